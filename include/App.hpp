@@ -1,126 +1,502 @@
-/** 
- *  @file   App.hpp 
- *  @brief  App class interface
- *  @author Mike and Dennis Ping
- *  @date   2021-11-13
- ***********************************************/
-#ifndef APP_HPP 
-#define APP_HPP
-
-// Include our Third-Party SFML header
-#include <SFML/Graphics.hpp>
-#include <SFML/Graphics/Image.hpp>
-#include <SFML/Graphics/Texture.hpp>
-#include <SFML/Graphics/Sprite.hpp>
-#include <SFML/System.hpp>
-// Include standard library C++ libraries.
-#include <queue>
-#include <stack>
-#include <vector>
-#include <unordered_map>
-// Project header files
-#include "Command.hpp"
-#include "Draw.hpp"
-#include "RoundedLine.hpp"
-
-// The main application that contains Minipaint functionality
-class App{
-private:
-
-    std::queue <std::unique_ptr<RoundedLine>> m_commands;
-    std::stack <std::unique_ptr<RoundedLine>> m_undo;
-    std::stack <std::unique_ptr<RoundedLine>> m_redo;
-    
-    // Main image	
-    sf::Image* m_image;
-    // Create a sprite that we overaly
-    // on top of the texture.
-    sf::Sprite* m_sprite;
-    // Texture sent to the GPU for rendering
-    sf::Texture* m_texture;
-    // Our rendering window
-    sf::RenderWindow* m_window;
-    // Current paintbrush color
-    sf::Color* m_current_color;
-    // Paintbrush radius
-    int* m_paintbrush_radius;
-    // Mouse cursor sprite
-    sf::Sprite* m_cursor_sprite;
-    // Mouse cursor texture
-    sf::RenderTexture* m_cursor_texture;
-    // Mouse cursor CircleShape template
-    sf::CircleShape* m_cursor_circle;
-    // Circle template for the paintbrush to use
-    std::vector<std::pair<int,int>>* m_circle_template;
-
-    sf::RenderTexture* m_render_texture;
-    sf::Sprite* m_render_sprite;
-
-    std::vector<std::unique_ptr<RoundedLine>>* m_draw_vector;
-
-    // Helper method to clear redo stack 
-    void ClearRedo();
-
-public:
-    App();
-    ~App();
-    // Public color codes map
-    std::unordered_map<sf::Keyboard::Key, sf::Color> color_codes;
-    // Stack that stores the number of undo commands.
-    std::stack<int> m_undo_count;
-    // Stack that stores the number of redo commands.
-    std::stack<int> m_redo_count;
-    sf::Vector2f* m_prev_point;
-
-    // Count the number of commands from mouse press to mouse release.
-    int cmdCount = 0;
-    // A vector of draw commands set to nullptr.
-    // std::vector<std::unique_ptr<Command>> prevCmds;
-
-    // Function pointer of init callback.
-	void (*m_initFunc)(void);
-    // Function pointer of update callback.
-	void (*m_updateFunc)(App& myApp);
-    // Function pointer of draw callback.
-	void (*m_drawFunc)(App& myApp);
-
-    // void 	AddCommand(std::unique_ptr<Command> c);
-    void    AddCommand(std::unique_ptr<RoundedLine> c);
-    int 	ExecuteCommand();
-    int 	UndoCommand();
-    int	    RedoCommand();
-
-    // Delete the copy, copy assignment, move, and copy move assignment
-    App(const App& other) = delete;
-    App(App&& other) = delete;
-    App& operator=(const App& other) = delete;
-    App& operator=(App& other) = delete;
-
-    sf::Image&          GetImage();
-    sf::Texture&        GetTexture();
-    sf::RenderWindow&   GetWindow();
-    sf::Sprite&         GetSprite();
-    sf::RenderTexture&  GetRenderTexture();
-    sf::Sprite&         GetRenderSprite();
-    
-    sf::Color&  GetPaintbrushColor();
-    void        SetPaintbrushColor(sf::Keyboard::Key numKey);
-    int&        GetPaintbrushRadius();
-    void        SetPaintbrushRadius(int radius);
-
-    void SetCursorPosition(const int &x, const int &y);
-    void GenerateCursor(int radius, sf::Color color);
-
-    void GenerateCircleTemplate(int radius);
-    std::vector<std::pair<int,int>> UseCircleTemplate(int x, int y);
-    
-	void Init(void (*initFunction)(void));
-	void UpdateCallback(void (*updateFunction)(App& myApp));
-	void DrawCallback(void (*drawFunction)(App& myApp));
-	void Loop(App& myApp);
-    void Destroy();
-
-};
-
-
-#endif
+/** 
+ *  @file   App.hpp 
+ *  @brief  App class interface
+ *  @author Mike and Dennis Ping
+ *  @date   2021-11-13
+ ***********************************************/
+#ifndef APP_HPP 
+#define APP_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+#include <SFML/System.hpp>
+// Include standard library C++ libraries.
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unordered_map>
+#include <unordered_set>
+// Project header files
+#include "Autosave.hpp"
+#include "Command.hpp"
+#include "Document.hpp"
+#include "Draw.hpp"
+#include "Exporter.hpp"
+#include "Fill.hpp"
+#include "Importer.hpp"
+#include "IndexedCanvas.hpp"
+#include "IndexedDelta.hpp"
+#include "Journal.hpp"
+#include "MipPyramid.hpp"
+#include "MpscQueue.hpp"
+#include "PaletteSwap.hpp"
+#include "PixelBatch.hpp"
+#include "RoundedLine.hpp"
+#include "SpillFile.hpp"
+#include "StrokeCodec.hpp"
+#include "StrokePipeline.hpp"
+#include "ThreadPool.hpp"
+#include "TileCanvas.hpp"
+#include "TileDelta.hpp"
+#include "TilePacker.hpp"
+#include "Timeline.hpp"
+#include "VirtualCanvas.hpp"
+
+// The main application that contains Minipaint functionality
+class App{
+public:
+    // Kinds of gestures in the undo history. Turning indexed mode on or off is a gesture too.
+    enum GestureKind { STROKE_GESTURE, RASTER_GESTURE, INDEXED_GESTURE };
+    // Id of the empty canvas, the root of the undo tree.
+    static constexpr sf::Uint32 NO_GESTURE = 0xFFFFFFFF;
+    // One node of the undo tree: the range [begin, end) of line segments of a paintbrush
+    // stroke, or of raster commands for a raster gesture, and the gesture it was made after.
+    // An indexed gesture has the entry of m_indexed_canvases indexed mode is on with in begin.
+    struct Gesture {
+        sf::Uint32 begin;
+        sf::Uint32 end;
+        sf::Uint32 parent;
+        // Child that redo goes to: the one made or visited last
+        sf::Uint32 redoChild;
+        // Number of gestures, and of raster gestures, from the root to this one
+        sf::Uint32 depth;
+        sf::Uint32 rasterDepth;
+        sf::Uint8 kind;
+    };
+
+private:
+
+    // Line segments waiting for ExecuteCommand(). Any thread may queue them; only the UI
+    // thread executes them.
+    MpscQueue<std::unique_ptr<RoundedLine>> m_commands;
+    // The thread that constructed the app, which runs the main loop and executes the queue
+    std::thread::id m_ui_thread;
+    // Segments ExecuteCommand() took from m_commands in one go
+    std::vector<std::unique_ptr<RoundedLine>> m_command_batch;
+    // A raster command in the history and where its undo data is in the scratch file.
+    struct RasterEntry {
+        std::unique_ptr<Command> command;
+        // Bytes of undo data in memory, 0 while spilled
+        size_t bytes = 0;
+        size_t spillOffset = 0;
+        size_t spillSize = 0;
+        // The undo data has a copy in the scratch file
+        bool onDisk = false;
+        // The undo data is only in the scratch file
+        bool spilled = false;
+    };
+
+    // Raster commands (bucket fills, raster strokes) of every branch of the undo tree.
+    std::vector <RasterEntry> m_raster_commands;
+    // Memory budget of the raster undo data, and how much of it is in memory.
+    size_t m_history_budget;
+    size_t m_history_bytes;
+    // Raster commands below this index are all spilled.
+    size_t m_spill_scan;
+    // Scratch file that undo data over the budget is spilled to
+    SpillFile* m_spill_file;
+    // Undo tree of every gesture, in the order they were made. A gesture made after an
+    // undo starts a new branch, so no gesture is ever thrown away.
+    std::vector <Gesture> m_gestures;
+    // The gesture the canvas is at, or NO_GESTURE for the empty canvas
+    sf::Uint32 m_gesture_cursor;
+    // Child of the empty canvas that redo goes to
+    sf::Uint32 m_root_redo;
+    // Where m_image was on the virtual canvas when each gesture was made, by gesture id. A
+    // stroke gesture has the one of its parent, so a branch only changes it at a raster or
+    // indexed gesture.
+    std::vector<sf::Vector2i> m_gesture_origins;
+    // Snapshots of the image after every CHECKPOINT_INTERVAL-th raster gesture of a branch,
+    // and of the empty canvas under NO_GESTURE. They share the tiles they have in common.
+    std::unordered_map<sf::Uint32, TileCanvas> m_checkpoints;
+    // Bytes of the tiles only the checkpoints hold, which count against the history budget
+    size_t m_checkpoint_bytes;
+    
+    // Main image: the part of the virtual canvas being shown and edited, from m_view_origin
+    // on, m_view_size big. It is empty in indexed mode.
+    sf::Image* m_image;
+    sf::Vector2i m_view_size;
+    // Every pixel of the canvas, which may be much larger than m_image. Tiles of m_image
+    // changed since they were last written back are marked in m_window_dirty.
+    VirtualCanvas* m_virtual_canvas;
+    sf::Vector2i m_view_origin;
+    std::vector<bool> m_window_dirty;
+    // Magnification of the view of m_image in the window
+    float m_zoom;
+    // The virtual canvas at half, quarter, ... of its size, for the view zoomed out. Tiles of
+    // m_image changed since they were last handed to it are marked in m_mip_dirty.
+    MipPyramid* m_mip_pyramid;
+    std::vector<bool> m_mip_dirty;
+    // When the changed tiles were last handed to the mip pyramid. At a zoom of 1 or more
+    // it is not shown, so the loop only does so every MIP_SYNC_INTERVAL_MS.
+    std::chrono::steady_clock::time_point m_mip_sync_time;
+    // The window's worth of the pyramid level shown zoomed out, from m_level_origin of level
+    // m_level_shown, or 0 if none is shown yet
+    sf::Image* m_level_image;
+    sf::Texture* m_level_texture;
+    sf::Sprite* m_level_sprite;
+    int m_level_shown;
+    sf::Vector2i m_level_origin;
+    // Tiles of m_image as of the last snapshot. Every change to m_image marks its tiles
+    // dirty here, so a snapshot only copies those tiles and the tile pointers.
+    TileCanvas* m_canvas;
+    // When each tile of m_image last changed. The buffers of m_canvas and of the checkpoints,
+    // but the ones under tiles that changed in the last m_cold_tile_ms, are handed to
+    // m_tile_packer every PACK_INTERVAL_MS; m_packing are the buffers it has.
+    std::vector<std::chrono::steady_clock::time_point> m_tile_touched;
+    TilePacker* m_tile_packer;
+    std::unordered_set<const TileCanvas::Tile*> m_packing;
+    int m_cold_tile_ms;
+    std::chrono::steady_clock::time_point m_pack_time;
+    // In indexed mode, every pixel of the canvas as 4 bit indices into a palette, instead of
+    // m_image and the pages of the virtual canvas; nullptr otherwise. Strokes, fills and
+    // recolors change the indices, and tiles are only expanded to RGBA8 for m_texture, the
+    // mip pyramid, the autosave and exports. m_indexed_changed are the tiles changed since
+    // they were last handed to the mip pyramid, and m_indexed_written the ones changed since
+    // the canvas was last saved, which leaving indexed mode writes to the virtual canvas.
+    IndexedCanvas* m_indexed;
+    std::set<int> m_indexed_changed;
+    // The indices of every time indexed mode was turned on, one of which m_indexed is. Leaving
+    // indexed mode keeps them, as undo and redo go back into it through its indexed gestures.
+    std::vector<std::unique_ptr<IndexedCanvas>> m_indexed_canvases;
+    std::vector<bool> m_indexed_written;
+    // Tiles changed by the indexed stroke being drawn, and its last point.
+    std::unique_ptr<IndexedDelta> m_indexed_stroke;
+    sf::Vector2f m_indexed_point;
+    // Create a sprite that we overaly
+    // on top of the texture.
+    sf::Sprite* m_sprite;
+    // Texture sent to the GPU for rendering
+    sf::Texture* m_texture;
+    // Our rendering window
+    sf::RenderWindow* m_window;
+    // Current paintbrush color
+    sf::Color* m_current_color;
+    // Paintbrush radius
+    int* m_paintbrush_radius;
+    // Mouse cursor sprite
+    sf::Sprite* m_cursor_sprite;
+    // Mouse cursor texture
+    sf::RenderTexture* m_cursor_texture;
+    // Mouse cursor CircleShape template
+    sf::CircleShape* m_cursor_circle;
+    // Circle template for the paintbrush to use
+    std::vector<std::pair<int,int>>* m_circle_template;
+
+    sf::RenderTexture* m_render_texture;
+    sf::Sprite* m_render_sprite;
+
+    // Every line segment of every branch, in drawing order. The ones from m_loose_begin on
+    // are not in a gesture yet.
+    std::vector<std::unique_ptr<RoundedLine>>* m_draw_vector;
+    size_t m_loose_begin;
+    // Line segment ranges of the strokes from the root to the cursor, in drawing order
+    std::vector<std::pair<size_t, size_t>> m_visible_lines;
+    // Number of line segments on the canvas
+    size_t m_draw_count;
+
+    // Worker threads shared by fills and other canvas-wide jobs
+    ThreadPool* m_thread_pool;
+    // Tessellates and rasterizes submitted strokes off the UI thread. Started by the first
+    // Submit call, so an App that never submits has no extra threads.
+    StrokePipeline* m_pipeline;
+    // CollectStrokes() is recording a finished item, so the pipeline must not be drained.
+    bool m_collecting;
+    // Renders the canvas after any gesture for the timeline slider, off the UI thread.
+    // Started by the first scrub.
+    Timeline* m_timeline;
+    // The image after m_scrub_gesture and the line segment ranges of its strokes, which
+    // timeline mode shows instead of the canvas
+    std::unique_ptr<sf::Image> m_scrub_image;
+    std::vector<std::pair<size_t, size_t>> m_scrub_strokes;
+    sf::Texture* m_scrub_texture;
+    sf::Sprite* m_scrub_sprite;
+    sf::Uint32 m_scrub_gesture;
+    bool m_timeline_mode;
+    // Encodes saved images off the UI thread. Started by the first save.
+    Exporter* m_exporter;
+    // Turns imported images into documents off the UI thread. Started by the first import.
+    Importer* m_importer;
+    // Milliseconds the last SaveImage() call kept the UI thread
+    double m_save_block_ms;
+    // The document last opened or saved. It stays mapped, so tiles of it outside the
+    // canvas are only read again, still compressed, when it is saved.
+    Document* m_document;
+
+    // Currently selected tool
+    int m_tool;
+    // In raster mode strokes are painted into m_image instead of kept as line segments.
+    bool m_raster_mode;
+    // Tiles changed by the raster mode stroke being drawn.
+    std::unique_ptr<TileDelta> m_stroke_delta;
+    // The last gesture is a stroke of pixel batches that later batches are added to.
+    bool m_batch_stroke;
+
+    // Kinds of records in the journal.
+    enum JournalRecordKind { STROKE_RECORD, FILL_RECORD, PIXELS_RECORD, UNDO_RECORD, REDO_RECORD, SWITCH_RECORD, PAN_RECORD, RECOLOR_RECORD, INDEXED_RECORD, CANVAS_RECORD };
+    // Write-ahead journal of the committed gestures, or nullptr if there is none
+    Journal* m_journal;
+    // Gestures made before the last journal checkpoint, and the cursor at it. Replay starts
+    // from the document saved there, so it only has that gesture and the ones made after.
+    sf::Uint32 m_journal_floor;
+    sf::Uint32 m_journal_floor_cursor;
+    // The cursor moved to a gesture from before the checkpoint, so nothing is journaled
+    // until the next one
+    bool m_journal_stopped;
+    // Line segments executed since the last stroke record, already encoded for it.
+    StrokeWriter m_journal_lines;
+    // Saves what changed on the canvas every m_autosave_interval_ms, or nullptr if autosave is off
+    Autosave* m_autosave;
+    int m_autosave_interval_ms;
+    std::chrono::steady_clock::time_point m_autosave_time;
+    // Tiles of the virtual canvas changed since the last autosave
+    std::set<int> m_autosave_tiles;
+    // Line segment ranges of the strokes of the last autosave
+    std::vector<std::pair<size_t, size_t>> m_autosave_strokes;
+    // The file m_document was opened from or saved to
+    std::string m_document_path;
+
+    // Add a gesture after the cursor and move the cursor to it
+    void AddGesture(int kind, size_t begin, size_t end);
+    // The redo child of a gesture, or of the empty canvas
+    sf::Uint32& RedoChild(sf::Uint32 id);
+    // Where m_image was when gesture id was made, or (0,0) for the empty canvas
+    sf::Vector2i OriginOf(sf::Uint32 id);
+    // Undo or redo the raster commands of raster gesture id
+    bool ApplyRaster(sf::Uint32 id, bool redo);
+    // Move the cursor to the parent of its gesture, undoing its raster commands if applyRaster
+    bool StepBack(bool applyRaster);
+    // Move the cursor to a child of its gesture, redoing its raster commands if applyRaster
+    bool StepForward(sf::Uint32 child, bool applyRaster);
+    // Record the line segments since the last gesture as one stroke gesture
+    void RecordStroke(int numLines);
+    // Record a finished raster mode stroke, or forget its journal lines if delta is nullptr
+    void RecordRasterStroke(std::unique_ptr<Command> delta);
+    // Queue an item for the stroke pipeline, collecting finished items while it is full
+    void SubmitItem(StrokeItem& item);
+    // Collect and record everything submitted to the stroke pipeline
+    void DrainPipeline();
+    // Append a bucket fill record
+    void JournalFill(int x, int y, const sf::Color& color);
+    // Record an executed raster command as one gesture
+    void PushRasterCommand(std::unique_ptr<Command> command);
+    // Record the raster mode stroke or the pixel batch stroke being drawn, if any, as one gesture
+    void EndRasterStroke();
+    // Mark pixels of m_image as changed since the last snapshot and write back
+    void MarkDirty(const sf::IntRect& bounds);
+    // Paint a line segment into m_indexed as part of the indexed stroke being drawn
+    void PaintIndexed(const RoundedLine& line);
+    // Mark tiles of m_indexed under bounds, in canvas pixels, as changed and show them
+    void ShowIndexed(const sf::IntRect& bounds);
+    // Expand the part of bounds in the view to RGBA8 into m_texture
+    void UploadIndexed(const sf::IntRect& bounds);
+    // The pixels of area of m_indexed as an image, the background where it is off the canvas
+    sf::Image ExpandIndexed(const sf::IntRect& area);
+    // Read the virtual canvas into indices, or nullptr if it has too many colors
+    std::unique_ptr<IndexedCanvas> ReadIndexed();
+    // Turn indexed mode on with indexed, which holds the canvas as it is, or off for nullptr
+    bool SwitchIndexed(IndexedCanvas* indexed);
+    // Turn indexed mode off, writing the tiles it changed to the virtual canvas if writeBack
+    void LeaveIndexedMode(bool writeBack);
+    // Write the changed tiles of m_image back to the virtual canvas
+    bool WriteBack();
+    // Move m_image to origin of the virtual canvas, clamped to the canvas. Returns false if it did not move.
+    bool MoveRasterWindow(sf::Vector2i origin);
+    // Spill the oldest undo data until the history fits its memory budget
+    void TrimHistory();
+    // Bytes the line segments of the history take
+    size_t GetLineBytes();
+    // Count the bytes of the tiles only the checkpoints hold
+    void CountCheckpoints();
+    // Read spilled undo data of raster commands [begin, end) back into memory
+    bool FaultIn(size_t begin, size_t end);
+    // What the timeline renders for gesture id, or nullptr if its undo data can not be read
+    std::unique_ptr<Timeline::Frame> MakeTimelineFrame(sf::Uint32 id);
+    // Forget the undo history and every line segment, leaving the image as it is
+    void ResetHistory();
+    // Encode an executed line segment for the next stroke record
+    void JournalLine(const RoundedLine& line);
+    // Append the encoded line segments and the gesture made of the last gestureLines of them
+    void JournalStroke(bool raster, int gestureLines);
+    // Append a record that has no line segments, after any line segments still pending
+    void JournalRecord(const std::vector<sf::Uint8>& record);
+    // True if there is a journal and it can still replay where the cursor is
+    bool IsJournaling();
+    // Append an undo, redo or switch record for the move of the cursor just made
+    void JournalMove(int kind);
+    // Cut the journal back to a record of the canvas as it is now
+    void CheckpointJournal();
+    // Apply one journal record to the canvas and the undo history
+    bool ReplayRecord(const std::vector<sf::Uint8>& record);
+    // Line segment ranges of the strokes on the canvas, the ones not in a gesture yet as one more
+    void GetCanvasStrokes(std::vector<std::pair<size_t, size_t>>& strokes);
+    // Put the tiles and strokes changed since the last autosave in job. Returns false if none did.
+    bool FillAutosave(Autosave::Job& job);
+    // Start the autosave over for a new base document, whose strokes are the canvas's if strokesInBase
+    void RestartAutosave(bool strokesInBase);
+
+public:
+    // Default memory budget of the undo history.
+    static constexpr size_t DEFAULT_HISTORY_BUDGET = 256 * 1024 * 1024;
+    // Line segments m_commands holds before AddCommand() waits or executes them, and that
+    // ExecuteCommand() takes from it at a time.
+    static constexpr size_t COMMAND_QUEUE_CAPACITY = 65536;
+    static constexpr size_t COMMAND_BATCH = 256;
+    // Raster gestures of a branch between two checkpoints of the image.
+    static constexpr sf::Uint32 CHECKPOINT_INTERVAL = 32;
+    // Range of magnifications of the view. Below 1 the view is a level of the mip pyramid
+    // drawn 1:1, so only powers of two, down to the level that fits in one tile.
+    static constexpr float MIN_ZOOM = 1.0f / 1024.0f;
+    static constexpr float MAX_ZOOM = 16.0f;
+    // Default time between autosaves.
+    static constexpr int DEFAULT_AUTOSAVE_INTERVAL_MS = 30 * 1000;
+    // The autosave starts over once its file is this many times the size of the tiles drawn
+    // on, and at least AUTOSAVE_COMPACT_BYTES, since a tile changed in every save is in it
+    // every time.
+    static constexpr size_t AUTOSAVE_COMPACT_RATIO = 4;
+    static constexpr size_t AUTOSAVE_COMPACT_BYTES = 4 * 1024 * 1024;
+    // Default time a tile has to stay unchanged before it is packed, and how often the
+    // loop looks for such tiles.
+    static constexpr int DEFAULT_COLD_TILE_MS = 10 * 1000;
+    static constexpr int PACK_INTERVAL_MS = 1000;
+    // How often the loop hands the changed tiles to the mip pyramid while it is not shown.
+    static constexpr int MIP_SYNC_INTERVAL_MS = 1000;
+    // Tools the left mouse button can use.
+    enum Tool { PAINTBRUSH, BUCKET };
+
+    App();
+    ~App();
+    // Public color codes map
+    std::unordered_map<sf::Keyboard::Key, sf::Color> color_codes;
+    sf::Vector2f* m_prev_point;
+
+    // Count the number of commands from mouse press to mouse release.
+    int cmdCount = 0;
+    // A vector of draw commands set to nullptr.
+    // std::vector<std::unique_ptr<Command>> prevCmds;
+
+    // Function pointer of init callback.
+	void (*m_initFunc)(void);
+    // Function pointer of update callback.
+	void (*m_updateFunc)(App& myApp);
+    // Function pointer of draw callback.
+	void (*m_drawFunc)(App& myApp);
+
+    // void 	AddCommand(std::unique_ptr<Command> c);
+    void    AddCommand(std::unique_ptr<RoundedLine> c);
+    int 	ExecuteCommand();
+    int 	UndoCommand();
+    int	    RedoCommand();
+    int     FillCommand(int x, int y);
+    int     RecolorCommand(int x, int y);
+    int     PaintPixels(std::unique_ptr<PixelBatch> batch);
+    void    PushGesture(int numLines);
+    void    SubmitPoint(int x, int y, short owner);
+    void    SubmitStrokeEnd();
+    void    SubmitFill(int x, int y);
+    int     CollectStrokes();
+    int     SwitchGesture(sf::Uint32 id);
+    int     SwitchBranch();
+    sf::Uint32 GetGestureCursor();
+    size_t  GetGestureCount();
+    const Gesture& GetGesture(sf::Uint32 id);
+    int     ScrubTo(sf::Uint32 id);
+    bool    CollectScrub();
+    sf::Uint32 GetScrubGesture();
+    const sf::Image& GetScrubImage();
+    size_t  GetScrubLineCount();
+    sf::Image RenderGesture(sf::Uint32 id);
+    bool    GetTimelineMode();
+    void    SetTimelineMode(bool timelineMode);
+    size_t  GetLineCount();
+    void    SetHistoryBudget(size_t bytes);
+    size_t  GetHistoryBytes();
+    size_t  GetSpillFileSize();
+    int     OpenJournal(const std::string& path, int flushIntervalMs = Journal::DEFAULT_FLUSH_INTERVAL_MS);
+    bool    FlushJournal();
+    void    CloseJournal();
+    sf::Image Flatten();
+    bool    SaveImage(const std::string& path);
+    int     CollectSaves();
+    float   GetSaveProgress();
+    double  GetSaveBlockTime();
+    void    WaitForSaves();
+    bool    ImportImage(const std::string& source, const std::string& document = "");
+    int     CollectImports();
+    float   GetImportProgress();
+    void    WaitForImports();
+    bool    SaveDocument(const std::string& path);
+    bool    OpenDocument(const std::string& path);
+    bool    NewCanvas(int width, int height);
+    bool    StartAutosave(const std::string& path, int intervalMs = DEFAULT_AUTOSAVE_INTERVAL_MS);
+    void    StopAutosave();
+    bool    AutosaveNow();
+    size_t  GetAutosaveBytes();
+    size_t  GetAutosaveCount();
+    void    WaitForAutosave();
+    bool    RestoreAutosave(const std::string& path);
+    sf::Vector2i GetCanvasSize();
+    bool    PanTo(int x, int y);
+    bool    Pan(int dx, int dy);
+    sf::Vector2i GetViewOrigin();
+    void    SetZoom(float zoom);
+    float   GetZoom();
+    int     GetMipLevel();
+    void    SyncMipPyramid(bool wait = false);
+    const sf::Image* RenderLevel();
+    sf::Vector2i MapPixelToCanvas(int x, int y);
+    size_t  GetCanvasPageBytes();
+    void    SetColdTileTime(int ms);
+    size_t  PackColdTiles(bool wait = false);
+    size_t  GetSnapshotBytes();
+    size_t  GetCanvasBytes();
+    TileCanvas Snapshot();
+
+    // Delete the copy, copy assignment, move, and copy move assignment
+    App(const App& other) = delete;
+    App(App&& other) = delete;
+    App& operator=(const App& other) = delete;
+    App& operator=(App& other) = delete;
+
+    sf::Image&          GetImage();
+    sf::Texture&        GetTexture();
+    sf::RenderWindow&   GetWindow();
+    sf::Sprite&         GetSprite();
+    sf::RenderTexture&  GetRenderTexture();
+    sf::Sprite&         GetRenderSprite();
+    
+    sf::Color&  GetPaintbrushColor();
+    void        SetPaintbrushColor(sf::Keyboard::Key numKey);
+    int&        GetPaintbrushRadius();
+    void        SetPaintbrushRadius(int radius);
+    int         GetTool();
+    void        SetTool(int tool);
+    bool        GetRasterMode();
+    void        SetRasterMode(bool rasterMode);
+    bool        GetIndexedMode();
+    bool        SetIndexedMode(bool indexedMode);
+    size_t      GetIndexedBytes();
+
+    void SetCursorPosition(const int &x, const int &y);
+    void GenerateCursor(int radius, sf::Color color);
+
+    void GenerateCircleTemplate(int radius);
+    std::vector<std::pair<int,int>> UseCircleTemplate(int x, int y);
+    
+	void Init(void (*initFunction)(void));
+	void UpdateCallback(void (*updateFunction)(App& myApp));
+	void DrawCallback(void (*drawFunction)(App& myApp));
+	void Loop(App& myApp);
+    void Destroy();
+
+};
+
+
+#endif
@@ -0,0 +1,130 @@
+/** 
+ *  @file   Autosave.hpp 
+ *  @brief  Incremental autosave of the canvas, written on a background thread
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef AUTOSAVE_HPP
+#define AUTOSAVE_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Config.hpp>
+// Include standard library C++ libraries.
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+// Project header files
+#include "Journal.hpp"
+#include "RoundedLine.hpp"
+
+// Saves the canvas into a file of its own every so often, writing only what changed since
+// the save before: the tiles of the virtual canvas drawn on since, still compressed, and
+// the strokes after the ones the two saves have in common. The UI thread hands that over
+// as a job and a worker thread appends it to a Journal and fsyncs it, so painting never
+// waits on the disk. A save is these records, each starting with its kind:
+//     HEADER_RECORD: width, height and strokes of the base document (varints), then its path
+//     TILE_RECORD: tile index (varint), then the TileCodec bytes of the tile
+//     STROKES_RECORD: strokes kept of the save before (varint), then StrokeWriter bytes of the strokes after them
+//     COMMIT_RECORD: number of the save (varint)
+// A save with a header starts the file over, for a canvas with a new base document; it is
+// written to a new file that replaces the old one once it is whole. Load() only applies
+// the saves that were committed, so one torn by a crash is dropped whole.
+class Autosave {
+    public:
+        enum RecordKind { HEADER_RECORD, TILE_RECORD, STROKES_RECORD, COMMIT_RECORD };
+        // What changed on the canvas since the save before.
+        struct Job {
+            // Start the file over for a width x height canvas over the document at base,
+            // or "" for a blank one, whose first baseStrokes strokes are the canvas's.
+            bool restart = false;
+            int width = 0;
+            int height = 0;
+            size_t baseStrokes = 0;
+            std::string base;
+            // Compressed tiles, by index
+            std::vector<std::pair<int, std::vector<sf::Uint8>>> tiles;
+            // The strokes changed: the first keptStrokes are the ones of the save before,
+            // then come the ones in strokes.
+            bool strokesChanged = false;
+            size_t keptStrokes = 0;
+            std::vector<sf::Uint8> strokes;
+        };
+        // The canvas as of the last committed save.
+        struct State {
+            int width = 0;
+            int height = 0;
+            std::string base;
+            // Strokes of the base document still first on the canvas
+            size_t baseStrokes = 0;
+            // Tiles changed from the base, compressed, by index
+            std::map<int, std::vector<sf::Uint8>> tiles;
+            // Line segments of the strokes after the base ones, and where each stroke ends
+            std::vector<std::unique_ptr<RoundedLine>> lines;
+            std::vector<size_t> strokeEnds;
+            size_t saveCount = 0;
+        };
+
+    private:
+        std::string m_path;
+        // Only the worker uses the journal while it is open.
+        Journal m_journal;
+        // Guards every member below.
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_idle;
+        std::deque<std::unique_ptr<Job>> m_jobs;
+        bool m_saving;
+        bool m_stopping;
+        bool m_failed;
+        size_t m_save_count;
+        size_t m_last_bytes;
+        size_t m_total_bytes;
+        size_t m_file_size;
+        std::thread m_worker;
+
+        // Write the saved jobs in order, until the autosave is destroyed.
+        void WorkerLoop();
+        // Append the records of job and fsync them. Returns the bytes written, or 0 if it failed.
+        size_t Write(const Job& job);
+
+    public:
+        Autosave();
+        // Write the saved jobs, then stop the worker and close the file.
+        ~Autosave();
+
+        // Delete the copy, copy assignment, move, and copy move assignment
+        Autosave(const Autosave& other) = delete;
+        Autosave(Autosave&& other) = delete;
+        Autosave& operator=(const Autosave& other) = delete;
+        Autosave& operator=(Autosave&& other) = delete;
+
+        // Start an empty autosave file at path. One already there is kept at path + ".prev".
+        // The first job saved must restart it.
+        bool Open(const std::string& path);
+        // Queue job for the worker.
+        void Save(std::unique_ptr<Job> job);
+        // True while a job waits or is written.
+        bool IsBusy();
+        // Wait until every saved job is written.
+        void Wait();
+        // False once a save could not be written.
+        bool IsGood();
+        // Saves written, bytes the last one and all of them wrote, and the size of the file.
+        size_t GetSaveCount();
+        size_t GetLastBytes();
+        size_t GetTotalBytes();
+        size_t GetFileSize();
+
+        // Read the committed saves of the autosave at path into state. Returns false if it
+        // can not be read or has none.
+        static bool Load(const std::string& path, State& state);
+};
+
+#endif
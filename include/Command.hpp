@@ -1,39 +1,62 @@
-/** 
- *  @file   Command.hpp 
- *  @brief  Represents an actionable command by the user.
- *  @author Mike and Dennis Ping
- *  @date   2021-11-13
- ***********************************************/
-#ifndef COMMAND_HPP
-#define COMMAND_HPP
-
-// Include our Third-Party SFML header
-#include <SFML/Graphics/Image.hpp>
-// Include standard library C++ libraries.
-#include <string>
-
-// The command class
-class Command{
-    protected:
-        sf::Image& m_image;
-
-    public:
-        // The Constructor for a command requires an image reference that it uses to
-        // apply the command
-        Command(sf::Image& image);
-        // The Destructor for a command
-        virtual ~Command();
-
-        // Returns true or false if the command was able to succssfully
-        // execute.
-        // If it executes successfully, then that command is added to the
-        // undo stack.
-        virtual bool execute() = 0;
-        virtual bool undo() = 0;
-        virtual bool redo() = 0;
-        virtual std::pair<int, int> getCoords() = 0;
-        //friend bool operator!= (const Command &left, const Command &right);
-        virtual std::string getDescription() = 0;
-};
-
-#endif
+/** 
+ *  @file   Command.hpp 
+ *  @brief  Represents an actionable command by the user.
+ *  @author Mike and Dennis Ping
+ *  @date   2021-11-13
+ ***********************************************/
+#ifndef COMMAND_HPP
+#define COMMAND_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+// Include standard library C++ libraries.
+#include <cstddef>
+#include <string>
+#include <vector>
+
+// The command class
+class Command{
+    protected:
+        sf::Image& m_image;
+
+        // Writable pointer to the RGBA8 pixels of m_image for commands that
+        // paint whole spans instead of calling setPixel per pixel.
+        sf::Uint8* pixels();
+        // Human readable name of one of the palette colors.
+        static std::string colorName(sf::Color color);
+
+    public:
+        // The Constructor for a command requires an image reference that it uses to
+        // apply the command
+        Command(sf::Image& image);
+        // The Destructor for a command
+        virtual ~Command();
+
+        // Returns true or false if the command was able to succssfully
+        // execute.
+        // If it executes successfully, then that command is added to the
+        // undo stack.
+        virtual bool execute() = 0;
+        virtual bool undo() = 0;
+        virtual bool redo() = 0;
+        virtual std::pair<int, int> getCoords() = 0;
+        //friend bool operator!= (const Command &left, const Command &right);
+        virtual std::string getDescription() = 0;
+
+        // Undo history support for commands whose undo data can leave memory while they
+        // sit in the history. By default a command has nothing to spill.
+        // Bytes of undo data held in memory.
+        virtual size_t getByteSize() const;
+        // Append the undo data to bytes and free it. Returns false if the command can not spill.
+        virtual bool spill(std::vector<sf::Uint8>& bytes);
+        // Take back the undo data from the bytes spill() wrote. Returns false if they are not valid.
+        virtual bool restore(const std::vector<sf::Uint8>& bytes);
+        // Pixels of m_image that execute, undo and redo may change. The whole image by default.
+        virtual sf::IntRect getBounds() const;
+        // Paint what redo() paints into image, an image of the same size as m_image (e.g. a
+        // copy of an earlier state of it), leaving m_image alone. Returns false if the command can not.
+        virtual bool redoInto(sf::Image& image) const;
+};
+
+#endif
@@ -0,0 +1,141 @@
+/** 
+ *  @file   Document.hpp 
+ *  @brief  Native document file of independently compressed tiles and strokes
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef DOCUMENT_HPP
+#define DOCUMENT_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Config.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+// Include standard library C++ libraries.
+#include <cstddef>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+// Project header files
+#include "RoundedLine.hpp"
+#include "TileCanvas.hpp"
+
+// A document file is laid out as
+//     header:  magic "MPD2", width, height, tile size (u32 each), offset and size of the strokes (u64 each)
+//     index:   offset (u64) and size (u32) of every tile, row after row
+//     tiles:   each compressed on its own with TileCodec
+//     strokes: every stroke on the canvas, as StrokeWriter::WriteStroke() encodes it
+// with every number in memory order. Open() maps the file instead of reading it, so
+// opening costs the same for any size of document, and the OS only reads the pages of
+// the index and of the tiles that are decoded.
+class Document {
+    private:
+        const sf::Uint8* m_data;
+        size_t m_size;
+#ifdef _WIN32
+        void* m_file;
+        void* m_mapping;
+#else
+        int m_file;
+#endif
+        int m_width;
+        int m_height;
+        int m_tiles_x;
+        int m_tiles_y;
+        // Tiles decoded since the document was opened
+        size_t m_decoded_count;
+
+    public:
+        // Tile edge length in pixels, the same as the tiles of the canvas snapshots.
+        static constexpr int TILE_SIZE = TileCanvas::TILE_SIZE;
+        // Bytes of the header and of one index entry.
+        static constexpr size_t HEADER_SIZE = 32;
+        static constexpr size_t INDEX_ENTRY_SIZE = 12;
+
+        Document();
+        ~Document();
+
+        // Delete the copy, copy assignment, move, and copy move assignment
+        Document(const Document& other) = delete;
+        Document(Document&& other) = delete;
+        Document& operator=(const Document& other) = delete;
+        Document& operator=(Document&& other) = delete;
+
+        // Map the document at path. Returns false if it can not be mapped or is not a document.
+        bool Open(const std::string& path);
+        void Close();
+        bool IsOpen() const;
+        int GetWidth() const;
+        int GetHeight() const;
+        int GetTilesX() const;
+        int GetTileCount() const;
+        // Pixel rectangle of a tile, clipped to the document.
+        sf::IntRect GetTileRect(int tile) const;
+        // The compressed bytes of a tile, inside the mapping.
+        bool GetEncodedTile(int tile, const sf::Uint8*& data, size_t& size) const;
+        // Decode a tile into pixels, rows stride bytes apart, the size GetTileRect() says.
+        bool ReadTile(int tile, sf::Uint8* pixels, size_t stride);
+        // Decode the tiles that overlap image, put at (left,top) of the document, into it.
+        // Pixels of image outside the document are left alone.
+        bool ReadRegion(int left, int top, sf::Image& image);
+        // Read the strokes: their line segments, in drawing order, and where each stroke ends.
+        bool ReadStrokes(std::vector<std::unique_ptr<RoundedLine>>& lines, std::vector<size_t>& strokeEnds) const;
+        // Size in bytes of the encoded strokes.
+        size_t GetStrokesSize() const;
+        size_t GetDecodedCount() const;
+};
+
+// Writes a document front to back, one tile at a time in index order, so the whole
+// canvas never has to be in memory at once. The file is written next to path and
+// renamed over it by Finish(), so a document can be saved over the one that is open.
+class DocumentWriter {
+    private:
+        std::FILE* m_file;
+        std::string m_path;
+        std::string m_temp_path;
+        int m_width;
+        int m_height;
+        int m_tiles_x;
+        int m_tile_count;
+        // Tiles added so far
+        int m_next;
+        // Offset the next tile or strokes go to
+        size_t m_offset;
+        // Offset of the strokes
+        size_t m_strokes_offset;
+        std::vector<sf::Uint8> m_index;
+        std::vector<sf::Uint8> m_encoded;
+
+        // Append bytes at m_offset.
+        bool Append(const sf::Uint8* data, size_t size);
+
+    public:
+        DocumentWriter();
+        // Drop a document that was not finished.
+        ~DocumentWriter();
+
+        // Delete the copy, copy assignment, move, and copy move assignment
+        DocumentWriter(const DocumentWriter& other) = delete;
+        DocumentWriter(DocumentWriter&& other) = delete;
+        DocumentWriter& operator=(const DocumentWriter& other) = delete;
+        DocumentWriter& operator=(DocumentWriter&& other) = delete;
+
+        // Start a width x height document at path.
+        bool Open(const std::string& path, int width, int height);
+        // Compress the next tile from pixels, rows stride bytes apart.
+        bool AddTile(const sf::Uint8* pixels, size_t stride);
+        // Add the next tile compressed already, e.g. copied from another document.
+        bool AddEncodedTile(const sf::Uint8* data, size_t size);
+        // Pixel rectangle of the next tile.
+        sf::IntRect GetNextTileRect() const;
+        // Append bytes a StrokeWriter encoded. Every tile must have been added. The strokes
+        // may be added a chunk at a time, so they never have to be in memory at once.
+        bool AddStrokes(const std::vector<sf::Uint8>& strokes);
+        // Write the header and the index and put the file in place. Every tile must have been added.
+        bool Finish();
+        // Bytes written so far.
+        size_t GetSize() const;
+};
+
+#endif
@@ -0,0 +1,100 @@
+/** 
+ *  @file   Exporter.hpp 
+ *  @brief  Saves canvas snapshots to image files on a background encoder thread
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef EXPORTER_HPP
+#define EXPORTER_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/System/Vector2.hpp>
+// Include standard library C++ libraries.
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+// Project header files
+#include "RoundedLine.hpp"
+#include "SvgWriter.hpp"
+#include "TileCanvas.hpp"
+
+// Encodes image files on a worker thread, so a save never waits on the encoder. The UI
+// thread only takes a snapshot of the canvas (a TileCanvas copy shares the tiles) and the
+// line segments to flatten over it, and Save()s them as a job. The worker flattens and
+// encodes the jobs in the order they were saved and reports its progress through each one.
+class Exporter {
+    public:
+        // One file to write: the image as the snapshot, with the lines flattened over it.
+        // The lines belong to the canvas, which must keep them alive until IsBusy() is false.
+        // An SVG file has the lines only, as vector paths, one per gesture of strokeEnds.
+        struct Job {
+            std::string path;
+            TileCanvas canvas;
+            std::vector<const RoundedLine*> lines;
+            // Where each gesture of lines ends. Lines after the last end are one more gesture.
+            std::vector<size_t> strokeEnds;
+            // Where the snapshot is on the canvas the lines are drawn on.
+            sf::Vector2i origin;
+        };
+        // A finished save.
+        struct Result {
+            std::string path;
+            bool saved = false;
+        };
+
+    private:
+        // Guards every member below except m_progress.
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_idle;
+        std::deque<std::unique_ptr<Job>> m_jobs;
+        std::vector<Result> m_results;
+        bool m_encoding;
+        bool m_stopping;
+        // Progress through the job being encoded, in thousandths
+        std::atomic<int> m_progress;
+        std::thread m_worker;
+
+        // Encode the saved jobs in order, until the exporter is destroyed.
+        void WorkerLoop();
+
+    public:
+        // Start the worker.
+        Exporter();
+        // Finish the saved jobs, then stop the worker.
+        ~Exporter();
+
+        // Delete the copy, copy assignment, move, and copy move assignment
+        Exporter(const Exporter& other) = delete;
+        Exporter(Exporter&& other) = delete;
+        Exporter& operator=(const Exporter& other) = delete;
+        Exporter& operator=(Exporter&& other) = delete;
+
+        // Queue job for the worker.
+        void Save(std::unique_ptr<Job> job);
+        // Progress through the saves not finished yet, from 0 to 1, or 1 if there are none.
+        float GetProgress();
+        // Move the saves finished since the last call to results. Returns how many there were.
+        size_t Collect(std::vector<Result>& results);
+        // True while a job waits or is encoded.
+        bool IsBusy();
+        // Wait until every saved job is written.
+        void Wait();
+
+        // Flatten and encode job into its file, in the format its extension names. progress,
+        // if not nullptr, goes from 0 to 1000 along the way. Returns false if it could not be written.
+        static bool Encode(const Job& job, std::atomic<int>* progress = nullptr);
+        // Write the lines of job as SVG paths, streamed out a gesture at a time.
+        static bool EncodeSvg(const Job& job, std::atomic<int>* progress = nullptr);
+        // True if path ends in an extension Encode() can write (.png, .jpg, .jpeg, .bmp, .tga, .svg).
+        static bool IsSupported(const std::string& path);
+};
+
+#endif
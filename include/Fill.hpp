@@ -0,0 +1,68 @@
+/** 
+ *  @file   Fill.hpp 
+ *  @brief  Bucket fill action interface. 
+ *  @author Dennis Ping 
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef FILL_HPP
+#define FILL_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Image.hpp>
+// Include standard library C++ libraries.
+#include <string>
+#include <vector>
+// Project header files
+#include "Command.hpp"
+#include "MathUtility.hpp"
+#include "ThreadPool.hpp"
+
+// The Fill class inherits from the Command class. One Fill is one undoable
+// bucket fill, no matter how many pixels it changes.
+class Fill : public Command {
+    private:
+        int xCoord;
+        int yCoord;
+        sf::Color currColor;
+        // Optional image the fill region is computed on instead of m_image.
+        // Only used during execute().
+        const sf::Image* m_boundary;
+        // Optional pool that large fills are split over.
+        ThreadPool* m_pool;
+        // The filled region as horizontal spans.
+        std::vector<MathUtility::Span> m_spans;
+        // Run-length encoded previous pixels of m_image over m_spans, as (pixel, count).
+        std::vector<std::pair<sf::Uint32, int>> m_prevRuns;
+        // Bounding box of m_spans, which is kept while they are spilled.
+        sf::IntRect m_bounds;
+
+    public:
+        // Images with at least this many pixels are filled tile by tile on the thread pool.
+        static constexpr size_t PARALLEL_FILL_PIXELS = 4096 * 2048;
+
+        // The constructor for a Fill requires an (x,y) seed, an image ref, 
+        // and the current paintbrush color.
+        Fill(int x, int y, sf::Image& image, sf::Color paintbrushColor);
+        // Same as above, but the region is found on the boundary image (e.g. a
+        // flattened copy of the canvas) while the pixels are written to image.
+        Fill(int x, int y, sf::Image& image, sf::Color paintbrushColor, const sf::Image& boundary);
+        ~Fill();
+        bool execute() override;
+        bool undo() override;
+        bool redo() override;
+        bool redoInto(sf::Image& image) const override;
+        std::pair<int, int> getCoords() override;
+        std::string getDescription() override;
+        // Split the fill over a thread pool when the image is large enough.
+        void setThreadPool(ThreadPool* pool);
+        // Number of pixels changed by this fill.
+        size_t getPixelCount() const;
+        size_t getByteSize() const override;
+        // The spans are stored as varint deltas from the previous span.
+        bool spill(std::vector<sf::Uint8>& bytes) override;
+        bool restore(const std::vector<sf::Uint8>& bytes) override;
+        sf::IntRect getBounds() const override;
+};
+
+#endif
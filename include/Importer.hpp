@@ -0,0 +1,96 @@
+/** 
+ *  @file   Importer.hpp 
+ *  @brief  Imports image files as documents on a background thread, a band of rows at a time
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef IMPORTER_HPP
+#define IMPORTER_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Config.hpp>
+// Include standard library C++ libraries.
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Turns image files into documents on a worker thread, which the App then opens like any
+// other, so only the tiles under the view are ever decoded again. The image is read from
+// the top down one band of TILE_SIZE rows at a time, and every tile of the band is
+// compressed into a DocumentWriter before the next band is read, so an import holds one
+// tile row of pixels however tall the image is. BMP, TGA and binary PPM/PGM files are
+// decoded straight from the file a row at a time. Other formats sf::Image can load (PNG,
+// JPEG, ...) have no row by row decoder here, so they are loaded whole first and then go
+// through the same bands.
+class Importer {
+    public:
+        // One image to import: source is read and the document written to document.
+        struct Job {
+            std::string source;
+            std::string document;
+        };
+        // A finished import.
+        struct Result {
+            std::string source;
+            std::string document;
+            bool imported = false;
+            int width = 0;
+            int height = 0;
+            // Most bytes of pixels held at once along the way
+            size_t peakBytes = 0;
+        };
+
+    private:
+        // Guards every member below except m_progress.
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_idle;
+        std::deque<std::unique_ptr<Job>> m_jobs;
+        std::vector<Result> m_results;
+        bool m_importing;
+        bool m_stopping;
+        // Progress through the job being imported, in thousandths
+        std::atomic<int> m_progress;
+        std::thread m_worker;
+
+        // Import the queued jobs in order, until the importer is destroyed.
+        void WorkerLoop();
+
+    public:
+        // Start the worker.
+        Importer();
+        // Finish the queued jobs, then stop the worker.
+        ~Importer();
+
+        // Delete the copy, copy assignment, move, and copy move assignment
+        Importer(const Importer& other) = delete;
+        Importer(Importer&& other) = delete;
+        Importer& operator=(const Importer& other) = delete;
+        Importer& operator=(Importer&& other) = delete;
+
+        // Queue job for the worker.
+        void Import(std::unique_ptr<Job> job);
+        // Progress through the imports not finished yet, from 0 to 1, or 1 if there are none.
+        float GetProgress();
+        // Move the imports finished since the last call to results. Returns how many there were.
+        size_t Collect(std::vector<Result>& results);
+        // True while a job waits or is imported.
+        bool IsBusy();
+        // Wait until every queued job is imported.
+        void Wait();
+
+        // Import the image of job into its document, filling in result. progress, if not
+        // nullptr, goes from 0 to 1000 along the way. Returns false if the image could not
+        // be read or the document could not be written.
+        static bool Convert(const Job& job, Result& result, std::atomic<int>* progress = nullptr);
+        // True if path ends in an extension that is decoded a row at a time (.bmp, .tga, .ppm, .pgm, .pnm).
+        static bool IsStreamed(const std::string& path);
+};
+
+#endif
@@ -0,0 +1,145 @@
+/** 
+ *  @file   IndexedCanvas.hpp 
+ *  @brief  Canvas of 4 bit palette indices, for pictures of at most 16 colors
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef INDEXEDCANVAS_HPP
+#define INDEXEDCANVAS_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+// Include standard library C++ libraries.
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+// Project header files
+#include "MathUtility.hpp"
+#include "TileCanvas.hpp"
+
+// Pixels stored as 4 bit indices into a palette of up to MAX_COLORS colors, two pixels a
+// byte with the left one in the low nibble, in tiles of TILE_SIZE x TILE_SIZE like a
+// TileCanvas and a VirtualCanvas. A tile takes TILE_BYTES, an eighth of its RGBA8 pixels,
+// so fills and scans go through an eighth of the bytes, and a tile of one index takes
+// none. Pixels are expanded to RGBA8 only when a tile is handed on to be uploaded or
+// exported, a byte of indices at a time through a table of the pixel pairs of every byte.
+// Changing a color of the palette recolors every pixel of it without touching the
+// indices. Several entries of the palette may have the same color.
+// Tiles are always TILE_SIZE pixels wide in memory; the edge tiles use part of it.
+class IndexedCanvas {
+    public:
+        // Tile edge length in pixels.
+        static constexpr int TILE_SIZE = TileCanvas::TILE_SIZE;
+        // Bytes of one row of a tile.
+        static constexpr int TILE_ROW_BYTES = TILE_SIZE / 2;
+        // Bytes of one tile.
+        static constexpr int TILE_BYTES = TILE_ROW_BYTES * TILE_SIZE;
+        static constexpr int MAX_COLORS = 16;
+        // FindColor() of a color not in the palette.
+        static constexpr int NO_INDEX = -1;
+
+        // The indices of one tile, or none for a tile whose pixels are all of index.
+        struct Tile {
+            std::vector<sf::Uint8> indices;
+            sf::Uint8 index = 0;
+        };
+
+    private:
+        int m_width;
+        int m_height;
+        int m_tiles_x;
+        int m_tiles_y;
+        std::vector<Tile> m_tiles;
+        std::vector<sf::Color> m_palette;
+        // The two RGBA8 pixels of every byte of indices, 8 bytes each.
+        std::vector<sf::Uint8> m_expand;
+
+        // One in every nibble of a 64 bit word.
+        static constexpr std::uint64_t NIBBLES = 0x1111111111111111ULL;
+
+        // Make m_expand for the palette.
+        void BuildExpand();
+        // True if mask has only one index, and then pattern is that index in all 16 nibbles.
+        static bool SingleIndex(unsigned int mask, std::uint64_t& pattern);
+        // The tile that holds pixel (x,y).
+        const Tile& TileAt(int x, int y) const;
+        // The byte of indices that holds pixel (x,y), of a tile that has indices. The
+        // writable one gives the tile its indices first if it is of one index.
+        sf::Uint8* ByteAt(int x, int y);
+        const sf::Uint8* ByteAt(int x, int y) const;
+        // The indices of mask, bit i for index i, are the ones a run is made of.
+        // The last x of the run of mask pixels of row y that starts at x, going right no further than limit.
+        int RunRight(int x, int y, unsigned int mask, int limit) const;
+        // The first x of the run of mask pixels of row y that ends at x, going left no further than limit.
+        int RunLeft(int x, int y, unsigned int mask, int limit) const;
+        // The first x from x on of a pixel of mask in row y, or limit + 1 if there is none up to limit.
+        int NextOf(int x, int y, unsigned int mask, int limit) const;
+        // Set pixels x0 to x1 of row y to index, a byte at a time between the ends.
+        void FillRow(int y, int x0, int x1, int index);
+
+    public:
+        IndexedCanvas();
+        // Make a width x height canvas of the palette color index. Returns false if the
+        // palette has more than MAX_COLORS colors.
+        bool Create(int width, int height, const std::vector<sf::Color>& palette, int index = 0);
+        // Make a canvas of the pixels of image, with the colors of palette and then the other
+        // colors of the image in the order they are met. Returns false if there are more than
+        // MAX_COLORS of them.
+        bool FromImage(const sf::Image& image, const std::vector<sf::Color>& palette);
+
+        int GetWidth() const;
+        int GetHeight() const;
+        int GetTilesX() const;
+        int GetTileCount() const;
+        // Pixel rectangle of a tile, clipped to the canvas.
+        sf::IntRect GetTileRect(int tile) const;
+
+        const std::vector<sf::Color>& GetPalette() const;
+        // Index of color in the palette, or NO_INDEX.
+        int FindColor(sf::Color color) const;
+        // Index of color in the palette, added to it if it is not there yet. NO_INDEX if the palette is full.
+        int AddColor(sf::Color color);
+        // Change a color of the palette, and so every pixel of it.
+        void SetPaletteColor(int index, sf::Color color);
+        // Bit i set for every index i of color.
+        unsigned int GetColorMask(sf::Color color) const;
+
+        int GetIndex(int x, int y) const;
+        void SetIndex(int x, int y, int index);
+        sf::Color GetPixel(int x, int y) const;
+        // Set every pixel of rect, clipped to the canvas, to index.
+        void FillRect(const sf::IntRect& rect, int index);
+        // Set every pixel whose center is within width / 2 of the segment from a to b to index.
+        void FillCapsule(sf::Vector2f a, sf::Vector2f b, float width, int index);
+        // Bucket fill the region of the color of (x,y) with index, within area, or the whole
+        // canvas. Returns the filled spans, none if (x,y) is outside or already of the color of index.
+        std::vector<MathUtility::Span> Fill(int x, int y, int index);
+        std::vector<MathUtility::Span> Fill(int x, int y, int index, const sf::IntRect& area);
+
+        const Tile& GetTile(int tile) const;
+        // Swap a tile with other, e.g. to take back the tile it was before a change.
+        void SwapTile(int tile, Tile& other);
+        // Drop the indices of a tile whose pixels are all of one index. Returns true if it is of one index.
+        bool Compact(int tile);
+        // True if a pixel of the tile is of index.
+        bool HasIndex(int tile, int index) const;
+        // Read the indices of a tile from RGBA8 pixels, rows stride bytes apart, adding their
+        // colors to the palette. Returns false if it has no room for them.
+        bool ReadTile(int tile, const sf::Uint8* pixels, size_t stride);
+
+        // Expand the pixels of a tile to RGBA8, rows stride bytes apart. Only the part of the
+        // tile on the canvas is written.
+        void ExpandTile(int tile, sf::Uint8* pixels, size_t stride) const;
+        // Expand the pixels of rect to RGBA8 at pixels, rows stride bytes apart. Only the part
+        // of rect on the canvas is written.
+        void ExpandRect(const sf::IntRect& rect, sf::Uint8* pixels, size_t stride) const;
+        // Expand every pixel into image, which is made the size of the canvas.
+        void CopyToImage(sf::Image& image) const;
+        // Bytes the tiles take: TILE_BYTES for each tile of more than one index, and the tile table.
+        size_t GetByteSize() const;
+};
+
+#endif
@@ -0,0 +1,64 @@
+/** 
+ *  @file   IndexedDelta.hpp 
+ *  @brief  Undo a gesture on an IndexedCanvas with the tiles it changed.
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef INDEXEDDELTA_HPP
+#define INDEXEDDELTA_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+// Include standard library C++ libraries.
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+// Project header files
+#include "Command.hpp"
+#include "IndexedCanvas.hpp"
+
+// One undoable gesture (a paintbrush stroke or a bucket fill) on the indices of an
+// IndexedCanvas, the counterpart of a TileDelta for a canvas in indexed mode. While the
+// gesture is painted, touch() saves each tile the first time it is about to change.
+// execute() keeps the saved tiles that changed, TILE_BYTES each or none for a tile of one
+// index. Undo and redo swap them with the tiles of the canvas, so both are tile swaps.
+class IndexedDelta : public Command {
+    private:
+        IndexedCanvas& m_canvas;
+        std::string m_name;
+        // While recording: index into m_tiles of each tile, or -1 if it is untouched.
+        std::vector<int> m_slots;
+        // The tile index and the other version of each saved tile: before the gesture
+        // while it is done, after it while it is undone.
+        std::vector<std::pair<int, IndexedCanvas::Tile>> m_tiles;
+        // Bounding box of the changed tiles, which is kept while they are spilled.
+        sf::IntRect m_bounds;
+
+        // Swap the saved tiles with the ones of the canvas.
+        void swap();
+
+    public:
+        // Record a gesture named name on canvas. image is the window of the App the command
+        // belongs to. Call touch() before each write, then execute().
+        IndexedDelta(IndexedCanvas& canvas, sf::Image& image, const std::string& name);
+        ~IndexedDelta();
+        // Save the tiles overlapping the canvas rectangle [x0, x1] x [y0, y1] that were not saved yet.
+        void touch(int x0, int y0, int x1, int y1);
+        // Stop recording and keep the changed tiles. Returns false if nothing changed.
+        bool execute() override;
+        bool undo() override;
+        bool redo() override;
+        std::pair<int, int> getCoords() override;
+        std::string getDescription() override;
+        // Number of tiles the gesture changed.
+        size_t getTileCount() const;
+        size_t getByteSize() const override;
+        bool spill(std::vector<sf::Uint8>& bytes) override;
+        bool restore(const std::vector<sf::Uint8>& bytes) override;
+        // Canvas pixels of the changed tiles.
+        sf::IntRect getBounds() const override;
+};
+
+#endif
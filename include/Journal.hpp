@@ -0,0 +1,88 @@
+/** 
+ *  @file   Journal.hpp 
+ *  @brief  Write-ahead journal of the undo history
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef JOURNAL_HPP
+#define JOURNAL_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Config.hpp>
+// Include standard library C++ libraries.
+#include <condition_variable>
+#include <cstddef>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// An append-only file of binary records. Append() only queues a record in memory; a
+// background thread writes the queued records and fsyncs the file every flush interval,
+// so the caller never waits on the disk. Each record is framed as a varint length, the
+// payload and a CRC-32 of the payload, so a record torn by a crash is detected and
+// dropped when the journal is read back.
+class Journal {
+    private:
+        std::FILE* m_file;
+        int m_flush_interval_ms;
+        // Framed records waiting for the background thread.
+        std::vector<sf::Uint8> m_pending;
+        size_t m_pending_count;
+        // Bytes and records in the file, including the ones that are not synced yet.
+        size_t m_size;
+        size_t m_record_count;
+        bool m_stopping;
+        // Held while records are written, so they reach the file in Append() order.
+        std::mutex m_file_mutex;
+        // Guards m_pending, m_pending_count and m_stopping.
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::thread m_writer;
+
+        // Wake up every flush interval and write the queued records.
+        void WriterLoop();
+        // Write the queued records and fsync the file.
+        bool WritePending();
+
+    public:
+        // Default time between background writes.
+        static constexpr int DEFAULT_FLUSH_INTERVAL_MS = 100;
+
+        Journal();
+        // Write the queued records and close the file.
+        ~Journal();
+
+        // Open the journal at path for appending, creating it if needed. A torn record at
+        // the end of the file is cut off. An interval of 0 writes every record right away.
+        bool Open(const std::string& path, int flushIntervalMs = DEFAULT_FLUSH_INTERVAL_MS);
+        // Queue a record for the background thread.
+        void Append(const std::vector<sf::Uint8>& record);
+        // Write and fsync the queued records now. Returns false if the file could not be
+        // written; the records then stay queued for the next flush.
+        bool Flush();
+        // Drop every record, queued or in the file, e.g. once what they recorded is saved.
+        bool Reset();
+        // Flush, stop the background thread and close the file.
+        void Close();
+        bool IsOpen() const;
+        // Bytes and records appended so far, including the ones still queued.
+        size_t GetSize();
+        size_t GetRecordCount();
+
+        // Read every intact record of the journal at path, stopping at the first torn or
+        // corrupt one. validSize is the length of the file up to that record. Returns false
+        // if the file exists but is not a journal.
+        static bool ReadRecords(const std::string& path, std::vector<std::vector<sf::Uint8>>& records, size_t& validSize);
+        // CRC-32 (IEEE) of size bytes.
+        static sf::Uint32 Crc32(const sf::Uint8* data, size_t size);
+
+        // Delete the copy, copy assignment, move, and copy move assignment
+        Journal(const Journal& other) = delete;
+        Journal(Journal&& other) = delete;
+        Journal& operator=(const Journal& other) = delete;
+        Journal& operator=(Journal&& other) = delete;
+};
+
+#endif
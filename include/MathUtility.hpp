@@ -1,27 +1,59 @@
-/** 
- *  @file   MathUtility.hpp 
- *  @brief  Math utility interface
- *  @author Dennis Ping 
- *  @date   2021-10-23
- ***********************************************/
-
-#ifndef MATHUTILITY_H
-#define MATHUTILITY_H
-
-#include <vector>
-
-// A utility class for drawing lines and shapes.
-class MathUtility {
-
-    public:
-        // Extremely Fast Line Algorithm (EFLA)
-        static std::vector<std::pair<int, int>> ExtremelyFastLineAlgo(int x1, int y1, int x2, int y2);
-
-        // Bresenham's Circle Algorithm
-        static std::vector<std::pair<int, int>> BresenhamCircleAlgo(int radius);
-
-        // Flood Fill Algorithm
-        // std::vector<std::pair<int, int>> Utility::FloodFill(sf::Image& image, int x, int y, sf::Color newColor);
-};
-
+/** 
+ *  @file   MathUtility.hpp 
+ *  @brief  Math utility interface
+ *  @author Dennis Ping 
+ *  @date   2021-10-23
+ ***********************************************/
+
+#ifndef MATHUTILITY_H
+#define MATHUTILITY_H
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics/Color.hpp>
+// Include standard library C++ libraries.
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+namespace sf { class Image; }
+class ThreadPool;
+
+// A utility class for drawing lines and shapes.
+class MathUtility {
+
+    public:
+        // A horizontal run of pixels on row y from x0 to x1 (inclusive).
+        struct Span {
+            int y;
+            int x0;
+            int x1;
+        };
+
+        // Szudzik pairing function as a hash for std::pair<int,int> keys (computed in double)
+        struct SzudzikHash {
+            size_t operator()(const std::pair<int,int>& p) const;
+        };
+
+        // Extremely Fast Line Algorithm (EFLA)
+        static std::vector<std::pair<int, int>> ExtremelyFastLineAlgo(int x1, int y1, int x2, int y2);
+
+        // Bresenham's Circle Algorithm
+        static std::vector<std::pair<int, int>> BresenhamCircleAlgo(int radius);
+
+        // Scanline Flood Fill Algorithm on a RGBA8 pixel buffer
+        static std::vector<Span> ScanlineFill(const sf::Uint8* pixels, int width, int height, int x, int y);
+
+        // Scanline Flood Fill split into tiles that are filled in parallel on a thread pool
+        static std::vector<Span> TileFill(const sf::Uint8* pixels, int width, int height, int x, int y, ThreadPool& pool, int tileSize = 512);
+
+        // Paint every span of a RGBA8 pixel buffer with one color
+        static void FillSpans(sf::Uint8* pixels, int width, const std::vector<Span>& spans, sf::Color color);
+
+        // Writable pointer to the RGBA8 pixels of an image
+        static sf::Uint8* MutablePixels(sf::Image& image);
+
+        // Pack a color into the 32-bit layout of one RGBA8 pixel
+        static sf::Uint32 PackColor(sf::Color color);
+};
+
 #endif
\ No newline at end of file
@@ -0,0 +1,115 @@
+/** 
+ *  @file   MipPyramid.hpp 
+ *  @brief  Downsampled levels of the virtual canvas, rebuilt on a worker thread
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef MIPPYRAMID_HPP
+#define MIPPYRAMID_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+// Include standard library C++ libraries.
+#include <condition_variable>
+#include <cstddef>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+// Project header files
+#include "Document.hpp"
+#include "VirtualCanvas.hpp"
+
+// The canvas at half, quarter, ... of its size, down to the level that fits in one tile, for
+// drawing it zoomed out at the cost of drawing it at 1:1. Level 0 is the canvas itself and is
+// not kept here; the UI thread Update()s the level 0 tiles that changed. A worker thread box
+// filters each of them into its quarter of the parent tile on level 1, then that tile into its
+// quarter on level 2 and so on, so only the ancestors of changed tiles are rebuilt. Each level
+// is a VirtualCanvas of its own, so it takes memory only for the tiles that are not the
+// background, compressed.
+class MipPyramid {
+    public:
+        typedef std::vector<sf::Uint8> Tile;
+
+    private:
+        int m_width;
+        int m_height;
+        // Level 1 is m_levels[0]
+        std::vector<std::unique_ptr<VirtualCanvas>> m_levels;
+        // Guards every member, and the levels while one is read or written.
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_idle;
+        // Level 0 tiles waiting for the worker, by tile index
+        std::map<int, Tile> m_pending;
+        // The document of the canvas, if any: its tiles go in too, once the worker has
+        // nothing pending, unless they were updated already.
+        const Document* m_document;
+        int m_document_next;
+        std::vector<bool> m_updated;
+        // Tiles of each level rebuilt since TakeRebuilt(), without repeats
+        std::vector<std::vector<int>> m_rebuilt;
+        std::vector<std::vector<bool>> m_rebuilt_flags;
+        size_t m_rebuilt_count;
+        bool m_working;
+        bool m_stopping;
+        std::thread m_worker;
+
+        // Take a batch of level 0 tiles and rebuild their ancestors, until the pyramid is destroyed.
+        void WorkerLoop();
+        // Rebuild the parents of children, the tiles of level - 1 by index, on level. Returns the parents.
+        std::map<int, Tile> BuildLevel(int level, std::map<int, Tile>& children);
+        bool HasWork() const;
+
+    public:
+        // Tile edge length in pixels on every level.
+        static constexpr int TILE_SIZE = VirtualCanvas::TILE_SIZE;
+        // Level 0 tiles the worker takes at a time.
+        static constexpr size_t BATCH_SIZE = 256;
+
+        // Start the worker. The pyramid has no levels until Reset().
+        MipPyramid();
+        // Stop the worker, dropping the tiles not built yet.
+        ~MipPyramid();
+
+        // Delete the copy, copy assignment, move, and copy move assignment
+        MipPyramid(const MipPyramid& other) = delete;
+        MipPyramid(MipPyramid&& other) = delete;
+        MipPyramid& operator=(const MipPyramid& other) = delete;
+        MipPyramid& operator=(MipPyramid&& other) = delete;
+
+        // Start over for a width x height canvas of background, and queue the tiles of document
+        // if it is not nullptr. It must stay open until the pyramid is reset again or given
+        // another document by SetDocument().
+        void Reset(int width, int height, sf::Color background, const Document* document = nullptr);
+        // Read the tiles still to go in from document, which has the same pixels as the one before.
+        void SetDocument(const Document* document);
+        // Levels above level 0.
+        int GetLevelCount();
+        // Size of a level.
+        sf::Vector2i GetLevelSize(int level);
+
+        // Queue level 0 tile, rows stride bytes apart and as large as the tile is on the canvas.
+        // The pixels are copied; a tile queued again before the worker took it is replaced.
+        void Update(int tile, const sf::Uint8* pixels, size_t stride);
+        // Read level, from 1 to GetLevelCount(), under area of image, with image put at
+        // (left,top) of the level. Pixels outside the level are the background.
+        bool Read(int level, int left, int top, sf::Image& image, const sf::IntRect& area);
+        // Swap the tiles of level rebuilt since the last call into tiles.
+        void TakeRebuilt(int level, std::vector<int>& tiles);
+        // Pixel rectangle of a tile of level.
+        sf::IntRect GetTileRect(int level, int tile);
+
+        // True while tiles wait or are being built.
+        bool IsBusy();
+        // Wait until every tile queued is built.
+        void Wait();
+        // Number of tiles rebuilt on all levels since the pyramid was made.
+        size_t GetRebuiltCount();
+};
+
+#endif
@@ -0,0 +1,121 @@
+/** 
+ *  @file   MpscQueue.hpp 
+ *  @brief  Bounded lock-free multi-producer/single-consumer queue
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef MPSCQUEUE_HPP
+#define MPSCQUEUE_HPP
+
+// Include standard library C++ libraries.
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <utility>
+#include <vector>
+
+// A ring buffer that any number of threads push to and one thread pops from, without locks.
+// Every slot has a sequence number that says whose turn it is: a producer may fill the slot
+// of position pos when its sequence is pos, and the consumer may empty it when it is pos + 1.
+// Producers claim positions with a compare-and-swap on m_tail, so the only contention is on
+// that one counter; the consumer owns m_head and never writes a shared counter.
+template <typename T>
+class MpscQueue {
+    private:
+        // Size of a cache line, so the two ends never share one.
+        static constexpr size_t CACHE_LINE = 64;
+
+        struct Slot {
+            std::atomic<size_t> sequence;
+            T value;
+        };
+
+        std::unique_ptr<Slot[]> m_slots;
+        size_t m_capacity;
+        size_t m_mask;
+        // Next position a producer claims.
+        alignas(CACHE_LINE) std::atomic<size_t> m_tail;
+        // Next position to pop. Only the consumer reads or writes it.
+        alignas(CACHE_LINE) size_t m_head;
+
+    public:
+        // A queue of at least capacity items. The capacity is rounded up to a power of two.
+        explicit MpscQueue(size_t capacity) : m_tail(0), m_head(0) {
+            m_capacity = 2;
+            while (m_capacity < capacity) {
+                m_capacity *= 2;
+            }
+            m_mask = m_capacity - 1;
+            m_slots.reset(new Slot[m_capacity]);
+            for (size_t i = 0; i < m_capacity; i++) {
+                m_slots[i].sequence.store(i, std::memory_order_relaxed);
+            }
+        }
+
+        // Delete the copy, copy assignment, move, and copy move assignment
+        MpscQueue(const MpscQueue& other) = delete;
+        MpscQueue(MpscQueue&& other) = delete;
+        MpscQueue& operator=(const MpscQueue& other) = delete;
+        MpscQueue& operator=(MpscQueue&& other) = delete;
+
+        // Any thread: move item into the queue. Returns false, leaving item alone, if the queue is full.
+        bool TryPush(T& item) {
+            size_t pos = m_tail.load(std::memory_order_relaxed);
+            Slot* slot;
+            while (true) {
+                slot = &m_slots[pos & m_mask];
+                const size_t sequence = slot->sequence.load(std::memory_order_acquire);
+                const std::intptr_t lag = (std::intptr_t)sequence - (std::intptr_t)pos;
+                if (lag == 0) {
+                    // The slot is free: claim pos, or retry from wherever m_tail moved to.
+                    if (m_tail.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                        break;
+                    }
+                } else if (lag < 0) {
+                    // The slot still holds the item of the previous lap.
+                    return false;
+                } else {
+                    pos = m_tail.load(std::memory_order_relaxed);
+                }
+            }
+            slot->value = std::move(item);
+            slot->sequence.store(pos + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer: move the oldest item into item. Returns false if the queue is empty, or if
+        // the producer that claimed the oldest position has not filled it yet.
+        bool TryPop(T& item) {
+            Slot& slot = m_slots[m_head & m_mask];
+            if (slot.sequence.load(std::memory_order_acquire) != m_head + 1) {
+                return false;
+            }
+            item = std::move(slot.value);
+            slot.sequence.store(m_head + m_capacity, std::memory_order_release);
+            m_head++;
+            return true;
+        }
+
+        // Consumer: append up to max of the oldest items to items. Returns the number taken.
+        size_t TryPopBatch(std::vector<T>& items, size_t max) {
+            size_t count = 0;
+            while (count < max) {
+                Slot& slot = m_slots[m_head & m_mask];
+                if (slot.sequence.load(std::memory_order_acquire) != m_head + 1) {
+                    break;
+                }
+                items.push_back(std::move(slot.value));
+                slot.sequence.store(m_head + m_capacity, std::memory_order_release);
+                m_head++;
+                count++;
+            }
+            return count;
+        }
+
+        size_t GetCapacity() const {
+            return m_capacity;
+        }
+};
+
+#endif
@@ -0,0 +1,54 @@
+/** 
+ *  @file   PaletteSwap.hpp 
+ *  @brief  Recolor every pixel of a color of an IndexedCanvas through its palette.
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef PALETTESWAP_HPP
+#define PALETTESWAP_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+// Include standard library C++ libraries.
+#include <cstddef>
+#include <string>
+#include <utility>
+#include <vector>
+// Project header files
+#include "Command.hpp"
+#include "IndexedCanvas.hpp"
+
+// Recolor every pixel of one color of the whole canvas by changing the palette entries of
+// that color, the indices are left alone. Undo sets the entries back. The command keeps
+// no pixels, only the entries it changed.
+class PaletteSwap : public Command {
+    private:
+        IndexedCanvas& m_canvas;
+        sf::Color m_from;
+        sf::Color m_to;
+        // The palette entries that were of m_from.
+        std::vector<int> m_indices;
+        // Bounding box of the tiles that have pixels of the entries.
+        sf::IntRect m_bounds;
+
+    public:
+        // Recolor the pixels of canvas of color from to color to. image is the window of the
+        // App the command belongs to.
+        PaletteSwap(IndexedCanvas& canvas, sf::Image& image, sf::Color from, sf::Color to);
+        ~PaletteSwap();
+        // Returns false if no entry of the palette is of color from, or from is to.
+        bool execute() override;
+        bool undo() override;
+        bool redo() override;
+        std::pair<int, int> getCoords() override;
+        std::string getDescription() override;
+        // Number of palette entries changed.
+        size_t getColorCount() const;
+        size_t getByteSize() const override;
+        // Canvas pixels of the tiles the recolor shows on.
+        sf::IntRect getBounds() const override;
+};
+
+#endif
@@ -0,0 +1,62 @@
+/** 
+ *  @file   PixelBatch.hpp 
+ *  @brief  Batched pixel drawing action interface. 
+ *  @author Dennis Ping 
+ *  @date   2026-10-19 
+ ***********************************************/
+#ifndef PIXEL_BATCH_HPP
+#define PIXEL_BATCH_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+// Include standard library C++ libraries.
+#include <string>
+#include <vector>
+// Project header files
+#include "Command.hpp"
+
+// The PixelBatch class inherits from the Command class. One PixelBatch paints many
+// pixels with one color, e.g. a paintbrush dab and the line joining it to the last one,
+// so execute, undo and redo are one virtual call each instead of one per pixel.
+class PixelBatch : public Command {
+    private:
+        sf::Color currColor;
+        // Pixel indices (y * width + x) into m_image, in the order they are painted.
+        std::vector<sf::Uint32> m_indices;
+        // Previous pixel of each index, packed like an RGBA8 pixel. Filled by execute().
+        std::vector<sf::Uint32> m_prevColors;
+        // Bounding box of the pixels, which is kept while they are spilled.
+        sf::IntRect m_bounds;
+
+    public:
+        // The constructor for a PixelBatch requires an image ref and the current
+        // paintbrush color. Pixels are added with add() before execute().
+        PixelBatch(sf::Image& image, sf::Color paintbrushColor);
+        ~PixelBatch();
+        // Add the pixel at (x,y). Pixels outside the image are ignored.
+        void add(int x, int y);
+        // Add every (x,y) pixel of coords.
+        void add(const std::vector<std::pair<int, int>>& coords);
+        void reserve(size_t count);
+        // Paint the pixels, keeping only the ones that change. Returns false if none do.
+        bool execute() override;
+        bool undo() override;
+        bool redo() override;
+        bool redoInto(sf::Image& image) const override;
+        std::pair<int, int> getCoords() override;
+        std::string getDescription() override;
+        // Number of pixels in the batch, only the changed ones after execute().
+        size_t getPixelCount() const;
+        // Pixel indices (y * width + x) of the batch, in the order they are painted.
+        const std::vector<sf::Uint32>& getIndices() const;
+        sf::Color getColor() const;
+        size_t getByteSize() const override;
+        // The indices are stored as varint deltas and the previous pixels as runs.
+        bool spill(std::vector<sf::Uint8>& bytes) override;
+        bool restore(const std::vector<sf::Uint8>& bytes) override;
+        sf::IntRect getBounds() const override;
+};
+
+#endif
@@ -0,0 +1,44 @@
+/** 
+ *  @file   PixelKernels.hpp 
+ *  @brief  RGBA8 span kernels with runtime CPU dispatch
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef PIXELKERNELS_HPP
+#define PIXELKERNELS_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics/Color.hpp>
+
+// Row kernels every CPU pixel write goes through: brushes, fills and compositing.
+// Each kernel has a scalar, an SSE2 and an AVX2 version, and the best one the CPU
+// supports is picked the first time a kernel is called. All versions give the same
+// result bit for bit. Blending is source-over in straight alpha, with the color
+// channels blended as if the destination were opaque (the canvas always is):
+//     out.rgb = (src.rgb * a + dst.rgb * (255 - a)) / 255
+//     out.a   = a + dst.a * (255 - a) / 255
+class PixelKernels {
+
+    public:
+        // Instruction set levels, from slowest to fastest.
+        enum Level { SCALAR, SSE2, AVX2 };
+
+        // Fill count pixels with one color, packed with MathUtility::PackColor.
+        static void FillSpan(sf::Uint8* dst, int count, sf::Uint32 color);
+        // Blend one color over count pixels, its alpha scaled by each 8-bit mask (coverage) value.
+        static void BlendMask(sf::Uint8* dst, const sf::Uint8* mask, int count, sf::Color color);
+        // Box filter two rows of 2 * count pixels into count pixels: each one is the rounded
+        // average of a 2x2 block, channel by channel.
+        static void Downsample(sf::Uint8* dst, const sf::Uint8* row0, const sf::Uint8* row1, int count);
+
+        // The best level this CPU supports.
+        static Level GetBestLevel();
+        // The level the kernels currently run at.
+        static Level GetLevel();
+        // Force a level, e.g. to compare them in tests and benchmarks. Levels the CPU
+        // does not support fall back to the best one it does. Not thread safe.
+        static void SetLevel(Level level);
+        static const char* GetLevelName(Level level);
+};
+
+#endif
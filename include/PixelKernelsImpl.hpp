@@ -0,0 +1,37 @@
+/** 
+ *  @file   PixelKernelsImpl.hpp 
+ *  @brief  Per instruction set implementations of the PixelKernels
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef PIXELKERNELSIMPL_HPP
+#define PIXELKERNELSIMPL_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics/Color.hpp>
+
+// Only PixelKernels.cpp should call these; everyone else goes through PixelKernels.
+// Each namespace lives in its own translation unit compiled for its instruction set.
+namespace PixelKernelsScalar {
+    void FillSpan(sf::Uint8* dst, int count, sf::Uint32 color);
+    void BlendMask(sf::Uint8* dst, const sf::Uint8* mask, int count, sf::Color color);
+    void Downsample(sf::Uint8* dst, const sf::Uint8* row0, const sf::Uint8* row1, int count);
+}
+
+#if defined(__x86_64__) || defined(__i386__) || defined(_M_X64)
+#define PIXEL_KERNELS_X86 1
+
+namespace PixelKernelsSSE2 {
+    void FillSpan(sf::Uint8* dst, int count, sf::Uint32 color);
+    void BlendMask(sf::Uint8* dst, const sf::Uint8* mask, int count, sf::Color color);
+    void Downsample(sf::Uint8* dst, const sf::Uint8* row0, const sf::Uint8* row1, int count);
+}
+
+namespace PixelKernelsAVX2 {
+    void FillSpan(sf::Uint8* dst, int count, sf::Uint32 color);
+    void BlendMask(sf::Uint8* dst, const sf::Uint8* mask, int count, sf::Color color);
+    void Downsample(sf::Uint8* dst, const sf::Uint8* row0, const sf::Uint8* row1, int count);
+}
+#endif
+
+#endif
@@ -0,0 +1,274 @@
+/** 
+ *  @file   PixelSet.hpp 
+ *  @brief  Flat open-addressing set and map of pixel coordinates
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef PIXELSET_HPP
+#define PIXELSET_HPP
+
+// Include standard library C++ libraries.
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+// Helpers shared by PixelSet and PixelMap.
+namespace PixelKey {
+    // Key of an empty slot. It is the packed key of (INT_MIN, INT_MIN), which can not be stored.
+    const std::uint64_t EMPTY = 0x8000000080000000ULL;
+
+    // Pack (x,y) into one 64-bit key, y in the high half and x in the low half.
+    inline std::uint64_t Pack(int x, int y) {
+        return ((std::uint64_t)(std::uint32_t)y << 32) | (std::uint32_t)x;
+    }
+
+    inline int X(std::uint64_t key) {
+        return (int)(std::uint32_t)key;
+    }
+
+    inline int Y(std::uint64_t key) {
+        return (int)(std::uint32_t)(key >> 32);
+    }
+
+    // Integer-only mixing hash (the MurmurHash3 64-bit finalizer), so that neighboring
+    // pixels land far apart in the table.
+    inline std::uint64_t Mix(std::uint64_t key) {
+        key ^= key >> 33;
+        key *= 0xff51afd7ed558ccdULL;
+        key ^= key >> 33;
+        key *= 0xc4ceb9fe1a85ec53ULL;
+        key ^= key >> 33;
+        return key;
+    }
+}
+
+// The open-addressing table of packed pixel keys that PixelSet and PixelMap are built on:
+// one flat array of keys with linear probing, doubled at 50% load, and erase by shifting
+// the rest of the probe run back, so there are no tombstones. A map keeps its values in an
+// array of the same size; every call that moves keys between slots calls move(from, to),
+// so the map moves the values along.
+class PixelTable {
+    private:
+        std::vector<std::uint64_t> m_keys;
+        size_t m_size;
+        size_t m_mask;
+
+    public:
+        // Erase() of a key that is not in the table.
+        static constexpr size_t NO_SLOT = (size_t)-1;
+
+        PixelTable();
+
+        size_t Size() const;
+        size_t Capacity() const;
+        std::uint64_t KeyAt(size_t slot) const;
+        // Index of the slot holding key, or of the empty slot where it would go.
+        size_t Probe(std::uint64_t key) const;
+        // Empty every slot but keep the table memory.
+        void Clear();
+
+        // Move every key into a new table of capacity slots (a power of 2). move(from, to)
+        // is called with from a slot of the old table.
+        template <typename Move>
+        void Rehash(size_t capacity, Move move) {
+            std::vector<std::uint64_t> oldKeys(capacity, PixelKey::EMPTY);
+            oldKeys.swap(m_keys);
+            m_mask = capacity - 1;
+            for (size_t i = 0; i < oldKeys.size(); i++) {
+                if (oldKeys[i] != PixelKey::EMPTY) {
+                    const size_t slot = Probe(oldKeys[i]);
+                    m_keys[slot] = oldKeys[i];
+                    move(i, slot);
+                }
+            }
+        }
+
+        // Make room for count keys without rehashing.
+        template <typename Move>
+        void Reserve(size_t count, Move move) {
+            size_t capacity = m_keys.size();
+            while (capacity < count * 2) {
+                capacity *= 2;
+            }
+            if (capacity != m_keys.size()) {
+                Rehash(capacity, move);
+            }
+        }
+
+        // Return the slot of key, adding it first if it is missing. The table doubles
+        // when it would become more than half full.
+        template <typename Move>
+        size_t Insert(std::uint64_t key, bool& inserted, Move move) {
+            assert(key != PixelKey::EMPTY && "(INT_MIN, INT_MIN) can not be stored");
+            if ((m_size + 1) * 2 > m_keys.size()) {
+                Rehash(m_keys.size() * 2, move);
+            }
+            const size_t slot = Probe(key);
+            inserted = m_keys[slot] == PixelKey::EMPTY;
+            if (inserted) {
+                m_keys[slot] = key;
+                m_size++;
+            }
+            return slot;
+        }
+
+        // Remove key. The following entries of its probe run are shifted back. Returns the
+        // slot left empty, or NO_SLOT if key was not in the table.
+        template <typename Move>
+        size_t Erase(std::uint64_t key, Move move) {
+            size_t hole = Probe(key);
+            if (m_keys[hole] == PixelKey::EMPTY) {
+                return NO_SLOT;
+            }
+            size_t i = hole;
+            while (true) {
+                i = (i + 1) & m_mask;
+                if (m_keys[i] == PixelKey::EMPTY) {
+                    break;
+                }
+                // Move the entry back unless its home slot lies cyclically in (hole, i].
+                const size_t home = PixelKey::Mix(m_keys[i]) & m_mask;
+                if (((i - home) & m_mask) >= ((i - hole) & m_mask)) {
+                    m_keys[hole] = m_keys[i];
+                    move(i, hole);
+                    hole = i;
+                }
+            }
+            m_keys[hole] = PixelKey::EMPTY;
+            m_size--;
+            return hole;
+        }
+};
+
+// A map from pixel coordinates to Value: a PixelTable and an array of values beside it.
+// Unlike std::unordered_map there is no node allocation per pixel: one insert is a hash,
+// a few probes in a contiguous array and a store.
+template <typename Value>
+class PixelMap {
+    private:
+        PixelTable m_table;
+        std::vector<Value> m_values;
+
+        // Move the values along with the keys a rehash moves out of the old table.
+        void Grow(size_t capacity) {
+            std::vector<Value> oldValues(capacity);
+            oldValues.swap(m_values);
+            m_table.Rehash(capacity, [this, &oldValues](size_t from, size_t to) { m_values[to] = std::move(oldValues[from]); });
+        }
+
+    public:
+        PixelMap() : m_values(m_table.Capacity()) {
+        }
+
+        size_t Size() const {
+            return m_table.Size();
+        }
+
+        bool Empty() const {
+            return m_table.Size() == 0;
+        }
+
+        // Make room for count pixels without rehashing.
+        void Reserve(size_t count) {
+            size_t capacity = m_table.Capacity();
+            while (capacity < count * 2) {
+                capacity *= 2;
+            }
+            if (capacity != m_table.Capacity()) {
+                Grow(capacity);
+            }
+        }
+
+        void Clear() {
+            m_table.Clear();
+            m_values.assign(m_values.size(), Value());
+        }
+
+        // Return a reference to the value at (x,y), inserting a default value if it is missing.
+        Value& Get(int x, int y) {
+            const std::uint64_t key = PixelKey::Pack(x, y);
+            if ((m_table.Size() + 1) * 2 > m_table.Capacity()) {
+                Grow(m_table.Capacity() * 2);
+            }
+            bool inserted;
+            const size_t slot = m_table.Insert(key, inserted, [](size_t, size_t) {});
+            if (inserted) {
+                m_values[slot] = Value();
+            }
+            return m_values[slot];
+        }
+
+        // Set the value at (x,y). Returns true if (x,y) was not in the map before.
+        bool Insert(int x, int y, const Value& value) {
+            const size_t before = m_table.Size();
+            Get(x, y) = value;
+            return m_table.Size() != before;
+        }
+
+        // Return a pointer to the value at (x,y), or nullptr if it is missing.
+        Value* Find(int x, int y) {
+            const size_t slot = m_table.Probe(PixelKey::Pack(x, y));
+            return m_table.KeyAt(slot) == PixelKey::EMPTY ? nullptr : &m_values[slot];
+        }
+
+        bool Contains(int x, int y) const {
+            return m_table.KeyAt(m_table.Probe(PixelKey::Pack(x, y))) != PixelKey::EMPTY;
+        }
+
+        // Remove (x,y). Returns true if (x,y) was present.
+        bool Erase(int x, int y) {
+            const size_t hole = m_table.Erase(PixelKey::Pack(x, y), [this](size_t from, size_t to) { m_values[to] = std::move(m_values[from]); });
+            if (hole == PixelTable::NO_SLOT) {
+                return false;
+            }
+            m_values[hole] = Value();
+            return true;
+        }
+
+        // Call f(x, y, value) for every entry, in table order.
+        template <typename Function>
+        void ForEach(Function f) {
+            for (size_t i = 0; i < m_table.Capacity(); i++) {
+                const std::uint64_t key = m_table.KeyAt(i);
+                if (key != PixelKey::EMPTY) {
+                    f(PixelKey::X(key), PixelKey::Y(key), m_values[i]);
+                }
+            }
+        }
+};
+
+// A set of pixel coordinates: a PixelTable without values.
+class PixelSet {
+    private:
+        PixelTable m_table;
+
+    public:
+        PixelSet();
+
+        size_t Size() const;
+        bool Empty() const;
+        void Reserve(size_t count);
+        void Clear();
+        // Add (x,y). Returns true if it was not in the set before.
+        bool Insert(int x, int y);
+        bool Contains(int x, int y) const;
+        // Remove (x,y). Returns true if it was in the set.
+        bool Erase(int x, int y);
+        // Return all pixels, in table order.
+        std::vector<std::pair<int, int>> ToVector() const;
+
+        // Call f(x, y) for every pixel, in table order.
+        template <typename Function>
+        void ForEach(Function f) const {
+            for (size_t i = 0; i < m_table.Capacity(); i++) {
+                const std::uint64_t key = m_table.KeyAt(i);
+                if (key != PixelKey::EMPTY) {
+                    f(PixelKey::X(key), PixelKey::Y(key));
+                }
+            }
+        }
+};
+
+#endif
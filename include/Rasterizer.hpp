@@ -0,0 +1,38 @@
+/** 
+ *  @file   Rasterizer.hpp 
+ *  @brief  Anti-aliased CPU rasterizer interface
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef RASTERIZER_HPP
+#define RASTERIZER_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+// Include standard library C++ libraries.
+#include <cstddef>
+
+// Draws anti-aliased shapes into a RGBA8 pixel buffer on the CPU, so smooth strokes
+// do not need an OpenGL context with multisampling.
+class Rasterizer {
+
+    public:
+        // Thickest stroke the fixed point math is set up for.
+        static constexpr float MAX_THICKNESS = 200.0f;
+
+        // Draw a capsule (a line with round caps) from start to end, thickness pixels wide,
+        // alpha blended over the pixels. Returns the number of pixels it visited.
+        static size_t DrawCapsule(sf::Uint8* pixels, int width, int height, sf::Vector2f start, sf::Vector2f end, float thickness, sf::Color color);
+        static size_t DrawCapsule(sf::Image& image, sf::Vector2f start, sf::Vector2f end, float thickness, sf::Color color);
+        // The pixels DrawCapsule may write for the same capsule, not clipped to any image.
+        static sf::IntRect CapsuleBounds(sf::Vector2f start, sf::Vector2f end, float thickness);
+
+        // Write the coverage (0-255) of count pixels of one row into coverage. Pixel i is at
+        // fixed point (16.16) distance s0 + i*ds along the segment and c0 + i*dc across it.
+        static void CapsuleCoverage(sf::Uint8* coverage, int count, int s0, int ds, int c0, int dc, int length, float radius);
+};
+
+#endif
@@ -0,0 +1,45 @@
+/** 
+ *  @file   SpillFile.hpp 
+ *  @brief  Scratch file that undo history is spilled to
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef SPILLFILE_HPP
+#define SPILLFILE_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Config.hpp>
+// Include standard library C++ libraries.
+#include <cstddef>
+#include <cstdio>
+#include <vector>
+
+// An append-only temporary file. Blocks written to it are read back by offset.
+// The file is created on the first write and deleted by the OS when it is closed.
+class SpillFile {
+    private:
+        std::FILE* m_file;
+        size_t m_size;
+
+    public:
+        SpillFile();
+        ~SpillFile();
+
+        // Append bytes and return the offset they start at. Returns false if the
+        // scratch file can not be created or written.
+        bool Write(const std::vector<sf::Uint8>& bytes, size_t& offset);
+        // Read size bytes starting at offset.
+        bool Read(size_t offset, size_t size, std::vector<sf::Uint8>& bytes);
+        // Bytes written so far.
+        size_t GetSize() const;
+        // Drop every block and truncate the file, e.g. when the history is reset.
+        bool Clear();
+
+        // Delete the copy, copy assignment, move, and copy move assignment
+        SpillFile(const SpillFile& other) = delete;
+        SpillFile(SpillFile&& other) = delete;
+        SpillFile& operator=(const SpillFile& other) = delete;
+        SpillFile& operator=(SpillFile&& other) = delete;
+};
+
+#endif
@@ -0,0 +1,91 @@
+/** 
+ *  @file   SpscQueue.hpp 
+ *  @brief  Bounded lock-free single-producer/single-consumer queue
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef SPSCQUEUE_HPP
+#define SPSCQUEUE_HPP
+
+// Include standard library C++ libraries.
+#include <atomic>
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+// A ring buffer that one thread pushes to and one other thread pops from, without locks.
+// The producer only writes m_tail and the consumer only writes m_head, each publishing its
+// slot with a release store that the other side reads with an acquire load. Both keep a
+// cached copy of the other index, so the shared cache line is only read when the queue
+// looks full (producer) or empty (consumer).
+template <typename T>
+class SpscQueue {
+    private:
+        // Size of a cache line, so the two indices never share one.
+        static constexpr size_t CACHE_LINE = 64;
+
+        std::vector<T> m_slots;
+        size_t m_mask;
+        // Next slot to pop. Written by the consumer.
+        alignas(CACHE_LINE) std::atomic<size_t> m_head;
+        size_t m_cached_tail;
+        // Next slot to push. Written by the producer.
+        alignas(CACHE_LINE) std::atomic<size_t> m_tail;
+        size_t m_cached_head;
+
+    public:
+        // A queue of at least capacity items. The capacity is rounded up to a power of two.
+        explicit SpscQueue(size_t capacity) : m_head(0), m_cached_tail(0), m_tail(0), m_cached_head(0) {
+            size_t size = 2;
+            while (size < capacity) {
+                size *= 2;
+            }
+            m_slots.resize(size);
+            m_mask = size - 1;
+        }
+
+        // Delete the copy, copy assignment, move, and copy move assignment
+        SpscQueue(const SpscQueue& other) = delete;
+        SpscQueue(SpscQueue&& other) = delete;
+        SpscQueue& operator=(const SpscQueue& other) = delete;
+        SpscQueue& operator=(SpscQueue&& other) = delete;
+
+        // Producer: move item into the queue. Returns false, leaving item alone, if the queue is full.
+        bool TryPush(T& item) {
+            const size_t tail = m_tail.load(std::memory_order_relaxed);
+            if (tail - m_cached_head == m_slots.size()) {
+                m_cached_head = m_head.load(std::memory_order_acquire);
+                if (tail - m_cached_head == m_slots.size()) {
+                    return false;
+                }
+            }
+            m_slots[tail & m_mask] = std::move(item);
+            m_tail.store(tail + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Consumer: move the oldest item into item. Returns false if the queue is empty.
+        bool TryPop(T& item) {
+            const size_t head = m_head.load(std::memory_order_relaxed);
+            if (head == m_cached_tail) {
+                m_cached_tail = m_tail.load(std::memory_order_acquire);
+                if (head == m_cached_tail) {
+                    return false;
+                }
+            }
+            item = std::move(m_slots[head & m_mask]);
+            m_head.store(head + 1, std::memory_order_release);
+            return true;
+        }
+
+        // Number of items in the queue. Exact only when neither side is running.
+        size_t GetSize() const {
+            return m_tail.load(std::memory_order_acquire) - m_head.load(std::memory_order_acquire);
+        }
+
+        size_t GetCapacity() const {
+            return m_slots.size();
+        }
+};
+
+#endif
@@ -0,0 +1,87 @@
+/** 
+ *  @file   StrokeCodec.hpp 
+ *  @brief  Compact binary encoding of stroke line segments
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef STROKECODEC_HPP
+#define STROKECODEC_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Config.hpp>
+#include <SFML/Graphics/Color.hpp>
+// Include standard library C++ libraries.
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+// Project header files
+#include "RoundedLine.hpp"
+
+// Points and widths are fixed point with this many steps per pixel.
+constexpr float STROKE_FIXED_SCALE = 256.0f;
+
+// Line segments are encoded one after another, each as
+//     style flag (varint): 1 if the color, width or owner changed since the last segment
+//     color (varint of the packed RGBA), width (varint, 1/256 pixels), owner (zigzag varint), if the flag is 1
+//     start point minus the last end point, then end point minus start point (zigzag varints, 1/256 pixels)
+// The points are fixed point, so integer mouse positions are stored exactly. A stroke
+// keeps its style and its segments join end to start, so a segment of it takes about 5
+// bytes instead of the 28 of its floats. A stroke starts with BeginStroke(), which puts
+// down the count of its segments.
+class StrokeWriter {
+    private:
+        std::vector<sf::Uint8> m_bytes;
+        size_t m_count;
+        // End point of the last segment, and its style, which the next one is written against.
+        std::int64_t m_x;
+        std::int64_t m_y;
+        sf::Color m_color;
+        float m_width;
+        short m_owner;
+
+    public:
+        StrokeWriter();
+
+        // Encode the count of line segments of the stroke that the next count Write()s are.
+        void BeginStroke(size_t count);
+        // Encode one line segment.
+        void Write(const RoundedLine& line);
+        // Bytes encoded since the last Clear() or Reset().
+        const std::vector<sf::Uint8>& GetBytes() const;
+        // Line segments encoded since the last Clear() or Reset().
+        size_t GetCount() const;
+        // Drop the bytes once they are written somewhere. The next segment is still encoded
+        // against the last one, so a long stream can be written a chunk at a time.
+        void Clear();
+        // Start over, as if nothing was encoded.
+        void Reset();
+};
+
+// Decodes what a StrokeWriter encoded, from a buffer that may hold other data around it.
+class StrokeReader {
+    private:
+        const sf::Uint8* m_position;
+        const sf::Uint8* m_end;
+        size_t m_count;
+        std::int64_t m_x;
+        std::int64_t m_y;
+        sf::Uint32 m_color;
+        std::uint64_t m_width;
+        std::int64_t m_owner;
+
+    public:
+        // Read from the size bytes at data.
+        StrokeReader(const sf::Uint8* data, size_t size);
+
+        // Decode the next line segment. Returns false if the data is not one.
+        bool Read(std::unique_ptr<RoundedLine>& line);
+        // Decode the next stroke and append its line segments to lines. Returns false if the
+        // data is not one.
+        bool ReadStroke(std::vector<std::unique_ptr<RoundedLine>>& lines);
+        // The first byte not read yet.
+        const sf::Uint8* GetPosition() const;
+        bool AtEnd() const;
+};
+
+#endif
@@ -0,0 +1,149 @@
+/** 
+ *  @file   StrokePipeline.hpp 
+ *  @brief  Stroke tessellation and rasterization on worker threads
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef STROKEPIPELINE_HPP
+#define STROKEPIPELINE_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+#include <SFML/System/Vector2.hpp>
+// Include standard library C++ libraries.
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+// Project header files
+#include "Command.hpp"
+#include "RoundedLine.hpp"
+#include "SpscQueue.hpp"
+#include "ThreadPool.hpp"
+#include "TileDelta.hpp"
+
+// One item flowing through the pipeline. The UI thread fills in the input sample, the
+// tessellation stage adds the line segment and the raster stage adds what it painted.
+struct StrokeItem {
+    // A point of a stroke, the end of a stroke, or a bucket fill at point.
+    enum Kind { POINT, END, FILL };
+    Kind kind = POINT;
+    // Paint the stroke into the image instead of keeping its line segments.
+    bool raster = false;
+    // In canvas coordinates; the image is at origin of the canvas.
+    sf::Vector2f point;
+    sf::Vector2i origin;
+    float width = 0;
+    sf::Color color;
+    short owner = 0;
+    // POINT: a segment of the smoothed stroke up to point.
+    std::unique_ptr<RoundedLine> line;
+    // FILL: the lines on the canvas, which bound the fill like the strokes the user sees.
+    std::unique_ptr<std::vector<const RoundedLine*>> boundary;
+    // Pixels the raster stage changed.
+    sf::IntRect bounds;
+    // END of a raster stroke: its tile delta, FILL: the fill. nullptr if nothing changed.
+    std::unique_ptr<Command> command;
+    // END: number of segments in the stroke.
+    int lineCount = 0;
+};
+
+// Wakes a worker sleeping until another thread changes a queue it waits on. The worker
+// takes Peek() before it looks at its queues and, finding nothing to do, Wait()s for a
+// Ring() after that.
+class Doorbell {
+    private:
+        std::atomic<size_t> m_rings;
+        std::atomic<int> m_sleepers;
+        std::mutex m_mutex;
+        std::condition_variable m_rung;
+
+    public:
+        Doorbell();
+
+        // The number of rings so far.
+        size_t Peek() const;
+        // Wake the sleepers. Cheap while no one sleeps.
+        void Ring();
+        // Sleep until the number of rings is no longer seen.
+        void Wait(size_t seen);
+};
+
+// Three stages connected by bounded lock-free queues:
+//   1. input sampling, on the UI thread, which Submit()s mouse samples,
+//   2. smoothing and tessellation into RoundedLine segments, on its own worker,
+//   3. rasterization of raster strokes and fills into the image tiles, on its own worker.
+// The UI thread Collect()s the finished items and keeps the undo history, the texture
+// upload and the present to itself. The raster stage is the only writer of the image while
+// items are in flight; LockImage() keeps it out while the UI thread reads the image.
+class StrokePipeline {
+    private:
+        sf::Image& m_image;
+        ThreadPool* m_pool;
+        SpscQueue<StrokeItem> m_samples;
+        SpscQueue<StrokeItem> m_segments;
+        SpscQueue<StrokeItem> m_results;
+        // Held by the raster stage while it writes a segment or a fill.
+        std::mutex m_image_mutex;
+        // Rung for the tessellation stage by Submit() and by the raster stage taking a
+        // segment, and for the raster stage by new segments, Collect() and Resume().
+        Doorbell m_tessellator_bell;
+        Doorbell m_rasterizer_bell;
+        // Items submitted and collected by the UI thread, samples the tessellation stage
+        // dropped, and segments it added where a curve took more than one.
+        size_t m_submitted;
+        size_t m_collected;
+        std::atomic<size_t> m_dropped;
+        std::atomic<size_t> m_added;
+        // The raster stage waits after the end of a gesture until the UI thread has recorded
+        // it, so the image is not changed under the snapshot the gesture may take.
+        std::atomic<size_t> m_gestures_sent;
+        std::atomic<size_t> m_gestures_recorded;
+        std::atomic<bool> m_stopping;
+        std::thread m_tessellator;
+        std::thread m_rasterizer;
+
+        // Stage 2: turn samples into line segments.
+        void TessellateLoop();
+        // Stage 3: paint raster segments and fills into the image.
+        void RasterizeLoop();
+        // Move item into queue, waiting on bell while it is full. Returns false if the
+        // pipeline stops.
+        bool Push(SpscQueue<StrokeItem>& queue, StrokeItem& item, Doorbell& bell);
+        // Stage 2: pass item on to the raster stage and wake it.
+        bool PushSegment(StrokeItem& item);
+
+    public:
+        // Items each queue holds before the stage feeding it waits.
+        static constexpr size_t QUEUE_CAPACITY = 1024;
+
+        // Start the workers. Fills are split over pool, which may be nullptr.
+        StrokePipeline(sf::Image& image, ThreadPool* pool);
+        // Stop the workers. Items still in flight are dropped.
+        ~StrokePipeline();
+
+        // Delete the copy, copy assignment, move, and copy move assignment
+        StrokePipeline(const StrokePipeline& other) = delete;
+        StrokePipeline(StrokePipeline&& other) = delete;
+        StrokePipeline& operator=(const StrokePipeline& other) = delete;
+        StrokePipeline& operator=(StrokePipeline&& other) = delete;
+
+        // UI thread: queue an input item. Returns false, leaving item alone, if the first
+        // queue is full; Collect() and try again.
+        bool Submit(StrokeItem& item);
+        // UI thread: take the next finished item. Returns false if there is none yet.
+        bool Collect(StrokeItem& item);
+        // UI thread: let the raster stage go on after an END or a FILL was recorded.
+        void Resume();
+        // UI thread: true if every submitted item was collected.
+        bool IsIdle() const;
+        // Keep the raster stage from writing the image while the lock is held.
+        std::unique_lock<std::mutex> LockImage();
+};
+
+#endif
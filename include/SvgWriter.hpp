@@ -0,0 +1,72 @@
+/** 
+ *  @file   SvgWriter.hpp 
+ *  @brief  Streams strokes to an SVG file as round capped paths
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef SVGWRITER_HPP
+#define SVGWRITER_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/System/Vector2.hpp>
+// Include standard library C++ libraries.
+#include <cstddef>
+#include <cstdio>
+#include <string>
+// Project header files
+#include "RoundedLine.hpp"
+
+// Writes an SVG file front to back, one gesture at a time, without keeping a document
+// in memory: the text goes through a fixed size buffer that is written out whenever it
+// fills up, so a file of any size takes the same memory. Each gesture becomes one path
+// element of round capped, round joined polylines. A gesture whose line segments change
+// color, width or owner part way is split into one path per style, since a path has one.
+class SvgWriter {
+    private:
+        std::FILE* m_file;
+        std::string m_buffer;
+        size_t m_size;
+        bool m_failed;
+        // Style of the open path element, if any
+        bool m_in_path;
+        sf::Color m_color;
+        float m_width;
+        short m_owner;
+        // End point of the last line segment of the open path
+        sf::Vector2f m_end;
+
+        // Start a path element in the style of line.
+        void BeginPath(const RoundedLine& line);
+        void EndPath();
+        // Append a coordinate, with at most two decimals.
+        void AppendNumber(float value);
+        // Write the buffer out.
+        void Flush();
+
+    public:
+        // Bytes of text kept before they are written out.
+        static constexpr size_t BUFFER_SIZE = 64 * 1024;
+
+        SvgWriter();
+        // Close a file that was not finished.
+        ~SvgWriter();
+
+        // Delete the copy, copy assignment, move, and copy move assignment
+        SvgWriter(const SvgWriter& other) = delete;
+        SvgWriter(SvgWriter&& other) = delete;
+        SvgWriter& operator=(const SvgWriter& other) = delete;
+        SvgWriter& operator=(SvgWriter&& other) = delete;
+
+        // Start a width x height drawing at path, filled with background, of the part of the
+        // canvas from origin on.
+        bool Open(const std::string& path, int width, int height, sf::Color background = sf::Color::White, sf::Vector2i origin = sf::Vector2i());
+        // Write the count line segments at lines as the paths of one gesture.
+        void AddGesture(const RoundedLine* const* lines, size_t count);
+        // Close the drawing and the file. Returns false if anything could not be written.
+        bool Finish();
+        // Bytes written so far, the buffer included.
+        size_t GetSize() const;
+};
+
+#endif
@@ -0,0 +1,49 @@
+/** 
+ *  @file   ThreadPool.hpp 
+ *  @brief  Fixed size thread pool interface
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef THREADPOOL_HPP
+#define THREADPOOL_HPP
+
+// Include standard library C++ libraries.
+#include <condition_variable>
+#include <functional>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// A fixed number of worker threads that run submitted jobs in FIFO order.
+class ThreadPool {
+    private:
+        std::vector<std::thread> m_workers;
+        std::queue<std::function<void()>> m_jobs;
+        std::mutex m_mutex;
+        std::condition_variable m_job_ready;
+        bool m_stopping;
+
+        // Pop and run jobs until the pool is destroyed.
+        void WorkerLoop();
+
+    public:
+        // Start threadCount workers. A pool of 0 workers runs ParallelFor on the calling thread.
+        explicit ThreadPool(int threadCount);
+        // Finish the queued jobs and join the workers.
+        ~ThreadPool();
+
+        // Delete the copy, copy assignment, move, and copy move assignment
+        ThreadPool(const ThreadPool& other) = delete;
+        ThreadPool(ThreadPool&& other) = delete;
+        ThreadPool& operator=(const ThreadPool& other) = delete;
+        ThreadPool& operator=(ThreadPool&& other) = delete;
+
+        int  GetThreadCount() const;
+        // Queue a job for a worker and return immediately.
+        void Submit(std::function<void()> job);
+        // Run job(0) ... job(count-1) on the workers and the calling thread, and wait for all of them.
+        void ParallelFor(int count, const std::function<void(int)>& job);
+};
+
+#endif
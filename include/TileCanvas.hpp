@@ -0,0 +1,112 @@
+/** 
+ *  @file   TileCanvas.hpp 
+ *  @brief  Copy-on-write tiled canvas for cheap snapshots
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef TILECANVAS_HPP
+#define TILECANVAS_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Image.hpp>
+// Include standard library C++ libraries.
+#include <cstddef>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+// RGBA8 pixels stored as reference counted tiles of TILE_SIZE x TILE_SIZE. Copying a
+// TileCanvas is a snapshot: it copies the tile pointers, not the pixels. A tile shared
+// with a snapshot is duplicated only when one of them writes to it, so a snapshot costs
+// O(tiles) and memory only grows with the tiles that changed since.
+// Tiles are always TILE_SIZE pixels wide in memory; the edge tiles use part of it.
+// A tile that has not changed for a while can be swapped for a packed copy of it, made off
+// the UI thread by a TilePacker; reading or writing it unpacks it again in this canvas only.
+class TileCanvas {
+    public:
+        typedef std::vector<sf::Uint8> Tile;
+        // A tile kept compressed in memory: the one color of all its pixels, or their TileCodec bytes.
+        struct PackedTile {
+            bool uniform = false;
+            sf::Uint32 color = 0;
+            std::vector<sf::Uint8> encoded;
+        };
+
+    private:
+        // A tile is either its pixels or packed, never both.
+        struct Slot {
+            std::shared_ptr<Tile> pixels;
+            std::shared_ptr<const PackedTile> packed;
+        };
+
+        int m_width;
+        int m_height;
+        int m_tiles_x;
+        int m_tiles_y;
+        // Reading a packed tile unpacks it in place, so they change under const methods too.
+        mutable std::vector<Slot> m_tiles;
+        // Tiles to read again from the image on the next Sync().
+        std::vector<bool> m_dirty;
+
+    public:
+        // Tile edge length in pixels.
+        static constexpr int TILE_SIZE = 64;
+        // Bytes of one row of a tile.
+        static constexpr int TILE_STRIDE = TILE_SIZE * 4;
+
+        TileCanvas();
+        TileCanvas(int width, int height, sf::Color color);
+        // Make a width x height canvas of one color. All tiles share one buffer until written.
+        void Create(int width, int height, sf::Color color);
+
+        int GetWidth() const;
+        int GetHeight() const;
+        int GetTilesX() const;
+        int GetTileCount() const;
+        // Index of the tile that holds pixel (x,y).
+        int GetTileIndex(int x, int y) const;
+        // Width and height of the part of a tile on the canvas.
+        int GetTileWidth(int tile) const;
+        int GetTileHeight(int tile) const;
+
+        sf::Color GetPixel(int x, int y) const;
+        void SetPixel(int x, int y, sf::Color color);
+        // Read only pixels of a tile, rows TILE_STRIDE bytes apart. Unpacks the tile first if it is packed.
+        const sf::Uint8* GetTile(int tile) const;
+        // Writable pixels of a tile. Duplicates the tile first if it is shared.
+        sf::Uint8* GetMutableTile(int tile);
+
+        // Mark the tiles overlapping [x0, x1] x [y0, y1] as changed in the image Sync() reads.
+        void MarkDirty(int x0, int y0, int x1, int y1);
+        // Copy the dirty tiles from image, which must have the same size. Returns the number of tiles copied.
+        size_t Sync(const sf::Image& image);
+        // Follow an image whose pixels moved by (-dx, -dy) whole tiles: tile (tx,ty) takes the
+        // buffer of tile (tx+dx, ty+dy). Tiles with no full buffer to take are marked dirty.
+        void Shift(int dx, int dy);
+        // Copy all pixels into image, resizing it to fit.
+        void CopyToImage(sf::Image& image) const;
+
+        // True if tile is the same buffer in both canvases.
+        bool SharesTile(const TileCanvas& other, int tile) const;
+        // Number of distinct tile buffers, e.g. to see how much memory snapshots really cost.
+        size_t GetBufferCount() const;
+
+        // The pixel buffer of tile, or nullptr if it is packed.
+        std::shared_ptr<const Tile> GetPixelBuffer(int tile) const;
+        bool IsPacked(int tile) const;
+        // Swap every tile whose pixel buffer is a key of packed for its packed tile. Returns the
+        // number of tiles swapped.
+        size_t ReplacePacked(const std::unordered_map<const Tile*, std::shared_ptr<const PackedTile>>& packed);
+        // Bytes of the pixel buffers and packed tiles of the canvas not in counted yet, which
+        // they are added to, so buffers shared by several canvases are counted once.
+        size_t CountBytes(std::unordered_set<const void*>& counted) const;
+
+        // Pack width x height pixels, rows TILE_STRIDE bytes apart.
+        static std::shared_ptr<const PackedTile> Pack(const sf::Uint8* pixels, int width, int height);
+        // Unpack a tile into width x height pixels, rows stride bytes apart.
+        static bool Unpack(const PackedTile& packed, sf::Uint8* pixels, size_t stride, int width, int height);
+};
+
+#endif
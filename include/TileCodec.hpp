@@ -0,0 +1,30 @@
+/** 
+ *  @file   TileCodec.hpp 
+ *  @brief  Run-length codec for canvas tiles
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef TILECODEC_HPP
+#define TILECODEC_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Config.hpp>
+// Include standard library C++ libraries.
+#include <cstddef>
+#include <vector>
+
+// Compresses a rectangle of RGBA8 pixels on its own, so every tile of a document can be
+// decoded without the others. The pixels are read row after row as one sequence of
+// 32-bit values and written as tokens, each a varint (count << 1 | kind) followed by
+// one value for a run of count equal pixels, or by count literal pixels. Canvas tiles are
+// mostly background and flat paint, so a one color tile is a single 5 to 8 byte token.
+class TileCodec {
+    public:
+        // Append the width x height pixels at pixels, rows stride bytes apart, to out.
+        static void Encode(const sf::Uint8* pixels, size_t stride, int width, int height, std::vector<sf::Uint8>& out);
+        // Decode size bytes of Encode() output into width x height pixels at pixels, rows
+        // stride bytes apart. Returns false if the data is not a tile of that size.
+        static bool Decode(const sf::Uint8* data, size_t size, sf::Uint8* pixels, size_t stride, int width, int height);
+};
+
+#endif
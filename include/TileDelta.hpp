@@ -0,0 +1,76 @@
+/** 
+ *  @file   TileDelta.hpp 
+ *  @brief  Undo a raster gesture with compressed per-tile deltas.
+ *  @author Dennis Ping 
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef TILEDELTA_HPP
+#define TILEDELTA_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics/Image.hpp>
+// Include standard library C++ libraries.
+#include <cstddef>
+#include <string>
+#include <vector>
+// Project header files
+#include "Command.hpp"
+
+// One undoable raster gesture (e.g. a paintbrush stroke painted into the image).
+// While the gesture is painted, touch() saves each tile the first time it is about
+// to change. execute() then keeps only the XOR of the tiles before and after, run-length
+// encoded. Unchanged pixels XOR to 0 and a solid paint XORs to one value, so the delta
+// is about as big as the compressed change. The same delta XORed in again turns
+// after into before (undo) and before into after (redo), so both are tile blits.
+class TileDelta : public Command {
+    private:
+        // Delta of one tile, stored at offset in m_data.
+        struct TileRecord {
+            int tile;
+            size_t offset;
+        };
+
+        int m_tilesX;
+        int m_tilesY;
+        // While recording: index into m_before of each tile, or -1 if it is untouched.
+        std::vector<int> m_slots;
+        // While recording: the tile index and the pixels of each touched tile before the gesture.
+        std::vector<std::pair<int, std::vector<sf::Uint32>>> m_before;
+        // The compressed deltas.
+        std::vector<TileRecord> m_tiles;
+        std::vector<sf::Uint8> m_data;
+        // Bounding box of the changed tiles, which is kept while they are spilled.
+        sf::IntRect m_bounds;
+
+        // Pixel rectangle of a tile, clipped to the image.
+        void tileRect(int tile, int& x0, int& y0, int& width, int& height) const;
+        // XOR the delta of one tile into image. Returns false on truncated or corrupt data.
+        bool apply(const TileRecord& record, sf::Image& image) const;
+
+    public:
+        // Tile edge length in pixels.
+        static constexpr int TILE_SIZE = 64;
+
+        // Record a gesture on image. Call touch() before each write, then execute().
+        TileDelta(sf::Image& image);
+        ~TileDelta();
+        // Save the tiles overlapping the pixel rectangle [x0, x1] x [y0, y1] that were not saved yet.
+        void touch(int x0, int y0, int x1, int y1);
+        // Stop recording and compress the changed tiles. Returns false if nothing changed.
+        bool execute() override;
+        bool undo() override;
+        bool redo() override;
+        bool redoInto(sf::Image& image) const override;
+        std::pair<int, int> getCoords() override;
+        std::string getDescription() override;
+        // Number of tiles the gesture changed.
+        size_t getTileCount() const;
+        // Bytes the recorded delta takes.
+        size_t getByteSize() const override;
+        // The delta is already compressed, so spilling writes it out as is.
+        bool spill(std::vector<sf::Uint8>& bytes) override;
+        bool restore(const std::vector<sf::Uint8>& bytes) override;
+        sf::IntRect getBounds() const override;
+};
+
+#endif
@@ -0,0 +1,82 @@
+/** 
+ *  @file   TilePacker.hpp 
+ *  @brief  Packs cold canvas tiles in memory on a background thread
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef TILEPACKER_HPP
+#define TILEPACKER_HPP
+
+// Include standard library C++ libraries.
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+// Project header files
+#include "TileCanvas.hpp"
+
+// Packs the pixel buffers of TileCanvas tiles on a worker thread, so the tiles of snapshots
+// that have not changed for a while cost the bytes of their TileCodec encoding, or nothing
+// but their color if they are of one color, instead of TILE_SIZE * TILE_STRIDE bytes each.
+// The buffers handed over are shared and so never written again; the UI thread collects the
+// packed tiles and swaps them into its canvases with TileCanvas::ReplacePacked().
+class TilePacker {
+    public:
+        // A tile to pack, width x height of it on the canvas.
+        struct Job {
+            std::shared_ptr<const TileCanvas::Tile> pixels;
+            int width = 0;
+            int height = 0;
+        };
+        // A packed tile, and the buffer it was packed from, which it holds on to so no other
+        // buffer can take its address before the result is collected.
+        struct Result {
+            std::shared_ptr<const TileCanvas::Tile> pixels;
+            std::shared_ptr<const TileCanvas::PackedTile> packed;
+        };
+
+    private:
+        // Guards every member below.
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_idle;
+        std::deque<Job> m_jobs;
+        std::vector<Result> m_results;
+        bool m_packing;
+        bool m_stopping;
+        size_t m_packed_count;
+        size_t m_packed_bytes;
+        std::thread m_worker;
+
+        // Pack the queued tiles in order, until the packer is destroyed.
+        void WorkerLoop();
+
+    public:
+        // Start the worker.
+        TilePacker();
+        // Stop the worker, dropping the tiles not packed yet.
+        ~TilePacker();
+
+        // Delete the copy, copy assignment, move, and copy move assignment
+        TilePacker(const TilePacker& other) = delete;
+        TilePacker(TilePacker&& other) = delete;
+        TilePacker& operator=(const TilePacker& other) = delete;
+        TilePacker& operator=(TilePacker&& other) = delete;
+
+        // Queue jobs for the worker, emptying jobs.
+        void Pack(std::vector<Job>& jobs);
+        // Move the tiles packed since the last call to results. Returns how many there were.
+        size_t Collect(std::vector<Result>& results);
+        // True while tiles wait or are packed.
+        bool IsBusy();
+        // Wait until every queued tile is packed.
+        void Wait();
+        // Tiles packed since the packer was made, and the bytes they were packed to.
+        size_t GetPackedCount();
+        size_t GetPackedBytes();
+};
+
+#endif
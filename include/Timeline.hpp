@@ -0,0 +1,95 @@
+/** 
+ *  @file   Timeline.hpp 
+ *  @brief  Renders past states of the canvas on a worker thread for timeline scrubbing
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef TIMELINE_HPP
+#define TIMELINE_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Config.hpp>
+#include <SFML/Graphics/Image.hpp>
+// Include standard library C++ libraries.
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+// Project header files
+#include "Command.hpp"
+#include "TileCanvas.hpp"
+
+// Renders the image as it looked after any gesture of the history, for a timeline slider.
+// The UI thread Request()s a frame: the nearest keyframe (a checkpoint of the image) and the
+// raster commands to redo over it. A worker thread renders it into an image of its own, so
+// the UI thread only ever waits to swap finished images. Line segments are not rendered;
+// the frame hands their ranges back with the image, for the GPU to draw over it like it does
+// over the canvas. A request replaces one that has not started yet and cancels the one being
+// rendered, so dragging the slider only renders the positions it stops at.
+class Timeline {
+    public:
+        // Everything the worker needs to render the image after one gesture. The commands
+        // belong to the history, which must keep them alive and not spill them while IsBusy().
+        struct Frame {
+            sf::Uint32 gesture = 0;
+            TileCanvas keyframe;
+            // Raster commands from the keyframe to the gesture, in the order to redo them.
+            std::vector<const Command*> commands;
+            // Line segment ranges [first, second) of the strokes from the root to the gesture,
+            // in drawing order.
+            std::vector<std::pair<size_t, size_t>> strokes;
+        };
+
+    private:
+        // Guards every member below except m_cancel.
+        std::mutex m_mutex;
+        std::condition_variable m_wake;
+        std::condition_variable m_idle;
+        // The newest request that the worker has not started yet
+        std::unique_ptr<Frame> m_pending;
+        // The newest finished image, its gesture and strokes, until Collect() takes them
+        std::unique_ptr<sf::Image> m_result;
+        sf::Uint32 m_result_gesture;
+        std::vector<std::pair<size_t, size_t>> m_result_strokes;
+        bool m_has_result;
+        bool m_rendering;
+        bool m_stopping;
+        // Set by a request that comes in while a frame is rendered
+        std::atomic<bool> m_cancel;
+        std::thread m_worker;
+
+        // Render the newest request, until the timeline is destroyed.
+        void WorkerLoop();
+
+    public:
+        // Start the worker.
+        Timeline();
+        // Stop the worker, dropping any request not rendered yet.
+        ~Timeline();
+
+        // Delete the copy, copy assignment, move, and copy move assignment
+        Timeline(const Timeline& other) = delete;
+        Timeline(Timeline&& other) = delete;
+        Timeline& operator=(const Timeline& other) = delete;
+        Timeline& operator=(Timeline&& other) = delete;
+
+        // Render frame instead of whatever was requested before.
+        void Request(std::unique_ptr<Frame> frame);
+        // Swap the newest finished image into image, and its gesture and strokes into gesture
+        // and strokes. The old image is reused for a later render. Returns false if nothing
+        // finished since the last call.
+        bool Collect(std::unique_ptr<sf::Image>& image, sf::Uint32& gesture, std::vector<std::pair<size_t, size_t>>& strokes);
+        // True while a request waits or is rendered.
+        bool IsBusy();
+        // Wait until every request is rendered or cancelled.
+        void Wait();
+
+        // Render frame into image. Returns false if cancel was set before it finished.
+        static bool Render(const Frame& frame, sf::Image& image, const std::atomic<bool>* cancel = nullptr);
+};
+
+#endif
@@ -0,0 +1,77 @@
+/** 
+ *  @file   Varint.hpp 
+ *  @brief  Variable length integer encoding for compact binary records
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef VARINT_HPP
+#define VARINT_HPP
+
+// Include standard library C++ libraries.
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+// LEB128 varints: 7 bits per byte, low bits first, high bit set on every byte but the last.
+// Small numbers take 1 byte. Signed values are zigzag mapped first so small negative
+// numbers stay small too. The Get functions return false instead of reading past end.
+namespace Varint {
+    inline void Put(std::vector<std::uint8_t>& out, std::uint64_t value) {
+        while (value >= 0x80) {
+            out.push_back((std::uint8_t)(value | 0x80));
+            value >>= 7;
+        }
+        out.push_back((std::uint8_t)value);
+    }
+
+    inline bool Get(const std::uint8_t*& p, const std::uint8_t* end, std::uint64_t& value) {
+        value = 0;
+        for (int shift = 0; p < end && shift < 64; shift += 7) {
+            const std::uint8_t byte = *p++;
+            value |= (std::uint64_t)(byte & 0x7F) << shift;
+            if ((byte & 0x80) == 0) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    inline std::uint64_t ZigZag(std::int64_t value) {
+        return ((std::uint64_t)value << 1) ^ (std::uint64_t)(value >> 63);
+    }
+
+    inline std::int64_t UnZigZag(std::uint64_t value) {
+        return (std::int64_t)(value >> 1) ^ -(std::int64_t)(value & 1);
+    }
+
+    inline void PutSigned(std::vector<std::uint8_t>& out, std::int64_t value) {
+        Put(out, ZigZag(value));
+    }
+
+    inline bool GetSigned(const std::uint8_t*& p, const std::uint8_t* end, std::int64_t& value) {
+        std::uint64_t raw;
+        if (!Get(p, end, raw)) {
+            return false;
+        }
+        value = UnZigZag(raw);
+        return true;
+    }
+
+    // Fixed 4 bytes, in memory order, for values that do not shrink (e.g. packed pixels).
+    inline void PutUint32(std::vector<std::uint8_t>& out, std::uint32_t value) {
+        std::uint8_t bytes[4];
+        std::memcpy(bytes, &value, sizeof(value));
+        out.insert(out.end(), bytes, bytes + 4);
+    }
+
+    inline bool GetUint32(const std::uint8_t*& p, const std::uint8_t* end, std::uint32_t& value) {
+        if (end - p < 4) {
+            return false;
+        }
+        std::memcpy(&value, p, sizeof(value));
+        p += 4;
+        return true;
+    }
+}
+
+#endif
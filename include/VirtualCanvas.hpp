@@ -0,0 +1,90 @@
+/** 
+ *  @file   VirtualCanvas.hpp 
+ *  @brief  Tiled store of a canvas larger than the image in memory
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+#ifndef VIRTUALCANVAS_HPP
+#define VIRTUALCANVAS_HPP
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics/Color.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Rect.hpp>
+// Include standard library C++ libraries.
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+// Project header files
+#include "Document.hpp"
+#include "TileCanvas.hpp"
+
+// The pixels of a canvas of any size, as TILE_SIZE x TILE_SIZE tiles. Only the part of the
+// canvas being edited and shown is decoded, into an image the App keeps; the rest lives
+// here. A tile that was written back is kept compressed with TileCodec; one that never was
+// is read from the document the canvas was opened from, or is the background color. So a
+// canvas costs memory for the tiles that were edited, not for its size.
+class VirtualCanvas {
+    private:
+        int m_width;
+        int m_height;
+        int m_tiles_x;
+        int m_tiles_y;
+        sf::Color m_background;
+        // Tiles that were never written come from here, if it is not nullptr
+        Document* m_document;
+        // Tiles written back, compressed
+        std::unordered_map<int, std::vector<sf::Uint8>> m_pages;
+        size_t m_page_bytes;
+        std::vector<sf::Uint8> m_scratch;
+        std::vector<sf::Uint8> m_encoded;
+
+    public:
+        // Tile edge length in pixels, the same as the document tiles.
+        static constexpr int TILE_SIZE = TileCanvas::TILE_SIZE;
+
+        VirtualCanvas();
+
+        // Delete the copy, copy assignment, move, and copy move assignment
+        VirtualCanvas(const VirtualCanvas& other) = delete;
+        VirtualCanvas(VirtualCanvas&& other) = delete;
+        VirtualCanvas& operator=(const VirtualCanvas& other) = delete;
+        VirtualCanvas& operator=(VirtualCanvas&& other) = delete;
+
+        // Make a width x height canvas of background, or of the tiles of document, which must
+        // be open and of that size and stay open while the canvas uses it.
+        void Create(int width, int height, sf::Color background, Document* document = nullptr);
+        int GetWidth() const;
+        int GetHeight() const;
+        int GetTilesX() const;
+        int GetTileCount() const;
+        sf::Color GetBackground() const;
+        // Pixel rectangle of a tile, clipped to the canvas.
+        sf::IntRect GetTileRect(int tile) const;
+
+        // Decode a tile into pixels, rows stride bytes apart. Returns false if its document tile
+        // can not be read.
+        bool ReadTile(int tile, sf::Uint8* pixels, size_t stride);
+        // Compress a tile from pixels, rows stride bytes apart, and keep it.
+        void WriteTile(int tile, const sf::Uint8* pixels, size_t stride);
+        // Point data at the compressed bytes of a written tile or of its document tile. Returns
+        // false for a tile of the background.
+        bool GetEncodedTile(int tile, const sf::Uint8*& data, size_t& size) const;
+        // Keep size bytes of TileCodec output as a tile, without decoding them.
+        void WriteEncodedTile(int tile, const sf::Uint8* data, size_t size);
+        // Indices of the tiles written, in no order.
+        void GetPageTiles(std::vector<int>& tiles) const;
+
+        // Read the canvas under area of image, with image put at (left,top) of the canvas.
+        // Pixels of area outside the canvas are the background.
+        bool Read(int left, int top, sf::Image& image, const sf::IntRect& area);
+        // Write back every tile of the canvas that overlaps one of areas of image, put at
+        // (left,top) of the canvas. The whole part of such a tile under image is written.
+        bool Write(int left, int top, const sf::Image& image, const std::vector<sf::IntRect>& areas);
+
+        // Number and compressed size of the tiles written.
+        size_t GetPageCount() const;
+        size_t GetPageBytes() const;
+};
+
+#endif
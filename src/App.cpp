@@ -1,392 +1,3158 @@
-/** 
- *  @file   App.cpp 
- *  @brief  Main class for program
- *  @author Mike and Dennis Ping
- *  @date   2021-11-13
- ***********************************************/
-
-// Include our Third-Party SFML header
-#include <SFML/Graphics.hpp>
-#include <SFML/Graphics/Image.hpp>
-#include <SFML/Graphics/Texture.hpp>
-#include <SFML/Graphics/Sprite.hpp>
-#include <SFML/Window.hpp>
-// Include standard library C++ libraries.
-#include <cassert>
-#include <iostream>
-#include <string>
-#include <queue>
-// Project header files
-#include "App.hpp"
-// #include "Draw.hpp"
-#include "MathUtility.hpp"
-
-/*! \brief  App constructor
-*		
-*/
-App::App() {
-    // Canvas variables
-    m_window = nullptr;
-    m_image = new sf::Image;
-    m_sprite = new sf::Sprite;
-    m_texture = new sf::Texture;
-    m_current_color = new sf::Color;
-    m_paintbrush_radius = nullptr;
-    m_cursor_sprite = new sf::Sprite;
-    m_cursor_texture = new sf::RenderTexture;
-    m_cursor_circle = new sf::CircleShape(5);
-    m_circle_template = new std::vector<std::pair<int,int>>;
-    m_prev_point = nullptr;
-    m_render_texture = new sf::RenderTexture;
-    m_render_sprite = new sf::Sprite;
-    m_draw_vector = new std::vector<std::unique_ptr<RoundedLine>>;
-
-    // Color code member variable
-    color_codes = {
-        {sf::Keyboard::Num1, sf::Color::Black},
-        {sf::Keyboard::Num2, sf::Color::White},
-        {sf::Keyboard::Num3, sf::Color::Red},
-        {sf::Keyboard::Num4, sf::Color::Green},
-        {sf::Keyboard::Num5, sf::Color::Blue},
-        {sf::Keyboard::Num6, sf::Color::Yellow},
-        {sf::Keyboard::Num7, sf::Color::Magenta},
-        {sf::Keyboard::Num8, sf::Color::Cyan}
-    };
-    
-    
-}
-
-App::~App(){}
-
-/*! \brief  Clear the redo stack.
-*		
-*/
-void App::ClearRedo() {
-    int clearCount = 0;
-    while(!m_redo.empty()) {
-        clearCount++;
-        m_redo.pop();
-    }
-    while (!m_redo_count.empty()) {
-        m_redo_count.pop();
-    }
-    if (clearCount > 0) {
-        std::cout << "Cleared " << clearCount << " from the redo stack" << std::endl;
-    }
-}
-
-/*! \brief 	Add new commands to queue for execution.
-*		
-*/
-// void App::AddCommand(std::unique_ptr<Command> c) {
-//     m_commands.push(std::move(c));
-// }
-void App::AddCommand(std::unique_ptr<RoundedLine> c) {
-    m_commands.push(std::move(c));
-}
-
-/*! \brief  Execute commands from the m_command stack.
-*           Push executed commands to the undo stack.
-*           Clear the redo stack.
-*/
-int App::ExecuteCommand() {
-    int successCount = 0;
-    while (!m_commands.empty()) {
-        // bool success = m_commands.front() -> execute(*m_render_texture);
-        // if (success) {
-        //     m_undo.push(std::move(m_commands.front()));
-        //     successCount++;
-        // } 
-        m_draw_vector->push_back(std::move(m_commands.front()));
-        m_commands.pop();
-        successCount++;
-    }
-    ClearRedo();
-    return successCount;
-}
-
-/*! \brief  Look at the m_undo_count stack to determine how many Draw commands
-*           to undo. The opposite logic of the RedoCommand().
-*/
-int App::UndoCommand() {
-    // Need this if statement so we don't undo "nothing"
-    int numUndo = 0;
-    if (!m_undo_count.empty()) {
-        numUndo = m_undo_count.top();
-        std::cout << "Undoing: " << numUndo << " lines" << std::endl;
-        // for (int i = 0; i < m_undo_count.top(); i++) {
-        //     m_undo.top() -> undo(*m_render_texture);
-        //     m_redo.push(std::move(m_undo.top()));
-        //     m_undo.pop();
-        // }
-        for (int i = 0; i < numUndo; i++) {
-            m_redo.push(std::move(m_draw_vector->back()));
-            m_draw_vector->pop_back();
-        }
-        m_redo_count.push(m_undo_count.top());
-        m_undo_count.pop();
-    }
-    else {
-        std::cout << "There is nothing to undo" << std::endl;
-    }
-    return numUndo;
-}
-
-/*! \brief  Look at the m_redo_count stack to determine how many Draw commands
-*           to redo. The opposite logic of the UndoCommand().
-*/
-int App::RedoCommand() {
-    // Need this if statement so we don't redo "nothing"
-    int numRedo = 0;
-    if (!m_redo_count.empty()) {
-        numRedo = m_redo_count.top();
-        std::cout << "Redoing: " << numRedo << " lines" << std::endl;
-        // for (int i = 0; i < m_redo_count.top(); i++) {
-        //     m_redo.top() -> redo(*m_render_texture);
-        //     m_undo.push(std::move(m_redo.top()));
-        //     m_redo.pop();
-        // }
-        for (int i = 0; i < numRedo; i++) {
-            m_draw_vector->push_back(std::move(m_redo.top()));
-            m_redo.pop();
-        }
-        m_undo_count.push(m_redo_count.top());
-        m_redo_count.pop();
-    }
-    else {
-        std::cout << "There is nothing to redo" << std::endl;
-    }
-    return numRedo;
-}
-
-/*! \brief  Return a reference to our m_image, so that
-*           we do not have to publicly expose it.
-*		
-*/
-sf::Image& App::GetImage(){
-    return *m_image;
-}
-
-/*! \brief  Return a reference to our m_Texture so that
-*           we do not have to publicly expose it.
-*		
-*/
-sf::Texture& App::GetTexture(){
-    return *m_texture;
-}
-
-/*! \brief  Return a reference to our m_window
-*		
-*/
-sf::RenderWindow& App::GetWindow(){
-    return *m_window;
-}
-
-/*! \brief  Return a reference to our m_sprite
-*
-*/
-sf::Sprite& App::GetSprite(){
-    return *m_sprite;
-}
-
-sf::RenderTexture& App::GetRenderTexture(){
-    return *m_render_texture;
-}
-
-sf::Sprite& App::GetRenderSprite(){
-    return *m_render_sprite;
-}
-
-/*! \brief  Return a reference to our m_current_color
-*/
-sf::Color& App::GetPaintbrushColor() {
-    return *m_current_color;
-}
-
-/*! \brief  Set the m_current_color to the newColor
-*
-*/
-void App::SetPaintbrushColor(sf::Keyboard::Key numKey) {
-    *m_current_color = color_codes[numKey];
-}
-
-/*! \brief  Return a reference to our m_paintbrush_radius
-*
-*/
-int& App::GetPaintbrushRadius(){
-    return *m_paintbrush_radius;
-}
-
-/*! \brief  Set the m_paintbrush_radius to the new radius.
-*
-*/
-void App::SetPaintbrushRadius(int radius){
-    *m_paintbrush_radius = radius;
-}
-
-/*! \brief  Set the sprite cursor position on the window and apply an offset because
-*           the pointer tip is not exactly in the center of the cursor.
-*/
-void App::SetCursorPosition(const int &x, const int &y) {
-    m_cursor_sprite->setPosition(x - *m_paintbrush_radius, y - *m_paintbrush_radius);
-}
-
-/*! \brief  Generate a new cursor if the paintbrush radius or color is changed.
-*		
-*/
-void App::GenerateCursor(int radius, sf::Color paintbrush_color) {
-    radius += 1;
-    // Build our circle shape
-    m_cursor_circle -> setRadius(radius);
-    m_cursor_circle -> setFillColor(paintbrush_color);
-    m_cursor_circle -> setPointCount(4*radius);
-    if (paintbrush_color == sf::Color::Black || paintbrush_color == sf::Color::Blue) {
-        m_cursor_circle -> setOutlineColor(sf::Color::White);
-    }
-    else {
-        m_cursor_circle -> setOutlineColor(sf::Color::Black);
-    }
-    m_cursor_circle -> setOutlineThickness(-1);
-
-    // Create the cursor texture and draw our circle shape on it
-    m_cursor_texture -> create((radius)*2, (radius)*2);
-    m_cursor_texture -> clear(sf::Color::Transparent);
-    //m_cursor_texture -> setSmooth(true);
-    m_cursor_texture -> draw(*m_cursor_circle);
-    m_cursor_sprite -> setTexture(m_cursor_texture -> getTexture(), true);
-}
-
-/*! \brief  Generate and cache a circle template for drawing.
-*
-*/
-void App::GenerateCircleTemplate(int radius) {
-    *m_circle_template = MathUtility::BresenhamCircleAlgo(radius);
-}
-
-/*! \brief  A cached circle template generated at (0,0) which is shifted by (x,y) 
-*           rather than constantly computing the same circle.
-*/
-std::vector<std::pair<int,int>> App::UseCircleTemplate(int x, int y) {
-	std::vector<std::pair<int,int>> transformedCircle;
-    // Reserve memory in vector to get 4x performance: https://github.com/facontidavide/CPP_Optimizations_Diary/blob/master/docs/reserve.md 
-    transformedCircle.reserve((m_circle_template->size()*8));
-    // Use std::transform to shift the circle template by (x,y)
-    std::transform(m_circle_template->begin(), m_circle_template->end(), std::back_inserter(transformedCircle),
-    	[x,y](std::pair<int,int> p) {
-    		return std::make_pair(p.first + x, p.second + y);
-    	});
-    return transformedCircle;
-}
-
-/*! \brief 	Destroy all raw pointers before ending the program.
-*		
-*/
-void App::Destroy(){
-    delete m_prev_point;
-    delete m_render_texture;
-    delete m_render_sprite;
-    delete m_current_color;
-    delete m_paintbrush_radius;
-    delete m_cursor_sprite;
-    delete m_cursor_texture;
-    delete m_cursor_circle;
-    delete m_circle_template;
-    delete m_image;
-    delete m_sprite;
-    delete m_texture;
-    delete m_window;
-}
-
-/*! \brief  Initializes the App and sets up the main
-*           rendering window(i.e. our canvas.)
-*/
-void App::Init(void (*initFunction)(void)){
-    // Create our window
-    int width = 1280;
-    int height = 720;
-    sf::ContextSettings settings;
-    settings.antialiasingLevel = 16;
-    m_window = new sf::RenderWindow(sf::VideoMode(width,height),"Mini-Paint alpha 0.0.3",sf::Style::Titlebar | sf::Style::Close, settings);
-    //m_window -> clear(sf::Color::White);
-    m_window -> setFramerateLimit(60);
-    m_window -> setVerticalSyncEnabled(true);
-    // Set the mouse cursor to be invisible because we are going to draw our own cursor
-    m_window->setMouseCursorVisible(false);
-    // Create an image which stores the pixels we will update
-    m_image->create(width, height, sf::Color::White);
-    assert(m_image != nullptr && "m_image != nullptr");
-    // Create a texture which lives in the GPU and will render our image
-    m_texture->loadFromImage(*m_image);
-    assert(m_texture != nullptr && "m_texture != nullptr");
-    // // Create a sprite which is the entity that can be textured
-    m_sprite->setTexture(*m_texture);
-    assert(m_sprite != nullptr && "m_sprite != nullptr");
-    m_render_texture->create(width, height);
-    m_render_texture->clear(sf::Color::White);
-    m_render_sprite->setTextureRect(sf::IntRect(0, height, width, -height));
-    // Initialize current color = black
-    SetPaintbrushColor(sf::Keyboard::Num0);
-    // Initialize the cursor radius
-    m_paintbrush_radius = new int(5);
-    // Generate the cursor with current color = black
-    GenerateCursor(*m_paintbrush_radius, sf::Color::Black);
-    // Set the cursor initial position to off screen so it doesn't momentarily appear
-    int x = -10;
-    int y = -10;
-    SetCursorPosition(x, y);
-    GenerateCircleTemplate(5);
-    m_initFunc = initFunction;
-}
-
-/*! \brief  Set a callback function which will be called
-*           each iteration of the main loop before drawing.
-*		
-*/
-void App::UpdateCallback(void (*updateFunction)(App& myApp)){
-    m_updateFunc = updateFunction;
-}
-
-/*! \brief  Set a callback function which will be called
-*           each iteration of the main loop after update.
-*		
-*/
-void App::DrawCallback(void (*drawFunction)(App& myApp)){
-    m_drawFunc = drawFunction;
-}
-
-/*! \brief 	The main loop function which handles initialization
-            and will be executed until the main window is closed.
-            Within the loop function the update and draw callback
-            functions will be called.
-*		
-*/
-void App::Loop(App& myApp){
-    // Call the init function
-    m_initFunc();
-
-    // Start the main rendering loop
-    while(m_window->isOpen()){
-        // Clear the window
-        m_window->clear(sf::Color::White);
-        // Updates specified by the user
-        m_updateFunc(myApp);
-        // Additional drawing specified by user
-        m_drawFunc(myApp);
-        // Update the texture
-        // Note: This can be done in the 'draw call'
-        // Draw to the canvas
-        // m_window->draw(*m_render_sprite);
-        //m_window->draw(*m_sprite);
-        
-        // Iterate through m_draw_vector and draw each line
-        for (auto& line : *m_draw_vector) {
-            m_window->draw(*line);
-        }
-
-        m_window->draw(*m_cursor_sprite);
-        // Display the canvas
-        m_window->display();
-    }
-}
-
-
+/** 
+ *  @file   App.cpp 
+ *  @brief  Main class for program
+ *  @author Mike and Dennis Ping
+ *  @date   2021-11-13
+ ***********************************************/
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+#include <SFML/Window.hpp>
+// Include standard library C++ libraries.
+#include <algorithm>
+#include <cassert>
+#include <chrono>
+#include <climits>
+#include <cmath>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <queue>
+// Project header files
+#include "App.hpp"
+// #include "Draw.hpp"
+#include "MathUtility.hpp"
+#include "TileCodec.hpp"
+#include "Varint.hpp"
+
+namespace {
+
+// Bytes of encoded strokes a document save writes at a time.
+const size_t STROKE_CHUNK_SIZE = 1 << 20;
+
+sf::Color UnpackColor(sf::Uint32 packed) {
+    sf::Uint8 rgba[4];
+    std::memcpy(rgba, &packed, sizeof(packed));
+    return sf::Color(rgba[0], rgba[1], rgba[2], rgba[3]);
+}
+
+// Bytes a line segment of the history takes: the object, its pointer and the vertices
+// sf::Shape keeps for its fill.
+size_t LineBytes(const RoundedLine& line) {
+    return sizeof(RoundedLine) + sizeof(std::unique_ptr<RoundedLine>) + (line.getPointCount() + 2) * sizeof(sf::Vertex);
+}
+
+}
+
+/*! \brief  App constructor
+*		
+*/
+App::App() : m_commands(COMMAND_QUEUE_CAPACITY), m_ui_thread(std::this_thread::get_id()) {
+    // Canvas variables
+    m_window = nullptr;
+    m_image = new sf::Image;
+    m_canvas = new TileCanvas;
+    m_virtual_canvas = new VirtualCanvas;
+    m_view_origin = sf::Vector2i(0, 0);
+    m_view_size = sf::Vector2i(0, 0);
+    m_zoom = 1.0f;
+    m_mip_pyramid = new MipPyramid;
+    m_tile_packer = nullptr;
+    m_cold_tile_ms = DEFAULT_COLD_TILE_MS;
+    m_indexed = nullptr;
+    m_level_image = new sf::Image;
+    m_level_texture = new sf::Texture;
+    m_level_sprite = new sf::Sprite;
+    m_level_shown = 0;
+    m_sprite = new sf::Sprite;
+    m_texture = new sf::Texture;
+    m_current_color = new sf::Color;
+    m_paintbrush_radius = nullptr;
+    m_cursor_sprite = new sf::Sprite;
+    m_cursor_texture = new sf::RenderTexture;
+    m_cursor_circle = new sf::CircleShape(5);
+    m_circle_template = new std::vector<std::pair<int,int>>;
+    m_prev_point = nullptr;
+    m_render_texture = new sf::RenderTexture;
+    m_render_sprite = new sf::Sprite;
+    m_draw_vector = new std::vector<std::unique_ptr<RoundedLine>>;
+    m_draw_count = 0;
+    m_loose_begin = 0;
+    m_history_budget = DEFAULT_HISTORY_BUDGET;
+    m_history_bytes = 0;
+    m_checkpoint_bytes = 0;
+    m_spill_scan = 0;
+    m_spill_file = new SpillFile;
+    m_gesture_cursor = NO_GESTURE;
+    m_root_redo = NO_GESTURE;
+    m_tool = PAINTBRUSH;
+    m_raster_mode = false;
+    m_batch_stroke = false;
+    m_journal = nullptr;
+    m_journal_floor = 0;
+    m_journal_floor_cursor = NO_GESTURE;
+    m_journal_stopped = false;
+    m_pipeline = nullptr;
+    m_collecting = false;
+    m_timeline = nullptr;
+    m_scrub_image.reset(new sf::Image);
+    m_scrub_texture = new sf::Texture;
+    m_scrub_sprite = new sf::Sprite;
+    m_scrub_gesture = NO_GESTURE;
+    m_timeline_mode = false;
+    m_exporter = nullptr;
+    m_importer = nullptr;
+    m_save_block_ms = 0;
+    m_document = nullptr;
+    m_autosave = nullptr;
+    m_autosave_interval_ms = DEFAULT_AUTOSAVE_INTERVAL_MS;
+    // Leave one core for the main thread, which takes part in parallel jobs too
+    m_thread_pool = new ThreadPool(std::max(1, (int)std::thread::hardware_concurrency() - 1));
+
+    // Color code member variable
+    color_codes = {
+        {sf::Keyboard::Num1, sf::Color::Black},
+        {sf::Keyboard::Num2, sf::Color::White},
+        {sf::Keyboard::Num3, sf::Color::Red},
+        {sf::Keyboard::Num4, sf::Color::Green},
+        {sf::Keyboard::Num5, sf::Color::Blue},
+        {sf::Keyboard::Num6, sf::Color::Yellow},
+        {sf::Keyboard::Num7, sf::Color::Magenta},
+        {sf::Keyboard::Num8, sf::Color::Cyan}
+    };
+    
+    
+}
+
+App::~App(){}
+
+/*! \brief 	Add new commands to queue for execution.
+*		
+*/
+// void App::AddCommand(std::unique_ptr<Command> c) {
+//     m_commands.push(std::move(c));
+// }
+/*! \brief  Queue a line segment for ExecuteCommand(). Safe to call from any thread, e.g.
+*           a network receiver or a script player. While the queue is full, the UI thread
+*           executes it, since no one else would, and other threads wait.
+*/
+void App::AddCommand(std::unique_ptr<RoundedLine> c) {
+    while (!m_commands.TryPush(c)) {
+        if (std::this_thread::get_id() == m_ui_thread) {
+            ExecuteCommand();
+        } else {
+            std::this_thread::yield();
+        }
+    }
+}
+
+/*! \brief  Execute commands from the m_command queue, COMMAND_BATCH at a time.
+*           Executed line segments are not in a gesture until PushGesture().
+*/
+int App::ExecuteCommand() {
+    int successCount = 0;
+    while (m_commands.TryPopBatch(m_command_batch, COMMAND_BATCH) > 0) {
+        // Only wait for the stroke pipeline when there is something to execute.
+        if (successCount == 0) {
+            DrainPipeline();
+        }
+        for (std::unique_ptr<RoundedLine>& line : m_command_batch) {
+            JournalLine(*line);
+            if (m_indexed != nullptr) {
+                PaintIndexed(*line);
+                successCount++;
+                continue;
+            }
+            if (m_raster_mode) {
+                // Paint the line into the image, saving the tiles it is about to change for undo.
+                if (!m_stroke_delta) {
+                    m_stroke_delta.reset(new TileDelta(*m_image));
+                }
+                sf::IntRect bounds = line->getRasterBounds();
+                bounds.left -= m_view_origin.x;
+                bounds.top -= m_view_origin.y;
+                m_stroke_delta->touch(bounds.left, bounds.top, bounds.left + bounds.width - 1, bounds.top + bounds.height - 1);
+                MarkDirty(bounds);
+                line->rasterize(*m_image, m_view_origin);
+                successCount++;
+                continue;
+            }
+            // bool success = m_commands.front() -> execute(*m_render_texture);
+            // if (success) {
+            //     m_undo.push(std::move(m_commands.front()));
+            //     successCount++;
+            // } 
+            m_draw_vector->push_back(std::move(line));
+            m_draw_count++;
+            successCount++;
+        }
+        m_command_batch.clear();
+    }
+    if (m_raster_mode && m_indexed == nullptr && successCount > 0) {
+        m_texture->update(*m_image);
+    }
+    return successCount;
+}
+
+/*! \brief  Record the line segments drawn since the last stroke (the numLines the caller
+*           counted) as one paintbrush stroke, so they are undone and redone together.
+*/
+void App::PushGesture(int numLines) {
+    DrainPipeline();
+    RecordStroke(numLines);
+}
+
+/*! \brief  Record the line segments drawn since the last gesture as one stroke gesture.
+*
+*/
+void App::RecordStroke(int numLines) {
+    EndRasterStroke();
+    if (m_raster_mode) {
+        return;
+    }
+    JournalStroke(false, std::max(numLines, 0));
+    if (numLines <= 0 || m_loose_begin == m_draw_vector->size()) {
+        return;
+    }
+    AddGesture(STROKE_GESTURE, m_loose_begin, m_draw_vector->size());
+    TrimHistory();
+}
+
+/*! \brief  Record an executed raster command (a fill or a raster mode stroke) as one gesture.
+*
+*/
+void App::PushRasterCommand(std::unique_ptr<Command> command) {
+    RasterEntry entry;
+    entry.bytes = command->getByteSize();
+    entry.command = std::move(command);
+    m_history_bytes += entry.bytes;
+    m_raster_commands.push_back(std::move(entry));
+    AddGesture(RASTER_GESTURE, m_raster_commands.size() - 1, m_raster_commands.size());
+    TrimHistory();
+}
+
+/*! \brief  Add a gesture as a child of the one at the cursor, which starts a new branch if
+*           that one already has children, and move the cursor to it. Every CHECKPOINT_INTERVAL-th
+*           raster gesture of a branch keeps a snapshot of the image to switch branches from, and
+*           so does one made after a pan, so the raster gestures after a checkpoint all have its origin.
+*           So does turning indexed mode off, for the timeline to render the gestures after it from.
+*/
+void App::AddGesture(int kind, size_t begin, size_t end) {
+    Gesture gesture;
+    gesture.begin = (sf::Uint32)begin;
+    gesture.end = (sf::Uint32)end;
+    gesture.parent = m_gesture_cursor;
+    gesture.redoChild = NO_GESTURE;
+    gesture.depth = m_gesture_cursor == NO_GESTURE ? 1 : m_gestures[m_gesture_cursor].depth + 1;
+    gesture.rasterDepth = m_gesture_cursor == NO_GESTURE ? 0 : m_gestures[m_gesture_cursor].rasterDepth;
+    gesture.kind = (sf::Uint8)kind;
+    if (kind == RASTER_GESTURE) {
+        gesture.rasterDepth++;
+    }
+    const sf::Uint32 id = (sf::Uint32)m_gestures.size();
+    const sf::Vector2i parentOrigin = OriginOf(m_gesture_cursor);
+    m_gestures.push_back(gesture);
+    m_gesture_origins.push_back(kind == STROKE_GESTURE ? parentOrigin : m_view_origin);
+    RedoChild(m_gesture_cursor) = id;
+    m_gesture_cursor = id;
+    if (kind == STROKE_GESTURE) {
+        m_visible_lines.emplace_back(begin, end);
+        m_loose_begin = end;
+    }
+    // Indexed mode has no image to snapshot; its gestures are all undone and redone in place.
+    else if (m_indexed == nullptr && (kind == INDEXED_GESTURE || gesture.rasterDepth % CHECKPOINT_INTERVAL == 0 || m_view_origin != parentOrigin)) {
+        m_checkpoints[id] = Snapshot();
+        CountCheckpoints();
+    }
+}
+
+/*! \brief  Return the child of gesture id (or of the empty canvas) that redo goes to.
+*
+*/
+sf::Uint32& App::RedoChild(sf::Uint32 id) {
+    return id == NO_GESTURE ? m_root_redo : m_gestures[id].redoChild;
+}
+
+/*! \brief  Return where m_image was on the canvas when gesture id was made.
+*
+*/
+sf::Vector2i App::OriginOf(sf::Uint32 id) {
+    return id == NO_GESTURE ? sf::Vector2i(0, 0) : m_gesture_origins[id];
+}
+
+/*! \brief  Undo or redo the raster commands of raster gesture id, reading their undo data
+*           back from the scratch file first if it was spilled. The view moves to where the
+*           gesture was made first, since its commands change m_image there. In indexed mode
+*           they change m_indexed, wherever the view is.
+*/
+bool App::ApplyRaster(sf::Uint32 id, bool redo) {
+    const Gesture& gesture = m_gestures[id];
+    if (m_indexed == nullptr) {
+        MoveRasterWindow(OriginOf(id));
+    }
+    if (!FaultIn(gesture.begin, gesture.end)) {
+        return false;
+    }
+    auto show = [this](const sf::IntRect& bounds) {
+        if (m_indexed != nullptr) {
+            ShowIndexed(bounds);
+        }
+        else {
+            MarkDirty(bounds);
+        }
+    };
+    if (redo) {
+        for (size_t i = gesture.begin; i < gesture.end; i++) {
+            m_raster_commands[i].command->redo();
+            show(m_raster_commands[i].command->getBounds());
+        }
+    }
+    else {
+        for (size_t i = gesture.end; i-- > gesture.begin; ) {
+            m_raster_commands[i].command->undo();
+            show(m_raster_commands[i].command->getBounds());
+        }
+    }
+    return true;
+}
+
+/*! \brief  Move the cursor from its gesture to the parent. A stroke only drops its range of
+*           line segments, however many segments it has. An indexed gesture switches indexed
+*           mode back.
+*/
+bool App::StepBack(bool applyRaster) {
+    const Gesture& gesture = m_gestures[m_gesture_cursor];
+    if (gesture.kind == RASTER_GESTURE) {
+        if (applyRaster && !ApplyRaster(m_gesture_cursor, false)) {
+            return false;
+        }
+    }
+    else if (gesture.kind == INDEXED_GESTURE) {
+        if (!SwitchIndexed(m_indexed == nullptr ? m_indexed_canvases[gesture.begin].get() : nullptr)) {
+            return false;
+        }
+    }
+    else {
+        m_visible_lines.pop_back();
+        m_draw_count -= gesture.end - gesture.begin;
+    }
+    RedoChild(gesture.parent) = m_gesture_cursor;
+    m_gesture_cursor = gesture.parent;
+    return true;
+}
+
+/*! \brief  Move the cursor from its gesture to the child, which redo goes to from now on.
+*
+*/
+bool App::StepForward(sf::Uint32 child, bool applyRaster) {
+    const Gesture& gesture = m_gestures[child];
+    if (gesture.kind == RASTER_GESTURE) {
+        if (applyRaster && !ApplyRaster(child, true)) {
+            return false;
+        }
+    }
+    else if (gesture.kind == INDEXED_GESTURE) {
+        if (!SwitchIndexed(m_indexed == nullptr ? m_indexed_canvases[gesture.begin].get() : nullptr)) {
+            return false;
+        }
+    }
+    else {
+        m_visible_lines.emplace_back(gesture.begin, gesture.end);
+        m_draw_count += gesture.end - gesture.begin;
+    }
+    RedoChild(m_gesture_cursor) = child;
+    m_gesture_cursor = child;
+    return true;
+}
+
+/*! \brief  Move the canvas to gesture id of any branch, or to the empty canvas for NO_GESTURE.
+*           Line segments only move the cursor through the tree. The image is brought over by
+*           undoing up to the last gesture shared with id and redoing down to id, or from the
+*           nearest checkpoint above id when that redoes fewer raster gestures and every
+*           raster gesture on the way was made where the checkpoint was and indexed mode is not
+*           switched on the way. Returns the number of gestures moved through, or -1 if id is
+*           not a gesture or the undo data on the way can not be read back, in which case
+*           nothing moves.
+*/
+int App::SwitchGesture(sf::Uint32 id) {
+    if (id != NO_GESTURE && id >= m_gestures.size()) {
+        return -1;
+    }
+    DrainPipeline();
+    EndRasterStroke();
+    auto parentOf = [this](sf::Uint32 g) { return m_gestures[g].parent; };
+    auto depthOf = [this](sf::Uint32 g) { return g == NO_GESTURE ? 0 : m_gestures[g].depth; };
+    auto rasterDepthOf = [this](sf::Uint32 g) { return g == NO_GESTURE ? 0 : m_gestures[g].rasterDepth; };
+
+    // Gestures to step back through from the cursor, and forward through down to id.
+    std::vector<sf::Uint32> up;
+    std::vector<sf::Uint32> down;
+    sf::Uint32 a = m_gesture_cursor;
+    sf::Uint32 b = id;
+    while (depthOf(a) > depthOf(b)) {
+        up.push_back(a);
+        a = parentOf(a);
+    }
+    while (depthOf(b) > depthOf(a)) {
+        down.push_back(b);
+        b = parentOf(b);
+    }
+    while (a != b) {
+        up.push_back(a);
+        down.push_back(b);
+        a = parentOf(a);
+        b = parentOf(b);
+    }
+    const sf::Uint32 shared = a;
+
+    // The nearest checkpoint at or above id, and the raster and indexed gestures from it down to id.
+    sf::Uint32 checkpoint = id;
+    std::vector<sf::Uint32> replay;
+    while (checkpoint != NO_GESTURE && m_checkpoints.find(checkpoint) == m_checkpoints.end()) {
+        if (m_gestures[checkpoint].kind != STROKE_GESTURE) {
+            replay.push_back(checkpoint);
+        }
+        checkpoint = parentOf(checkpoint);
+    }
+    const sf::Uint32 pathCost = (rasterDepthOf(m_gesture_cursor) - rasterDepthOf(shared)) + (rasterDepthOf(id) - rasterDepthOf(shared));
+    // A checkpoint only holds m_image where it was made, so it can not bring back changes elsewhere.
+    const sf::Vector2i checkpointOrigin = OriginOf(checkpoint);
+    // Nor can it be used across a switch of indexed mode, which the steps must make.
+    auto madeAtCheckpoint = [this, &checkpointOrigin](const std::vector<sf::Uint32>& gestures) {
+        return std::all_of(gestures.begin(), gestures.end(), [this, &checkpointOrigin](sf::Uint32 g) {
+            return m_gestures[g].kind == STROKE_GESTURE || (m_gestures[g].kind == RASTER_GESTURE && OriginOf(g) == checkpointOrigin);
+        });
+    };
+    const bool fromCheckpoint = m_indexed == nullptr && m_checkpoints.find(checkpoint) != m_checkpoints.end() && replay.size() < pathCost
+                                && madeAtCheckpoint(up) && madeAtCheckpoint(down) && madeAtCheckpoint(replay);
+
+    // Read the undo data of every raster gesture on the way back first, so a scratch file
+    // that can not be read leaves the canvas where it was instead of half way there.
+    auto faultIn = [this](const std::vector<sf::Uint32>& gestures) {
+        return std::all_of(gestures.begin(), gestures.end(), [this](sf::Uint32 g) {
+            return m_gestures[g].kind != RASTER_GESTURE || FaultIn(m_gestures[g].begin, m_gestures[g].end);
+        });
+    };
+    if (fromCheckpoint ? !faultIn(replay) : !faultIn(up) || !faultIn(down)) {
+        return -1;
+    }
+    for (size_t i = 0; i < up.size(); i++) {
+        if (!StepBack(!fromCheckpoint)) {
+            return -1;
+        }
+    }
+    for (size_t i = down.size(); i-- > 0; ) {
+        if (!StepForward(down[i], !fromCheckpoint)) {
+            return -1;
+        }
+    }
+    if (fromCheckpoint) {
+        MoveRasterWindow(checkpointOrigin);
+        m_checkpoints[checkpoint].CopyToImage(*m_image);
+        MarkDirty(sf::IntRect(0, 0, (int)m_image->getSize().x, (int)m_image->getSize().y));
+        for (size_t i = replay.size(); i-- > 0; ) {
+            if (!ApplyRaster(replay[i], true)) {
+                return -1;
+            }
+        }
+    }
+    if (m_indexed == nullptr) {
+        m_texture->update(*m_image);
+    }
+    TrimHistory();
+    JournalMove(SWITCH_RECORD);
+    std::cout << "Switched to gesture " << (id == NO_GESTURE ? -1 : (long long)id) << " through " << up.size() + down.size() << " gestures" << std::endl;
+    return (int)(up.size() + down.size());
+}
+
+/*! \brief  Switch to the next gesture (in the order they were made) that has the same parent
+*           as the one at the cursor, i.e. to the next branch at this point of the history.
+*           Returns the number of gestures moved through.
+*/
+int App::SwitchBranch() {
+    if (m_gesture_cursor == NO_GESTURE) {
+        return 0;
+    }
+    const sf::Uint32 parent = m_gestures[m_gesture_cursor].parent;
+    for (size_t k = 1; k < m_gestures.size(); k++) {
+        const sf::Uint32 id = (sf::Uint32)((m_gesture_cursor + k) % m_gestures.size());
+        if (m_gestures[id].parent == parent) {
+            return SwitchGesture(id);
+        }
+    }
+    return 0;
+}
+
+/*! \brief  Return the gesture the canvas is at, or NO_GESTURE for the empty canvas.
+*
+*/
+sf::Uint32 App::GetGestureCursor() {
+    return m_gesture_cursor;
+}
+
+/*! \brief  Return the number of gestures in the undo tree, over all branches.
+*
+*/
+size_t App::GetGestureCount() {
+    return m_gestures.size();
+}
+
+/*! \brief  Return gesture id of the undo tree.
+*
+*/
+const App::Gesture& App::GetGesture(sf::Uint32 id) {
+    return m_gestures[id];
+}
+
+/*! \brief  Gather what the canvas after gesture id is made of: the nearest checkpoint at
+*           or above id, the raster commands of the gestures from there down to id, and the
+*           line segment ranges of every stroke from the root to id. Spilled undo data is read back.
+*           Returns nullptr if it can not be read back or id was made in indexed mode.
+*/
+std::unique_ptr<Timeline::Frame> App::MakeTimelineFrame(sf::Uint32 id) {
+    std::unique_ptr<Timeline::Frame> frame(new Timeline::Frame);
+    frame->gesture = id;
+    std::vector<sf::Uint32> rasterGestures;
+    std::vector<sf::Uint32> strokes;
+    bool keyframeFound = false;
+    for (sf::Uint32 g = id; ; g = m_gestures[g].parent) {
+        if (!keyframeFound) {
+            auto checkpoint = m_checkpoints.find(g);
+            if (checkpoint != m_checkpoints.end()) {
+                frame->keyframe = checkpoint->second;
+                keyframeFound = true;
+            }
+        }
+        if (g == NO_GESTURE) {
+            break;
+        }
+        if (m_gestures[g].kind == STROKE_GESTURE) {
+            strokes.push_back(g);
+        }
+        else if (!keyframeFound) {
+            // Gestures made in indexed mode have no keyframe to be redone over.
+            if (m_gestures[g].kind == INDEXED_GESTURE) {
+                return nullptr;
+            }
+            rasterGestures.push_back(g);
+        }
+    }
+    for (size_t i = rasterGestures.size(); i-- > 0; ) {
+        const Gesture& gesture = m_gestures[rasterGestures[i]];
+        if (!FaultIn(gesture.begin, gesture.end)) {
+            return nullptr;
+        }
+        for (size_t c = gesture.begin; c < gesture.end; c++) {
+            frame->commands.push_back(m_raster_commands[c].command.get());
+        }
+    }
+    for (size_t i = strokes.size(); i-- > 0; ) {
+        frame->strokes.emplace_back(m_gestures[strokes[i]].begin, m_gestures[strokes[i]].end);
+    }
+    return frame;
+}
+
+/*! \brief  Ask the timeline for the canvas as it looked after gesture id (in the order the
+*           gestures were made, over all branches), or the empty canvas for NO_GESTURE. Only
+*           the frame is gathered here; the timeline renders it on its worker and
+*           CollectScrub() picks it up. Returns the number of raster commands the worker
+*           redoes, or -1 if id is not a gesture or the canvas is or was at id in indexed mode.
+*/
+int App::ScrubTo(sf::Uint32 id) {
+    if ((id != NO_GESTURE && id >= m_gestures.size()) || m_indexed != nullptr) {
+        return -1;
+    }
+    std::unique_ptr<Timeline::Frame> frame = MakeTimelineFrame(id);
+    if (!frame) {
+        return -1;
+    }
+    if (m_timeline == nullptr) {
+        m_timeline = new Timeline;
+    }
+    const int commandCount = (int)frame->commands.size();
+    m_timeline->Request(std::move(frame));
+    return commandCount;
+}
+
+/*! \brief  Take the newest image the timeline finished and upload it. Returns false if
+*           there is none since the last call.
+*/
+bool App::CollectScrub() {
+    if (m_timeline == nullptr || !m_timeline->Collect(m_scrub_image, m_scrub_gesture, m_scrub_strokes)) {
+        return false;
+    }
+    if (m_scrub_texture->getSize() != m_scrub_image->getSize()) {
+        m_scrub_texture->loadFromImage(*m_scrub_image);
+        m_scrub_sprite->setTexture(*m_scrub_texture, true);
+    }
+    else {
+        m_scrub_texture->update(*m_scrub_image);
+    }
+    const sf::Vector2i origin = OriginOf(m_scrub_gesture);
+    m_scrub_sprite->setPosition((float)origin.x, (float)origin.y);
+    return true;
+}
+
+/*! \brief  Return the gesture of the image CollectScrub() took last.
+*
+*/
+sf::Uint32 App::GetScrubGesture() {
+    return m_scrub_gesture;
+}
+
+/*! \brief  Return the image (without the line segments) CollectScrub() took last.
+*
+*/
+const sf::Image& App::GetScrubImage() {
+    return *m_scrub_image;
+}
+
+/*! \brief  Return the number of line segments drawn over the image CollectScrub() took last.
+*
+*/
+size_t App::GetScrubLineCount() {
+    size_t count = 0;
+    for (const std::pair<size_t, size_t>& range : m_scrub_strokes) {
+        count += range.second - range.first;
+    }
+    return count;
+}
+
+/*! \brief  Render the canvas after gesture id on this thread with the strokes flattened over
+*           it, e.g. to export a past state. The image is the part of the canvas where the last
+*           raster gesture up to id was made. The canvas and the cursor are left alone. The
+*           image is empty in indexed mode, or for a gesture made in it, which has no
+*           checkpoints to render from.
+*/
+sf::Image App::RenderGesture(sf::Uint32 id) {
+    sf::Image image;
+    if ((id != NO_GESTURE && id >= m_gestures.size()) || m_indexed != nullptr) {
+        return image;
+    }
+    std::unique_ptr<Timeline::Frame> frame = MakeTimelineFrame(id);
+    if (!frame) {
+        return image;
+    }
+    Timeline::Render(*frame, image);
+    const sf::Vector2i origin = OriginOf(id);
+    for (const std::pair<size_t, size_t>& range : frame->strokes) {
+        for (size_t i = range.first; i < range.second; i++) {
+            (*m_draw_vector)[i]->rasterize(image, origin);
+        }
+    }
+    return image;
+}
+
+/*! \brief  Spill the undo data of the oldest raster commands to the scratch file until the
+*           history fits in its memory budget, then drop the oldest checkpoints if it still
+*           does not. Line segments count against the budget too but stay in memory, since
+*           every frame draws them. The commands next to the undo cursor stay in memory. A
+*           command that comes back from the scratch file keeps its copy there, so spilling it
+*           again only frees the memory.
+*/
+void App::TrimHistory() {
+    // The timeline redoes commands of the history while it renders.
+    if (m_timeline != nullptr && m_timeline->IsBusy()) {
+        return;
+    }
+    size_t spilledCount = 0;
+    size_t spilledBytes = 0;
+    std::vector<sf::Uint8> bytes;
+    // The last command undo needs and the first one redo needs stay in memory.
+    size_t keepUndo = m_raster_commands.size();
+    size_t keepRedo = m_raster_commands.size();
+    if (m_gesture_cursor != NO_GESTURE && m_gestures[m_gesture_cursor].kind == RASTER_GESTURE) {
+        keepUndo = m_gestures[m_gesture_cursor].end - 1;
+    }
+    const sf::Uint32 redoChild = RedoChild(m_gesture_cursor);
+    if (redoChild != NO_GESTURE && m_gestures[redoChild].kind == RASTER_GESTURE) {
+        keepRedo = m_gestures[redoChild].begin;
+    }
+    const size_t lineBytes = GetLineBytes();
+    for (size_t i = m_spill_scan; i < m_raster_commands.size() && m_history_bytes + lineBytes + m_checkpoint_bytes > m_history_budget; i++) {
+        RasterEntry& entry = m_raster_commands[i];
+        if (entry.spilled || i == keepUndo || i == keepRedo) {
+            continue;
+        }
+        bytes.clear();
+        if (!entry.command->spill(bytes)) {
+            continue;
+        }
+        if (!entry.onDisk) {
+            if (!m_spill_file->Write(bytes, entry.spillOffset)) {
+                std::cout << "Could not write the undo history to the scratch file" << std::endl;
+                entry.command->restore(bytes);
+                break;
+            }
+            entry.spillSize = bytes.size();
+            entry.onDisk = true;
+        }
+        entry.spilled = true;
+        m_history_bytes -= entry.bytes;
+        spilledBytes += entry.bytes;
+        entry.bytes = 0;
+        spilledCount++;
+    }
+    while (m_spill_scan < m_raster_commands.size() && m_raster_commands[m_spill_scan].spilled) {
+        m_spill_scan++;
+    }
+    if (spilledCount > 0) {
+        std::cout << "Spilled " << spilledCount << " gestures (" << spilledBytes << " bytes) to the scratch file" << std::endl;
+    }
+    // Checkpoints only make switching branches quicker, so the oldest go next. The ones made
+    // after a pan or on leaving indexed mode stay, since the timeline renders from them, and
+    // so does the empty canvas.
+    size_t evicted = 0;
+    while (m_history_bytes + lineBytes + m_checkpoint_bytes > m_history_budget) {
+        sf::Uint32 oldest = NO_GESTURE;
+        for (const std::pair<const sf::Uint32, TileCanvas>& checkpoint : m_checkpoints) {
+            const sf::Uint32 g = checkpoint.first;
+            if (g != NO_GESTURE && g < oldest && m_gestures[g].kind == RASTER_GESTURE && OriginOf(g) == OriginOf(m_gestures[g].parent)) {
+                oldest = g;
+            }
+        }
+        if (oldest == NO_GESTURE) {
+            break;
+        }
+        m_checkpoints.erase(oldest);
+        CountCheckpoints();
+        evicted++;
+    }
+    if (evicted > 0) {
+        std::cout << "Dropped " << evicted << " checkpoints over the history budget" << std::endl;
+    }
+}
+
+/*! \brief  Count the bytes of the tiles the checkpoints hold that m_canvas does not share.
+*           Only done when a checkpoint is made or dropped, as it visits every tile of them.
+*/
+void App::CountCheckpoints() {
+    std::unordered_set<const void*> counted;
+    m_canvas->CountBytes(counted);
+    m_checkpoint_bytes = 0;
+    for (const std::pair<const sf::Uint32, TileCanvas>& checkpoint : m_checkpoints) {
+        m_checkpoint_bytes += checkpoint.second.CountBytes(counted);
+    }
+}
+
+/*! \brief  Read the undo data of the raster commands [begin, end) back from the scratch
+*           file if they were spilled. Returns false if it could not be read.
+*/
+bool App::FaultIn(size_t begin, size_t end) {
+    std::vector<sf::Uint8> bytes;
+    for (size_t i = begin; i < end; i++) {
+        RasterEntry& entry = m_raster_commands[i];
+        if (!entry.spilled) {
+            continue;
+        }
+        if (!m_spill_file->Read(entry.spillOffset, entry.spillSize, bytes) || !entry.command->restore(bytes)) {
+            std::cout << "Could not read the undo history back from the scratch file" << std::endl;
+            return false;
+        }
+        entry.spilled = false;
+        entry.bytes = entry.command->getByteSize();
+        m_history_bytes += entry.bytes;
+        m_spill_scan = std::min(m_spill_scan, i);
+    }
+    return true;
+}
+
+/*! \brief  Set how many bytes of undo data the history may keep in memory.
+*
+*/
+void App::SetHistoryBudget(size_t bytes) {
+    m_history_budget = bytes;
+    TrimHistory();
+}
+
+/*! \brief  Return the bytes of undo data and line segments the history keeps in memory.
+*
+*/
+size_t App::GetHistoryBytes() {
+    return m_history_bytes + GetLineBytes();
+}
+
+/*! \brief  Return the bytes the line segments of every branch take. They all have the same
+*           number of points, so the first one gives the size of each.
+*/
+size_t App::GetLineBytes() {
+    return m_draw_vector->empty() ? 0 : m_draw_vector->size() * LineBytes(*m_draw_vector->front());
+}
+
+/*! \brief  Return the bytes written to the scratch file.
+*
+*/
+size_t App::GetSpillFileSize() {
+    return m_spill_file->GetSize();
+}
+
+/*! \brief  Encode an executed line segment for the next stroke record, with the stroke
+*           codec, so a line of a stroke takes about 5 bytes.
+*/
+void App::JournalLine(const RoundedLine& line) {
+    if (!IsJournaling()) {
+        return;
+    }
+    m_journal_lines.Write(line);
+}
+
+/*! \brief  Append a stroke record: the line segments executed since the last one, and the
+*           gesture made of the last gestureLines line segments. Raster strokes are one
+*           gesture of all their line segments.
+*/
+void App::JournalStroke(bool raster, int gestureLines) {
+    if (!IsJournaling() || (m_journal_lines.GetCount() == 0 && gestureLines == 0)) {
+        return;
+    }
+    std::vector<sf::Uint8> record{STROKE_RECORD, (sf::Uint8)(raster ? 1 : 0)};
+    Varint::Put(record, (std::uint64_t)gestureLines);
+    Varint::Put(record, m_journal_lines.GetCount());
+    record.insert(record.end(), m_journal_lines.GetBytes().begin(), m_journal_lines.GetBytes().end());
+    m_journal_lines.Reset();
+    m_journal->Append(record);
+}
+
+/*! \brief  Append a fill, pixel batch, undo or redo record. Line segments drawn before it
+*           without a gesture are appended first, so the journal keeps the order of events.
+*/
+void App::JournalRecord(const std::vector<sf::Uint8>& record) {
+    if (!IsJournaling()) {
+        return;
+    }
+    JournalStroke(false, 0);
+    m_journal->Append(record);
+}
+
+/*! \brief  Return true if edits are being journaled: there is a journal, and the cursor has
+*           not left the gestures it can replay since the last checkpoint.
+*/
+bool App::IsJournaling() {
+    return m_journal != nullptr && !m_journal_stopped;
+}
+
+/*! \brief  Append an undo, redo or switch record for the move of the cursor just made. After
+*           a checkpoint, replay starts from the saved document, so it only has the gesture
+*           the cursor was at then and the ones made after it. A move to any other gesture can
+*           not be replayed, so the journal stops there until the next checkpoint.
+*/
+void App::JournalMove(int kind) {
+    if (!IsJournaling()) {
+        return;
+    }
+    const bool reachable = m_gesture_cursor == m_journal_floor_cursor || (m_gesture_cursor != NO_GESTURE && m_gesture_cursor >= m_journal_floor);
+    if (!reachable) {
+        JournalStroke(false, 0);
+        m_journal->Flush();
+        m_journal_stopped = true;
+        std::cout << "Moved to a gesture from before the last save; the journal stops here until the next save" << std::endl;
+        return;
+    }
+    std::vector<sf::Uint8> record{(sf::Uint8)kind};
+    if (kind == SWITCH_RECORD) {
+        // 0 is the gesture of the checkpoint, then the ones made after it in order.
+        Varint::Put(record, m_gesture_cursor == m_journal_floor_cursor ? 0 : (std::uint64_t)(m_gesture_cursor - m_journal_floor) + 1);
+    }
+    JournalRecord(record);
+}
+
+/*! \brief  Start the journal over from the canvas as it is, e.g. once it is saved or another
+*           document is opened: the file is cut back to a canvas record of the document, or
+*           of a blank canvas, so replay opens it and only applies the edits made after. Line
+*           segments not journaled yet are in the document already.
+*/
+void App::CheckpointJournal() {
+    m_journal_floor = (sf::Uint32)m_gestures.size();
+    m_journal_floor_cursor = m_gesture_cursor;
+    if (m_journal == nullptr) {
+        return;
+    }
+    m_journal_lines.Reset();
+    if (!m_journal->Reset()) {
+        std::cout << "Could not start the journal over" << std::endl;
+        return;
+    }
+    m_journal_stopped = false;
+    std::vector<sf::Uint8> record{CANVAS_RECORD, (sf::Uint8)(m_indexed != nullptr ? 1 : 0)};
+    Varint::Put(record, (std::uint64_t)m_virtual_canvas->GetWidth());
+    Varint::Put(record, (std::uint64_t)m_virtual_canvas->GetHeight());
+    Varint::PutSigned(record, m_view_origin.x);
+    Varint::PutSigned(record, m_view_origin.y);
+    record.insert(record.end(), m_document_path.begin(), m_document_path.end());
+    m_journal->Append(record);
+}
+
+/*! \brief  Apply a journal record through the same calls that made it. Returns false if
+*           the record is not valid.
+*/
+bool App::ReplayRecord(const std::vector<sf::Uint8>& record) {
+    const sf::Uint8* p = record.data();
+    const sf::Uint8* end = p + record.size();
+    if (p == end) {
+        return false;
+    }
+    const int kind = *p++;
+    if (kind == STROKE_RECORD) {
+        std::uint64_t gestureLines, count;
+        if (p == end || *p > 1) {
+            return false;
+        }
+        const bool raster = *p++ == 1;
+        if (!Varint::Get(p, end, gestureLines) || !Varint::Get(p, end, count) || gestureLines > (std::uint64_t)INT_MAX || count > (std::uint64_t)(end - p)) {
+            return false;
+        }
+        if (raster != m_raster_mode) {
+            SetRasterMode(raster);
+        }
+        StrokeReader reader(p, (size_t)(end - p));
+        for (std::uint64_t i = 0; i < count; i++) {
+            std::unique_ptr<RoundedLine> line;
+            if (!reader.Read(line)) {
+                return false;
+            }
+            AddCommand(std::move(line));
+            // A long stroke would fill the queue before it is executed.
+            if ((i + 1) % COMMAND_BATCH == 0) {
+                ExecuteCommand();
+            }
+        }
+        p = reader.GetPosition();
+        ExecuteCommand();
+        if (raster) {
+            EndRasterStroke();
+        } else {
+            PushGesture((int)gestureLines);
+        }
+    }
+    else if (kind == FILL_RECORD) {
+        std::int64_t fillX, fillY;
+        sf::Uint32 color;
+        if (!Varint::GetSigned(p, end, fillX) || !Varint::GetSigned(p, end, fillY) || !Varint::GetUint32(p, end, color)) {
+            return false;
+        }
+        const sf::Color paintbrushColor = *m_current_color;
+        *m_current_color = UnpackColor(color);
+        FillCommand((int)fillX, (int)fillY);
+        *m_current_color = paintbrushColor;
+    }
+    else if (kind == PIXELS_RECORD) {
+        std::uint64_t count;
+        sf::Uint32 color;
+        if (p == end || *p > 1) {
+            return false;
+        }
+        const bool newGesture = *p++ == 1;
+        if (!Varint::GetUint32(p, end, color) || !Varint::Get(p, end, count) || count > (std::uint64_t)(end - p)) {
+            return false;
+        }
+        const std::int64_t width = (std::int64_t)m_image->getSize().x;
+        const std::int64_t pixelCount = width * m_image->getSize().y;
+        std::unique_ptr<PixelBatch> batch(new PixelBatch(*m_image, UnpackColor(color)));
+        batch->reserve((size_t)count);
+        std::int64_t index = 0;
+        for (std::uint64_t i = 0; i < count; i++) {
+            std::int64_t delta;
+            if (!Varint::GetSigned(p, end, delta) || index + delta < 0 || index + delta >= pixelCount) {
+                return false;
+            }
+            index += delta;
+            batch->add((int)(index % width), (int)(index / width));
+        }
+        if (newGesture) {
+            EndRasterStroke();
+        }
+        PaintPixels(std::move(batch));
+    }
+    else if (kind == UNDO_RECORD) {
+        UndoCommand();
+    }
+    else if (kind == SWITCH_RECORD) {
+        std::uint64_t id;
+        if (!Varint::Get(p, end, id) || (id > 0 && m_journal_floor + id - 1 >= m_gestures.size())) {
+            return false;
+        }
+        SwitchGesture(id == 0 ? m_journal_floor_cursor : (sf::Uint32)(m_journal_floor + id - 1));
+    }
+    else if (kind == REDO_RECORD) {
+        RedoCommand();
+    }
+    else if (kind == RECOLOR_RECORD) {
+        std::int64_t recolorX, recolorY;
+        sf::Uint32 color;
+        if (!Varint::GetSigned(p, end, recolorX) || !Varint::GetSigned(p, end, recolorY) || !Varint::GetUint32(p, end, color)) {
+            return false;
+        }
+        const sf::Color paintbrushColor = *m_current_color;
+        *m_current_color = UnpackColor(color);
+        RecolorCommand((int)recolorX, (int)recolorY);
+        *m_current_color = paintbrushColor;
+    }
+    else if (kind == INDEXED_RECORD) {
+        if (p == end || *p > 1) {
+            return false;
+        }
+        SetIndexedMode(*p++ == 1);
+    }
+    else if (kind == CANVAS_RECORD) {
+        std::uint64_t width, height;
+        std::int64_t x, y;
+        if (p == end || *p > 1) {
+            return false;
+        }
+        const bool indexed = *p++ == 1;
+        if (!Varint::Get(p, end, width) || !Varint::Get(p, end, height) || !Varint::GetSigned(p, end, x) || !Varint::GetSigned(p, end, y)
+            || width > (std::uint64_t)INT_MAX || height > (std::uint64_t)INT_MAX || x < INT_MIN || x > INT_MAX || y < INT_MIN || y > INT_MAX) {
+            return false;
+        }
+        const std::string path(p, end);
+        p = end;
+        if (path.empty() ? !NewCanvas((int)width, (int)height) : !OpenDocument(path)) {
+            return false;
+        }
+        if (GetCanvasSize() != sf::Vector2i((int)width, (int)height)) {
+            std::cout << "The document " << path << " is not the size it was journaled at" << std::endl;
+            return false;
+        }
+        if (indexed && !SetIndexedMode(true)) {
+            return false;
+        }
+        PanTo((int)x, (int)y);
+        if (m_view_origin != sf::Vector2i((int)x, (int)y)) {
+            return false;
+        }
+        m_journal_floor = (sf::Uint32)m_gestures.size();
+        m_journal_floor_cursor = m_gesture_cursor;
+    }
+    else if (kind == PAN_RECORD) {
+        std::int64_t x, y;
+        if (!Varint::GetSigned(p, end, x) || !Varint::GetSigned(p, end, y) || x < INT_MIN || x > INT_MAX || y < INT_MIN || y > INT_MAX) {
+            return false;
+        }
+        PanTo((int)x, (int)y);
+    }
+    else {
+        return false;
+    }
+    return p == end;
+}
+
+/*! \brief  Recover the session in the journal at path by replaying its records, then keep
+*           appending every committed gesture to it. A new journal starts with a canvas record
+*           of the canvas as it is, so replay rebuilds that canvas, whatever canvas the app
+*           was started with, and stops if its document is no longer the size it was. Returns
+*           the number of records replayed, or -1 if the journal could not be opened.
+*/
+int App::OpenJournal(const std::string& path, int flushIntervalMs) {
+    CloseJournal();
+    m_journal_stopped = false;
+    std::vector<std::vector<sf::Uint8>> records;
+    size_t validSize;
+    if (!Journal::ReadRecords(path, records, validSize)) {
+        std::cout << "Could not read the journal " << path << std::endl;
+        return -1;
+    }
+    const bool rasterMode = m_raster_mode;
+    int replayed = 0;
+    for (const std::vector<sf::Uint8>& record : records) {
+        if (!ReplayRecord(record)) {
+            break;
+        }
+        replayed++;
+    }
+    SetRasterMode(rasterMode);
+    // A record this version can not read is left alone instead of being appended after.
+    if (replayed < (int)records.size()) {
+        std::cout << "Stopped replaying the journal " << path << " at an invalid record" << std::endl;
+        return -1;
+    }
+    m_journal = new Journal;
+    if (!m_journal->Open(path, flushIntervalMs)) {
+        std::cout << "Could not open the journal " << path << std::endl;
+        delete m_journal;
+        m_journal = nullptr;
+        return -1;
+    }
+    if (replayed > 0) {
+        std::cout << "Recovered " << replayed << " records from the journal" << std::endl;
+    }
+    if (records.empty()) {
+        CheckpointJournal();
+    }
+    return replayed;
+}
+
+/*! \brief  Write and fsync the journal records still queued.
+*
+*/
+bool App::FlushJournal() {
+    return m_journal != nullptr && m_journal->Flush();
+}
+
+/*! \brief  Flush and close the journal. Line segments drawn without a gesture are appended first.
+*
+*/
+void App::CloseJournal() {
+    if (m_journal == nullptr) {
+        return;
+    }
+    DrainPipeline();
+    JournalStroke(false, 0);
+    delete m_journal;
+    m_journal = nullptr;
+}
+
+/*! \brief  Finish the raster mode or indexed stroke being drawn and record its tile delta
+*           as one gesture, unless it changed nothing. Later pixel batches start a new gesture.
+*/
+void App::EndRasterStroke() {
+    m_batch_stroke = false;
+    if (m_indexed_stroke) {
+        std::unique_ptr<IndexedDelta> delta = std::move(m_indexed_stroke);
+        if (!delta->execute()) {
+            delta.reset();
+        }
+        RecordRasterStroke(std::move(delta));
+    }
+    if (!m_stroke_delta) {
+        return;
+    }
+    std::unique_ptr<TileDelta> delta = std::move(m_stroke_delta);
+    if (!delta->execute()) {
+        delta.reset();
+    }
+    RecordRasterStroke(std::move(delta));
+}
+
+/*! \brief  Record the tile delta of a finished raster mode stroke as one gesture. A stroke
+*           that changed nothing has no delta, and its journal lines are dropped.
+*/
+void App::RecordRasterStroke(std::unique_ptr<Command> delta) {
+    if (!delta) {
+        m_journal_lines.Reset();
+        return;
+    }
+    JournalStroke(true, 0);
+    std::cout << "Recorded: " << delta->getDescription() << std::endl;
+    PushRasterCommand(std::move(delta));
+}
+
+/*! \brief  Queue a paintbrush sample at (x,y) of the canvas for the stroke pipeline, with the
+*           current paintbrush and stroke mode. The segments are recorded by CollectStrokes().
+*           In indexed mode the segment is painted into the indices here instead, which is
+*           quicker than handing it to the pipeline's workers.
+*/
+void App::SubmitPoint(int x, int y, short owner) {
+    if (m_indexed != nullptr) {
+        const sf::Vector2f point((float)x, (float)y);
+        if (m_indexed_stroke && point == m_indexed_point) {
+            return;
+        }
+        AddCommand(std::unique_ptr<RoundedLine>(new RoundedLine(m_indexed_stroke ? m_indexed_point : point, point, (float)(*m_paintbrush_radius * 2), *m_current_color, owner)));
+        m_indexed_point = point;
+        ExecuteCommand();
+        return;
+    }
+    StrokeItem item;
+    item.kind = StrokeItem::POINT;
+    item.raster = m_raster_mode;
+    item.point = sf::Vector2f((float)x, (float)y);
+    item.origin = m_view_origin;
+    item.width = (float)(*m_paintbrush_radius * 2);
+    item.color = *m_current_color;
+    item.owner = owner;
+    SubmitItem(item);
+}
+
+/*! \brief  End the stroke being submitted. It becomes one gesture once CollectStrokes()
+*           has its last segment.
+*/
+void App::SubmitStrokeEnd() {
+    if (m_indexed != nullptr) {
+        EndRasterStroke();
+        return;
+    }
+    StrokeItem item;
+    item.kind = StrokeItem::END;
+    item.raster = m_raster_mode;
+    SubmitItem(item);
+}
+
+/*! \brief  Queue a bucket fill at (x,y) of the canvas with the paintbrush color for the stroke
+*           pipeline. The lines on the canvas bound the fill, as in FillCommand().
+*/
+void App::SubmitFill(int x, int y) {
+    // The lines submitted before the fill bound it too, so they are collected first.
+    DrainPipeline();
+    // A fill on the indices is quick enough for the UI thread, and indexed mode has no lines.
+    if (m_indexed != nullptr) {
+        FillCommand(x, y);
+        return;
+    }
+    StrokeItem item;
+    item.kind = StrokeItem::FILL;
+    item.point = sf::Vector2f((float)x, (float)y);
+    item.origin = m_view_origin;
+    item.color = *m_current_color;
+    item.boundary.reset(new std::vector<const RoundedLine*>);
+    for (const std::pair<size_t, size_t>& range : m_visible_lines) {
+        for (size_t i = range.first; i < range.second; i++) {
+            item.boundary->push_back((*m_draw_vector)[i].get());
+        }
+    }
+    for (size_t i = m_loose_begin; i < m_draw_vector->size(); i++) {
+        item.boundary->push_back((*m_draw_vector)[i].get());
+    }
+    SubmitItem(item);
+}
+
+/*! \brief  Queue an item for the stroke pipeline, starting it on first use. While the
+*           pipeline is full the finished items are collected, so its stages can go on.
+*/
+void App::SubmitItem(StrokeItem& item) {
+    if (m_pipeline == nullptr) {
+        m_pipeline = new StrokePipeline(*m_image, m_thread_pool);
+    }
+    // A stroke drawn with ExecuteCommand() must save its tiles before the pipeline paints.
+    if (m_stroke_delta) {
+        DrainPipeline();
+        EndRasterStroke();
+    }
+    while (!m_pipeline->Submit(item)) {
+        CollectStrokes();
+        std::this_thread::yield();
+    }
+}
+
+/*! \brief  Record the items the stroke pipeline finished: line segments go on the canvas,
+*           painted tiles are marked dirty and uploaded, and strokes and fills become
+*           gestures. Called by the main loop every frame. Returns the number of line
+*           segments and fills collected.
+*/
+int App::CollectStrokes() {
+    if (m_pipeline == nullptr || m_collecting) {
+        return 0;
+    }
+    m_collecting = true;
+    int collected = 0;
+    bool upload = false;
+    StrokeItem item;
+    while (m_pipeline->Collect(item)) {
+        if (item.kind == StrokeItem::POINT) {
+            JournalLine(*item.line);
+            if (item.raster) {
+                MarkDirty(item.bounds);
+                upload = true;
+            } else {
+                m_draw_vector->push_back(std::move(item.line));
+                m_draw_count++;
+            }
+            collected++;
+        } else if (item.kind == StrokeItem::END) {
+            if (item.raster) {
+                m_batch_stroke = false;
+                RecordRasterStroke(std::move(item.command));
+                m_pipeline->Resume();
+            } else {
+                RecordStroke(item.lineCount);
+            }
+        } else {
+            EndRasterStroke();
+            if (item.command) {
+                MarkDirty(item.bounds);
+                upload = true;
+                PushRasterCommand(std::move(item.command));
+                JournalFill((int)item.point.x, (int)item.point.y, item.color);
+                collected++;
+            }
+            m_pipeline->Resume();
+        }
+    }
+    if (upload) {
+        std::unique_lock<std::mutex> lock = m_pipeline->LockImage();
+        m_texture->update(*m_image);
+    }
+    m_collecting = false;
+    return collected;
+}
+
+/*! \brief  Wait for the stroke pipeline to finish everything submitted and record it, so
+*           the image and the undo history are not changed under the caller.
+*/
+void App::DrainPipeline() {
+    if (m_pipeline == nullptr || m_collecting) {
+        return;
+    }
+    CollectStrokes();
+    while (!m_pipeline->IsIdle()) {
+        std::this_thread::yield();
+        CollectStrokes();
+    }
+}
+
+/*! \brief  Return the number of line segments on the canvas.
+*
+*/
+size_t App::GetLineCount() {
+    return m_draw_count;
+}
+
+/*! \brief  Flatten the strokes over the image on the CPU, anti-aliased like the GPU
+*           draws them, without a render texture readback. In indexed mode there are no
+*           strokes, and the view is expanded from the indices.
+*/
+sf::Image App::Flatten() {
+    DrainPipeline();
+    if (m_indexed != nullptr) {
+        return ExpandIndexed(sf::IntRect(m_view_origin.x, m_view_origin.y, m_view_size.x, m_view_size.y));
+    }
+    sf::Image composite = *m_image;
+    for (const std::pair<size_t, size_t>& range : m_visible_lines) {
+        for (size_t i = range.first; i < range.second; i++) {
+            (*m_draw_vector)[i]->rasterize(composite, m_view_origin);
+        }
+    }
+    for (size_t i = m_loose_begin; i < m_draw_vector->size(); i++) {
+        (*m_draw_vector)[i]->rasterize(composite, m_view_origin);
+    }
+    return composite;
+}
+
+/*! \brief  Save the canvas to path, as PNG, JPEG, BMP, TGA or SVG by its extension. Only a
+*           snapshot of the image and the list of lines on it are taken here; the exporter
+*           flattens and encodes them on its worker, so painting goes on during the save and
+*           CollectSaves() reports it. Returns false if the format is not supported.
+*/
+bool App::SaveImage(const std::string& path) {
+    if (!Exporter::IsSupported(path)) {
+        std::cout << "Can not save " << path << ", use a .png, .jpg, .bmp, .tga or .svg file" << std::endl;
+        return false;
+    }
+    const auto start = std::chrono::steady_clock::now();
+    std::unique_ptr<Exporter::Job> job(new Exporter::Job);
+    job->path = path;
+    if (m_indexed != nullptr) {
+        // The view is expanded from the indices into a canvas of its own.
+        job->canvas.Create(m_view_size.x, m_view_size.y, sf::Color::White);
+        job->canvas.MarkDirty(0, 0, m_view_size.x - 1, m_view_size.y - 1);
+        job->canvas.Sync(ExpandIndexed(sf::IntRect(m_view_origin.x, m_view_origin.y, m_view_size.x, m_view_size.y)));
+    }
+    else {
+        job->canvas = Snapshot();
+    }
+    job->origin = m_view_origin;
+    job->lines.reserve(m_draw_count + (m_draw_vector->size() - m_loose_begin));
+    job->strokeEnds.reserve(m_visible_lines.size());
+    for (const std::pair<size_t, size_t>& range : m_visible_lines) {
+        for (size_t i = range.first; i < range.second; i++) {
+            job->lines.push_back((*m_draw_vector)[i].get());
+        }
+        job->strokeEnds.push_back(job->lines.size());
+    }
+    for (size_t i = m_loose_begin; i < m_draw_vector->size(); i++) {
+        job->lines.push_back((*m_draw_vector)[i].get());
+    }
+    if (m_exporter == nullptr) {
+        m_exporter = new Exporter;
+    }
+    m_exporter->Save(std::move(job));
+    m_save_block_ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::cout << "Saving " << path << " in the background, the UI thread took " << m_save_block_ms << " ms" << std::endl;
+    return true;
+}
+
+/*! \brief  Report the saves the exporter finished since the last call. Returns how many there were.
+*
+*/
+int App::CollectSaves() {
+    if (m_exporter == nullptr) {
+        return 0;
+    }
+    std::vector<Exporter::Result> results;
+    m_exporter->Collect(results);
+    for (const Exporter::Result& result : results) {
+        std::cout << (result.saved ? "Saved " : "Could not save ") << result.path << std::endl;
+    }
+    return (int)results.size();
+}
+
+/*! \brief  Return how far along the saves in progress are, from 0 to 1, or 1 if there are none.
+*
+*/
+float App::GetSaveProgress() {
+    return m_exporter == nullptr ? 1.0f : m_exporter->GetProgress();
+}
+
+/*! \brief  Return the milliseconds the last SaveImage() call kept the UI thread.
+*
+*/
+double App::GetSaveBlockTime() {
+    return m_save_block_ms;
+}
+
+/*! \brief  Wait until every saved image is written.
+*
+*/
+void App::WaitForSaves() {
+    if (m_exporter != nullptr) {
+        m_exporter->Wait();
+    }
+}
+
+/*! \brief  Import the image at source as a document at document, source + ".mpd" if empty,
+*           on the importer's worker, a band of rows at a time. CollectImports() opens it on
+*           the canvas once it is written. Returns false if the document is the image itself.
+*/
+bool App::ImportImage(const std::string& source, const std::string& document) {
+    std::unique_ptr<Importer::Job> job(new Importer::Job);
+    job->source = source;
+    job->document = document.empty() ? source + ".mpd" : document;
+    if (job->document == source) {
+        std::cout << "Can not import " << source << " over itself" << std::endl;
+        return false;
+    }
+    if (m_importer == nullptr) {
+        m_importer = new Importer;
+    }
+    std::cout << "Importing " << source << " in the background" << std::endl;
+    m_importer->Import(std::move(job));
+    return true;
+}
+
+/*! \brief  Open the documents the importer finished since the last call on the canvas, and
+*           report the images it could not read. Returns how many imports finished.
+*/
+int App::CollectImports() {
+    if (m_importer == nullptr) {
+        return 0;
+    }
+    std::vector<Importer::Result> results;
+    m_importer->Collect(results);
+    for (const Importer::Result& result : results) {
+        if (!result.imported) {
+            std::cout << "Could not import " << result.source << std::endl;
+            continue;
+        }
+        std::cout << "Imported " << result.source << " (" << result.width << "x" << result.height << ") as " << result.document << std::endl;
+        OpenDocument(result.document);
+    }
+    return (int)results.size();
+}
+
+/*! \brief  Return how far along the imports in progress are, from 0 to 1, or 1 if there are none.
+*
+*/
+float App::GetImportProgress() {
+    return m_importer == nullptr ? 1.0f : m_importer->GetProgress();
+}
+
+/*! \brief  Wait until every imported image is written as a document.
+*
+*/
+void App::WaitForImports() {
+    if (m_importer != nullptr) {
+        m_importer->Wait();
+    }
+}
+
+/*! \brief  Put the line segment ranges of the strokes from the root to the cursor in strokes,
+*           then the line segments not in a gesture yet as one more stroke.
+*/
+void App::GetCanvasStrokes(std::vector<std::pair<size_t, size_t>>& strokes) {
+    strokes = m_visible_lines;
+    if (m_loose_begin < m_draw_vector->size()) {
+        strokes.emplace_back(m_loose_begin, m_draw_vector->size());
+    }
+}
+
+/*! \brief  Save the canvas and its strokes as a document at path. The changed tiles of the
+*           image are written back first, then every tile of the virtual canvas is copied over
+*           still compressed, or compressed from the background, one at a time. In indexed mode
+*           every tile is expanded from the indices instead. The saved document becomes the
+*           open one.
+*/
+bool App::SaveDocument(const std::string& path) {
+    DrainPipeline();
+    EndRasterStroke();
+    // The changed tiles go to the mip pyramid and the autosave first, as they are written back.
+    SyncMipPyramid();
+    if (!WriteBack()) {
+        std::cout << "Could not write the canvas back before saving " << path << std::endl;
+        return false;
+    }
+    const int width = m_virtual_canvas->GetWidth();
+    const int height = m_virtual_canvas->GetHeight();
+    DocumentWriter writer;
+    if (!writer.Open(path, width, height)) {
+        std::cout << "Could not create the document " << path << std::endl;
+        return false;
+    }
+    const size_t tileStride = (size_t)Document::TILE_SIZE * 4;
+    std::vector<sf::Uint8> scratch((size_t)Document::TILE_SIZE * tileStride);
+    bool written = true;
+    for (int tile = 0; written && tile < m_virtual_canvas->GetTileCount(); tile++) {
+        const sf::Uint8* encoded;
+        size_t encodedSize;
+        if (m_indexed != nullptr) {
+            m_indexed->ExpandTile(tile, scratch.data(), tileStride);
+            written = writer.AddTile(scratch.data(), tileStride);
+        }
+        else if (m_virtual_canvas->GetEncodedTile(tile, encoded, encodedSize)) {
+            written = writer.AddEncodedTile(encoded, encodedSize);
+        } else {
+            written = m_virtual_canvas->ReadTile(tile, scratch.data(), tileStride) && writer.AddTile(scratch.data(), tileStride);
+        }
+    }
+    // The strokes of the canvas, with the line segments not in a gesture yet as one more,
+    // encoded and written a chunk at a time.
+    std::vector<std::pair<size_t, size_t>> strokes;
+    GetCanvasStrokes(strokes);
+    StrokeWriter strokeWriter;
+    for (const std::pair<size_t, size_t>& range : strokes) {
+        strokeWriter.BeginStroke(range.second - range.first);
+        for (size_t i = range.first; i < range.second; i++) {
+            strokeWriter.Write(*(*m_draw_vector)[i]);
+        }
+        if (strokeWriter.GetBytes().size() >= STROKE_CHUNK_SIZE) {
+            written = written && writer.AddStrokes(strokeWriter.GetBytes());
+            strokeWriter.Clear();
+        }
+    }
+    written = written && writer.AddStrokes(strokeWriter.GetBytes());
+    if (!written || !writer.Finish()) {
+        std::cout << "Could not save the document " << path << std::endl;
+        return false;
+    }
+    // The canvas now reads its tiles from the saved document, which has every one written.
+    std::unique_ptr<Document> saved(new Document);
+    if (saved->Open(path)) {
+        m_virtual_canvas->Create(width, height, m_virtual_canvas->GetBackground(), saved.get());
+        m_mip_pyramid->SetDocument(saved.get());
+        delete m_document;
+        m_document = saved.release();
+        m_document_path = path;
+        // The indices now only differ from the saved document where they change from here on.
+        std::fill(m_indexed_written.begin(), m_indexed_written.end(), false);
+        // The autosave and the journal only have to keep what changes after the saved document.
+        RestartAutosave(true);
+        CheckpointJournal();
+    }
+    std::cout << "Saved " << path << ", " << width << "x" << height << std::endl;
+    return true;
+}
+
+/*! \brief  Open the document at path in place of the canvas and its undo history. It becomes
+*           the virtual canvas, and only the tiles under the image are decoded, so opening takes
+*           as long for a document of any size. Its strokes become stroke gestures, and the
+*           journal starts over from the document, since its records are of the canvas before.
+*/
+bool App::OpenDocument(const std::string& path) {
+    std::unique_ptr<Document> document(new Document);
+    std::vector<std::unique_ptr<RoundedLine>> lines;
+    std::vector<size_t> strokeEnds;
+    if (!document->Open(path) || !document->ReadStrokes(lines, strokeEnds)) {
+        std::cout << "Could not open the document " << path << std::endl;
+        return false;
+    }
+    sf::Image region;
+    region.create(m_view_size.x, m_view_size.y, sf::Color::White);
+    if (!document->ReadRegion(0, 0, region)) {
+        std::cout << "Could not read the tiles of the document " << path << std::endl;
+        return false;
+    }
+    DrainPipeline();
+    EndRasterStroke();
+    WaitForSaves();
+    LeaveIndexedMode(false);
+    ResetHistory();
+    m_virtual_canvas->Create(document->GetWidth(), document->GetHeight(), sf::Color::White, document.get());
+    m_mip_pyramid->Reset(document->GetWidth(), document->GetHeight(), sf::Color::White, document.get());
+    m_view_origin = sf::Vector2i(0, 0);
+    std::fill(m_window_dirty.begin(), m_window_dirty.end(), false);
+    std::fill(m_mip_dirty.begin(), m_mip_dirty.end(), false);
+    m_level_shown = 0;
+    *m_image = region;
+    m_canvas->MarkDirty(0, 0, (int)region.getSize().x - 1, (int)region.getSize().y - 1);
+    m_checkpoints[NO_GESTURE] = Snapshot();
+    size_t begin = 0;
+    for (const size_t strokeEnd : strokeEnds) {
+        for (size_t i = begin; i < strokeEnd; i++) {
+            m_draw_vector->push_back(std::move(lines[i]));
+        }
+        m_draw_count += strokeEnd - begin;
+        AddGesture(STROKE_GESTURE, begin, strokeEnd);
+        begin = strokeEnd;
+    }
+    m_texture->update(*m_image);
+    delete m_document;
+    m_document = document.release();
+    m_document_path = path;
+    RestartAutosave(true);
+    CheckpointJournal();
+    std::cout << "Opened " << path << ", " << m_document->GetWidth() << "x" << m_document->GetHeight()
+              << ", decoded " << m_document->GetDecodedCount() << " of " << m_document->GetTileCount() << " tiles" << std::endl;
+    return true;
+}
+
+/*! \brief  Start over with a blank width x height canvas, of any size: only its tiles that
+*           are drawn on take memory. The undo history is forgotten and the journal started
+*           over, as when a document is opened.
+*/
+bool App::NewCanvas(int width, int height) {
+    if (width <= 0 || height <= 0) {
+        return false;
+    }
+    DrainPipeline();
+    EndRasterStroke();
+    WaitForSaves();
+    LeaveIndexedMode(false);
+    ResetHistory();
+    m_virtual_canvas->Create(width, height, sf::Color::White);
+    m_mip_pyramid->Reset(width, height, sf::Color::White);
+    delete m_document;
+    m_document = nullptr;
+    m_view_origin = sf::Vector2i(0, 0);
+    std::fill(m_window_dirty.begin(), m_window_dirty.end(), false);
+    std::fill(m_mip_dirty.begin(), m_mip_dirty.end(), false);
+    m_level_shown = 0;
+    m_virtual_canvas->Read(0, 0, *m_image, sf::IntRect(0, 0, (int)m_image->getSize().x, (int)m_image->getSize().y));
+    m_canvas->MarkDirty(0, 0, (int)m_image->getSize().x - 1, (int)m_image->getSize().y - 1);
+    m_checkpoints[NO_GESTURE] = Snapshot();
+    m_texture->update(*m_image);
+    m_document_path.clear();
+    RestartAutosave(false);
+    CheckpointJournal();
+    std::cout << "New canvas, " << width << "x" << height << std::endl;
+    return true;
+}
+
+/*! \brief  Autosave the canvas to path every intervalMs from now on, on a worker thread. The
+*           first save has the tiles drawn on since the canvas was opened, saved or made, and
+*           its strokes; every one after only has what changed since the one before.
+*/
+bool App::StartAutosave(const std::string& path, int intervalMs) {
+    StopAutosave();
+    m_autosave = new Autosave;
+    if (!m_autosave->Open(path)) {
+        std::cout << "Could not create the autosave " << path << std::endl;
+        StopAutosave();
+        return false;
+    }
+    m_autosave_interval_ms = std::max(intervalMs, 0);
+    SyncMipPyramid();
+    if (!WriteBack()) {
+        std::cout << "Could not write the canvas back" << std::endl;
+    }
+    RestartAutosave(false);
+    return true;
+}
+
+/*! \brief  Stop autosaving, once the saves handed to the worker are written.
+*
+*/
+void App::StopAutosave() {
+    delete m_autosave;
+    m_autosave = nullptr;
+    m_autosave_tiles.clear();
+    m_autosave_strokes.clear();
+}
+
+/*! \brief  Hand the tiles and strokes changed since the last autosave to the autosave worker.
+*           The tiles are copied from the virtual canvas still compressed, so the UI thread
+*           only spends time on what changed. Returns false if autosave is off or nothing changed.
+*/
+bool App::AutosaveNow() {
+    if (m_autosave == nullptr) {
+        return false;
+    }
+    m_autosave_time = std::chrono::steady_clock::now();
+    // The changed tiles of m_image are collected on the way to the pyramid, then written back.
+    SyncMipPyramid();
+    if (!WriteBack()) {
+        std::cout << "Could not write the canvas back" << std::endl;
+    }
+    // Start the file over once it is mostly tiles saved again since.
+    if (m_autosave->GetFileSize() > std::max(AUTOSAVE_COMPACT_BYTES, AUTOSAVE_COMPACT_RATIO * m_virtual_canvas->GetPageBytes())) {
+        RestartAutosave(false);
+        return true;
+    }
+    std::unique_ptr<Autosave::Job> job(new Autosave::Job);
+    if (!FillAutosave(*job)) {
+        return false;
+    }
+    m_autosave->Save(std::move(job));
+    return true;
+}
+
+/*! \brief  Copy the compressed tiles changed since the last autosave into job, and encode the
+*           strokes after the ones the last autosave has in common with the canvas. A stroke is
+*           the same if its line segment range is, since line segments are never overwritten.
+*/
+bool App::FillAutosave(Autosave::Job& job) {
+    std::vector<std::pair<size_t, size_t>> strokes;
+    GetCanvasStrokes(strokes);
+    size_t kept = 0;
+    while (kept < strokes.size() && kept < m_autosave_strokes.size() && strokes[kept] == m_autosave_strokes[kept]) {
+        kept++;
+    }
+    if (kept < strokes.size() || kept < m_autosave_strokes.size()) {
+        StrokeWriter writer;
+        for (size_t stroke = kept; stroke < strokes.size(); stroke++) {
+            writer.BeginStroke(strokes[stroke].second - strokes[stroke].first);
+            for (size_t i = strokes[stroke].first; i < strokes[stroke].second; i++) {
+                writer.Write(*(*m_draw_vector)[i]);
+            }
+        }
+        job.strokesChanged = true;
+        job.keptStrokes = kept;
+        job.strokes = writer.GetBytes();
+        m_autosave_strokes.swap(strokes);
+    }
+    const size_t tileStride = (size_t)IndexedCanvas::TILE_SIZE * 4;
+    std::vector<sf::Uint8> scratch;
+    for (const int tile : m_autosave_tiles) {
+        const sf::Uint8* encoded;
+        size_t encodedSize;
+        if (m_indexed != nullptr) {
+            // The tile is only in the indices, so it is expanded and compressed here.
+            const sf::IntRect rect = m_indexed->GetTileRect(tile);
+            scratch.resize((size_t)IndexedCanvas::TILE_SIZE * tileStride);
+            m_indexed->ExpandTile(tile, scratch.data(), tileStride);
+            job.tiles.emplace_back(tile, std::vector<sf::Uint8>());
+            TileCodec::Encode(scratch.data(), tileStride, rect.width, rect.height, job.tiles.back().second);
+        }
+        else if (m_virtual_canvas->GetEncodedTile(tile, encoded, encodedSize)) {
+            job.tiles.emplace_back(tile, std::vector<sf::Uint8>(encoded, encoded + encodedSize));
+        }
+    }
+    m_autosave_tiles.clear();
+    return job.restart || job.strokesChanged || !job.tiles.empty();
+}
+
+/*! \brief  Start the autosave file over for the canvas as it is over m_document: the tiles
+*           written since it was opened or made, and the strokes, except the ones of the
+*           document if strokesInBase.
+*/
+void App::RestartAutosave(bool strokesInBase) {
+    if (m_autosave == nullptr) {
+        return;
+    }
+    std::unique_ptr<Autosave::Job> job(new Autosave::Job);
+    job->restart = true;
+    job->width = m_virtual_canvas->GetWidth();
+    job->height = m_virtual_canvas->GetHeight();
+    job->base = m_document_path;
+    m_autosave_strokes.clear();
+    if (strokesInBase) {
+        GetCanvasStrokes(m_autosave_strokes);
+    }
+    job->baseStrokes = m_autosave_strokes.size();
+    std::vector<int> pages;
+    m_virtual_canvas->GetPageTiles(pages);
+    for (size_t tile = 0; tile < m_indexed_written.size(); tile++) {
+        if (m_indexed_written[tile]) {
+            pages.push_back((int)tile);
+        }
+    }
+    m_autosave_tiles.clear();
+    m_autosave_tiles.insert(pages.begin(), pages.end());
+    FillAutosave(*job);
+    m_autosave->Save(std::move(job));
+    m_autosave_time = std::chrono::steady_clock::now();
+}
+
+/*! \brief  Return the bytes the last autosave wrote, or 0 if there was none.
+*
+*/
+size_t App::GetAutosaveBytes() {
+    return m_autosave == nullptr ? 0 : m_autosave->GetLastBytes();
+}
+
+/*! \brief  Return the number of autosaves written since autosave was started.
+*
+*/
+size_t App::GetAutosaveCount() {
+    return m_autosave == nullptr ? 0 : m_autosave->GetSaveCount();
+}
+
+/*! \brief  Wait until every autosave handed to the worker is written.
+*
+*/
+void App::WaitForAutosave() {
+    if (m_autosave != nullptr) {
+        m_autosave->Wait();
+    }
+}
+
+/*! \brief  Restore the canvas from the autosave at path, e.g. after a crash, in place of the
+*           canvas and its undo history. The base document of the autosave is opened, the tiles
+*           saved over it are kept still compressed, and the strokes become stroke gestures, as
+*           when a document is opened. Restore an autosave before starting autosave over it.
+*/
+bool App::RestoreAutosave(const std::string& path) {
+    WaitForAutosave();
+    Autosave::State state;
+    std::unique_ptr<Document> document;
+    std::vector<std::unique_ptr<RoundedLine>> lines;
+    std::vector<size_t> strokeEnds;
+    bool read = Autosave::Load(path, state) && state.width > 0 && state.height > 0;
+    if (read && !state.base.empty()) {
+        document.reset(new Document);
+        read = document->Open(state.base) && document->GetWidth() == state.width && document->GetHeight() == state.height
+            && document->ReadStrokes(lines, strokeEnds) && strokeEnds.size() >= state.baseStrokes;
+    } else {
+        read = read && state.baseStrokes == 0;
+    }
+    if (!read) {
+        std::cout << "Could not restore the autosave " << path << std::endl;
+        return false;
+    }
+    // The strokes of the base document still on the canvas, then the autosaved ones.
+    strokeEnds.resize(state.baseStrokes);
+    lines.resize(strokeEnds.empty() ? 0 : strokeEnds.back());
+    const size_t baseLines = lines.size();
+    for (std::unique_ptr<RoundedLine>& line : state.lines) {
+        lines.push_back(std::move(line));
+    }
+    for (const size_t strokeEnd : state.strokeEnds) {
+        strokeEnds.push_back(baseLines + strokeEnd);
+    }
+    DrainPipeline();
+    EndRasterStroke();
+    CloseJournal();
+    WaitForSaves();
+    LeaveIndexedMode(false);
+    ResetHistory();
+    m_virtual_canvas->Create(state.width, state.height, sf::Color::White, document.get());
+    m_mip_pyramid->Reset(state.width, state.height, sf::Color::White, document.get());
+    const size_t tileStride = (size_t)VirtualCanvas::TILE_SIZE * 4;
+    std::vector<sf::Uint8> scratch((size_t)VirtualCanvas::TILE_SIZE * tileStride);
+    for (const std::pair<const int, std::vector<sf::Uint8>>& tile : state.tiles) {
+        if (tile.first < 0 || tile.first >= m_virtual_canvas->GetTileCount()) {
+            continue;
+        }
+        m_virtual_canvas->WriteEncodedTile(tile.first, tile.second.data(), tile.second.size());
+        if (m_virtual_canvas->ReadTile(tile.first, scratch.data(), tileStride)) {
+            m_mip_pyramid->Update(tile.first, scratch.data(), tileStride);
+        }
+    }
+    m_view_origin = sf::Vector2i(0, 0);
+    std::fill(m_window_dirty.begin(), m_window_dirty.end(), false);
+    std::fill(m_mip_dirty.begin(), m_mip_dirty.end(), false);
+    m_level_shown = 0;
+    m_virtual_canvas->Read(0, 0, *m_image, sf::IntRect(0, 0, (int)m_image->getSize().x, (int)m_image->getSize().y));
+    m_canvas->MarkDirty(0, 0, (int)m_image->getSize().x - 1, (int)m_image->getSize().y - 1);
+    m_checkpoints[NO_GESTURE] = Snapshot();
+    size_t begin = 0;
+    for (const size_t strokeEnd : strokeEnds) {
+        for (size_t i = begin; i < strokeEnd; i++) {
+            m_draw_vector->push_back(std::move(lines[i]));
+        }
+        m_draw_count += strokeEnd - begin;
+        AddGesture(STROKE_GESTURE, begin, strokeEnd);
+        begin = strokeEnd;
+    }
+    m_texture->update(*m_image);
+    delete m_document;
+    m_document = document.release();
+    m_document_path = state.base;
+    RestartAutosave(false);
+    std::cout << "Restored " << path << ", " << state.saveCount << " autosaves, " << state.tiles.size() << " tiles" << std::endl;
+    return true;
+}
+
+/*! \brief  Return the size of the virtual canvas.
+*
+*/
+sf::Vector2i App::GetCanvasSize() {
+    return sf::Vector2i(m_virtual_canvas->GetWidth(), m_virtual_canvas->GetHeight());
+}
+
+/*! \brief  Write the tiles of m_image changed since they were last written back to the
+*           virtual canvas, compressed. The raster stage is kept out while they are read.
+*/
+bool App::WriteBack() {
+    std::vector<sf::IntRect> areas;
+    const int tilesX = (m_view_size.x + TileCanvas::TILE_SIZE - 1) / TileCanvas::TILE_SIZE;
+    for (size_t i = 0; i < m_window_dirty.size(); i++) {
+        if (m_window_dirty[i]) {
+            areas.emplace_back((int)i % tilesX * TileCanvas::TILE_SIZE, (int)i / tilesX * TileCanvas::TILE_SIZE, TileCanvas::TILE_SIZE, TileCanvas::TILE_SIZE);
+        }
+    }
+    if (areas.empty()) {
+        return true;
+    }
+    std::fill(m_window_dirty.begin(), m_window_dirty.end(), false);
+    std::unique_lock<std::mutex> lock;
+    if (m_pipeline != nullptr) {
+        lock = m_pipeline->LockImage();
+    }
+    return m_virtual_canvas->Write(m_view_origin.x, m_view_origin.y, *m_image, areas);
+}
+
+/*! \brief  Move m_image to origin of the virtual canvas. Its changed tiles are written back,
+*           the pixels still in view are moved over and only the strips that come into view
+*           are read, so a move costs the same on a canvas of any size. In indexed mode the
+*           indices are the whole canvas, so only the texture is expanded from them again.
+*/
+bool App::MoveRasterWindow(sf::Vector2i origin) {
+    const int width = m_view_size.x;
+    const int height = m_view_size.y;
+    origin.x = std::max(0, std::min(origin.x, m_virtual_canvas->GetWidth() - width));
+    origin.y = std::max(0, std::min(origin.y, m_virtual_canvas->GetHeight() - height));
+    if (origin == m_view_origin) {
+        return false;
+    }
+    DrainPipeline();
+    EndRasterStroke();
+    if (m_indexed != nullptr) {
+        m_view_origin = origin;
+        UploadIndexed(sf::IntRect(origin.x, origin.y, width, height));
+        return true;
+    }
+    SyncMipPyramid();
+    if (!WriteBack()) {
+        std::cout << "Could not write the canvas back" << std::endl;
+    }
+    const int dx = origin.x - m_view_origin.x;
+    const int dy = origin.y - m_view_origin.y;
+    m_view_origin = origin;
+    if (std::abs(dx) >= width || std::abs(dy) >= height) {
+        m_virtual_canvas->Read(origin.x, origin.y, *m_image, sf::IntRect(0, 0, width, height));
+    }
+    else {
+        sf::Uint8* pixels = MathUtility::MutablePixels(*m_image);
+        const size_t stride = (size_t)width * 4;
+        const size_t rowBytes = (size_t)(width - std::abs(dx)) * 4;
+        const int rows = height - std::abs(dy);
+        // Go through the rows in the order that never overwrites one still to be moved.
+        for (int i = 0; i < rows; i++) {
+            const int y = dy >= 0 ? i : rows - 1 - i;
+            std::memmove(pixels + (size_t)(y + std::max(-dy, 0)) * stride + (size_t)std::max(-dx, 0) * 4,
+                         pixels + (size_t)(y + std::max(dy, 0)) * stride + (size_t)std::max(dx, 0) * 4, rowBytes);
+        }
+        if (dx != 0) {
+            m_virtual_canvas->Read(origin.x, origin.y, *m_image, sf::IntRect(dx > 0 ? width - dx : 0, 0, std::abs(dx), height));
+        }
+        if (dy != 0) {
+            m_virtual_canvas->Read(origin.x, origin.y, *m_image, sf::IntRect(0, dy > 0 ? height - dy : 0, width, std::abs(dy)));
+        }
+    }
+    // None of the pixels has to be written back. For the next snapshot, a pan by whole tiles
+    // moves the tiles along and only the exposed ones are new; otherwise every pixel is.
+    const int tile = TileCanvas::TILE_SIZE;
+    if (dx % tile == 0 && dy % tile == 0 && std::abs(dx) < width && std::abs(dy) < height) {
+        m_canvas->Shift(dx / tile, dy / tile);
+    }
+    else {
+        m_canvas->MarkDirty(0, 0, width - 1, height - 1);
+    }
+    // Every tile of the window has other pixels now, so none of them is cold.
+    std::fill(m_tile_touched.begin(), m_tile_touched.end(), std::chrono::steady_clock::now());
+    m_texture->update(*m_image);
+    return true;
+}
+
+/*! \brief  Pan the view so m_image starts at (x,y) of the canvas, as far as the canvas goes.
+*           Returns false if the view did not move.
+*/
+bool App::PanTo(int x, int y) {
+    if (!MoveRasterWindow(sf::Vector2i(x, y))) {
+        return false;
+    }
+    if (IsJournaling()) {
+        std::vector<sf::Uint8> record{PAN_RECORD};
+        Varint::PutSigned(record, m_view_origin.x);
+        Varint::PutSigned(record, m_view_origin.y);
+        JournalRecord(record);
+    }
+    return true;
+}
+
+/*! \brief  Pan the view by (dx,dy) pixels of the canvas.
+*
+*/
+bool App::Pan(int dx, int dy) {
+    return PanTo(m_view_origin.x + dx, m_view_origin.y + dy);
+}
+
+/*! \brief  Return where m_image starts on the canvas.
+*
+*/
+sf::Vector2i App::GetViewOrigin() {
+    return m_view_origin;
+}
+
+/*! \brief  Magnify the view of the image around its center, from MIN_ZOOM to MAX_ZOOM. Below 1
+*           the zoom is rounded to the power of two of a level of the mip pyramid.
+*/
+void App::SetZoom(float zoom) {
+    zoom = std::max(MIN_ZOOM, std::min(zoom, MAX_ZOOM));
+    if (zoom < 1.0f) {
+        const int level = std::min((int)std::lround(std::log2(1.0f / zoom)), m_mip_pyramid->GetLevelCount());
+        zoom = std::ldexp(1.0f, -level);
+    }
+    m_zoom = zoom;
+}
+
+/*! \brief  Return the magnification of the view.
+*
+*/
+float App::GetZoom() {
+    return m_zoom;
+}
+
+/*! \brief  Return the level of the mip pyramid the view shows, or 0 for the canvas itself.
+*
+*/
+int App::GetMipLevel() {
+    return m_zoom < 1.0f ? (int)std::lround(std::log2(1.0f / m_zoom)) : 0;
+}
+
+/*! \brief  Hand the tiles of the virtual canvas under the changed tiles of m_image to the mip
+*           pyramid, which rebuilds their ancestors on its worker. Only their raw pixels are
+*           copied: a tile only partly under m_image is read from the virtual canvas and the
+*           part under m_image copied over it, so nothing is compressed here. If wait, wait
+*           for the worker to finish. In indexed mode the changed tiles of m_indexed are
+*           expanded for it.
+*/
+void App::SyncMipPyramid(bool wait) {
+    if (m_indexed != nullptr) {
+        if (m_autosave != nullptr) {
+            m_autosave_tiles.insert(m_indexed_changed.begin(), m_indexed_changed.end());
+        }
+        const size_t stride = (size_t)IndexedCanvas::TILE_SIZE * 4;
+        std::vector<sf::Uint8> scratch((size_t)IndexedCanvas::TILE_SIZE * stride);
+        for (const int tile : m_indexed_changed) {
+            m_indexed->ExpandTile(tile, scratch.data(), stride);
+            m_mip_pyramid->Update(tile, scratch.data(), stride);
+        }
+        m_indexed_changed.clear();
+        m_mip_sync_time = std::chrono::steady_clock::now();
+        if (wait) {
+            m_mip_pyramid->Wait();
+        }
+        return;
+    }
+    const int width = (int)m_image->getSize().x;
+    const int height = (int)m_image->getSize().y;
+    const int tilesX = (width + TileCanvas::TILE_SIZE - 1) / TileCanvas::TILE_SIZE;
+    std::vector<int> tiles;
+    for (size_t i = 0; i < m_mip_dirty.size(); i++) {
+        if (!m_mip_dirty[i]) {
+            continue;
+        }
+        // The tiles of the canvas under this tile of m_image, which need not line up with them.
+        const int left = m_view_origin.x + (int)i % tilesX * TileCanvas::TILE_SIZE;
+        const int top = m_view_origin.y + (int)i / tilesX * TileCanvas::TILE_SIZE;
+        const int right = std::min(std::min(left + TileCanvas::TILE_SIZE, m_view_origin.x + width), m_virtual_canvas->GetWidth()) - 1;
+        const int bottom = std::min(std::min(top + TileCanvas::TILE_SIZE, m_view_origin.y + height), m_virtual_canvas->GetHeight()) - 1;
+        for (int ty = top / VirtualCanvas::TILE_SIZE; left <= right && top <= bottom && ty <= bottom / VirtualCanvas::TILE_SIZE; ty++) {
+            for (int tx = left / VirtualCanvas::TILE_SIZE; tx <= right / VirtualCanvas::TILE_SIZE; tx++) {
+                tiles.push_back(ty * m_virtual_canvas->GetTilesX() + tx);
+            }
+        }
+    }
+    if (!tiles.empty()) {
+        std::fill(m_mip_dirty.begin(), m_mip_dirty.end(), false);
+        std::sort(tiles.begin(), tiles.end());
+        tiles.erase(std::unique(tiles.begin(), tiles.end()), tiles.end());
+        if (m_autosave != nullptr) {
+            m_autosave_tiles.insert(tiles.begin(), tiles.end());
+        }
+        std::unique_lock<std::mutex> lock;
+        if (m_pipeline != nullptr) {
+            lock = m_pipeline->LockImage();
+        }
+        const size_t stride = (size_t)width * 4;
+        const size_t tileStride = (size_t)VirtualCanvas::TILE_SIZE * 4;
+        std::vector<sf::Uint8> scratch((size_t)VirtualCanvas::TILE_SIZE * tileStride);
+        const sf::IntRect view(m_view_origin.x, m_view_origin.y, width, height);
+        for (const int tile : tiles) {
+            const sf::IntRect rect = m_virtual_canvas->GetTileRect(tile);
+            const int x = rect.left - m_view_origin.x;
+            const int y = rect.top - m_view_origin.y;
+            if (x >= 0 && y >= 0 && x + rect.width <= width && y + rect.height <= height) {
+                m_mip_pyramid->Update(tile, m_image->getPixelsPtr() + (size_t)y * stride + (size_t)x * 4, stride);
+                continue;
+            }
+            // Outside m_image the canvas only changes when m_image is written back, so the
+            // virtual canvas has the rest of the tile.
+            sf::IntRect under;
+            if (!rect.intersects(view, under) || !m_virtual_canvas->ReadTile(tile, scratch.data(), tileStride)) {
+                continue;
+            }
+            for (int row = under.top; row < under.top + under.height; row++) {
+                std::memcpy(scratch.data() + (size_t)(row - rect.top) * tileStride + (size_t)(under.left - rect.left) * 4,
+                            m_image->getPixelsPtr() + (size_t)(row - m_view_origin.y) * stride + (size_t)(under.left - m_view_origin.x) * 4,
+                            (size_t)under.width * 4);
+            }
+            m_mip_pyramid->Update(tile, scratch.data(), tileStride);
+        }
+    }
+    m_mip_sync_time = std::chrono::steady_clock::now();
+    if (wait) {
+        m_mip_pyramid->Wait();
+    }
+}
+
+/*! \brief  Bring the level of the mip pyramid under the zoomed out view into m_level_image and
+*           its texture, and return it, or nullptr at a zoom of 1 or more. The level is read
+*           whole when the view moved to other pixels of it, and otherwise only its tiles
+*           rebuilt since the last frame are, so a frame zoomed out costs as much as one at 1:1.
+*/
+const sf::Image* App::RenderLevel() {
+    const int level = GetMipLevel();
+    if (level == 0) {
+        return nullptr;
+    }
+    const int width = m_view_size.x;
+    const int height = m_view_size.y;
+    // The view is centered on m_image at any zoom.
+    const sf::Vector2i origin(((m_view_origin.x + width / 2) >> level) - width / 2, ((m_view_origin.y + height / 2) >> level) - height / 2);
+    std::vector<int> rebuilt;
+    m_mip_pyramid->TakeRebuilt(level, rebuilt);
+    if (level != m_level_shown || origin != m_level_origin) {
+        m_mip_pyramid->Read(level, origin.x, origin.y, *m_level_image, sf::IntRect(0, 0, width, height));
+        m_level_shown = level;
+        m_level_origin = origin;
+    } else if (!rebuilt.empty()) {
+        const sf::IntRect window(0, 0, width, height);
+        for (const int tile : rebuilt) {
+            sf::IntRect rect = m_mip_pyramid->GetTileRect(level, tile);
+            rect.left -= origin.x;
+            rect.top -= origin.y;
+            sf::IntRect area;
+            if (rect.intersects(window, area)) {
+                m_mip_pyramid->Read(level, origin.x, origin.y, *m_level_image, area);
+            }
+        }
+    } else {
+        return m_level_image;
+    }
+    m_level_texture->update(*m_level_image);
+    m_level_sprite->setPosition((float)(origin.x * (1 << level)), (float)(origin.y * (1 << level)));
+    m_level_sprite->setScale((float)(1 << level), (float)(1 << level));
+    return m_level_image;
+}
+
+/*! \brief  Return the point of the canvas under pixel (x,y) of the window.
+*
+*/
+sf::Vector2i App::MapPixelToCanvas(int x, int y) {
+    const float halfWidth = (float)m_view_size.x / 2.0f;
+    const float halfHeight = (float)m_view_size.y / 2.0f;
+    return sf::Vector2i(m_view_origin.x + (int)std::floor(halfWidth + ((float)x - halfWidth) / m_zoom),
+                        m_view_origin.y + (int)std::floor(halfHeight + ((float)y - halfHeight) / m_zoom));
+}
+
+/*! \brief  Return the bytes the compressed tiles written back to the virtual canvas take.
+*
+*/
+size_t App::GetCanvasPageBytes() {
+    return m_virtual_canvas->GetPageBytes();
+}
+
+/*! \brief  Set how long a tile has to stay unchanged before PackColdTiles() packs it.
+*
+*/
+void App::SetColdTileTime(int ms) {
+    m_cold_tile_ms = std::max(ms, 0);
+}
+
+/*! \brief  Swap the tiles the packer finished for their packed copies in m_canvas and in every
+*           checkpoint, then hand it the tiles that went cold: every buffer but the ones under
+*           tiles of m_image that changed in the last m_cold_tile_ms. With wait, waits for
+*           those to be packed and swaps them in too. Returns the number of tiles swapped.
+*/
+size_t App::PackColdTiles(bool wait) {
+    if (m_tile_packer == nullptr) {
+        m_tile_packer = new TilePacker;
+    }
+    auto swapPacked = [this]() {
+        std::vector<TilePacker::Result> results;
+        if (m_tile_packer->Collect(results) == 0) {
+            return (size_t)0;
+        }
+        std::unordered_map<const TileCanvas::Tile*, std::shared_ptr<const TileCanvas::PackedTile>> packed;
+        for (const TilePacker::Result& result : results) {
+            packed[result.pixels.get()] = result.packed;
+            m_packing.erase(result.pixels.get());
+        }
+        size_t swapped = m_canvas->ReplacePacked(packed);
+        for (std::pair<const sf::Uint32, TileCanvas>& checkpoint : m_checkpoints) {
+            swapped += checkpoint.second.ReplacePacked(packed);
+        }
+        return swapped;
+    };
+    size_t swapped = swapPacked();
+
+    // A buffer can be under several tiles, like the one of a blank canvas, so it is warm if
+    // any tile of m_image that changed lately has it.
+    const std::chrono::steady_clock::time_point cold = std::chrono::steady_clock::now() - std::chrono::milliseconds(m_cold_tile_ms);
+    std::unordered_set<const TileCanvas::Tile*> warm;
+    for (int tile = 0; tile < m_canvas->GetTileCount(); tile++) {
+        if (m_tile_touched[(size_t)tile] > cold && !m_canvas->IsPacked(tile)) {
+            warm.insert(m_canvas->GetPixelBuffer(tile).get());
+        }
+    }
+    std::vector<TilePacker::Job> jobs;
+    auto queue = [this, &jobs, &warm](const TileCanvas& canvas) {
+        for (int tile = 0; tile < canvas.GetTileCount(); tile++) {
+            std::shared_ptr<const TileCanvas::Tile> pixels = canvas.GetPixelBuffer(tile);
+            if (pixels && warm.count(pixels.get()) == 0 && m_packing.insert(pixels.get()).second) {
+                jobs.push_back(TilePacker::Job{pixels, canvas.GetTileWidth(tile), canvas.GetTileHeight(tile)});
+            }
+        }
+    };
+    queue(*m_canvas);
+    for (const std::pair<const sf::Uint32, TileCanvas>& checkpoint : m_checkpoints) {
+        queue(checkpoint.second);
+    }
+    if (!jobs.empty()) {
+        m_tile_packer->Pack(jobs);
+    }
+    if (wait) {
+        m_tile_packer->Wait();
+        swapped += swapPacked();
+    }
+    m_pack_time = std::chrono::steady_clock::now();
+    return swapped;
+}
+
+/*! \brief  Return the bytes the tiles of m_canvas and of the checkpoints take, packed or not,
+*           each buffer counted once however many of them share it.
+*/
+size_t App::GetSnapshotBytes() {
+    std::unordered_set<const void*> counted;
+    size_t bytes = m_canvas->CountBytes(counted);
+    for (const std::pair<const sf::Uint32, TileCanvas>& checkpoint : m_checkpoints) {
+        bytes += checkpoint.second.CountBytes(counted);
+    }
+    return bytes;
+}
+
+/*! \brief  Return the bytes the canvas takes in memory: m_image, its snapshots, the tiles
+*           written back to the virtual canvas, and the indices of indexed mode.
+*/
+size_t App::GetCanvasBytes() {
+    return (size_t)m_image->getSize().x * m_image->getSize().y * 4 + GetSnapshotBytes() + m_virtual_canvas->GetPageBytes() + GetIndexedBytes();
+}
+
+/*! \brief  Forget every gesture, raster command, checkpoint and line segment, and the indices
+*           of indexed mode but the ones in use. The timeline is stopped first, since it renders
+*           from them.
+*/
+void App::ResetHistory() {
+    if (m_timeline != nullptr) {
+        m_timeline->Wait();
+        CollectScrub();
+    }
+    m_scrub_gesture = NO_GESTURE;
+    m_scrub_strokes.clear();
+    m_timeline_mode = false;
+    m_raster_commands.clear();
+    m_history_bytes = 0;
+    m_spill_scan = 0;
+    m_spill_file->Clear();
+    m_gestures.clear();
+    m_gesture_origins.clear();
+    m_gesture_cursor = NO_GESTURE;
+    m_root_redo = NO_GESTURE;
+    m_journal_floor = 0;
+    m_journal_floor_cursor = NO_GESTURE;
+    m_checkpoints.clear();
+    m_checkpoint_bytes = 0;
+    m_draw_vector->clear();
+    m_loose_begin = 0;
+    m_visible_lines.clear();
+    m_draw_count = 0;
+    m_batch_stroke = false;
+    m_indexed_stroke.reset();
+    m_journal_lines.Reset();
+    for (std::unique_ptr<IndexedCanvas>& indexed : m_indexed_canvases) {
+        if (indexed.get() == m_indexed) {
+            indexed.swap(m_indexed_canvases.front());
+        }
+    }
+    m_indexed_canvases.resize(m_indexed != nullptr ? 1 : 0);
+}
+
+/*! \brief  Take a snapshot of the image. Only the tiles changed since the last snapshot
+*           are copied, the rest are shared with earlier snapshots.
+*/
+TileCanvas App::Snapshot() {
+    DrainPipeline();
+    m_canvas->Sync(*m_image);
+    return *m_canvas;
+}
+
+/*! \brief  Mark the pixels in bounds as changed for the next snapshot and for write back.
+*
+*/
+void App::MarkDirty(const sf::IntRect& bounds) {
+    m_canvas->MarkDirty(bounds.left, bounds.top, bounds.left + bounds.width - 1, bounds.top + bounds.height - 1);
+    const int tilesX = ((int)m_image->getSize().x + TileCanvas::TILE_SIZE - 1) / TileCanvas::TILE_SIZE;
+    const int tilesY = ((int)m_image->getSize().y + TileCanvas::TILE_SIZE - 1) / TileCanvas::TILE_SIZE;
+    const int x0 = std::max(bounds.left / TileCanvas::TILE_SIZE, 0);
+    const int y0 = std::max(bounds.top / TileCanvas::TILE_SIZE, 0);
+    const int x1 = std::min((bounds.left + bounds.width - 1) / TileCanvas::TILE_SIZE, tilesX - 1);
+    const int y1 = std::min((bounds.top + bounds.height - 1) / TileCanvas::TILE_SIZE, tilesY - 1);
+    const std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    for (int ty = y0; ty <= y1; ty++) {
+        for (int tx = x0; tx <= x1; tx++) {
+            m_window_dirty[(size_t)(ty * tilesX + tx)] = true;
+            m_mip_dirty[(size_t)(ty * tilesX + tx)] = true;
+            m_tile_touched[(size_t)(ty * tilesX + tx)] = now;
+        }
+    }
+}
+
+/*! \brief  Bucket fill the region under (x,y) of the canvas with the paintbrush color as one
+*           undoable command. The strokes are flattened over the image first to find
+*           the fill boundary. The fill stays within the image. In indexed mode the region
+*           is found and filled on the indices, within the view.
+*/
+int App::FillCommand(int x, int y) {
+    DrainPipeline();
+    EndRasterStroke();
+    if (m_indexed != nullptr) {
+        const int index = m_indexed->AddColor(*m_current_color);
+        if (index == IndexedCanvas::NO_INDEX) {
+            std::cout << "The palette of indexed mode is full" << std::endl;
+            return 0;
+        }
+        const sf::IntRect view(m_view_origin.x, m_view_origin.y, m_view_size.x, m_view_size.y);
+        std::unique_ptr<IndexedDelta> fill(new IndexedDelta(*m_indexed, *m_image, "Fill"));
+        fill->touch(view.left, view.top, view.left + view.width - 1, view.top + view.height - 1);
+        m_indexed->Fill(x, y, index, view);
+        if (!fill->execute()) {
+            return 0;
+        }
+        ShowIndexed(fill->getBounds());
+        PushRasterCommand(std::move(fill));
+        JournalFill(x, y, *m_current_color);
+        return 1;
+    }
+    sf::Image composite = Flatten();
+
+    std::unique_ptr<Fill> fill(new Fill(x - m_view_origin.x, y - m_view_origin.y, *m_image, *m_current_color, composite));
+    fill->setThreadPool(m_thread_pool);
+    if (!fill->execute()) {
+        return 0;
+    }
+    MarkDirty(fill->getBounds());
+    m_texture->update(*m_image);
+    PushRasterCommand(std::move(fill));
+    JournalFill(x, y, *m_current_color);
+    return 1;
+}
+
+/*! \brief  Paint every pixel of the canvas of the color at (x,y) of it with the paintbrush
+*           color, as one undoable command. Only the palette entries of the color change, so a
+*           recolor takes as long for a canvas of any size and keeps no pixels for undo. Needs
+*           indexed mode. Returns the number of palette entries changed.
+*/
+int App::RecolorCommand(int x, int y) {
+    if (m_indexed == nullptr) {
+        std::cout << "Recoloring needs indexed mode" << std::endl;
+        return 0;
+    }
+    DrainPipeline();
+    EndRasterStroke();
+    if (x < 0 || y < 0 || x >= m_indexed->GetWidth() || y >= m_indexed->GetHeight()) {
+        return 0;
+    }
+    std::unique_ptr<PaletteSwap> swap(new PaletteSwap(*m_indexed, *m_image, m_indexed->GetPixel(x, y), *m_current_color));
+    if (!swap->execute()) {
+        return 0;
+    }
+    const int colorCount = (int)swap->getColorCount();
+    ShowIndexed(swap->getBounds());
+    PushRasterCommand(std::move(swap));
+    if (IsJournaling()) {
+        std::vector<sf::Uint8> record{RECOLOR_RECORD};
+        Varint::PutSigned(record, x);
+        Varint::PutSigned(record, y);
+        Varint::PutUint32(record, MathUtility::PackColor(*m_current_color));
+        JournalRecord(record);
+    }
+    return colorCount;
+}
+
+/*! \brief  Append a record of a bucket fill at (x,y) with color.
+*
+*/
+void App::JournalFill(int x, int y, const sf::Color& color) {
+    if (!IsJournaling()) {
+        return;
+    }
+    std::vector<sf::Uint8> record{FILL_RECORD};
+    Varint::PutSigned(record, x);
+    Varint::PutSigned(record, y);
+    Varint::PutUint32(record, MathUtility::PackColor(color));
+    JournalRecord(record);
+}
+
+/*! \brief  Paint a batch of pixels into the image as one command. Batches painted until
+*           the next gesture ends (PushGesture, undo, redo...) are undone together, like the
+*           line segments of a stroke. Returns the number of pixels changed, or 0 in indexed mode.
+*/
+int App::PaintPixels(std::unique_ptr<PixelBatch> batch) {
+    if (m_indexed != nullptr) {
+        std::cout << "Pixel batches are painted into the image, which indexed mode does not have" << std::endl;
+        return 0;
+    }
+    DrainPipeline();
+    // A raster mode stroke being drawn must save its tiles before the batch changes them.
+    if (m_stroke_delta) {
+        EndRasterStroke();
+    }
+    if (!batch->execute()) {
+        return 0;
+    }
+    MarkDirty(batch->getBounds());
+    m_texture->update(*m_image);
+    const int pixelCount = (int)batch->getPixelCount();
+    if (IsJournaling()) {
+        std::vector<sf::Uint8> record{PIXELS_RECORD, (sf::Uint8)(m_batch_stroke ? 0 : 1)};
+        Varint::PutUint32(record, MathUtility::PackColor(batch->getColor()));
+        Varint::Put(record, batch->getIndices().size());
+        std::int64_t prevIndex = 0;
+        for (const sf::Uint32 index : batch->getIndices()) {
+            Varint::PutSigned(record, (std::int64_t)index - prevIndex);
+            prevIndex = index;
+        }
+        JournalRecord(record);
+    }
+    if (m_batch_stroke) {
+        RasterEntry entry;
+        entry.bytes = batch->getByteSize();
+        entry.command = std::move(batch);
+        m_history_bytes += entry.bytes;
+        m_raster_commands.push_back(std::move(entry));
+        m_gestures[m_gesture_cursor].end = (sf::Uint32)m_raster_commands.size();
+        if (m_checkpoints.find(m_gesture_cursor) != m_checkpoints.end()) {
+            m_checkpoints[m_gesture_cursor] = Snapshot();
+        }
+        TrimHistory();
+    }
+    else {
+        PushRasterCommand(std::move(batch));
+        m_batch_stroke = true;
+    }
+    return pixelCount;
+}
+
+/*! \brief  Undo the gesture at the cursor and move the cursor to its parent. A stroke only
+*           drops its range of visible line segments, however many segments it has. Returns
+*           the number of lines undone, of raster commands for a raster gesture, or 1 for a
+*           switch of indexed mode. The opposite logic of the RedoCommand().
+*/
+int App::UndoCommand() {
+    // Need this if statement so we don't undo "nothing"
+    int numUndo = 0;
+    DrainPipeline();
+    EndRasterStroke();
+    if (m_gesture_cursor != NO_GESTURE) {
+        const Gesture gesture = m_gestures[m_gesture_cursor];
+        if (!StepBack(true)) {
+            return 0;
+        }
+        if (gesture.kind == RASTER_GESTURE) {
+            for (size_t i = gesture.end; i-- > gesture.begin; ) {
+                std::cout << "Undoing: " << m_raster_commands[i].command->getDescription() << std::endl;
+            }
+            if (m_indexed == nullptr) {
+                m_texture->update(*m_image);
+            }
+        }
+        else if (gesture.kind == INDEXED_GESTURE) {
+            std::cout << "Undoing: indexed mode, which is now " << (m_indexed != nullptr ? "on" : "off") << std::endl;
+        }
+        else {
+            std::cout << "Undoing: " << gesture.end - gesture.begin << " lines" << std::endl;
+        }
+        numUndo = gesture.kind == INDEXED_GESTURE ? 1 : (int)(gesture.end - gesture.begin);
+        TrimHistory();
+        JournalMove(UNDO_RECORD);
+    }
+    else {
+        std::cout << "There is nothing to undo" << std::endl;
+    }
+    return numUndo;
+}
+
+/*! \brief  Redo the child of the gesture at the cursor that was made or visited last.
+*           The opposite logic of the UndoCommand().
+*/
+int App::RedoCommand() {
+    // Need this if statement so we don't redo "nothing"
+    int numRedo = 0;
+    DrainPipeline();
+    EndRasterStroke();
+    const sf::Uint32 child = RedoChild(m_gesture_cursor);
+    if (child != NO_GESTURE) {
+        const Gesture gesture = m_gestures[child];
+        if (!StepForward(child, true)) {
+            return 0;
+        }
+        if (gesture.kind == RASTER_GESTURE) {
+            for (size_t i = gesture.begin; i < gesture.end; i++) {
+                std::cout << "Redoing: " << m_raster_commands[i].command->getDescription() << std::endl;
+            }
+            if (m_indexed == nullptr) {
+                m_texture->update(*m_image);
+            }
+        }
+        else if (gesture.kind == INDEXED_GESTURE) {
+            std::cout << "Redoing: indexed mode, which is now " << (m_indexed != nullptr ? "on" : "off") << std::endl;
+        }
+        else {
+            std::cout << "Redoing: " << gesture.end - gesture.begin << " lines" << std::endl;
+        }
+        numRedo = gesture.kind == INDEXED_GESTURE ? 1 : (int)(gesture.end - gesture.begin);
+        TrimHistory();
+        JournalMove(REDO_RECORD);
+    }
+    else {
+        std::cout << "There is nothing to redo" << std::endl;
+    }
+    return numRedo;
+}
+
+/*! \brief  Return a reference to our m_image, so that
+*           we do not have to publicly expose it.
+*		
+*/
+sf::Image& App::GetImage(){
+    return *m_image;
+}
+
+/*! \brief  Return a reference to our m_Texture so that
+*           we do not have to publicly expose it.
+*		
+*/
+sf::Texture& App::GetTexture(){
+    return *m_texture;
+}
+
+/*! \brief  Return a reference to our m_window
+*		
+*/
+sf::RenderWindow& App::GetWindow(){
+    return *m_window;
+}
+
+/*! \brief  Return a reference to our m_sprite
+*
+*/
+sf::Sprite& App::GetSprite(){
+    return *m_sprite;
+}
+
+sf::RenderTexture& App::GetRenderTexture(){
+    return *m_render_texture;
+}
+
+sf::Sprite& App::GetRenderSprite(){
+    return *m_render_sprite;
+}
+
+/*! \brief  Return a reference to our m_current_color
+*/
+sf::Color& App::GetPaintbrushColor() {
+    return *m_current_color;
+}
+
+/*! \brief  Set the m_current_color to the newColor
+*
+*/
+void App::SetPaintbrushColor(sf::Keyboard::Key numKey) {
+    *m_current_color = color_codes[numKey];
+}
+
+/*! \brief  Return a reference to our m_paintbrush_radius
+*
+*/
+int& App::GetPaintbrushRadius(){
+    return *m_paintbrush_radius;
+}
+
+/*! \brief  Set the m_paintbrush_radius to the new radius.
+*
+*/
+void App::SetPaintbrushRadius(int radius){
+    *m_paintbrush_radius = radius;
+}
+
+/*! \brief  Return the currently selected tool.
+*
+*/
+int App::GetTool() {
+    return m_tool;
+}
+
+/*! \brief  Select the tool used by the left mouse button.
+*
+*/
+void App::SetTool(int tool) {
+    m_tool = tool;
+}
+
+/*! \brief  Return true if strokes are painted into the image.
+*
+*/
+bool App::GetRasterMode() {
+    return m_raster_mode;
+}
+
+/*! \brief  Switch between keeping strokes as line segments and painting them into the image.
+*
+*/
+void App::SetRasterMode(bool rasterMode) {
+    if (!rasterMode && m_indexed != nullptr) {
+        std::cout << "Indexed mode only paints raster strokes" << std::endl;
+        return;
+    }
+    DrainPipeline();
+    EndRasterStroke();
+    // Line segments drawn without a gesture stay on the canvas, so they are journaled too.
+    if (!m_raster_mode) {
+        JournalStroke(false, 0);
+    }
+    m_raster_mode = rasterMode;
+}
+
+/*! \brief  Return true if the canvas is kept as palette indices.
+*
+*/
+bool App::GetIndexedMode() {
+    return m_indexed != nullptr;
+}
+
+/*! \brief  Switch indexed mode on or off. Turning it on reads every tile of the canvas into
+*           4 bit indices into a palette of white, the color codes and the other colors of
+*           the canvas, and drops m_image and the pages of the virtual canvas, so the canvas
+*           takes an eighth of the memory. Strokes are raster strokes in indexed mode. Turning
+*           it off writes the tiles changed in it back as RGBA8. Either way the switch is a
+*           gesture of the undo history, so undo goes back across it. Returns false if indexed
+*           mode stays off: the canvas has line segments on it or more than
+*           IndexedCanvas::MAX_COLORS colors.
+*/
+bool App::SetIndexedMode(bool indexedMode) {
+    if (indexedMode == (m_indexed != nullptr)) {
+        return true;
+    }
+    DrainPipeline();
+    EndRasterStroke();
+    if (!indexedMode) {
+        const size_t session = (size_t)(std::find_if(m_indexed_canvases.begin(), m_indexed_canvases.end(),
+            [this](const std::unique_ptr<IndexedCanvas>& indexed) { return indexed.get() == m_indexed; }) - m_indexed_canvases.begin());
+        SwitchIndexed(nullptr);
+        AddGesture(INDEXED_GESTURE, session, session);
+    }
+    else {
+        if (!m_visible_lines.empty() || m_loose_begin < m_draw_vector->size()) {
+            std::cout << "Indexed mode only paints raster strokes, so the canvas can not have line strokes on it" << std::endl;
+            return false;
+        }
+        // The indices are read from the virtual canvas, so the changed tiles go there first.
+        if (!WriteBack()) {
+            std::cout << "Could not write the canvas back" << std::endl;
+            return false;
+        }
+        std::unique_ptr<IndexedCanvas> indexed = ReadIndexed();
+        if (!indexed) {
+            std::cout << "Indexed mode needs a canvas of at most " << IndexedCanvas::MAX_COLORS << " colors" << std::endl;
+            return false;
+        }
+        m_indexed_canvases.push_back(std::move(indexed));
+        if (!SwitchIndexed(m_indexed_canvases.back().get())) {
+            m_indexed_canvases.pop_back();
+            return false;
+        }
+        AddGesture(INDEXED_GESTURE, m_indexed_canvases.size() - 1, m_indexed_canvases.size() - 1);
+    }
+    TrimHistory();
+    if (IsJournaling()) {
+        std::vector<sf::Uint8> record{INDEXED_RECORD, (sf::Uint8)(indexedMode ? 1 : 0)};
+        JournalRecord(record);
+    }
+    return true;
+}
+
+/*! \brief  Read every tile of the virtual canvas into indices into a palette of white, the
+*           color codes and the other colors of the canvas. Returns nullptr if the canvas has
+*           more than IndexedCanvas::MAX_COLORS colors.
+*/
+std::unique_ptr<IndexedCanvas> App::ReadIndexed() {
+    std::vector<sf::Color> palette{sf::Color::White};
+    for (int key = sf::Keyboard::Num1; key <= sf::Keyboard::Num8; key++) {
+        const auto code = color_codes.find((sf::Keyboard::Key)key);
+        if (code != color_codes.end() && std::find(palette.begin(), palette.end(), code->second) == palette.end()) {
+            palette.push_back(code->second);
+        }
+    }
+    const sf::Color background = m_virtual_canvas->GetBackground();
+    const int backgroundIndex = (int)(std::find(palette.begin(), palette.end(), background) - palette.begin());
+    if (backgroundIndex == (int)palette.size()) {
+        palette.push_back(background);
+    }
+    // Tiles never written to are of the background, which the indices start as.
+    std::unique_ptr<IndexedCanvas> indexed(new IndexedCanvas);
+    indexed->Create(m_virtual_canvas->GetWidth(), m_virtual_canvas->GetHeight(), palette, backgroundIndex);
+    const size_t stride = (size_t)VirtualCanvas::TILE_SIZE * 4;
+    std::vector<sf::Uint8> scratch((size_t)VirtualCanvas::TILE_SIZE * stride);
+    for (int tile = 0; tile < m_virtual_canvas->GetTileCount(); tile++) {
+        const sf::Uint8* encoded;
+        size_t encodedSize;
+        if (!m_virtual_canvas->GetEncodedTile(tile, encoded, encodedSize)) {
+            continue;
+        }
+        if (!m_virtual_canvas->ReadTile(tile, scratch.data(), stride) || !indexed->ReadTile(tile, scratch.data(), stride)) {
+            return nullptr;
+        }
+    }
+    return indexed;
+}
+
+/*! \brief  Turn indexed mode on with indexed, which must hold the canvas as it is, or off
+*           for nullptr, leaving the undo history alone. Undo and redo of an indexed gesture
+*           come here too, with the indices it was made with, which the commands after it change.
+*           Returns false if the changed tiles of m_image could not be written back.
+*/
+bool App::SwitchIndexed(IndexedCanvas* indexed) {
+    // The changed tiles go to the mip pyramid and the autosave first.
+    SyncMipPyramid();
+    if (indexed == nullptr) {
+        LeaveIndexedMode(true);
+        const int width = m_view_size.x;
+        const int height = m_view_size.y;
+        m_virtual_canvas->Read(m_view_origin.x, m_view_origin.y, *m_image, sf::IntRect(0, 0, width, height));
+        m_canvas->MarkDirty(0, 0, width - 1, height - 1);
+        std::fill(m_tile_touched.begin(), m_tile_touched.end(), std::chrono::steady_clock::now());
+        m_texture->update(*m_image);
+        return true;
+    }
+    if (!WriteBack()) {
+        std::cout << "Could not write the canvas back" << std::endl;
+        return false;
+    }
+    // The tiles that differ from the document are the ones to write back when leaving.
+    std::vector<int> pages;
+    m_virtual_canvas->GetPageTiles(pages);
+    m_indexed_written.assign((size_t)indexed->GetTileCount(), false);
+    for (const int tile : pages) {
+        m_indexed_written[(size_t)tile] = true;
+    }
+    m_indexed = indexed;
+    m_virtual_canvas->Create(m_indexed->GetWidth(), m_indexed->GetHeight(), m_virtual_canvas->GetBackground(), m_document);
+    m_image->create(0, 0);
+    m_canvas->Create(0, 0, sf::Color::White);
+    // Nothing reads the checkpoints of the image until indexed mode is left, so they go to
+    // the packer now rather than once they are cold.
+    PackColdTiles(true);
+    m_raster_mode = true;
+    UploadIndexed(sf::IntRect(m_view_origin.x, m_view_origin.y, m_view_size.x, m_view_size.y));
+    return true;
+}
+
+/*! \brief  Turn indexed mode off. If writeBack, the tiles it changed are expanded and written
+*           to the virtual canvas. m_image is made the size of the view again, but not read.
+*           The indices stay in m_indexed_canvases for the undo history.
+*/
+void App::LeaveIndexedMode(bool writeBack) {
+    if (m_indexed == nullptr) {
+        return;
+    }
+    if (writeBack) {
+        const size_t stride = (size_t)IndexedCanvas::TILE_SIZE * 4;
+        std::vector<sf::Uint8> scratch((size_t)IndexedCanvas::TILE_SIZE * stride);
+        for (size_t tile = 0; tile < m_indexed_written.size(); tile++) {
+            if (m_indexed_written[tile]) {
+                m_indexed->ExpandTile((int)tile, scratch.data(), stride);
+                m_virtual_canvas->WriteTile((int)tile, scratch.data(), stride);
+            }
+        }
+    }
+    m_indexed_stroke.reset();
+    m_indexed = nullptr;
+    m_indexed_changed.clear();
+    m_indexed_written.clear();
+    m_image->create(m_view_size.x, m_view_size.y, sf::Color::White);
+    m_canvas->Create(m_view_size.x, m_view_size.y, sf::Color::White);
+}
+
+/*! \brief  Paint a line segment into the indices, saving the tiles it is about to change for
+*           undo. A color the palette has no room for is not painted.
+*/
+void App::PaintIndexed(const RoundedLine& line) {
+    if (!m_indexed_stroke) {
+        m_indexed_stroke.reset(new IndexedDelta(*m_indexed, *m_image, "Stroke"));
+    }
+    const int index = m_indexed->AddColor(line.getColor());
+    if (index == IndexedCanvas::NO_INDEX) {
+        return;
+    }
+    const sf::IntRect bounds = line.getRasterBounds();
+    m_indexed_stroke->touch(bounds.left, bounds.top, bounds.left + bounds.width - 1, bounds.top + bounds.height - 1);
+    m_indexed->FillCapsule(line.getStartPoint(), line.getEndPoint(), line.getWidth(), index);
+    ShowIndexed(bounds);
+}
+
+/*! \brief  Mark the tiles of the indices under bounds of the canvas as changed, for the mip
+*           pyramid, the autosave and leaving indexed mode, and upload the part in view.
+*/
+void App::ShowIndexed(const sf::IntRect& bounds) {
+    if (bounds.width <= 0 || bounds.height <= 0) {
+        return;
+    }
+    const int size = IndexedCanvas::TILE_SIZE;
+    const int tilesX = m_indexed->GetTilesX();
+    const int tilesY = m_indexed->GetTileCount() / tilesX;
+    const int x0 = std::max(bounds.left / size, 0);
+    const int y0 = std::max(bounds.top / size, 0);
+    const int x1 = std::min((bounds.left + bounds.width - 1) / size, tilesX - 1);
+    const int y1 = std::min((bounds.top + bounds.height - 1) / size, tilesY - 1);
+    for (int ty = y0; ty <= y1; ty++) {
+        for (int tx = x0; tx <= x1; tx++) {
+            m_indexed_changed.insert(ty * tilesX + tx);
+            m_indexed_written[(size_t)(ty * tilesX + tx)] = true;
+        }
+    }
+    UploadIndexed(bounds);
+}
+
+/*! \brief  Expand the part of bounds of the canvas that is in view into m_texture.
+*
+*/
+void App::UploadIndexed(const sf::IntRect& bounds) {
+    sf::IntRect area;
+    if (!bounds.intersects(sf::IntRect(m_view_origin.x, m_view_origin.y, m_view_size.x, m_view_size.y), area)) {
+        return;
+    }
+    m_texture->update(ExpandIndexed(area), (unsigned int)(area.left - m_view_origin.x), (unsigned int)(area.top - m_view_origin.y));
+}
+
+/*! \brief  Return the pixels of area of the canvas expanded from the indices, with the
+*           background where area is off the canvas.
+*/
+sf::Image App::ExpandIndexed(const sf::IntRect& area) {
+    sf::Image image;
+    image.create((unsigned int)area.width, (unsigned int)area.height, m_virtual_canvas->GetBackground());
+    m_indexed->ExpandRect(area, MathUtility::MutablePixels(image), (size_t)area.width * 4);
+    return image;
+}
+
+/*! \brief  Return the bytes of indices of indexed mode, counting the ones kept for the undo
+*           history after it was turned off.
+*/
+size_t App::GetIndexedBytes() {
+    size_t bytes = 0;
+    for (const std::unique_ptr<IndexedCanvas>& indexed : m_indexed_canvases) {
+        bytes += indexed->GetByteSize();
+    }
+    return bytes;
+}
+
+/*! \brief  Return true if the window shows the timeline instead of the canvas.
+*
+*/
+bool App::GetTimelineMode() {
+    return m_timeline_mode;
+}
+
+/*! \brief  Show the canvas as it looked after the gesture ScrubTo() picked, or go back to
+*           the canvas. Entering timeline mode starts at the gesture at the cursor.
+*/
+void App::SetTimelineMode(bool timelineMode) {
+    if (timelineMode && !m_timeline_mode) {
+        DrainPipeline();
+        EndRasterStroke();
+        ScrubTo(m_gesture_cursor);
+    }
+    m_timeline_mode = timelineMode;
+}
+
+/*! \brief  Set the sprite cursor position on the window and apply an offset because
+*           the pointer tip is not exactly in the center of the cursor.
+*/
+void App::SetCursorPosition(const int &x, const int &y) {
+    m_cursor_sprite->setPosition(x - *m_paintbrush_radius, y - *m_paintbrush_radius);
+}
+
+/*! \brief  Generate a new cursor if the paintbrush radius or color is changed.
+*		
+*/
+void App::GenerateCursor(int radius, sf::Color paintbrush_color) {
+    radius += 1;
+    // Build our circle shape
+    m_cursor_circle -> setRadius(radius);
+    m_cursor_circle -> setFillColor(paintbrush_color);
+    m_cursor_circle -> setPointCount(4*radius);
+    if (paintbrush_color == sf::Color::Black || paintbrush_color == sf::Color::Blue) {
+        m_cursor_circle -> setOutlineColor(sf::Color::White);
+    }
+    else {
+        m_cursor_circle -> setOutlineColor(sf::Color::Black);
+    }
+    m_cursor_circle -> setOutlineThickness(-1);
+
+    // Create the cursor texture and draw our circle shape on it
+    m_cursor_texture -> create((radius)*2, (radius)*2);
+    m_cursor_texture -> clear(sf::Color::Transparent);
+    //m_cursor_texture -> setSmooth(true);
+    m_cursor_texture -> draw(*m_cursor_circle);
+    m_cursor_sprite -> setTexture(m_cursor_texture -> getTexture(), true);
+}
+
+/*! \brief  Generate and cache a circle template for drawing.
+*
+*/
+void App::GenerateCircleTemplate(int radius) {
+    *m_circle_template = MathUtility::BresenhamCircleAlgo(radius);
+}
+
+/*! \brief  A cached circle template generated at (0,0) which is shifted by (x,y) 
+*           rather than constantly computing the same circle.
+*/
+std::vector<std::pair<int,int>> App::UseCircleTemplate(int x, int y) {
+	std::vector<std::pair<int,int>> transformedCircle;
+    // Reserve memory in vector to get 4x performance: https://github.com/facontidavide/CPP_Optimizations_Diary/blob/master/docs/reserve.md 
+    transformedCircle.reserve((m_circle_template->size()*8));
+    // Use std::transform to shift the circle template by (x,y)
+    std::transform(m_circle_template->begin(), m_circle_template->end(), std::back_inserter(transformedCircle),
+    	[x,y](std::pair<int,int> p) {
+    		return std::make_pair(p.first + x, p.second + y);
+    	});
+    return transformedCircle;
+}
+
+/*! \brief 	Destroy all raw pointers before ending the program.
+*		
+*/
+void App::Destroy(){
+    DrainPipeline();
+    CloseJournal();
+    StopAutosave();
+    delete m_pipeline;
+    // Stop the timeline before the history it renders from goes away, and finish the saves
+    delete m_timeline;
+    delete m_exporter;
+    delete m_importer;
+    delete m_tile_packer;
+    m_indexed = nullptr;
+    m_indexed_canvases.clear();
+    // Stop the pyramid worker before the document it may read goes away
+    delete m_mip_pyramid;
+    delete m_document;
+    delete m_scrub_texture;
+    delete m_scrub_sprite;
+    delete m_prev_point;
+    delete m_render_texture;
+    delete m_render_sprite;
+    delete m_current_color;
+    delete m_paintbrush_radius;
+    delete m_cursor_sprite;
+    delete m_cursor_texture;
+    delete m_cursor_circle;
+    delete m_circle_template;
+    delete m_image;
+    delete m_canvas;
+    delete m_virtual_canvas;
+    delete m_level_sprite;
+    delete m_level_texture;
+    delete m_level_image;
+    delete m_sprite;
+    delete m_texture;
+    delete m_window;
+    delete m_thread_pool;
+    delete m_draw_vector;
+    delete m_spill_file;
+}
+
+/*! \brief  Initializes the App and sets up the main
+*           rendering window(i.e. our canvas.)
+*/
+void App::Init(void (*initFunction)(void)){
+    // Create our window
+    int width = 1280;
+    int height = 720;
+    sf::ContextSettings settings;
+    settings.antialiasingLevel = 16;
+    m_window = new sf::RenderWindow(sf::VideoMode(width,height),"Mini-Paint alpha 0.0.3",sf::Style::Titlebar | sf::Style::Close, settings);
+    //m_window -> clear(sf::Color::White);
+    m_window -> setFramerateLimit(60);
+    m_window -> setVerticalSyncEnabled(true);
+    // Set the mouse cursor to be invisible because we are going to draw our own cursor
+    m_window->setMouseCursorVisible(false);
+    // Create an image which stores the pixels we will update
+    m_view_size = sf::Vector2i(width, height);
+    m_image->create(width, height, sf::Color::White);
+    m_canvas->Create(width, height, sf::Color::White);
+    m_virtual_canvas->Create(width, height, sf::Color::White);
+    m_window_dirty.assign((size_t)m_canvas->GetTileCount(), false);
+    m_tile_touched.assign((size_t)m_canvas->GetTileCount(), std::chrono::steady_clock::now());
+    m_pack_time = std::chrono::steady_clock::now();
+    m_mip_pyramid->Reset(width, height, sf::Color::White);
+    m_mip_dirty.assign((size_t)m_canvas->GetTileCount(), false);
+    m_mip_sync_time = std::chrono::steady_clock::now();
+    m_level_image->create(width, height, sf::Color::White);
+    m_level_texture->loadFromImage(*m_level_image);
+    m_level_sprite->setTexture(*m_level_texture);
+    m_checkpoints[NO_GESTURE] = Snapshot();
+    assert(m_image != nullptr && "m_image != nullptr");
+    // Create a texture which lives in the GPU and will render our image
+    m_texture->loadFromImage(*m_image);
+    assert(m_texture != nullptr && "m_texture != nullptr");
+    // // Create a sprite which is the entity that can be textured
+    m_sprite->setTexture(*m_texture);
+    assert(m_sprite != nullptr && "m_sprite != nullptr");
+    m_render_texture->create(width, height);
+    m_render_texture->clear(sf::Color::White);
+    m_render_sprite->setTextureRect(sf::IntRect(0, height, width, -height));
+    // Initialize current color = black
+    SetPaintbrushColor(sf::Keyboard::Num0);
+    // Initialize the cursor radius
+    m_paintbrush_radius = new int(5);
+    // Generate the cursor with current color = black
+    GenerateCursor(*m_paintbrush_radius, sf::Color::Black);
+    // Set the cursor initial position to off screen so it doesn't momentarily appear
+    int x = -10;
+    int y = -10;
+    SetCursorPosition(x, y);
+    GenerateCircleTemplate(5);
+    m_initFunc = initFunction;
+}
+
+/*! \brief  Set a callback function which will be called
+*           each iteration of the main loop before drawing.
+*		
+*/
+void App::UpdateCallback(void (*updateFunction)(App& myApp)){
+    m_updateFunc = updateFunction;
+}
+
+/*! \brief  Set a callback function which will be called
+*           each iteration of the main loop after update.
+*		
+*/
+void App::DrawCallback(void (*drawFunction)(App& myApp)){
+    m_drawFunc = drawFunction;
+}
+
+/*! \brief 	The main loop function which handles initialization
+            and will be executed until the main window is closed.
+            Within the loop function the update and draw callback
+            functions will be called.
+*		
+*/
+void App::Loop(App& myApp){
+    // Call the init function
+    m_initFunc();
+
+    // Start the main rendering loop
+    while(m_window->isOpen()){
+        // Clear the window
+        m_window->clear(sf::Color::White);
+        // Updates specified by the user
+        m_updateFunc(myApp);
+        // Record the strokes the pipeline finished and upload what it painted
+        CollectStrokes();
+        // Execute the line segments other threads (network, script playback) queued
+        ExecuteCommand();
+        // Additional drawing specified by user
+        m_drawFunc(myApp);
+        // Report the saves the exporter finished
+        CollectSaves();
+        // Open the images the importer finished
+        CollectImports();
+        // Hand what changed since the last autosave to its worker, every autosave interval
+        if (m_autosave != nullptr && std::chrono::steady_clock::now() - m_autosave_time >= std::chrono::milliseconds(m_autosave_interval_ms)) {
+            AutosaveNow();
+        }
+        // Pack the tiles of the snapshots that went cold, every pack interval
+        if (std::chrono::steady_clock::now() - m_pack_time >= std::chrono::milliseconds(PACK_INTERVAL_MS)) {
+            PackColdTiles();
+        }
+        // In timeline mode show the newest scrub position the timeline rendered with its
+        // strokes over it, and how far along the history it is, instead of the canvas
+        if (m_timeline_mode) {
+            CollectScrub();
+            const sf::Vector2i scrubOrigin = OriginOf(m_scrub_gesture);
+            sf::View scrubView(sf::FloatRect((float)scrubOrigin.x, (float)scrubOrigin.y, (float)m_view_size.x, (float)m_view_size.y));
+            scrubView.zoom(1.0f / m_zoom);
+            m_window->setView(scrubView);
+            m_window->draw(*m_scrub_sprite);
+            for (const std::pair<size_t, size_t>& range : m_scrub_strokes) {
+                for (size_t i = range.first; i < range.second; i++) {
+                    m_window->draw(*(*m_draw_vector)[i]);
+                }
+            }
+            m_window->setView(m_window->getDefaultView());
+            const float position = m_scrub_gesture == NO_GESTURE ? 0.0f : (float)(m_scrub_gesture + 1) / (float)m_gestures.size();
+            sf::RectangleShape bar(sf::Vector2f(position * (float)m_window->getSize().x, 6.0f));
+            bar.setPosition(0.0f, (float)m_window->getSize().y - 6.0f);
+            bar.setFillColor(sf::Color::Blue);
+            m_window->draw(bar);
+            m_window->display();
+            continue;
+        }
+        // Update the texture
+        // Note: This can be done in the 'draw call'
+        // Draw to the canvas
+        // m_window->draw(*m_render_sprite);
+        // Look at the image where it is on the canvas, magnified around its center. The
+        // strokes are in canvas coordinates, so they line up with it.
+        sf::View view(sf::FloatRect((float)m_view_origin.x, (float)m_view_origin.y, (float)m_view_size.x, (float)m_view_size.y));
+        view.zoom(1.0f / m_zoom);
+        m_window->setView(view);
+        // Draw the raster layer (bucket fills) below the strokes: zoomed out, the level of
+        // the mip pyramid under the view instead, which the changed tiles go to when its
+        // worker is done with the ones before. Not zoomed out, the pyramid is not shown, so
+        // they only go to it now and then, to keep the work of zooming out small.
+        if (!m_mip_pyramid->IsBusy() && (GetMipLevel() > 0 || std::chrono::steady_clock::now() - m_mip_sync_time >= std::chrono::milliseconds(MIP_SYNC_INTERVAL_MS))) {
+            SyncMipPyramid();
+        }
+        if (RenderLevel() != nullptr) {
+            m_window->draw(*m_level_sprite);
+        } else {
+            m_sprite->setPosition((float)m_view_origin.x, (float)m_view_origin.y);
+            m_window->draw(*m_sprite);
+        }
+        
+        // Draw the lines of the strokes from the root of the undo tree to the cursor,
+        // then the ones not in a stroke yet
+        for (const std::pair<size_t, size_t>& range : m_visible_lines) {
+            for (size_t i = range.first; i < range.second; i++) {
+                m_window->draw(*(*m_draw_vector)[i]);
+            }
+        }
+        for (size_t i = m_loose_begin; i < m_draw_vector->size(); i++) {
+            m_window->draw(*(*m_draw_vector)[i]);
+        }
+
+        // Show the progress of the saves still encoding along the top
+        m_window->setView(m_window->getDefaultView());
+        if (GetSaveProgress() < 1.0f) {
+            sf::RectangleShape bar(sf::Vector2f(GetSaveProgress() * (float)m_window->getSize().x, 6.0f));
+            bar.setFillColor(sf::Color::Green);
+            m_window->draw(bar);
+        }
+        // and of the imports under it
+        if (GetImportProgress() < 1.0f) {
+            sf::RectangleShape bar(sf::Vector2f(GetImportProgress() * (float)m_window->getSize().x, 6.0f));
+            bar.setPosition(0.0f, 6.0f);
+            bar.setFillColor(sf::Color::Cyan);
+            m_window->draw(bar);
+        }
+        m_window->draw(*m_cursor_sprite);
+        // Display the canvas
+        m_window->display();
+    }
+}
+
+
@@ -0,0 +1,307 @@
+/** 
+ *  @file   Autosave.cpp 
+ *  @brief  Implementation of Autosave.hpp
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include standard library C++ libraries.
+#include <cstdio>
+// Project header files
+#include "Autosave.hpp"
+#include "StrokeCodec.hpp"
+#include "Varint.hpp"
+
+namespace {
+
+// The worker flushes the journal at the end of every save, so the journal's own writer
+// thread, which flushes on a timer, should not cut in while a save is half appended.
+const int JOURNAL_FLUSH_INTERVAL_MS = 60 * 1000;
+
+// Rename the file at from over the one at to, if there is one.
+bool RenameOver(const std::string& from, const std::string& to) {
+#ifdef _WIN32
+    // Windows does not rename over an existing file.
+    std::remove(to.c_str());
+#endif
+    return std::rename(from.c_str(), to.c_str()) == 0;
+}
+
+// Apply one record of a committed save to state. Returns false if it is not a record of one.
+bool ApplyRecord(const std::vector<sf::Uint8>& record, Autosave::State& state) {
+    const sf::Uint8* p = record.data() + 1;
+    const sf::Uint8* end = record.data() + record.size();
+    std::uint64_t a;
+    std::uint64_t b;
+    std::uint64_t c;
+    switch (record[0]) {
+        case Autosave::HEADER_RECORD:
+            if (!Varint::Get(p, end, a) || !Varint::Get(p, end, b) || !Varint::Get(p, end, c)) {
+                return false;
+            }
+            state.width = (int)a;
+            state.height = (int)b;
+            state.baseStrokes = (size_t)c;
+            state.base.assign(p, end);
+            state.tiles.clear();
+            state.lines.clear();
+            state.strokeEnds.clear();
+            return true;
+        case Autosave::TILE_RECORD:
+            if (!Varint::Get(p, end, a)) {
+                return false;
+            }
+            state.tiles[(int)a].assign(p, end);
+            return true;
+        case Autosave::STROKES_RECORD: {
+            if (!Varint::Get(p, end, a)) {
+                return false;
+            }
+            // Cut the strokes back to the ones kept, which may go into the base ones.
+            if (a <= state.baseStrokes) {
+                state.baseStrokes = (size_t)a;
+                state.strokeEnds.clear();
+            } else if (a - state.baseStrokes <= state.strokeEnds.size()) {
+                state.strokeEnds.resize((size_t)(a - state.baseStrokes));
+            } else {
+                return false;
+            }
+            state.lines.resize(state.strokeEnds.empty() ? 0 : state.strokeEnds.back());
+            StrokeReader reader(p, (size_t)(end - p));
+            while (!reader.AtEnd()) {
+                if (!reader.ReadStroke(state.lines)) {
+                    return false;
+                }
+                state.strokeEnds.push_back(state.lines.size());
+            }
+            return true;
+        }
+        default:
+            return false;
+    }
+}
+
+}
+
+/*! \brief  Autosave constructor. Starts the worker; nothing is written until Open().
+*
+*/
+Autosave::Autosave() : m_saving(false),
+    m_stopping(false),
+    m_failed(false),
+    m_save_count(0),
+    m_last_bytes(0),
+    m_total_bytes(0),
+    m_file_size(0) {
+    m_worker = std::thread(&Autosave::WorkerLoop, this);
+}
+
+/*! \brief  Autosave destructor. Waits for the saved jobs, so the last changes are not lost,
+*           and joins the worker.
+*/
+Autosave::~Autosave() {
+    Wait();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_worker.join();
+    m_journal.Close();
+}
+
+/*! \brief  Start an empty autosave at path. An autosave already there, e.g. of a session
+*           that crashed and was not restored, is kept at path + ".prev" in place of the one
+*           kept before it.
+*/
+bool Autosave::Open(const std::string& path) {
+    Wait();
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_journal.Close();
+    RenameOver(path, path + ".prev");
+    m_path = path;
+    m_failed = !m_journal.Open(path, JOURNAL_FLUSH_INTERVAL_MS);
+    m_file_size = m_journal.GetSize();
+    return !m_failed;
+}
+
+/*! \brief  Take the oldest job and write it, until the autosave is destroyed.
+*
+*/
+void Autosave::WorkerLoop() {
+    while (true) {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+            if (m_jobs.empty()) {
+                return;
+            }
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+            m_saving = true;
+        }
+        const size_t bytes = Write(*job);
+        job.reset();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_saving = false;
+            m_failed = m_failed || bytes == 0;
+            if (bytes > 0) {
+                m_save_count++;
+                m_last_bytes = bytes;
+                m_total_bytes += bytes;
+                m_file_size = m_journal.GetSize();
+            }
+        }
+        m_idle.notify_all();
+    }
+}
+
+/*! \brief  Append the header, tiles and strokes of job, then its commit record, and fsync
+*           the file once for all of them. A restart is written to a new file beside the old
+*           one, which it is renamed over once it is on disk, so there is an autosave to
+*           restore all the way through.
+*/
+size_t Autosave::Write(const Job& job) {
+    const std::string temp = m_path + ".tmp";
+    if (job.restart) {
+        m_journal.Close();
+        std::remove(temp.c_str());
+        if (!m_journal.Open(temp, JOURNAL_FLUSH_INTERVAL_MS)) {
+            return 0;
+        }
+    }
+    if (!m_journal.IsOpen()) {
+        return 0;
+    }
+    const size_t before = job.restart ? 0 : m_journal.GetSize();
+    std::vector<sf::Uint8> record;
+    if (job.restart) {
+        record.push_back(HEADER_RECORD);
+        Varint::Put(record, (std::uint64_t)job.width);
+        Varint::Put(record, (std::uint64_t)job.height);
+        Varint::Put(record, job.baseStrokes);
+        record.insert(record.end(), job.base.begin(), job.base.end());
+        m_journal.Append(record);
+    }
+    for (const std::pair<int, std::vector<sf::Uint8>>& tile : job.tiles) {
+        record.assign(1, TILE_RECORD);
+        Varint::Put(record, (std::uint64_t)tile.first);
+        record.insert(record.end(), tile.second.begin(), tile.second.end());
+        m_journal.Append(record);
+    }
+    if (job.strokesChanged) {
+        record.assign(1, STROKES_RECORD);
+        Varint::Put(record, job.keptStrokes);
+        record.insert(record.end(), job.strokes.begin(), job.strokes.end());
+        m_journal.Append(record);
+    }
+    record.assign(1, COMMIT_RECORD);
+    Varint::Put(record, GetSaveCount() + 1);
+    m_journal.Append(record);
+    if (!m_journal.Flush()) {
+        if (job.restart) {
+            // Later saves are not appended to a file that is not the autosave.
+            m_journal.Close();
+            std::remove(temp.c_str());
+        }
+        return 0;
+    }
+    if (job.restart) {
+        m_journal.Close();
+        if (!RenameOver(temp, m_path) || !m_journal.Open(m_path, JOURNAL_FLUSH_INTERVAL_MS)) {
+            std::remove(temp.c_str());
+            return 0;
+        }
+    }
+    return m_journal.GetSize() - before;
+}
+
+/*! \brief  Queue a job for the worker.
+*
+*/
+void Autosave::Save(std::unique_ptr<Job> job) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(std::move(job));
+    }
+    m_wake.notify_one();
+}
+
+/*! \brief  Return true while a job waits or is written.
+*
+*/
+bool Autosave::IsBusy() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_saving || !m_jobs.empty();
+}
+
+/*! \brief  Wait until the worker has written every saved job.
+*
+*/
+void Autosave::Wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return !m_saving && m_jobs.empty(); });
+}
+
+/*! \brief  Return false if the file could not be opened or a save could not be written.
+*
+*/
+bool Autosave::IsGood() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return !m_failed;
+}
+
+size_t Autosave::GetSaveCount() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_save_count;
+}
+
+size_t Autosave::GetLastBytes() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_last_bytes;
+}
+
+size_t Autosave::GetTotalBytes() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_total_bytes;
+}
+
+size_t Autosave::GetFileSize() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_file_size;
+}
+
+/*! \brief  Read the records of the autosave at path and apply each save once its commit
+*           record is read, so the records of a save torn by a crash are left out.
+*/
+bool Autosave::Load(const std::string& path, State& state) {
+    std::vector<std::vector<sf::Uint8>> records;
+    size_t validSize;
+    if (!Journal::ReadRecords(path, records, validSize)) {
+        return false;
+    }
+    state = State();
+    size_t begin = 0;
+    for (size_t i = 0; i < records.size(); i++) {
+        if (records[i].empty()) {
+            return false;
+        }
+        if (records[i][0] != COMMIT_RECORD) {
+            continue;
+        }
+        // Every save starts from a header, the first one or one in an earlier save.
+        if (records[begin][0] != HEADER_RECORD && state.saveCount == 0) {
+            return false;
+        }
+        for (; begin < i; begin++) {
+            if (!ApplyRecord(records[begin], state)) {
+                return false;
+            }
+        }
+        begin = i + 1;
+        state.saveCount++;
+    }
+    return state.saveCount > 0;
+}
@@ -1,22 +1,88 @@
-/** 
- *  @file   Command.cpp 
- *  @brief  Implementation of Command.hpp
- *  @author Mike and Dennis Ping 
- *  @date   2021-11-13
- ***********************************************/
-
-// Include our Third-Party SFML header
-// #include ...
-// Include standard library C++ libraries.
-// Project header files
-#include "Command.hpp"
-
-/*! \brief 	Command constructor.
-*		
-*/
-Command::Command(sf::Image& image) : m_image(image) {}
-
-/*! \brief 	Command destructor.
-*		
-*/
-Command::~Command(){}
\ No newline at end of file
+/** 
+ *  @file   Command.cpp 
+ *  @brief  Implementation of Command.hpp
+ *  @author Mike and Dennis Ping 
+ *  @date   2021-11-13
+ ***********************************************/
+
+// Include our Third-Party SFML header
+// #include ...
+// Include standard library C++ libraries.
+#include <map>
+// Project header files
+#include "Command.hpp"
+#include "MathUtility.hpp"
+
+/*! \brief 	Command constructor.
+*		
+*/
+Command::Command(sf::Image& image) : m_image(image) {}
+
+/*! \brief 	Command destructor.
+*		
+*/
+Command::~Command(){}
+
+/*! \brief 	Return a writable pointer to the pixels of m_image.
+*		
+*/
+sf::Uint8* Command::pixels() {
+    return MathUtility::MutablePixels(m_image);
+}
+
+/*! \brief 	Return the name of a palette color, e.g. "Red".
+*		
+*/
+std::string Command::colorName(sf::Color color) {
+    // C++ does not know how to hash an sf::Color object, so we must use the literal integer value.
+    const std::map<sf::Uint32, std::string> colorMap {
+        {255, "Black"},
+        {4294967295, "White"},
+        {4278190335, "Red"},
+        {16711935, "Green"},
+        {65535, "Blue"},
+        {4294902015, "Yellow"},
+        {4278255615, "Magenta"},
+        {16777215, "Cyan"},
+        {0, "Transparent"}
+    };
+    return colorMap.at(color.toInteger());
+}
+
+/*! \brief 	Return the bytes of undo data the command holds in memory.
+*		
+*/
+size_t Command::getByteSize() const {
+    return 0;
+}
+
+/*! \brief 	Commands can not spill their undo data unless they override this.
+*		
+*/
+bool Command::spill(std::vector<sf::Uint8>& bytes) {
+    (void)bytes;
+    return false;
+}
+
+/*! \brief 	Commands can not restore undo data unless they override this.
+*		
+*/
+bool Command::restore(const std::vector<sf::Uint8>& bytes) {
+    (void)bytes;
+    return false;
+}
+
+/*! \brief 	Return the pixels the command may change, the whole image unless overridden.
+*		
+*/
+sf::IntRect Command::getBounds() const {
+    return sf::IntRect(0, 0, (int)m_image.getSize().x, (int)m_image.getSize().y);
+}
+
+/*! \brief 	Commands can not redo into another image unless they override this.
+*		
+*/
+bool Command::redoInto(sf::Image& image) const {
+    (void)image;
+    return false;
+}
\ No newline at end of file
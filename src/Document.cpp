@@ -0,0 +1,438 @@
+/** 
+ *  @file   Document.cpp 
+ *  @brief  Implementation of Document.hpp
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include standard library C++ libraries.
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+// Project header files
+#include "Document.hpp"
+#include "MathUtility.hpp"
+#include "StrokeCodec.hpp"
+#include "TileCodec.hpp"
+
+namespace {
+
+// The first bytes of every document file.
+const sf::Uint8 DOCUMENT_MAGIC[4] = {'M', 'P', 'D', '2'};
+// Zeros written where the index goes until Finish() knows it.
+const size_t ZERO_CHUNK = 65536;
+
+template <typename T>
+T Load(const sf::Uint8* p) {
+    T value;
+    std::memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+template <typename T>
+void Store(sf::Uint8* p, T value) {
+    std::memcpy(p, &value, sizeof(value));
+}
+
+// Pixel rectangle of a tile of a width x height document, clipped to it.
+sf::IntRect TileRect(int tile, int tilesX, int width, int height) {
+    const int left = (tile % tilesX) * Document::TILE_SIZE;
+    const int top = (tile / tilesX) * Document::TILE_SIZE;
+    return sf::IntRect(left, top, std::min(Document::TILE_SIZE, width - left), std::min(Document::TILE_SIZE, height - top));
+}
+
+}
+
+/*! \brief  Document constructor. Nothing is mapped until Open().
+*
+*/
+Document::Document() : m_data(nullptr),
+    m_size(0),
+#ifdef _WIN32
+    m_file(INVALID_HANDLE_VALUE),
+    m_mapping(nullptr),
+#else
+    m_file(-1),
+#endif
+    m_width(0),
+    m_height(0),
+    m_tiles_x(0),
+    m_tiles_y(0),
+    m_decoded_count(0) {
+}
+
+/*! \brief  Document destructor. Unmaps the file.
+*
+*/
+Document::~Document() {
+    Close();
+}
+
+/*! \brief  Map the file at path read only and check its header and that its index fits.
+*           Nothing else is read here.
+*/
+bool Document::Open(const std::string& path) {
+    Close();
+#ifdef _WIN32
+    m_file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_DELETE, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    LARGE_INTEGER fileSize;
+    if (m_file == INVALID_HANDLE_VALUE || !GetFileSizeEx(m_file, &fileSize) || fileSize.QuadPart < (LONGLONG)HEADER_SIZE) {
+        Close();
+        return false;
+    }
+    m_size = (size_t)fileSize.QuadPart;
+    m_mapping = CreateFileMappingA(m_file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    m_data = m_mapping != nullptr ? (const sf::Uint8*)MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if (m_data == nullptr) {
+        Close();
+        return false;
+    }
+#else
+    m_file = ::open(path.c_str(), O_RDONLY);
+    struct stat fileStat;
+    if (m_file < 0 || fstat(m_file, &fileStat) != 0 || fileStat.st_size < (off_t)HEADER_SIZE) {
+        Close();
+        return false;
+    }
+    m_size = (size_t)fileStat.st_size;
+    void* data = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, m_file, 0);
+    if (data == MAP_FAILED) {
+        Close();
+        return false;
+    }
+    m_data = (const sf::Uint8*)data;
+#endif
+    const sf::Uint32 width = Load<sf::Uint32>(m_data + 4);
+    const sf::Uint32 height = Load<sf::Uint32>(m_data + 8);
+    const sf::Uint32 tileSize = Load<sf::Uint32>(m_data + 12);
+    const std::uint64_t strokesOffset = Load<std::uint64_t>(m_data + 16);
+    const std::uint64_t strokesSize = Load<std::uint64_t>(m_data + 24);
+    if (std::memcmp(m_data, DOCUMENT_MAGIC, sizeof(DOCUMENT_MAGIC)) != 0 || tileSize != TILE_SIZE
+        || width == 0 || height == 0 || width > INT32_MAX - TILE_SIZE || height > INT32_MAX - TILE_SIZE) {
+        Close();
+        return false;
+    }
+    m_width = (int)width;
+    m_height = (int)height;
+    m_tiles_x = (m_width + TILE_SIZE - 1) / TILE_SIZE;
+    m_tiles_y = (m_height + TILE_SIZE - 1) / TILE_SIZE;
+    const std::uint64_t indexEnd = HEADER_SIZE + (std::uint64_t)m_tiles_x * m_tiles_y * INDEX_ENTRY_SIZE;
+    if (indexEnd > m_size || strokesOffset < indexEnd || strokesOffset > m_size || strokesSize > m_size - strokesOffset) {
+        Close();
+        return false;
+    }
+    return true;
+}
+
+/*! \brief  Unmap and close the file.
+*
+*/
+void Document::Close() {
+#ifdef _WIN32
+    if (m_data != nullptr) {
+        UnmapViewOfFile(m_data);
+    }
+    if (m_mapping != nullptr) {
+        CloseHandle(m_mapping);
+    }
+    if (m_file != INVALID_HANDLE_VALUE) {
+        CloseHandle(m_file);
+    }
+    m_mapping = nullptr;
+    m_file = INVALID_HANDLE_VALUE;
+#else
+    if (m_data != nullptr) {
+        munmap((void*)m_data, m_size);
+    }
+    if (m_file >= 0) {
+        ::close(m_file);
+    }
+    m_file = -1;
+#endif
+    m_data = nullptr;
+    m_size = 0;
+    m_width = 0;
+    m_height = 0;
+    m_tiles_x = 0;
+    m_tiles_y = 0;
+    m_decoded_count = 0;
+}
+
+bool Document::IsOpen() const {
+    return m_data != nullptr;
+}
+
+int Document::GetWidth() const {
+    return m_width;
+}
+
+int Document::GetHeight() const {
+    return m_height;
+}
+
+int Document::GetTilesX() const {
+    return m_tiles_x;
+}
+
+int Document::GetTileCount() const {
+    return m_tiles_x * m_tiles_y;
+}
+
+/*! \brief  Return the pixel rectangle of a tile, clipped to the document.
+*
+*/
+sf::IntRect Document::GetTileRect(int tile) const {
+    return TileRect(tile, m_tiles_x, m_width, m_height);
+}
+
+/*! \brief  Look up the compressed bytes of a tile in the index.
+*
+*/
+bool Document::GetEncodedTile(int tile, const sf::Uint8*& data, size_t& size) const {
+    if (m_data == nullptr || tile < 0 || tile >= GetTileCount()) {
+        return false;
+    }
+    const sf::Uint8* entry = m_data + HEADER_SIZE + (size_t)tile * INDEX_ENTRY_SIZE;
+    const std::uint64_t offset = Load<std::uint64_t>(entry);
+    const sf::Uint32 length = Load<sf::Uint32>(entry + 8);
+    if (offset > m_size || length > m_size - offset) {
+        return false;
+    }
+    data = m_data + offset;
+    size = length;
+    return true;
+}
+
+/*! \brief  Decode one tile into pixels.
+*
+*/
+bool Document::ReadTile(int tile, sf::Uint8* pixels, size_t stride) {
+    const sf::Uint8* data;
+    size_t size;
+    if (!GetEncodedTile(tile, data, size)) {
+        return false;
+    }
+    const sf::IntRect rect = GetTileRect(tile);
+    m_decoded_count++;
+    return TileCodec::Decode(data, size, pixels, stride, rect.width, rect.height);
+}
+
+/*! \brief  Decode the tiles under image, put at (left,top) of the document. A tile that is
+*           only partly under it is decoded to the side and the part under it copied over.
+*/
+bool Document::ReadRegion(int left, int top, sf::Image& image) {
+    const int width = (int)image.getSize().x;
+    const int height = (int)image.getSize().y;
+    const int x0 = std::max(left, 0);
+    const int y0 = std::max(top, 0);
+    const int x1 = std::min(left + width, m_width);
+    const int y1 = std::min(top + height, m_height);
+    if (m_data == nullptr) {
+        return false;
+    }
+    sf::Uint8* dst = MathUtility::MutablePixels(image);
+    const size_t stride = (size_t)width * 4;
+    std::vector<sf::Uint8> scratch((size_t)TILE_SIZE * TILE_SIZE * 4);
+    for (int ty = y0 / TILE_SIZE; ty * TILE_SIZE < y1; ty++) {
+        for (int tx = x0 / TILE_SIZE; tx * TILE_SIZE < x1; tx++) {
+            const int tile = ty * m_tiles_x + tx;
+            const sf::IntRect rect = GetTileRect(tile);
+            const int cx0 = std::max(rect.left, x0);
+            const int cy0 = std::max(rect.top, y0);
+            const int cx1 = std::min(rect.left + rect.width, x1);
+            const int cy1 = std::min(rect.top + rect.height, y1);
+            sf::Uint8* target = dst + (size_t)(rect.top - top) * stride + (size_t)(rect.left - left) * 4;
+            if (cx0 == rect.left && cy0 == rect.top && cx1 == rect.left + rect.width && cy1 == rect.top + rect.height) {
+                if (!ReadTile(tile, target, stride)) {
+                    return false;
+                }
+                continue;
+            }
+            if (!ReadTile(tile, scratch.data(), (size_t)TILE_SIZE * 4)) {
+                return false;
+            }
+            for (int y = cy0; y < cy1; y++) {
+                std::memcpy(dst + (size_t)(y - top) * stride + (size_t)(cx0 - left) * 4,
+                            scratch.data() + ((size_t)(y - rect.top) * TILE_SIZE + (cx0 - rect.left)) * 4, (size_t)(cx1 - cx0) * 4);
+            }
+        }
+    }
+    return true;
+}
+
+/*! \brief  Read the strokes at the end of the document.
+*
+*/
+bool Document::ReadStrokes(std::vector<std::unique_ptr<RoundedLine>>& lines, std::vector<size_t>& strokeEnds) const {
+    if (m_data == nullptr) {
+        return false;
+    }
+    StrokeReader reader(m_data + Load<std::uint64_t>(m_data + 16), GetStrokesSize());
+    while (!reader.AtEnd()) {
+        if (!reader.ReadStroke(lines)) {
+            return false;
+        }
+        strokeEnds.push_back(lines.size());
+    }
+    return true;
+}
+
+size_t Document::GetStrokesSize() const {
+    return m_data == nullptr ? 0 : (size_t)Load<std::uint64_t>(m_data + 24);
+}
+
+size_t Document::GetDecodedCount() const {
+    return m_decoded_count;
+}
+
+/*! \brief  DocumentWriter constructor. Nothing is written until Open().
+*
+*/
+DocumentWriter::DocumentWriter() : m_file(nullptr),
+    m_width(0),
+    m_height(0),
+    m_tiles_x(0),
+    m_tile_count(0),
+    m_next(0),
+    m_offset(0),
+    m_strokes_offset(0) {
+}
+
+/*! \brief  DocumentWriter destructor. A document that was not finished is deleted.
+*
+*/
+DocumentWriter::~DocumentWriter() {
+    if (m_file != nullptr) {
+        std::fclose(m_file);
+        std::remove(m_temp_path.c_str());
+    }
+}
+
+/*! \brief  Create the file next to path and leave room for the header and the index.
+*
+*/
+bool DocumentWriter::Open(const std::string& path, int width, int height) {
+    if (m_file != nullptr || width <= 0 || height <= 0) {
+        return false;
+    }
+    m_path = path;
+    m_temp_path = path + ".tmp";
+    m_file = std::fopen(m_temp_path.c_str(), "wb");
+    if (m_file == nullptr) {
+        return false;
+    }
+    m_width = width;
+    m_height = height;
+    m_tiles_x = (width + Document::TILE_SIZE - 1) / Document::TILE_SIZE;
+    m_tile_count = m_tiles_x * ((height + Document::TILE_SIZE - 1) / Document::TILE_SIZE);
+    m_next = 0;
+    m_offset = 0;
+    m_strokes_offset = 0;
+    m_index.assign(Document::HEADER_SIZE + (size_t)m_tile_count * Document::INDEX_ENTRY_SIZE, 0);
+    const std::vector<sf::Uint8> zeros(ZERO_CHUNK, 0);
+    for (size_t written = 0; written < m_index.size(); written += ZERO_CHUNK) {
+        if (!Append(zeros.data(), std::min(ZERO_CHUNK, m_index.size() - written))) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*! \brief  Write bytes at the end of the file.
+*
+*/
+bool DocumentWriter::Append(const sf::Uint8* data, size_t size) {
+    if (std::fwrite(data, 1, size, m_file) != size) {
+        return false;
+    }
+    m_offset += size;
+    return true;
+}
+
+/*! \brief  Compress the next tile and append it.
+*
+*/
+bool DocumentWriter::AddTile(const sf::Uint8* pixels, size_t stride) {
+    const sf::IntRect rect = GetNextTileRect();
+    m_encoded.clear();
+    TileCodec::Encode(pixels, stride, rect.width, rect.height, m_encoded);
+    return AddEncodedTile(m_encoded.data(), m_encoded.size());
+}
+
+/*! \brief  Append the next tile as it is and note where it went in the index.
+*
+*/
+bool DocumentWriter::AddEncodedTile(const sf::Uint8* data, size_t size) {
+    if (m_file == nullptr || m_next >= m_tile_count) {
+        return false;
+    }
+    sf::Uint8* entry = m_index.data() + Document::HEADER_SIZE + (size_t)m_next * Document::INDEX_ENTRY_SIZE;
+    Store<std::uint64_t>(entry, m_offset);
+    Store<sf::Uint32>(entry + 8, (sf::Uint32)size);
+    m_next++;
+    if (!Append(data, size)) {
+        return false;
+    }
+    // The strokes start after the last tile.
+    m_strokes_offset = m_offset;
+    return true;
+}
+
+/*! \brief  Return the pixel rectangle of the next tile, clipped to the document.
+*
+*/
+sf::IntRect DocumentWriter::GetNextTileRect() const {
+    return TileRect(m_next, m_tiles_x, m_width, m_height);
+}
+
+/*! \brief  Append a chunk of encoded strokes after the tiles.
+*
+*/
+bool DocumentWriter::AddStrokes(const std::vector<sf::Uint8>& strokes) {
+    if (m_file == nullptr || m_next != m_tile_count) {
+        return false;
+    }
+    return Append(strokes.data(), strokes.size());
+}
+
+/*! \brief  Write the header and the index and rename the file over path.
+*
+*/
+bool DocumentWriter::Finish() {
+    if (m_file == nullptr || m_next != m_tile_count) {
+        return false;
+    }
+    std::memcpy(m_index.data(), DOCUMENT_MAGIC, sizeof(DOCUMENT_MAGIC));
+    Store<sf::Uint32>(m_index.data() + 4, (sf::Uint32)m_width);
+    Store<sf::Uint32>(m_index.data() + 8, (sf::Uint32)m_height);
+    Store<sf::Uint32>(m_index.data() + 12, (sf::Uint32)Document::TILE_SIZE);
+    Store<std::uint64_t>(m_index.data() + 16, m_strokes_offset);
+    Store<std::uint64_t>(m_index.data() + 24, m_offset - m_strokes_offset);
+    bool written = std::fseek(m_file, 0, SEEK_SET) == 0 && std::fwrite(m_index.data(), 1, m_index.size(), m_file) == m_index.size();
+    written = std::fclose(m_file) == 0 && written;
+    m_file = nullptr;
+#ifdef _WIN32
+    // Windows does not rename over an existing file.
+    std::remove(m_path.c_str());
+#endif
+    if (!written || std::rename(m_temp_path.c_str(), m_path.c_str()) != 0) {
+        std::remove(m_temp_path.c_str());
+        return false;
+    }
+    return true;
+}
+
+/*! \brief  Return the bytes written so far.
+*
+*/
+size_t DocumentWriter::GetSize() const {
+    return m_offset;
+}
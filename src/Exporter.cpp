@@ -0,0 +1,201 @@
+/** 
+ *  @file   Exporter.cpp 
+ *  @brief  Implementation of Exporter.hpp
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include standard library C++ libraries.
+#include <algorithm>
+#include <cctype>
+#include <string>
+// Project header files
+#include "Exporter.hpp"
+
+namespace {
+
+// Progress, in thousandths, at the end of each stage of a job: copying the snapshot tiles
+// out, flattening the lines, and encoding, which sf::Image does in one call.
+const int COPIED = 100;
+const int FLATTENED = 500;
+const int ENCODED = 1000;
+// Line segments flattened between two progress updates.
+const size_t PROGRESS_LINES = 256;
+
+// The extension of path in lower case, or "" if it has none.
+std::string Extension(const std::string& path) {
+    const size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) {
+        return "";
+    }
+    std::string extension = path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return extension;
+}
+
+}
+
+/*! \brief  Exporter constructor. Starts the worker.
+*
+*/
+Exporter::Exporter() : m_encoding(false),
+    m_stopping(false),
+    m_progress(0) {
+    m_worker = std::thread(&Exporter::WorkerLoop, this);
+}
+
+/*! \brief  Exporter destructor. Waits for the saved jobs, so no save is lost, and joins the worker.
+*
+*/
+Exporter::~Exporter() {
+    Wait();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_worker.join();
+}
+
+/*! \brief  Take the oldest job and encode it, until the exporter is destroyed.
+*
+*/
+void Exporter::WorkerLoop() {
+    while (true) {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+            if (m_jobs.empty()) {
+                return;
+            }
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+            m_encoding = true;
+            m_progress = 0;
+        }
+        Result result;
+        result.path = job->path;
+        result.saved = Encode(*job, &m_progress);
+        job.reset();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_results.push_back(result);
+            m_encoding = false;
+        }
+        m_idle.notify_all();
+    }
+}
+
+/*! \brief  Queue a job for the worker.
+*
+*/
+void Exporter::Save(std::unique_ptr<Job> job) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(std::move(job));
+    }
+    m_wake.notify_one();
+}
+
+/*! \brief  Return how far along the unfinished saves are. Each counts as one part of the
+*           whole, so a second save halves the progress instead of resetting it.
+*/
+float Exporter::GetProgress() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const size_t remaining = m_jobs.size() + (m_encoding ? 1 : 0);
+    if (remaining == 0) {
+        return 1.0f;
+    }
+    const float current = m_encoding ? (float)m_progress.load() / ENCODED : 0.0f;
+    return current / (float)remaining;
+}
+
+/*! \brief  Move the finished saves to results.
+*
+*/
+size_t Exporter::Collect(std::vector<Result>& results) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const size_t count = m_results.size();
+    results.insert(results.end(), m_results.begin(), m_results.end());
+    m_results.clear();
+    return count;
+}
+
+/*! \brief  Return true while a job waits or is encoded.
+*
+*/
+bool Exporter::IsBusy() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_encoding || !m_jobs.empty();
+}
+
+/*! \brief  Wait until every saved job is written.
+*
+*/
+void Exporter::Wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return !m_encoding && m_jobs.empty(); });
+}
+
+/*! \brief  Copy the snapshot into an image, flatten the lines over it like App::Flatten()
+*           and let sf::Image encode it.
+*/
+bool Exporter::Encode(const Job& job, std::atomic<int>* progress) {
+    if (Extension(job.path) == "svg") {
+        return EncodeSvg(job, progress);
+    }
+    sf::Image image;
+    job.canvas.CopyToImage(image);
+    if (progress != nullptr) {
+        *progress = COPIED;
+    }
+    for (size_t i = 0; i < job.lines.size(); i++) {
+        job.lines[i]->rasterize(image, job.origin);
+        if (progress != nullptr && (i + 1) % PROGRESS_LINES == 0) {
+            *progress = COPIED + (int)((FLATTENED - COPIED) * (i + 1) / job.lines.size());
+        }
+    }
+    if (progress != nullptr) {
+        *progress = FLATTENED;
+    }
+    const bool saved = image.saveToFile(job.path);
+    if (progress != nullptr) {
+        *progress = ENCODED;
+    }
+    return saved;
+}
+
+/*! \brief  Stream the gestures of the job to an SVG file of the size of its snapshot. The
+*           snapshot pixels are not written: the raster layer has no vector form.
+*/
+bool Exporter::EncodeSvg(const Job& job, std::atomic<int>* progress) {
+    SvgWriter writer;
+    if (!writer.Open(job.path, job.canvas.GetWidth(), job.canvas.GetHeight(), sf::Color::White, job.origin)) {
+        return false;
+    }
+    size_t begin = 0;
+    for (size_t g = 0; g <= job.strokeEnds.size(); g++) {
+        const size_t end = g < job.strokeEnds.size() ? job.strokeEnds[g] : job.lines.size();
+        if (end > begin) {
+            writer.AddGesture(job.lines.data() + begin, end - begin);
+        }
+        if (progress != nullptr && begin / PROGRESS_LINES != end / PROGRESS_LINES) {
+            *progress = (int)(ENCODED * end / job.lines.size());
+        }
+        begin = end;
+    }
+    const bool saved = writer.Finish();
+    if (progress != nullptr) {
+        *progress = ENCODED;
+    }
+    return saved;
+}
+
+/*! \brief  Return true if the extension of path is one sf::Image can write, or SVG.
+*
+*/
+bool Exporter::IsSupported(const std::string& path) {
+    const std::string extension = Extension(path);
+    return extension == "png" || extension == "jpg" || extension == "jpeg" || extension == "bmp" || extension == "tga" || extension == "svg";
+}
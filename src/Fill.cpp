@@ -0,0 +1,268 @@
+/** 
+ *  @file   Fill.cpp 
+ *  @brief  Fill implementation, a bucket fill is a single command. 
+ *  @author Dennis Ping 
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics/Color.hpp>
+// Include standard library C++ libraries.
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+// Project header files
+#include "Fill.hpp"
+#include "Command.hpp"
+#include "MathUtility.hpp"
+#include "PixelKernels.hpp"
+#include "Varint.hpp"
+
+/*! \brief  Constructor for a Fill command that finds its region on the image it paints.
+*
+*/
+Fill::Fill(int x, int y, sf::Image& image, sf::Color paintbrushColor) : Command(image),
+    xCoord(x),
+    yCoord(y),
+    currColor(paintbrushColor),
+    m_boundary(nullptr),
+    m_pool(nullptr) {
+}
+
+/*! \brief  Constructor for a Fill command that finds its region on a separate boundary image.
+*           The boundary image must have the same size as the image.
+*/
+Fill::Fill(int x, int y, sf::Image& image, sf::Color paintbrushColor, const sf::Image& boundary) : Command(image),
+    xCoord(x),
+    yCoord(y),
+    currColor(paintbrushColor),
+    m_boundary(&boundary),
+    m_pool(nullptr) {
+}
+
+Fill::~Fill(){}
+
+/*! \brief  Compute the fill region with a scanline fill, remember the pixels it covers
+*           and paint it with the current color. Returns false if there is nothing to fill.
+*/
+bool Fill::execute() {
+    const int width = (int)m_image.getSize().x;
+    const int height = (int)m_image.getSize().y;
+    const sf::Image& source = m_boundary != nullptr ? *m_boundary : m_image;
+    m_boundary = nullptr;
+    if (source.getSize() != m_image.getSize()) {
+        return false;
+    }
+    if (xCoord < 0 || xCoord >= width || yCoord < 0 || yCoord >= height) {
+        return false;
+    }
+    if (source.getPixel(xCoord, yCoord) == currColor) {
+        return false;
+    }
+    if (m_pool != nullptr && (size_t)width * height >= PARALLEL_FILL_PIXELS) {
+        m_spans = MathUtility::TileFill(source.getPixelsPtr(), width, height, xCoord, yCoord, *m_pool);
+    } else {
+        m_spans = MathUtility::ScanlineFill(source.getPixelsPtr(), width, height, xCoord, yCoord);
+    }
+    int left = width, top = height, right = -1, bottom = -1;
+    for (const MathUtility::Span& span : m_spans) {
+        left = std::min(left, span.x0);
+        right = std::max(right, span.x1);
+        top = std::min(top, span.y);
+        bottom = std::max(bottom, span.y);
+    }
+    m_bounds = sf::IntRect(left, top, right - left + 1, bottom - top + 1);
+
+    // The region is usually one color, so the previous pixels compress to about one run per span.
+    m_prevRuns.clear();
+    const sf::Uint8* src = m_image.getPixelsPtr();
+    for (const MathUtility::Span& span : m_spans) {
+        const sf::Uint8* p = src + ((size_t)span.y * width + span.x0) * 4;
+        int x = span.x0;
+        while (x <= span.x1) {
+            sf::Uint32 pixel, next;
+            std::memcpy(&pixel, p, sizeof(pixel));
+            int count = 1;
+            for (p += 4, x++; x <= span.x1; p += 4, x++, count++) {
+                std::memcpy(&next, p, sizeof(next));
+                if (next != pixel) {
+                    break;
+                }
+            }
+            if (!m_prevRuns.empty() && m_prevRuns.back().first == pixel) {
+                m_prevRuns.back().second += count;
+            } else {
+                m_prevRuns.emplace_back(pixel, count);
+            }
+        }
+    }
+    MathUtility::FillSpans(pixels(), width, m_spans, currColor);
+    return true;
+}
+
+/*! \brief  Restore the previous pixels of the filled region.
+*		
+*/
+bool Fill::undo() {
+    const int width = (int)m_image.getSize().x;
+    sf::Uint8* dst = pixels();
+    auto run = m_prevRuns.begin();
+    int left = run != m_prevRuns.end() ? run->second : 0;
+    for (const MathUtility::Span& span : m_spans) {
+        sf::Uint8* p = dst + ((size_t)span.y * width + span.x0) * 4;
+        int remaining = span.x1 - span.x0 + 1;
+        while (remaining > 0) {
+            // Write the longest piece of the current run that fits in this span.
+            const int count = std::min(left, remaining);
+            PixelKernels::FillSpan(p, count, run->first);
+            p += (size_t)count * 4;
+            remaining -= count;
+            left -= count;
+            if (left == 0 && ++run != m_prevRuns.end()) {
+                left = run->second;
+            }
+        }
+    }
+    return true;
+}
+
+/*! \brief  Paint the filled region with the fill color again.
+*		
+*/
+bool Fill::redo() {
+    return redoInto(m_image);
+}
+
+/*! \brief  Paint the filled region of image with the fill color.
+*		
+*/
+bool Fill::redoInto(sf::Image& image) const {
+    MathUtility::FillSpans(MathUtility::MutablePixels(image), (int)image.getSize().x, m_spans, currColor);
+    return true;
+}
+
+/*! \brief  Split the fill over a thread pool when the image has at least PARALLEL_FILL_PIXELS pixels.
+*
+*/
+void Fill::setThreadPool(ThreadPool* pool) {
+    m_pool = pool;
+}
+
+/*! \brief  Return the (x,y) seed coordinates of this Fill command.
+*
+*/
+std::pair<int, int> Fill::getCoords() {
+    return std::make_pair(xCoord, yCoord);
+}
+
+/*! \brief  Get a string representation of this Fill command in the form (x, y, color).
+*
+*/
+std::string Fill::getDescription() {
+    return "Fill (" + std::to_string(xCoord) + ", " + std::to_string(yCoord) + ", " + colorName(currColor) + ")";
+}
+
+/*! \brief  Return the number of pixels changed by this fill.
+*
+*/
+size_t Fill::getPixelCount() const {
+    size_t count = 0;
+    for (const MathUtility::Span& span : m_spans) {
+        count += span.x1 - span.x0 + 1;
+    }
+    return count;
+}
+
+/*! \brief  Return the bytes of undo data (spans and previous pixels) held in memory.
+*
+*/
+size_t Fill::getByteSize() const {
+    return m_spans.capacity() * sizeof(MathUtility::Span) + m_prevRuns.capacity() * sizeof(m_prevRuns[0]);
+}
+
+/*! \brief  Append the spans and the previous pixel runs to bytes and free them. Spans mostly
+*           go down one row at a time at about the same x, so their deltas fit in a byte or two.
+*/
+bool Fill::spill(std::vector<sf::Uint8>& bytes) {
+    Varint::Put(bytes, m_spans.size());
+    int prevY = 0;
+    int prevX0 = 0;
+    for (const MathUtility::Span& span : m_spans) {
+        Varint::PutSigned(bytes, span.y - prevY);
+        Varint::PutSigned(bytes, span.x0 - prevX0);
+        Varint::Put(bytes, (std::uint64_t)(span.x1 - span.x0));
+        prevY = span.y;
+        prevX0 = span.x0;
+    }
+    Varint::Put(bytes, m_prevRuns.size());
+    for (const std::pair<sf::Uint32, int>& run : m_prevRuns) {
+        Varint::PutUint32(bytes, run.first);
+        Varint::Put(bytes, (std::uint64_t)run.second);
+    }
+    std::vector<MathUtility::Span>().swap(m_spans);
+    std::vector<std::pair<sf::Uint32, int>>().swap(m_prevRuns);
+    return true;
+}
+
+/*! \brief  Read back the spans and the previous pixel runs written by spill().
+*
+*/
+bool Fill::restore(const std::vector<sf::Uint8>& bytes) {
+    const sf::Uint8* p = bytes.data();
+    const sf::Uint8* end = p + bytes.size();
+    const std::int64_t width = (std::int64_t)m_image.getSize().x;
+    const std::int64_t height = (std::int64_t)m_image.getSize().y;
+    std::uint64_t count = 0;
+    if (!Varint::Get(p, end, count) || count > (std::uint64_t)(end - p)) {
+        return false;
+    }
+    std::vector<MathUtility::Span> spans;
+    spans.reserve(count);
+    std::int64_t y = 0;
+    std::int64_t x0 = 0;
+    std::uint64_t pixelCount = 0;
+    for (std::uint64_t i = 0; i < count; i++) {
+        std::int64_t dy, dx;
+        std::uint64_t length;
+        if (!Varint::GetSigned(p, end, dy) || !Varint::GetSigned(p, end, dx) || !Varint::Get(p, end, length)) {
+            return false;
+        }
+        y += dy;
+        x0 += dx;
+        if (y < 0 || y >= height || x0 < 0 || x0 + (std::int64_t)length >= width) {
+            return false;
+        }
+        spans.push_back(MathUtility::Span{(int)y, (int)x0, (int)(x0 + (std::int64_t)length)});
+        pixelCount += length + 1;
+    }
+    if (!Varint::Get(p, end, count) || count > (std::uint64_t)(end - p)) {
+        return false;
+    }
+    std::vector<std::pair<sf::Uint32, int>> runs;
+    runs.reserve(count);
+    std::uint64_t runPixels = 0;
+    for (std::uint64_t i = 0; i < count; i++) {
+        sf::Uint32 pixel;
+        std::uint64_t length;
+        if (!Varint::GetUint32(p, end, pixel) || !Varint::Get(p, end, length) || length == 0 || length > pixelCount) {
+            return false;
+        }
+        runs.emplace_back(pixel, (int)length);
+        runPixels += length;
+    }
+    // undo() walks the runs and the spans together, so they must cover the same pixels.
+    if (runPixels != pixelCount || p != end) {
+        return false;
+    }
+    m_spans = std::move(spans);
+    m_prevRuns = std::move(runs);
+    return true;
+}
+
+/*! \brief  Return the bounding box of the filled region.
+*
+*/
+sf::IntRect Fill::getBounds() const {
+    return m_bounds;
+}
\ No newline at end of file
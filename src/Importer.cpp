@@ -0,0 +1,481 @@
+/** 
+ *  @file   Importer.cpp 
+ *  @brief  Implementation of Importer.hpp
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics/Image.hpp>
+// Include standard library C++ libraries.
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+// Project header files
+#include "Document.hpp"
+#include "Importer.hpp"
+
+namespace {
+
+// Progress, in thousandths, once an image that is loaded whole is loaded, and once every
+// band is in the document. A streamed image goes from 0 to the end band by band.
+const int LOADED = 300;
+const int IMPORTED = 1000;
+// Largest width and height imported, so the tile count of the document fits an int.
+const int MAX_DIMENSION = 1 << 20;
+
+// The extension of path in lower case, or "" if it has none.
+std::string Extension(const std::string& path) {
+    const size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) {
+        return "";
+    }
+    std::string extension = path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(), [](unsigned char c) { return (char)std::tolower(c); });
+    return extension;
+}
+
+// Little endian numbers of image file headers.
+sf::Uint32 LoadLe16(const sf::Uint8* p) {
+    return (sf::Uint32)p[0] | (sf::Uint32)p[1] << 8;
+}
+
+sf::Uint32 LoadLe32(const sf::Uint8* p) {
+    return (sf::Uint32)p[0] | (sf::Uint32)p[1] << 8 | (sf::Uint32)p[2] << 16 | (sf::Uint32)p[3] << 24;
+}
+
+// The rows of an image, read from the top down as RGBA8.
+class RowSource {
+    protected:
+        int m_width = 0;
+        int m_height = 0;
+
+    public:
+        virtual ~RowSource() {}
+        int GetWidth() const { return m_width; }
+        int GetHeight() const { return m_height; }
+        // Read the next count rows into pixels, rows stride bytes apart.
+        virtual bool ReadRows(sf::Uint8* pixels, size_t stride, int count) = 0;
+        // Bytes of pixels it holds, besides the ones it reads into.
+        virtual size_t GetBufferBytes() const = 0;
+};
+
+// Where the rows of an uncompressed image file are and how a pixel is laid out in them.
+struct RasterLayout {
+    int width = 0;
+    int height = 0;
+    // Offset of the first row in the file, the bottom one if bottomUp
+    long offset = 0;
+    size_t rowBytes = 0;
+    bool bottomUp = false;
+    int bytesPerPixel = 0;
+    // Byte of each channel in a pixel; alpha -1 for opaque pixels
+    int red = 0;
+    int green = 0;
+    int blue = 0;
+    int alpha = -1;
+    // Channel value of full intensity, which is scaled to 255
+    int maxValue = 255;
+};
+
+// Reads an uncompressed image a band of rows at a time: the rows of a band are next to
+// each other in the file either way up, so each band is one read.
+class FileRows : public RowSource {
+    private:
+        std::FILE* m_file;
+        RasterLayout m_layout;
+        std::vector<sf::Uint8> m_raw;
+        int m_next;
+
+    public:
+        FileRows(std::FILE* file, const RasterLayout& layout) : m_file(file), m_layout(layout), m_next(0) {
+            m_width = layout.width;
+            m_height = layout.height;
+        }
+
+        ~FileRows() {
+            std::fclose(m_file);
+        }
+
+        bool ReadRows(sf::Uint8* pixels, size_t stride, int count) override {
+            if (count <= 0 || m_next + count > m_height) {
+                return false;
+            }
+            const size_t rowBytes = m_layout.rowBytes;
+            const long first = m_layout.bottomUp ? m_height - m_next - count : m_next;
+            m_raw.resize(rowBytes * (size_t)count);
+            if (std::fseek(m_file, m_layout.offset + first * (long)rowBytes, SEEK_SET) != 0
+                || std::fread(m_raw.data(), 1, m_raw.size(), m_file) != m_raw.size()) {
+                return false;
+            }
+            const int bpp = m_layout.bytesPerPixel;
+            for (int row = 0; row < count; row++) {
+                const sf::Uint8* src = m_raw.data() + rowBytes * (size_t)(m_layout.bottomUp ? count - 1 - row : row);
+                sf::Uint8* dst = pixels + stride * (size_t)row;
+                for (int x = 0; x < m_width; x++, src += bpp, dst += 4) {
+                    dst[0] = src[m_layout.red];
+                    dst[1] = src[m_layout.green];
+                    dst[2] = src[m_layout.blue];
+                    dst[3] = m_layout.alpha < 0 ? 255 : src[m_layout.alpha];
+                }
+                if (m_layout.maxValue != 255) {
+                    dst = pixels + stride * (size_t)row;
+                    for (int i = 0; i < m_width * 4; i++) {
+                        dst[i] = (i & 3) == 3 ? dst[i] : (sf::Uint8)(std::min((int)dst[i], m_layout.maxValue) * 255 / m_layout.maxValue);
+                    }
+                }
+            }
+            m_next += count;
+            return true;
+        }
+
+        size_t GetBufferBytes() const override {
+            return m_raw.capacity();
+        }
+};
+
+// An image sf::Image loaded whole, handed out a band at a time like the others.
+class ImageRows : public RowSource {
+    private:
+        sf::Image m_image;
+        int m_next = 0;
+
+    public:
+        bool Load(const std::string& path) {
+            if (!m_image.loadFromFile(path)) {
+                return false;
+            }
+            m_width = (int)m_image.getSize().x;
+            m_height = (int)m_image.getSize().y;
+            return true;
+        }
+
+        bool ReadRows(sf::Uint8* pixels, size_t stride, int count) override {
+            if (count <= 0 || m_next + count > m_height) {
+                return false;
+            }
+            for (int row = 0; row < count; row++) {
+                std::memcpy(pixels + stride * (size_t)row, m_image.getPixelsPtr() + (size_t)(m_next + row) * m_width * 4, (size_t)m_width * 4);
+            }
+            m_next += count;
+            return true;
+        }
+
+        size_t GetBufferBytes() const override {
+            return (size_t)m_width * m_height * 4;
+        }
+};
+
+// Read the header of a BMP of 24 or 32 bits a pixel, without compression or with the
+// channels in bytes of their own.
+bool ParseBmp(std::FILE* file, RasterLayout& layout) {
+    sf::Uint8 header[70] = {};
+    if (std::fread(header, 1, 54, file) != 54 || header[0] != 'B' || header[1] != 'M') {
+        return false;
+    }
+    const sf::Uint32 infoSize = LoadLe32(header + 14);
+    const int width = (int)LoadLe32(header + 18);
+    const int height = (int)LoadLe32(header + 22);
+    const sf::Uint32 bits = LoadLe16(header + 28);
+    const sf::Uint32 compression = LoadLe32(header + 30);
+    if (infoSize < 40 || width <= 0 || height == 0 || height == INT32_MIN || (bits != 24 && bits != 32)) {
+        return false;
+    }
+    layout.width = width;
+    layout.height = std::abs(height);
+    layout.bottomUp = height > 0;
+    layout.offset = (long)LoadLe32(header + 10);
+    layout.bytesPerPixel = (int)bits / 8;
+    layout.rowBytes = ((size_t)width * bits + 31) / 32 * 4;
+    // BGR(X), unless bit fields say where the channels are.
+    layout.blue = 0;
+    layout.green = 1;
+    layout.red = 2;
+    layout.alpha = -1;
+    if (compression == 3 || compression == 6) {
+        // The masks follow a 40 byte header, or are in the larger ones at the same place.
+        const size_t masks = compression == 6 || infoSize >= 56 ? 16 : 12;
+        if (bits != 32 || std::fread(header + 54, 1, masks, file) != masks) {
+            return false;
+        }
+        int* channels[4] = {&layout.red, &layout.green, &layout.blue, &layout.alpha};
+        for (size_t i = 0; i < masks / 4; i++) {
+            const sf::Uint32 mask = LoadLe32(header + 54 + i * 4);
+            int byte = 0;
+            while (byte < 4 && mask != 0xFFu << (byte * 8)) {
+                byte++;
+            }
+            if (byte == 4 && (i < 3 || mask != 0)) {
+                return false;
+            }
+            *channels[i] = byte == 4 ? -1 : byte;
+        }
+    }
+    else if (compression != 0) {
+        return false;
+    }
+    return true;
+}
+
+// Read the header of an uncompressed true color (24 or 32 bits) or grayscale TGA.
+bool ParseTga(std::FILE* file, RasterLayout& layout) {
+    sf::Uint8 header[18];
+    if (std::fread(header, 1, sizeof(header), file) != sizeof(header) || header[1] != 0) {
+        return false;
+    }
+    const int type = header[2];
+    const int bits = header[16];
+    const int descriptor = header[17];
+    const bool trueColor = type == 2 && (bits == 24 || bits == 32);
+    const bool gray = type == 3 && bits == 8;
+    // Rows stored right to left are not supported.
+    if ((!trueColor && !gray) || (descriptor & 0x10) != 0) {
+        return false;
+    }
+    layout.width = (int)LoadLe16(header + 12);
+    layout.height = (int)LoadLe16(header + 14);
+    layout.bottomUp = (descriptor & 0x20) == 0;
+    layout.offset = (long)(sizeof(header) + header[0]);
+    layout.bytesPerPixel = bits / 8;
+    layout.rowBytes = (size_t)layout.width * layout.bytesPerPixel;
+    layout.blue = 0;
+    layout.green = gray ? 0 : 1;
+    layout.red = gray ? 0 : 2;
+    layout.alpha = bits == 32 ? 3 : -1;
+    return layout.width > 0 && layout.height > 0;
+}
+
+// Read the next number of a PNM header, after whitespace and comments.
+bool ReadPnmNumber(std::FILE* file, int& value) {
+    int c = std::fgetc(file);
+    while (c == '#' || std::isspace(c)) {
+        if (c == '#') {
+            while (c != '\n' && c != EOF) {
+                c = std::fgetc(file);
+            }
+        }
+        c = std::fgetc(file);
+    }
+    if (!std::isdigit(c)) {
+        return false;
+    }
+    value = 0;
+    while (std::isdigit(c)) {
+        if (value > MAX_DIMENSION) {
+            return false;
+        }
+        value = value * 10 + (c - '0');
+        c = std::fgetc(file);
+    }
+    // One whitespace character ends the number; after the last one the pixels start.
+    return std::isspace(c) != 0;
+}
+
+// Read the header of a binary PPM (P6) or PGM (P5) of at most 8 bits a channel.
+bool ParsePnm(std::FILE* file, RasterLayout& layout) {
+    char magic[2];
+    if (std::fread(magic, 1, 2, file) != 2 || magic[0] != 'P' || (magic[1] != '5' && magic[1] != '6')) {
+        return false;
+    }
+    int maxValue;
+    if (!ReadPnmNumber(file, layout.width) || !ReadPnmNumber(file, layout.height) || !ReadPnmNumber(file, maxValue)
+        || maxValue <= 0 || maxValue > 255) {
+        return false;
+    }
+    const bool gray = magic[1] == '5';
+    layout.offset = std::ftell(file);
+    layout.bottomUp = false;
+    layout.bytesPerPixel = gray ? 1 : 3;
+    layout.rowBytes = (size_t)layout.width * layout.bytesPerPixel;
+    layout.red = 0;
+    layout.green = gray ? 0 : 1;
+    layout.blue = gray ? 0 : 2;
+    layout.alpha = -1;
+    layout.maxValue = maxValue;
+    return layout.width > 0 && layout.height > 0;
+}
+
+// Open the rows of the image at path: decoded from the file a band at a time for the formats
+// that can be, and loaded whole otherwise. Returns nullptr if it can not be read.
+std::unique_ptr<RowSource> OpenRows(const std::string& path) {
+    const std::string extension = Extension(path);
+    if (!Importer::IsStreamed(path)) {
+        ImageRows* image = new ImageRows;
+        std::unique_ptr<RowSource> rows(image);
+        if (!image->Load(path)) {
+            return nullptr;
+        }
+        return rows;
+    }
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return nullptr;
+    }
+    RasterLayout layout;
+    const bool parsed = extension == "bmp" ? ParseBmp(file, layout) : extension == "tga" ? ParseTga(file, layout) : ParsePnm(file, layout);
+    if (!parsed || layout.width > MAX_DIMENSION || layout.height > MAX_DIMENSION) {
+        std::fclose(file);
+        return nullptr;
+    }
+    return std::unique_ptr<RowSource>(new FileRows(file, layout));
+}
+
+}
+
+/*! \brief  Importer constructor. Starts the worker.
+*
+*/
+Importer::Importer() : m_importing(false),
+    m_stopping(false),
+    m_progress(0) {
+    m_worker = std::thread(&Importer::WorkerLoop, this);
+}
+
+/*! \brief  Importer destructor. Waits for the queued jobs and joins the worker.
+*
+*/
+Importer::~Importer() {
+    Wait();
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_worker.join();
+}
+
+/*! \brief  Take the oldest job and import it, until the importer is destroyed.
+*
+*/
+void Importer::WorkerLoop() {
+    while (true) {
+        std::unique_ptr<Job> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+            if (m_jobs.empty()) {
+                return;
+            }
+            job = std::move(m_jobs.front());
+            m_jobs.pop_front();
+            m_importing = true;
+            m_progress = 0;
+        }
+        Result result;
+        Convert(*job, result, &m_progress);
+        job.reset();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_results.push_back(result);
+            m_importing = false;
+        }
+        m_idle.notify_all();
+    }
+}
+
+/*! \brief  Queue a job for the worker.
+*
+*/
+void Importer::Import(std::unique_ptr<Job> job) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push_back(std::move(job));
+    }
+    m_wake.notify_one();
+}
+
+/*! \brief  Return how far along the unfinished imports are, each counting as one part of the whole.
+*
+*/
+float Importer::GetProgress() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const size_t remaining = m_jobs.size() + (m_importing ? 1 : 0);
+    if (remaining == 0) {
+        return 1.0f;
+    }
+    const float current = m_importing ? (float)m_progress.load() / IMPORTED : 0.0f;
+    return current / (float)remaining;
+}
+
+/*! \brief  Move the finished imports to results.
+*
+*/
+size_t Importer::Collect(std::vector<Result>& results) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const size_t count = m_results.size();
+    results.insert(results.end(), m_results.begin(), m_results.end());
+    m_results.clear();
+    return count;
+}
+
+/*! \brief  Return true while a job waits or is imported.
+*
+*/
+bool Importer::IsBusy() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_importing || !m_jobs.empty();
+}
+
+/*! \brief  Wait until every queued job is imported.
+*
+*/
+void Importer::Wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return !m_importing && m_jobs.empty(); });
+}
+
+/*! \brief  Read the image a band of TILE_SIZE rows at a time and compress each band's tiles
+*           into the document before reading the next, so the pixels held are one band and
+*           whatever the reader needs to decode it.
+*/
+bool Importer::Convert(const Job& job, Result& result, std::atomic<int>* progress) {
+    result.source = job.source;
+    result.document = job.document;
+    result.imported = false;
+    std::unique_ptr<RowSource> rows = OpenRows(job.source);
+    if (!rows) {
+        return false;
+    }
+    const int width = rows->GetWidth();
+    const int height = rows->GetHeight();
+    result.width = width;
+    result.height = height;
+    const int start = IsStreamed(job.source) ? 0 : LOADED;
+    if (progress != nullptr) {
+        *progress = start;
+    }
+    DocumentWriter writer;
+    if (!writer.Open(job.document, width, height)) {
+        return false;
+    }
+    const size_t stride = (size_t)width * 4;
+    std::vector<sf::Uint8> band(stride * Document::TILE_SIZE);
+    for (int top = 0; top < height; top += Document::TILE_SIZE) {
+        const int count = std::min(Document::TILE_SIZE, height - top);
+        if (!rows->ReadRows(band.data(), stride, count)) {
+            return false;
+        }
+        for (int left = 0; left < width; left += Document::TILE_SIZE) {
+            if (!writer.AddTile(band.data() + (size_t)left * 4, stride)) {
+                return false;
+            }
+        }
+        if (progress != nullptr) {
+            *progress = start + (int)((long long)(IMPORTED - start) * (top + count) / height);
+        }
+    }
+    result.peakBytes = band.size() + rows->GetBufferBytes();
+    result.imported = writer.Finish();
+    return result.imported;
+}
+
+/*! \brief  Return true for the formats read from the file a band of rows at a time.
+*
+*/
+bool Importer::IsStreamed(const std::string& path) {
+    const std::string extension = Extension(path);
+    return extension == "bmp" || extension == "tga" || extension == "ppm" || extension == "pgm" || extension == "pnm";
+}
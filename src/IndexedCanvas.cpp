@@ -0,0 +1,583 @@
+/** 
+ *  @file   IndexedCanvas.cpp 
+ *  @brief  Implementation of IndexedCanvas.hpp
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include standard library C++ libraries.
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <utility>
+// Project header files
+#include "IndexedCanvas.hpp"
+
+IndexedCanvas::IndexedCanvas() : m_width(0),
+    m_height(0),
+    m_tiles_x(0),
+    m_tiles_y(0),
+    m_expand(256 * 8, 0) {
+}
+
+/*! \brief  Make a width x height canvas of the palette color index. Every tile is of one
+*           index, so it takes no indices until it is drawn on.
+*/
+bool IndexedCanvas::Create(int width, int height, const std::vector<sf::Color>& palette, int index) {
+    if (palette.size() > (size_t)MAX_COLORS || width < 0 || height < 0) {
+        return false;
+    }
+    m_width = width;
+    m_height = height;
+    m_tiles_x = (width + TILE_SIZE - 1) / TILE_SIZE;
+    m_tiles_y = (height + TILE_SIZE - 1) / TILE_SIZE;
+    Tile tile;
+    tile.index = (sf::Uint8)(index & 0xF);
+    std::vector<Tile>(m_tiles_x * m_tiles_y, tile).swap(m_tiles);
+    m_palette = palette;
+    BuildExpand();
+    return true;
+}
+
+/*! \brief  Make a canvas of the pixels of image. The palette grows with the colors of the
+*           image it does not have yet, and the canvas is left empty if there are too many.
+*/
+bool IndexedCanvas::FromImage(const sf::Image& image, const std::vector<sf::Color>& palette) {
+    if (!Create((int)image.getSize().x, (int)image.getSize().y, palette)) {
+        return false;
+    }
+    const size_t stride = (size_t)m_width * 4;
+    for (int tile = 0; tile < GetTileCount(); tile++) {
+        const sf::IntRect rect = GetTileRect(tile);
+        if (!ReadTile(tile, image.getPixelsPtr() + (size_t)rect.top * stride + (size_t)rect.left * 4, stride)) {
+            Create(0, 0, palette);
+            return false;
+        }
+    }
+    return true;
+}
+
+/*! \brief  Make the table of the RGBA8 pixel pairs of every byte of indices. Indices
+*           past the end of the palette expand to transparent pixels.
+*/
+void IndexedCanvas::BuildExpand() {
+    sf::Uint32 colors[MAX_COLORS] = {};
+    for (size_t i = 0; i < m_palette.size(); i++) {
+        colors[i] = MathUtility::PackColor(m_palette[i]);
+    }
+    for (int byte = 0; byte < 256; byte++) {
+        std::memcpy(&m_expand[(size_t)byte * 8], &colors[byte & 0xF], 4);
+        std::memcpy(&m_expand[(size_t)byte * 8 + 4], &colors[byte >> 4], 4);
+    }
+}
+
+/*! \brief  Check that mask has one bit, and spread its index over the 16 nibbles of a word
+*           for the compares of 16 pixels at a time.
+*/
+bool IndexedCanvas::SingleIndex(unsigned int mask, std::uint64_t& pattern) {
+    if (mask == 0 || (mask & (mask - 1)) != 0) {
+        return false;
+    }
+    int index = 0;
+    while ((mask >> index & 1) == 0) {
+        index++;
+    }
+    pattern = (std::uint64_t)index * NIBBLES;
+    return true;
+}
+
+const IndexedCanvas::Tile& IndexedCanvas::TileAt(int x, int y) const {
+    return m_tiles[(size_t)(y / TILE_SIZE) * m_tiles_x + x / TILE_SIZE];
+}
+
+sf::Uint8* IndexedCanvas::ByteAt(int x, int y) {
+    Tile& tile = m_tiles[(size_t)(y / TILE_SIZE) * m_tiles_x + x / TILE_SIZE];
+    if (tile.indices.empty()) {
+        tile.indices.assign(TILE_BYTES, (sf::Uint8)(tile.index * 0x11));
+    }
+    return tile.indices.data() + (size_t)(y % TILE_SIZE) * TILE_ROW_BYTES + (x % TILE_SIZE) / 2;
+}
+
+const sf::Uint8* IndexedCanvas::ByteAt(int x, int y) const {
+    return TileAt(x, y).indices.data() + (size_t)(y % TILE_SIZE) * TILE_ROW_BYTES + (x % TILE_SIZE) / 2;
+}
+
+/*! \brief  Walk right from x over pixels of mask. A tile of one index is passed in one
+*           step, and for a mask of one index, 16 pixels that start on a multiple of 16 are
+*           8 bytes of one tile row, so they are checked with one compare.
+*/
+int IndexedCanvas::RunRight(int x, int y, unsigned int mask, int limit) const {
+    std::uint64_t pattern = 0;
+    const bool single = SingleIndex(mask, pattern);
+    for (int next = x + 1; next <= limit;) {
+        const int base = next - next % TILE_SIZE;
+        const int end = std::min(limit, base + TILE_SIZE - 1) - base;
+        const Tile& tile = TileAt(base, y);
+        if (tile.indices.empty()) {
+            if ((mask >> tile.index & 1) == 0) {
+                return next - 1;
+            }
+            next = base + end + 1;
+            continue;
+        }
+        const sf::Uint8* row = ByteAt(base, y);
+        for (int i = next - base; i <= end; i++) {
+            if (single && (i & 15) == 0 && i + 15 <= end) {
+                std::uint64_t word;
+                std::memcpy(&word, row + i / 2, sizeof(word));
+                if (word == pattern) {
+                    i += 15;
+                    continue;
+                }
+            }
+            if ((mask >> ((row[i / 2] >> ((i & 1) * 4)) & 0xF) & 1) == 0) {
+                return base + i - 1;
+            }
+        }
+        next = base + end + 1;
+    }
+    return std::max(x, limit);
+}
+
+/*! \brief  Walk left from x over pixels of mask, a tile of one index or 16 pixels at a time
+*           where they line up.
+*/
+int IndexedCanvas::RunLeft(int x, int y, unsigned int mask, int limit) const {
+    std::uint64_t pattern = 0;
+    const bool single = SingleIndex(mask, pattern);
+    for (int next = x - 1; next >= limit;) {
+        const int base = next - next % TILE_SIZE;
+        const int begin = std::max(limit, base) - base;
+        const Tile& tile = TileAt(base, y);
+        if (tile.indices.empty()) {
+            if ((mask >> tile.index & 1) == 0) {
+                return next + 1;
+            }
+            next = base + begin - 1;
+            continue;
+        }
+        const sf::Uint8* row = ByteAt(base, y);
+        for (int i = next - base; i >= begin; i--) {
+            if (single && (i & 15) == 15 && i - 15 >= begin) {
+                std::uint64_t word;
+                std::memcpy(&word, row + (i - 15) / 2, sizeof(word));
+                if (word == pattern) {
+                    i -= 15;
+                    continue;
+                }
+            }
+            if ((mask >> ((row[i / 2] >> ((i & 1) * 4)) & 0xF) & 1) == 0) {
+                return base + i + 1;
+            }
+        }
+        next = base + begin - 1;
+    }
+    return std::min(x, limit);
+}
+
+/*! \brief  Find the first pixel of mask from x on. A tile of one index is skipped in one
+*           step, and for a mask of one index so are 16 pixels that line up when none of
+*           their nibbles is of it.
+*/
+int IndexedCanvas::NextOf(int x, int y, unsigned int mask, int limit) const {
+    std::uint64_t pattern = 0;
+    const bool single = SingleIndex(mask, pattern);
+    while (x <= limit) {
+        const int base = x - x % TILE_SIZE;
+        const int end = std::min(limit, base + TILE_SIZE - 1) - base;
+        const Tile& tile = TileAt(base, y);
+        if (tile.indices.empty()) {
+            if (mask >> tile.index & 1) {
+                return x;
+            }
+            x = base + end + 1;
+            continue;
+        }
+        const sf::Uint8* row = ByteAt(base, y);
+        for (int i = x - base; i <= end; i++) {
+            if (single && (i & 15) == 0 && i + 15 <= end) {
+                std::uint64_t word;
+                std::memcpy(&word, row + i / 2, sizeof(word));
+                // A nibble of the index is a zero nibble of word ^ pattern.
+                const std::uint64_t v = word ^ pattern;
+                if (((v - NIBBLES) & ~v & NIBBLES * 8) == 0) {
+                    i += 15;
+                    continue;
+                }
+            }
+            if (mask >> ((row[i / 2] >> ((i & 1) * 4)) & 0xF) & 1) {
+                return base + i;
+            }
+        }
+        x = base + end + 1;
+    }
+    return limit + 1;
+}
+
+/*! \brief  Set pixels x0 to x1 of row y to index. Within each tile the odd first and even
+*           last pixel are set by nibble and the bytes between them with one memset.
+*/
+void IndexedCanvas::FillRow(int y, int x0, int x1, int index) {
+    const sf::Uint8 low = (sf::Uint8)(index & 0xF);
+    while (x0 <= x1) {
+        const int end = std::min(x1, (x0 / TILE_SIZE + 1) * TILE_SIZE - 1);
+        int a = x0;
+        int b = end;
+        if (a & 1) {
+            sf::Uint8* p = ByteAt(a, y);
+            *p = (sf::Uint8)((*p & 0x0F) | low << 4);
+            a++;
+        }
+        if (a <= b && (b & 1) == 0) {
+            sf::Uint8* p = ByteAt(b, y);
+            *p = (sf::Uint8)((*p & 0xF0) | low);
+            b--;
+        }
+        if (a < b) {
+            std::memset(ByteAt(a, y), low * 0x11, (size_t)(b - a + 1) / 2);
+        }
+        x0 = end + 1;
+    }
+}
+
+int IndexedCanvas::GetWidth() const {
+    return m_width;
+}
+
+int IndexedCanvas::GetHeight() const {
+    return m_height;
+}
+
+int IndexedCanvas::GetTilesX() const {
+    return m_tiles_x;
+}
+
+int IndexedCanvas::GetTileCount() const {
+    return m_tiles_x * m_tiles_y;
+}
+
+sf::IntRect IndexedCanvas::GetTileRect(int tile) const {
+    const int left = (tile % m_tiles_x) * TILE_SIZE;
+    const int top = (tile / m_tiles_x) * TILE_SIZE;
+    return sf::IntRect(left, top, std::min(TILE_SIZE, m_width - left), std::min(TILE_SIZE, m_height - top));
+}
+
+const std::vector<sf::Color>& IndexedCanvas::GetPalette() const {
+    return m_palette;
+}
+
+int IndexedCanvas::FindColor(sf::Color color) const {
+    for (size_t i = 0; i < m_palette.size(); i++) {
+        if (m_palette[i] == color) {
+            return (int)i;
+        }
+    }
+    return NO_INDEX;
+}
+
+int IndexedCanvas::AddColor(sf::Color color) {
+    const int index = FindColor(color);
+    if (index != NO_INDEX || m_palette.size() >= (size_t)MAX_COLORS) {
+        return index;
+    }
+    m_palette.push_back(color);
+    BuildExpand();
+    return (int)m_palette.size() - 1;
+}
+
+/*! \brief  Change a color of the palette. Only the palette and the expand table change,
+*           however many pixels have the color.
+*/
+void IndexedCanvas::SetPaletteColor(int index, sf::Color color) {
+    if (index < 0 || index >= (int)m_palette.size()) {
+        return;
+    }
+    m_palette[(size_t)index] = color;
+    BuildExpand();
+}
+
+unsigned int IndexedCanvas::GetColorMask(sf::Color color) const {
+    unsigned int mask = 0;
+    for (size_t i = 0; i < m_palette.size(); i++) {
+        if (m_palette[i] == color) {
+            mask |= 1u << i;
+        }
+    }
+    return mask;
+}
+
+int IndexedCanvas::GetIndex(int x, int y) const {
+    const Tile& tile = TileAt(x, y);
+    return tile.indices.empty() ? tile.index : (*ByteAt(x, y) >> ((x & 1) * 4)) & 0xF;
+}
+
+void IndexedCanvas::SetIndex(int x, int y, int index) {
+    sf::Uint8* p = ByteAt(x, y);
+    const int shift = (x & 1) * 4;
+    *p = (sf::Uint8)((*p & ~(0xF << shift)) | (index & 0xF) << shift);
+}
+
+sf::Color IndexedCanvas::GetPixel(int x, int y) const {
+    const int index = GetIndex(x, y);
+    return index < (int)m_palette.size() ? m_palette[(size_t)index] : sf::Color::Transparent;
+}
+
+void IndexedCanvas::FillRect(const sf::IntRect& rect, int index) {
+    const int x0 = std::max(rect.left, 0);
+    const int x1 = std::min(rect.left + rect.width, m_width) - 1;
+    for (int y = std::max(rect.top, 0); y < std::min(rect.top + rect.height, m_height); y++) {
+        FillRow(y, x0, x1, index);
+    }
+}
+
+/*! \brief  Fill the capsule a row at a time. The capsule is convex, so its part of a row is
+*           the span from the leftmost to the rightmost point where the row crosses the
+*           discs at its ends or the rectangle between them.
+*/
+void IndexedCanvas::FillCapsule(sf::Vector2f a, sf::Vector2f b, float width, int index) {
+    const float radius = width / 2.0f;
+    const sf::Vector2f d = b - a;
+    const float length = std::sqrt(d.x * d.x + d.y * d.y);
+    // The corners of the rectangle, going round it.
+    sf::Vector2f corners[4];
+    if (length > 0.0f) {
+        const sf::Vector2f normal(-d.y * radius / length, d.x * radius / length);
+        corners[0] = a + normal;
+        corners[1] = b + normal;
+        corners[2] = b - normal;
+        corners[3] = a - normal;
+    }
+    const int y0 = std::max(0, (int)std::floor(std::min(a.y, b.y) - radius));
+    const int y1 = std::min(m_height - 1, (int)std::ceil(std::max(a.y, b.y) + radius));
+    for (int y = y0; y <= y1; y++) {
+        const float cy = (float)y + 0.5f;
+        float left = (float)m_width;
+        float right = -1.0f;
+        for (const sf::Vector2f& end : {a, b}) {
+            const float dy = cy - end.y;
+            if (dy * dy <= radius * radius) {
+                const float half = std::sqrt(radius * radius - dy * dy);
+                left = std::min(left, end.x - half);
+                right = std::max(right, end.x + half);
+            }
+        }
+        for (int i = 0; length > 0.0f && i < 4; i++) {
+            const sf::Vector2f& p = corners[i];
+            const sf::Vector2f& q = corners[(i + 1) % 4];
+            if (p.y != q.y && (p.y - cy) * (q.y - cy) <= 0.0f) {
+                const float x = p.x + (cy - p.y) * (q.x - p.x) / (q.y - p.y);
+                left = std::min(left, x);
+                right = std::max(right, x);
+            }
+        }
+        // The pixels whose centers are in [left, right].
+        const int x0 = std::max(0, (int)std::ceil(left - 0.5f));
+        const int x1 = std::min(m_width - 1, (int)std::floor(right - 0.5f));
+        if (x0 <= x1) {
+            FillRow(y, x0, x1, index);
+        }
+    }
+}
+
+std::vector<MathUtility::Span> IndexedCanvas::Fill(int x, int y, int index) {
+    return Fill(x, y, index, sf::IntRect(0, 0, m_width, m_height));
+}
+
+/*! \brief  Scanline fill of the pixels of every index of the color of (x,y): every span is
+*           widened to the whole run of them in its row and set to index at once, which also
+*           marks it as visited, and the rows above and below it are searched for runs of
+*           them to start the next spans from.
+*/
+std::vector<MathUtility::Span> IndexedCanvas::Fill(int x, int y, int index, const sf::IntRect& area) {
+    std::vector<MathUtility::Span> spans;
+    const int left = std::max(area.left, 0);
+    const int top = std::max(area.top, 0);
+    const int right = std::min(area.left + area.width, m_width) - 1;
+    const int bottom = std::min(area.top + area.height, m_height) - 1;
+    if (x < left || y < top || x > right || y > bottom) {
+        return spans;
+    }
+    const unsigned int target = GetColorMask(GetPixel(x, y)) | 1u << GetIndex(x, y);
+    if (target >> (index & 0xF) & 1) {
+        return spans;
+    }
+    std::vector<std::pair<int, int>> seeds{{x, y}};
+    while (!seeds.empty()) {
+        const int sx = seeds.back().first;
+        const int sy = seeds.back().second;
+        seeds.pop_back();
+        if ((target >> GetIndex(sx, sy) & 1) == 0) {
+            continue;
+        }
+        const int x0 = RunLeft(sx, sy, target, left);
+        const int x1 = RunRight(sx, sy, target, right);
+        FillRow(sy, x0, x1, index);
+        spans.push_back(MathUtility::Span{sy, x0, x1});
+        for (int ny = sy - 1; ny <= sy + 1; ny += 2) {
+            if (ny < top || ny > bottom) {
+                continue;
+            }
+            for (int nx = NextOf(x0, ny, target, x1); nx <= x1; nx = NextOf(RunRight(nx, ny, target, x1) + 1, ny, target, x1)) {
+                seeds.emplace_back(nx, ny);
+            }
+        }
+    }
+    return spans;
+}
+
+const IndexedCanvas::Tile& IndexedCanvas::GetTile(int tile) const {
+    return m_tiles[(size_t)tile];
+}
+
+/*! \brief  Swap a tile with other, without copying either.
+*
+*/
+void IndexedCanvas::SwapTile(int tile, Tile& other) {
+    std::swap(m_tiles[(size_t)tile], other);
+}
+
+/*! \brief  Drop the indices of a tile if its pixels on the canvas are all of one index.
+*
+*/
+bool IndexedCanvas::Compact(int tile) {
+    Tile& t = m_tiles[(size_t)tile];
+    if (t.indices.empty()) {
+        return true;
+    }
+    const sf::IntRect rect = GetTileRect(tile);
+    const sf::Uint8 index = t.indices[0] & 0xF;
+    const sf::Uint8 pair = (sf::Uint8)(index * 0x11);
+    for (int y = 0; y < rect.height; y++) {
+        const sf::Uint8* row = t.indices.data() + (size_t)y * TILE_ROW_BYTES;
+        for (int i = 0; i < rect.width / 2; i++) {
+            if (row[i] != pair) {
+                return false;
+            }
+        }
+        if ((rect.width & 1) && (row[rect.width / 2] & 0xF) != index) {
+            return false;
+        }
+    }
+    std::vector<sf::Uint8>().swap(t.indices);
+    t.index = index;
+    return true;
+}
+
+/*! \brief  Look for a pixel of index in a tile, a row at a time with the run search.
+*
+*/
+bool IndexedCanvas::HasIndex(int tile, int index) const {
+    const Tile& t = m_tiles[(size_t)tile];
+    if (t.indices.empty()) {
+        return t.index == index;
+    }
+    const sf::IntRect rect = GetTileRect(tile);
+    const int right = rect.left + rect.width - 1;
+    for (int y = rect.top; y < rect.top + rect.height; y++) {
+        if (NextOf(rect.left, y, 1u << index, right) <= right) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/*! \brief  Look up the index of every pixel of a tile. Pixels mostly come in runs of one
+*           color, so the last color found is checked before the palette.
+*/
+bool IndexedCanvas::ReadTile(int tile, const sf::Uint8* pixels, size_t stride) {
+    sf::Uint32 colors[MAX_COLORS];
+    for (size_t i = 0; i < m_palette.size(); i++) {
+        colors[i] = MathUtility::PackColor(m_palette[i]);
+    }
+    const sf::IntRect rect = GetTileRect(tile);
+    std::vector<sf::Uint8> indices(TILE_BYTES, 0);
+    sf::Uint32 last = m_palette.empty() ? 0 : colors[0];
+    int lastIndex = m_palette.empty() ? NO_INDEX : 0;
+    for (int y = 0; y < rect.height; y++) {
+        const sf::Uint8* p = pixels + (size_t)y * stride;
+        sf::Uint8* row = indices.data() + (size_t)y * TILE_ROW_BYTES;
+        for (int x = 0; x < rect.width; x++, p += 4) {
+            sf::Uint32 pixel;
+            std::memcpy(&pixel, p, sizeof(pixel));
+            if (pixel != last || lastIndex == NO_INDEX) {
+                lastIndex = NO_INDEX;
+                for (size_t i = 0; i < m_palette.size(); i++) {
+                    if (colors[i] == pixel) {
+                        lastIndex = (int)i;
+                        break;
+                    }
+                }
+                if (lastIndex == NO_INDEX) {
+                    lastIndex = AddColor(sf::Color(p[0], p[1], p[2], p[3]));
+                    if (lastIndex == NO_INDEX) {
+                        return false;
+                    }
+                    colors[lastIndex] = pixel;
+                }
+                last = pixel;
+            }
+            row[x / 2] |= (sf::Uint8)(lastIndex << ((x & 1) * 4));
+        }
+    }
+    m_tiles[(size_t)tile].indices.swap(indices);
+    Compact(tile);
+    return true;
+}
+
+void IndexedCanvas::ExpandTile(int tile, sf::Uint8* pixels, size_t stride) const {
+    ExpandRect(GetTileRect(tile), pixels, stride);
+}
+
+/*! \brief  Expand a rectangle to RGBA8 with one 8 byte copy from the table per byte of
+*           indices, and a tile of one index with copies of its color.
+*/
+void IndexedCanvas::ExpandRect(const sf::IntRect& rect, sf::Uint8* pixels, size_t stride) const {
+    const int x0 = std::max(rect.left, 0);
+    const int x1 = std::min(rect.left + rect.width, m_width);
+    const sf::Uint8* expand = m_expand.data();
+    for (int y = std::max(rect.top, 0); y < std::min(rect.top + rect.height, m_height); y++) {
+        sf::Uint8* dst = pixels + (size_t)(y - rect.top) * stride + (size_t)(x0 - rect.left) * 4;
+        for (int x = x0; x < x1; ) {
+            const int base = x - x % TILE_SIZE;
+            const int end = std::min(x1, base + TILE_SIZE) - base;
+            int i = x - base;
+            const Tile& tile = TileAt(base, y);
+            if (tile.indices.empty()) {
+                const sf::Uint8* color = expand + (size_t)tile.index * 0x11 * 8;
+                for (; i < end; i++, dst += 4) {
+                    std::memcpy(dst, color, 4);
+                }
+                x = base + end;
+                continue;
+            }
+            const sf::Uint8* row = ByteAt(base, y);
+            if (i & 1) {
+                std::memcpy(dst, expand + (size_t)row[i / 2] * 8 + 4, 4);
+                dst += 4;
+                i++;
+            }
+            for (; i + 1 < end; i += 2, dst += 8) {
+                std::memcpy(dst, expand + (size_t)row[i / 2] * 8, 8);
+            }
+            if (i < end) {
+                std::memcpy(dst, expand + (size_t)row[i / 2] * 8, 4);
+                dst += 4;
+            }
+            x = base + end;
+        }
+    }
+}
+
+void IndexedCanvas::CopyToImage(sf::Image& image) const {
+    image.create((unsigned int)m_width, (unsigned int)m_height);
+    ExpandRect(sf::IntRect(0, 0, m_width, m_height), MathUtility::MutablePixels(image), (size_t)m_width * 4);
+}
+
+size_t IndexedCanvas::GetByteSize() const {
+    size_t bytes = m_tiles.capacity() * sizeof(Tile);
+    for (const Tile& tile : m_tiles) {
+        bytes += tile.indices.capacity();
+    }
+    return bytes;
+}
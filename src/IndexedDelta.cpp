@@ -0,0 +1,216 @@
+/** 
+ *  @file   IndexedDelta.cpp 
+ *  @brief  Implementation of IndexedDelta.hpp
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include standard library C++ libraries.
+#include <algorithm>
+#include <cstdint>
+#include <string>
+// Project header files
+#include "IndexedDelta.hpp"
+#include "Varint.hpp"
+
+namespace {
+
+// How a spilled tile is written: its one index, or TILE_BYTES of indices.
+enum TileKind {
+    UNIFORM_TILE = 0,
+    INDICES_TILE = 1
+};
+
+} // namespace
+
+/*! \brief  Constructor for an IndexedDelta that records changes to canvas.
+*
+*/
+IndexedDelta::IndexedDelta(IndexedCanvas& canvas, sf::Image& image, const std::string& name) : Command(image),
+    m_canvas(canvas),
+    m_name(name),
+    m_slots((size_t)canvas.GetTileCount(), -1) {
+}
+
+IndexedDelta::~IndexedDelta(){}
+
+/*! \brief  Save a copy of every tile overlapping [x0, x1] x [y0, y1] that is not saved yet.
+*           Must be called before those pixels are written.
+*/
+void IndexedDelta::touch(int x0, int y0, int x1, int y1) {
+    if (m_slots.empty()) {
+        return;
+    }
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, m_canvas.GetWidth() - 1);
+    y1 = std::min(y1, m_canvas.GetHeight() - 1);
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
+    const int size = IndexedCanvas::TILE_SIZE;
+    for (int ty = y0 / size; ty <= y1 / size; ty++) {
+        for (int tx = x0 / size; tx <= x1 / size; tx++) {
+            const int tile = ty * m_canvas.GetTilesX() + tx;
+            if (m_slots[tile] >= 0) {
+                continue;
+            }
+            // Compacted first, so a tile that ends up as it was compares equal.
+            m_canvas.Compact(tile);
+            m_slots[tile] = (int)m_tiles.size();
+            m_tiles.emplace_back(tile, m_canvas.GetTile(tile));
+        }
+    }
+}
+
+/*! \brief  Stop recording: keep the saved tiles that differ from the tiles of the canvas,
+*           which are compacted first.
+*/
+bool IndexedDelta::execute() {
+    size_t kept = 0;
+    for (size_t i = 0; i < m_tiles.size(); i++) {
+        auto& saved = m_tiles[i];
+        m_canvas.Compact(saved.first);
+        const IndexedCanvas::Tile& now = m_canvas.GetTile(saved.first);
+        if (saved.second.indices == now.indices && (!now.indices.empty() || saved.second.index == now.index)) {
+            continue;
+        }
+        const sf::IntRect rect = m_canvas.GetTileRect(saved.first);
+        if (kept == 0) {
+            m_bounds = rect;
+        } else {
+            const int left = std::min(m_bounds.left, rect.left);
+            const int top = std::min(m_bounds.top, rect.top);
+            const int right = std::max(m_bounds.left + m_bounds.width, rect.left + rect.width);
+            const int bottom = std::max(m_bounds.top + m_bounds.height, rect.top + rect.height);
+            m_bounds = sf::IntRect(left, top, right - left, bottom - top);
+        }
+        if (kept != i) {
+            m_tiles[kept] = std::move(saved);
+        }
+        kept++;
+    }
+    m_tiles.resize(kept);
+    m_tiles.shrink_to_fit();
+    // The tile table is only needed while recording.
+    std::vector<int>().swap(m_slots);
+    return !m_tiles.empty();
+}
+
+/*! \brief  Swap the saved tiles with the ones of the canvas, which turns before into after
+*           and after into before.
+*/
+void IndexedDelta::swap() {
+    for (auto& saved : m_tiles) {
+        m_canvas.SwapTile(saved.first, saved.second);
+    }
+}
+
+/*! \brief  Turn the changed tiles back to how they were before the gesture.
+*
+*/
+bool IndexedDelta::undo() {
+    swap();
+    return true;
+}
+
+/*! \brief  Turn the changed tiles back to how they were after the gesture.
+*
+*/
+bool IndexedDelta::redo() {
+    swap();
+    return true;
+}
+
+/*! \brief  Return the top left pixel of the first changed tile.
+*
+*/
+std::pair<int, int> IndexedDelta::getCoords() {
+    return std::make_pair(m_bounds.left, m_bounds.top);
+}
+
+/*! \brief  Return a human readable description of the gesture.
+*
+*/
+std::string IndexedDelta::getDescription() {
+    return m_name + " (" + std::to_string(getTileCount()) + " indexed tiles, " + std::to_string(getByteSize()) + " bytes)";
+}
+
+/*! \brief  Return the number of tiles the gesture changed.
+*
+*/
+size_t IndexedDelta::getTileCount() const {
+    return m_tiles.size();
+}
+
+/*! \brief  Return the number of bytes the saved tiles take.
+*
+*/
+size_t IndexedDelta::getByteSize() const {
+    size_t bytes = m_tiles.capacity() * sizeof(m_tiles[0]);
+    for (const auto& saved : m_tiles) {
+        bytes += saved.second.indices.capacity();
+    }
+    return bytes;
+}
+
+/*! \brief  Append the saved tiles to bytes and free them.
+*
+*/
+bool IndexedDelta::spill(std::vector<sf::Uint8>& bytes) {
+    Varint::Put(bytes, m_tiles.size());
+    for (const auto& saved : m_tiles) {
+        Varint::Put(bytes, (std::uint64_t)saved.first);
+        if (saved.second.indices.empty()) {
+            bytes.push_back(UNIFORM_TILE);
+            bytes.push_back(saved.second.index);
+        } else {
+            bytes.push_back(INDICES_TILE);
+            bytes.insert(bytes.end(), saved.second.indices.begin(), saved.second.indices.end());
+        }
+    }
+    std::vector<std::pair<int, IndexedCanvas::Tile>>().swap(m_tiles);
+    return true;
+}
+
+/*! \brief  Read back the saved tiles written by spill().
+*
+*/
+bool IndexedDelta::restore(const std::vector<sf::Uint8>& bytes) {
+    const sf::Uint8* p = bytes.data();
+    const sf::Uint8* end = p + bytes.size();
+    std::uint64_t count = 0;
+    if (!Varint::Get(p, end, count) || count > (std::uint64_t)m_canvas.GetTileCount()) {
+        return false;
+    }
+    std::vector<std::pair<int, IndexedCanvas::Tile>> tiles;
+    for (std::uint64_t i = 0; i < count; i++) {
+        std::uint64_t tile = 0;
+        if (!Varint::Get(p, end, tile) || tile >= (std::uint64_t)m_canvas.GetTileCount() || end - p < 2) {
+            return false;
+        }
+        IndexedCanvas::Tile saved;
+        const sf::Uint8 kind = *p++;
+        if (kind == UNIFORM_TILE) {
+            saved.index = (sf::Uint8)(*p++ & 0xF);
+        } else if (kind == INDICES_TILE && end - p >= IndexedCanvas::TILE_BYTES) {
+            saved.indices.assign(p, p + IndexedCanvas::TILE_BYTES);
+            p += IndexedCanvas::TILE_BYTES;
+        } else {
+            return false;
+        }
+        tiles.emplace_back((int)tile, std::move(saved));
+    }
+    if (p != end) {
+        return false;
+    }
+    m_tiles = std::move(tiles);
+    return true;
+}
+
+/*! \brief  Return the bounding box of the changed tiles.
+*
+*/
+sf::IntRect IndexedDelta::getBounds() const {
+    return m_bounds;
+}
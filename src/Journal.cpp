@@ -0,0 +1,317 @@
+/** 
+ *  @file   Journal.cpp 
+ *  @brief  Implementation of Journal.hpp
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include standard library C++ libraries.
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+// Project header files
+#include "Journal.hpp"
+#include "Varint.hpp"
+
+namespace {
+
+// The first bytes of every journal file.
+const sf::Uint8 JOURNAL_MAGIC[4] = {'M', 'P', 'J', '1'};
+
+// Push the stdio buffer to the OS and wait until the OS has the file on disk.
+bool SyncFile(std::FILE* file) {
+    if (std::fflush(file) != 0) {
+        return false;
+    }
+#ifdef _WIN32
+    return _commit(_fileno(file)) == 0;
+#else
+    return fsync(fileno(file)) == 0;
+#endif
+}
+
+// Cut the file back to size bytes.
+bool TruncateFile(std::FILE* file, size_t size) {
+    std::clearerr(file);
+#ifdef _WIN32
+    return _chsize(_fileno(file), (long)size) == 0;
+#else
+    return ftruncate(fileno(file), (off_t)size) == 0;
+#endif
+}
+
+// Read the whole file at path. Returns false if it can not be opened.
+bool ReadFile(const std::string& path, std::vector<sf::Uint8>& bytes) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    bytes.clear();
+    sf::Uint8 buffer[65536];
+    size_t count;
+    while ((count = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        bytes.insert(bytes.end(), buffer, buffer + count);
+    }
+    std::fclose(file);
+    return true;
+}
+
+}
+
+/*! \brief  Journal constructor. Nothing is written until Open().
+*
+*/
+Journal::Journal() : m_file(nullptr),
+    m_flush_interval_ms(DEFAULT_FLUSH_INTERVAL_MS),
+    m_pending_count(0),
+    m_size(0),
+    m_record_count(0),
+    m_stopping(false) {
+}
+
+/*! \brief  Journal destructor. The queued records are written before the file is closed.
+*
+*/
+Journal::~Journal() {
+    Close();
+}
+
+/*! \brief  Open the journal at path for appending, keeping its intact records.
+*
+*/
+bool Journal::Open(const std::string& path, int flushIntervalMs) {
+    Close();
+    std::vector<std::vector<sf::Uint8>> records;
+    size_t validSize = 0;
+    if (!ReadRecords(path, records, validSize)) {
+        return false;
+    }
+    // Rewrite the file when it is new, or to cut off a record torn by a crash.
+    std::vector<sf::Uint8> bytes;
+    if (!ReadFile(path, bytes) || validSize == 0 || validSize < bytes.size()) {
+        if (validSize == 0) {
+            bytes.assign(JOURNAL_MAGIC, JOURNAL_MAGIC + sizeof(JOURNAL_MAGIC));
+            validSize = bytes.size();
+        }
+        std::FILE* file = std::fopen(path.c_str(), "wb");
+        if (file == nullptr) {
+            return false;
+        }
+        const bool written = std::fwrite(bytes.data(), 1, validSize, file) == validSize && SyncFile(file);
+        std::fclose(file);
+        if (!written) {
+            return false;
+        }
+    }
+    m_file = std::fopen(path.c_str(), "ab");
+    if (m_file == nullptr) {
+        return false;
+    }
+    // Records are written a batch at a time anyway, and with no stdio buffer a failed write
+    // leaves nothing behind to be flushed after the file is cut back.
+    std::setvbuf(m_file, nullptr, _IONBF, 0);
+    m_flush_interval_ms = flushIntervalMs;
+    m_size = validSize;
+    m_record_count = records.size();
+    m_stopping = false;
+    m_writer = std::thread(&Journal::WriterLoop, this);
+    return true;
+}
+
+/*! \brief  Frame a record and queue it for the background thread.
+*
+*/
+void Journal::Append(const std::vector<sf::Uint8>& record) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        Varint::Put(m_pending, record.size());
+        m_pending.insert(m_pending.end(), record.begin(), record.end());
+        Varint::PutUint32(m_pending, Crc32(record.data(), record.size()));
+        m_pending_count++;
+    }
+    if (m_flush_interval_ms <= 0) {
+        m_wake.notify_one();
+    }
+}
+
+/*! \brief  Write the queued records every flush interval until the journal is closed.
+*
+*/
+void Journal::WriterLoop() {
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            if (m_flush_interval_ms > 0) {
+                m_wake.wait_for(lock, std::chrono::milliseconds(m_flush_interval_ms), [this] { return m_stopping; });
+            } else {
+                m_wake.wait(lock, [this] { return m_stopping || m_pending_count > 0; });
+            }
+            if (m_stopping) {
+                return;
+            }
+        }
+        WritePending();
+    }
+}
+
+/*! \brief  Take the queued records, write them in one go and fsync the file. Only the
+*           swap of the queue holds m_mutex, so Append() never waits for the disk. If the write
+*           or the fsync fails, the file is cut back to its last good size, so no torn record
+*           is left for later ones to sit behind, and the records go back to the front of the
+*           queue for the next try.
+*/
+bool Journal::WritePending() {
+    std::lock_guard<std::mutex> fileLock(m_file_mutex);
+    std::vector<sf::Uint8> bytes;
+    size_t count;
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        bytes.swap(m_pending);
+        count = m_pending_count;
+        m_pending_count = 0;
+    }
+    if (bytes.empty() || m_file == nullptr) {
+        return m_file != nullptr;
+    }
+    if (std::fwrite(bytes.data(), 1, bytes.size(), m_file) != bytes.size() || !SyncFile(m_file)) {
+        TruncateFile(m_file, m_size);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        bytes.insert(bytes.end(), m_pending.begin(), m_pending.end());
+        m_pending.swap(bytes);
+        m_pending_count += count;
+        return false;
+    }
+    m_size += bytes.size();
+    m_record_count += count;
+    return true;
+}
+
+/*! \brief  Write and fsync the queued records on the calling thread.
+*
+*/
+bool Journal::Flush() {
+    return WritePending();
+}
+
+/*! \brief  Drop the queued records and cut the file back to its header, then fsync it. The
+*           file stays open for the records after.
+*/
+bool Journal::Reset() {
+    std::lock_guard<std::mutex> fileLock(m_file_mutex);
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending.clear();
+        m_pending_count = 0;
+    }
+    if (m_file == nullptr || !TruncateFile(m_file, sizeof(JOURNAL_MAGIC)) || !SyncFile(m_file)) {
+        return false;
+    }
+    m_size = sizeof(JOURNAL_MAGIC);
+    m_record_count = 0;
+    return true;
+}
+
+/*! \brief  Stop the background thread, write what is still queued and close the file.
+*
+*/
+void Journal::Close() {
+    if (m_writer.joinable()) {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_wake.notify_one();
+        m_writer.join();
+    }
+    if (m_file != nullptr) {
+        WritePending();
+        std::fclose(m_file);
+        m_file = nullptr;
+    }
+}
+
+/*! \brief  Return true if the journal is open for appending.
+*
+*/
+bool Journal::IsOpen() const {
+    return m_file != nullptr;
+}
+
+/*! \brief  Return the size of the journal, counting the records still queued.
+*
+*/
+size_t Journal::GetSize() {
+    std::lock_guard<std::mutex> fileLock(m_file_mutex);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_size + m_pending.size();
+}
+
+/*! \brief  Return the number of records in the journal, counting the ones still queued.
+*
+*/
+size_t Journal::GetRecordCount() {
+    std::lock_guard<std::mutex> fileLock(m_file_mutex);
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_record_count + m_pending_count;
+}
+
+/*! \brief  Read the intact records of the journal at path. A missing file is an empty journal.
+*
+*/
+bool Journal::ReadRecords(const std::string& path, std::vector<std::vector<sf::Uint8>>& records, size_t& validSize) {
+    records.clear();
+    validSize = 0;
+    std::vector<sf::Uint8> bytes;
+    if (!ReadFile(path, bytes) || bytes.size() < sizeof(JOURNAL_MAGIC)) {
+        // No journal, or one torn before its header was written.
+        return true;
+    }
+    if (std::memcmp(bytes.data(), JOURNAL_MAGIC, sizeof(JOURNAL_MAGIC)) != 0) {
+        return false;
+    }
+    const sf::Uint8* p = bytes.data() + sizeof(JOURNAL_MAGIC);
+    const sf::Uint8* end = bytes.data() + bytes.size();
+    validSize = sizeof(JOURNAL_MAGIC);
+    while (p < end) {
+        std::uint64_t size;
+        sf::Uint32 crc;
+        if (!Varint::Get(p, end, size) || size > (std::uint64_t)(end - p)) {
+            break;
+        }
+        const sf::Uint8* payload = p;
+        p += size;
+        if (!Varint::GetUint32(p, end, crc) || crc != Crc32(payload, (size_t)size)) {
+            break;
+        }
+        records.emplace_back(payload, payload + size);
+        validSize = (size_t)(p - bytes.data());
+    }
+    return true;
+}
+
+/*! \brief  CRC-32 with the reflected IEEE polynomial, computed with a 256 entry table.
+*
+*/
+sf::Uint32 Journal::Crc32(const sf::Uint8* data, size_t size) {
+    static const std::vector<sf::Uint32> table = [] {
+        std::vector<sf::Uint32> t(256);
+        for (sf::Uint32 i = 0; i < 256; i++) {
+            sf::Uint32 c = i;
+            for (int k = 0; k < 8; k++) {
+                c = (c & 1) ? 0xEDB88320u ^ (c >> 1) : c >> 1;
+            }
+            t[i] = c;
+        }
+        return t;
+    }();
+    sf::Uint32 crc = 0xFFFFFFFFu;
+    for (size_t i = 0; i < size; i++) {
+        crc = table[(crc ^ data[i]) & 0xFF] ^ (crc >> 8);
+    }
+    return crc ^ 0xFFFFFFFFu;
+}
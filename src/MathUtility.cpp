@@ -1,240 +1,451 @@
-/** 
- *  @file   MathUtility.cpp 
- *  @brief  Math utility functions
- *  @author Dennis Ping 
- *  @date   2021-11-13
- ***********************************************/
-
-#include <vector>
-#include <cmath>
-#include <iostream>
-#include <queue>
-#include <set>
-
-#include "MathUtility.hpp"
-#include "App.hpp"
-
-/*! \brief  Return a vector of intermediate pixels between (x1,y1) and (x2,y2).
-*           This is the Extremely Fast Line Algorithm (EFLA) Variation E
-*           Author: Po-Han Lin (2005)
-*           Source: http://www.edepot.com/algorithm.html 
-*/
-std::vector<std::pair<int, int>> MathUtility::ExtremelyFastLineAlgo(int x1, int y1, int x2, int y2) {
-    std::vector<std::pair<int, int>> pixelsVector;
-        bool yLonger = false;
-        int shortLen = y2 - y1;
-        int longLen = x2 - x1;
-        if (abs(shortLen) > abs(longLen)) {
-            int swap = shortLen;
-            shortLen = longLen;
-            longLen = swap;				
-            yLonger = true;
-        }
-        int decInc;
-        if (longLen == 0) decInc = 0;
-        else decInc = (shortLen << 16) / longLen;
-
-        if (yLonger) {
-            if (longLen > 0) {
-                longLen += y1;
-                for (int j = 0x8000 + (x1 << 16); y1 <= longLen; ++y1) {
-                    // Make a new pair and push it back into the vector
-                    pixelsVector.emplace_back(std::make_pair(j >> 16, y1));	
-                    j += decInc;
-                }
-                return pixelsVector;
-            }
-            longLen += y1;
-            for (int j = 0x8000 + (x1 << 16); y1 >= longLen; --y1) {
-                pixelsVector.emplace_back(std::make_pair(j >> 16, y1));
-                j -= decInc;
-            }
-            return pixelsVector;
-        }
-
-        if (longLen > 0) {
-            longLen += x1;
-            for (int j = 0x8000 + (y1 << 16); x1 <= longLen; ++x1) {
-                pixelsVector.emplace_back(std::make_pair(x1, j >> 16));
-                j += decInc;
-            }
-            return pixelsVector;
-        }
-        longLen += x1;
-        for (int j = 0x8000 + (y1 << 16); x1 >= longLen; --x1) {
-            pixelsVector.emplace_back(std::make_pair(x1, j >> 16));
-            j -= decInc;
-        }
-        return pixelsVector;
-}
-
-/*! \brief  Return a vector of a filled in circle using a modified version of Bresenham's Circle Algorithm.
-*           Cache this circle template so that App does not need to always compute this.
-*           Author: Linus Arver (2021)
-*           Source: https://funloop.org/post/2021-03-15-bresenham-circle-drawing-algorithm.html 
-*/
-std::vector<std::pair<int,int>> MathUtility::BresenhamCircleAlgo(int radius) {
-    std::set<std::pair<int, int>> outerSet;
-    int x = 0;
-    int y = -radius;
-    int F_M = 1 - radius;
-    int dir_east = 3;
-    int dir_northeast = -(radius << 1) + 5;
-    // Emplace all the mirror points of (x,y)
-    outerSet.emplace(std::make_pair(x, y));
-    outerSet.emplace(std::make_pair(x, -y));
-    outerSet.emplace(std::make_pair(-x, y));
-    outerSet.emplace(std::make_pair(-x, -y));
-    outerSet.emplace(std::make_pair(y, x));
-    outerSet.emplace(std::make_pair(y, -x));
-    outerSet.emplace(std::make_pair(-y, x));
-    outerSet.emplace(std::make_pair(-y, -x));
-
-    while (x < -y) {
-        if (F_M <= 0) {
-            F_M += dir_east;
-        } else {
-            F_M += dir_northeast;
-            dir_northeast += 2;
-            y += 1;
-        }
-        dir_east += 2;
-        dir_northeast += 2;
-        x += 1;
-        // Emplace all the mirror points of (x,y)
-        outerSet.emplace(std::make_pair(x, y));
-        outerSet.emplace(std::make_pair(x, -y));
-        outerSet.emplace(std::make_pair(-x, y));
-        outerSet.emplace(std::make_pair(-x, -y));
-        outerSet.emplace(std::make_pair(y, x));
-        outerSet.emplace(std::make_pair(y, -x));
-        outerSet.emplace(std::make_pair(-y, x));
-        outerSet.emplace(std::make_pair(-y, -x));
-    }
-
-    // O(n^2) loop to fill pixels in because math is hard.
-    // It's ok, we will cache this circle template anyway.
-    for (int j=0; j < radius; j++) {
-        for (int k=0; k < radius; k++) {
-            if (pow(j, 2) + pow(k, 2) < pow(radius, 2)) {
-                outerSet.emplace(std::make_pair(j,k));
-                outerSet.emplace(std::make_pair(j,-k));
-                outerSet.emplace(std::make_pair(-j,k));
-                outerSet.emplace(std::make_pair(-j,-k));
-            }
-        }
-    }
-    // Convert our set to a vector for easier access
-    std::vector<std::pair<int,int>> circleTemplate;
-    // Reserve memory in vector to get 4x performance: https://github.com/facontidavide/CPP_Optimizations_Diary/blob/master/docs/reserve.md 
-    circleTemplate.reserve((outerSet.size()*8));
-    // Use std::transform to fill the vector
-    std::transform(outerSet.begin(), outerSet.end(), std::back_inserter(circleTemplate), [](const std::pair<int,int>& p) { return p; });
-    return circleTemplate;
-}
-
-/*! \brief  A pairing function that maps two values to a single unique value.
-*           Essentially a hash function for pairs of signed integers.
-*           The C++ std lib pair hash only works for combinations, not permutations where order matters.
-*           Author: Matthew Szudzik (2006)
-*           Source: https://www.vertexfragment.com/ramblings/cantor-szudzik-pairing-functions/  
-*/
-namespace std {
-    template<>
-    struct hash<std::pair<int,int>> {
-        size_t operator()(const std::pair<int,int>& p) const {
-            int one = p.first;
-            int two = p.second;
-            int const a = (one >= 0.0 ? 2.0 * one : (-2.0 * one) - 1.0);
-            int const b = (two >= 0.0 ? 2.0 * two : (-2.0 * two) - 1.0);
-            return (a >= b ? (a * a) + a + b : (b * b) + a) * 0.5;
-        }
-    };
-}
-
-// /*! \brief 	Return a vector of pairs of (x,y) coordinates that within inside the radius of the paintbrush center.
-// *           This is the brute force version of Bresenham's Circle Algorithm
-// *           Source: https://stackoverflow.com/questions/1201200/fast-algorithm-for-drawing-filled-circles
-// *           Author: Daniel Earwicker (2009)
-// * */
-// std::vector<std::pair<int, int>> Utility::MidpointCircleAlgo(int xCenter, int yCenter, int radius) {
-    // std::vector<std::pair<int, int>> pixelsVector;
-    // int radius_sqr = radius * radius;
-    // for (int x = -radius; x < radius ; x++) {
-    //     int hh = (int)std::sqrt(radius_sqr - x * x);
-    //     int rx = xCenter + x;
-    //     int ph = yCenter + hh;
-
-    //     for (int y = yCenter-hh; y < ph; y++) {
-    //         pixelsVector.push_back(std::make_pair(rx, y));
-    //     }
-    // }
-// }
-
-// std::vector<std::pair<int, int>> Utility::MidpointCircleAlgo(int xCenter, int yCenter, int radius) {
-//     std::vector<std::pair<int, int>> pixelsVector;
-//     int x = radius;
-//     int y = 0;
-//     int radiusError = 1 - x;
-//     while (x >= y) {  // iterate to the circle diagonal
-//         // use symmetry to draw the two horizontal lines at this Y with a special case to draw
-//         // only one line at the centerY where y == 0
-//         int startX = -x + xCenter;
-//         int endX = x + xCenter;         
-//         for (int i = startX; i <= endX; i++) {
-//             pixelsVector.push_back(std::make_pair(i, y + yCenter));
-//         }
-//         if (y != 0) {
-//             for (int i = startX; i <= endX; i++) {
-//                 pixelsVector.push_back(std::make_pair(i, -y + yCenter));
-//             }
-//         }
-//         // move Y one line
-//         y++;
-//         // calculate or maintain new x
-//         if (radiusError<0) {
-//             radiusError += 2 * y + 1;
-//         } 
-//         else {
-//             // we're about to move x over one, this means we completed a column of X values, use
-//             // symmetry to draw those complete columns as horizontal lines at the top and bottom of the circle
-//             // beyond the diagonal of the main loop
-//             if (x >= y)
-//             {
-//                 startX = -y + 1 + xCenter;
-//                 endX = y - 1 + xCenter;
-//                 for (int i = startX; i <= endX; i++) {
-//                     pixelsVector.push_back(std::make_pair(i, x + yCenter));
-//                     pixelsVector.push_back(std::make_pair(i, -x + yCenter));
-//                 }
-//             }
-//             x--;
-//             radiusError += 2 * (y - x + 1);
-//         }
-//     }
-//     return pixelsVector;
-// }
-
-// Source: https://en.wikipedia.org/wiki/Flood_fill
-// std::vector<std::pair<int, int>> Utility::FloodFill(sf::Image& image, int x, int y, sf::Color color) {
-//     std::vector<std::pair<int, int>> pixelsVector;
-//     std::queue<std::pair<int, int>> myQueue;
-//     std::unordered_set<std::pair<int, int>> mySet;
-//     myQueue.push(std::make_pair(x, y));
-//     while (!myQueue.empty()) {
-//         std::pair<int, int> pixel = myQueue.front();
-//         myQueue.pop();
-//         if (image.getPixel(pixel.first, pixel.second) != color) {
-//             mySet.insert(pixel);
-//             myQueue.push(std::make_pair(pixel.first + 1, pixel.second));
-//             myQueue.push(std::make_pair(pixel.first - 1, pixel.second));
-//             myQueue.push(std::make_pair(pixel.first, pixel.second + 1));
-//             myQueue.push(std::make_pair(pixel.first, pixel.second - 1));
-//         }
-//     }
-//     for (auto& pixel : mySet) {
-//         pixelsVector.push_back(pixel);
-//     }
-//     return pixelsVector;
-// }
-//
\ No newline at end of file
+/** 
+ *  @file   MathUtility.cpp 
+ *  @brief  Math utility functions
+ *  @author Dennis Ping 
+ *  @date   2021-11-13
+ ***********************************************/
+
+#include <vector>
+#include <cmath>
+#include <iostream>
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+
+#include "MathUtility.hpp"
+#include "App.hpp"
+#include "PixelKernels.hpp"
+#include "PixelSet.hpp"
+#include "ThreadPool.hpp"
+
+/*! \brief  Return a vector of intermediate pixels between (x1,y1) and (x2,y2).
+*           This is the Extremely Fast Line Algorithm (EFLA) Variation E
+*           Author: Po-Han Lin (2005)
+*           Source: http://www.edepot.com/algorithm.html 
+*/
+std::vector<std::pair<int, int>> MathUtility::ExtremelyFastLineAlgo(int x1, int y1, int x2, int y2) {
+    std::vector<std::pair<int, int>> pixelsVector;
+        bool yLonger = false;
+        int shortLen = y2 - y1;
+        int longLen = x2 - x1;
+        if (abs(shortLen) > abs(longLen)) {
+            int swap = shortLen;
+            shortLen = longLen;
+            longLen = swap;				
+            yLonger = true;
+        }
+        int decInc;
+        if (longLen == 0) decInc = 0;
+        else decInc = (shortLen << 16) / longLen;
+
+        if (yLonger) {
+            if (longLen > 0) {
+                longLen += y1;
+                for (int j = 0x8000 + (x1 << 16); y1 <= longLen; ++y1) {
+                    // Make a new pair and push it back into the vector
+                    pixelsVector.emplace_back(std::make_pair(j >> 16, y1));	
+                    j += decInc;
+                }
+                return pixelsVector;
+            }
+            longLen += y1;
+            for (int j = 0x8000 + (x1 << 16); y1 >= longLen; --y1) {
+                pixelsVector.emplace_back(std::make_pair(j >> 16, y1));
+                j -= decInc;
+            }
+            return pixelsVector;
+        }
+
+        if (longLen > 0) {
+            longLen += x1;
+            for (int j = 0x8000 + (y1 << 16); x1 <= longLen; ++x1) {
+                pixelsVector.emplace_back(std::make_pair(x1, j >> 16));
+                j += decInc;
+            }
+            return pixelsVector;
+        }
+        longLen += x1;
+        for (int j = 0x8000 + (y1 << 16); x1 >= longLen; --x1) {
+            pixelsVector.emplace_back(std::make_pair(x1, j >> 16));
+            j -= decInc;
+        }
+        return pixelsVector;
+}
+
+/*! \brief  Return a vector of a filled in circle using a modified version of Bresenham's Circle Algorithm.
+*           Cache this circle template so that App does not need to always compute this.
+*           Author: Linus Arver (2021)
+*           Source: https://funloop.org/post/2021-03-15-bresenham-circle-drawing-algorithm.html 
+*/
+std::vector<std::pair<int,int>> MathUtility::BresenhamCircleAlgo(int radius) {
+    PixelSet outerSet;
+    int x = 0;
+    int y = -radius;
+    int F_M = 1 - radius;
+    int dir_east = 3;
+    int dir_northeast = -(radius << 1) + 5;
+    // Emplace all the mirror points of (x,y)
+    outerSet.Insert(x, y);
+    outerSet.Insert(x, -y);
+    outerSet.Insert(-x, y);
+    outerSet.Insert(-x, -y);
+    outerSet.Insert(y, x);
+    outerSet.Insert(y, -x);
+    outerSet.Insert(-y, x);
+    outerSet.Insert(-y, -x);
+
+    while (x < -y) {
+        if (F_M <= 0) {
+            F_M += dir_east;
+        } else {
+            F_M += dir_northeast;
+            dir_northeast += 2;
+            y += 1;
+        }
+        dir_east += 2;
+        dir_northeast += 2;
+        x += 1;
+        // Emplace all the mirror points of (x,y)
+        outerSet.Insert(x, y);
+        outerSet.Insert(x, -y);
+        outerSet.Insert(-x, y);
+        outerSet.Insert(-x, -y);
+        outerSet.Insert(y, x);
+        outerSet.Insert(y, -x);
+        outerSet.Insert(-y, x);
+        outerSet.Insert(-y, -x);
+    }
+
+    // O(n^2) loop to fill pixels in because math is hard.
+    // It's ok, we will cache this circle template anyway.
+    for (int j=0; j < radius; j++) {
+        for (int k=0; k < radius; k++) {
+            if (pow(j, 2) + pow(k, 2) < pow(radius, 2)) {
+                outerSet.Insert(j,k);
+                outerSet.Insert(j,-k);
+                outerSet.Insert(-j,k);
+                outerSet.Insert(-j,-k);
+            }
+        }
+    }
+    // Convert our set to a vector for easier access, sorted by (x,y) so the order does not depend on the table
+    std::vector<std::pair<int,int>> circleTemplate = outerSet.ToVector();
+    std::sort(circleTemplate.begin(), circleTemplate.end());
+    return circleTemplate;
+}
+
+/*! \brief  A pairing function that maps two values to a single unique value.
+*           Essentially a hash function for pairs of signed integers.
+*           The C++ std lib pair hash only works for combinations, not permutations where order matters.
+*           Kept as the baseline PixelSet is benchmarked against; PixelKey::Mix is integer-only.
+*           Author: Matthew Szudzik (2006)
+*           Source: https://www.vertexfragment.com/ramblings/cantor-szudzik-pairing-functions/  
+*/
+size_t MathUtility::SzudzikHash::operator()(const std::pair<int,int>& p) const {
+    int one = p.first;
+    int two = p.second;
+    int const a = (one >= 0.0 ? 2.0 * one : (-2.0 * one) - 1.0);
+    int const b = (two >= 0.0 ? 2.0 * two : (-2.0 * two) - 1.0);
+    return (a >= b ? (a * a) + a + b : (b * b) + a) * 0.5;
+}
+
+// /*! \brief 	Return a vector of pairs of (x,y) coordinates that within inside the radius of the paintbrush center.
+// *           This is the brute force version of Bresenham's Circle Algorithm
+// *           Source: https://stackoverflow.com/questions/1201200/fast-algorithm-for-drawing-filled-circles
+// *           Author: Daniel Earwicker (2009)
+// * */
+// std::vector<std::pair<int, int>> Utility::MidpointCircleAlgo(int xCenter, int yCenter, int radius) {
+    // std::vector<std::pair<int, int>> pixelsVector;
+    // int radius_sqr = radius * radius;
+    // for (int x = -radius; x < radius ; x++) {
+    //     int hh = (int)std::sqrt(radius_sqr - x * x);
+    //     int rx = xCenter + x;
+    //     int ph = yCenter + hh;
+
+    //     for (int y = yCenter-hh; y < ph; y++) {
+    //         pixelsVector.push_back(std::make_pair(rx, y));
+    //     }
+    // }
+// }
+
+// std::vector<std::pair<int, int>> Utility::MidpointCircleAlgo(int xCenter, int yCenter, int radius) {
+//     std::vector<std::pair<int, int>> pixelsVector;
+//     int x = radius;
+//     int y = 0;
+//     int radiusError = 1 - x;
+//     while (x >= y) {  // iterate to the circle diagonal
+//         // use symmetry to draw the two horizontal lines at this Y with a special case to draw
+//         // only one line at the centerY where y == 0
+//         int startX = -x + xCenter;
+//         int endX = x + xCenter;         
+//         for (int i = startX; i <= endX; i++) {
+//             pixelsVector.push_back(std::make_pair(i, y + yCenter));
+//         }
+//         if (y != 0) {
+//             for (int i = startX; i <= endX; i++) {
+//                 pixelsVector.push_back(std::make_pair(i, -y + yCenter));
+//             }
+//         }
+//         // move Y one line
+//         y++;
+//         // calculate or maintain new x
+//         if (radiusError<0) {
+//             radiusError += 2 * y + 1;
+//         } 
+//         else {
+//             // we're about to move x over one, this means we completed a column of X values, use
+//             // symmetry to draw those complete columns as horizontal lines at the top and bottom of the circle
+//             // beyond the diagonal of the main loop
+//             if (x >= y)
+//             {
+//                 startX = -y + 1 + xCenter;
+//                 endX = y - 1 + xCenter;
+//                 for (int i = startX; i <= endX; i++) {
+//                     pixelsVector.push_back(std::make_pair(i, x + yCenter));
+//                     pixelsVector.push_back(std::make_pair(i, -x + yCenter));
+//                 }
+//             }
+//             x--;
+//             radiusError += 2 * (y - x + 1);
+//         }
+//     }
+//     return pixelsVector;
+// }
+
+/*! \brief  Return a writable pointer to the pixels of an image.
+*           sf::Image keeps its pixels in a non-const contiguous array but only
+*           exposes a const pointer, so casting the constness away is safe here.
+*/
+sf::Uint8* MathUtility::MutablePixels(sf::Image& image) {
+    return const_cast<sf::Uint8*>(image.getPixelsPtr());
+}
+
+/*! \brief  Pack a color into the 32-bit layout of one RGBA8 pixel so that whole pixels
+*           of a sf::Image buffer can be compared and written as a single integer.
+*/
+sf::Uint32 MathUtility::PackColor(sf::Color color) {
+    const sf::Uint8 rgba[4] = {color.r, color.g, color.b, color.a};
+    sf::Uint32 packed;
+    std::memcpy(&packed, rgba, sizeof(packed));
+    return packed;
+}
+
+namespace {
+
+// A pixel to grow into a span, the direction it was reached from, and the parent span
+// on the row it was reached from (which is already filled and need not be rescanned).
+struct FillSeed {
+    int x;
+    int y;
+    int dir;
+    int parentX0;
+    int parentX1;
+};
+
+// Span-based scanline fill confined to the rectangle (x0,y0)-(x1,y1) of a RGBA8 image.
+// Bit x of row y in the visited bitmap is bit (x & 63) of word y*stride + x/64, so
+// rectangles whose left edges are multiples of 64 never share a word.
+class SpanFiller {
+    private:
+        const sf::Uint8* m_pixels;
+        int m_width;
+        int m_height;
+        sf::Uint32 m_target;
+        std::uint64_t* m_visited;
+        size_t m_stride;
+        int m_x0, m_y0, m_x1, m_y1;
+
+        sf::Uint32 PixelAt(int x, int y) const {
+            sf::Uint32 p;
+            std::memcpy(&p, m_pixels + ((size_t)y * m_width + x) * 4, sizeof(p));
+            return p;
+        }
+
+        bool IsVisited(int x, int y) const {
+            return (m_visited[y * m_stride + (x >> 6)] >> (x & 63)) & 1;
+        }
+
+        // Spans are always whole runs of matching pixels, so a run is either entirely visited
+        // or not at all. Only the first pixel of a run needs the bitmap; the rest is a color scan.
+        int RunEnd(int x, int y, int last) const {
+            while (x <= last && PixelAt(x, y) == m_target) {
+                x++;
+            }
+            return x;
+        }
+
+        // Seed every run of matching pixels on row ny between xa and xb. Runs outside the
+        // rectangle are handed to escaped unfiltered, since their bitmap belongs to someone else.
+        void PushRuns(int ny, int xa, int xb, int dir, int parentX0, int parentX1,
+                      std::vector<FillSeed>& stack, std::vector<FillSeed>* escaped) const {
+            const bool inside = ny >= m_y0 && ny <= m_y1;
+            if (ny < 0 || ny >= m_height || xa > xb || (!inside && escaped == nullptr)) {
+                return;
+            }
+            int nx = xa;
+            while (nx <= xb) {
+                if (PixelAt(nx, ny) != m_target) {
+                    nx++;
+                    continue;
+                }
+                if (!inside) {
+                    escaped->push_back({nx, ny, dir, parentX0, parentX1});
+                } else if (!IsVisited(nx, ny)) {
+                    stack.push_back({nx, ny, dir, parentX0, parentX1});
+                }
+                nx = RunEnd(nx, ny, xb);
+            }
+        }
+
+    public:
+        SpanFiller(const sf::Uint8* pixels, int width, int height, sf::Uint32 target,
+                   std::uint64_t* visited, size_t stride, int x0, int y0, int x1, int y1)
+            : m_pixels(pixels), m_width(width), m_height(height), m_target(target), m_visited(visited),
+              m_stride(stride), m_x0(x0), m_y0(y0), m_x1(x1), m_y1(y1) {}
+
+        // Fill from every seed on the stack (emptying it) and append the new spans.
+        void Run(std::vector<FillSeed>& stack, std::vector<MathUtility::Span>& spans, std::vector<FillSeed>* escaped) {
+            while (!stack.empty()) {
+                const FillSeed seed = stack.back();
+                stack.pop_back();
+                if (IsVisited(seed.x, seed.y) || PixelAt(seed.x, seed.y) != m_target) {
+                    continue;
+                }
+                // Grow the seed into the widest span on its row.
+                int lx = seed.x;
+                while (lx > m_x0 && PixelAt(lx - 1, seed.y) == m_target) {
+                    lx--;
+                }
+                const int rx = RunEnd(seed.x, seed.y, m_x1) - 1;
+                // Mark the span as visited a whole 64-bit word at a time where possible.
+                std::uint64_t* row = m_visited + seed.y * m_stride;
+                for (int i = lx; i <= rx; ) {
+                    if ((i & 63) == 0 && i + 63 <= rx) {
+                        row[i >> 6] = ~std::uint64_t(0);
+                        i += 64;
+                    } else {
+                        row[i >> 6] |= std::uint64_t(1) << (i & 63);
+                        i++;
+                    }
+                }
+                spans.push_back({seed.y, lx, rx});
+                // Keep going away from the parent row over the whole span...
+                PushRuns(seed.y + seed.dir, lx, rx, seed.dir, lx, rx, stack, escaped);
+                // ...and turn back only where the span leaks past the parent span.
+                PushRuns(seed.y - seed.dir, lx, std::min(rx, seed.parentX0 - 1), -seed.dir, lx, rx, stack, escaped);
+                PushRuns(seed.y - seed.dir, std::max(lx, seed.parentX1 + 1), rx, -seed.dir, lx, rx, stack, escaped);
+                // A span cut off by the left or right edge of the rectangle continues next door.
+                if (escaped != nullptr && lx == m_x0 && lx > 0 && PixelAt(lx - 1, seed.y) == m_target) {
+                    escaped->push_back({lx - 1, seed.y, 1, lx, lx - 1});
+                }
+                if (escaped != nullptr && rx == m_x1 && rx + 1 < m_width && PixelAt(rx + 1, seed.y) == m_target) {
+                    escaped->push_back({rx + 1, seed.y, 1, rx + 2, rx + 1});
+                }
+            }
+        }
+};
+
+}
+
+/*! \brief  Return the spans of all pixels 4-connected to (x,y) that share its color.
+*           Span-based scanline fill: each popped seed is grown into a whole row span, then
+*           only one seed per run of matching pixels is pushed for the rows above and below.
+*           The row the seed came from is only rescanned where the new span sticks out past
+*           its parent span. An explicit stack and a 1-bit-per-pixel visited bitmap replace
+*           the old per-pixel BFS queue and unordered_set, so memory stays at (width*height)/8 bytes.
+*           Source: https://en.wikipedia.org/wiki/Flood_fill#Span_filling
+*/
+std::vector<MathUtility::Span> MathUtility::ScanlineFill(const sf::Uint8* pixels, int width, int height, int x, int y) {
+    std::vector<Span> spans;
+    if (pixels == nullptr || x < 0 || y < 0 || x >= width || y >= height) {
+        return spans;
+    }
+    const size_t stride = ((size_t)width + 63) / 64;
+    std::vector<std::uint64_t> visited(stride * height, 0);
+    sf::Uint32 target;
+    std::memcpy(&target, pixels + ((size_t)y * width + x) * 4, sizeof(target));
+
+    SpanFiller filler(pixels, width, height, target, visited.data(), stride, 0, 0, width - 1, height - 1);
+    // The first seed has no parent, so both of its neighbor rows are scanned in full.
+    std::vector<FillSeed> stack;
+    stack.push_back({x, y, 1, x + 1, x});
+    filler.Run(stack, spans, nullptr);
+    return spans;
+}
+
+/*! \brief  The same fill as ScanlineFill, spread over the thread pool for very large images.
+*           The image is cut into tiles of tileSize (rounded up to a multiple of 64) and every
+*           tile fills its own part of the region from the seeds it received. Spans that reach a
+*           tile border hand seeds to the neighbor tile, and rounds repeat until no tile receives
+*           new seeds. Each tile only writes its own words of the shared visited bitmap.
+*/
+std::vector<MathUtility::Span> MathUtility::TileFill(const sf::Uint8* pixels, int width, int height, int x, int y, ThreadPool& pool, int tileSize) {
+    std::vector<Span> spans;
+    if (pixels == nullptr || x < 0 || y < 0 || x >= width || y >= height) {
+        return spans;
+    }
+    tileSize = std::max(64, (tileSize + 63) / 64 * 64);
+    const int tilesX = (width + tileSize - 1) / tileSize;
+    const int tilesY = (height + tileSize - 1) / tileSize;
+    const size_t stride = ((size_t)width + 63) / 64;
+    std::vector<std::uint64_t> visited(stride * height, 0);
+    sf::Uint32 target;
+    std::memcpy(&target, pixels + ((size_t)y * width + x) * 4, sizeof(target));
+
+    auto tileOf = [tileSize, tilesX](const FillSeed& seed) {
+        return (seed.y / tileSize) * tilesX + seed.x / tileSize;
+    };
+    std::vector<std::vector<FillSeed>> inbox(tilesX * tilesY);
+    std::vector<std::vector<FillSeed>> outbox(tilesX * tilesY);
+    std::vector<std::vector<Span>> tileSpans(tilesX * tilesY);
+    const FillSeed first = {x, y, 1, x + 1, x};
+    inbox[tileOf(first)].push_back(first);
+
+    std::vector<int> active;
+    while (true) {
+        active.clear();
+        for (int t = 0; t < tilesX * tilesY; t++) {
+            if (!inbox[t].empty()) {
+                active.push_back(t);
+            }
+        }
+        if (active.empty()) {
+            break;
+        }
+        pool.ParallelFor((int)active.size(), [&](int k) {
+            const int t = active[k];
+            const int x0 = (t % tilesX) * tileSize;
+            const int y0 = (t / tilesX) * tileSize;
+            SpanFiller filler(pixels, width, height, target, visited.data(), stride,
+                              x0, y0, std::min(x0 + tileSize, width) - 1, std::min(y0 + tileSize, height) - 1);
+            filler.Run(inbox[t], tileSpans[t], &outbox[t]);
+        });
+        // Exchange the seeds that crossed a tile border.
+        for (int t : active) {
+            for (const FillSeed& seed : outbox[t]) {
+                inbox[tileOf(seed)].push_back(seed);
+            }
+            outbox[t].clear();
+        }
+    }
+
+    size_t total = 0;
+    for (const std::vector<Span>& part : tileSpans) {
+        total += part.size();
+    }
+    spans.reserve(total);
+    for (const std::vector<Span>& part : tileSpans) {
+        spans.insert(spans.end(), part.begin(), part.end());
+    }
+    return spans;
+}
+
+/*! \brief  Paint every span of a RGBA8 pixel buffer with one color.
+*
+*/
+void MathUtility::FillSpans(sf::Uint8* pixels, int width, const std::vector<Span>& spans, sf::Color color) {
+    const sf::Uint32 packed = PackColor(color);
+    for (const Span& span : spans) {
+        PixelKernels::FillSpan(pixels + ((size_t)span.y * width + span.x0) * 4, span.x1 - span.x0 + 1, packed);
+    }
+}
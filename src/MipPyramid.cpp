@@ -0,0 +1,286 @@
+/** 
+ *  @file   MipPyramid.cpp 
+ *  @brief  Implementation of MipPyramid.hpp
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include standard library C++ libraries.
+#include <algorithm>
+#include <cstring>
+#include <utility>
+// Project header files
+#include "MipPyramid.hpp"
+#include "PixelKernels.hpp"
+#include "TileCodec.hpp"
+
+namespace {
+
+const size_t TILE_STRIDE = (size_t)MipPyramid::TILE_SIZE * 4;
+
+// Pixel rectangle of a tile of a width x height level.
+sf::IntRect TileRectOf(int width, int height, int tile) {
+    const int tilesX = (width + MipPyramid::TILE_SIZE - 1) / MipPyramid::TILE_SIZE;
+    if (tilesX == 0) {
+        return sf::IntRect();
+    }
+    const int left = tile % tilesX * MipPyramid::TILE_SIZE;
+    const int top = tile / tilesX * MipPyramid::TILE_SIZE;
+    return sf::IntRect(left, top, std::min(MipPyramid::TILE_SIZE, width - left), std::min(MipPyramid::TILE_SIZE, height - top));
+}
+
+}
+
+/*! \brief  MipPyramid constructor. Starts the worker.
+*
+*/
+MipPyramid::MipPyramid() : m_width(0),
+    m_height(0),
+    m_document(nullptr),
+    m_document_next(0),
+    m_rebuilt_count(0),
+    m_working(false),
+    m_stopping(false) {
+    m_worker = std::thread(&MipPyramid::WorkerLoop, this);
+}
+
+/*! \brief  MipPyramid destructor. Joins the worker after the batch it is building.
+*
+*/
+MipPyramid::~MipPyramid() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_worker.join();
+}
+
+/*! \brief  Drop every level and queued tile, and make empty levels for a width x height canvas,
+*           halving it until it fits in a tile. The worker finishes its batch first, since it
+*           writes the old levels.
+*/
+void MipPyramid::Reset(int width, int height, sf::Color background, const Document* document) {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_pending.clear();
+    m_document = nullptr;
+    m_idle.wait(lock, [this] { return !m_working; });
+    m_width = std::max(width, 0);
+    m_height = std::max(height, 0);
+    m_levels.clear();
+    m_rebuilt.clear();
+    m_rebuilt_flags.clear();
+    int levelWidth = m_width;
+    int levelHeight = m_height;
+    while (levelWidth > TILE_SIZE || levelHeight > TILE_SIZE) {
+        levelWidth = (levelWidth + 1) / 2;
+        levelHeight = (levelHeight + 1) / 2;
+        m_levels.emplace_back(new VirtualCanvas);
+        m_levels.back()->Create(levelWidth, levelHeight, background);
+        m_rebuilt.emplace_back();
+        m_rebuilt_flags.emplace_back((size_t)m_levels.back()->GetTileCount(), false);
+    }
+    const int tilesX = (m_width + TILE_SIZE - 1) / TILE_SIZE;
+    const int tilesY = (m_height + TILE_SIZE - 1) / TILE_SIZE;
+    m_updated.assign((size_t)tilesX * tilesY, false);
+    m_document = document;
+    m_document_next = 0;
+    lock.unlock();
+    m_wake.notify_one();
+}
+
+/*! \brief  Read the document tiles still to go in from document from now on.
+*
+*/
+void MipPyramid::SetDocument(const Document* document) {
+    // The worker only reads the document while it holds the mutex.
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_document = document;
+}
+
+int MipPyramid::GetLevelCount() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return (int)m_levels.size();
+}
+
+sf::Vector2i MipPyramid::GetLevelSize(int level) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (level <= 0 || level > (int)m_levels.size()) {
+        return level == 0 ? sf::Vector2i(m_width, m_height) : sf::Vector2i();
+    }
+    return sf::Vector2i(m_levels[level - 1]->GetWidth(), m_levels[level - 1]->GetHeight());
+}
+
+/*! \brief  Copy level 0 tile into the queue, in place of the copy queued before if the worker
+*           has not taken it yet.
+*/
+void MipPyramid::Update(int tile, const sf::Uint8* pixels, size_t stride) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (tile < 0 || tile >= (int)m_updated.size() || m_levels.empty()) {
+            return;
+        }
+        const sf::IntRect rect = TileRectOf(m_width, m_height, tile);
+        Tile& queued = m_pending[tile];
+        queued.resize(TILE_STRIDE * TILE_SIZE);
+        for (int row = 0; row < rect.height; row++) {
+            std::memcpy(queued.data() + (size_t)row * TILE_STRIDE, pixels + (size_t)row * stride, (size_t)rect.width * 4);
+        }
+        m_updated[tile] = true;
+    }
+    m_wake.notify_one();
+}
+
+/*! \brief  Read level under area of image, like VirtualCanvas::Read().
+*
+*/
+bool MipPyramid::Read(int level, int left, int top, sf::Image& image, const sf::IntRect& area) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (level <= 0 || level > (int)m_levels.size()) {
+        return false;
+    }
+    return m_levels[level - 1]->Read(left, top, image, area);
+}
+
+/*! \brief  Swap the list of tiles of level rebuilt since the last call into tiles.
+*
+*/
+void MipPyramid::TakeRebuilt(int level, std::vector<int>& tiles) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    tiles.clear();
+    if (level <= 0 || level > (int)m_levels.size()) {
+        return;
+    }
+    tiles.swap(m_rebuilt[level - 1]);
+    for (int tile : tiles) {
+        m_rebuilt_flags[level - 1][tile] = false;
+    }
+}
+
+sf::IntRect MipPyramid::GetTileRect(int level, int tile) {
+    const sf::Vector2i size = GetLevelSize(level);
+    return TileRectOf(size.x, size.y, tile);
+}
+
+/*! \brief  Return true while tiles are queued, document tiles are left or a batch is built.
+*
+*/
+bool MipPyramid::IsBusy() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_working || HasWork();
+}
+
+/*! \brief  Wait until the worker has built everything queued.
+*
+*/
+void MipPyramid::Wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return !m_working && !HasWork(); });
+}
+
+size_t MipPyramid::GetRebuiltCount() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_rebuilt_count;
+}
+
+/*! \brief  Return true if tiles are queued or document tiles are left. The mutex must be held.
+*
+*/
+bool MipPyramid::HasWork() const {
+    return !m_levels.empty() && (!m_pending.empty() || (m_document != nullptr && m_document_next < (int)m_updated.size()));
+}
+
+/*! \brief  Take up to BATCH_SIZE queued tiles, or the next document tiles no one updated when
+*           none are queued, and rebuild their ancestors level by level. A batch only holds
+*           the tiles it changes on the level being built, so it takes the same memory for a
+*           canvas of any size.
+*/
+void MipPyramid::WorkerLoop() {
+    while (true) {
+        std::map<int, Tile> batch;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || HasWork(); });
+            if (m_stopping) {
+                return;
+            }
+            while (!m_pending.empty() && batch.size() < BATCH_SIZE) {
+                batch.emplace(m_pending.begin()->first, std::move(m_pending.begin()->second));
+                m_pending.erase(m_pending.begin());
+            }
+            // The document is mapped, so decoding a tile of it is quick enough to do here.
+            while (batch.empty() && m_document != nullptr && m_document_next < (int)m_updated.size()) {
+                for (; batch.size() < BATCH_SIZE && m_document_next < (int)m_updated.size(); m_document_next++) {
+                    const sf::Uint8* data;
+                    size_t size;
+                    if (m_updated[m_document_next] || !m_document->GetEncodedTile(m_document_next, data, size)) {
+                        continue;
+                    }
+                    const sf::IntRect rect = TileRectOf(m_width, m_height, m_document_next);
+                    Tile pixels(TILE_STRIDE * TILE_SIZE);
+                    if (TileCodec::Decode(data, size, pixels.data(), TILE_STRIDE, rect.width, rect.height)) {
+                        batch.emplace(m_document_next, std::move(pixels));
+                    }
+                }
+            }
+            m_working = true;
+        }
+        for (int level = 1; level <= (int)m_levels.size() && !batch.empty(); level++) {
+            batch = BuildLevel(level, batch);
+        }
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_working = false;
+        }
+        m_idle.notify_all();
+    }
+}
+
+/*! \brief  Box filter each child tile into its quarter of its parent tile on level, and store
+*           the parents. A child with an odd width or height is padded by repeating its last
+*           column or row, so the last parent pixel averages what there is.
+*/
+std::map<int, MipPyramid::Tile> MipPyramid::BuildLevel(int level, std::map<int, Tile>& children) {
+    VirtualCanvas& parents = *m_levels[level - 1];
+    const int childWidth = level == 1 ? m_width : m_levels[level - 2]->GetWidth();
+    const int childHeight = level == 1 ? m_height : m_levels[level - 2]->GetHeight();
+    const int childTilesX = (childWidth + TILE_SIZE - 1) / TILE_SIZE;
+    std::map<int, Tile> built;
+    for (std::pair<const int, Tile>& child : children) {
+        const int cx = child.first % childTilesX;
+        const int cy = child.first / childTilesX;
+        const int parent = cy / 2 * parents.GetTilesX() + cx / 2;
+        auto found = built.find(parent);
+        if (found == built.end()) {
+            found = built.emplace(parent, Tile(TILE_STRIDE * TILE_SIZE)).first;
+            std::lock_guard<std::mutex> lock(m_mutex);
+            parents.ReadTile(parent, found->second.data(), TILE_STRIDE);
+        }
+        const sf::IntRect rect = TileRectOf(childWidth, childHeight, child.first);
+        sf::Uint8* pixels = child.second.data();
+        if (rect.width % 2 != 0) {
+            for (int row = 0; row < rect.height; row++) {
+                sf::Uint8* last = pixels + (size_t)row * TILE_STRIDE + (size_t)(rect.width - 1) * 4;
+                std::memcpy(last + 4, last, 4);
+            }
+        }
+        if (rect.height % 2 != 0) {
+            std::memcpy(pixels + (size_t)rect.height * TILE_STRIDE, pixels + (size_t)(rect.height - 1) * TILE_STRIDE, TILE_STRIDE);
+        }
+        sf::Uint8* quarter = found->second.data() + (size_t)(cy % 2) * (TILE_SIZE / 2) * TILE_STRIDE + (size_t)(cx % 2) * (TILE_SIZE / 2) * 4;
+        for (int row = 0; row < (rect.height + 1) / 2; row++) {
+            PixelKernels::Downsample(quarter + (size_t)row * TILE_STRIDE, pixels + (size_t)row * 2 * TILE_STRIDE,
+                                     pixels + (size_t)(row * 2 + 1) * TILE_STRIDE, (rect.width + 1) / 2);
+        }
+    }
+    for (const std::pair<const int, Tile>& tile : built) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        parents.WriteTile(tile.first, tile.second.data(), TILE_STRIDE);
+        if (!m_rebuilt_flags[level - 1][tile.first]) {
+            m_rebuilt_flags[level - 1][tile.first] = true;
+            m_rebuilt[level - 1].push_back(tile.first);
+        }
+        m_rebuilt_count++;
+    }
+    return built;
+}
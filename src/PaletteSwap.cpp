@@ -0,0 +1,116 @@
+/** 
+ *  @file   PaletteSwap.cpp 
+ *  @brief  Implementation of PaletteSwap.hpp
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include standard library C++ libraries.
+#include <algorithm>
+#include <string>
+// Project header files
+#include "PaletteSwap.hpp"
+
+/*! \brief  Constructor for a PaletteSwap of color from to color to on canvas.
+*
+*/
+PaletteSwap::PaletteSwap(IndexedCanvas& canvas, sf::Image& image, sf::Color from, sf::Color to) : Command(image),
+    m_canvas(canvas),
+    m_from(from),
+    m_to(to) {
+}
+
+PaletteSwap::~PaletteSwap(){}
+
+/*! \brief  Change every palette entry of m_from to m_to, and find the tiles that show it.
+*
+*/
+bool PaletteSwap::execute() {
+    if (m_from == m_to) {
+        return false;
+    }
+    const std::vector<sf::Color>& palette = m_canvas.GetPalette();
+    for (size_t i = 0; i < palette.size(); i++) {
+        if (palette[i] == m_from) {
+            m_indices.push_back((int)i);
+        }
+    }
+    if (m_indices.empty()) {
+        return false;
+    }
+    int left = m_canvas.GetWidth();
+    int top = m_canvas.GetHeight();
+    int right = 0;
+    int bottom = 0;
+    for (int tile = 0; tile < m_canvas.GetTileCount(); tile++) {
+        for (int index : m_indices) {
+            if (m_canvas.HasIndex(tile, index)) {
+                const sf::IntRect rect = m_canvas.GetTileRect(tile);
+                left = std::min(left, rect.left);
+                top = std::min(top, rect.top);
+                right = std::max(right, rect.left + rect.width);
+                bottom = std::max(bottom, rect.top + rect.height);
+                break;
+            }
+        }
+    }
+    if (left < right) {
+        m_bounds = sf::IntRect(left, top, right - left, bottom - top);
+    }
+    return redo();
+}
+
+/*! \brief  Set the changed palette entries back to m_from.
+*
+*/
+bool PaletteSwap::undo() {
+    for (int index : m_indices) {
+        m_canvas.SetPaletteColor(index, m_from);
+    }
+    return true;
+}
+
+/*! \brief  Set the changed palette entries to m_to again.
+*
+*/
+bool PaletteSwap::redo() {
+    for (int index : m_indices) {
+        m_canvas.SetPaletteColor(index, m_to);
+    }
+    return true;
+}
+
+/*! \brief  Return the top left pixel of the recolored tiles.
+*
+*/
+std::pair<int, int> PaletteSwap::getCoords() {
+    return std::make_pair(m_bounds.left, m_bounds.top);
+}
+
+/*! \brief  Return a human readable description of the recolor.
+*
+*/
+std::string PaletteSwap::getDescription() {
+    return "Recolor of " + std::to_string(getColorCount()) + " palette colors";
+}
+
+/*! \brief  Return the number of palette entries changed.
+*
+*/
+size_t PaletteSwap::getColorCount() const {
+    return m_indices.size();
+}
+
+/*! \brief  Return the number of bytes the changed entries take.
+*
+*/
+size_t PaletteSwap::getByteSize() const {
+    return m_indices.capacity() * sizeof(int);
+}
+
+/*! \brief  Return the bounding box of the tiles that show the recolored entries.
+*
+*/
+sf::IntRect PaletteSwap::getBounds() const {
+    return m_bounds;
+}
@@ -0,0 +1,249 @@
+/** 
+ *  @file   PixelBatch.cpp 
+ *  @brief  PixelBatch implementation, many pixels of one color are a single command. 
+ *  @author Dennis Ping 
+ *  @date   2026-10-19 
+ ***********************************************/
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics/Color.hpp>
+// Include standard library C++ libraries.
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+// Project header files
+#include "PixelBatch.hpp"
+#include "Command.hpp"
+#include "MathUtility.hpp"
+#include "Varint.hpp"
+
+/*! \brief  Constructor for an empty PixelBatch command.
+*
+*/
+PixelBatch::PixelBatch(sf::Image& image, sf::Color paintbrushColor) : Command(image),
+    currColor(paintbrushColor),
+    m_bounds(0, 0, 0, 0) {
+}
+
+PixelBatch::~PixelBatch(){}
+
+/*! \brief  Add the pixel at (x,y) to the batch, unless it is outside the image.
+*
+*/
+void PixelBatch::add(int x, int y) {
+    const int width = (int)m_image.getSize().x;
+    const int height = (int)m_image.getSize().y;
+    if (x < 0 || x >= width || y < 0 || y >= height) {
+        return;
+    }
+    m_indices.push_back((sf::Uint32)y * width + x);
+}
+
+/*! \brief  Add every (x,y) pixel of coords to the batch.
+*
+*/
+void PixelBatch::add(const std::vector<std::pair<int, int>>& coords) {
+    m_indices.reserve(m_indices.size() + coords.size());
+    for (const std::pair<int, int>& coord : coords) {
+        add(coord.first, coord.second);
+    }
+}
+
+/*! \brief  Reserve room for count pixels.
+*
+*/
+void PixelBatch::reserve(size_t count) {
+    m_indices.reserve(count);
+}
+
+/*! \brief  Store the previous color of every pixel and paint them with the current color.
+*           Pixels that already have the color (including ones added twice) are dropped,
+*           so undo only touches the pixels this batch changed.
+*/
+bool PixelBatch::execute() {
+    const sf::Uint32 color = MathUtility::PackColor(currColor);
+    const sf::Uint32 width = m_image.getSize().x;
+    sf::Uint8* dst = pixels();
+    m_prevColors.clear();
+    m_prevColors.reserve(m_indices.size());
+    sf::Uint32 left = width, top = m_image.getSize().y, right = 0, bottom = 0;
+    size_t kept = 0;
+    for (size_t i = 0; i < m_indices.size(); i++) {
+        const sf::Uint32 index = m_indices[i];
+        sf::Uint8* p = dst + (size_t)index * 4;
+        sf::Uint32 prev;
+        std::memcpy(&prev, p, sizeof(prev));
+        if (prev == color) {
+            continue;
+        }
+        std::memcpy(p, &color, sizeof(color));
+        m_indices[kept++] = index;
+        m_prevColors.push_back(prev);
+        const sf::Uint32 x = index % width;
+        const sf::Uint32 y = index / width;
+        left = std::min(left, x);
+        right = std::max(right, x);
+        top = std::min(top, y);
+        bottom = std::max(bottom, y);
+    }
+    m_indices.resize(kept);
+    m_indices.shrink_to_fit();
+    if (kept == 0) {
+        return false;
+    }
+    m_bounds = sf::IntRect((int)left, (int)top, (int)(right - left + 1), (int)(bottom - top + 1));
+    return true;
+}
+
+/*! \brief  Restore the previous colors, last pixel first.
+*
+*/
+bool PixelBatch::undo() {
+    sf::Uint8* dst = pixels();
+    for (size_t i = m_indices.size(); i-- > 0; ) {
+        std::memcpy(dst + (size_t)m_indices[i] * 4, &m_prevColors[i], sizeof(sf::Uint32));
+    }
+    return true;
+}
+
+/*! \brief  Paint the pixels with the current color again.
+*
+*/
+bool PixelBatch::redo() {
+    return redoInto(m_image);
+}
+
+/*! \brief  Paint the pixels of image with the current color.
+*
+*/
+bool PixelBatch::redoInto(sf::Image& image) const {
+    const sf::Uint32 color = MathUtility::PackColor(currColor);
+    sf::Uint8* dst = MathUtility::MutablePixels(image);
+    for (const sf::Uint32 index : m_indices) {
+        std::memcpy(dst + (size_t)index * 4, &color, sizeof(color));
+    }
+    return true;
+}
+
+/*! \brief  Return the (x,y) coordinates of the first pixel, or (-1,-1) if the batch is empty.
+*
+*/
+std::pair<int, int> PixelBatch::getCoords() {
+    if (m_indices.empty()) {
+        return std::make_pair(-1, -1);
+    }
+    const sf::Uint32 width = m_image.getSize().x;
+    return std::make_pair((int)(m_indices[0] % width), (int)(m_indices[0] / width));
+}
+
+/*! \brief  Get a string representation of this PixelBatch command in the form (pixels, color).
+*
+*/
+std::string PixelBatch::getDescription() {
+    return "PixelBatch (" + std::to_string(m_indices.size()) + " pixels, " + colorName(currColor) + ")";
+}
+
+/*! \brief  Return the number of pixels in the batch.
+*
+*/
+size_t PixelBatch::getPixelCount() const {
+    return m_indices.size();
+}
+
+/*! \brief  Return the pixel indices (y * width + x) of the batch.
+*
+*/
+const std::vector<sf::Uint32>& PixelBatch::getIndices() const {
+    return m_indices;
+}
+
+/*! \brief  Return the color the batch paints with.
+*
+*/
+sf::Color PixelBatch::getColor() const {
+    return currColor;
+}
+
+/*! \brief  Return the bytes of undo data (indices and previous pixels) held in memory.
+*
+*/
+size_t PixelBatch::getByteSize() const {
+    return (m_indices.capacity() + m_prevColors.capacity()) * sizeof(sf::Uint32);
+}
+
+/*! \brief  Append the indices and the previous pixel runs to bytes and free them. A dab
+*           walks along rows and lines, so most index deltas fit in a byte or two.
+*/
+bool PixelBatch::spill(std::vector<sf::Uint8>& bytes) {
+    Varint::Put(bytes, m_indices.size());
+    std::int64_t prevIndex = 0;
+    for (const sf::Uint32 index : m_indices) {
+        Varint::PutSigned(bytes, (std::int64_t)index - prevIndex);
+        prevIndex = index;
+    }
+    // The previous pixels are usually the background, so they are written as runs.
+    size_t i = 0;
+    while (i < m_prevColors.size()) {
+        size_t count = 1;
+        while (i + count < m_prevColors.size() && m_prevColors[i + count] == m_prevColors[i]) {
+            count++;
+        }
+        Varint::PutUint32(bytes, m_prevColors[i]);
+        Varint::Put(bytes, count);
+        i += count;
+    }
+    std::vector<sf::Uint32>().swap(m_indices);
+    std::vector<sf::Uint32>().swap(m_prevColors);
+    return true;
+}
+
+/*! \brief  Read back the indices and the previous pixel runs written by spill().
+*
+*/
+bool PixelBatch::restore(const std::vector<sf::Uint8>& bytes) {
+    const sf::Uint8* p = bytes.data();
+    const sf::Uint8* end = p + bytes.size();
+    const std::int64_t pixelCount = (std::int64_t)m_image.getSize().x * m_image.getSize().y;
+    std::uint64_t count = 0;
+    if (!Varint::Get(p, end, count) || count > (std::uint64_t)(end - p)) {
+        return false;
+    }
+    std::vector<sf::Uint32> indices;
+    indices.reserve(count);
+    std::int64_t index = 0;
+    for (std::uint64_t i = 0; i < count; i++) {
+        std::int64_t delta;
+        if (!Varint::GetSigned(p, end, delta)) {
+            return false;
+        }
+        index += delta;
+        if (index < 0 || index >= pixelCount) {
+            return false;
+        }
+        indices.push_back((sf::Uint32)index);
+    }
+    std::vector<sf::Uint32> prevColors;
+    prevColors.reserve(count);
+    while (p != end) {
+        sf::Uint32 pixel;
+        std::uint64_t length;
+        if (!Varint::GetUint32(p, end, pixel) || !Varint::Get(p, end, length) || length == 0 || length > count - prevColors.size()) {
+            return false;
+        }
+        prevColors.insert(prevColors.end(), (size_t)length, pixel);
+    }
+    if (prevColors.size() != count) {
+        return false;
+    }
+    m_indices = std::move(indices);
+    m_prevColors = std::move(prevColors);
+    return true;
+}
+
+/*! \brief  Return the bounding box of the changed pixels.
+*
+*/
+sf::IntRect PixelBatch::getBounds() const {
+    return m_bounds;
+}
@@ -0,0 +1,166 @@
+/** 
+ *  @file   PixelKernels.cpp 
+ *  @brief  Scalar RGBA8 span kernels and the runtime CPU dispatch
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include standard library C++ libraries.
+#include <cstring>
+// Project header files
+#include "PixelKernels.hpp"
+#include "PixelKernelsImpl.hpp"
+
+namespace {
+
+// Exact division by 255 with rounding for values up to 255*255.
+inline int Div255(int v) {
+    v += 128;
+    return (v + (v >> 8)) >> 8;
+}
+
+// Blend (r, g, b) at alpha over one pixel.
+inline void BlendPixel(sf::Uint8* dst, int r, int g, int b, int alpha) {
+    const int inverse = 255 - alpha;
+    dst[0] = (sf::Uint8)Div255(r * alpha + dst[0] * inverse);
+    dst[1] = (sf::Uint8)Div255(g * alpha + dst[1] * inverse);
+    dst[2] = (sf::Uint8)Div255(b * alpha + dst[2] * inverse);
+    dst[3] = (sf::Uint8)(alpha + Div255(dst[3] * inverse));
+}
+
+// The kernels of one level.
+struct KernelTable {
+    void (*fillSpan)(sf::Uint8*, int, sf::Uint32);
+    void (*blendMask)(sf::Uint8*, const sf::Uint8*, int, sf::Color);
+    void (*downsample)(sf::Uint8*, const sf::Uint8*, const sf::Uint8*, int);
+};
+
+const KernelTable SCALAR_TABLE = { PixelKernelsScalar::FillSpan, PixelKernelsScalar::BlendMask, PixelKernelsScalar::Downsample };
+#ifdef PIXEL_KERNELS_X86
+const KernelTable SSE2_TABLE = { PixelKernelsSSE2::FillSpan, PixelKernelsSSE2::BlendMask, PixelKernelsSSE2::Downsample };
+const KernelTable AVX2_TABLE = { PixelKernelsAVX2::FillSpan, PixelKernelsAVX2::BlendMask, PixelKernelsAVX2::Downsample };
+#endif
+
+PixelKernels::Level DetectLevel() {
+#if defined(PIXEL_KERNELS_X86) && (defined(__GNUC__) || defined(__clang__))
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx2")) {
+        return PixelKernels::AVX2;
+    }
+    if (__builtin_cpu_supports("sse2")) {
+        return PixelKernels::SSE2;
+    }
+#elif defined(PIXEL_KERNELS_X86)
+    // Every x86-64 CPU has SSE2.
+    return PixelKernels::SSE2;
+#endif
+    return PixelKernels::SCALAR;
+}
+
+const KernelTable& TableFor(PixelKernels::Level level) {
+#ifdef PIXEL_KERNELS_X86
+    if (level == PixelKernels::AVX2) {
+        return AVX2_TABLE;
+    }
+    if (level == PixelKernels::SSE2) {
+        return SSE2_TABLE;
+    }
+#endif
+    (void)level;
+    return SCALAR_TABLE;
+}
+
+// The level in use, picked on first use.
+PixelKernels::Level& CurrentLevel() {
+    static PixelKernels::Level level = DetectLevel();
+    return level;
+}
+
+const KernelTable*& CurrentTable() {
+    static const KernelTable* table = &TableFor(CurrentLevel());
+    return table;
+}
+
+} // namespace
+
+namespace PixelKernelsScalar {
+
+void FillSpan(sf::Uint8* dst, int count, sf::Uint32 color) {
+    for (int i = 0; i < count; i++, dst += 4) {
+        std::memcpy(dst, &color, sizeof(color));
+    }
+}
+
+void BlendMask(sf::Uint8* dst, const sf::Uint8* mask, int count, sf::Color color) {
+    for (int i = 0; i < count; i++, dst += 4) {
+        BlendPixel(dst, color.r, color.g, color.b, Div255(mask[i] * color.a));
+    }
+}
+
+void Downsample(sf::Uint8* dst, const sf::Uint8* row0, const sf::Uint8* row1, int count) {
+    for (int i = 0; i < count; i++, dst += 4, row0 += 8, row1 += 8) {
+        for (int c = 0; c < 4; c++) {
+            dst[c] = (sf::Uint8)((row0[c] + row0[c + 4] + row1[c] + row1[c + 4] + 2) >> 2);
+        }
+    }
+}
+
+} // namespace PixelKernelsScalar
+
+/*! \brief  Fill count RGBA8 pixels with one packed color.
+*
+*/
+void PixelKernels::FillSpan(sf::Uint8* dst, int count, sf::Uint32 color) {
+    CurrentTable()->fillSpan(dst, count, color);
+}
+
+/*! \brief  Blend color over count RGBA8 pixels, weighted by an 8-bit mask.
+*
+*/
+void PixelKernels::BlendMask(sf::Uint8* dst, const sf::Uint8* mask, int count, sf::Color color) {
+    CurrentTable()->blendMask(dst, mask, count, color);
+}
+
+/*! \brief  Average each 2x2 block of row0 and row1 into one RGBA8 pixel of dst.
+*
+*/
+void PixelKernels::Downsample(sf::Uint8* dst, const sf::Uint8* row0, const sf::Uint8* row1, int count) {
+    CurrentTable()->downsample(dst, row0, row1, count);
+}
+
+/*! \brief  Get the best level this CPU supports.
+*
+*/
+PixelKernels::Level PixelKernels::GetBestLevel() {
+    static const Level best = DetectLevel();
+    return best;
+}
+
+/*! \brief  Get the level the kernels run at.
+*
+*/
+PixelKernels::Level PixelKernels::GetLevel() {
+    return CurrentLevel();
+}
+
+/*! \brief  Run the kernels at level, or at the best supported level below it.
+*
+*/
+void PixelKernels::SetLevel(Level level) {
+    if (level > GetBestLevel()) {
+        level = GetBestLevel();
+    }
+    CurrentLevel() = level;
+    CurrentTable() = &TableFor(level);
+}
+
+/*! \brief  Get the name of a level.
+*
+*/
+const char* PixelKernels::GetLevelName(Level level) {
+    switch (level) {
+        case AVX2: return "AVX2";
+        case SSE2: return "SSE2";
+        default: return "Scalar";
+    }
+}
@@ -0,0 +1,100 @@
+/** 
+ *  @file   PixelKernelsAVX2.cpp 
+ *  @brief  AVX2 RGBA8 span kernels, 8 pixels at a time
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Project header files
+#include "PixelKernelsImpl.hpp"
+
+#ifdef PIXEL_KERNELS_X86
+
+// Include standard library C++ libraries.
+#include <cstring>
+#include <immintrin.h>
+
+// This file is built with AVX2 enabled; PixelKernels only calls into it on CPUs that have it.
+namespace {
+
+// Exact division by 255 with rounding of each 16-bit lane, for values up to 255*255.
+inline __m256i Div255(__m256i v) {
+    v = _mm256_add_epi16(v, _mm256_set1_epi16(128));
+    return _mm256_srli_epi16(_mm256_add_epi16(v, _mm256_srli_epi16(v, 8)), 8);
+}
+
+// Blend 4 pixels of 16-bit lanes: (src * alpha + dst * (255 - alpha)) / 255.
+inline __m256i Blend(__m256i dst, __m256i src, __m256i alpha) {
+    const __m256i inverse = _mm256_sub_epi16(_mm256_set1_epi16(255), alpha);
+    return Div255(_mm256_add_epi16(_mm256_mullo_epi16(src, alpha), _mm256_mullo_epi16(dst, inverse)));
+}
+
+// Average 2x2 blocks of 8 pixels of each row into 4 pixels of 16-bit lanes, 2 in each
+// 128-bit lane: the sums stay within lanes like the unpacks.
+inline __m256i Box4(__m256i top, __m256i bottom) {
+    const __m256i zero = _mm256_setzero_si256();
+    const __m256i lo = _mm256_add_epi16(_mm256_unpacklo_epi8(top, zero), _mm256_unpacklo_epi8(bottom, zero));
+    const __m256i hi = _mm256_add_epi16(_mm256_unpackhi_epi8(top, zero), _mm256_unpackhi_epi8(bottom, zero));
+    const __m256i sums = _mm256_unpacklo_epi64(_mm256_add_epi16(lo, _mm256_srli_si256(lo, 8)), _mm256_add_epi16(hi, _mm256_srli_si256(hi, 8)));
+    return _mm256_srli_epi16(_mm256_add_epi16(sums, _mm256_set1_epi16(2)), 2);
+}
+
+} // namespace
+
+namespace PixelKernelsAVX2 {
+
+void FillSpan(sf::Uint8* dst, int count, sf::Uint32 color) {
+    const __m256i value = _mm256_set1_epi32((int)color);
+    int i = 0;
+    for (; i + 8 <= count; i += 8, dst += 32) {
+        _mm256_storeu_si256((__m256i*)dst, value);
+    }
+    PixelKernelsScalar::FillSpan(dst, count - i, color);
+}
+
+void BlendMask(sf::Uint8* dst, const sf::Uint8* mask, int count, sf::Color color) {
+    sf::Uint32 packed;
+    std::memcpy(&packed, &color, sizeof(packed));
+    // x86 is little endian, so the alpha byte is the top byte of a packed pixel.
+    const __m256i source = _mm256_set1_epi32((int)(packed | 0xFF000000u));
+    const __m256i colorAlpha = _mm256_set1_epi16(color.a);
+    const __m256i spread = _mm256_set1_epi32(0x01010101);
+    const __m256i zero = _mm256_setzero_si256();
+    int i = 0;
+    for (; i + 8 <= count; i += 8, dst += 32, mask += 8) {
+        unsigned long long m;
+        std::memcpy(&m, mask, sizeof(m));
+        // Strokes are mostly empty or fully covered pixels.
+        if (m == 0) {
+            continue;
+        }
+        if (m == ~0ULL && color.a == 255) {
+            _mm256_storeu_si256((__m256i*)dst, _mm256_set1_epi32((int)packed));
+            continue;
+        }
+        // Spread each mask byte over the 4 bytes of its pixel, then scale by the color alpha.
+        const __m256i bytes = _mm256_mullo_epi32(_mm256_cvtepu8_epi32(_mm_loadl_epi64((const __m128i*)mask)), spread);
+        const __m256i alphaLo = Div255(_mm256_mullo_epi16(_mm256_unpacklo_epi8(bytes, zero), colorAlpha));
+        const __m256i alphaHi = Div255(_mm256_mullo_epi16(_mm256_unpackhi_epi8(bytes, zero), colorAlpha));
+        const __m256i d = _mm256_loadu_si256((const __m256i*)dst);
+        const __m256i lo = Blend(_mm256_unpacklo_epi8(d, zero), _mm256_unpacklo_epi8(source, zero), alphaLo);
+        const __m256i hi = Blend(_mm256_unpackhi_epi8(d, zero), _mm256_unpackhi_epi8(source, zero), alphaHi);
+        _mm256_storeu_si256((__m256i*)dst, _mm256_packus_epi16(lo, hi));
+    }
+    PixelKernelsScalar::BlendMask(dst, mask, count - i, color);
+}
+
+void Downsample(sf::Uint8* dst, const sf::Uint8* row0, const sf::Uint8* row1, int count) {
+    int i = 0;
+    for (; i + 8 <= count; i += 8, dst += 32, row0 += 64, row1 += 64) {
+        const __m256i first = Box4(_mm256_loadu_si256((const __m256i*)row0), _mm256_loadu_si256((const __m256i*)row1));
+        const __m256i second = Box4(_mm256_loadu_si256((const __m256i*)(row0 + 32)), _mm256_loadu_si256((const __m256i*)(row1 + 32)));
+        // The pack interleaves the 64-bit halves of the lanes; put the pixels back in order.
+        _mm256_storeu_si256((__m256i*)dst, _mm256_permute4x64_epi64(_mm256_packus_epi16(first, second), 0xD8));
+    }
+    PixelKernelsSSE2::Downsample(dst, row0, row1, count - i);
+}
+
+} // namespace PixelKernelsAVX2
+
+#endif
@@ -0,0 +1,103 @@
+/** 
+ *  @file   PixelKernelsSSE2.cpp 
+ *  @brief  SSE2 RGBA8 span kernels, 4 pixels at a time
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Project header files
+#include "PixelKernelsImpl.hpp"
+
+#ifdef PIXEL_KERNELS_X86
+
+// Include standard library C++ libraries.
+#include <cstring>
+#include <emmintrin.h>
+
+namespace {
+
+// Exact division by 255 with rounding of each 16-bit lane, for values up to 255*255.
+inline __m128i Div255(__m128i v) {
+    v = _mm_add_epi16(v, _mm_set1_epi16(128));
+    return _mm_srli_epi16(_mm_add_epi16(v, _mm_srli_epi16(v, 8)), 8);
+}
+
+// Blend 2 pixels of 16-bit lanes: (src * alpha + dst * (255 - alpha)) / 255.
+inline __m128i Blend(__m128i dst, __m128i src, __m128i alpha) {
+    const __m128i inverse = _mm_sub_epi16(_mm_set1_epi16(255), alpha);
+    return Div255(_mm_add_epi16(_mm_mullo_epi16(src, alpha), _mm_mullo_epi16(dst, inverse)));
+}
+
+// Sum each pixel of 2 pixels of 16-bit lanes with the one after it, for 2 such sums: the
+// result has the first sum in its low half and the second in its high half.
+inline __m128i SumPairs(__m128i first, __m128i second) {
+    return _mm_unpacklo_epi64(_mm_add_epi16(first, _mm_srli_si128(first, 8)), _mm_add_epi16(second, _mm_srli_si128(second, 8)));
+}
+
+// Average 2x2 blocks of 4 pixels of each row into 2 pixels of 16-bit lanes.
+inline __m128i Box2(__m128i top, __m128i bottom) {
+    const __m128i zero = _mm_setzero_si128();
+    const __m128i lo = _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+    const __m128i hi = _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+    return _mm_srli_epi16(_mm_add_epi16(SumPairs(lo, hi), _mm_set1_epi16(2)), 2);
+}
+
+} // namespace
+
+namespace PixelKernelsSSE2 {
+
+void FillSpan(sf::Uint8* dst, int count, sf::Uint32 color) {
+    const __m128i value = _mm_set1_epi32((int)color);
+    int i = 0;
+    for (; i + 4 <= count; i += 4, dst += 16) {
+        _mm_storeu_si128((__m128i*)dst, value);
+    }
+    PixelKernelsScalar::FillSpan(dst, count - i, color);
+}
+
+void BlendMask(sf::Uint8* dst, const sf::Uint8* mask, int count, sf::Color color) {
+    sf::Uint32 packed;
+    std::memcpy(&packed, &color, sizeof(packed));
+    // x86 is little endian, so the alpha byte is the top byte of a packed pixel.
+    const __m128i source = _mm_set1_epi32((int)(packed | 0xFF000000u));
+    const __m128i colorAlpha = _mm_set1_epi16(color.a);
+    const __m128i zero = _mm_setzero_si128();
+    int i = 0;
+    for (; i + 4 <= count; i += 4, dst += 16, mask += 4) {
+        sf::Uint32 m;
+        std::memcpy(&m, mask, sizeof(m));
+        // Strokes are mostly empty or fully covered pixels.
+        if (m == 0) {
+            continue;
+        }
+        if (m == 0xFFFFFFFFu && color.a == 255) {
+            _mm_storeu_si128((__m128i*)dst, _mm_set1_epi32((int)packed));
+            continue;
+        }
+        // Spread each mask byte over the 4 bytes of its pixel, then scale by the color alpha.
+        __m128i spread = _mm_cvtsi32_si128((int)m);
+        spread = _mm_unpacklo_epi8(spread, spread);
+        spread = _mm_unpacklo_epi16(spread, spread);
+        const __m128i alphaLo = Div255(_mm_mullo_epi16(_mm_unpacklo_epi8(spread, zero), colorAlpha));
+        const __m128i alphaHi = Div255(_mm_mullo_epi16(_mm_unpackhi_epi8(spread, zero), colorAlpha));
+        const __m128i d = _mm_loadu_si128((const __m128i*)dst);
+        const __m128i lo = Blend(_mm_unpacklo_epi8(d, zero), _mm_unpacklo_epi8(source, zero), alphaLo);
+        const __m128i hi = Blend(_mm_unpackhi_epi8(d, zero), _mm_unpackhi_epi8(source, zero), alphaHi);
+        _mm_storeu_si128((__m128i*)dst, _mm_packus_epi16(lo, hi));
+    }
+    PixelKernelsScalar::BlendMask(dst, mask, count - i, color);
+}
+
+void Downsample(sf::Uint8* dst, const sf::Uint8* row0, const sf::Uint8* row1, int count) {
+    int i = 0;
+    for (; i + 4 <= count; i += 4, dst += 16, row0 += 32, row1 += 32) {
+        const __m128i first = Box2(_mm_loadu_si128((const __m128i*)row0), _mm_loadu_si128((const __m128i*)row1));
+        const __m128i second = Box2(_mm_loadu_si128((const __m128i*)(row0 + 16)), _mm_loadu_si128((const __m128i*)(row1 + 16)));
+        _mm_storeu_si128((__m128i*)dst, _mm_packus_epi16(first, second));
+    }
+    PixelKernelsScalar::Downsample(dst, row0, row1, count - i);
+}
+
+} // namespace PixelKernelsSSE2
+
+#endif
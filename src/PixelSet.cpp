@@ -0,0 +1,107 @@
+/** 
+ *  @file   PixelSet.cpp 
+ *  @brief  Flat open-addressing table and set of pixel coordinates
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Project header files
+#include "PixelSet.hpp"
+
+/*! \brief  Construct an empty table of 16 slots.
+*
+*/
+PixelTable::PixelTable() : m_keys(16, PixelKey::EMPTY), m_size(0), m_mask(15) {
+}
+
+size_t PixelTable::Size() const {
+    return m_size;
+}
+
+size_t PixelTable::Capacity() const {
+    return m_keys.size();
+}
+
+std::uint64_t PixelTable::KeyAt(size_t slot) const {
+    return m_keys[slot];
+}
+
+/*! \brief  Return the index of the slot holding key, or of the empty slot where it would go.
+*           Linear probing keeps the probe sequence in one or two cache lines.
+*/
+size_t PixelTable::Probe(std::uint64_t key) const {
+    size_t i = PixelKey::Mix(key) & m_mask;
+    while (m_keys[i] != key && m_keys[i] != PixelKey::EMPTY) {
+        i = (i + 1) & m_mask;
+    }
+    return i;
+}
+
+/*! \brief  Empty every slot but keep the table memory.
+*
+*/
+void PixelTable::Clear() {
+    m_keys.assign(m_keys.size(), PixelKey::EMPTY);
+    m_size = 0;
+}
+
+/*! \brief  Construct an empty set with room for 8 pixels.
+*
+*/
+PixelSet::PixelSet() {
+}
+
+size_t PixelSet::Size() const {
+    return m_table.Size();
+}
+
+bool PixelSet::Empty() const {
+    return m_table.Size() == 0;
+}
+
+/*! \brief  Make room for count pixels without rehashing.
+*
+*/
+void PixelSet::Reserve(size_t count) {
+    m_table.Reserve(count, [](size_t, size_t) {});
+}
+
+/*! \brief  Remove every pixel but keep the table memory.
+*
+*/
+void PixelSet::Clear() {
+    m_table.Clear();
+}
+
+/*! \brief  Add (x,y) and return true if it was not in the set before.
+*
+*/
+bool PixelSet::Insert(int x, int y) {
+    bool inserted;
+    m_table.Insert(PixelKey::Pack(x, y), inserted, [](size_t, size_t) {});
+    return inserted;
+}
+
+/*! \brief  Return true if (x,y) is in the set.
+*
+*/
+bool PixelSet::Contains(int x, int y) const {
+    return m_table.KeyAt(m_table.Probe(PixelKey::Pack(x, y))) != PixelKey::EMPTY;
+}
+
+/*! \brief  Remove (x,y) and return true if it was in the set.
+*
+*/
+bool PixelSet::Erase(int x, int y) {
+    return m_table.Erase(PixelKey::Pack(x, y), [](size_t, size_t) {}) != PixelTable::NO_SLOT;
+}
+
+/*! \brief  Return all pixels of the set as (x,y) pairs, in table order.
+*
+*/
+std::vector<std::pair<int, int>> PixelSet::ToVector() const {
+    std::vector<std::pair<int, int>> pixels;
+    pixels.reserve(m_table.Size());
+    ForEach([&pixels](int x, int y) { pixels.emplace_back(x, y); });
+    return pixels;
+}
@@ -0,0 +1,86 @@
+/** 
+ *  @file   SpillFile.cpp 
+ *  @brief  Implementation of SpillFile.hpp
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include standard library C++ libraries.
+#include <climits>
+#include <cstdio>
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+// Project header files
+#include "SpillFile.hpp"
+
+/*! \brief  SpillFile constructor. The file is only created when something is written.
+*
+*/
+SpillFile::SpillFile() : m_file(nullptr), m_size(0) {}
+
+/*! \brief  SpillFile destructor. Closing a tmpfile deletes it.
+*
+*/
+SpillFile::~SpillFile() {
+    if (m_file != nullptr) {
+        std::fclose(m_file);
+    }
+}
+
+/*! \brief  Append bytes at the end of the file.
+*
+*/
+bool SpillFile::Write(const std::vector<sf::Uint8>& bytes, size_t& offset) {
+    if (m_file == nullptr) {
+        m_file = std::tmpfile();
+        if (m_file == nullptr) {
+            return false;
+        }
+    }
+    if (m_size + bytes.size() > (size_t)LONG_MAX || std::fseek(m_file, (long)m_size, SEEK_SET) != 0) {
+        return false;
+    }
+    if (std::fwrite(bytes.data(), 1, bytes.size(), m_file) != bytes.size()) {
+        return false;
+    }
+    offset = m_size;
+    m_size += bytes.size();
+    return true;
+}
+
+/*! \brief  Read back a block written by Write().
+*
+*/
+bool SpillFile::Read(size_t offset, size_t size, std::vector<sf::Uint8>& bytes) {
+    if (m_file == nullptr || offset + size > m_size || std::fseek(m_file, (long)offset, SEEK_SET) != 0) {
+        return false;
+    }
+    bytes.resize(size);
+    return std::fread(bytes.data(), 1, size, m_file) == size;
+}
+
+/*! \brief  Return the number of bytes written to the file.
+*
+*/
+size_t SpillFile::GetSize() const {
+    return m_size;
+}
+
+/*! \brief  Drop every block and truncate the file to nothing, so the space of a history
+*           that is thrown away goes back to the OS while the file stays open for the next one.
+*/
+bool SpillFile::Clear() {
+    m_size = 0;
+    if (m_file == nullptr) {
+        return true;
+    }
+    std::fflush(m_file);
+#ifdef _WIN32
+    return _chsize(_fileno(m_file), 0) == 0;
+#else
+    return ftruncate(fileno(m_file), 0) == 0;
+#endif
+}
@@ -0,0 +1,165 @@
+/** 
+ *  @file   StrokeCodec.cpp 
+ *  @brief  Implementation of StrokeCodec.hpp
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include standard library C++ libraries.
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+// Project header files
+#include "StrokeCodec.hpp"
+#include "MathUtility.hpp"
+#include "Varint.hpp"
+
+namespace {
+
+std::int64_t ToFixed(float value) {
+    return (std::int64_t)std::llround(value * STROKE_FIXED_SCALE);
+}
+
+float FromFixed(std::int64_t value) {
+    return (float)value / STROKE_FIXED_SCALE;
+}
+
+}
+
+/*! \brief  StrokeWriter constructor
+*
+*/
+StrokeWriter::StrokeWriter() {
+    Reset();
+}
+
+/*! \brief  Encode a line segment. Its start point is written relative to the end of the
+*           last one, which it usually is, and its style only when it changed.
+*/
+void StrokeWriter::Write(const RoundedLine& line) {
+    const bool styleChanged = m_count == 0 || line.getColor() != m_color || line.getWidth() != m_width || line.getOwner() != m_owner;
+    Varint::Put(m_bytes, styleChanged ? 1 : 0);
+    if (styleChanged) {
+        Varint::PutUint32(m_bytes, MathUtility::PackColor(line.getColor()));
+        Varint::Put(m_bytes, (std::uint64_t)std::max<std::int64_t>(0, ToFixed(line.getWidth())));
+        Varint::PutSigned(m_bytes, line.getOwner());
+        m_color = line.getColor();
+        m_width = line.getWidth();
+        m_owner = line.getOwner();
+    }
+    const std::int64_t x0 = ToFixed(line.getStartPoint().x);
+    const std::int64_t y0 = ToFixed(line.getStartPoint().y);
+    const std::int64_t x1 = ToFixed(line.getEndPoint().x);
+    const std::int64_t y1 = ToFixed(line.getEndPoint().y);
+    Varint::PutSigned(m_bytes, x0 - m_x);
+    Varint::PutSigned(m_bytes, y0 - m_y);
+    Varint::PutSigned(m_bytes, x1 - x0);
+    Varint::PutSigned(m_bytes, y1 - y0);
+    m_x = x1;
+    m_y = y1;
+    m_count++;
+}
+
+/*! \brief  Encode the count of line segments of a stroke. Its segments are written next.
+*
+*/
+void StrokeWriter::BeginStroke(size_t count) {
+    Varint::Put(m_bytes, count);
+}
+
+const std::vector<sf::Uint8>& StrokeWriter::GetBytes() const {
+    return m_bytes;
+}
+
+size_t StrokeWriter::GetCount() const {
+    return m_count;
+}
+
+/*! \brief  Drop the encoded bytes but keep the last segment to encode the next one against.
+*           The style is written again with the next segment.
+*/
+void StrokeWriter::Clear() {
+    m_bytes.clear();
+    m_count = 0;
+}
+
+/*! \brief  Forget the encoded bytes and the last segment.
+*
+*/
+void StrokeWriter::Reset() {
+    m_bytes.clear();
+    m_count = 0;
+    m_x = 0;
+    m_y = 0;
+    m_color = sf::Color();
+    m_width = 0;
+    m_owner = 0;
+}
+
+/*! \brief  StrokeReader constructor
+*
+*/
+StrokeReader::StrokeReader(const sf::Uint8* data, size_t size) : m_position(data),
+    m_end(data + size),
+    m_count(0),
+    m_x(0),
+    m_y(0),
+    m_color(0),
+    m_width(0),
+    m_owner(0) {
+}
+
+/*! \brief  Decode the next line segment. The first one must carry its style.
+*
+*/
+bool StrokeReader::Read(std::unique_ptr<RoundedLine>& line) {
+    std::uint64_t styleChanged;
+    std::int64_t dx0, dy0, dx1, dy1;
+    if (!Varint::Get(m_position, m_end, styleChanged) || styleChanged > 1 || (m_count == 0 && styleChanged != 1)) {
+        return false;
+    }
+    if (styleChanged == 1 && (!Varint::GetUint32(m_position, m_end, m_color) || !Varint::Get(m_position, m_end, m_width)
+                              || !Varint::GetSigned(m_position, m_end, m_owner))) {
+        return false;
+    }
+    if (!Varint::GetSigned(m_position, m_end, dx0) || !Varint::GetSigned(m_position, m_end, dy0)
+        || !Varint::GetSigned(m_position, m_end, dx1) || !Varint::GetSigned(m_position, m_end, dy1)) {
+        return false;
+    }
+    const sf::Vector2f start(FromFixed(m_x + dx0), FromFixed(m_y + dy0));
+    m_x += dx0 + dx1;
+    m_y += dy0 + dy1;
+    sf::Uint8 rgba[4];
+    std::memcpy(rgba, &m_color, sizeof(rgba));
+    line.reset(new RoundedLine(start, sf::Vector2f(FromFixed(m_x), FromFixed(m_y)), FromFixed((std::int64_t)m_width),
+                               sf::Color(rgba[0], rgba[1], rgba[2], rgba[3]), (short)m_owner));
+    m_count++;
+    return true;
+}
+
+/*! \brief  Decode the count of line segments of a stroke and each of them.
+*
+*/
+bool StrokeReader::ReadStroke(std::vector<std::unique_ptr<RoundedLine>>& lines) {
+    std::uint64_t count;
+    // Every line segment takes at least 5 bytes, so a count past the bytes left is not valid.
+    if (!Varint::Get(m_position, m_end, count) || count > (std::uint64_t)(m_end - m_position)) {
+        return false;
+    }
+    for (std::uint64_t i = 0; i < count; i++) {
+        std::unique_ptr<RoundedLine> line;
+        if (!Read(line)) {
+            return false;
+        }
+        lines.push_back(std::move(line));
+    }
+    return true;
+}
+
+const sf::Uint8* StrokeReader::GetPosition() const {
+    return m_position;
+}
+
+bool StrokeReader::AtEnd() const {
+    return m_position == m_end;
+}
@@ -0,0 +1,368 @@
+/** 
+ *  @file   StrokePipeline.cpp 
+ *  @brief  Implementation of StrokePipeline.hpp
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include standard library C++ libraries.
+#include <algorithm>
+#include <cmath>
+// Project header files
+#include "StrokePipeline.hpp"
+#include "Fill.hpp"
+#include "StrokeCodec.hpp"
+
+namespace {
+
+// Polls of an empty (or full) queue before a stage goes to sleep on its doorbell.
+const int SPIN_POLLS = 64;
+// Furthest a curve segment may stray from the curve, in pixels, and the most segments
+// one curve is split into.
+const float CURVE_TOLERANCE = 0.25f;
+const int MAX_CURVE_SEGMENTS = 16;
+
+// Back off a stage that found nothing to do since bell showed seen: yield first, so a
+// busy pipeline does not wait on a lock, then sleep until the bell rings, so an idle
+// one costs no CPU.
+void Backoff(Doorbell& bell, size_t seen, int& polls) {
+    if (polls < SPIN_POLLS) {
+        polls++;
+        std::this_thread::yield();
+    } else {
+        bell.Wait(seen);
+    }
+}
+
+// A POINT item with the pen of sample and no segment yet.
+StrokeItem Pen(const StrokeItem& sample) {
+    StrokeItem item;
+    item.raster = sample.raster;
+    item.point = sample.point;
+    item.origin = sample.origin;
+    item.width = sample.width;
+    item.color = sample.color;
+    item.owner = sample.owner;
+    return item;
+}
+
+// Round point to the fixed point the journal stores segments in, so a recovered stroke
+// paints the same pixels.
+sf::Vector2f Snap(sf::Vector2f point) {
+    return sf::Vector2f(std::round(point.x * STROKE_FIXED_SCALE) / STROKE_FIXED_SCALE, std::round(point.y * STROKE_FIXED_SCALE) / STROKE_FIXED_SCALE);
+}
+
+// The point at t along the quadratic Bezier curve from start over control to end.
+sf::Vector2f Bezier(sf::Vector2f start, sf::Vector2f control, sf::Vector2f end, float t) {
+    const float s = 1 - t;
+    return Snap(s * s * start + 2 * s * t * control + t * t * end);
+}
+
+// The number of line segments that keep the curve from start over control to end within
+// CURVE_TOLERANCE. The curve strays from its chord by half as far as control does, and
+// each split quarters how far the segments stray from the curve.
+int CurveSegments(sf::Vector2f start, sf::Vector2f control, sf::Vector2f end) {
+    const sf::Vector2f chord = end - start;
+    const sf::Vector2f arm = control - start;
+    const float length = std::sqrt(chord.x * chord.x + chord.y * chord.y);
+    const float off = length > 0 ? std::abs(arm.x * chord.y - arm.y * chord.x) / length : std::sqrt(arm.x * arm.x + arm.y * arm.y);
+    if (off / 2 <= CURVE_TOLERANCE) {
+        return 1;
+    }
+    const sf::Vector2f bend = start - 2.f * control + end;
+    const float stray = std::sqrt(bend.x * bend.x + bend.y * bend.y) / 4;
+    const int segments = (int)std::ceil(std::sqrt(stray / CURVE_TOLERANCE));
+    return std::min(std::max(segments, 1), MAX_CURVE_SEGMENTS);
+}
+
+}
+
+/*! \brief  Doorbell constructor.
+*
+*/
+Doorbell::Doorbell() : m_rings(0), m_sleepers(0) {
+}
+
+/*! \brief  Return the number of rings so far.
+*
+*/
+size_t Doorbell::Peek() const {
+    return m_rings.load();
+}
+
+/*! \brief  Wake the sleepers. The ring is counted before the sleepers are, and a sleeper
+*           counts itself before it looks at the rings, so one of the two sees the other.
+*/
+void Doorbell::Ring() {
+    m_rings.fetch_add(1);
+    if (m_sleepers.load() > 0) {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_rung.notify_all();
+    }
+}
+
+/*! \brief  Sleep until the number of rings is no longer seen.
+*
+*/
+void Doorbell::Wait(size_t seen) {
+    m_sleepers.fetch_add(1);
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_rung.wait(lock, [this, seen] { return m_rings.load() != seen; });
+    }
+    m_sleepers.fetch_sub(1);
+}
+
+/*! \brief  StrokePipeline constructor. Starts the tessellation and raster workers.
+*
+*/
+StrokePipeline::StrokePipeline(sf::Image& image, ThreadPool* pool) : m_image(image),
+    m_pool(pool),
+    m_samples(QUEUE_CAPACITY),
+    m_segments(QUEUE_CAPACITY),
+    m_results(QUEUE_CAPACITY),
+    m_submitted(0),
+    m_collected(0),
+    m_dropped(0),
+    m_added(0),
+    m_gestures_sent(0),
+    m_gestures_recorded(0),
+    m_stopping(false) {
+    m_tessellator = std::thread(&StrokePipeline::TessellateLoop, this);
+    m_rasterizer = std::thread(&StrokePipeline::RasterizeLoop, this);
+}
+
+/*! \brief  StrokePipeline destructor. Stops and joins the workers.
+*
+*/
+StrokePipeline::~StrokePipeline() {
+    m_stopping = true;
+    m_tessellator_bell.Ring();
+    m_rasterizer_bell.Ring();
+    m_tessellator.join();
+    m_rasterizer.join();
+}
+
+/*! \brief  Move item into queue, backing off on bell while the next stage catches up.
+*
+*/
+bool StrokePipeline::Push(SpscQueue<StrokeItem>& queue, StrokeItem& item, Doorbell& bell) {
+    int polls = 0;
+    while (true) {
+        // Peek before looking at m_stopping, so the ring of the destructor is not missed.
+        const size_t seen = bell.Peek();
+        if (queue.TryPush(item)) {
+            return true;
+        }
+        if (m_stopping) {
+            return false;
+        }
+        Backoff(bell, seen, polls);
+    }
+}
+
+/*! \brief  Pass item on to the raster stage and wake it.
+*
+*/
+bool StrokePipeline::PushSegment(StrokeItem& item) {
+    if (!Push(m_segments, item, m_tessellator_bell)) {
+        return false;
+    }
+    m_rasterizer_bell.Ring();
+    return true;
+}
+
+/*! \brief  Stage 2: smooth each stroke through its samples. A stroke runs from the midpoint
+*           of two samples to the next midpoint along a quadratic curve bent towards the
+*           sample in between, which is split into as many line segments as it takes to
+*           look round. The curve to a sample's midpoint is drawn when the next sample
+*           comes, and the stroke is finished with a straight segment to its last sample at
+*           its end. A repeated sample would not bend the stroke, so it is dropped.
+*/
+void StrokePipeline::TessellateLoop() {
+    bool inStroke = false;
+    sf::Vector2f prev;
+    sf::Vector2f mid;
+    StrokeItem pen;
+    StrokeItem item;
+    int polls = 0;
+    while (true) {
+        const size_t seen = m_tessellator_bell.Peek();
+        if (m_stopping) {
+            return;
+        }
+        if (!m_samples.TryPop(item)) {
+            Backoff(m_tessellator_bell, seen, polls);
+            continue;
+        }
+        polls = 0;
+        if (item.kind == StrokeItem::POINT) {
+            if (inStroke && item.point == prev) {
+                m_dropped.fetch_add(1, std::memory_order_release);
+                continue;
+            }
+            if (!inStroke) {
+                // The first sample is a dot, so a click paints too.
+                item.line.reset(new RoundedLine(item.point, item.point, item.width, item.color, item.owner));
+                prev = item.point;
+                mid = item.point;
+                inStroke = true;
+            } else {
+                const sf::Vector2f next = Snap((prev + item.point) / 2.f);
+                const int segments = CurveSegments(mid, prev, next);
+                // Count the segments before the UI thread can collect them.
+                m_added.fetch_add(segments - 1, std::memory_order_release);
+                sf::Vector2f from = mid;
+                for (int i = 1; i < segments; i++) {
+                    const sf::Vector2f to = Bezier(mid, prev, next, (float)i / segments);
+                    StrokeItem segment = Pen(item);
+                    segment.line.reset(new RoundedLine(from, to, item.width, item.color, item.owner));
+                    if (!PushSegment(segment)) {
+                        return;
+                    }
+                    from = to;
+                }
+                item.line.reset(new RoundedLine(from, next, item.width, item.color, item.owner));
+                prev = item.point;
+                mid = next;
+            }
+            pen = Pen(item);
+        } else {
+            if (inStroke && mid != prev) {
+                m_added.fetch_add(1, std::memory_order_release);
+                StrokeItem segment = Pen(pen);
+                segment.line.reset(new RoundedLine(mid, prev, pen.width, pen.color, pen.owner));
+                if (!PushSegment(segment)) {
+                    return;
+                }
+            }
+            inStroke = false;
+        }
+        if (!PushSegment(item)) {
+            return;
+        }
+    }
+}
+
+/*! \brief  Stage 3: paint raster segments and fills into the image. Line mode segments are
+*           passed on as they are, since the GPU draws them.
+*/
+void StrokePipeline::RasterizeLoop() {
+    std::unique_ptr<TileDelta> delta;
+    int lineCount = 0;
+    StrokeItem item;
+    int polls = 0;
+    while (true) {
+        const size_t seen = m_rasterizer_bell.Peek();
+        if (m_stopping) {
+            return;
+        }
+        if (!m_segments.TryPop(item)) {
+            Backoff(m_rasterizer_bell, seen, polls);
+            continue;
+        }
+        polls = 0;
+        // The tessellation stage may be waiting for the room.
+        m_tessellator_bell.Ring();
+        if (item.kind == StrokeItem::POINT) {
+            lineCount++;
+            if (item.raster) {
+                if (!delta) {
+                    delta.reset(new TileDelta(m_image));
+                }
+                item.bounds = item.line->getRasterBounds();
+                item.bounds.left -= item.origin.x;
+                item.bounds.top -= item.origin.y;
+                std::lock_guard<std::mutex> lock(m_image_mutex);
+                delta->touch(item.bounds.left, item.bounds.top, item.bounds.left + item.bounds.width - 1, item.bounds.top + item.bounds.height - 1);
+                item.line->rasterize(m_image, item.origin);
+            }
+        } else if (item.kind == StrokeItem::END) {
+            item.lineCount = lineCount;
+            lineCount = 0;
+            // Compressing the delta only reads the image, which no one else writes.
+            if (delta && delta->execute()) {
+                item.bounds = delta->getBounds();
+                item.command = std::move(delta);
+            }
+            delta.reset();
+        } else {
+            // Find the region on the image with the strokes flattened over it.
+            sf::Image composite = m_image;
+            for (const RoundedLine* line : *item.boundary) {
+                line->rasterize(composite, item.origin);
+            }
+            std::unique_ptr<Fill> fill(new Fill((int)item.point.x - item.origin.x, (int)item.point.y - item.origin.y, m_image, item.color, composite));
+            fill->setThreadPool(m_pool);
+            std::lock_guard<std::mutex> lock(m_image_mutex);
+            if (fill->execute()) {
+                item.bounds = fill->getBounds();
+                item.command = std::move(fill);
+            }
+        }
+        const bool waitForRecord = (item.kind == StrokeItem::END && item.raster) || item.kind == StrokeItem::FILL;
+        if (!Push(m_results, item, m_rasterizer_bell)) {
+            return;
+        }
+        if (waitForRecord) {
+            const size_t sent = m_gestures_sent.fetch_add(1, std::memory_order_release) + 1;
+            while (true) {
+                const size_t seen = m_rasterizer_bell.Peek();
+                if (m_gestures_recorded.load(std::memory_order_acquire) >= sent) {
+                    break;
+                }
+                if (m_stopping) {
+                    return;
+                }
+                Backoff(m_rasterizer_bell, seen, polls);
+            }
+            polls = 0;
+        }
+    }
+}
+
+/*! \brief  Queue an input item for the tessellation stage.
+*
+*/
+bool StrokePipeline::Submit(StrokeItem& item) {
+    if (!m_samples.TryPush(item)) {
+        return false;
+    }
+    m_submitted++;
+    m_tessellator_bell.Ring();
+    return true;
+}
+
+/*! \brief  Take the next item the raster stage finished.
+*
+*/
+bool StrokePipeline::Collect(StrokeItem& item) {
+    if (!m_results.TryPop(item)) {
+        return false;
+    }
+    m_collected++;
+    m_rasterizer_bell.Ring();
+    return true;
+}
+
+/*! \brief  Let the raster stage go on after the UI thread recorded an END or a FILL.
+*
+*/
+void StrokePipeline::Resume() {
+    m_gestures_recorded.fetch_add(1, std::memory_order_release);
+    m_rasterizer_bell.Ring();
+}
+
+/*! \brief  Return true if every submitted item and every added segment was collected,
+*           or the item was dropped.
+*/
+bool StrokePipeline::IsIdle() const {
+    return m_collected + m_dropped.load(std::memory_order_acquire) == m_submitted + m_added.load(std::memory_order_acquire);
+}
+
+/*! \brief  Lock the image against the raster stage.
+*
+*/
+std::unique_lock<std::mutex> StrokePipeline::LockImage() {
+    return std::unique_lock<std::mutex>(m_image_mutex);
+}
@@ -0,0 +1,205 @@
+/** 
+ *  @file   SvgWriter.cpp 
+ *  @brief  Implementation of SvgWriter.hpp
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include standard library C++ libraries.
+#include <cmath>
+#include <cstdint>
+// Project header files
+#include "SvgWriter.hpp"
+
+namespace {
+
+const char HEX_DIGITS[] = "0123456789abcdef";
+
+// Append a color as #rrggbb.
+void AppendColor(std::string& out, sf::Color color) {
+    const sf::Uint8 channels[3] = {color.r, color.g, color.b};
+    out += '#';
+    for (sf::Uint8 channel : channels) {
+        out += HEX_DIGITS[channel >> 4];
+        out += HEX_DIGITS[channel & 15];
+    }
+}
+
+}
+
+/*! \brief  SvgWriter constructor. Nothing is written until Open().
+*
+*/
+SvgWriter::SvgWriter() : m_file(nullptr),
+    m_size(0),
+    m_failed(false),
+    m_in_path(false),
+    m_width(0),
+    m_owner(0) {
+}
+
+/*! \brief  SvgWriter destructor. Closes the file if Finish() was not called.
+*
+*/
+SvgWriter::~SvgWriter() {
+    if (m_file != nullptr) {
+        std::fclose(m_file);
+    }
+}
+
+/*! \brief  Create the file and write the root element, the background and the group every
+*           path is in, which holds what the paths have in common.
+*/
+bool SvgWriter::Open(const std::string& path, int width, int height, sf::Color background, sf::Vector2i origin) {
+    if (m_file != nullptr) {
+        return false;
+    }
+    m_file = std::fopen(path.c_str(), "wb");
+    if (m_file == nullptr) {
+        return false;
+    }
+    m_buffer.reserve(BUFFER_SIZE + 256);
+    m_buffer.clear();
+    m_size = 0;
+    m_failed = false;
+    m_in_path = false;
+    const std::string w = std::to_string(width);
+    const std::string h = std::to_string(height);
+    m_buffer += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<svg xmlns=\"http://www.w3.org/2000/svg\" width=\"" + w + "\" height=\"" + h
+              + "\" viewBox=\"" + std::to_string(origin.x) + " " + std::to_string(origin.y) + " " + w + " " + h
+              + "\">\n<rect x=\"" + std::to_string(origin.x) + "\" y=\"" + std::to_string(origin.y) + "\" width=\"100%\" height=\"100%\" fill=\"";
+    AppendColor(m_buffer, background);
+    m_buffer += "\"/>\n<g fill=\"none\" stroke-linecap=\"round\" stroke-linejoin=\"round\">\n";
+    return true;
+}
+
+/*! \brief  Write the line segments of a gesture. A segment that starts where the last one
+*           ended continues its polyline; any other starts a new one in the same path.
+*/
+void SvgWriter::AddGesture(const RoundedLine* const* lines, size_t count) {
+    if (m_file == nullptr) {
+        return;
+    }
+    for (size_t i = 0; i < count; i++) {
+        const RoundedLine& line = *lines[i];
+        if (m_in_path && (line.getColor() != m_color || line.getWidth() != m_width || line.getOwner() != m_owner)) {
+            EndPath();
+        }
+        const bool newPath = !m_in_path;
+        if (newPath) {
+            BeginPath(line);
+        }
+        if (newPath || line.getStartPoint() != m_end) {
+            if (!newPath) {
+                m_buffer += ' ';
+            }
+            m_buffer += 'M';
+            AppendNumber(line.getStartPoint().x);
+            m_buffer += ' ';
+            AppendNumber(line.getStartPoint().y);
+            m_buffer += 'L';
+        } else {
+            m_buffer += ' ';
+        }
+        AppendNumber(line.getEndPoint().x);
+        m_buffer += ' ';
+        AppendNumber(line.getEndPoint().y);
+        m_end = line.getEndPoint();
+        if (m_buffer.size() >= BUFFER_SIZE) {
+            Flush();
+        }
+    }
+    EndPath();
+}
+
+/*! \brief  Open a path element with the stroke color, opacity and width of line. The owner
+*           is kept as a data attribute, so the strokes of each peer can be told apart.
+*/
+void SvgWriter::BeginPath(const RoundedLine& line) {
+    m_color = line.getColor();
+    m_width = line.getWidth();
+    m_owner = line.getOwner();
+    m_buffer += "<path stroke=\"";
+    AppendColor(m_buffer, m_color);
+    if (m_color.a != 255) {
+        m_buffer += "\" stroke-opacity=\"";
+        AppendNumber(m_color.a / 255.0f);
+    }
+    m_buffer += "\" stroke-width=\"";
+    AppendNumber(m_width);
+    if (m_owner != 0) {
+        m_buffer += "\" data-owner=\"" + std::to_string(m_owner);
+    }
+    m_buffer += "\" d=\"";
+    m_in_path = true;
+}
+
+/*! \brief  Close the open path element, if any.
+*
+*/
+void SvgWriter::EndPath() {
+    if (!m_in_path) {
+        return;
+    }
+    m_buffer += "\"/>\n";
+    m_in_path = false;
+}
+
+/*! \brief  Append value rounded to two decimals, without trailing zeros. Mouse positions
+*           are whole pixels, so most numbers are plain integers.
+*/
+void SvgWriter::AppendNumber(float value) {
+    std::int64_t hundredths = (std::int64_t)std::llround(value * 100.0f);
+    if (hundredths < 0) {
+        m_buffer += '-';
+        hundredths = -hundredths;
+    }
+    char digits[24];
+    int length = 0;
+    std::int64_t whole = hundredths / 100;
+    do {
+        digits[length++] = (char)('0' + whole % 10);
+        whole /= 10;
+    } while (whole > 0);
+    while (length > 0) {
+        m_buffer += digits[--length];
+    }
+    const int fraction = (int)(hundredths % 100);
+    if (fraction != 0) {
+        m_buffer += '.';
+        m_buffer += (char)('0' + fraction / 10);
+        if (fraction % 10 != 0) {
+            m_buffer += (char)('0' + fraction % 10);
+        }
+    }
+}
+
+/*! \brief  Write the buffer to the file and empty it.
+*
+*/
+void SvgWriter::Flush() {
+    if (!m_buffer.empty() && std::fwrite(m_buffer.data(), 1, m_buffer.size(), m_file) != m_buffer.size()) {
+        m_failed = true;
+    }
+    m_size += m_buffer.size();
+    m_buffer.clear();
+}
+
+/*! \brief  Close the group and the root element, and the file.
+*
+*/
+bool SvgWriter::Finish() {
+    if (m_file == nullptr) {
+        return false;
+    }
+    EndPath();
+    m_buffer += "</g>\n</svg>\n";
+    Flush();
+    const bool closed = std::fclose(m_file) == 0;
+    m_file = nullptr;
+    return closed && !m_failed;
+}
+
+size_t SvgWriter::GetSize() const {
+    return m_size + m_buffer.size();
+}
@@ -0,0 +1,109 @@
+/** 
+ *  @file   ThreadPool.cpp 
+ *  @brief  Fixed size thread pool implementation
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include standard library C++ libraries.
+#include <algorithm>
+#include <atomic>
+#include <memory>
+// Project header files
+#include "ThreadPool.hpp"
+
+/*! \brief  Start threadCount worker threads.
+*
+*/
+ThreadPool::ThreadPool(int threadCount) : m_stopping(false) {
+    for (int i = 0; i < threadCount; i++) {
+        m_workers.emplace_back(&ThreadPool::WorkerLoop, this);
+    }
+}
+
+/*! \brief  Let the workers finish the queued jobs, then join them.
+*
+*/
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+    }
+    m_job_ready.notify_all();
+    for (std::thread& worker : m_workers) {
+        worker.join();
+    }
+}
+
+/*! \brief  Wait for jobs and run them until the pool is stopping and the queue is empty.
+*
+*/
+void ThreadPool::WorkerLoop() {
+    while (true) {
+        std::function<void()> job;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_job_ready.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+            if (m_jobs.empty()) {
+                return;
+            }
+            job = std::move(m_jobs.front());
+            m_jobs.pop();
+        }
+        job();
+    }
+}
+
+/*! \brief  Return the number of worker threads.
+*
+*/
+int ThreadPool::GetThreadCount() const {
+    return (int)m_workers.size();
+}
+
+/*! \brief  Queue a job for the next free worker.
+*
+*/
+void ThreadPool::Submit(std::function<void()> job) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.push(std::move(job));
+    }
+    m_job_ready.notify_one();
+}
+
+/*! \brief  Run job(i) for every i in [0, count) and block until all of them returned.
+*           The calling thread takes indices too, so this also finishes when every
+*           worker is busy with other jobs (or the pool has no workers at all).
+*/
+void ThreadPool::ParallelFor(int count, const std::function<void(int)>& job) {
+    if (count <= 0) {
+        return;
+    }
+    struct Batch {
+        std::atomic<int> next{0};
+        int running = 0;
+        std::mutex mutex;
+        std::condition_variable done;
+    };
+    auto batch = std::make_shared<Batch>();
+    auto drain = [batch, count, &job]() {
+        for (int i = batch->next++; i < count; i = batch->next++) {
+            job(i);
+        }
+    };
+    const int helpers = std::min(GetThreadCount(), count - 1);
+    batch->running = helpers;
+    for (int h = 0; h < helpers; h++) {
+        Submit([batch, drain]() {
+            drain();
+            std::lock_guard<std::mutex> lock(batch->mutex);
+            if (--batch->running == 0) {
+                batch->done.notify_one();
+            }
+        });
+    }
+    drain();
+    std::unique_lock<std::mutex> lock(batch->mutex);
+    batch->done.wait(lock, [&batch] { return batch->running == 0; });
+}
@@ -0,0 +1,314 @@
+/** 
+ *  @file   TileCanvas.cpp 
+ *  @brief  Implementation of TileCanvas.hpp
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include standard library C++ libraries.
+#include <algorithm>
+#include <cstring>
+#include <unordered_set>
+// Project header files
+#include "TileCanvas.hpp"
+#include "MathUtility.hpp"
+#include "PixelKernels.hpp"
+#include "TileCodec.hpp"
+
+/*! \brief  Construct an empty canvas.
+*
+*/
+TileCanvas::TileCanvas() : m_width(0), m_height(0), m_tiles_x(0), m_tiles_y(0) {}
+
+/*! \brief  Construct a width x height canvas of one color.
+*
+*/
+TileCanvas::TileCanvas(int width, int height, sf::Color color) : TileCanvas() {
+    Create(width, height, color);
+}
+
+/*! \brief  Make a width x height canvas of one color. Every tile points at the same buffer.
+*
+*/
+void TileCanvas::Create(int width, int height, sf::Color color) {
+    m_width = std::max(width, 0);
+    m_height = std::max(height, 0);
+    m_tiles_x = (m_width + TILE_SIZE - 1) / TILE_SIZE;
+    m_tiles_y = (m_height + TILE_SIZE - 1) / TILE_SIZE;
+    std::shared_ptr<Tile> solid = std::make_shared<Tile>((size_t)TILE_STRIDE * TILE_SIZE);
+    PixelKernels::FillSpan(solid->data(), TILE_SIZE * TILE_SIZE, MathUtility::PackColor(color));
+    m_tiles.assign((size_t)m_tiles_x * m_tiles_y, Slot{solid, nullptr});
+    m_dirty.assign(m_tiles.size(), false);
+}
+
+int TileCanvas::GetWidth() const {
+    return m_width;
+}
+
+int TileCanvas::GetHeight() const {
+    return m_height;
+}
+
+int TileCanvas::GetTilesX() const {
+    return m_tiles_x;
+}
+
+int TileCanvas::GetTileCount() const {
+    return (int)m_tiles.size();
+}
+
+/*! \brief  Return the index of the tile that holds pixel (x,y).
+*
+*/
+int TileCanvas::GetTileIndex(int x, int y) const {
+    return (y / TILE_SIZE) * m_tiles_x + x / TILE_SIZE;
+}
+
+int TileCanvas::GetTileWidth(int tile) const {
+    return std::min(TILE_SIZE, m_width - (tile % m_tiles_x) * TILE_SIZE);
+}
+
+int TileCanvas::GetTileHeight(int tile) const {
+    return std::min(TILE_SIZE, m_height - (tile / m_tiles_x) * TILE_SIZE);
+}
+
+/*! \brief  Return the color of pixel (x,y).
+*
+*/
+sf::Color TileCanvas::GetPixel(int x, int y) const {
+    const sf::Uint8* p = GetTile(GetTileIndex(x, y)) + (y % TILE_SIZE) * TILE_STRIDE + (x % TILE_SIZE) * 4;
+    return sf::Color(p[0], p[1], p[2], p[3]);
+}
+
+/*! \brief  Set the color of pixel (x,y), duplicating its tile first if it is shared.
+*
+*/
+void TileCanvas::SetPixel(int x, int y, sf::Color color) {
+    sf::Uint8* p = GetMutableTile(GetTileIndex(x, y)) + (y % TILE_SIZE) * TILE_STRIDE + (x % TILE_SIZE) * 4;
+    p[0] = color.r;
+    p[1] = color.g;
+    p[2] = color.b;
+    p[3] = color.a;
+}
+
+/*! \brief  Return the pixels of a tile for reading. A packed tile is unpacked into a buffer
+*           of this canvas; the other canvases sharing the packed tile keep it packed.
+*/
+const sf::Uint8* TileCanvas::GetTile(int tile) const {
+    Slot& slot = m_tiles[tile];
+    if (!slot.pixels) {
+        slot.pixels = std::make_shared<Tile>((size_t)TILE_STRIDE * TILE_SIZE);
+        Unpack(*slot.packed, slot.pixels->data(), TILE_STRIDE, GetTileWidth(tile), GetTileHeight(tile));
+        slot.packed.reset();
+    }
+    return slot.pixels->data();
+}
+
+/*! \brief  Return the pixels of a tile for writing. The copy on write happens here.
+*
+*/
+sf::Uint8* TileCanvas::GetMutableTile(int tile) {
+    GetTile(tile);
+    std::shared_ptr<Tile>& buffer = m_tiles[tile].pixels;
+    if (buffer.use_count() > 1) {
+        buffer = std::make_shared<Tile>(*buffer);
+    }
+    return buffer->data();
+}
+
+/*! \brief  Mark the tiles overlapping [x0, x1] x [y0, y1] to be copied on the next Sync().
+*
+*/
+void TileCanvas::MarkDirty(int x0, int y0, int x1, int y1) {
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, m_width - 1);
+    y1 = std::min(y1, m_height - 1);
+    for (int ty = y0 / TILE_SIZE; x0 <= x1 && ty <= y1 / TILE_SIZE; ty++) {
+        for (int tx = x0 / TILE_SIZE; tx <= x1 / TILE_SIZE; tx++) {
+            m_dirty[ty * m_tiles_x + tx] = true;
+        }
+    }
+}
+
+/*! \brief  Copy the dirty tiles from image. Tiles shared with a snapshot get a new buffer,
+*           so the snapshot keeps the old pixels.
+*/
+size_t TileCanvas::Sync(const sf::Image& image) {
+    if ((int)image.getSize().x != m_width || (int)image.getSize().y != m_height) {
+        return 0;
+    }
+    const sf::Uint8* src = image.getPixelsPtr();
+    size_t copied = 0;
+    for (int tile = 0; tile < (int)m_tiles.size(); tile++) {
+        if (!m_dirty[tile]) {
+            continue;
+        }
+        m_dirty[tile] = false;
+        const int left = (tile % m_tiles_x) * TILE_SIZE;
+        const int top = (tile / m_tiles_x) * TILE_SIZE;
+        const int width = std::min(TILE_SIZE, m_width - left);
+        const int height = std::min(TILE_SIZE, m_height - top);
+        // No need to copy the old pixels of a shared or packed tile, they are all overwritten.
+        std::shared_ptr<Tile>& buffer = m_tiles[tile].pixels;
+        if (!buffer || buffer.use_count() > 1) {
+            buffer = std::make_shared<Tile>((size_t)TILE_STRIDE * TILE_SIZE);
+        }
+        m_tiles[tile].packed.reset();
+        for (int row = 0; row < height; row++) {
+            std::memcpy(buffer->data() + (size_t)row * TILE_STRIDE, src + ((size_t)(top + row) * m_width + left) * 4, (size_t)width * 4);
+        }
+        copied++;
+    }
+    return copied;
+}
+
+/*! \brief  Move the tile buffers along with the image pixels, so a pan by whole tiles only
+*           leaves the exposed tiles to Sync(). A partial tile at the right or bottom edge
+*           does not hold a full tile, so the tile that takes it is marked dirty as well.
+*/
+void TileCanvas::Shift(int dx, int dy) {
+    const bool partialColumn = m_width % TILE_SIZE != 0;
+    const bool partialRow = m_height % TILE_SIZE != 0;
+    std::vector<Slot> tiles(m_tiles.size());
+    std::vector<bool> dirty(m_dirty.size(), true);
+    for (int ty = 0; ty < m_tiles_y; ty++) {
+        for (int tx = 0; tx < m_tiles_x; tx++) {
+            const int tile = ty * m_tiles_x + tx;
+            const int sx = tx + dx;
+            const int sy = ty + dy;
+            if (sx < 0 || sx >= m_tiles_x || sy < 0 || sy >= m_tiles_y) {
+                tiles[tile] = m_tiles[tile];
+                continue;
+            }
+            const int source = sy * m_tiles_x + sx;
+            tiles[tile] = m_tiles[source];
+            dirty[tile] = m_dirty[source] || (partialColumn && sx == m_tiles_x - 1 && tx != sx)
+                          || (partialRow && sy == m_tiles_y - 1 && ty != sy);
+        }
+    }
+    m_tiles.swap(tiles);
+    m_dirty.swap(dirty);
+}
+
+/*! \brief  Copy all pixels into image. Packed tiles are unpacked straight into it and stay
+*           packed, so restoring an old snapshot does not grow it.
+*/
+void TileCanvas::CopyToImage(sf::Image& image) const {
+    if ((int)image.getSize().x != m_width || (int)image.getSize().y != m_height) {
+        image.create(m_width, m_height);
+    }
+    sf::Uint8* dst = MathUtility::MutablePixels(image);
+    for (int tile = 0; tile < (int)m_tiles.size(); tile++) {
+        const int left = (tile % m_tiles_x) * TILE_SIZE;
+        const int top = (tile / m_tiles_x) * TILE_SIZE;
+        const int width = std::min(TILE_SIZE, m_width - left);
+        const int height = std::min(TILE_SIZE, m_height - top);
+        sf::Uint8* corner = dst + ((size_t)top * m_width + left) * 4;
+        if (!m_tiles[tile].pixels) {
+            Unpack(*m_tiles[tile].packed, corner, (size_t)m_width * 4, width, height);
+            continue;
+        }
+        for (int row = 0; row < height; row++) {
+            std::memcpy(corner + (size_t)row * m_width * 4, m_tiles[tile].pixels->data() + (size_t)row * TILE_STRIDE, (size_t)width * 4);
+        }
+    }
+}
+
+/*! \brief  Return true if both canvases point tile at the same buffer.
+*
+*/
+bool TileCanvas::SharesTile(const TileCanvas& other, int tile) const {
+    return tile < (int)m_tiles.size() && tile < (int)other.m_tiles.size() && m_tiles[tile].pixels == other.m_tiles[tile].pixels
+           && m_tiles[tile].packed == other.m_tiles[tile].packed;
+}
+
+/*! \brief  Return the number of distinct tile buffers of the canvas.
+*
+*/
+size_t TileCanvas::GetBufferCount() const {
+    std::unordered_set<const void*> buffers;
+    for (const Slot& slot : m_tiles) {
+        buffers.insert(slot.pixels ? (const void*)slot.pixels.get() : (const void*)slot.packed.get());
+    }
+    return buffers.size();
+}
+
+std::shared_ptr<const TileCanvas::Tile> TileCanvas::GetPixelBuffer(int tile) const {
+    return m_tiles[tile].pixels;
+}
+
+bool TileCanvas::IsPacked(int tile) const {
+    return !m_tiles[tile].pixels;
+}
+
+/*! \brief  Swap the pixel buffers that were packed for their packed tiles. A tile written
+*           since it was handed to the packer has another buffer by now, so it is left alone.
+*/
+size_t TileCanvas::ReplacePacked(const std::unordered_map<const Tile*, std::shared_ptr<const PackedTile>>& packed) {
+    size_t replaced = 0;
+    for (Slot& slot : m_tiles) {
+        if (!slot.pixels) {
+            continue;
+        }
+        auto found = packed.find(slot.pixels.get());
+        if (found != packed.end()) {
+            slot.packed = found->second;
+            slot.pixels.reset();
+            replaced++;
+        }
+    }
+    return replaced;
+}
+
+/*! \brief  Add up the bytes of the buffers of the canvas not counted before.
+*
+*/
+size_t TileCanvas::CountBytes(std::unordered_set<const void*>& counted) const {
+    size_t bytes = 0;
+    for (const Slot& slot : m_tiles) {
+        if (slot.pixels && counted.insert(slot.pixels.get()).second) {
+            bytes += slot.pixels->capacity();
+        }
+        else if (slot.packed && counted.insert(slot.packed.get()).second) {
+            bytes += sizeof(PackedTile) + slot.packed->encoded.capacity();
+        }
+    }
+    return bytes;
+}
+
+/*! \brief  Pack a tile: one color if every pixel of it is that color, otherwise TileCodec bytes.
+*
+*/
+std::shared_ptr<const TileCanvas::PackedTile> TileCanvas::Pack(const sf::Uint8* pixels, int width, int height) {
+    std::shared_ptr<PackedTile> packed = std::make_shared<PackedTile>();
+    std::memcpy(&packed->color, pixels, 4);
+    packed->uniform = true;
+    for (int row = 0; row < height && packed->uniform; row++) {
+        const sf::Uint8* p = pixels + (size_t)row * TILE_STRIDE;
+        for (int x = 0; x < width; x++, p += 4) {
+            if (std::memcmp(p, &packed->color, 4) != 0) {
+                packed->uniform = false;
+                break;
+            }
+        }
+    }
+    if (!packed->uniform) {
+        TileCodec::Encode(pixels, TILE_STRIDE, width, height, packed->encoded);
+        packed->encoded.shrink_to_fit();
+    }
+    return packed;
+}
+
+/*! \brief  Unpack a tile into pixels.
+*
+*/
+bool TileCanvas::Unpack(const PackedTile& packed, sf::Uint8* pixels, size_t stride, int width, int height) {
+    if (!packed.uniform) {
+        return TileCodec::Decode(packed.encoded.data(), packed.encoded.size(), pixels, stride, width, height);
+    }
+    for (int row = 0; row < height; row++) {
+        PixelKernels::FillSpan(pixels + (size_t)row * stride, width, packed.color);
+    }
+    return true;
+}
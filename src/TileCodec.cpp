@@ -0,0 +1,118 @@
+/** 
+ *  @file   TileCodec.cpp 
+ *  @brief  Implementation of TileCodec.hpp
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include standard library C++ libraries.
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+// Project header files
+#include "TileCodec.hpp"
+#include "PixelKernels.hpp"
+#include "Varint.hpp"
+
+namespace {
+
+enum TokenKind {
+    // count pixels of the one 32-bit value that follows
+    RUN = 0,
+    // count pixels that each have their own 32-bit value, which follow
+    LITERALS = 1
+};
+
+// Encode count pixels that follow each other in memory.
+void EncodeSequence(const sf::Uint32* values, int count, std::vector<sf::Uint8>& out) {
+    int i = 0;
+    while (i < count) {
+        const sf::Uint32 value = values[i];
+        int run = 1;
+        while (i + run < count && values[i + run] == value) {
+            run++;
+        }
+        if (run >= 2) {
+            Varint::Put(out, (std::uint64_t)run << 1 | RUN);
+            Varint::PutUint32(out, value);
+            i += run;
+            continue;
+        }
+        // Collect literals until the next run of 2.
+        int end = i + 1;
+        while (end < count && !(end + 1 < count && values[end + 1] == values[end])) {
+            end++;
+        }
+        Varint::Put(out, (std::uint64_t)(end - i) << 1 | LITERALS);
+        for (; i < end; i++) {
+            Varint::PutUint32(out, values[i]);
+        }
+    }
+}
+
+}
+
+/*! \brief  Run-length encode the pixels. Runs and literals may go on over the end of a row.
+*
+*/
+void TileCodec::Encode(const sf::Uint8* pixels, size_t stride, int width, int height, std::vector<sf::Uint8>& out) {
+    // Rows that are not back to back are gathered first, so runs can go on over row ends.
+    std::vector<sf::Uint32> gathered;
+    const sf::Uint32* values = reinterpret_cast<const sf::Uint32*>(pixels);
+    if (stride != (size_t)width * 4 || reinterpret_cast<std::uintptr_t>(pixels) % alignof(sf::Uint32) != 0) {
+        gathered.resize((size_t)width * height);
+        for (int row = 0; row < height; row++) {
+            std::memcpy(&gathered[(size_t)row * width], pixels + (size_t)row * stride, (size_t)width * 4);
+        }
+        values = gathered.data();
+    }
+    EncodeSequence(values, width * height, out);
+}
+
+/*! \brief  Decode the tokens row by row. Runs are written with the SIMD fill kernel.
+*
+*/
+bool TileCodec::Decode(const sf::Uint8* data, size_t size, sf::Uint8* pixels, size_t stride, int width, int height) {
+    const sf::Uint8* p = data;
+    const sf::Uint8* end = data + size;
+    int remaining = width * height;
+    int row = 0;
+    int col = 0;
+    while (remaining > 0) {
+        std::uint64_t token;
+        if (!Varint::Get(p, end, token)) {
+            return false;
+        }
+        const std::uint64_t count = token >> 1;
+        const int kind = (int)(token & 1);
+        if (count == 0 || count > (std::uint64_t)remaining) {
+            return false;
+        }
+        sf::Uint32 value = 0;
+        if (kind == RUN && !Varint::GetUint32(p, end, value)) {
+            return false;
+        }
+        if (kind == LITERALS && (std::uint64_t)(end - p) < count * 4) {
+            return false;
+        }
+        remaining -= (int)count;
+        int left = (int)count;
+        while (left > 0) {
+            const int n = std::min(left, width - col);
+            sf::Uint8* dst = pixels + (size_t)row * stride + (size_t)col * 4;
+            if (kind == RUN) {
+                PixelKernels::FillSpan(dst, n, value);
+            } else {
+                std::memcpy(dst, p, (size_t)n * 4);
+                p += (size_t)n * 4;
+            }
+            left -= n;
+            col += n;
+            if (col == width) {
+                col = 0;
+                row++;
+            }
+        }
+    }
+    return p == end;
+}
@@ -0,0 +1,334 @@
+/** 
+ *  @file   TileDelta.cpp 
+ *  @brief  TileDelta implementation, XOR + run-length encoded tile deltas.
+ *  @author Dennis Ping 
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include standard library C++ libraries.
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+// Project header files
+#include "TileDelta.hpp"
+#include "Command.hpp"
+#include "MathUtility.hpp"
+#include "Varint.hpp"
+
+namespace {
+
+// A delta is a sequence of tokens. Each starts with a varint (count << 2 | kind).
+enum TokenKind {
+    // count unchanged pixels, nothing follows
+    ZERO_RUN = 0,
+    // count pixels that all XOR with the one 32-bit value that follows
+    VALUE_RUN = 1,
+    // count pixels that each XOR with their own 32-bit value, which follow
+    LITERALS = 2
+};
+
+// Run-length encode count XOR values.
+void Encode(const sf::Uint32* values, int count, std::vector<sf::Uint8>& out) {
+    int i = 0;
+    while (i < count) {
+        const sf::Uint32 value = values[i];
+        int run = 1;
+        while (i + run < count && values[i + run] == value) {
+            run++;
+        }
+        if (value == 0 || run >= 2) {
+            Varint::Put(out, (std::uint64_t)run << 2 | (value == 0 ? ZERO_RUN : VALUE_RUN));
+            if (value != 0) {
+                Varint::PutUint32(out, value);
+            }
+            i += run;
+            continue;
+        }
+        // Collect literals until the next zero or run of 2.
+        int end = i + 1;
+        while (end < count && values[end] != 0 && !(end + 1 < count && values[end + 1] == values[end])) {
+            end++;
+        }
+        Varint::Put(out, (std::uint64_t)(end - i) << 2 | LITERALS);
+        for (; i < end; i++) {
+            Varint::PutUint32(out, values[i]);
+        }
+    }
+}
+
+// XOR count pixels at dst with value.
+void XorRun(sf::Uint8* dst, int count, sf::Uint32 value) {
+    for (int i = 0; i < count; i++, dst += 4) {
+        sf::Uint32 pixel;
+        std::memcpy(&pixel, dst, sizeof(pixel));
+        pixel ^= value;
+        std::memcpy(dst, &pixel, sizeof(pixel));
+    }
+}
+
+} // namespace
+
+/*! \brief  Constructor for a TileDelta that records changes to image.
+*
+*/
+TileDelta::TileDelta(sf::Image& image) : Command(image),
+    m_tilesX(((int)image.getSize().x + TILE_SIZE - 1) / TILE_SIZE),
+    m_tilesY(((int)image.getSize().y + TILE_SIZE - 1) / TILE_SIZE),
+    m_slots((size_t)m_tilesX * m_tilesY, -1) {
+}
+
+TileDelta::~TileDelta(){}
+
+/*! \brief  Get the pixel rectangle of a tile, clipped to the image.
+*
+*/
+void TileDelta::tileRect(int tile, int& x0, int& y0, int& width, int& height) const {
+    x0 = (tile % m_tilesX) * TILE_SIZE;
+    y0 = (tile / m_tilesX) * TILE_SIZE;
+    width = std::min(TILE_SIZE, (int)m_image.getSize().x - x0);
+    height = std::min(TILE_SIZE, (int)m_image.getSize().y - y0);
+}
+
+/*! \brief  Save a copy of every tile overlapping [x0, x1] x [y0, y1] that is not saved yet.
+*           Must be called before those pixels are written.
+*/
+void TileDelta::touch(int x0, int y0, int x1, int y1) {
+    if (m_slots.empty()) {
+        return;
+    }
+    x0 = std::max(x0, 0);
+    y0 = std::max(y0, 0);
+    x1 = std::min(x1, (int)m_image.getSize().x - 1);
+    y1 = std::min(y1, (int)m_image.getSize().y - 1);
+    if (x0 > x1 || y0 > y1) {
+        return;
+    }
+    const sf::Uint8* src = m_image.getPixelsPtr();
+    const int imageWidth = (int)m_image.getSize().x;
+    for (int ty = y0 / TILE_SIZE; ty <= y1 / TILE_SIZE; ty++) {
+        for (int tx = x0 / TILE_SIZE; tx <= x1 / TILE_SIZE; tx++) {
+            const int tile = ty * m_tilesX + tx;
+            if (m_slots[tile] >= 0) {
+                continue;
+            }
+            int left, top, width, height;
+            tileRect(tile, left, top, width, height);
+            std::vector<sf::Uint32> before((size_t)width * height);
+            for (int row = 0; row < height; row++) {
+                std::memcpy(&before[(size_t)row * width], src + ((size_t)(top + row) * imageWidth + left) * 4, (size_t)width * 4);
+            }
+            m_slots[tile] = (int)m_before.size();
+            m_before.emplace_back(tile, std::move(before));
+        }
+    }
+}
+
+/*! \brief  Stop recording: XOR each saved tile with its current pixels and keep the
+*           run-length encoded result of the tiles that changed.
+*/
+bool TileDelta::execute() {
+    const sf::Uint8* src = m_image.getPixelsPtr();
+    const int imageWidth = (int)m_image.getSize().x;
+    std::vector<sf::Uint32> delta;
+    for (auto& saved : m_before) {
+        int left, top, width, height;
+        tileRect(saved.first, left, top, width, height);
+        delta.resize(saved.second.size());
+        bool changed = false;
+        for (int row = 0; row < height; row++) {
+            const sf::Uint8* p = src + ((size_t)(top + row) * imageWidth + left) * 4;
+            const sf::Uint32* before = &saved.second[(size_t)row * width];
+            sf::Uint32* out = &delta[(size_t)row * width];
+            for (int x = 0; x < width; x++, p += 4) {
+                sf::Uint32 pixel;
+                std::memcpy(&pixel, p, sizeof(pixel));
+                out[x] = pixel ^ before[x];
+                changed |= out[x] != 0;
+            }
+        }
+        if (!changed) {
+            continue;
+        }
+        m_tiles.push_back(TileRecord{saved.first, m_data.size()});
+        Encode(delta.data(), (int)delta.size(), m_data);
+        // Grow the bounding box by the tile.
+        const int right = std::max(m_bounds.left + m_bounds.width, left + width);
+        const int bottom = std::max(m_bounds.top + m_bounds.height, top + height);
+        if (m_tiles.size() > 1) {
+            left = std::min(left, m_bounds.left);
+            top = std::min(top, m_bounds.top);
+        }
+        m_bounds = sf::IntRect(left, top, right - left, bottom - top);
+    }
+    // The uncompressed copies and the tile table are only needed while recording.
+    std::vector<std::pair<int, std::vector<sf::Uint32>>>().swap(m_before);
+    std::vector<int>().swap(m_slots);
+    m_data.shrink_to_fit();
+    m_tiles.shrink_to_fit();
+    return !m_tiles.empty();
+}
+
+/*! \brief  XOR the delta of one tile into image. Stops and returns false at a token that is
+*           truncated, empty or runs past the tile, which only corrupt spill data can hold.
+*/
+bool TileDelta::apply(const TileRecord& record, sf::Image& image) const {
+    int left, top, width, height;
+    tileRect(record.tile, left, top, width, height);
+    const int imageWidth = (int)image.getSize().x;
+    sf::Uint8* row = MathUtility::MutablePixels(image) + ((size_t)top * imageWidth + left) * 4;
+    const sf::Uint8* p = m_data.data() + record.offset;
+    const sf::Uint8* end = m_data.data() + m_data.size();
+    int col = 0;
+    int remaining = width * height;
+    while (remaining > 0) {
+        std::uint64_t token = 0;
+        if (!Varint::Get(p, end, token) || (token >> 2) == 0 || (token >> 2) > (std::uint64_t)remaining) {
+            return false;
+        }
+        int count = (int)(token >> 2);
+        const int kind = (int)(token & 3);
+        if (kind > LITERALS) {
+            return false;
+        }
+        sf::Uint32 value = 0;
+        if (kind == VALUE_RUN && !Varint::GetUint32(p, end, value)) {
+            return false;
+        }
+        if (kind == LITERALS && end - p < (std::ptrdiff_t)count * 4) {
+            return false;
+        }
+        remaining -= count;
+        // A token can wrap over several rows of the tile.
+        while (count > 0) {
+            const int n = std::min(count, width - col);
+            if (kind == VALUE_RUN) {
+                XorRun(row + (size_t)col * 4, n, value);
+            } else if (kind == LITERALS) {
+                sf::Uint8* dst = row + (size_t)col * 4;
+                for (int i = 0; i < n; i++, dst += 4, p += 4) {
+                    std::memcpy(&value, p, sizeof(value));
+                    XorRun(dst, 1, value);
+                }
+            }
+            count -= n;
+            col += n;
+            if (col == width) {
+                col = 0;
+                row += (size_t)imageWidth * 4;
+            }
+        }
+    }
+    return true;
+}
+
+/*! \brief  Turn the changed tiles back to how they were before the gesture.
+*
+*/
+bool TileDelta::undo() {
+    return redoInto(m_image);
+}
+
+/*! \brief  Turn the changed tiles back to how they were after the gesture.
+*
+*/
+bool TileDelta::redo() {
+    return undo();
+}
+
+/*! \brief  Turn the changed tiles of image, which is as it was before the gesture, into how
+*           they were after it. XOR works both ways, so undo is the same call on m_image.
+*/
+bool TileDelta::redoInto(sf::Image& image) const {
+    for (const TileRecord& record : m_tiles) {
+        if (!apply(record, image)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/*! \brief  Return the top left pixel of the first changed tile.
+*
+*/
+std::pair<int, int> TileDelta::getCoords() {
+    if (m_tiles.empty()) {
+        return std::make_pair(0, 0);
+    }
+    int left, top, width, height;
+    tileRect(m_tiles.front().tile, left, top, width, height);
+    return std::make_pair(left, top);
+}
+
+/*! \brief  Return a human readable description of the gesture.
+*
+*/
+std::string TileDelta::getDescription() {
+    return "Stroke (" + std::to_string(getTileCount()) + " tiles, " + std::to_string(getByteSize()) + " bytes)";
+}
+
+/*! \brief  Return the number of tiles the gesture changed.
+*
+*/
+size_t TileDelta::getTileCount() const {
+    return m_tiles.size();
+}
+
+/*! \brief  Return the number of bytes the recorded delta takes.
+*
+*/
+size_t TileDelta::getByteSize() const {
+    return m_data.capacity() + m_tiles.capacity() * sizeof(TileRecord);
+}
+
+/*! \brief  Append the tile table and the deltas to bytes and free them.
+*
+*/
+bool TileDelta::spill(std::vector<sf::Uint8>& bytes) {
+    Varint::Put(bytes, m_tiles.size());
+    for (size_t i = 0; i < m_tiles.size(); i++) {
+        const size_t next = i + 1 < m_tiles.size() ? m_tiles[i + 1].offset : m_data.size();
+        Varint::Put(bytes, (std::uint64_t)m_tiles[i].tile);
+        Varint::Put(bytes, next - m_tiles[i].offset);
+    }
+    bytes.insert(bytes.end(), m_data.begin(), m_data.end());
+    std::vector<TileRecord>().swap(m_tiles);
+    std::vector<sf::Uint8>().swap(m_data);
+    return true;
+}
+
+/*! \brief  Read back the tile table and the deltas written by spill().
+*
+*/
+bool TileDelta::restore(const std::vector<sf::Uint8>& bytes) {
+    const sf::Uint8* p = bytes.data();
+    const sf::Uint8* end = p + bytes.size();
+    std::uint64_t count = 0;
+    if (!Varint::Get(p, end, count) || count > (std::uint64_t)m_tilesX * m_tilesY) {
+        return false;
+    }
+    std::vector<TileRecord> tiles;
+    size_t offset = 0;
+    for (std::uint64_t i = 0; i < count; i++) {
+        std::uint64_t tile = 0;
+        std::uint64_t size = 0;
+        if (!Varint::Get(p, end, tile) || !Varint::Get(p, end, size) || tile >= (std::uint64_t)m_tilesX * m_tilesY) {
+            return false;
+        }
+        tiles.push_back(TileRecord{(int)tile, offset});
+        offset += size;
+    }
+    if ((size_t)(end - p) != offset) {
+        return false;
+    }
+    m_tiles = std::move(tiles);
+    m_data.assign(p, end);
+    return true;
+}
+
+/*! \brief  Return the bounding box of the changed tiles.
+*
+*/
+sf::IntRect TileDelta::getBounds() const {
+    return m_bounds;
+}
\ No newline at end of file
@@ -0,0 +1,131 @@
+/** 
+ *  @file   TilePacker.cpp 
+ *  @brief  Implementation of TilePacker.hpp
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include standard library C++ libraries.
+#include <algorithm>
+#include <iterator>
+// Project header files
+#include "TilePacker.hpp"
+
+namespace {
+
+// Tiles the worker takes at a time, so the UI thread can collect the first ones while the
+// rest of a large batch is still being packed.
+const size_t BATCH_SIZE = 64;
+
+}
+
+/*! \brief  TilePacker constructor. Starts the worker.
+*
+*/
+TilePacker::TilePacker() : m_packing(false),
+    m_stopping(false),
+    m_packed_count(0),
+    m_packed_bytes(0) {
+    m_worker = std::thread(&TilePacker::WorkerLoop, this);
+}
+
+/*! \brief  TilePacker destructor. The tiles not packed yet stay as they are in their canvases,
+*           so they are dropped rather than waited for.
+*/
+TilePacker::~TilePacker() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.clear();
+        m_stopping = true;
+    }
+    m_wake.notify_one();
+    m_worker.join();
+}
+
+/*! \brief  Take a batch of tiles and pack them, until the packer is destroyed.
+*
+*/
+void TilePacker::WorkerLoop() {
+    std::vector<Job> batch;
+    std::vector<Result> results;
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || !m_jobs.empty(); });
+            if (m_stopping) {
+                return;
+            }
+            const size_t count = std::min(m_jobs.size(), BATCH_SIZE);
+            batch.assign(std::make_move_iterator(m_jobs.begin()), std::make_move_iterator(m_jobs.begin() + (long)count));
+            m_jobs.erase(m_jobs.begin(), m_jobs.begin() + (long)count);
+            m_packing = true;
+        }
+        results.clear();
+        size_t bytes = 0;
+        for (Job& job : batch) {
+            Result result;
+            result.packed = TileCanvas::Pack(job.pixels->data(), job.width, job.height);
+            result.pixels = std::move(job.pixels);
+            bytes += result.packed->encoded.size();
+            results.push_back(std::move(result));
+        }
+        batch.clear();
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_results.insert(m_results.end(), std::make_move_iterator(results.begin()), std::make_move_iterator(results.end()));
+            m_packed_count += results.size();
+            m_packed_bytes += bytes;
+            m_packing = false;
+        }
+        m_idle.notify_all();
+    }
+}
+
+/*! \brief  Queue tiles for the worker.
+*
+*/
+void TilePacker::Pack(std::vector<Job>& jobs) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_jobs.insert(m_jobs.end(), std::make_move_iterator(jobs.begin()), std::make_move_iterator(jobs.end()));
+    }
+    jobs.clear();
+    m_wake.notify_one();
+}
+
+/*! \brief  Move the packed tiles to results.
+*
+*/
+size_t TilePacker::Collect(std::vector<Result>& results) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    const size_t count = m_results.size();
+    results.insert(results.end(), std::make_move_iterator(m_results.begin()), std::make_move_iterator(m_results.end()));
+    m_results.clear();
+    return count;
+}
+
+/*! \brief  Return true while tiles wait or are packed.
+*
+*/
+bool TilePacker::IsBusy() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_packing || !m_jobs.empty();
+}
+
+/*! \brief  Wait until every queued tile is packed.
+*
+*/
+void TilePacker::Wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return !m_packing && m_jobs.empty(); });
+}
+
+size_t TilePacker::GetPackedCount() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_packed_count;
+}
+
+size_t TilePacker::GetPackedBytes() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_packed_bytes;
+}
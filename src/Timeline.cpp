@@ -0,0 +1,127 @@
+/** 
+ *  @file   Timeline.cpp 
+ *  @brief  Implementation of Timeline.hpp
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include standard library C++ libraries.
+#include <utility>
+// Project header files
+#include "Timeline.hpp"
+
+/*! \brief  Timeline constructor. Starts the worker.
+*
+*/
+Timeline::Timeline() : m_result(new sf::Image),
+    m_result_gesture(0),
+    m_has_result(false),
+    m_rendering(false),
+    m_stopping(false),
+    m_cancel(false) {
+    m_worker = std::thread(&Timeline::WorkerLoop, this);
+}
+
+/*! \brief  Timeline destructor. Cancels the render in progress and joins the worker.
+*
+*/
+Timeline::~Timeline() {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_stopping = true;
+        m_cancel = true;
+    }
+    m_wake.notify_one();
+    m_worker.join();
+}
+
+/*! \brief  Take the newest request and render it, publishing the image unless a newer
+*           request came in meanwhile.
+*/
+void Timeline::WorkerLoop() {
+    std::unique_ptr<sf::Image> image(new sf::Image);
+    while (true) {
+        std::unique_ptr<Frame> frame;
+        {
+            std::unique_lock<std::mutex> lock(m_mutex);
+            m_wake.wait(lock, [this] { return m_stopping || m_pending != nullptr; });
+            if (m_stopping) {
+                return;
+            }
+            frame = std::move(m_pending);
+            m_cancel = false;
+            m_rendering = true;
+        }
+        const bool finished = Render(*frame, *image, &m_cancel);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (finished && m_pending == nullptr) {
+                std::swap(image, m_result);
+                m_result_gesture = frame->gesture;
+                m_result_strokes.swap(frame->strokes);
+                m_has_result = true;
+            }
+            m_rendering = false;
+        }
+        m_idle.notify_all();
+    }
+}
+
+/*! \brief  Replace the request that has not started, and cancel the one being rendered.
+*
+*/
+void Timeline::Request(std::unique_ptr<Frame> frame) {
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        m_pending = std::move(frame);
+        if (m_rendering) {
+            m_cancel = true;
+        }
+    }
+    m_wake.notify_one();
+}
+
+/*! \brief  Swap the newest finished image with image.
+*
+*/
+bool Timeline::Collect(std::unique_ptr<sf::Image>& image, sf::Uint32& gesture, std::vector<std::pair<size_t, size_t>>& strokes) {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (!m_has_result) {
+        return false;
+    }
+    std::swap(image, m_result);
+    gesture = m_result_gesture;
+    strokes.swap(m_result_strokes);
+    m_has_result = false;
+    return true;
+}
+
+/*! \brief  Return true while a request waits or is being rendered.
+*
+*/
+bool Timeline::IsBusy() {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_rendering || m_pending != nullptr;
+}
+
+/*! \brief  Wait until the worker has nothing left to render.
+*
+*/
+void Timeline::Wait() {
+    std::unique_lock<std::mutex> lock(m_mutex);
+    m_idle.wait(lock, [this] { return !m_rendering && m_pending == nullptr; });
+}
+
+/*! \brief  Copy the keyframe into image and redo the raster commands over it.
+*
+*/
+bool Timeline::Render(const Frame& frame, sf::Image& image, const std::atomic<bool>* cancel) {
+    frame.keyframe.CopyToImage(image);
+    for (const Command* command : frame.commands) {
+        if (cancel != nullptr && cancel->load(std::memory_order_relaxed)) {
+            return false;
+        }
+        command->redoInto(image);
+    }
+    return cancel == nullptr || !cancel->load(std::memory_order_relaxed);
+}
@@ -0,0 +1,237 @@
+/** 
+ *  @file   VirtualCanvas.cpp 
+ *  @brief  Implementation of VirtualCanvas.hpp
+ *  @author Dennis Ping
+ *  @date   2026-10-19
+ ***********************************************/
+
+// Include standard library C++ libraries.
+#include <algorithm>
+#include <cstring>
+// Project header files
+#include "VirtualCanvas.hpp"
+#include "MathUtility.hpp"
+#include "PixelKernels.hpp"
+#include "TileCodec.hpp"
+
+/*! \brief  VirtualCanvas constructor. The canvas is empty until Create().
+*
+*/
+VirtualCanvas::VirtualCanvas() : m_width(0),
+    m_height(0),
+    m_tiles_x(0),
+    m_tiles_y(0),
+    m_background(sf::Color::White),
+    m_document(nullptr),
+    m_page_bytes(0),
+    m_scratch((size_t)TILE_SIZE * TILE_SIZE * 4) {
+}
+
+/*! \brief  Make a canvas of background, or of the tiles of document, dropping every tile written.
+*
+*/
+void VirtualCanvas::Create(int width, int height, sf::Color background, Document* document) {
+    m_width = std::max(width, 0);
+    m_height = std::max(height, 0);
+    m_tiles_x = (m_width + TILE_SIZE - 1) / TILE_SIZE;
+    m_tiles_y = (m_height + TILE_SIZE - 1) / TILE_SIZE;
+    m_background = background;
+    m_document = document;
+    m_pages.clear();
+    m_page_bytes = 0;
+}
+
+int VirtualCanvas::GetWidth() const {
+    return m_width;
+}
+
+int VirtualCanvas::GetHeight() const {
+    return m_height;
+}
+
+int VirtualCanvas::GetTilesX() const {
+    return m_tiles_x;
+}
+
+int VirtualCanvas::GetTileCount() const {
+    return m_tiles_x * m_tiles_y;
+}
+
+sf::Color VirtualCanvas::GetBackground() const {
+    return m_background;
+}
+
+/*! \brief  Return the pixel rectangle of a tile, clipped to the canvas.
+*
+*/
+sf::IntRect VirtualCanvas::GetTileRect(int tile) const {
+    const int left = (tile % m_tiles_x) * TILE_SIZE;
+    const int top = (tile / m_tiles_x) * TILE_SIZE;
+    return sf::IntRect(left, top, std::min(TILE_SIZE, m_width - left), std::min(TILE_SIZE, m_height - top));
+}
+
+/*! \brief  Decode a tile from its page, from the document, or fill it with the background.
+*
+*/
+bool VirtualCanvas::ReadTile(int tile, sf::Uint8* pixels, size_t stride) {
+    const sf::IntRect rect = GetTileRect(tile);
+    auto page = m_pages.find(tile);
+    if (page != m_pages.end()) {
+        return TileCodec::Decode(page->second.data(), page->second.size(), pixels, stride, rect.width, rect.height);
+    }
+    if (m_document != nullptr) {
+        return m_document->ReadTile(tile, pixels, stride);
+    }
+    const sf::Uint32 background = MathUtility::PackColor(m_background);
+    for (int y = 0; y < rect.height; y++) {
+        PixelKernels::FillSpan(pixels + (size_t)y * stride, rect.width, background);
+    }
+    return true;
+}
+
+/*! \brief  Compress a tile into its page.
+*
+*/
+void VirtualCanvas::WriteTile(int tile, const sf::Uint8* pixels, size_t stride) {
+    const sf::IntRect rect = GetTileRect(tile);
+    m_encoded.clear();
+    TileCodec::Encode(pixels, stride, rect.width, rect.height, m_encoded);
+    std::vector<sf::Uint8>& page = m_pages[tile];
+    m_page_bytes += m_encoded.size();
+    m_page_bytes -= page.size();
+    page.assign(m_encoded.begin(), m_encoded.end());
+}
+
+/*! \brief  Keep an already compressed tile as its page, e.g. one read back from an autosave.
+*
+*/
+void VirtualCanvas::WriteEncodedTile(int tile, const sf::Uint8* data, size_t size) {
+    std::vector<sf::Uint8>& page = m_pages[tile];
+    m_page_bytes += size;
+    m_page_bytes -= page.size();
+    page.assign(data, data + size);
+}
+
+/*! \brief  Point data at the compressed page of a tile, or at its tile of the document,
+*           so a save copies it without decoding it.
+*/
+bool VirtualCanvas::GetEncodedTile(int tile, const sf::Uint8*& data, size_t& size) const {
+    auto page = m_pages.find(tile);
+    if (page != m_pages.end()) {
+        data = page->second.data();
+        size = page->second.size();
+        return true;
+    }
+    return m_document != nullptr && m_document->GetEncodedTile(tile, data, size);
+}
+
+/*! \brief  Fill area of image from the canvas, with image at (left,top) of it. Tiles wholly
+*           under area are decoded straight into image, the edge ones through a scratch tile.
+*/
+bool VirtualCanvas::Read(int left, int top, sf::Image& image, const sf::IntRect& area) {
+    const int width = (int)image.getSize().x;
+    const size_t stride = (size_t)width * 4;
+    sf::Uint8* dst = MathUtility::MutablePixels(image);
+    // The background first, for the part of area outside the canvas.
+    if (left + area.left < 0 || top + area.top < 0 || left + area.left + area.width > m_width || top + area.top + area.height > m_height) {
+        const sf::Uint32 background = MathUtility::PackColor(m_background);
+        for (int y = area.top; y < area.top + area.height; y++) {
+            PixelKernels::FillSpan(dst + (size_t)y * stride + (size_t)area.left * 4, area.width, background);
+        }
+    }
+    const int x0 = std::max(left + area.left, 0);
+    const int y0 = std::max(top + area.top, 0);
+    const int x1 = std::min(left + area.left + area.width, m_width);
+    const int y1 = std::min(top + area.top + area.height, m_height);
+    const size_t tileStride = (size_t)TILE_SIZE * 4;
+    for (int ty = y0 / TILE_SIZE; ty * TILE_SIZE < y1; ty++) {
+        for (int tx = x0 / TILE_SIZE; tx * TILE_SIZE < x1; tx++) {
+            const int tile = ty * m_tiles_x + tx;
+            const sf::IntRect rect = GetTileRect(tile);
+            const int cx0 = std::max(rect.left, x0);
+            const int cy0 = std::max(rect.top, y0);
+            const int cx1 = std::min(rect.left + rect.width, x1);
+            const int cy1 = std::min(rect.top + rect.height, y1);
+            if (cx0 == rect.left && cy0 == rect.top && cx1 == rect.left + rect.width && cy1 == rect.top + rect.height) {
+                if (!ReadTile(tile, dst + (size_t)(rect.top - top) * stride + (size_t)(rect.left - left) * 4, stride)) {
+                    return false;
+                }
+                continue;
+            }
+            if (!ReadTile(tile, m_scratch.data(), tileStride)) {
+                return false;
+            }
+            for (int y = cy0; y < cy1; y++) {
+                std::memcpy(dst + (size_t)(y - top) * stride + (size_t)(cx0 - left) * 4,
+                            m_scratch.data() + (size_t)(y - rect.top) * tileStride + (size_t)(cx0 - rect.left) * 4, (size_t)(cx1 - cx0) * 4);
+            }
+        }
+    }
+    return true;
+}
+
+/*! \brief  Write back the tiles of the canvas that overlap areas of image, with image at
+*           (left,top) of it. A tile wholly under image is compressed straight from it; one
+*           on the edge of image is read first, so its part outside image is kept.
+*/
+bool VirtualCanvas::Write(int left, int top, const sf::Image& image, const std::vector<sf::IntRect>& areas) {
+    const int width = (int)image.getSize().x;
+    const int height = (int)image.getSize().y;
+    const size_t stride = (size_t)width * 4;
+    const sf::Uint8* src = image.getPixelsPtr();
+    // The tiles to write, each once.
+    std::vector<int> tiles;
+    for (const sf::IntRect& area : areas) {
+        const int x0 = std::max(left + std::max(area.left, 0), 0);
+        const int y0 = std::max(top + std::max(area.top, 0), 0);
+        const int x1 = std::min(left + std::min(area.left + area.width, width), m_width);
+        const int y1 = std::min(top + std::min(area.top + area.height, height), m_height);
+        for (int ty = y0 / TILE_SIZE; ty * TILE_SIZE < y1; ty++) {
+            for (int tx = x0 / TILE_SIZE; tx * TILE_SIZE < x1; tx++) {
+                tiles.push_back(ty * m_tiles_x + tx);
+            }
+        }
+    }
+    std::sort(tiles.begin(), tiles.end());
+    tiles.erase(std::unique(tiles.begin(), tiles.end()), tiles.end());
+
+    const size_t tileStride = (size_t)TILE_SIZE * 4;
+    for (const int tile : tiles) {
+        const sf::IntRect rect = GetTileRect(tile);
+        const int cx0 = std::max(rect.left, left);
+        const int cy0 = std::max(rect.top, top);
+        const int cx1 = std::min(rect.left + rect.width, left + width);
+        const int cy1 = std::min(rect.top + rect.height, top + height);
+        if (cx0 == rect.left && cy0 == rect.top && cx1 == rect.left + rect.width && cy1 == rect.top + rect.height) {
+            WriteTile(tile, src + (size_t)(rect.top - top) * stride + (size_t)(rect.left - left) * 4, stride);
+            continue;
+        }
+        if (!ReadTile(tile, m_scratch.data(), tileStride)) {
+            return false;
+        }
+        for (int y = cy0; y < cy1; y++) {
+            std::memcpy(m_scratch.data() + (size_t)(y - rect.top) * tileStride + (size_t)(cx0 - rect.left) * 4,
+                        src + (size_t)(y - top) * stride + (size_t)(cx0 - left) * 4, (size_t)(cx1 - cx0) * 4);
+        }
+        WriteTile(tile, m_scratch.data(), tileStride);
+    }
+    return true;
+}
+
+/*! \brief  List the tiles that have a page.
+*
+*/
+void VirtualCanvas::GetPageTiles(std::vector<int>& tiles) const {
+    tiles.clear();
+    for (const std::pair<const int, std::vector<sf::Uint8>>& page : m_pages) {
+        tiles.push_back(page.first);
+    }
+}
+
+size_t VirtualCanvas::GetPageCount() const {
+    return m_pages.size();
+}
+
+size_t VirtualCanvas::GetPageBytes() const {
+    return m_page_bytes;
+}
@@ -1,206 +1,333 @@
-/** 
- *  @file   main.cpp 
- *  @brief  Entry point into the program.
- *  @author Mike and Dennis Ping
- *  @date   2021-11-13
- ***********************************************/
-
-// Compile: Use a CMakeLists.txt or you can try compiling with:
-// g++ -std=c++17 ./src/*.cpp -I./include/ -o App -lsfml-graphics -lsfml-window -lsfml-system
-
-// Include our Third-Party SFML header
-#include <SFML/Graphics.hpp>
-#include <SFML/Graphics/Image.hpp>
-#include <SFML/Graphics/Texture.hpp>
-#include <SFML/Graphics/Sprite.hpp>
-#include <SFML/Window.hpp>
-#include <catch_amalgamated.hpp>
-// Include standard library C++ libraries.
-#include <iostream>
-#include <string>
-// Project header files
-#include "App.hpp"
-// #include "Command.hpp"
-// #include "Draw.hpp"
-#include "MathUtility.hpp"
-#include "RoundedLine.hpp"
-
-
-/*! \brief 	Initializes the App and sets up the main
-*		    rendering window (i.e. our canvas.)
-*		
-*/
-void initialization(void){
-    std::cout << "\nStarting the App" << std::endl;
-    std::string instructions = "How to use:\n"
-                                "\tPress numbers [1, 2, 3, 4, 5, 6, 7, 8] to change paintbrush color\n"
-                                "\tPress Z to undo\n"
-                                "\tPress Y to redo\n"
-                                "\tPress , to decrease paintbrush size\n"
-                                "\tPress . to increase paintbrush size\n";
-    std::cout << instructions << std::endl;
-}
-
-/*! \brief 	The update window function.
-*		
-*/
-void update(App& myApp){
-    // Update our canvas
-    sf::Event event;
-    while(myApp.GetWindow().pollEvent(event)){
-        sf::Vector2i mousePos = sf::Mouse::getPosition(myApp.GetWindow());
-        int mouseX = mousePos.x;
-        int mouseY = mousePos.y;
-        myApp.SetCursorPosition(mouseX, mouseY);
-
-        if(event.type == sf::Event::KeyReleased) {
-            // Undo command
-            if(event.key.code == sf::Keyboard::Z) {
-                myApp.UndoCommand();
-            }
-            // Redo command
-            if(event.key.code == sf::Keyboard::Y) {
-                myApp.RedoCommand();
-            }
-            // Check for change paintbrush color keypress
-            if(myApp.color_codes.find(event.key.code) != myApp.color_codes.end()) {
-                myApp.SetPaintbrushColor(event.key.code);
-                myApp.GenerateCursor(myApp.GetPaintbrushRadius(), myApp.GetPaintbrushColor());
-            }
-            // Check for change paintbrush size keypress
-            if(event.key.code == sf::Keyboard::Comma) {
-                if (myApp.GetPaintbrushRadius() > 3) {
-                    myApp.SetPaintbrushRadius(myApp.GetPaintbrushRadius() - 2);
-                    int& radius = myApp.GetPaintbrushRadius();
-                    myApp.GenerateCircleTemplate(radius);
-                    myApp.GenerateCursor(radius, myApp.GetPaintbrushColor());
-                    myApp.SetCursorPosition(mouseX, mouseY);
-                    std::cout << "Paintbrush radius is now: " << radius << std::endl;
-                }
-            }
-            if(event.key.code == sf::Keyboard::Period) {
-                if (myApp.GetPaintbrushRadius() < 15) {
-                    myApp.SetPaintbrushRadius(myApp.GetPaintbrushRadius() + 2);
-                    int& radius = myApp.GetPaintbrushRadius();
-                    myApp.GenerateCircleTemplate(radius);
-                    myApp.GenerateCursor(radius, myApp.GetPaintbrushColor());
-                    myApp.SetCursorPosition(mouseX, mouseY);
-                    std::cout << "Paintbrush radius is now: " << radius << std::endl;
-                }
-            }
-
-        }
-        // Close the window when you press the 'close' button.
-        if(event.type == sf::Event::Closed) {
-            myApp.GetWindow().close();
-            exit(EXIT_SUCCESS);
-        }
-        // When the mouse is released, push the count to the m_undo_count stack. Reset the count.
-        if(event.type == sf::Event::MouseButtonReleased) {
-            if (myApp.cmdCount == 0) {
-                break;
-            }
-            myApp.m_undo_count.push(myApp.cmdCount);
-            std::cout << "Pushed " << myApp.cmdCount << " to the undo stack" << std::endl;
-            myApp.cmdCount = 0;
-            myApp.m_prev_point = nullptr;
-        }
-        // Draw with the paintbrush
-        if(sf::Mouse::isButtonPressed(sf::Mouse::Left)) {
-            
-            if ((mouseX < 0) || (mouseY < 0) || (mouseX >= (int)myApp.GetWindow().getSize().x || (mouseY > (int)myApp.GetWindow().getSize().y))) {
-                return;
-            }
-            // Use a dummy port for now because we're not on a network
-            short port = 1234;
-            // If you have already started drawing...
-            if (myApp.m_prev_point != nullptr) {
-                std::unique_ptr<RoundedLine> line (new RoundedLine(*myApp.m_prev_point, sf::Vector2f(mouseX, mouseY), myApp.GetPaintbrushRadius()*2, myApp.GetPaintbrushColor(), port));
-                myApp.m_prev_point = new sf::Vector2f(mouseX, mouseY);
-                myApp.AddCommand(std::move(line));
-                
-            } else {
-                //Set the m_prev_pointer to the current mouse position.
-                std::unique_ptr<RoundedLine> line (new RoundedLine(sf::Vector2f(mouseX, mouseY), sf::Vector2f(mouseX, mouseY), myApp.GetPaintbrushRadius()*2, myApp.GetPaintbrushColor(), port));
-                myApp.m_prev_point = new sf::Vector2f(mouseX, mouseY);
-                myApp.AddCommand(std::move(line));
-            }
-            myApp.cmdCount += myApp.ExecuteCommand();
-
-            // Create a vector of all the points to be drawn.
-            //std::vector<std::pair<int, int>> allCoords = myApp.UseCircleTemplate(mouseX, mouseY);
-            //myApp.prevCmds.resize(allCoords.size());
-
-            // For each coordinate in allCoords, make a new Draw drawCmd pointer.
-            // for (int i=0; i < (int)allCoords.size(); i++) {
-            //     std::unique_ptr<Command> drawCmd1 (new Draw(allCoords[i].first, allCoords[i].second, myApp.GetImage(), myApp.GetPaintbrushColor()));
-            //     std::unique_ptr<Command> drawCmd2 (new Draw(allCoords[i].first, allCoords[i].second, myApp.GetImage(), myApp.GetPaintbrushColor()));
-            //     // If we have already started drawing...
-            //     if (myApp.prevCmds[i] != nullptr) {
-            //         // Use the EFLA algorithm to get a vector of intermediate pixels between prevCmd and drawCmd.
-            //         std::vector<std::pair<int, int>> pixels = MathUtility::ExtremelyFastLineAlgo(myApp.prevCmds[i]->getCoords().first, myApp.prevCmds[i]->getCoords().second, drawCmd1->getCoords().first, drawCmd1->getCoords().second);
-            //         // Iterate through the pixels and construct a new draw command for each pixel.
-            //         for (auto& pixel : pixels) {
-            //             std::unique_ptr<Command> intermDraw1(new Draw(pixel.first, pixel.second, myApp.GetImage(), myApp.GetPaintbrushColor()));
-            //             std::unique_ptr<Command> intermDraw2(new Draw(pixel.first, pixel.second, myApp.GetImage(), myApp.GetPaintbrushColor()));
-            //             // Remember to update the prevCmd with the new intermediateCmd.
-            //             myApp.prevCmds[i] = std::move(intermDraw1);
-            //             myApp.AddCommand(std::move(intermDraw2));
-            //         }
-            //     }
-            //     // Else if this is the first command, just re-assign the pointer to drawCmd and do nothing.
-            //     else {
-            //         myApp.prevCmds[i] = std::move(drawCmd1);
-            //         myApp.AddCommand(std::move(drawCmd2));
-            //     }
-            //     myApp.cmdCount += myApp.ExecuteCommand();
-            // }
-        }
-    }
-
-    // Check for ESC key press
-    if(sf::Keyboard::isKeyPressed(sf::Keyboard::Escape)){
-        myApp.GetWindow().close();
-        exit(EXIT_SUCCESS);
-    }
-}
-
-
-/*! \brief 	The draw call 
-*		
-*/
-void draw(App& myApp){
-    // Make the clock variable static so we don't lose it.
-    static sf::Clock clock;
-
-    // Load the modified pixels into our texture every 1/60 of a second.
-    // So every 1 frame if your monitor's refresh rate is 60 hz.
-    if(clock.getElapsedTime().asSeconds() > 0.0111f) {
-        // myApp.GetTexture().loadFromImage(myApp.GetImage());
-        // myApp.GetRenderSprite().setTexture(myApp.GetRenderTexture().getTexture());
-        //myApp.cmdCount += myApp.ExecuteCommand();
-        clock.restart();
-    }
-}
-
- 
-/*! \brief 	The entry point into our program.
-*		
-*/
-int main(){
-    // Call any setup function
-    // Passing a function pointer into the 'init' function.
-    // of our application.
-    App myApp = App();
-    myApp.Init(&initialization);
-    // Setup your keyboard
-    myApp.UpdateCallback(&update);
-    // Setup the Draw Function
-    myApp.DrawCallback(&draw);
-    // Call the main loop function
-    myApp.Loop(myApp);
-    // Destroy our app
-    myApp.Destroy();
-
-    return 0;
+/** 
+ *  @file   main.cpp 
+ *  @brief  Entry point into the program.
+ *  @author Mike and Dennis Ping
+ *  @date   2021-11-13
+ ***********************************************/
+
+// Compile: Use a CMakeLists.txt or you can try compiling with:
+// g++ -std=c++17 ./src/*.cpp -I./include/ -o App -lsfml-graphics -lsfml-window -lsfml-system
+
+// Include our Third-Party SFML header
+#include <SFML/Graphics.hpp>
+#include <SFML/Graphics/Image.hpp>
+#include <SFML/Graphics/Texture.hpp>
+#include <SFML/Graphics/Sprite.hpp>
+#include <SFML/Window.hpp>
+#include <catch_amalgamated.hpp>
+// Include standard library C++ libraries.
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+// Project header files
+#include "App.hpp"
+// #include "Command.hpp"
+// #include "Draw.hpp"
+#include "MathUtility.hpp"
+#include "RoundedLine.hpp"
+
+
+/*! \brief 	Initializes the App and sets up the main
+*		    rendering window (i.e. our canvas.)
+*		
+*/
+void initialization(void){
+    std::cout << "\nStarting the App" << std::endl;
+    std::string instructions = "How to use:\n"
+                                "\tPress numbers [1, 2, 3, 4, 5, 6, 7, 8] to change paintbrush color\n"
+                                "\tPress Z to undo\n"
+                                "\tPress Y to redo\n"
+                                "\tPress N to switch to the next branch of the undo history\n"
+                                "\tPress T to open the history timeline, move the mouse across the window to scrub\n"
+                                "\t  through it and press Enter to go back to the gesture shown\n"
+                                "\tPress S to save the canvas to minipaint.png, or J to minipaint.jpg\n"
+                                "\tPress B to switch between the paintbrush and the bucket fill\n"
+                                "\tPress R to switch between line strokes and raster strokes\n"
+                                "\tPress I to switch indexed mode, a canvas of 4 bit palette indices, on and off\n"
+                                "\tPress C in indexed mode to paint every pixel of the color under the mouse with the paintbrush color\n"
+                                "\tPress the arrow keys to pan over the canvas and scroll the mouse wheel to zoom in and out\n"
+                                "\tPress , to decrease paintbrush size\n"
+                                "\tPress . to increase paintbrush size\n";
+    std::cout << instructions << std::endl;
+}
+
+/*! \brief 	The update window function.
+*		
+*/
+void update(App& myApp){
+    // Update our canvas
+    sf::Event event;
+    while(myApp.GetWindow().pollEvent(event)){
+        sf::Vector2i mousePos = sf::Mouse::getPosition(myApp.GetWindow());
+        int mouseX = mousePos.x;
+        int mouseY = mousePos.y;
+        myApp.SetCursorPosition(mouseX, mouseY);
+
+        // In timeline mode the mouse scrubs through the history instead of painting: the
+        // left edge of the window is the empty canvas and the right edge the last gesture.
+        if (myApp.GetTimelineMode()) {
+            if (event.type == sf::Event::MouseMoved) {
+                const long long steps = (long long)myApp.GetGestureCount() + 1;
+                const long long step = std::min(steps - 1, std::max(0LL, (long long)event.mouseMove.x * steps / (long long)myApp.GetWindow().getSize().x));
+                myApp.ScrubTo(step == 0 ? App::NO_GESTURE : (sf::Uint32)(step - 1));
+            }
+            if (event.type == sf::Event::KeyReleased && event.key.code == sf::Keyboard::Enter) {
+                myApp.SetTimelineMode(false);
+                myApp.SwitchGesture(myApp.GetScrubGesture());
+            }
+            if (event.type == sf::Event::KeyReleased && event.key.code == sf::Keyboard::T) {
+                myApp.SetTimelineMode(false);
+            }
+            if (event.type == sf::Event::Closed) {
+                myApp.GetWindow().close();
+                myApp.CloseJournal();
+                exit(EXIT_SUCCESS);
+            }
+            continue;
+        }
+
+        // Pan over the canvas a tile at a time, which is fewer pixels the more it is zoomed in
+        if(event.type == sf::Event::KeyPressed) {
+            const int step = std::max(1, (int)(64 / myApp.GetZoom()));
+            if(event.key.code == sf::Keyboard::Left) {
+                myApp.Pan(-step, 0);
+            }
+            if(event.key.code == sf::Keyboard::Right) {
+                myApp.Pan(step, 0);
+            }
+            if(event.key.code == sf::Keyboard::Up) {
+                myApp.Pan(0, -step);
+            }
+            if(event.key.code == sf::Keyboard::Down) {
+                myApp.Pan(0, step);
+            }
+        }
+        // Zoom in and out by a factor of 2 per wheel step
+        if(event.type == sf::Event::MouseWheelScrolled) {
+            myApp.SetZoom(event.mouseWheelScroll.delta > 0 ? myApp.GetZoom() * 2.0f : myApp.GetZoom() / 2.0f);
+        }
+
+        if(event.type == sf::Event::KeyReleased) {
+            // Undo command
+            if(event.key.code == sf::Keyboard::Z) {
+                myApp.UndoCommand();
+            }
+            // Redo command
+            if(event.key.code == sf::Keyboard::Y) {
+                myApp.RedoCommand();
+            }
+            // Switch to the next branch of the undo history
+            if(event.key.code == sf::Keyboard::N) {
+                myApp.SwitchBranch();
+            }
+            // Save the canvas in the background
+            if(event.key.code == sf::Keyboard::S) {
+                myApp.SaveImage("minipaint.png");
+            }
+            if(event.key.code == sf::Keyboard::J) {
+                myApp.SaveImage("minipaint.jpg");
+            }
+            if(event.key.code == sf::Keyboard::V) {
+                myApp.SaveImage("minipaint.svg");
+            }
+            // Save and open the native document, tiles and strokes
+            if(event.key.code == sf::Keyboard::D) {
+                myApp.SaveDocument("minipaint.mpd");
+            }
+            if(event.key.code == sf::Keyboard::O) {
+                myApp.OpenDocument("minipaint.mpd");
+            }
+            // Open the history timeline
+            if(event.key.code == sf::Keyboard::T) {
+                myApp.SetTimelineMode(true);
+            }
+            // Switch between the paintbrush and the bucket fill
+            if(event.key.code == sf::Keyboard::B) {
+                if (myApp.GetTool() == App::BUCKET) {
+                    myApp.SetTool(App::PAINTBRUSH);
+                    std::cout << "Tool is now: paintbrush" << std::endl;
+                } else {
+                    myApp.SetTool(App::BUCKET);
+                    std::cout << "Tool is now: bucket fill" << std::endl;
+                }
+            }
+            // Switch between keeping strokes as lines and painting them into the canvas
+            if(event.key.code == sf::Keyboard::R) {
+                myApp.SetRasterMode(!myApp.GetRasterMode());
+                std::cout << "Strokes are now: " << (myApp.GetRasterMode() ? "raster" : "lines") << std::endl;
+            }
+            // Keep the canvas as palette indices, in an eighth of the memory
+            if(event.key.code == sf::Keyboard::I) {
+                if (myApp.SetIndexedMode(!myApp.GetIndexedMode())) {
+                    std::cout << "Indexed mode is now: " << (myApp.GetIndexedMode() ? "on" : "off") << std::endl;
+                }
+            }
+            // Recolor the color under the mouse, all over the canvas
+            if(event.key.code == sf::Keyboard::C) {
+                const sf::Vector2i point = myApp.MapPixelToCanvas(mouseX, mouseY);
+                const int colors = myApp.RecolorCommand(point.x, point.y);
+                if (colors > 0) {
+                    std::cout << "Recolored " << colors << " palette colors" << std::endl;
+                }
+            }
+            // Check for change paintbrush color keypress
+            if(myApp.color_codes.find(event.key.code) != myApp.color_codes.end()) {
+                myApp.SetPaintbrushColor(event.key.code);
+                myApp.GenerateCursor(myApp.GetPaintbrushRadius(), myApp.GetPaintbrushColor());
+            }
+            // Check for change paintbrush size keypress
+            if(event.key.code == sf::Keyboard::Comma) {
+                if (myApp.GetPaintbrushRadius() > 3) {
+                    myApp.SetPaintbrushRadius(myApp.GetPaintbrushRadius() - 2);
+                    int& radius = myApp.GetPaintbrushRadius();
+                    myApp.GenerateCircleTemplate(radius);
+                    myApp.GenerateCursor(radius, myApp.GetPaintbrushColor());
+                    myApp.SetCursorPosition(mouseX, mouseY);
+                    std::cout << "Paintbrush radius is now: " << radius << std::endl;
+                }
+            }
+            if(event.key.code == sf::Keyboard::Period) {
+                if (myApp.GetPaintbrushRadius() < 15) {
+                    myApp.SetPaintbrushRadius(myApp.GetPaintbrushRadius() + 2);
+                    int& radius = myApp.GetPaintbrushRadius();
+                    myApp.GenerateCircleTemplate(radius);
+                    myApp.GenerateCursor(radius, myApp.GetPaintbrushColor());
+                    myApp.SetCursorPosition(mouseX, mouseY);
+                    std::cout << "Paintbrush radius is now: " << radius << std::endl;
+                }
+            }
+
+        }
+        // Close the window when you press the 'close' button.
+        if(event.type == sf::Event::Closed) {
+            myApp.GetWindow().close();
+            myApp.CloseJournal();
+            exit(EXIT_SUCCESS);
+        }
+        // When the mouse is released, end the stroke. The pipeline records it as one gesture. Reset the count.
+        if(event.type == sf::Event::MouseButtonReleased) {
+            if (myApp.cmdCount == 0) {
+                break;
+            }
+            myApp.SubmitStrokeEnd();
+            std::cout << "Submitted a stroke of " << myApp.cmdCount << " samples" << std::endl;
+            myApp.cmdCount = 0;
+        }
+        // Fill with the bucket once per click, off the UI thread
+        if(event.type == sf::Event::MouseButtonPressed && event.mouseButton.button == sf::Mouse::Left && myApp.GetTool() == App::BUCKET) {
+            const sf::Vector2i point = myApp.MapPixelToCanvas(event.mouseButton.x, event.mouseButton.y);
+            myApp.SubmitFill(point.x, point.y);
+        }
+        // Draw with the paintbrush
+        if(myApp.GetTool() == App::PAINTBRUSH && sf::Mouse::isButtonPressed(sf::Mouse::Left)) {
+            
+            if ((mouseX < 0) || (mouseY < 0) || (mouseX >= (int)myApp.GetWindow().getSize().x || (mouseY > (int)myApp.GetWindow().getSize().y))) {
+                return;
+            }
+            // Use a dummy port for now because we're not on a network
+            short port = 1234;
+            // Only sample the mouse here. The stroke pipeline joins the samples into line
+            // segments and paints them on its workers.
+            const sf::Vector2i point = myApp.MapPixelToCanvas(mouseX, mouseY);
+            myApp.SubmitPoint(point.x, point.y, port);
+            myApp.cmdCount++;
+
+            // Create a vector of all the points to be drawn.
+            //std::vector<std::pair<int, int>> allCoords = myApp.UseCircleTemplate(mouseX, mouseY);
+            //myApp.prevCmds.resize(allCoords.size());
+
+            // For each coordinate in allCoords, make a new Draw drawCmd pointer.
+            // for (int i=0; i < (int)allCoords.size(); i++) {
+            //     std::unique_ptr<Command> drawCmd1 (new Draw(allCoords[i].first, allCoords[i].second, myApp.GetImage(), myApp.GetPaintbrushColor()));
+            //     std::unique_ptr<Command> drawCmd2 (new Draw(allCoords[i].first, allCoords[i].second, myApp.GetImage(), myApp.GetPaintbrushColor()));
+            //     // If we have already started drawing...
+            //     if (myApp.prevCmds[i] != nullptr) {
+            //         // Use the EFLA algorithm to get a vector of intermediate pixels between prevCmd and drawCmd.
+            //         std::vector<std::pair<int, int>> pixels = MathUtility::ExtremelyFastLineAlgo(myApp.prevCmds[i]->getCoords().first, myApp.prevCmds[i]->getCoords().second, drawCmd1->getCoords().first, drawCmd1->getCoords().second);
+            //         // Iterate through the pixels and construct a new draw command for each pixel.
+            //         for (auto& pixel : pixels) {
+            //             std::unique_ptr<Command> intermDraw1(new Draw(pixel.first, pixel.second, myApp.GetImage(), myApp.GetPaintbrushColor()));
+            //             std::unique_ptr<Command> intermDraw2(new Draw(pixel.first, pixel.second, myApp.GetImage(), myApp.GetPaintbrushColor()));
+            //             // Remember to update the prevCmd with the new intermediateCmd.
+            //             myApp.prevCmds[i] = std::move(intermDraw1);
+            //             myApp.AddCommand(std::move(intermDraw2));
+            //         }
+            //     }
+            //     // Else if this is the first command, just re-assign the pointer to drawCmd and do nothing.
+            //     else {
+            //         myApp.prevCmds[i] = std::move(drawCmd1);
+            //         myApp.AddCommand(std::move(drawCmd2));
+            //     }
+            //     myApp.cmdCount += myApp.ExecuteCommand();
+            // }
+        }
+    }
+
+    // Check for ESC key press
+    if(sf::Keyboard::isKeyPressed(sf::Keyboard::Escape)){
+        myApp.GetWindow().close();
+        myApp.CloseJournal();
+        exit(EXIT_SUCCESS);
+    }
+}
+
+
+/*! \brief 	The draw call 
+*		
+*/
+void draw(App& myApp){
+    // Make the clock variable static so we don't lose it.
+    static sf::Clock clock;
+
+    // Load the modified pixels into our texture every 1/60 of a second.
+    // So every 1 frame if your monitor's refresh rate is 60 hz.
+    if(clock.getElapsedTime().asSeconds() > 0.0111f) {
+        // myApp.GetTexture().loadFromImage(myApp.GetImage());
+        // myApp.GetRenderSprite().setTexture(myApp.GetRenderTexture().getTexture());
+        //myApp.cmdCount += myApp.ExecuteCommand();
+        clock.restart();
+    }
+}
+
+ 
+/*! \brief 	The entry point into our program. "minipaint width height" paints on a canvas of
+*           that size instead of one the size of the window, and "minipaint --import image"
+*           opens the image once it is imported, however large it is. "minipaint --restore"
+*           starts from the last autosave, and "minipaint --restore minipaint.autosave.prev"
+*           from the one of the session before, which each start keeps.
+*		
+*/
+int main(int argc, char* argv[]){
+    // Call any setup function
+    // Passing a function pointer into the 'init' function.
+    // of our application.
+    App myApp = App();
+    myApp.Init(&initialization);
+    if (argc == 3 && std::string(argv[1]) == "--import") {
+        myApp.ImportImage(argv[2]);
+    }
+    else if (argc == 3 && std::string(argv[1]) != "--restore") {
+        myApp.NewCanvas(std::atoi(argv[1]), std::atoi(argv[2]));
+    }
+    // Start from the last autosave instead, or the one given, if asked to; the journal is of
+    // the canvas before it
+    if ((argc == 2 || argc == 3) && std::string(argv[1]) == "--restore" && myApp.RestoreAutosave(argc == 3 ? argv[2] : "minipaint.autosave")) {
+        std::remove("minipaint.journal");
+    }
+    // Recover the last session on the canvas it was journaled on, then journal this one
+    myApp.OpenJournal("minipaint.journal");
+    // Save what changed every half minute, off the UI thread
+    myApp.StartAutosave("minipaint.autosave");
+    // Setup your keyboard
+    myApp.UpdateCallback(&update);
+    // Setup the Draw Function
+    myApp.DrawCallback(&draw);
+    // Call the main loop function
+    myApp.Loop(myApp);
+    // Destroy our app
+    myApp.Destroy();
+
+    return 0;
 }
\ No newline at end of file
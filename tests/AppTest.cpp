@@ -1,366 +1,2116 @@
-#define CATCH_CONFIG_MAIN
-
-#include "catch_amalgamated.hpp"
-#include "App.hpp"
-#include "Command.hpp"
-#include "Draw.hpp"
-#include "MathUtility.hpp"
-
-#include <SFML/Graphics.hpp>
-#include <vector>
-#include <iostream>
-#include <string>
-
-// Our custom print coordinates function for testing and debugging purposes
-void _printCoordinates(std::vector<std::pair<int, int>> coordinates) {
-    for (auto coordinate : coordinates) {
-        std::cout << "(" << coordinate.first << ", " << coordinate.second << ")" << std::endl;
-    }
-}
-
-// Our custom initializer function for testing purposes
-void _initialization(void) {}
-
-// Our custom update function for testing purposes with mouse position at (100, 200)
-void _update(App& app) {
-    int mouseX = 100;
-    int mouseY = 200;
-    std::vector<std::pair<int, int>> allCoords = app.UseCircleTemplate(mouseX, mouseY);
-    app.prevCmds.resize(allCoords.size());
-    // For each coordinate in allCoords, make a new Draw drawCmd pointer.
-    for (int i=0; i < (int)allCoords.size(); i++) {
-        std::unique_ptr<Command> drawCmd1 (new Draw(allCoords[i].first, allCoords[i].second, app.GetImage(), app.GetPaintbrushColor()));
-        std::unique_ptr<Command> drawCmd2 (new Draw(allCoords[i].first, allCoords[i].second, app.GetImage(), app.GetPaintbrushColor()));
-        // If we have already started drawing...
-        if (app.prevCmds[i] != nullptr) {
-            // Use the EFLA algorithm to get a vector of intermediate pixels between prevCmd and drawCmd.
-            std::vector<std::pair<int, int>> pixels = MathUtility::ExtremelyFastLineAlgo(app.prevCmds[i]->getCoords().first, app.prevCmds[i]->getCoords().second, drawCmd1->getCoords().first, drawCmd1->getCoords().second);
-            // Iterate through the pixels and construct a new draw command for each pixel.
-            for (auto& pixel : pixels) {
-                std::unique_ptr<Command> intermDraw1(new Draw(pixel.first, pixel.second, app.GetImage(), app.GetPaintbrushColor()));
-                std::unique_ptr<Command> intermDraw2(new Draw(pixel.first, pixel.second, app.GetImage(), app.GetPaintbrushColor()));
-                // Remember to update the prevCmd with the new intermediateCmd.
-                app.prevCmds[i] = std::move(intermDraw1);
-                app.AddCommand(std::move(intermDraw2));
-            }
-        }
-        // Else if this is the first command, just re-assign the pointer to drawCmd and do nothing.
-        else {
-            app.prevCmds[i] = std::move(drawCmd1);
-            app.AddCommand(std::move(drawCmd2));
-        }
-        app.cmdCount += app.ExecuteCommand();
-    }
-}
-
-// Our custom update function for testing purposes with mouse position at (120, 220)
-void _update2(App& app) {
-    int mouseX = 120;
-    int mouseY = 220;
-    std::vector<std::pair<int, int>> allCoords = app.UseCircleTemplate(mouseX, mouseY);
-    app.prevCmds.resize(allCoords.size());
-    // For each coordinate in allCoords, make a new Draw drawCmd pointer.
-    for (int i=0; i < (int)allCoords.size(); i++) {
-        std::unique_ptr<Command> drawCmd1 (new Draw(allCoords[i].first, allCoords[i].second, app.GetImage(), app.GetPaintbrushColor()));
-        std::unique_ptr<Command> drawCmd2 (new Draw(allCoords[i].first, allCoords[i].second, app.GetImage(), app.GetPaintbrushColor()));
-        // If we have already started drawing...
-        if (app.prevCmds[i] != nullptr) {
-            // Use the EFLA algorithm to get a vector of intermediate pixels between prevCmd and drawCmd.
-            std::vector<std::pair<int, int>> pixels = MathUtility::ExtremelyFastLineAlgo(app.prevCmds[i]->getCoords().first, app.prevCmds[i]->getCoords().second, drawCmd1->getCoords().first, drawCmd1->getCoords().second);
-            // Iterate through the pixels and construct a new draw command for each pixel.
-            for (auto& pixel : pixels) {
-                std::unique_ptr<Command> intermDraw1(new Draw(pixel.first, pixel.second, app.GetImage(), app.GetPaintbrushColor()));
-                std::unique_ptr<Command> intermDraw2(new Draw(pixel.first, pixel.second, app.GetImage(), app.GetPaintbrushColor()));
-                // Remember to update the prevCmd with the new intermediateCmd.
-                app.prevCmds[i] = std::move(intermDraw1);
-                app.AddCommand(std::move(intermDraw2));
-            }
-        }
-        // Else if this is the first command, just re-assign the pointer to drawCmd and do nothing.
-        else {
-            app.prevCmds[i] = std::move(drawCmd1);
-            app.AddCommand(std::move(drawCmd2));
-        }
-        app.cmdCount += app.ExecuteCommand();
-    }
-}
-
-// Our custom draw function for testing purposes
-void _draw(App& myApp){
-	static sf::Clock clock;
-	if(clock.getElapsedTime().asSeconds() > 0.0166f) {
-		myApp.GetTexture().loadFromImage(myApp.GetImage());
-		clock.restart();
-	}
-}
-
-// A replacement function for the App::Loop() function that only runs 1 time at point (100,200).
-void manualUpdateAndDraw1(App& app) {
-    app.UpdateCallback(&_update);
-    app.DrawCallback(&_draw);
-    app.GetWindow().clear();
-    app.m_updateFunc(app);
-    app.m_drawFunc(app);
-    app.GetWindow().draw(app.GetSprite());
-}
-
-// A replacement function for the App::Loop() function that only runs 1 time at point (120,220).
-void manualUpdateAndDraw2(App& app) {
-    app.UpdateCallback(&_update2);
-    app.DrawCallback(&_draw);
-    app.GetWindow().clear();
-    app.m_updateFunc(app);
-    app.m_drawFunc(app);
-    app.GetWindow().draw(app.GetSprite());
-}
-
-/*! \brief Test app init and destroy.
-*/
-TEST_CASE("App Inititialization and Destroy", "[App] [Core]") {
-    App app = App();
-    app.Init(&_initialization);
-    app.Destroy();
-}
-
-/*! \brief Test drawing 1 pixel from white to black
-*/
-TEST_CASE("Draw 1 point from White to Black", "[App] [Core]") {
-    App app = App();
-    app.Init(&_initialization);
-    REQUIRE(app.GetImage().getPixel(100, 200) == sf::Color::White);
-    manualUpdateAndDraw1(app);
-    REQUIRE(app.GetImage().getPixel(100, 200) == sf::Color::Black);
-    app.Destroy();
-}
-
-/*! \brief Test drawing an entire circle (97 pixels) from white to black using default radius of 5.
-*/
-TEST_CASE("Draw entire circle (97) from White to Black", "[App] [Core]") {
-    App app = App();
-    app.Init(&_initialization);
-
-    // Manually extract the coordinates to be drawn and check the vector size.
-    std::vector<std::pair<int, int>> allCoords = app.UseCircleTemplate(100, 200);
-    REQUIRE(allCoords.size() == 97);
-
-    // Test the color before drawing
-    for (auto& coord : allCoords) {
-        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::White);
-    }
-    manualUpdateAndDraw1(app);
-    // Test the color after drawing
-    for (auto& coord : allCoords) {
-        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::Black);
-    }
-    // Check that the outer circle boundary (N,S,E,W) is still white
-    REQUIRE(app.GetImage().getPixel(106, 200) == sf::Color::White);
-    REQUIRE(app.GetImage().getPixel(94, 200) == sf::Color::White);
-    REQUIRE(app.GetImage().getPixel(100, 206) == sf::Color::White);
-    REQUIRE(app.GetImage().getPixel(100, 194) == sf::Color::White);
-    app.Destroy();
-}
-
-/*! \brief Test changing paintbrush radius.
-*/
-TEST_CASE("Change paintbrush radius", "[App] [Features]") {
-    App app = App();
-    app.Init(&_initialization);
-    SECTION("Change paintbrush radius from 5 to 7") {
-        REQUIRE(app.GetPaintbrushRadius() == 5);
-        app.SetPaintbrushRadius(7);
-        REQUIRE(app.GetPaintbrushRadius() == 7);
-    }
-    SECTION("Change paintbrush radius from 5 to 3") {
-        REQUIRE(app.GetPaintbrushRadius() == 5);
-        app.SetPaintbrushRadius(3);
-        REQUIRE(app.GetPaintbrushRadius() == 3);
-    }
-    app.Destroy();
-}
-
-/*! \brief Test drawing an entire circle (97 pixels) using paintbrush radius of 7.
-*/
-TEST_CASE("Draw after changing paintbrush radius from 5 to 7", "[App] [Features]") {
-    App app = App();
-    app.Init(&_initialization);
-    REQUIRE(app.GetPaintbrushRadius() == 5);
-    app.SetPaintbrushRadius(7);
-    app.GenerateCircleTemplate(7);
-
-    // Change the paintbrush radius to 7
-    REQUIRE(app.GetPaintbrushRadius() == 7);
-
-    // Manually extract the coordinates to be drawn and check the vector size.
-    std::vector<std::pair<int, int>> allCoords = app.UseCircleTemplate(100, 200);
-    REQUIRE(allCoords.size() == 177);
-
-    // Test the color before drawing
-    for (auto& coord : allCoords) {
-        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::White);
-    }
-    manualUpdateAndDraw1(app);
-    // Test the color after drawing
-    for (auto& coord : allCoords) {
-        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::Black);
-    }
-    // Check that the outer circle boundary (N,S,E,W) is still white
-    REQUIRE(app.GetImage().getPixel(108, 200) == sf::Color::White);
-    REQUIRE(app.GetImage().getPixel(92, 200) == sf::Color::White);
-    REQUIRE(app.GetImage().getPixel(100, 208) == sf::Color::White);
-    REQUIRE(app.GetImage().getPixel(100, 192) == sf::Color::White);
-    app.Destroy();
-}
-
-/*! \brief Test drawing an entire circle (177 pixels) using paintbrush radius of 7 and color red.
-*/
-TEST_CASE("Draw using paintbrush radius = 7 and color = Red", "[App] [Features]") {
-    App app = App();
-    app.Init(&_initialization);
-    app.SetPaintbrushRadius(7);
-    app.GenerateCircleTemplate(7);
-    REQUIRE(app.GetPaintbrushRadius() == 7);
-    // Change the paintbrush color from Black to Red
-    REQUIRE(app.GetPaintbrushColor() == sf::Color::Black);
-    app.SetPaintbrushColor(sf::Keyboard::Key::Num3);
-    REQUIRE(app.GetPaintbrushColor() == sf::Color::Red);
-
-    // Manually extract the coordinates to be drawn and check the vector size.
-    std::vector<std::pair<int, int>> allCoords = app.UseCircleTemplate(100, 200);
-
-    REQUIRE(allCoords.size() == 177);
-    // Test the color before drawing
-    for (auto& coord : allCoords) {
-        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::White);
-    }
-    manualUpdateAndDraw1(app);
-    // Test the color after drawing
-    for (auto& coord : allCoords) {
-        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::Red);
-    }
-    // Check that the outer circle boundary (N,S,E,W) is still white
-    REQUIRE(app.GetImage().getPixel(108, 200) == sf::Color::White);
-    REQUIRE(app.GetImage().getPixel(92, 200) == sf::Color::White);
-    REQUIRE(app.GetImage().getPixel(100, 208) == sf::Color::White);
-    REQUIRE(app.GetImage().getPixel(100, 192) == sf::Color::White);
-    app.Destroy();
-}
-
-/*! \brief Test drawing a thick line with paintbrush radius of 5 and color black.
-*/
-TEST_CASE("Draw a line from (100,200) to (120,220) using radius = 5 and color = Black", "[App] [Features]") {
-    App app = App();
-    app.Init(&_initialization);
-    // Manually extract the coordinates to be drawn and check the vector size.
-    std::vector<std::pair<int, int>> allCoords1 = app.UseCircleTemplate(100, 200);
-    // Test the color before drawing
-    for (auto& coord : allCoords1) {
-        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::White);
-    }
-    manualUpdateAndDraw1(app);
-    // Test the color after drawing
-    for (auto& coord : allCoords1) {
-        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::Black);
-    }
-
-    // **************************** MOVE THE MOUSE **************************************
-
-    // Manually extract the coordinates to be drawn and check the vector size.
-    std::vector<std::pair<int, int>> allCoords2 = app.UseCircleTemplate(120, 220);
-    // Test the color before drawing
-    for (auto& coord : allCoords2) {
-        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::White);
-    }
-    manualUpdateAndDraw2(app);
-    // Test the color after drawing
-    for (auto& coord : allCoords2) {
-        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::Black);
-    }
-    // Test all interpolated points between the original mouse position and the new mouse position.
-    for (std::pair<int,int> coord1 : allCoords1) {
-        for (std::pair<int,int> coord2 : allCoords2) {
-            std::vector<std::pair<int, int>> intermCoords = MathUtility::ExtremelyFastLineAlgo(coord1.first, coord1.second, coord2.first, coord2.second);
-            for (auto& interm : intermCoords) {
-                REQUIRE(app.GetImage().getPixel(interm.first, interm.second) == sf::Color::Black);
-            }
-        }
-    }
-    app.Destroy();
-}
-
-/*! \brief Test undo when there is nothing to undo.
-*/
-TEST_CASE("Test undo when there is nothing to undo", "[App] [Core]") {
-    App app = App();
-    app.Init(&_initialization);
-    int numUndo = app.UndoCommand();
-    REQUIRE(numUndo == 0);
-    app.Destroy();
-}
-
-/*! \brief Test redo when there is nothing to redo.
-*/
-TEST_CASE("Test redo when there is nothing to redo", "[App] [Core]") {
-    App app = App();
-    app.Init(&_initialization);
-    int numRedo = app.RedoCommand();
-    REQUIRE(numRedo == 0);
-    app.Destroy();
-}
-
-/*! \brief Test undo after drawing.
-*/
-TEST_CASE("Test undo after drawing", "[App] [Core]") {
-    App app = App();
-    app.Init(&_initialization);
-    manualUpdateAndDraw1(app);
-    // Manually extract the coordinates that were drawn and check the vector size.
-    std::vector<std::pair<int, int>> allCoords = app.UseCircleTemplate(100, 200);
-    REQUIRE(allCoords.size() == 97);
-    // Manually push in the m_undo_count because we don't have a mouse to release mouse button.
-    app.m_undo_count.push((int)allCoords.size());
-    // Test the color after drawing
-    for (auto& coord : allCoords) {
-        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::Black);
-    }
-    int numUndo = app.UndoCommand();
-    REQUIRE(numUndo == 97);
-    app.Destroy();
-}
-
-/*! \brief Test redo after drawing.
-*/
-TEST_CASE("Test redo after undoing", "[App] [Core]") {
-    App app = App();
-    app.Init(&_initialization);
-    manualUpdateAndDraw1(app);
-    std::vector<std::pair<int, int>> allCoords = app.UseCircleTemplate(100, 200);
-    REQUIRE(allCoords.size() == 97);
-    // Manually push in the m_undo_count because we don't have a mouse to release mouse button.
-    app.m_undo_count.push((int)allCoords.size());
-    app.UndoCommand();
-    // Call undo again and verify that 0 is returned.
-    int numUndo = app.UndoCommand();
-    REQUIRE(numUndo == 0);
-    int numRedo = app.RedoCommand();
-    REQUIRE(numRedo == 97);
-    app.Destroy();
-}
-
-/*! \brief Test that m_redo is automatically cleared if user draws after undoing.
-*/
-TEST_CASE("Test that m_redo is automatically cleared if user draws after undoing.", "[App] [Core]") {
-    App app = App();
-    app.Init(&_initialization);
-    manualUpdateAndDraw1(app);
-    std::vector<std::pair<int, int>> allCoords = app.UseCircleTemplate(100, 200);
-    REQUIRE(allCoords.size() == 97);
-    // Manually push in the m_undo_count because we don't have a mouse to release mouse button.
-    app.m_undo_count.push((int)allCoords.size());
-    app.UndoCommand();
-    // Draw again
-    manualUpdateAndDraw2(app);
-    // Verify that m_redo is empty
-    int numRedo = app.RedoCommand();
-    REQUIRE(numRedo == 0);
-    app.Destroy();
-}
\ No newline at end of file
+#define CATCH_CONFIG_MAIN
+
+#include "catch_amalgamated.hpp"
+#include "App.hpp"
+#include "Command.hpp"
+#include "Draw.hpp"
+#include "MathUtility.hpp"
+#include "PixelBatch.hpp"
+
+#include <SFML/Graphics.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <vector>
+#include <iostream>
+#include <string>
+#include <thread>
+
+// Our custom print coordinates function for testing and debugging purposes
+void _printCoordinates(std::vector<std::pair<int, int>> coordinates) {
+    for (auto coordinate : coordinates) {
+        std::cout << "(" << coordinate.first << ", " << coordinate.second << ")" << std::endl;
+    }
+}
+
+// Our custom initializer function for testing purposes
+void _initialization(void) {}
+
+// Draw count short line segments with the paintbrush, like one mouse drag.
+int _addLines(App& app, int count, float x = 0, float y = 100) {
+    int added = 0;
+    for (int i = 0; i < count; i++) {
+        std::unique_ptr<RoundedLine> line(new RoundedLine(sf::Vector2f(x + i % 1000, y), sf::Vector2f(x + i % 1000 + 1, y + 1), 10, sf::Color::Black, 1234));
+        app.AddCommand(std::move(line));
+        added += app.ExecuteCommand();
+    }
+    return added;
+}
+
+// Paint the paintbrush circle at (mouseX, mouseY) as one PixelBatch. If the mouse was
+// down before, each pixel of the circle is joined to the same pixel of the last circle
+// with the EFLA algorithm, like the paintbrush does when the mouse is dragged.
+void _paintCircle(App& app, int mouseX, int mouseY) {
+    std::unique_ptr<PixelBatch> batch(new PixelBatch(app.GetImage(), app.GetPaintbrushColor()));
+    std::vector<std::pair<int, int>> allCoords = app.UseCircleTemplate(mouseX, mouseY);
+    if (app.m_prev_point != nullptr) {
+        std::vector<std::pair<int, int>> prevCoords = app.UseCircleTemplate((int)app.m_prev_point->x, (int)app.m_prev_point->y);
+        for (int i=0; i < (int)allCoords.size(); i++) {
+            batch->add(MathUtility::ExtremelyFastLineAlgo(prevCoords[i].first, prevCoords[i].second, allCoords[i].first, allCoords[i].second));
+        }
+        delete app.m_prev_point;
+    }
+    else {
+        batch->add(allCoords);
+    }
+    app.m_prev_point = new sf::Vector2f((float)mouseX, (float)mouseY);
+    app.cmdCount += app.PaintPixels(std::move(batch));
+}
+
+// Our custom update function for testing purposes with mouse position at (100, 200)
+void _update(App& app) {
+    _paintCircle(app, 100, 200);
+}
+
+// Our custom update function for testing purposes with mouse position at (120, 220)
+void _update2(App& app) {
+    _paintCircle(app, 120, 220);
+}
+
+// Our custom draw function for testing purposes
+void _draw(App& myApp){
+	static sf::Clock clock;
+	if(clock.getElapsedTime().asSeconds() > 0.0166f) {
+		myApp.GetTexture().loadFromImage(myApp.GetImage());
+		clock.restart();
+	}
+}
+
+// A replacement function for the App::Loop() function that only runs 1 time at point (100,200).
+void manualUpdateAndDraw1(App& app) {
+    app.UpdateCallback(&_update);
+    app.DrawCallback(&_draw);
+    app.GetWindow().clear();
+    app.m_updateFunc(app);
+    app.m_drawFunc(app);
+    app.GetWindow().draw(app.GetSprite());
+}
+
+// A replacement function for the App::Loop() function that only runs 1 time at point (120,220).
+void manualUpdateAndDraw2(App& app) {
+    app.UpdateCallback(&_update2);
+    app.DrawCallback(&_draw);
+    app.GetWindow().clear();
+    app.m_updateFunc(app);
+    app.m_drawFunc(app);
+    app.GetWindow().draw(app.GetSprite());
+}
+
+/*! \brief Test app init and destroy.
+*/
+TEST_CASE("App Inititialization and Destroy", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    app.Destroy();
+}
+
+/*! \brief Test drawing 1 pixel from white to black
+*/
+TEST_CASE("Draw 1 point from White to Black", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE(app.GetImage().getPixel(100, 200) == sf::Color::White);
+    manualUpdateAndDraw1(app);
+    REQUIRE(app.GetImage().getPixel(100, 200) == sf::Color::Black);
+    app.Destroy();
+}
+
+/*! \brief Test drawing an entire circle (97 pixels) from white to black using default radius of 5.
+*/
+TEST_CASE("Draw entire circle (97) from White to Black", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+
+    // Manually extract the coordinates to be drawn and check the vector size.
+    std::vector<std::pair<int, int>> allCoords = app.UseCircleTemplate(100, 200);
+    REQUIRE(allCoords.size() == 97);
+
+    // Test the color before drawing
+    for (auto& coord : allCoords) {
+        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::White);
+    }
+    manualUpdateAndDraw1(app);
+    // Test the color after drawing
+    for (auto& coord : allCoords) {
+        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::Black);
+    }
+    // Check that the outer circle boundary (N,S,E,W) is still white
+    REQUIRE(app.GetImage().getPixel(106, 200) == sf::Color::White);
+    REQUIRE(app.GetImage().getPixel(94, 200) == sf::Color::White);
+    REQUIRE(app.GetImage().getPixel(100, 206) == sf::Color::White);
+    REQUIRE(app.GetImage().getPixel(100, 194) == sf::Color::White);
+    app.Destroy();
+}
+
+/*! \brief Test changing paintbrush radius.
+*/
+TEST_CASE("Change paintbrush radius", "[App] [Features]") {
+    App app = App();
+    app.Init(&_initialization);
+    SECTION("Change paintbrush radius from 5 to 7") {
+        REQUIRE(app.GetPaintbrushRadius() == 5);
+        app.SetPaintbrushRadius(7);
+        REQUIRE(app.GetPaintbrushRadius() == 7);
+    }
+    SECTION("Change paintbrush radius from 5 to 3") {
+        REQUIRE(app.GetPaintbrushRadius() == 5);
+        app.SetPaintbrushRadius(3);
+        REQUIRE(app.GetPaintbrushRadius() == 3);
+    }
+    app.Destroy();
+}
+
+/*! \brief Test drawing an entire circle (97 pixels) using paintbrush radius of 7.
+*/
+TEST_CASE("Draw after changing paintbrush radius from 5 to 7", "[App] [Features]") {
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE(app.GetPaintbrushRadius() == 5);
+    app.SetPaintbrushRadius(7);
+    app.GenerateCircleTemplate(7);
+
+    // Change the paintbrush radius to 7
+    REQUIRE(app.GetPaintbrushRadius() == 7);
+
+    // Manually extract the coordinates to be drawn and check the vector size.
+    std::vector<std::pair<int, int>> allCoords = app.UseCircleTemplate(100, 200);
+    REQUIRE(allCoords.size() == 177);
+
+    // Test the color before drawing
+    for (auto& coord : allCoords) {
+        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::White);
+    }
+    manualUpdateAndDraw1(app);
+    // Test the color after drawing
+    for (auto& coord : allCoords) {
+        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::Black);
+    }
+    // Check that the outer circle boundary (N,S,E,W) is still white
+    REQUIRE(app.GetImage().getPixel(108, 200) == sf::Color::White);
+    REQUIRE(app.GetImage().getPixel(92, 200) == sf::Color::White);
+    REQUIRE(app.GetImage().getPixel(100, 208) == sf::Color::White);
+    REQUIRE(app.GetImage().getPixel(100, 192) == sf::Color::White);
+    app.Destroy();
+}
+
+/*! \brief Test drawing an entire circle (177 pixels) using paintbrush radius of 7 and color red.
+*/
+TEST_CASE("Draw using paintbrush radius = 7 and color = Red", "[App] [Features]") {
+    App app = App();
+    app.Init(&_initialization);
+    app.SetPaintbrushRadius(7);
+    app.GenerateCircleTemplate(7);
+    REQUIRE(app.GetPaintbrushRadius() == 7);
+    // Change the paintbrush color from Black to Red
+    REQUIRE(app.GetPaintbrushColor() == sf::Color::Black);
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num3);
+    REQUIRE(app.GetPaintbrushColor() == sf::Color::Red);
+
+    // Manually extract the coordinates to be drawn and check the vector size.
+    std::vector<std::pair<int, int>> allCoords = app.UseCircleTemplate(100, 200);
+
+    REQUIRE(allCoords.size() == 177);
+    // Test the color before drawing
+    for (auto& coord : allCoords) {
+        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::White);
+    }
+    manualUpdateAndDraw1(app);
+    // Test the color after drawing
+    for (auto& coord : allCoords) {
+        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::Red);
+    }
+    // Check that the outer circle boundary (N,S,E,W) is still white
+    REQUIRE(app.GetImage().getPixel(108, 200) == sf::Color::White);
+    REQUIRE(app.GetImage().getPixel(92, 200) == sf::Color::White);
+    REQUIRE(app.GetImage().getPixel(100, 208) == sf::Color::White);
+    REQUIRE(app.GetImage().getPixel(100, 192) == sf::Color::White);
+    app.Destroy();
+}
+
+/*! \brief Test drawing a thick line with paintbrush radius of 5 and color black.
+*/
+TEST_CASE("Draw a line from (100,200) to (120,220) using radius = 5 and color = Black", "[App] [Features]") {
+    App app = App();
+    app.Init(&_initialization);
+    // Manually extract the coordinates to be drawn and check the vector size.
+    std::vector<std::pair<int, int>> allCoords1 = app.UseCircleTemplate(100, 200);
+    // Test the color before drawing
+    for (auto& coord : allCoords1) {
+        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::White);
+    }
+    manualUpdateAndDraw1(app);
+    // Test the color after drawing
+    for (auto& coord : allCoords1) {
+        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::Black);
+    }
+
+    // **************************** MOVE THE MOUSE **************************************
+
+    // Manually extract the coordinates to be drawn and check the vector size.
+    std::vector<std::pair<int, int>> allCoords2 = app.UseCircleTemplate(120, 220);
+    // Test the color before drawing
+    for (auto& coord : allCoords2) {
+        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::White);
+    }
+    manualUpdateAndDraw2(app);
+    // Test the color after drawing
+    for (auto& coord : allCoords2) {
+        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::Black);
+    }
+    // Test all interpolated points between the original mouse position and the new mouse position.
+    for (std::pair<int,int> coord1 : allCoords1) {
+        for (std::pair<int,int> coord2 : allCoords2) {
+            std::vector<std::pair<int, int>> intermCoords = MathUtility::ExtremelyFastLineAlgo(coord1.first, coord1.second, coord2.first, coord2.second);
+            for (auto& interm : intermCoords) {
+                REQUIRE(app.GetImage().getPixel(interm.first, interm.second) == sf::Color::Black);
+            }
+        }
+    }
+    app.Destroy();
+}
+
+/*! \brief Test undo when there is nothing to undo.
+*/
+TEST_CASE("Test undo when there is nothing to undo", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    int numUndo = app.UndoCommand();
+    REQUIRE(numUndo == 0);
+    app.Destroy();
+}
+
+/*! \brief Test redo when there is nothing to redo.
+*/
+TEST_CASE("Test redo when there is nothing to redo", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    int numRedo = app.RedoCommand();
+    REQUIRE(numRedo == 0);
+    app.Destroy();
+}
+
+/*! \brief Test undo after drawing.
+*/
+TEST_CASE("Test undo after drawing", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    manualUpdateAndDraw1(app);
+    // Manually extract the coordinates that were drawn and check the vector size.
+    std::vector<std::pair<int, int>> allCoords = app.UseCircleTemplate(100, 200);
+    REQUIRE(allCoords.size() == 97);
+    // Manually push the gesture because we don't have a mouse to release mouse button.
+    app.PushGesture((int)allCoords.size());
+    // Test the color after drawing
+    for (auto& coord : allCoords) {
+        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::Black);
+    }
+    // The circle is one PixelBatch command.
+    int numUndo = app.UndoCommand();
+    REQUIRE(numUndo == 1);
+    for (auto& coord : allCoords) {
+        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::White);
+    }
+    app.Destroy();
+}
+
+/*! \brief Test redo after drawing.
+*/
+TEST_CASE("Test redo after undoing", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    manualUpdateAndDraw1(app);
+    std::vector<std::pair<int, int>> allCoords = app.UseCircleTemplate(100, 200);
+    REQUIRE(allCoords.size() == 97);
+    // Manually push the gesture because we don't have a mouse to release mouse button.
+    app.PushGesture((int)allCoords.size());
+    app.UndoCommand();
+    // Call undo again and verify that 0 is returned.
+    int numUndo = app.UndoCommand();
+    REQUIRE(numUndo == 0);
+    int numRedo = app.RedoCommand();
+    REQUIRE(numRedo == 1);
+    for (auto& coord : allCoords) {
+        REQUIRE(app.GetImage().getPixel(coord.first, coord.second) == sf::Color::Black);
+    }
+    app.Destroy();
+}
+
+/*! \brief Test that m_redo is automatically cleared if user draws after undoing.
+*/
+TEST_CASE("Test that m_redo is automatically cleared if user draws after undoing.", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    manualUpdateAndDraw1(app);
+    std::vector<std::pair<int, int>> allCoords = app.UseCircleTemplate(100, 200);
+    REQUIRE(allCoords.size() == 97);
+    // Manually push the gesture because we don't have a mouse to release mouse button.
+    app.PushGesture((int)allCoords.size());
+    app.UndoCommand();
+    // Draw again
+    manualUpdateAndDraw2(app);
+    // Verify that m_redo is empty
+    int numRedo = app.RedoCommand();
+    REQUIRE(numRedo == 0);
+    app.Destroy();
+}
+
+/*! \brief Test that the pixel batches of one drag are undone and redone as one gesture.
+*/
+TEST_CASE("Undo and redo a drag of pixel batches", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    manualUpdateAndDraw1(app);
+    manualUpdateAndDraw2(app);
+    app.PushGesture(0);
+    REQUIRE(app.GetImage().getPixel(110, 210) == sf::Color::Black);
+    REQUIRE(app.UndoCommand() == 2);
+    REQUIRE(app.GetImage().getPixel(100, 200) == sf::Color::White);
+    REQUIRE(app.GetImage().getPixel(110, 210) == sf::Color::White);
+    REQUIRE(app.GetImage().getPixel(120, 220) == sf::Color::White);
+    REQUIRE(app.UndoCommand() == 0);
+    REQUIRE(app.RedoCommand() == 2);
+    REQUIRE(app.GetImage().getPixel(110, 210) == sf::Color::Black);
+    app.Destroy();
+}
+
+/*! \brief Test that strokes are undone and redone as whole gestures.
+*/
+TEST_CASE("Undo and redo whole strokes", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    app.PushGesture(_addLines(app, 3));
+    app.PushGesture(_addLines(app, 2));
+    REQUIRE(app.GetLineCount() == 5);
+    REQUIRE(app.UndoCommand() == 2);
+    REQUIRE(app.GetLineCount() == 3);
+    REQUIRE(app.UndoCommand() == 3);
+    REQUIRE(app.GetLineCount() == 0);
+    REQUIRE(app.UndoCommand() == 0);
+    REQUIRE(app.RedoCommand() == 3);
+    REQUIRE(app.GetLineCount() == 3);
+    // Drawing after an undo starts a new branch, which has nothing to redo.
+    app.PushGesture(_addLines(app, 1));
+    REQUIRE(app.GetLineCount() == 4);
+    REQUIRE(app.RedoCommand() == 0);
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.UndoCommand() == 3);
+    app.Destroy();
+}
+
+// True if both images have the same pixels.
+bool _sameCanvas(const sf::Image& a, const sf::Image& b) {
+    return a.getSize() == b.getSize() && std::equal(a.getPixelsPtr(), a.getPixelsPtr() + a.getSize().x * a.getSize().y * 4, b.getPixelsPtr());
+}
+
+/*! \brief Test that drawing after an undo starts a new branch and the old one can be switched back to.
+*/
+TEST_CASE("Switch between branches of the undo tree", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    app.PushGesture(_addLines(app, 3));
+    const sf::Uint32 shared = app.GetGestureCursor();
+    app.SetRasterMode(true);
+    app.PushGesture(_addLines(app, 10, 100, 300));
+    app.SetRasterMode(false);
+    app.PushGesture(_addLines(app, 4));
+    const sf::Uint32 first = app.GetGestureCursor();
+    sf::Image firstImage = app.Flatten();
+    REQUIRE(app.GetLineCount() == 7);
+
+    // Undo both, then draw a new branch from the shared stroke.
+    REQUIRE(app.UndoCommand() == 4);
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.FillCommand(600, 600) == 1);
+    app.PushGesture(_addLines(app, 2, 0, 400));
+    const sf::Uint32 second = app.GetGestureCursor();
+    sf::Image secondImage = app.Flatten();
+    REQUIRE(app.GetLineCount() == 5);
+    REQUIRE(app.RedoCommand() == 0);
+    REQUIRE(app.GetGestureCount() == 5);
+    REQUIRE(app.GetGesture(app.GetGesture(first).parent).parent == shared);
+    REQUIRE(app.GetGesture(app.GetGesture(second).parent).parent == shared);
+
+    // Switching only moves the cursor through the tree and brings the image over.
+    REQUIRE(app.SwitchGesture(first) == 4);
+    REQUIRE(app.GetGestureCursor() == first);
+    REQUIRE(app.GetLineCount() == 7);
+    REQUIRE(_sameCanvas(app.Flatten(), firstImage));
+    REQUIRE(app.SwitchGesture(second) == 4);
+    REQUIRE(_sameCanvas(app.Flatten(), secondImage));
+    // The next branch is the sibling of the current gesture.
+    REQUIRE(app.UndoCommand() == 2);
+    REQUIRE(app.SwitchBranch() == 2);
+    REQUIRE(app.RedoCommand() == 4);
+    REQUIRE(app.GetGestureCursor() == first);
+    REQUIRE(_sameCanvas(app.Flatten(), firstImage));
+    // Redo follows the branch that was visited last.
+    REQUIRE(app.UndoCommand() == 4);
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.RedoCommand() == 1);
+    REQUIRE(app.RedoCommand() == 4);
+    REQUIRE(app.GetGestureCursor() == first);
+    REQUIRE(app.SwitchGesture(App::NO_GESTURE) == 3);
+    REQUIRE(app.GetLineCount() == 0);
+    REQUIRE(app.SwitchGesture(99) == -1);
+    app.Destroy();
+}
+
+/*! \brief Test that undo tree nodes stay small, so thousands of branches are cheap.
+*/
+TEST_CASE("Undo tree nodes are compact", "[App] [Core]") {
+    REQUIRE(sizeof(App::Gesture) <= 28);
+}
+
+/*! \brief Test that raster mode strokes are painted into the image and undone as one gesture.
+*/
+TEST_CASE("Undo and redo a raster mode stroke", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    app.SetRasterMode(true);
+    app.PushGesture(_addLines(app, 10));
+    REQUIRE(app.GetLineCount() == 0);
+    REQUIRE(app.GetImage().getPixel(5, 100) == sf::Color::Black);
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.GetImage().getPixel(5, 100) == sf::Color::White);
+    REQUIRE(app.RedoCommand() == 1);
+    REQUIRE(app.GetImage().getPixel(5, 100) == sf::Color::Black);
+    app.Destroy();
+}
+
+/*! \brief Test that snapshots keep their pixels while the canvas changes and undo marks tiles dirty.
+*/
+TEST_CASE("Snapshot the canvas", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    app.SetRasterMode(true);
+    TileCanvas blank = app.Snapshot();
+    app.PushGesture(_addLines(app, 10));
+    TileCanvas drawn = app.Snapshot();
+    REQUIRE(blank.GetPixel(5, 100) == sf::Color::White);
+    REQUIRE(drawn.GetPixel(5, 100) == sf::Color::Black);
+    REQUIRE(drawn.SharesTile(blank, drawn.GetTileIndex(1000, 600)));
+    REQUIRE_FALSE(drawn.SharesTile(blank, drawn.GetTileIndex(5, 100)));
+    app.UndoCommand();
+    REQUIRE(app.Snapshot().GetPixel(5, 100) == sf::Color::White);
+    REQUIRE(drawn.GetPixel(5, 100) == sf::Color::Black);
+    app.Destroy();
+}
+
+/*! \brief Benchmark undo and redo of one 50k segment stroke, which should not depend on its length.
+*/
+TEST_CASE("Benchmark undo of a 50k segment gesture", "[App] [!benchmark]") {
+    App app = App();
+    app.Init(&_initialization);
+    app.PushGesture(_addLines(app, 50000));
+    REQUIRE(app.GetLineCount() == 50000);
+
+    BENCHMARK("Undo + redo 50k segment gesture") {
+        app.UndoCommand();
+        return app.RedoCommand();
+    };
+    REQUIRE(app.GetLineCount() == 50000);
+    app.Destroy();
+}
+
+// Draw gestures raster mode strokes all over the canvas.
+void _drawRasterStrokes(App& app, int gestures) {
+    app.SetRasterMode(true);
+    for (int g = 0; g < gestures; g++) {
+        app.PushGesture(_addLines(app, 40, (float)(g * 97 % 1200), (float)(g * 53 % 700)));
+    }
+}
+
+/*! \brief Test that switching between long raster branches goes through the image checkpoints.
+*/
+TEST_CASE("Switch between long raster branches", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    _drawRasterStrokes(app, 40);
+    const sf::Uint32 first = app.GetGestureCursor();
+    sf::Image firstImage = app.GetImage();
+    for (int g = 0; g < 40; g++) {
+        app.UndoCommand();
+    }
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num5);
+    for (int g = 0; g < 70; g++) {
+        app.PushGesture(_addLines(app, 40, (float)(g * 31 % 1200), (float)(g * 17 % 700)));
+    }
+    const sf::Uint32 second = app.GetGestureCursor();
+    sf::Image secondImage = app.GetImage();
+    REQUIRE(app.SwitchGesture(first) == 110);
+    REQUIRE(_sameCanvas(app.GetImage(), firstImage));
+    REQUIRE(app.SwitchGesture(second) == 110);
+    REQUIRE(_sameCanvas(app.GetImage(), secondImage));
+    REQUIRE(app.SwitchGesture(first - 20) == 90);
+    REQUIRE(app.SwitchGesture(first) == 20);
+    REQUIRE(_sameCanvas(app.GetImage(), firstImage));
+    app.Destroy();
+}
+
+/*! \brief Test that checkpoints over the history budget are dropped and switching still works without them.
+*/
+TEST_CASE("Checkpoints count against the history budget", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    _drawRasterStrokes(app, 70);
+    const sf::Uint32 last = app.GetGestureCursor();
+    sf::Image lastImage = app.GetImage();
+    const size_t withCheckpoints = app.GetSnapshotBytes();
+    app.SetHistoryBudget(0);
+    REQUIRE(app.GetSnapshotBytes() < withCheckpoints);
+    REQUIRE(app.SwitchGesture(App::NO_GESTURE) == 70);
+    REQUIRE(app.SwitchGesture(last) == 70);
+    REQUIRE(_sameCanvas(app.GetImage(), lastImage));
+    app.Destroy();
+}
+
+/*! \brief Test that undo data over the memory budget is spilled and comes back on deep undo.
+*/
+TEST_CASE("Undo history stays within its memory budget", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    sf::Image blank = app.GetImage();
+    app.SetHistoryBudget(0);
+    _drawRasterStrokes(app, 30);
+    sf::Image drawn = app.GetImage();
+    // Only the gesture next to the undo cursor stays in memory.
+    REQUIRE(app.GetHistoryBytes() < 4096);
+    REQUIRE(app.GetSpillFileSize() > 0);
+    for (int g = 0; g < 30; g++) {
+        REQUIRE(app.UndoCommand() == 1);
+        REQUIRE(app.GetHistoryBytes() < 8192);
+    }
+    REQUIRE(std::equal(blank.getPixelsPtr(), blank.getPixelsPtr() + 1280 * 720 * 4, app.GetImage().getPixelsPtr()));
+    while (app.RedoCommand() > 0) {}
+    REQUIRE(std::equal(drawn.getPixelsPtr(), drawn.getPixelsPtr() + 1280 * 720 * 4, app.GetImage().getPixelsPtr()));
+    // A new canvas drops the history and its scratch file.
+    REQUIRE(app.NewCanvas(1280, 720));
+    REQUIRE(app.GetSpillFileSize() == 0);
+    app.Destroy();
+}
+
+/*! \brief Test that the line segments of the history count against its memory budget.
+*/
+TEST_CASE("Line segments count against the history budget", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    _drawRasterStrokes(app, 10);
+    REQUIRE(app.GetSpillFileSize() == 0);
+    app.SetHistoryBudget(app.GetHistoryBytes());
+    app.SetRasterMode(false);
+    for (int g = 0; g < 20; g++) {
+        app.PushGesture(_addLines(app, 40, (float)(g * 31 % 1200), (float)(g * 17 % 700)));
+    }
+    REQUIRE(app.GetLineCount() == 800);
+    REQUIRE(app.GetSpillFileSize() > 0);
+    REQUIRE(app.GetHistoryBytes() >= 800 * sizeof(RoundedLine));
+    app.Destroy();
+}
+
+/*! \brief Benchmark how long a deep undo takes when its gestures come back from the scratch file.
+*/
+TEST_CASE("Benchmark undo of spilled gestures", "[App] [!benchmark]") {
+    for (size_t budget : {App::DEFAULT_HISTORY_BUDGET, (size_t)0}) {
+        App app = App();
+        app.Init(&_initialization);
+        app.SetHistoryBudget(budget);
+        _drawRasterStrokes(app, 200);
+        auto start = std::chrono::steady_clock::now();
+        while (app.UndoCommand() > 0) {}
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        WARN((budget == 0 ? "spilled" : "in memory") << ": " << seconds / 200 * 1e6 << " us per undo, "
+             << app.GetHistoryBytes() << " bytes in memory, " << app.GetSpillFileSize() << " bytes spilled");
+        app.Destroy();
+    }
+}
+/*! \brief Test that a session is recovered from its journal.
+*/
+TEST_CASE("Recover a session from the journal", "[App] [Core]") {
+    const std::string path = "AppTest.journal";
+    std::remove(path.c_str());
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE(app.OpenJournal(path, 0) == 0);
+    app.PushGesture(_addLines(app, 20, 10, 50));
+    app.PushGesture(_addLines(app, 5, 400.5f, 300.25f));
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num3);
+    REQUIRE(app.FillCommand(600, 600) == 1);
+    manualUpdateAndDraw1(app);
+    manualUpdateAndDraw2(app);
+    app.PushGesture(0);
+    _drawRasterStrokes(app, 3);
+    app.SetRasterMode(false);
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.RedoCommand() == 1);
+    sf::Image expected = app.Flatten();
+    const size_t lineCount = app.GetLineCount();
+    app.Destroy();
+
+    App recovered = App();
+    recovered.Init(&_initialization);
+    REQUIRE(recovered.OpenJournal(path) > 0);
+    REQUIRE(recovered.GetLineCount() == lineCount);
+    sf::Image image = recovered.Flatten();
+    REQUIRE(std::equal(expected.getPixelsPtr(), expected.getPixelsPtr() + 1280 * 720 * 4, image.getPixelsPtr()));
+    // The undo history is recovered too: one raster stroke can still be redone.
+    REQUIRE(recovered.RedoCommand() == 1);
+    REQUIRE(recovered.RedoCommand() == 0);
+    recovered.Destroy();
+    std::remove(path.c_str());
+}
+
+/*! \brief Test that branch switches are journaled and recovered.
+*/
+TEST_CASE("Recover a branch switch from the journal", "[App] [Core]") {
+    const std::string path = "AppTest.journal";
+    std::remove(path.c_str());
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE(app.OpenJournal(path, 0) == 0);
+    _drawRasterStrokes(app, 5);
+    const sf::Uint32 first = app.GetGestureCursor();
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.UndoCommand() == 1);
+    app.SetRasterMode(false);
+    app.PushGesture(_addLines(app, 6, 300, 300));
+    REQUIRE(app.SwitchGesture(first) == 3);
+    sf::Image expected = app.Flatten();
+    app.Destroy();
+
+    App recovered = App();
+    recovered.Init(&_initialization);
+    REQUIRE(recovered.OpenJournal(path) > 0);
+    REQUIRE(recovered.GetGestureCursor() == first);
+    REQUIRE(recovered.GetGestureCount() == 6);
+    REQUIRE(recovered.GetLineCount() == 0);
+    REQUIRE(_sameCanvas(recovered.Flatten(), expected));
+    recovered.Destroy();
+    std::remove(path.c_str());
+}
+
+/*! \brief Test that saving cuts the journal back, and that it recovers from the saved document.
+*/
+TEST_CASE("Recover from the journal after a save", "[App] [Core]") {
+    const std::string path = "AppTest.journal";
+    const std::string document = "AppTestJournal.mpd";
+    std::remove(path.c_str());
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE(app.OpenJournal(path, 0) == 0);
+    _drawRasterStrokes(app, 20);
+    app.SetRasterMode(false);
+    app.PushGesture(_addLines(app, 10, 50, 50));
+    REQUIRE(app.SaveDocument(document));
+    std::vector<std::vector<sf::Uint8>> records;
+    size_t validSize;
+    REQUIRE(app.FlushJournal());
+    REQUIRE(Journal::ReadRecords(path, records, validSize));
+    REQUIRE(records.size() == 1);
+    app.PushGesture(_addLines(app, 5, 300, 300));
+    _drawRasterStrokes(app, 2);
+    REQUIRE(app.UndoCommand() == 1);
+    sf::Image expected = app.Flatten();
+    const size_t lineCount = app.GetLineCount();
+    app.Destroy();
+
+    App recovered = App();
+    recovered.Init(&_initialization);
+    REQUIRE(recovered.OpenJournal(path) == 5);
+    REQUIRE(recovered.GetLineCount() == lineCount);
+    REQUIRE(_sameCanvas(recovered.Flatten(), expected));
+    REQUIRE(recovered.RedoCommand() == 1);
+    // An undo past the save can not be replayed from the document, so the journal stops there.
+    REQUIRE(recovered.UndoCommand() == 1);
+    REQUIRE(recovered.UndoCommand() == 1);
+    REQUIRE(recovered.UndoCommand() == 5);
+    sf::Image saved = recovered.Flatten();
+    REQUIRE(recovered.UndoCommand() == 10);
+    recovered.PushGesture(_addLines(recovered, 5, 600, 300));
+    recovered.Destroy();
+
+    App stopped = App();
+    stopped.Init(&_initialization);
+    REQUIRE(stopped.OpenJournal(path) == 9);
+    REQUIRE(_sameCanvas(stopped.Flatten(), saved));
+    stopped.Destroy();
+    std::remove(path.c_str());
+    std::remove(document.c_str());
+}
+
+/*! \brief Test that the journal starts over from a new canvas or an opened document and keeps journaling on it.
+*/
+TEST_CASE("Recover from the journal after opening a document", "[App] [Core]") {
+    const std::string path = "AppTest.journal";
+    const std::string document = "AppTestJournal.mpd";
+    std::remove(path.c_str());
+    App app = App();
+    app.Init(&_initialization);
+    app.PushGesture(_addLines(app, 10, 50, 50));
+    REQUIRE(app.SaveDocument(document));
+    REQUIRE(app.OpenJournal(path, 0) == 0);
+    app.PushGesture(_addLines(app, 5, 300, 300));
+    REQUIRE(app.NewCanvas(2000, 1500));
+    app.PushGesture(_addLines(app, 7, 100, 100));
+    app.Destroy();
+
+    // Only the new canvas and what was drawn on it are journaled.
+    App blank = App();
+    blank.Init(&_initialization);
+    REQUIRE(blank.OpenJournal(path) == 2);
+    REQUIRE(blank.GetCanvasSize() == sf::Vector2i(2000, 1500));
+    REQUIRE(blank.GetLineCount() == 7);
+    REQUIRE(blank.OpenDocument(document));
+    blank.PushGesture(_addLines(blank, 3, 600, 300));
+    sf::Image expected = blank.Flatten();
+    blank.Destroy();
+
+    App opened = App();
+    opened.Init(&_initialization);
+    REQUIRE(opened.OpenJournal(path) == 2);
+    REQUIRE(opened.GetLineCount() == 13);
+    REQUIRE(_sameCanvas(opened.Flatten(), expected));
+    opened.Destroy();
+    std::remove(path.c_str());
+    std::remove(document.c_str());
+}
+
+/*! \brief Test that a journal is replayed on the canvas it was started on, and refused if its document changed size.
+*/
+TEST_CASE("Recover the journal onto its own canvas", "[App] [Core]") {
+    const std::string path = "AppTest.journal";
+    const std::string document = "AppTestJournal.mpd";
+    std::remove(path.c_str());
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE(app.NewCanvas(3000, 2000));
+    REQUIRE(app.OpenJournal(path, 0) == 0);
+    app.PushGesture(_addLines(app, 10, 50, 50));
+    sf::Image expected = app.Flatten();
+    app.Destroy();
+
+    // Started on another canvas, the journal still rebuilds its own.
+    App recovered = App();
+    recovered.Init(&_initialization);
+    REQUIRE(recovered.OpenJournal(path) == 2);
+    REQUIRE(recovered.GetCanvasSize() == sf::Vector2i(3000, 2000));
+    REQUIRE(_sameCanvas(recovered.Flatten(), expected));
+    REQUIRE(recovered.SaveDocument(document));
+    recovered.PushGesture(_addLines(recovered, 5, 300, 300));
+    recovered.Destroy();
+
+    // The document the journal starts from is replaced by one of another size.
+    App other = App();
+    other.Init(&_initialization);
+    REQUIRE(other.NewCanvas(100, 100));
+    REQUIRE(other.SaveDocument(document));
+    other.Destroy();
+    App refused = App();
+    refused.Init(&_initialization);
+    REQUIRE(refused.OpenJournal(path) == -1);
+    refused.Destroy();
+    std::remove(path.c_str());
+    std::remove(document.c_str());
+}
+
+/*! \brief Benchmark recovery time against the length of the journal.
+*/
+TEST_CASE("Benchmark journal recovery", "[App] [!benchmark]") {
+    const std::string path = "AppTest.journal";
+    for (int gestures : {100, 1000, 10000}) {
+        std::remove(path.c_str());
+        App app = App();
+        app.Init(&_initialization);
+        app.OpenJournal(path);
+        for (int g = 0; g < gestures; g++) {
+            app.PushGesture(_addLines(app, 20, (float)(g % 1200), (float)(g % 700)));
+        }
+        app.Destroy();
+
+        App recovered = App();
+        recovered.Init(&_initialization);
+        auto start = std::chrono::steady_clock::now();
+        int records = recovered.OpenJournal(path);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::FILE* file = std::fopen(path.c_str(), "rb");
+        std::fseek(file, 0, SEEK_END);
+        long size = std::ftell(file);
+        std::fclose(file);
+        WARN(gestures << " gestures of 20 lines: " << records << " records, " << size << " bytes, recovered in "
+             << seconds * 1e3 << " ms");
+        REQUIRE(recovered.GetLineCount() == (size_t)gestures * 20);
+        recovered.Destroy();
+    }
+    std::remove(path.c_str());
+}
+
+/*! \brief Benchmark switching between two branches of 500 raster gestures each.
+*/
+TEST_CASE("Benchmark branch switching", "[App] [!benchmark]") {
+    App app = App();
+    app.Init(&_initialization);
+    _drawRasterStrokes(app, 500);
+    const sf::Uint32 first = app.GetGestureCursor();
+    for (int g = 0; g < 500; g++) {
+        app.UndoCommand();
+    }
+    _drawRasterStrokes(app, 500);
+    const sf::Uint32 second = app.GetGestureCursor();
+
+    BENCHMARK("Switch between two 500 gesture branches") {
+        app.SwitchGesture(first);
+        return app.SwitchGesture(second);
+    };
+    BENCHMARK("Undo 500 gestures and redo 500 gestures") {
+        for (int g = 0; g < 500; g++) {
+            app.UndoCommand();
+        }
+        int redone = 0;
+        for (int g = 0; g < 500; g++) {
+            redone += app.RedoCommand();
+        }
+        return redone;
+    };
+    app.Destroy();
+}
+
+// Mouse samples of a zigzag stroke starting at (x, y). Every sample is taken twice, like
+// the events the window sends while the mouse is held down without moving.
+std::vector<sf::Vector2i> _zigzag(int samples, int x, int y) {
+    std::vector<sf::Vector2i> points;
+    for (int i = 0; i < samples; i++) {
+        sf::Vector2i point(x + (i * 7) % 900, y + (i % 2) * 40 + i / 130 * 3);
+        points.push_back(point);
+        points.push_back(point);
+    }
+    return points;
+}
+
+// Draw a stroke through points on the UI thread, like main.cpp did before the pipeline,
+// with the segments the tessellation stage smooths it into.
+void _strokeInline(App& app, const std::vector<sf::Vector2i>& points) {
+    // Line mode items pass the raster stage by, so the pipeline only tessellates.
+    sf::Image unused;
+    unused.create(1, 1);
+    StrokePipeline tessellator(unused, nullptr);
+    int count = 0;
+    StrokeItem done;
+    auto collect = [&app, &tessellator, &count, &done] {
+        while (tessellator.Collect(done)) {
+            if (done.kind == StrokeItem::POINT) {
+                app.AddCommand(std::move(done.line));
+                count += app.ExecuteCommand();
+            }
+        }
+    };
+    for (size_t i = 0; i <= points.size(); i++) {
+        StrokeItem item;
+        if (i < points.size()) {
+            item.point = sf::Vector2f(points[i]);
+            item.width = app.GetPaintbrushRadius() * 2;
+            item.color = app.GetPaintbrushColor();
+            item.owner = 1234;
+        } else {
+            item.kind = StrokeItem::END;
+        }
+        while (!tessellator.Submit(item)) {
+            collect();
+        }
+    }
+    while (!tessellator.IsIdle()) {
+        std::this_thread::yield();
+        collect();
+    }
+    app.PushGesture(count);
+}
+
+// Submit a stroke through points to the stroke pipeline.
+void _strokePipelined(App& app, const std::vector<sf::Vector2i>& points) {
+    for (const sf::Vector2i& point : points) {
+        app.SubmitPoint(point.x, point.y, 1234);
+    }
+    app.SubmitStrokeEnd();
+}
+
+/*! \brief Test that strokes and fills through the pipeline end up like the ones drawn on the UI thread.
+*/
+TEST_CASE("Draw strokes and fills through the stroke pipeline", "[App] [Core]") {
+    App inlineApp = App();
+    inlineApp.Init(&_initialization);
+    App app = App();
+    app.Init(&_initialization);
+    for (App* a : {&inlineApp, &app}) {
+        a->SetPaintbrushRadius(7);
+    }
+    const std::vector<sf::Vector2i> lines = _zigzag(300, 20, 100);
+    const std::vector<sf::Vector2i> raster = _zigzag(300, 40, 400);
+
+    _strokeInline(inlineApp, lines);
+    inlineApp.SetPaintbrushColor(sf::Keyboard::Key::Num3);
+    inlineApp.FillCommand(5, 5);
+    inlineApp.SetPaintbrushColor(sf::Keyboard::Key::Num5);
+    inlineApp.SetRasterMode(true);
+    _strokeInline(inlineApp, raster);
+
+    _strokePipelined(app, lines);
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num3);
+    app.SubmitFill(5, 5);
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num5);
+    app.SetRasterMode(true);
+    _strokePipelined(app, raster);
+
+    REQUIRE(_sameCanvas(app.Flatten(), inlineApp.Flatten()));
+    REQUIRE(_sameCanvas(app.GetImage(), inlineApp.GetImage()));
+    REQUIRE(app.GetLineCount() == inlineApp.GetLineCount());
+    REQUIRE(inlineApp.GetGestureCount() == 3);
+    REQUIRE(app.GetGestureCount() == 3);
+    // The pipeline's gestures undo like any other.
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.UndoCommand() == (int)inlineApp.GetLineCount());
+    sf::Image white;
+    white.create(1280, 720, sf::Color::White);
+    REQUIRE(_sameCanvas(app.Flatten(), white));
+    inlineApp.Destroy();
+    app.Destroy();
+}
+
+/*! \brief Test that the strokes submitted before a crash are journaled and recovered.
+*/
+TEST_CASE("Recover pipelined strokes from the journal", "[App] [Core]") {
+    const std::string path = "AppTest.journal";
+    std::remove(path.c_str());
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE(app.OpenJournal(path, 0) == 0);
+    _strokePipelined(app, _zigzag(50, 100, 100));
+    app.SetRasterMode(true);
+    _strokePipelined(app, _zigzag(50, 100, 300));
+    sf::Image expected = app.Flatten();
+    app.Destroy();
+
+    App recovered = App();
+    recovered.Init(&_initialization);
+    REQUIRE(recovered.OpenJournal(path) > 0);
+    REQUIRE(recovered.GetGestureCount() == 2);
+    REQUIRE(_sameCanvas(recovered.Flatten(), expected));
+    recovered.Destroy();
+    std::remove(path.c_str());
+}
+
+/*! \brief Benchmark the time the UI thread spends on a heavy raster stroke, inline and pipelined.
+*   The mouse is sampled 16 times a frame, and the time between frames is not counted.
+*/
+TEST_CASE("Benchmark UI thread time of a raster stroke", "[App] [!benchmark]") {
+    const std::vector<sf::Vector2i> points = _zigzag(5000, 100, 100);
+    const size_t samplesPerFrame = 16;
+    for (int pipelined = 0; pipelined < 2; pipelined++) {
+        App app = App();
+        app.Init(&_initialization);
+        app.SetPaintbrushRadius(15);
+        app.SetRasterMode(true);
+        double uiMs = 0;
+        double slowestFrameMs = 0;
+        for (size_t frame = 0; frame < points.size(); frame += samplesPerFrame) {
+            const auto start = std::chrono::steady_clock::now();
+            for (size_t i = frame; i < std::min(frame + samplesPerFrame, points.size()); i++) {
+                if (pipelined) {
+                    app.SubmitPoint(points[i].x, points[i].y, 1234);
+                } else if (i == 0 || points[i] != points[i - 1]) {
+                    app.AddCommand(std::unique_ptr<RoundedLine>(new RoundedLine(sf::Vector2f(points[i > 0 ? i - 1 : i]), sf::Vector2f(points[i]), 30, sf::Color::Black, 1234)));
+                    app.ExecuteCommand();
+                }
+            }
+            // The main loop collects once per frame.
+            app.CollectStrokes();
+            const double frameMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            uiMs += frameMs;
+            slowestFrameMs = std::max(slowestFrameMs, frameMs);
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        app.PushGesture(0);
+        WARN((pipelined ? "Pipelined: " : "Inline: ") << uiMs << " ms on the UI thread for " << points.size()
+             << " samples, slowest frame " << slowestFrameMs << " ms");
+        app.Destroy();
+    }
+}
+
+/*! \brief Test that line segments queued from several threads are all executed by the UI thread.
+*/
+TEST_CASE("Queue line segments from several threads", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    const int producers = 4;
+    const int linesEach = 20000;
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&app, p] {
+            for (int i = 0; i < linesEach; i++) {
+                const sf::Vector2f point((float)(i % 1000), (float)(100 + p * 100));
+                app.AddCommand(std::unique_ptr<RoundedLine>(new RoundedLine(point, point + sf::Vector2f(1, 0), 6, sf::Color::Black, (short)p)));
+            }
+        });
+    }
+    int executed = 0;
+    while (executed < producers * linesEach) {
+        const int count = app.ExecuteCommand();
+        if (count == 0) {
+            std::this_thread::yield();
+        }
+        executed += count;
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    REQUIRE(app.ExecuteCommand() == 0);
+    REQUIRE(app.GetLineCount() == (size_t)(producers * linesEach));
+    app.PushGesture(executed);
+    REQUIRE(app.UndoCommand() == producers * linesEach);
+    app.Destroy();
+}
+
+/*! \brief Test that the UI thread queueing more line segments than the queue holds executes them instead of waiting.
+*/
+TEST_CASE("Queue more line segments than fit from the UI thread", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    const size_t lines = App::COMMAND_QUEUE_CAPACITY + 100;
+    for (size_t i = 0; i < lines; i++) {
+        const sf::Vector2f point((float)(i % 1000), 100);
+        app.AddCommand(std::unique_ptr<RoundedLine>(new RoundedLine(point, point + sf::Vector2f(1, 0), 6, sf::Color::Black, 1234)));
+    }
+    REQUIRE(app.GetLineCount() > 0);
+    app.ExecuteCommand();
+    REQUIRE(app.GetLineCount() == lines);
+    app.PushGesture((int)lines);
+    REQUIRE(app.UndoCommand() == (int)lines);
+    app.Destroy();
+}
+
+// Scrub to gesture id and wait for the timeline to render its image.
+const sf::Image& _scrub(App& app, sf::Uint32 id) {
+    app.ScrubTo(id);
+    while (!app.CollectScrub() || app.GetScrubGesture() != id) {
+        std::this_thread::yield();
+    }
+    return app.GetScrubImage();
+}
+
+/*! \brief Test that scrubbing the timeline shows each gesture of every branch like switching to it does.
+*/
+TEST_CASE("Scrub the timeline to any gesture", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    const sf::Image blank = app.Flatten();
+    app.PushGesture(_addLines(app, 5));
+    _drawRasterStrokes(app, 40);
+    app.SetRasterMode(false);
+    app.PushGesture(_addLines(app, 3, 0, 500));
+    REQUIRE(app.FillCommand(640, 650) == 1);
+    for (int g = 0; g < 10; g++) {
+        app.UndoCommand();
+    }
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num3);
+    _drawRasterStrokes(app, 5);
+    app.SetRasterMode(false);
+    app.PushGesture(_addLines(app, 2, 0, 300));
+    const sf::Uint32 cursor = app.GetGestureCursor();
+    REQUIRE(app.GetGestureCount() == 49);
+
+    // Scrubbing renders off the canvas, so the cursor and the image stay where they were.
+    const sf::Image current = app.Flatten();
+    REQUIRE(_sameCanvas(_scrub(app, App::NO_GESTURE), blank));
+    REQUIRE(app.GetScrubLineCount() == 0);
+    std::vector<sf::Uint32> ids{0, 1, 20, 32, 33, 40, 41, 42, 44, 47, 48};
+    std::vector<sf::Image> scrubbed;
+    std::vector<size_t> lineCounts;
+    std::vector<sf::Image> rendered;
+    for (sf::Uint32 id : ids) {
+        scrubbed.push_back(_scrub(app, id));
+        lineCounts.push_back(app.GetScrubLineCount());
+        rendered.push_back(app.RenderGesture(id));
+    }
+    REQUIRE(app.GetGestureCursor() == cursor);
+    REQUIRE(_sameCanvas(app.Flatten(), current));
+    for (size_t i = 0; i < ids.size(); i++) {
+        REQUIRE(app.SwitchGesture(ids[i]) >= 0);
+        REQUIRE(_sameCanvas(app.GetImage(), scrubbed[i]));
+        REQUIRE(app.GetLineCount() == lineCounts[i]);
+        REQUIRE(_sameCanvas(app.Flatten(), rendered[i]));
+    }
+    REQUIRE(app.ScrubTo(49) == -1);
+    app.Destroy();
+}
+
+/*! \brief Test that the timeline reads spilled undo data back and the history is not spilled under it.
+*/
+TEST_CASE("Scrub the timeline through spilled gestures", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    app.SetHistoryBudget(0);
+    _drawRasterStrokes(app, 20);
+    const sf::Image drawn = app.GetImage();
+    const sf::Image& scrubbed = _scrub(app, 10);
+    app.SwitchGesture(10);
+    REQUIRE(_sameCanvas(scrubbed, app.GetImage()));
+    REQUIRE(_sameCanvas(_scrub(app, 19), drawn));
+    app.Destroy();
+}
+
+/*! \brief Benchmark scrubbing a 100k gesture history: the UI thread time of a scrub request, and
+*          how long the worker takes to render a position.
+*/
+TEST_CASE("Benchmark timeline scrubbing of a 100k gesture history", "[App] [!benchmark]") {
+    App app = App();
+    app.Init(&_initialization);
+    // Three one segment strokes for every raster stroke, spread over the canvas.
+    for (int g = 0; g < 25000; g++) {
+        app.SetRasterMode(false);
+        for (int s = 0; s < 3; s++) {
+            app.PushGesture(_addLines(app, 1, (float)((g * 97 + s * 13) % 1200), (float)((g * 53 + s * 7) % 700)));
+        }
+        app.SetRasterMode(true);
+        app.PushGesture(_addLines(app, 1, (float)(g * 31 % 1200), (float)(g * 17 % 700)));
+    }
+    REQUIRE(app.GetGestureCount() == 100000);
+
+    // A drag across the slider: one request per frame, each replacing the last.
+    const int positions = 600;
+    auto start = std::chrono::steady_clock::now();
+    double longestRequest = 0;
+    for (int i = 0; i < positions; i++) {
+        auto requestStart = std::chrono::steady_clock::now();
+        app.ScrubTo((sf::Uint32)((size_t)i * 99999 / (positions - 1)));
+        app.CollectScrub();
+        longestRequest = std::max(longestRequest, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - requestStart).count());
+    }
+    const double dragMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    REQUIRE(_sameCanvas(_scrub(app, 99999), app.GetImage()));
+    const double settleMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() - dragMs;
+    WARN(positions << " scrub requests over 100k gestures: " << dragMs / positions << " ms each on the UI thread ("
+         << longestRequest << " ms at most), last position shown " << settleMs << " ms after the drag");
+
+    BENCHMARK("Render the canvas after a random gesture of 100k") {
+        return app.RenderGesture((sf::Uint32)(std::rand() % 100000)).getSize().x;
+    };
+    app.Destroy();
+}
+
+/*! \brief Test that a save writes the canvas as it was when saved, while painting goes on.
+*/
+TEST_CASE("Save the canvas in the background", "[App] [Core]") {
+    const std::string path = "AppTest.png";
+    std::remove(path.c_str());
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE_FALSE(app.SaveImage("AppTest.gif"));
+    app.PushGesture(_addLines(app, 50));
+    REQUIRE(app.FillCommand(600, 600) == 1);
+    app.PushGesture(_addLines(app, 20, 0, 400));
+    const sf::Image saved = app.Flatten();
+    REQUIRE(app.SaveImage(path));
+    // Keep painting, undoing and filling while the exporter encodes.
+    app.PushGesture(_addLines(app, 30, 200, 200));
+    app.UndoCommand();
+    app.UndoCommand();
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num3);
+    app.FillCommand(10, 10);
+    app.WaitForSaves();
+    REQUIRE(app.GetSaveProgress() == 1.0f);
+    REQUIRE(app.CollectSaves() == 1);
+    sf::Image loaded;
+    REQUIRE(loaded.loadFromFile(path));
+    REQUIRE(_sameCanvas(loaded, saved));
+    app.Destroy();
+    std::remove(path.c_str());
+}
+
+/*! \brief Test that an SVG save writes one path for each stroke on the canvas and one for the lines not in a gesture.
+*/
+TEST_CASE("Save the strokes as SVG", "[App] [Core]") {
+    const std::string path = "AppTest.svg";
+    App app = App();
+    app.Init(&_initialization);
+    app.PushGesture(_addLines(app, 50));
+    app.PushGesture(_addLines(app, 20, 0, 400));
+    app.PushGesture(_addLines(app, 10, 0, 500));
+    app.UndoCommand();
+    _addLines(app, 5, 0, 650);
+    app.ExecuteCommand();
+    REQUIRE(app.SaveImage(path));
+    app.WaitForSaves();
+    REQUIRE(app.CollectSaves() == 1);
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    REQUIRE(file != nullptr);
+    std::string svg(1 << 16, '\0');
+    svg.resize(std::fread(&svg[0], 1, svg.size(), file));
+    std::fclose(file);
+    size_t paths = 0;
+    for (size_t at = svg.find("<path "); at != std::string::npos; at = svg.find("<path ", at + 1)) {
+        paths++;
+    }
+    REQUIRE(paths == 3);
+    app.Destroy();
+    std::remove(path.c_str());
+}
+
+/*! \brief Benchmark how long a save keeps the UI thread, against encoding on it, for a canvas
+*          with a raster layer and 50k line segments. It should stay under one 60 Hz frame.
+*/
+TEST_CASE("Benchmark UI thread time of a save", "[App] [!benchmark]") {
+    const std::string path = "AppTest.png";
+    App app = App();
+    app.Init(&_initialization);
+    _drawRasterStrokes(app, 50);
+    app.SetRasterMode(false);
+    for (int g = 0; g < 50; g++) {
+        app.PushGesture(_addLines(app, 1000, 0, (float)(g * 14)));
+    }
+
+    double longestBlock = 0;
+    double totalBlock = 0;
+    const int saves = 10;
+    for (int i = 0; i < saves; i++) {
+        // Paint between saves, so each snapshot has dirty tiles to copy.
+        app.SetRasterMode(true);
+        app.PushGesture(_addLines(app, 40, (float)(i * 100), 300));
+        app.SetRasterMode(false);
+        REQUIRE(app.SaveImage(path));
+        longestBlock = std::max(longestBlock, app.GetSaveBlockTime());
+        totalBlock += app.GetSaveBlockTime();
+    }
+    auto start = std::chrono::steady_clock::now();
+    app.WaitForSaves();
+    const double drainMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    REQUIRE(app.CollectSaves() == saves);
+
+    start = std::chrono::steady_clock::now();
+    REQUIRE(app.Flatten().saveToFile(path));
+    const double inlineMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    WARN("UI thread time per save: " << totalBlock / saves << " ms (" << longestBlock << " ms at most), encoding on the UI thread: "
+         << inlineMs << " ms, " << drainMs << " ms for the background saves to finish");
+    CHECK(longestBlock < 1000.0 / 60);
+    app.Destroy();
+    std::remove(path.c_str());
+}
+
+/*! \brief Test that a saved document opens as the same canvas, with its strokes as gestures
+*          and the history before it gone.
+*/
+TEST_CASE("Save and open a document", "[App] [Core]") {
+    const std::string path = "AppTest.mpd";
+    App app = App();
+    app.Init(&_initialization);
+    app.PushGesture(_addLines(app, 50));
+    REQUIRE(app.FillCommand(600, 600) == 1);
+    app.PushGesture(_addLines(app, 20, 0, 400));
+    _addLines(app, 5, 0, 650);
+    app.ExecuteCommand();
+    const sf::Image saved = app.Flatten();
+    const sf::Image raster = app.GetImage();
+    REQUIRE(app.SaveDocument(path));
+
+    // Draw over it, then open it again.
+    app.PushGesture(_addLines(app, 30, 200, 200));
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num3);
+    app.FillCommand(10, 10);
+    REQUIRE(app.OpenDocument(path));
+    REQUIRE(_sameCanvas(app.GetImage(), raster));
+    REQUIRE(_sameCanvas(app.Flatten(), saved));
+    REQUIRE(app.GetGestureCount() == 3);
+    REQUIRE(app.GetLineCount() == 75);
+
+    // The strokes undo one at a time; the raster layer is the document's.
+    REQUIRE(app.UndoCommand() == 5);
+    REQUIRE(app.GetLineCount() == 70);
+    app.UndoCommand();
+    app.UndoCommand();
+    REQUIRE(app.UndoCommand() == 0);
+    REQUIRE(_sameCanvas(app.Flatten(), raster));
+    REQUIRE_FALSE(app.OpenDocument("AppTest.missing.mpd"));
+    app.Destroy();
+    std::remove(path.c_str());
+}
+
+/*! \brief Test that saving a document larger than the canvas keeps the part of it the canvas does not cover.
+*/
+TEST_CASE("Save a document larger than the canvas", "[App] [Core]") {
+    const std::string path = "AppTest.mpd";
+    {
+        // A 2000 x 1000 document, red but for a blue last tile row and column.
+        DocumentWriter writer;
+        REQUIRE(writer.Open(path, 2000, 1000));
+        sf::Image tile;
+        tile.create(64, 64, sf::Color::Red);
+        sf::Image edge;
+        edge.create(64, 64, sf::Color::Blue);
+        while (writer.GetNextTileRect().top < 1000) {
+            const sf::IntRect rect = writer.GetNextTileRect();
+            const bool last = rect.left + rect.width == 2000 || rect.top + rect.height == 1000;
+            REQUIRE(writer.AddTile((last ? edge : tile).getPixelsPtr(), 64 * 4));
+        }
+        REQUIRE(writer.Finish());
+    }
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE(app.OpenDocument(path));
+    REQUIRE(app.GetImage().getPixel(0, 0) == sf::Color::Red);
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num4);
+    REQUIRE(app.FillCommand(10, 10) == 1);
+    REQUIRE(app.SaveDocument(path));
+    app.Destroy();
+
+    Document document;
+    REQUIRE(document.Open(path));
+    REQUIRE(document.GetWidth() == 2000);
+    REQUIRE(document.GetHeight() == 1000);
+    sf::Image region;
+    region.create(2000, 1000, sf::Color::Black);
+    REQUIRE(document.ReadRegion(0, 0, region));
+    REQUIRE(region.getPixel(1279, 719) == sf::Color::Green);
+    REQUIRE(region.getPixel(1280, 719) == sf::Color::Red);
+    REQUIRE(region.getPixel(1279, 720) == sf::Color::Red);
+    REQUIRE(region.getPixel(1999, 0) == sf::Color::Blue);
+    REQUIRE(region.getPixel(0, 999) == sf::Color::Blue);
+    document.Close();
+    std::remove(path.c_str());
+}
+
+/*! \brief Test that the view pans over a canvas larger than the window, and undo goes back to where each change was made.
+*/
+TEST_CASE("Pan over a canvas larger than the window", "[App] [Core]") {
+    const std::string path = "AppTest.mpd";
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE_FALSE(app.NewCanvas(0, 100));
+    REQUIRE(app.NewCanvas(4000, 3000));
+    REQUIRE(app.GetCanvasSize() == sf::Vector2i(4000, 3000));
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num3);
+    REQUIRE(app.FillCommand(10, 10) == 1);
+    REQUIRE(app.PanTo(2000, 1500));
+    REQUIRE(app.GetViewOrigin() == sf::Vector2i(2000, 1500));
+    REQUIRE(app.GetImage().getPixel(0, 0) == sf::Color::White);
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num4);
+    REQUIRE(app.FillCommand(2100, 1600) == 1);
+
+    // Pan to overlap both fills: the part of the window that stayed in view moved over.
+    REQUIRE(app.PanTo(1000, 600));
+    REQUIRE(app.GetImage().getPixel(0, 0) == sf::Color::Red);
+    REQUIRE(app.GetImage().getPixel(279, 119) == sf::Color::Red);
+    REQUIRE(app.GetImage().getPixel(280, 120) == sf::Color::White);
+    REQUIRE(app.GetImage().getPixel(1000, 900 - 600) == sf::Color::White);
+    REQUIRE(app.Pan(100, 300));
+    REQUIRE(app.GetImage().getPixel(900, 600) == sf::Color::Green);
+    REQUIRE(app.GetImage().getPixel(899, 599) == sf::Color::White);
+
+    // The view stops at the edges of the canvas.
+    REQUIRE(app.PanTo(100000, -5));
+    REQUIRE(app.GetViewOrigin() == sf::Vector2i(4000 - 1280, 0));
+    REQUIRE_FALSE(app.Pan(10, 0));
+
+    // Undo pans back to each fill before taking it out.
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.GetViewOrigin() == sf::Vector2i(2000, 1500));
+    REQUIRE(app.GetImage().getPixel(100, 100) == sf::Color::White);
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.GetViewOrigin() == sf::Vector2i(0, 0));
+    REQUIRE(app.GetImage().getPixel(0, 0) == sf::Color::White);
+    REQUIRE(app.RedoCommand() == 1);
+    REQUIRE(app.RedoCommand() == 1);
+    REQUIRE(app.GetViewOrigin() == sf::Vector2i(2000, 1500));
+    REQUIRE(app.GetImage().getPixel(100, 100) == sf::Color::Green);
+
+    // Strokes are in canvas coordinates, through the stroke pipeline too.
+    app.SetRasterMode(true);
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num1);
+    REQUIRE(app.PanTo(2500, 2000));
+    app.SubmitPoint(2510, 2010, 1234);
+    app.SubmitPoint(2550, 2010, 1234);
+    app.SubmitStrokeEnd();
+    app.PushGesture(_addLines(app, 10, 2500, 2100));
+    REQUIRE(app.GetImage().getPixel(30, 10) == sf::Color::Black);
+    REQUIRE(app.GetImage().getPixel(5, 100) == sf::Color::Black);
+    app.SetRasterMode(false);
+    app.PushGesture(_addLines(app, 10, 2500, 2200));
+    REQUIRE(app.Flatten().getPixel(5, 200) == sf::Color::Black);
+
+    // Only the tiles drawn on take memory, and a document saves the whole canvas.
+    REQUIRE(app.GetCanvasPageBytes() < 100000);
+    REQUIRE(app.SaveDocument(path));
+    REQUIRE(app.OpenDocument(path));
+    REQUIRE(app.GetCanvasSize() == sf::Vector2i(4000, 3000));
+    REQUIRE(app.GetImage().getPixel(0, 0) == sf::Color::Red);
+    REQUIRE(app.PanTo(2000, 1500));
+    REQUIRE(app.GetImage().getPixel(100, 100) == sf::Color::Green);
+    REQUIRE(app.PanTo(2500, 2000));
+    REQUIRE(app.GetImage().getPixel(30, 10) == sf::Color::Black);
+    REQUIRE(app.Flatten().getPixel(5, 200) == sf::Color::Black);
+    app.Destroy();
+    std::remove(path.c_str());
+}
+
+/*! \brief Test that branch switches over changes made in different places of the canvas are journaled and recovered.
+*/
+TEST_CASE("Switch branches made in different places of the canvas", "[App] [Core]") {
+    const std::string path = "AppTest.journal";
+    std::remove(path.c_str());
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE(app.NewCanvas(4000, 3000));
+    REQUIRE(app.OpenJournal(path, 0) == 0);
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num3);
+    REQUIRE(app.FillCommand(10, 10) == 1);
+    REQUIRE(app.PanTo(2000, 1500));
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num4);
+    REQUIRE(app.FillCommand(2100, 1600) == 1);
+    const sf::Uint32 far = app.GetGestureCursor();
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.PanTo(0, 0));
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num5);
+    REQUIRE(app.FillCommand(10, 10) == 1);
+    const sf::Uint32 near = app.GetGestureCursor();
+
+    REQUIRE(app.SwitchGesture(far) == 2);
+    REQUIRE(app.GetViewOrigin() == sf::Vector2i(2000, 1500));
+    REQUIRE(app.GetImage().getPixel(100, 100) == sf::Color::Green);
+    REQUIRE(app.PanTo(0, 0));
+    REQUIRE(app.GetImage().getPixel(0, 0) == sf::Color::Red);
+    REQUIRE(app.RenderGesture(near).getPixel(0, 0) == sf::Color::Blue);
+    REQUIRE(app.RenderGesture(far).getPixel(100, 100) == sf::Color::Green);
+    REQUIRE(app.SwitchGesture(near) == 2);
+    REQUIRE(app.GetImage().getPixel(0, 0) == sf::Color::Blue);
+    REQUIRE(app.SwitchGesture(far) == 2);
+    app.Destroy();
+
+    App recovered = App();
+    recovered.Init(&_initialization);
+    REQUIRE(recovered.NewCanvas(4000, 3000));
+    REQUIRE(recovered.OpenJournal(path) > 0);
+    REQUIRE(recovered.GetGestureCursor() == far);
+    REQUIRE(recovered.GetViewOrigin() == sf::Vector2i(2000, 1500));
+    REQUIRE(recovered.GetImage().getPixel(100, 100) == sf::Color::Green);
+    REQUIRE(recovered.PanTo(0, 0));
+    REQUIRE(recovered.GetImage().getPixel(0, 0) == sf::Color::Red);
+    recovered.Destroy();
+    std::remove(path.c_str());
+}
+
+/*! \brief Benchmark the cost of panning with raster strokes on the way, which should not depend on the canvas size.
+*/
+TEST_CASE("Benchmark panning over canvases of any size", "[App] [!benchmark]") {
+    for (int size : {2048, 16384, 65536}) {
+        App app = App();
+        app.Init(&_initialization);
+        REQUIRE(app.NewCanvas(size, size));
+        app.SetRasterMode(true);
+        double panMs = 0;
+        const int pans = 200;
+        for (int i = 0; i < pans; i++) {
+            const auto start = std::chrono::steady_clock::now();
+            app.Pan(i % 2 == 0 ? 37 : -29, i % 3 == 0 ? -23 : 19);
+            panMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+            const sf::Vector2i origin = app.GetViewOrigin();
+            app.PushGesture(_addLines(app, 20, (float)(origin.x + i * 5 % 1200), (float)(origin.y + i * 3 % 700)));
+        }
+        WARN(size << " x " << size << " canvas: " << panMs / pans << " ms per pan, "
+             << app.GetCanvasPageBytes() / 1024 << " KB of tiles written back");
+        app.Destroy();
+    }
+}
+
+/*! \brief Test that zoomed out the view is the pyramid level of the zoom, kept up to date with the canvas.
+*/
+TEST_CASE("Zoom out over the mip pyramid", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE(app.NewCanvas(4096, 4096));
+    REQUIRE(app.RenderLevel() == nullptr);
+    // Levels down to 64 x 64, the zoom rounded to one of them.
+    app.SetZoom(0.3f);
+    REQUIRE(app.GetZoom() == 0.25f);
+    REQUIRE(app.GetMipLevel() == 2);
+    app.SetZoom(0.0f);
+    REQUIRE(app.GetZoom() == 1.0f / 64.0f);
+
+    // A fill of the whole window at (1280,1280) is a quarter of its size on level 2, around
+    // the center of the view.
+    app.SetZoom(1.0f);
+    REQUIRE(app.PanTo(1280, 1280));
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num3);
+    REQUIRE(app.FillCommand(1300, 1300) == 1);
+    app.SetZoom(0.25f);
+    app.SyncMipPyramid(true);
+    const sf::Image* level = app.RenderLevel();
+    REQUIRE(level != nullptr);
+    REQUIRE(level->getSize() == app.GetImage().getSize());
+    REQUIRE(level->getPixel(480, 270) == sf::Color::Red);
+    REQUIRE(level->getPixel(799, 449) == sf::Color::Red);
+    REQUIRE(level->getPixel(479, 270) == sf::Color::White);
+    REQUIRE(level->getPixel(800, 449) == sf::Color::White);
+    REQUIRE(level->getPixel(0, 0) == sf::Color::White);
+
+    // Changes drawn zoomed out show once the pyramid worker rebuilt their tiles.
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num4);
+    REQUIRE(app.FillCommand(1300, 1300) == 1);
+    app.SyncMipPyramid(true);
+    REQUIRE(app.RenderLevel()->getPixel(480, 270) == sf::Color::Green);
+    // Undo takes them back out of the pyramid too.
+    REQUIRE(app.UndoCommand() == 1);
+    app.SyncMipPyramid(true);
+    REQUIRE(app.RenderLevel()->getPixel(480, 270) == sf::Color::Red);
+    app.Destroy();
+}
+
+/*! \brief Test that changes go to the mip pyramid without being written back, also where the image only covers part of a tile.
+*/
+TEST_CASE("Zoom out over changes not written back", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE(app.NewCanvas(4096, 4096));
+    REQUIRE(app.PanTo(100, 100));
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num3);
+    REQUIRE(app.FillCommand(200, 200) == 1);
+    app.SetZoom(0.5f);
+    app.SyncMipPyramid(true);
+    REQUIRE(app.GetCanvasPageBytes() == 0);
+    // The view is centered on the image, at (-270,-130) of level 1.
+    const sf::Image* level = app.RenderLevel();
+    REQUIRE(level != nullptr);
+    REQUIRE(level->getPixel(325, 185) == sf::Color::Red);
+    REQUIRE(level->getPixel(315, 175) == sf::Color::White);
+    app.Destroy();
+}
+
+/*! \brief Benchmark a zoomed out frame after a pan at each level, which should not grow with the canvas area in view.
+*/
+TEST_CASE("Benchmark zoomed out frames", "[App] [!benchmark]") {
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE(app.NewCanvas(16384, 16384));
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num3);
+    for (int i = 0; i < 8; i++) {
+        app.PanTo(i * 2048, i * 2048);
+        app.FillCommand(i * 2048 + 10, i * 2048 + 10);
+    }
+    app.SyncMipPyramid(true);
+    for (int level = 1; level <= 6; level++) {
+        app.SetZoom(1.0f / (float)(1 << level));
+        const int frames = 20;
+        double frameMs = 0;
+        for (int i = 0; i < frames; i++) {
+            app.Pan(i % 2 == 0 ? 512 : -448, 256);
+            const auto start = std::chrono::steady_clock::now();
+            app.RenderLevel();
+            frameMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        }
+        WARN("Level " << level << ": " << frameMs / frames << " ms to bring a moved frame up to date, showing "
+             << (app.GetImage().getSize().x << level) << " x " << (app.GetImage().getSize().y << level) << " pixels of the canvas");
+    }
+    app.Destroy();
+}
+
+/*! \brief Test that each autosave writes only the tiles and strokes changed since the one before, and restoring it gives the canvas back.
+*/
+TEST_CASE("Autosave only what changed and restore it", "[App] [Core]") {
+    const std::string path = "AppTest.autosave";
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE(app.NewCanvas(4096, 4096));
+    REQUIRE(app.StartAutosave(path, 60 * 1000));
+    app.WaitForAutosave();
+    REQUIRE(app.GetAutosaveCount() == 1);
+    REQUIRE_FALSE(app.AutosaveNow());
+
+    // Strokes only: no tiles.
+    app.PushGesture(_addLines(app, 50));
+    app.PushGesture(_addLines(app, 20, 0, 400));
+    REQUIRE(app.AutosaveNow());
+    app.WaitForAutosave();
+    const size_t strokeBytes = app.GetAutosaveBytes();
+    REQUIRE(strokeBytes > 0);
+    REQUIRE(strokeBytes < 1000);
+
+    // A fill of the window away from the origin is its tiles, each one color.
+    REQUIRE(app.PanTo(1280, 1280));
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num3);
+    REQUIRE(app.FillCommand(1300, 1300) == 1);
+    REQUIRE(app.AutosaveNow());
+    app.WaitForAutosave();
+    REQUIRE(app.GetAutosaveBytes() > 20 * 12 * 4);
+    REQUIRE(app.GetAutosaveBytes() < 20 * 12 * 32);
+
+    // Undoing the fill writes its tiles again, undoing a stroke only cuts the strokes back,
+    // and a raster stroke is the tiles under it.
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.PanTo(0, 0));
+    REQUIRE(app.UndoCommand() == 20);
+    app.SetRasterMode(true);
+    app.PushGesture(_addLines(app, 10, 300, 300));
+    REQUIRE(app.AutosaveNow());
+    app.WaitForAutosave();
+    REQUIRE(app.GetAutosaveCount() == 4);
+    REQUIRE(app.GetAutosaveBytes() < 4 * 1024);
+    const sf::Image flattened = app.Flatten();
+    const size_t gestures = app.GetGestureCount();
+    app.StopAutosave();
+    app.Destroy();
+
+    App restored = App();
+    restored.Init(&_initialization);
+    REQUIRE(restored.RestoreAutosave(path));
+    REQUIRE(restored.GetCanvasSize() == sf::Vector2i(4096, 4096));
+    REQUIRE(_sameCanvas(restored.Flatten(), flattened));
+    REQUIRE(restored.GetLineCount() == 50);
+    REQUIRE(restored.GetGestureCount() == 1);
+    REQUIRE(gestures > 1);
+    REQUIRE(restored.PanTo(1280, 1280));
+    REQUIRE(restored.GetImage().getPixel(500, 500) == sf::Color::White);
+    REQUIRE_FALSE(restored.RestoreAutosave("AppTest.missing.autosave"));
+    restored.Destroy();
+    std::remove(path.c_str());
+    std::remove((path + ".prev").c_str());
+}
+
+/*! \brief Test that an autosave over a saved document only keeps what changed after it, down into the strokes of the document.
+*/
+TEST_CASE("Autosave over a saved document", "[App] [Core]") {
+    const std::string document = "AppTest.mpd";
+    const std::string path = "AppTest.autosave";
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE(app.StartAutosave(path, 60 * 1000));
+    app.PushGesture(_addLines(app, 30));
+    app.PushGesture(_addLines(app, 40, 0, 300));
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num5);
+    REQUIRE(app.FillCommand(600, 600) == 1);
+    REQUIRE(app.SaveDocument(document));
+    app.WaitForAutosave();
+    // The save starts the autosave over with the document as its base, so it is empty.
+    REQUIRE(app.GetAutosaveBytes() < 64);
+
+    // Undo into the strokes of the document, then draw another.
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.UndoCommand() == 40);
+    app.PushGesture(_addLines(app, 15, 0, 500));
+    REQUIRE(app.AutosaveNow());
+    app.WaitForAutosave();
+    REQUIRE(app.GetAutosaveCount() == 3);
+    const sf::Image flattened = app.Flatten();
+    app.Destroy();
+
+    App restored = App();
+    restored.Init(&_initialization);
+    REQUIRE(restored.RestoreAutosave(path));
+    REQUIRE(_sameCanvas(restored.Flatten(), flattened));
+    REQUIRE(restored.GetGestureCount() == 2);
+    REQUIRE(restored.GetLineCount() == 45);
+    restored.Destroy();
+    std::remove(path.c_str());
+    std::remove((path + ".prev").c_str());
+    std::remove(document.c_str());
+}
+
+/*! \brief Benchmark the UI thread time and the bytes of an autosave after a stroke on a large canvas, against saving the document.
+*/
+TEST_CASE("Benchmark autosave after a stroke", "[App] [!benchmark]") {
+    const std::string document = "AppTest.mpd";
+    const std::string path = "AppTest.autosave";
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE(app.NewCanvas(16384, 16384));
+    app.SetRasterMode(true);
+    // Raster strokes all over the canvas, so it has plenty of tiles drawn on.
+    for (int i = 0; i < 64; i++) {
+        app.PanTo(i % 8 * 2048, i / 8 * 2048);
+        const sf::Vector2i origin = app.GetViewOrigin();
+        for (int row = 0; row < 20; row++) {
+            app.PushGesture(_addLines(app, 1000, (float)origin.x, (float)(origin.y + row * 36)));
+        }
+    }
+    REQUIRE(app.StartAutosave(path, 60 * 1000));
+    app.WaitForAutosave();
+    const size_t firstBytes = app.GetAutosaveBytes();
+    double autosaveMs = 0;
+    size_t autosaveBytes = 0;
+    const int saves = 20;
+    for (int i = 0; i < saves; i++) {
+        const sf::Vector2i origin = app.GetViewOrigin();
+        app.PushGesture(_addLines(app, 50, (float)(origin.x + i * 40), (float)(origin.y + 100 + i * 20)));
+        const auto start = std::chrono::steady_clock::now();
+        app.AutosaveNow();
+        autosaveMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        app.WaitForAutosave();
+        autosaveBytes += app.GetAutosaveBytes();
+    }
+    const size_t pageBytes = app.GetCanvasPageBytes();
+    REQUIRE(app.SaveDocument(document));
+    std::FILE* file = std::fopen(document.c_str(), "rb");
+    REQUIRE(file != nullptr);
+    std::fseek(file, 0, SEEK_END);
+    const long documentBytes = std::ftell(file);
+    std::fclose(file);
+    WARN("16384 x 16384 canvas with " << pageBytes / 1024 << " KB of tiles: the first autosave writes "
+         << firstBytes / 1024 << " KB, one after a stroke " << autosaveBytes / saves << " bytes in "
+         << autosaveMs / saves << " ms of the UI thread; the document is " << documentBytes / 1024 << " KB");
+    app.Destroy();
+    std::remove(path.c_str());
+    std::remove((path + ".prev").c_str());
+    std::remove(document.c_str());
+}
+
+/*! \brief Test that an imported image is opened on the canvas once the importer has written it as a document.
+*/
+TEST_CASE("Import an image larger than the canvas", "[App] [Core]") {
+    const std::string source = "AppTest.tga";
+    const std::string document = "AppTest.tga.mpd";
+    {
+        // A 3000 x 2000 top down TGA, red but for a blue bottom right quarter.
+        std::vector<sf::Uint8> bytes{0, 0, 2, 0, 0, 0, 0, 0, 0, 0, 0, 0, 3000 & 0xFF, 3000 >> 8, 2000 & 0xFF, 2000 >> 8, 24, 0x20};
+        for (int y = 0; y < 2000; y++) {
+            for (int x = 0; x < 3000; x++) {
+                const sf::Color color = x >= 1500 && y >= 1000 ? sf::Color::Blue : sf::Color::Red;
+                bytes.insert(bytes.end(), {color.b, color.g, color.r});
+            }
+        }
+        std::FILE* file = std::fopen(source.c_str(), "wb");
+        REQUIRE(file != nullptr);
+        REQUIRE(std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size());
+        std::fclose(file);
+    }
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE(app.CollectImports() == 0);
+    REQUIRE_FALSE(app.ImportImage(source, source));
+    REQUIRE(app.ImportImage(source));
+    REQUIRE(app.ImportImage("AppTest.missing.bmp"));
+    app.WaitForImports();
+    REQUIRE(app.GetImportProgress() == 1.0f);
+    REQUIRE(app.CollectImports() == 2);
+    REQUIRE(app.GetCanvasSize() == sf::Vector2i(3000, 2000));
+    REQUIRE(app.GetImage().getPixel(0, 0) == sf::Color::Red);
+    REQUIRE(app.PanTo(1000, 500));
+    REQUIRE(app.GetImage().getPixel(499, 499) == sf::Color::Red);
+    REQUIRE(app.GetImage().getPixel(500, 500) == sf::Color::Blue);
+    app.Destroy();
+    std::remove(source.c_str());
+    std::remove(document.c_str());
+}
+
+// Push count raster gestures of short strokes spread over the window.
+void _paintGestures(App& app, int count) {
+    for (int i = 0; i < count; i++) {
+        app.PushGesture(_addLines(app, 30, (float)(i * 37 % 1000), (float)(20 + i * 9 % 680)));
+    }
+}
+
+/*! \brief Test that the tiles of the snapshots that went cold are packed, and switching to a checkpoint or drawing over them brings the same pixels back.
+*/
+TEST_CASE("Pack cold tiles of the snapshots", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    app.SetRasterMode(true);
+    _paintGestures(app, 34);
+    // Two gestures after the checkpoint of the 32nd.
+    const sf::Uint32 early = app.GetGestureCursor();
+    const sf::Image atEarly = app.Flatten();
+    _paintGestures(app, 36);
+    const sf::Uint32 last = app.GetGestureCursor();
+    const sf::Image atLast = app.Flatten();
+
+    // Nothing is cold yet but the checkpoint tiles the image moved on from.
+    const size_t raw = app.GetSnapshotBytes();
+    app.PackColdTiles(true);
+    REQUIRE(app.Snapshot().GetPixelBuffer(app.Snapshot().GetTileIndex(1200, 700)) != nullptr);
+    app.SetColdTileTime(0);
+    REQUIRE(app.PackColdTiles(true) > 0);
+    const size_t packed = app.GetSnapshotBytes();
+    REQUIRE(packed * 4 < raw);
+    REQUIRE(app.Snapshot().IsPacked(app.Snapshot().GetTileIndex(1200, 700)));
+
+    // A tile drawn on is not packed again until it was left alone for the cold tile time.
+    app.SetColdTileTime(60 * 1000);
+    app.PushGesture(_addLines(app, 30, 600, 400));
+    app.PackColdTiles(true);
+    TileCanvas snapshot = app.Snapshot();
+    REQUIRE_FALSE(snapshot.IsPacked(snapshot.GetTileIndex(610, 400)));
+    REQUIRE(snapshot.IsPacked(snapshot.GetTileIndex(1200, 700)));
+    REQUIRE(snapshot.GetPixel(610, 400) == sf::Color::Black);
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(_sameCanvas(app.Flatten(), atLast));
+
+    // Switching through the packed checkpoint brings the same pixels back.
+    REQUIRE(app.SwitchGesture(early) > 0);
+    REQUIRE(_sameCanvas(app.Flatten(), atEarly));
+    REQUIRE(app.SwitchGesture(last) > 0);
+    REQUIRE(_sameCanvas(app.Flatten(), atLast));
+    app.Destroy();
+}
+
+/*! \brief Benchmark the memory of the snapshots of a painting session packed, and switching to a checkpoint with its tiles packed.
+*/
+TEST_CASE("Benchmark packing cold snapshot tiles", "[App] [!benchmark]") {
+    App app = App();
+    app.Init(&_initialization);
+    app.SetRasterMode(true);
+    _paintGestures(app, 34);
+    const sf::Uint32 early = app.GetGestureCursor();
+    _paintGestures(app, 166);
+    const sf::Uint32 last = app.GetGestureCursor();
+    auto switchMs = [&app, early, last]() {
+        const auto start = std::chrono::steady_clock::now();
+        app.SwitchGesture(early);
+        const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        app.SwitchGesture(last);
+        return ms;
+    };
+    const double rawSwitch = switchMs();
+    const size_t raw = app.GetSnapshotBytes();
+    app.SetColdTileTime(0);
+    const auto start = std::chrono::steady_clock::now();
+    const size_t swapped = app.PackColdTiles(true);
+    const double packMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const size_t packed = app.GetSnapshotBytes();
+    const double packedSwitch = switchMs();
+    WARN("Snapshots of 200 raster gestures: " << raw / 1024 << " KB of tiles, " << packed / 1024 << " KB with " << swapped
+         << " cold tiles packed (" << (double)raw / packed << "x) in " << packMs << " ms; switching to a checkpoint "
+         << rawSwitch << " ms unpacked, " << packedSwitch << " ms packed");
+    REQUIRE(packed * 4 < raw);
+    app.Destroy();
+}
+
+// Paint a closed ring of black dabs, as pixel batches.
+void _paintRing(App& app) {
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num1);
+    for (int i = 0; i <= 40; i++) {
+        const float angle = (float)i * 6.2831853f / 40.0f;
+        _paintCircle(app, 400 + (int)(150.0f * std::cos(angle)), 300 + (int)(120.0f * std::sin(angle)));
+    }
+    delete app.m_prev_point;
+    app.m_prev_point = nullptr;
+    app.PushGesture(0);
+}
+
+// Fill inside the ring with red and outside it with yellow.
+void _fillRing(App& app) {
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num3);
+    REQUIRE(app.FillCommand(400, 300) == 1);
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num6);
+    REQUIRE(app.FillCommand(10, 10) == 1);
+}
+
+/*! \brief Test that indexed mode keeps the canvas in an eighth of the bytes or less, fills as the image does, and recolors through the palette alone.
+*/
+TEST_CASE("Fill and recolor in indexed mode", "[App] [Core]") {
+    const std::string path = "AppTest.journal";
+    std::remove(path.c_str());
+    App plain = App();
+    plain.Init(&_initialization);
+    _paintRing(plain);
+    _fillRing(plain);
+    const sf::Image filled = plain.Flatten();
+    plain.Destroy();
+
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE(app.OpenJournal(path, 0) == 0);
+    _paintRing(app);
+    const size_t rgbaBytes = app.GetCanvasBytes();
+    REQUIRE(rgbaBytes >= (size_t)1280 * 720 * 4);
+    REQUIRE(app.SetIndexedMode(true));
+    // The indices and the packed checkpoints of the undo history are all the canvas there is.
+    REQUIRE(app.GetImage().getSize().x == 0);
+    REQUIRE(app.GetCanvasBytes() == app.GetIndexedBytes() + app.GetSnapshotBytes());
+    REQUIRE(app.GetCanvasBytes() * 8 <= rgbaBytes);
+    _fillRing(app);
+    REQUIRE(_sameCanvas(app.Flatten(), filled));
+    REQUIRE(app.GetCanvasBytes() * 8 <= rgbaBytes);
+
+    // A recolor only changes the palette: its undo data is a few palette indices, and no
+    // pixels are stored anew.
+    const size_t historyBytes = app.GetHistoryBytes();
+    const size_t canvasBytes = app.GetCanvasBytes();
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num5);
+    REQUIRE(app.RecolorCommand(400, 300) == 1);
+    REQUIRE(app.GetHistoryBytes() - historyBytes <= IndexedCanvas::MAX_COLORS * sizeof(int));
+    REQUIRE(app.GetCanvasBytes() == canvasBytes);
+    REQUIRE(app.Flatten().getPixel(400, 300) == sf::Color::Blue);
+    REQUIRE(app.Flatten().getPixel(10, 10) == sf::Color::Yellow);
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.Flatten().getPixel(400, 300) == sf::Color::Red);
+    REQUIRE(app.RedoCommand() == 1);
+    REQUIRE(app.Flatten().getPixel(400, 300) == sf::Color::Blue);
+    // Into a color the canvas has already. Blue has two palette entries now, its own and
+    // the one recolored to it.
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num6);
+    REQUIRE(app.RecolorCommand(400, 300) == 2);
+    REQUIRE(app.Flatten().getPixel(400, 300) == sf::Color::Yellow);
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num4);
+    REQUIRE(app.FillCommand(400, 300) == 1);
+    REQUIRE(app.Flatten().getPixel(400, 300) == sf::Color::Green);
+    REQUIRE(app.Flatten().getPixel(10, 10) == sf::Color::Yellow);
+
+    // A paintbrush stroke on the indices is one gesture.
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num1);
+    app.SubmitPoint(300, 500, 1234);
+    app.SubmitPoint(500, 500, 1234);
+    app.SubmitStrokeEnd();
+    REQUIRE(app.Flatten().getPixel(400, 500) == sf::Color::Black);
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.Flatten().getPixel(400, 500) == sf::Color::Yellow);
+    REQUIRE(app.RedoCommand() == 1);
+    REQUIRE(app.Flatten().getPixel(400, 500) == sf::Color::Black);
+    const sf::Image expected = app.Flatten();
+    app.Destroy();
+
+    App recovered = App();
+    recovered.Init(&_initialization);
+    REQUIRE(recovered.OpenJournal(path) > 0);
+    REQUIRE(recovered.GetIndexedMode());
+    REQUIRE(_sameCanvas(recovered.Flatten(), expected));
+    recovered.Destroy();
+    std::remove(path.c_str());
+}
+
+/*! \brief Test that a recolor in indexed mode recolors the whole canvas, not only the view.
+*/
+TEST_CASE("Recolor the whole canvas in indexed mode", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE(app.NewCanvas(4000, 3000));
+    REQUIRE(app.SetIndexedMode(true));
+    // Red fills of two views far apart.
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num3);
+    REQUIRE(app.FillCommand(10, 10) == 1);
+    REQUIRE(app.PanTo(2700, 2200));
+    REQUIRE(app.FillCommand(3000, 2500) == 1);
+    const size_t canvasBytes = app.GetCanvasBytes();
+    REQUIRE(canvasBytes * 8 < (size_t)1280 * 720 * 4);
+
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num4);
+    REQUIRE(app.RecolorCommand(3000, 2500) == 1);
+    REQUIRE(app.GetCanvasBytes() == canvasBytes);
+    REQUIRE(app.Flatten().getPixel(300, 300) == sf::Color::Green);
+    REQUIRE(app.PanTo(0, 0));
+    REQUIRE(app.Flatten().getPixel(10, 10) == sf::Color::Green);
+    REQUIRE(app.Flatten().getPixel(1279, 719) == sf::Color::Green);
+    REQUIRE(app.PanTo(1290, 730));
+    REQUIRE(app.Flatten().getPixel(0, 0) == sf::Color::White);
+    // Undone wherever the view is.
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.PanTo(0, 0));
+    REQUIRE(app.Flatten().getPixel(10, 10) == sf::Color::Red);
+
+    // Leaving indexed mode keeps the recolored pixels, far from the view too.
+    REQUIRE(app.RedoCommand() == 1);
+    REQUIRE(app.SetIndexedMode(false));
+    REQUIRE(app.GetImage().getPixel(10, 10) == sf::Color::Green);
+    REQUIRE(app.PanTo(2700, 2200));
+    REQUIRE(app.GetImage().getPixel(300, 300) == sf::Color::Green);
+    app.Destroy();
+}
+
+/*! \brief Test that indexed mode is refused for a canvas of too many colors or with line strokes, and that leaving it brings back the image.
+*/
+TEST_CASE("Leave indexed mode for a canvas of many colors", "[App] [Core]") {
+    App app = App();
+    app.Init(&_initialization);
+    // A stroke of pixels of 20 colors.
+    for (int i = 0; i < 20; i++) {
+        std::unique_ptr<PixelBatch> batch(new PixelBatch(app.GetImage(), sf::Color((sf::Uint8)(i * 10), 5, 5)));
+        batch->add(100 + i, 300);
+        REQUIRE(app.PaintPixels(std::move(batch)) == 1);
+    }
+    REQUIRE_FALSE(app.SetIndexedMode(true));
+    REQUIRE_FALSE(app.GetIndexedMode());
+    REQUIRE(app.GetIndexedBytes() == 0);
+    REQUIRE(app.GetImage().getPixel(119, 300) == sf::Color(190, 5, 5));
+    REQUIRE(app.NewCanvas(1280, 720));
+    _addLines(app, 10);
+    REQUIRE_FALSE(app.SetIndexedMode(true));
+
+    // Back to few colors and no lines, it can go on again.
+    REQUIRE(app.NewCanvas(1280, 720));
+    REQUIRE(app.SetIndexedMode(true));
+    REQUIRE(app.GetRasterMode());
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num3);
+    REQUIRE(app.FillCommand(600, 600) == 1);
+    REQUIRE(app.SetIndexedMode(false));
+    REQUIRE_FALSE(app.GetIndexedMode());
+    REQUIRE(app.GetImage().getSize() == sf::Vector2u(1280, 720));
+    REQUIRE(app.GetImage().getPixel(600, 600) == sf::Color::Red);
+    // The image takes any color again.
+    std::unique_ptr<PixelBatch> batch(new PixelBatch(app.GetImage(), sf::Color(10, 5, 5)));
+    batch->add(100, 100);
+    REQUIRE(app.PaintPixels(std::move(batch)) == 1);
+    REQUIRE(app.GetImage().getPixel(100, 100) == sf::Color(10, 5, 5));
+    app.Destroy();
+}
+
+/*! \brief Test that switching indexed mode on and off is undone and redone like a gesture, keeping the history on both sides of it.
+*/
+TEST_CASE("Undo across a switch of indexed mode", "[App] [Core]") {
+    const std::string path = "AppTest.journal";
+    std::remove(path.c_str());
+    App app = App();
+    app.Init(&_initialization);
+    REQUIRE(app.OpenJournal(path, 0) == 0);
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num3);
+    REQUIRE(app.FillCommand(600, 600) == 1);
+    REQUIRE(app.SetIndexedMode(true));
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num4);
+    REQUIRE(app.FillCommand(600, 600) == 1);
+    REQUIRE(app.SetIndexedMode(false));
+    std::unique_ptr<PixelBatch> batch(new PixelBatch(app.GetImage(), sf::Color::Blue));
+    batch->add(100, 100);
+    REQUIRE(app.PaintPixels(std::move(batch)) == 1);
+    REQUIRE(app.GetGestureCount() == 5);
+    const sf::Image painted = app.Flatten();
+
+    // Undo goes back into indexed mode, with the fill made in it, and out of it again.
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.GetIndexedMode());
+    REQUIRE(app.Flatten().getPixel(600, 600) == sf::Color::Green);
+    REQUIRE(app.Flatten().getPixel(100, 100) == sf::Color::Green);
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.Flatten().getPixel(600, 600) == sf::Color::Red);
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE_FALSE(app.GetIndexedMode());
+    REQUIRE(app.GetImage().getPixel(600, 600) == sf::Color::Red);
+    REQUIRE(app.UndoCommand() == 1);
+    REQUIRE(app.GetImage().getPixel(600, 600) == sf::Color::White);
+    REQUIRE(app.UndoCommand() == 0);
+
+    // Redo and a switch to any gesture come back through both switches.
+    for (int i = 0; i < 5; i++) {
+        REQUIRE(app.RedoCommand() == 1);
+    }
+    REQUIRE_FALSE(app.GetIndexedMode());
+    REQUIRE(_sameCanvas(app.Flatten(), painted));
+    REQUIRE(app.SwitchGesture(App::NO_GESTURE) == 5);
+    REQUIRE(app.GetImage().getPixel(600, 600) == sf::Color::White);
+    REQUIRE(app.SwitchGesture(2) == 3);
+    REQUIRE(app.GetIndexedMode());
+    REQUIRE(app.Flatten().getPixel(600, 600) == sf::Color::Green);
+    REQUIRE(app.SwitchGesture(4) == 2);
+    REQUIRE(_sameCanvas(app.Flatten(), painted));
+    // A branch made before the switch leaves the indices of indexed mode for the other one.
+    REQUIRE(app.SwitchGesture(0) == 4);
+    app.SetPaintbrushColor(sf::Keyboard::Key::Num5);
+    REQUIRE(app.FillCommand(10, 10) == 1);
+    REQUIRE(app.GetImage().getPixel(10, 10) == sf::Color::Blue);
+    REQUIRE(app.SwitchGesture(2) == 3);
+    REQUIRE(app.Flatten().getPixel(10, 10) == sf::Color::Green);
+    REQUIRE(app.SwitchGesture(4) == 2);
+    const sf::Image expected = app.Flatten();
+    app.Destroy();
+
+    App recovered = App();
+    recovered.Init(&_initialization);
+    REQUIRE(recovered.OpenJournal(path) > 0);
+    REQUIRE_FALSE(recovered.GetIndexedMode());
+    REQUIRE(recovered.GetGestureCount() == 6);
+    REQUIRE(_sameCanvas(recovered.Flatten(), expected));
+    recovered.Destroy();
+    std::remove(path.c_str());
+}
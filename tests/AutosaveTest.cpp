@@ -0,0 +1,182 @@
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "Autosave.hpp"
+#include "Journal.hpp"
+#include "StrokeCodec.hpp"
+
+// A save of tiles, each (index, bytes), and of strokes of lines line segments each after the
+// first kept ones.
+std::unique_ptr<Autosave::Job> _autosaveJob(const std::vector<std::pair<int, std::vector<sf::Uint8>>>& tiles, size_t kept, const std::vector<int>& strokes) {
+    std::unique_ptr<Autosave::Job> job(new Autosave::Job);
+    job->tiles = tiles;
+    job->strokesChanged = kept > 0 || !strokes.empty();
+    job->keptStrokes = kept;
+    StrokeWriter writer;
+    for (const int lines : strokes) {
+        writer.BeginStroke((size_t)lines);
+        for (int i = 0; i < lines; i++) {
+            writer.Write(RoundedLine(sf::Vector2f((float)i, 10), sf::Vector2f((float)i + 1, 11), 5, sf::Color::Red, 1));
+        }
+    }
+    job->strokes = writer.GetBytes();
+    return job;
+}
+
+/*! \brief Test that each save only appends what it was given, and loading applies the saves in order.
+*/
+TEST_CASE("Autosave and load back the saves", "[Autosave]") {
+    const std::string path = "AutosaveTest.autosave";
+    Autosave autosave;
+    REQUIRE(autosave.Open(path));
+    std::unique_ptr<Autosave::Job> job = _autosaveJob({{0, std::vector<sf::Uint8>(100, 1)}, {5, std::vector<sf::Uint8>(50, 2)}}, 0, {3, 4});
+    job->restart = true;
+    job->width = 300;
+    job->height = 200;
+    autosave.Save(std::move(job));
+    autosave.Wait();
+    REQUIRE(autosave.GetSaveCount() == 1);
+    const size_t first = autosave.GetLastBytes();
+    REQUIRE(first > 150);
+
+    // Tile 5 drawn on again, the last stroke undone and another drawn.
+    autosave.Save(_autosaveJob({{5, std::vector<sf::Uint8>(20, 3)}}, 1, {2}));
+    autosave.Wait();
+    REQUIRE(autosave.GetSaveCount() == 2);
+    REQUIRE(autosave.GetLastBytes() > 20);
+    REQUIRE(autosave.GetLastBytes() < 100);
+    REQUIRE(autosave.GetTotalBytes() == first + autosave.GetLastBytes());
+    REQUIRE(autosave.GetFileSize() == autosave.GetTotalBytes());
+    REQUIRE(autosave.IsGood());
+
+    Autosave::State state;
+    REQUIRE(Autosave::Load(path, state));
+    REQUIRE(state.saveCount == 2);
+    REQUIRE(state.width == 300);
+    REQUIRE(state.height == 200);
+    REQUIRE(state.base.empty());
+    REQUIRE(state.tiles.size() == 2);
+    REQUIRE(state.tiles[0] == std::vector<sf::Uint8>(100, 1));
+    REQUIRE(state.tiles[5] == std::vector<sf::Uint8>(20, 3));
+    REQUIRE(state.strokeEnds == std::vector<size_t>{3, 5});
+    REQUIRE(state.lines.size() == 5);
+    REQUIRE(state.lines[4]->getColor() == sf::Color::Red);
+    std::remove(path.c_str());
+}
+
+/*! \brief Test that the records of a save without its commit record are left out.
+*/
+TEST_CASE("A torn autosave is dropped whole", "[Autosave]") {
+    const std::string path = "AutosaveTest.autosave";
+    {
+        Autosave autosave;
+        REQUIRE(autosave.Open(path));
+        std::unique_ptr<Autosave::Job> job = _autosaveJob({{1, std::vector<sf::Uint8>(10, 1)}}, 0, {});
+        job->restart = true;
+        job->width = 64;
+        job->height = 64;
+        job->base = "AutosaveTest.mpd";
+        job->baseStrokes = 4;
+        autosave.Save(std::move(job));
+    }
+    // A crash after the tile of the next save was written, but before its commit.
+    {
+        Journal journal;
+        REQUIRE(journal.Open(path));
+        std::vector<sf::Uint8> tile{Autosave::TILE_RECORD, 1, 9, 9};
+        journal.Append(tile);
+        std::vector<sf::Uint8> strokes{Autosave::STROKES_RECORD, 0};
+        journal.Append(strokes);
+    }
+    Autosave::State state;
+    REQUIRE(Autosave::Load(path, state));
+    REQUIRE(state.saveCount == 1);
+    REQUIRE(state.base == "AutosaveTest.mpd");
+    REQUIRE(state.baseStrokes == 4);
+    REQUIRE(state.tiles[1] == std::vector<sf::Uint8>(10, 1));
+    REQUIRE(state.strokeEnds.empty());
+
+    // Only a commit record of its own makes a save count.
+    {
+        Journal journal;
+        REQUIRE(journal.Open(path));
+        std::vector<sf::Uint8> commit{Autosave::COMMIT_RECORD, 2};
+        journal.Append(commit);
+    }
+    REQUIRE(Autosave::Load(path, state));
+    REQUIRE(state.saveCount == 2);
+    REQUIRE(state.tiles[1] == std::vector<sf::Uint8>{9, 9});
+    REQUIRE(state.baseStrokes == 0);
+    std::remove(path.c_str());
+}
+
+/*! \brief Test that a save with a header starts the file over, and a file without one is not an autosave.
+*/
+TEST_CASE("Restart an autosave for a new base", "[Autosave]") {
+    const std::string path = "AutosaveTest.autosave";
+    Autosave autosave;
+    REQUIRE(autosave.Open(path));
+    Autosave::State state;
+    REQUIRE_FALSE(Autosave::Load(path, state));
+    std::unique_ptr<Autosave::Job> job = _autosaveJob({{0, std::vector<sf::Uint8>(1000, 1)}}, 0, {10});
+    job->restart = true;
+    job->width = 64;
+    job->height = 64;
+    autosave.Save(std::move(job));
+    autosave.Save(_autosaveJob({{0, std::vector<sf::Uint8>(1000, 2)}}, 1, {}));
+    job = _autosaveJob({}, 0, {});
+    job->restart = true;
+    job->width = 128;
+    job->height = 64;
+    job->base = "AutosaveTest.mpd";
+    autosave.Save(std::move(job));
+    autosave.Wait();
+    REQUIRE(autosave.GetSaveCount() == 3);
+    REQUIRE(autosave.GetFileSize() < 100);
+    REQUIRE(autosave.GetFileSize() == autosave.GetLastBytes());
+    REQUIRE(Autosave::Load(path, state));
+    REQUIRE(state.saveCount == 1);
+    REQUIRE(state.width == 128);
+    REQUIRE(state.tiles.empty());
+    REQUIRE(state.lines.empty());
+
+    // Saves with no header before them are not of any canvas.
+    std::remove(path.c_str());
+    {
+        Journal journal;
+        REQUIRE(journal.Open(path));
+        std::vector<sf::Uint8> commit{Autosave::COMMIT_RECORD, 1};
+        journal.Append(commit);
+    }
+    REQUIRE_FALSE(Autosave::Load(path, state));
+    std::remove(path.c_str());
+}
+
+/*! \brief Test that opening an autosave keeps the one there before, and a restart leaves no file of its own behind.
+*/
+TEST_CASE("Open an autosave over the one before", "[Autosave]") {
+    const std::string path = "AutosaveTest.autosave";
+    const std::string previous = path + ".prev";
+    std::remove(previous.c_str());
+    {
+        Autosave autosave;
+        REQUIRE(autosave.Open(path));
+        std::unique_ptr<Autosave::Job> job = _autosaveJob({{2, std::vector<sf::Uint8>(30, 7)}}, 0, {});
+        job->restart = true;
+        job->width = 64;
+        job->height = 64;
+        autosave.Save(std::move(job));
+    }
+    REQUIRE(std::fopen((path + ".tmp").c_str(), "rb") == nullptr);
+    Autosave autosave;
+    REQUIRE(autosave.Open(path));
+    Autosave::State state;
+    REQUIRE_FALSE(Autosave::Load(path, state));
+    REQUIRE(Autosave::Load(previous, state));
+    REQUIRE(state.tiles[2] == std::vector<sf::Uint8>(30, 7));
+    std::remove(path.c_str());
+    std::remove(previous.c_str());
+}
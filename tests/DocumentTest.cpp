@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "Document.hpp"
+#include "RoundedLine.hpp"
+#include "StrokeCodec.hpp"
+#include "TileCodec.hpp"
+
+#include <SFML/Graphics.hpp>
+
+// True if the width x height pixels of a and b, rows aStride and bStride bytes apart, are the same.
+bool _samePixels(const sf::Uint8* a, size_t aStride, const sf::Uint8* b, size_t bStride, int width, int height) {
+    for (int y = 0; y < height; y++) {
+        if (!std::equal(a + y * aStride, a + y * aStride + width * 4, b + y * bStride)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// An image with flat regions, a gradient and noise, so tiles hit runs and literals.
+sf::Image _documentImage(unsigned width, unsigned height) {
+    sf::Image image;
+    image.create(width, height, sf::Color::White);
+    for (unsigned y = 0; y < height; y++) {
+        for (unsigned x = 0; x < width; x++) {
+            if (x < width / 3) {
+                continue;
+            }
+            if (x < 2 * width / 3) {
+                image.setPixel(x, y, sf::Color((sf::Uint8)x, (sf::Uint8)y, 128));
+            } else {
+                image.setPixel(x, y, sf::Color((sf::Uint8)(x * 31 + y * 17), (sf::Uint8)(x ^ y), (sf::Uint8)(y / 8 * 40)));
+            }
+        }
+    }
+    return image;
+}
+
+// Write image, with the given strokes, as a document at path.
+bool _writeDocument(const std::string& path, const sf::Image& image, const std::vector<const RoundedLine*>& lines, const std::vector<size_t>& strokeEnds) {
+    DocumentWriter writer;
+    if (!writer.Open(path, (int)image.getSize().x, (int)image.getSize().y)) {
+        return false;
+    }
+    const size_t stride = image.getSize().x * 4;
+    for (int tile = 0; tile < (int)((image.getSize().x + 63) / 64 * ((image.getSize().y + 63) / 64)); tile++) {
+        const sf::IntRect rect = writer.GetNextTileRect();
+        if (!writer.AddTile(image.getPixelsPtr() + rect.top * stride + rect.left * 4, stride)) {
+            return false;
+        }
+    }
+    StrokeWriter strokes;
+    size_t begin = 0;
+    for (size_t strokeEnd : strokeEnds) {
+        strokes.BeginStroke(strokeEnd - begin);
+        for (; begin < strokeEnd; begin++) {
+            strokes.Write(*lines[begin]);
+        }
+    }
+    return writer.AddStrokes(strokes.GetBytes()) && writer.Finish();
+}
+
+/*! \brief Test that a tile decodes to the pixels it was encoded from, and that bad data is refused.
+*/
+TEST_CASE("Tile codec round trip", "[Document]") {
+    const sf::Image image = _documentImage(200, 70);
+    const size_t stride = 200 * 4;
+    for (int left : {0, 60, 130}) {
+        std::vector<sf::Uint8> encoded;
+        TileCodec::Encode(image.getPixelsPtr() + left * 4, stride, 64, 64, encoded);
+        std::vector<sf::Uint8> decoded(64 * 64 * 4);
+        REQUIRE(TileCodec::Decode(encoded.data(), encoded.size(), decoded.data(), 64 * 4, 64, 64));
+        REQUIRE(_samePixels(decoded.data(), 64 * 4, image.getPixelsPtr() + left * 4, stride, 64, 64));
+        REQUIRE_FALSE(TileCodec::Decode(encoded.data(), encoded.size() - 1, decoded.data(), 64 * 4, 64, 64));
+        REQUIRE_FALSE(TileCodec::Decode(encoded.data(), encoded.size(), decoded.data(), 64 * 4, 64, 63));
+    }
+    // A white tile is a single run.
+    std::vector<sf::Uint8> encoded;
+    TileCodec::Encode(image.getPixelsPtr(), stride, 64, 64, encoded);
+    REQUIRE(encoded.size() <= 8);
+}
+
+/*! \brief Test that a document reads back its pixels, clipped edge tiles included, and its strokes.
+*/
+TEST_CASE("Write and read a document", "[Document]") {
+    const std::string path = "DocumentTest.mpd";
+    const sf::Image image = _documentImage(300, 150);
+    RoundedLine first(sf::Vector2f(1.5f, 2), sf::Vector2f(100, 50.25f), 10, sf::Color::Red, 7);
+    RoundedLine second(sf::Vector2f(100, 50.25f), sf::Vector2f(-20, 400), 3, sf::Color(1, 2, 3, 4), -1);
+    RoundedLine third(sf::Vector2f(5, 5), sf::Vector2f(6, 6), 20, sf::Color::Blue, 0);
+    REQUIRE(_writeDocument(path, image, {&first, &second, &third}, {2, 3}));
+
+    Document document;
+    REQUIRE(document.Open(path));
+    REQUIRE(document.GetWidth() == 300);
+    REQUIRE(document.GetHeight() == 150);
+    REQUIRE(document.GetTileCount() == 5 * 3);
+    REQUIRE(document.GetTileRect(14) == sf::IntRect(256, 128, 44, 22));
+
+    // The whole document, and a region hanging over its corner.
+    sf::Image whole;
+    whole.create(300, 150, sf::Color::Black);
+    REQUIRE(document.ReadRegion(0, 0, whole));
+    REQUIRE(_samePixels(whole.getPixelsPtr(), 300 * 4, image.getPixelsPtr(), 300 * 4, 300, 150));
+    sf::Image corner;
+    corner.create(100, 100, sf::Color::Black);
+    REQUIRE(document.ReadRegion(250, 100, corner));
+    REQUIRE(_samePixels(corner.getPixelsPtr(), 100 * 4, image.getPixelsPtr() + (100 * 300 + 250) * 4, 300 * 4, 50, 50));
+    REQUIRE(corner.getPixel(50, 0) == sf::Color::Black);
+    REQUIRE(corner.getPixel(0, 50) == sf::Color::Black);
+
+    std::vector<std::unique_ptr<RoundedLine>> lines;
+    std::vector<size_t> strokeEnds;
+    REQUIRE(document.ReadStrokes(lines, strokeEnds));
+    REQUIRE(strokeEnds == std::vector<size_t>{2, 3});
+    REQUIRE(lines.size() == 3);
+    REQUIRE(lines[0]->getStartPoint() == sf::Vector2f(1.5f, 2));
+    REQUIRE(lines[0]->getEndPoint() == sf::Vector2f(100, 50.25f));
+    REQUIRE(lines[0]->getColor() == sf::Color::Red);
+    REQUIRE(lines[0]->getOwner() == 7);
+    REQUIRE(lines[1]->getEndPoint() == sf::Vector2f(-20, 400));
+    REQUIRE(lines[1]->getWidth() == 3);
+    REQUIRE(lines[1]->getColor() == sf::Color(1, 2, 3, 4));
+    REQUIRE(lines[1]->getOwner() == -1);
+    REQUIRE(lines[2]->getWidth() == 20);
+    document.Close();
+    REQUIRE_FALSE(document.IsOpen());
+
+    // A file that is not a document is refused.
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    std::fputs("not a document, but longer than a document header", file);
+    std::fclose(file);
+    REQUIRE_FALSE(document.Open(path));
+    std::remove(path.c_str());
+}
+
+/*! \brief Test that only the tiles under the region read are decoded.
+*/
+TEST_CASE("Tiles are decoded lazily", "[Document]") {
+    const std::string path = "DocumentTest.mpd";
+    const sf::Image image = _documentImage(640, 640);
+    REQUIRE(_writeDocument(path, image, {}, {}));
+    Document document;
+    REQUIRE(document.Open(path));
+    REQUIRE(document.GetDecodedCount() == 0);
+    sf::Image region;
+    region.create(100, 100, sf::Color::Black);
+    REQUIRE(document.ReadRegion(320, 320, region));
+    REQUIRE(document.GetDecodedCount() == 4);
+    REQUIRE(_samePixels(region.getPixelsPtr(), 100 * 4, image.getPixelsPtr() + (320 * 640 + 320) * 4, 640 * 4, 100, 100));
+    std::remove(path.c_str());
+}
+
+/*! \brief Benchmark opening a 65536 x 65536 (4 gigapixel) document and reading a 1280 x 720
+*          viewport of it. Both should take milliseconds, and only the viewport tiles are decoded.
+*/
+TEST_CASE("Benchmark opening a multi-gigapixel document", "[Document] [!benchmark]") {
+    const std::string path = "DocumentTest.mpd";
+    const int size = 65536;
+    {
+        // Every tile of the document is the same white tile.
+        sf::Image white;
+        white.create(64, 64, sf::Color::White);
+        std::vector<sf::Uint8> tile;
+        TileCodec::Encode(white.getPixelsPtr(), 64 * 4, 64, 64, tile);
+        DocumentWriter writer;
+        REQUIRE(writer.Open(path, size, size));
+        for (int i = 0; i < (size / 64) * (size / 64); i++) {
+            REQUIRE(writer.AddEncodedTile(tile.data(), tile.size()));
+        }
+        REQUIRE(writer.Finish());
+        WARN("Document of " << size << "x" << size << " pixels is " << writer.GetSize() / (1024 * 1024) << " MB");
+    }
+    auto start = std::chrono::steady_clock::now();
+    Document document;
+    REQUIRE(document.Open(path));
+    const double openMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    sf::Image viewport;
+    viewport.create(1280, 720, sf::Color::Black);
+    start = std::chrono::steady_clock::now();
+    REQUIRE(document.ReadRegion(size / 2, size / 2, viewport));
+    const double readMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    REQUIRE(document.GetDecodedCount() == 20 * 12);
+    REQUIRE(viewport.getPixel(1279, 719) == sf::Color::White);
+    WARN("Open: " << openMs << " ms, read a 1280x720 viewport (" << document.GetDecodedCount() << " of "
+         << document.GetTileCount() << " tiles): " << readMs << " ms");
+    document.Close();
+    std::remove(path.c_str());
+}
@@ -0,0 +1,174 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "Exporter.hpp"
+#include "RoundedLine.hpp"
+#include "TileCanvas.hpp"
+
+#include <SFML/Graphics.hpp>
+
+// True if the image file at path has the same pixels as expected.
+bool _savedAs(const std::string& path, const sf::Image& expected) {
+    sf::Image saved;
+    if (!saved.loadFromFile(path) || saved.getSize() != expected.getSize()) {
+        return false;
+    }
+    return std::equal(saved.getPixelsPtr(), saved.getPixelsPtr() + saved.getSize().x * saved.getSize().y * 4, expected.getPixelsPtr());
+}
+
+/*! \brief Test that only the formats sf::Image can write are accepted.
+*/
+TEST_CASE("Export formats", "[Exporter]") {
+    REQUIRE(Exporter::IsSupported("canvas.png"));
+    REQUIRE(Exporter::IsSupported("canvas.JPG"));
+    REQUIRE(Exporter::IsSupported("my.canvas.jpeg"));
+    REQUIRE(Exporter::IsSupported("canvas.bmp"));
+    REQUIRE(Exporter::IsSupported("canvas.Svg"));
+    REQUIRE_FALSE(Exporter::IsSupported("canvas.gif"));
+    REQUIRE_FALSE(Exporter::IsSupported("canvas"));
+}
+
+/*! \brief Test that a job is written as the snapshot with its lines flattened over it, and reports its progress.
+*/
+TEST_CASE("Encode a snapshot with its lines", "[Exporter]") {
+    const std::string path = "ExporterTest.png";
+    std::remove(path.c_str());
+    std::unique_ptr<Exporter::Job> job(new Exporter::Job);
+    job->path = path;
+    job->canvas.Create(300, 200, sf::Color::White);
+    job->canvas.SetPixel(5, 5, sf::Color::Red);
+    std::vector<std::unique_ptr<RoundedLine>> lines;
+    for (int i = 0; i < 1000; i++) {
+        lines.emplace_back(new RoundedLine(sf::Vector2f((float)(i % 300), 100), sf::Vector2f((float)(i % 300), 150), 3, sf::Color::Blue, 1234));
+        job->lines.push_back(lines.back().get());
+    }
+    sf::Image expected;
+    job->canvas.CopyToImage(expected);
+    for (const RoundedLine* line : job->lines) {
+        line->rasterize(expected);
+    }
+
+    std::atomic<int> progress(0);
+    REQUIRE(Exporter::Encode(*job, &progress));
+    REQUIRE(progress == 1000);
+    REQUIRE(_savedAs(path, expected));
+    std::remove(path.c_str());
+
+    Exporter exporter;
+    REQUIRE(exporter.GetProgress() == 1.0f);
+    exporter.Save(std::move(job));
+    exporter.Wait();
+    REQUIRE_FALSE(exporter.IsBusy());
+    std::vector<Exporter::Result> results;
+    REQUIRE(exporter.Collect(results) == 1);
+    REQUIRE(results[0].path == path);
+    REQUIRE(results[0].saved);
+    REQUIRE(_savedAs(path, expected));
+    REQUIRE(exporter.Collect(results) == 0);
+    std::remove(path.c_str());
+}
+
+/*! \brief Test that a save that can not be written is reported as failed.
+*/
+TEST_CASE("Report a failed export", "[Exporter]") {
+    std::unique_ptr<Exporter::Job> job(new Exporter::Job);
+    job->path = "no_such_directory/ExporterTest.png";
+    job->canvas.Create(30, 20, sf::Color::White);
+    Exporter exporter;
+    exporter.Save(std::move(job));
+    exporter.Wait();
+    std::vector<Exporter::Result> results;
+    REQUIRE(exporter.Collect(results) == 1);
+    REQUIRE_FALSE(results[0].saved);
+}
+
+// The contents of the file at path.
+std::string _readText(const std::string& path) {
+    std::string text;
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    char chunk[4096];
+    size_t read;
+    while (file != nullptr && (read = std::fread(chunk, 1, sizeof(chunk), file)) > 0) {
+        text.append(chunk, read);
+    }
+    if (file != nullptr) {
+        std::fclose(file);
+    }
+    return text;
+}
+
+// Number of times part is in text.
+size_t _countOf(const std::string& text, const std::string& part) {
+    size_t count = 0;
+    for (size_t at = text.find(part); at != std::string::npos; at = text.find(part, at + 1)) {
+        count++;
+    }
+    return count;
+}
+
+/*! \brief Test that each gesture becomes one round capped path, split where its style changes.
+*/
+TEST_CASE("Export the strokes as SVG paths", "[Exporter]") {
+    const std::string path = "ExporterTest.svg";
+    RoundedLine a(sf::Vector2f(10, 20), sf::Vector2f(30, 40), 5, sf::Color::Red, 0);
+    RoundedLine b(sf::Vector2f(30, 40), sf::Vector2f(50.5f, 60.25f), 5, sf::Color::Red, 0);
+    RoundedLine c(sf::Vector2f(100, 100), sf::Vector2f(-1, 0), 5, sf::Color::Red, 0);
+    RoundedLine d(sf::Vector2f(0, 0), sf::Vector2f(1, 1), 2.5f, sf::Color(0, 0, 255, 128), 3);
+    RoundedLine e(sf::Vector2f(7, 7), sf::Vector2f(8, 8), 12, sf::Color::Black, 0);
+    std::unique_ptr<Exporter::Job> job(new Exporter::Job);
+    job->path = path;
+    job->canvas.Create(320, 200, sf::Color::White);
+    job->lines = {&a, &b, &c, &d, &e};
+    // The first gesture is a, b and c, with a gap before c, then d in another style; e is not in a gesture.
+    job->strokeEnds = {4};
+    std::atomic<int> progress(0);
+    REQUIRE(Exporter::Encode(*job, &progress));
+    REQUIRE(progress == 1000);
+
+    const std::string svg = _readText(path);
+    REQUIRE(svg.find("width=\"320\" height=\"200\"") != std::string::npos);
+    REQUIRE(svg.find("stroke-linecap=\"round\" stroke-linejoin=\"round\"") != std::string::npos);
+    REQUIRE(_countOf(svg, "<path ") == 3);
+    REQUIRE(svg.find("<path stroke=\"#ff0000\" stroke-width=\"5\" d=\"M10 20L30 40 50.5 60.25 M100 100L-1 0\"/>") != std::string::npos);
+    REQUIRE(svg.find("<path stroke=\"#0000ff\" stroke-opacity=\"0.5\" stroke-width=\"2.5\" data-owner=\"3\" d=\"M0 0L1 1\"/>") != std::string::npos);
+    REQUIRE(svg.find("<path stroke=\"#000000\" stroke-width=\"12\" d=\"M7 7L8 8\"/>") != std::string::npos);
+    REQUIRE(svg.substr(svg.size() - 12) == "</g>\n</svg>\n");
+    std::remove(path.c_str());
+}
+
+/*! \brief Benchmark exporting 1M line segments in 2000 gestures to SVG. The writer keeps only its
+*          fixed size buffer, whatever the size of the file.
+*/
+TEST_CASE("Benchmark SVG export of 1M line segments", "[Exporter] [!benchmark]") {
+    const std::string path = "ExporterTest.svg";
+    std::vector<std::unique_ptr<RoundedLine>> lines;
+    std::unique_ptr<Exporter::Job> job(new Exporter::Job);
+    job->path = path;
+    job->canvas.Create(1280, 720, sf::Color::White);
+    for (int g = 0; g < 2000; g++) {
+        for (int i = 0; i < 500; i++) {
+            const float x = (float)((g * 37 + i * 3) % 1280);
+            const float y = (float)((g * 11 + i) % 720);
+            lines.emplace_back(new RoundedLine(sf::Vector2f(x, y), sf::Vector2f(x + 3, y + 1), (float)(1 + g % 30), g % 2 == 0 ? sf::Color::Black : sf::Color::Red, 0));
+            job->lines.push_back(lines.back().get());
+        }
+        job->strokeEnds.push_back(job->lines.size());
+    }
+    const auto start = std::chrono::steady_clock::now();
+    REQUIRE(Exporter::Encode(*job));
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    REQUIRE(file != nullptr);
+    std::fseek(file, 0, SEEK_END);
+    const double megabytes = (double)std::ftell(file) / (1024 * 1024);
+    std::fclose(file);
+    WARN("1M line segments: " << megabytes << " MB of SVG in " << ms << " ms (" << megabytes / (ms / 1000) << " MB/s, "
+         << 1000000 / (ms / 1000) / 1e6 << "M segments/s), " << SvgWriter::BUFFER_SIZE / 1024 << " KB buffer");
+    std::remove(path.c_str());
+}
@@ -0,0 +1,249 @@
+#include <cstdlib>
+#include <queue>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "Fill.hpp"
+#include "MathUtility.hpp"
+#include "ThreadPool.hpp"
+
+#include <SFML/Graphics.hpp>
+
+// Mark every pixel covered by the spans of a width x height image.
+std::vector<int> _coverage(const std::vector<MathUtility::Span>& spans, int width, int height) {
+    std::vector<int> covered(width * height, 0);
+    for (auto& span : spans) {
+        for (int x = span.x0; x <= span.x1; x++) {
+            covered[span.y * width + x]++;
+        }
+    }
+    return covered;
+}
+
+// Draw the outline of a rectangle from (x0,y0) to (x1,y1) into the image.
+void _drawBox(sf::Image& img, int x0, int y0, int x1, int y1, sf::Color color) {
+    for (int x = x0; x <= x1; x++) {
+        img.setPixel(x, y0, color);
+        img.setPixel(x, y1, color);
+    }
+    for (int y = y0; y <= y1; y++) {
+        img.setPixel(x0, y, color);
+        img.setPixel(x1, y, color);
+    }
+}
+
+/*! \brief Test that a fill on a blank canvas covers every pixel exactly once.
+*/
+TEST_CASE("Scanline fill of an empty canvas", "[utilities] [Fill]") {
+    sf::Image img = sf::Image();
+    img.create(64, 48, sf::Color::White);
+    std::vector<MathUtility::Span> spans = MathUtility::ScanlineFill(img.getPixelsPtr(), 64, 48, 10, 10);
+    REQUIRE(spans.size() == 48);
+    for (int count : _coverage(spans, 64, 48)) {
+        REQUIRE(count == 1);
+    }
+}
+
+/*! \brief Test that the fill stays inside a closed outline and leaves the outline alone.
+*/
+TEST_CASE("Fill inside a closed box", "[Fill]") {
+    sf::Image img = sf::Image();
+    img.create(100, 100, sf::Color::White);
+    _drawBox(img, 10, 10, 40, 30, sf::Color::Black);
+    Fill fillCmd = Fill(20, 20, img, sf::Color::Red);
+    REQUIRE(fillCmd.execute());
+    REQUIRE(fillCmd.getPixelCount() == 29 * 19);
+    REQUIRE(img.getPixel(11, 11) == sf::Color::Red);
+    REQUIRE(img.getPixel(39, 29) == sf::Color::Red);
+    REQUIRE(img.getPixel(10, 20) == sf::Color::Black);
+    REQUIRE(img.getPixel(5, 5) == sf::Color::White);
+    REQUIRE(img.getPixel(41, 20) == sf::Color::White);
+}
+
+/*! \brief Test that the region can wind around obstacles (needs seeds from both rows).
+*/
+TEST_CASE("Fill a U-shaped region", "[Fill]") {
+    sf::Image img = sf::Image();
+    img.create(20, 20, sf::Color::White);
+    // A wall from the top down to row 15 splits the canvas into two halves joined at the bottom.
+    for (int y = 0; y <= 15; y++) {
+        img.setPixel(10, y, sf::Color::Black);
+    }
+    Fill fillCmd = Fill(2, 2, img, sf::Color::Blue);
+    REQUIRE(fillCmd.execute());
+    REQUIRE(fillCmd.getPixelCount() == 20 * 20 - 16);
+    REQUIRE(img.getPixel(18, 2) == sf::Color::Blue);
+}
+
+/*! \brief Test the scanline fill against a plain per-pixel BFS on random noise.
+*/
+TEST_CASE("Scanline fill matches a BFS fill on noise", "[utilities] [Fill]") {
+    const int width = 97;
+    const int height = 61;
+    sf::Image img = sf::Image();
+    img.create(width, height, sf::Color::White);
+    std::srand(5500);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (std::rand() % 100 < 40) {
+                img.setPixel(x, y, sf::Color::Black);
+            }
+        }
+    }
+    img.setPixel(48, 30, sf::Color::White);
+    std::vector<MathUtility::Span> spans = MathUtility::ScanlineFill(img.getPixelsPtr(), width, height, 48, 30);
+    std::vector<int> expected(width * height, 0);
+    std::queue<std::pair<int, int>> queue;
+    queue.push(std::make_pair(48, 30));
+    expected[30 * width + 48] = 1;
+    while (!queue.empty()) {
+        std::pair<int, int> p = queue.front();
+        queue.pop();
+        const int dx[4] = {1, -1, 0, 0};
+        const int dy[4] = {0, 0, 1, -1};
+        for (int k = 0; k < 4; k++) {
+            int nx = p.first + dx[k];
+            int ny = p.second + dy[k];
+            if (nx >= 0 && ny >= 0 && nx < width && ny < height && !expected[ny * width + nx] && img.getPixel(nx, ny) == sf::Color::White) {
+                expected[ny * width + nx] = 1;
+                queue.push(std::make_pair(nx, ny));
+            }
+        }
+    }
+    REQUIRE(_coverage(spans, width, height) == expected);
+}
+
+/*! \brief Test that the tile fill finds exactly the region of the serial fill,
+*          including regions that wind back and forth across tile borders.
+*/
+TEST_CASE("Tile fill matches the scanline fill", "[utilities] [Fill]") {
+    const int width = 300;
+    const int height = 200;
+    sf::Image img = sf::Image();
+    img.create(width, height, sf::Color::White);
+    std::srand(5500);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            if (std::rand() % 100 < 35) {
+                img.setPixel(x, y, sf::Color::Black);
+            }
+        }
+    }
+    // A serpentine corridor so the region crosses the 64 pixel tile borders many times.
+    for (int y = 0; y < height; y += 4) {
+        for (int x = 0; x < width; x++) {
+            img.setPixel(x, y, sf::Color::White);
+        }
+        int gate = (y / 4) % 2 == 0 ? width - 1 : 0;
+        for (int k = 1; k < 4 && y + k < height; k++) {
+            img.setPixel(gate, y + k, sf::Color::White);
+        }
+    }
+    std::vector<MathUtility::Span> serial = MathUtility::ScanlineFill(img.getPixelsPtr(), width, height, 0, 0);
+    for (int threads : {0, 3}) {
+        ThreadPool pool(threads);
+        std::vector<MathUtility::Span> tiled = MathUtility::TileFill(img.getPixelsPtr(), width, height, 0, 0, pool, 64);
+        REQUIRE(_coverage(tiled, width, height) == _coverage(serial, width, height));
+    }
+}
+
+/*! \brief Test that filling with the color already under the seed does nothing.
+*/
+TEST_CASE("Fill with the same color", "[Fill]") {
+    sf::Image img = sf::Image();
+    img.create(10, 10, sf::Color::White);
+    Fill fillCmd = Fill(4, 5, img, sf::Color::White);
+    REQUIRE_FALSE(fillCmd.execute());
+    Fill outside = Fill(-1, 5, img, sf::Color::Red);
+    REQUIRE_FALSE(outside.execute());
+}
+
+/*! \brief Test that undo restores every pixel and redo paints the region again.
+*/
+TEST_CASE("Undo and redo a fill", "[Fill]") {
+    sf::Image img = sf::Image();
+    img.create(50, 50, sf::Color::White);
+    _drawBox(img, 5, 5, 25, 25, sf::Color::Green);
+    // The boundary decides the region, the pixels below it may have any color.
+    sf::Image boundary = img;
+    img.setPixel(12, 12, sf::Color::Yellow);
+    img.setPixel(13, 12, sf::Color::Cyan);
+    sf::Image before = img;
+
+    Fill fillCmd = Fill(15, 15, img, sf::Color::Magenta, boundary);
+    REQUIRE(fillCmd.execute());
+    REQUIRE(img.getPixel(12, 12) == sf::Color::Magenta);
+    REQUIRE(fillCmd.undo());
+    for (int y = 0; y < 50; y++) {
+        for (int x = 0; x < 50; x++) {
+            REQUIRE(img.getPixel(x, y) == before.getPixel(x, y));
+        }
+    }
+    REQUIRE(fillCmd.redo());
+    REQUIRE(img.getPixel(12, 12) == sf::Color::Magenta);
+    REQUIRE(img.getPixel(13, 12) == sf::Color::Magenta);
+    REQUIRE(fillCmd.getDescription() == "Fill (15, 15, Magenta)");
+}
+
+/*! \brief Test that a fill can spill its undo data to bytes and undo after restoring it.
+*/
+TEST_CASE("Spill and restore a fill", "[Fill]") {
+    sf::Image img = sf::Image();
+    img.create(50, 50, sf::Color::White);
+    _drawBox(img, 5, 5, 25, 25, sf::Color::Green);
+    img.setPixel(12, 12, sf::Color::Yellow);
+    sf::Image before = img;
+
+    Fill fillCmd = Fill(15, 15, img, sf::Color::Magenta);
+    REQUIRE(fillCmd.execute());
+    REQUIRE(fillCmd.getByteSize() > 0);
+    std::vector<sf::Uint8> bytes;
+    REQUIRE(fillCmd.spill(bytes));
+    REQUIRE(fillCmd.getByteSize() == 0);
+    // Truncated bytes are rejected.
+    REQUIRE_FALSE(fillCmd.restore(std::vector<sf::Uint8>(bytes.begin(), bytes.end() - 1)));
+    REQUIRE(fillCmd.restore(bytes));
+    REQUIRE(fillCmd.undo());
+    for (int y = 0; y < 50; y++) {
+        for (int x = 0; x < 50; x++) {
+            REQUIRE(img.getPixel(x, y) == before.getPixel(x, y));
+        }
+    }
+}
+
+/*! \brief Benchmark a full-canvas fill at the default window size of 1280x720.
+*/
+TEST_CASE("Benchmark full-canvas fill 1280x720", "[Fill] [!benchmark]") {
+    sf::Image img = sf::Image();
+    img.create(1280, 720, sf::Color::White);
+    const sf::Uint8* pixels = img.getPixelsPtr();
+
+    BENCHMARK("ScanlineFill 1280x720") {
+        return MathUtility::ScanlineFill(pixels, 1280, 720, 640, 360);
+    };
+    BENCHMARK("Fill execute + undo 1280x720") {
+        Fill fillCmd = Fill(640, 360, img, sf::Color::Red);
+        fillCmd.execute();
+        return fillCmd.undo();
+    };
+}
+
+/*! \brief Benchmark the tile fill of a blank 16k x 16k canvas at 1, 2, 4 and 8 threads.
+*          The calling thread takes part in the fill, so n threads is a pool of n-1 workers.
+*/
+TEST_CASE("Benchmark tile fill scaling 16384x16384", "[Fill] [!benchmark]") {
+    const int size = 16384;
+    sf::Image img = sf::Image();
+    img.create(size, size, sf::Color::White);
+    const sf::Uint8* pixels = img.getPixelsPtr();
+
+    BENCHMARK("ScanlineFill 16384x16384") {
+        return MathUtility::ScanlineFill(pixels, size, size, size / 2, size / 2).size();
+    };
+    for (int threads : {1, 2, 4, 8}) {
+        ThreadPool pool(threads - 1);
+        BENCHMARK("TileFill 16384x16384 threads=" + std::to_string(threads)) {
+            return MathUtility::TileFill(pixels, size, size, size / 2, size / 2, pool).size();
+        };
+    }
+}
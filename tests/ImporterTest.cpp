@@ -0,0 +1,226 @@
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "Document.hpp"
+#include "Importer.hpp"
+
+// The color an image of the tests has at (x, y).
+sf::Uint32 _importColor(int x, int y) {
+    return (sf::Uint32)(x * 7 & 0xFF) << 24 | (sf::Uint32)(y * 5 & 0xFF) << 16 | (sf::Uint32)((x + y) & 0xFF) << 8 | 0xFF;
+}
+
+// Write bytes to a new file at path.
+bool _writeFile(const std::string& path, const std::vector<sf::Uint8>& bytes) {
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    const bool written = std::fwrite(bytes.data(), 1, bytes.size(), file) == bytes.size();
+    return std::fclose(file) == 0 && written;
+}
+
+void _putLe(std::vector<sf::Uint8>& bytes, sf::Uint32 value, int size) {
+    for (int i = 0; i < size; i++) {
+        bytes.push_back((sf::Uint8)(value >> (i * 8)));
+    }
+}
+
+// A 24 bit bottom up BMP of the test colors, rows padded to 4 bytes.
+std::vector<sf::Uint8> _bmp(int width, int height) {
+    const sf::Uint32 rowBytes = ((sf::Uint32)width * 3 + 3) / 4 * 4;
+    std::vector<sf::Uint8> bytes{'B', 'M'};
+    _putLe(bytes, 54 + rowBytes * height, 4);
+    _putLe(bytes, 0, 4);
+    _putLe(bytes, 54, 4);
+    _putLe(bytes, 40, 4);
+    _putLe(bytes, (sf::Uint32)width, 4);
+    _putLe(bytes, (sf::Uint32)height, 4);
+    _putLe(bytes, 1, 2);
+    _putLe(bytes, 24, 2);
+    _putLe(bytes, 0, 4);
+    _putLe(bytes, rowBytes * height, 4);
+    _putLe(bytes, 0, 16);
+    for (int y = height - 1; y >= 0; y--) {
+        for (int x = 0; x < width; x++) {
+            const sf::Uint32 color = _importColor(x, y);
+            bytes.push_back((sf::Uint8)(color >> 8));
+            bytes.push_back((sf::Uint8)(color >> 16));
+            bytes.push_back((sf::Uint8)(color >> 24));
+        }
+        bytes.resize(bytes.size() + rowBytes - width * 3);
+    }
+    return bytes;
+}
+
+// A 32 bit TGA of the test colors, with alpha x, stored top down or bottom up.
+std::vector<sf::Uint8> _tga(int width, int height, bool topDown) {
+    std::vector<sf::Uint8> bytes{0, 0, 2};
+    bytes.resize(12);
+    _putLe(bytes, (sf::Uint32)width, 2);
+    _putLe(bytes, (sf::Uint32)height, 2);
+    bytes.push_back(32);
+    bytes.push_back(topDown ? 0x28 : 0x08);
+    for (int row = 0; row < height; row++) {
+        const int y = topDown ? row : height - 1 - row;
+        for (int x = 0; x < width; x++) {
+            const sf::Uint32 color = _importColor(x, y);
+            bytes.push_back((sf::Uint8)(color >> 8));
+            bytes.push_back((sf::Uint8)(color >> 16));
+            bytes.push_back((sf::Uint8)(color >> 24));
+            bytes.push_back((sf::Uint8)x);
+        }
+    }
+    return bytes;
+}
+
+// A binary PPM of the test colors, with a comment in its header.
+std::vector<sf::Uint8> _ppm(int width, int height) {
+    const std::string header = "P6\n# test\n" + std::to_string(width) + " " + std::to_string(height) + "\n255\n";
+    std::vector<sf::Uint8> bytes(header.begin(), header.end());
+    bytes.reserve(bytes.size() + (size_t)width * height * 3);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            const sf::Uint32 color = _importColor(x, y);
+            bytes.push_back((sf::Uint8)(color >> 24));
+            bytes.push_back((sf::Uint8)(color >> 16));
+            bytes.push_back((sf::Uint8)(color >> 8));
+        }
+    }
+    return bytes;
+}
+
+// True if every pixel of the document at path is the test color, with alpha the x of the
+// pixel if alphaX, and opaque otherwise.
+bool _importedAs(const std::string& path, int width, int height, bool alphaX) {
+    Document document;
+    if (!document.Open(path) || document.GetWidth() != width || document.GetHeight() != height) {
+        return false;
+    }
+    std::vector<sf::Uint8> pixels;
+    for (int tile = 0; tile < document.GetTileCount(); tile++) {
+        const sf::IntRect rect = document.GetTileRect(tile);
+        pixels.assign((size_t)rect.width * rect.height * 4, 0);
+        if (!document.ReadTile(tile, pixels.data(), (size_t)rect.width * 4)) {
+            return false;
+        }
+        for (int y = 0; y < rect.height; y++) {
+            for (int x = 0; x < rect.width; x++) {
+                const sf::Uint8* p = pixels.data() + ((size_t)y * rect.width + x) * 4;
+                const sf::Uint32 color = _importColor(rect.left + x, rect.top + y);
+                const sf::Uint8 alpha = alphaX ? (sf::Uint8)(rect.left + x) : 255;
+                if (p[0] != (sf::Uint8)(color >> 24) || p[1] != (sf::Uint8)(color >> 16) || p[2] != (sf::Uint8)(color >> 8) || p[3] != alpha) {
+                    return false;
+                }
+            }
+        }
+    }
+    return true;
+}
+
+/*! \brief Test that BMP, TGA and PPM files are imported with every pixel where it was, and only one band of rows held at a time.
+*/
+TEST_CASE("Import images a band at a time", "[Importer]") {
+    const int width = 150;
+    const int height = 200;
+    const size_t band = (size_t)width * 4 * Document::TILE_SIZE;
+    struct Case {
+        std::string source;
+        std::vector<sf::Uint8> bytes;
+        bool alphaX;
+    };
+    const std::vector<Case> cases{
+        {"ImporterTest.bmp", _bmp(width, height), false},
+        {"ImporterTest.tga", _tga(width, height, false), true},
+        {"ImporterTest.TGA", _tga(width, height, true), true},
+        {"ImporterTest.ppm", _ppm(width, height), false},
+    };
+    for (const Case& test : cases) {
+        REQUIRE(Importer::IsStreamed(test.source));
+        REQUIRE(_writeFile(test.source, test.bytes));
+        Importer::Job job{test.source, "ImporterTest.mpd"};
+        Importer::Result result;
+        std::atomic<int> progress(-1);
+        REQUIRE(Importer::Convert(job, result, &progress));
+        REQUIRE(result.imported);
+        REQUIRE(progress == 1000);
+        REQUIRE(result.width == width);
+        REQUIRE(result.height == height);
+        // The band of RGBA pixels and the file bytes of it.
+        REQUIRE(result.peakBytes <= band * 2);
+        REQUIRE(_importedAs("ImporterTest.mpd", width, height, test.alphaX));
+        std::remove(test.source.c_str());
+    }
+    std::remove("ImporterTest.mpd");
+}
+
+/*! \brief Test that files that are not images, or not ones it can read, are not imported.
+*/
+TEST_CASE("Do not import what can not be read", "[Importer]") {
+    REQUIRE_FALSE(Importer::IsStreamed("canvas.png"));
+    REQUIRE(Importer::IsStreamed("canvas.PGM"));
+    Importer::Result result;
+    REQUIRE_FALSE(Importer::Convert(Importer::Job{"ImporterTest.missing.bmp", "ImporterTest.mpd"}, result));
+    REQUIRE_FALSE(result.imported);
+
+    // A 16 bit PPM, an RLE TGA and a file cut short in its pixels.
+    REQUIRE(_writeFile("ImporterTest.ppm", std::vector<sf::Uint8>{'P', '6', ' ', '1', ' ', '1', ' ', '6', '5', '5', '3', '5', '\n', 0, 0, 0, 0, 0, 0}));
+    REQUIRE_FALSE(Importer::Convert(Importer::Job{"ImporterTest.ppm", "ImporterTest.mpd"}, result));
+    std::vector<sf::Uint8> tga = _tga(4, 4, true);
+    tga[2] = 10;
+    REQUIRE(_writeFile("ImporterTest.tga", tga));
+    REQUIRE_FALSE(Importer::Convert(Importer::Job{"ImporterTest.tga", "ImporterTest.mpd"}, result));
+    std::vector<sf::Uint8> bmp = _bmp(100, 100);
+    bmp.resize(bmp.size() - 10);
+    REQUIRE(_writeFile("ImporterTest.bmp", bmp));
+    REQUIRE_FALSE(Importer::Convert(Importer::Job{"ImporterTest.bmp", "ImporterTest.mpd"}, result));
+    std::remove("ImporterTest.ppm");
+    std::remove("ImporterTest.tga");
+    std::remove("ImporterTest.bmp");
+    std::remove("ImporterTest.mpd");
+}
+
+/*! \brief Test that the worker imports the queued jobs in order and hands over their results.
+*/
+TEST_CASE("Import on the worker", "[Importer]") {
+    REQUIRE(_writeFile("ImporterTest.ppm", _ppm(70, 30)));
+    Importer importer;
+    REQUIRE(importer.GetProgress() == 1.0f);
+    std::unique_ptr<Importer::Job> job(new Importer::Job{"ImporterTest.ppm", "ImporterTest.mpd"});
+    importer.Import(std::move(job));
+    job.reset(new Importer::Job{"ImporterTest.missing.ppm", "ImporterTest2.mpd"});
+    importer.Import(std::move(job));
+    importer.Wait();
+    REQUIRE_FALSE(importer.IsBusy());
+    REQUIRE(importer.GetProgress() == 1.0f);
+    std::vector<Importer::Result> results;
+    REQUIRE(importer.Collect(results) == 2);
+    REQUIRE(results[0].imported);
+    REQUIRE(results[0].document == "ImporterTest.mpd");
+    REQUIRE_FALSE(results[1].imported);
+    REQUIRE(importer.Collect(results) == 0);
+    REQUIRE(_importedAs("ImporterTest.mpd", 70, 30, false));
+    std::remove("ImporterTest.ppm");
+    std::remove("ImporterTest.mpd");
+}
+
+/*! \brief Benchmark importing a large image, against holding all of its pixels at once.
+*/
+TEST_CASE("Benchmark import of a large image", "[Importer][!benchmark]") {
+    const int width = 4096;
+    const int height = 4096;
+    REQUIRE(_writeFile("ImporterTest.ppm", _ppm(width, height)));
+    Importer::Result result;
+    const auto start = std::chrono::steady_clock::now();
+    REQUIRE(Importer::Convert(Importer::Job{"ImporterTest.ppm", "ImporterTest.mpd"}, result));
+    const double ms = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const double fullBytes = (double)width * height * 4;
+    WARN("Imported " << width << "x" << height << " in " << ms << " ms (" << fullBytes / 1e3 / ms << " MB/s of pixels), "
+        << result.peakBytes / 1024 << " KB of pixels held at most, against " << fullBytes / 1024 / 1024 << " MB for the whole image");
+    REQUIRE(result.peakBytes * 32 < fullBytes);
+    std::remove("ImporterTest.ppm");
+    std::remove("ImporterTest.mpd");
+}
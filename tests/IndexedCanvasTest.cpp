@@ -0,0 +1,240 @@
+#include <algorithm>
+#include <chrono>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "IndexedCanvas.hpp"
+#include "MathUtility.hpp"
+
+// An image of width x height whose pixel (x,y) is colors[pick(x,y)].
+template <typename Pick>
+sf::Image _indexedImage(int width, int height, const std::vector<sf::Color>& colors, Pick pick) {
+    sf::Image image;
+    image.create((unsigned int)width, (unsigned int)height);
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            image.setPixel((unsigned int)x, (unsigned int)y, colors[(size_t)pick(x, y)]);
+        }
+    }
+    return image;
+}
+
+// True if the canvas expands to the pixels of image.
+bool _expandsTo(const IndexedCanvas& canvas, const sf::Image& image) {
+    sf::Image expanded;
+    canvas.CopyToImage(expanded);
+    return expanded.getSize() == image.getSize() &&
+        std::equal(image.getPixelsPtr(), image.getPixelsPtr() + (size_t)image.getSize().x * image.getSize().y * 4, expanded.getPixelsPtr());
+}
+
+/*! \brief Test that an image of few colors is stored as indices at an eighth of its bytes and expands to the same pixels.
+*/
+TEST_CASE("Expand indexed tiles to the pixels they were made from", "[IndexedCanvas]") {
+    const std::vector<sf::Color> palette{sf::Color::White, sf::Color::Black, sf::Color::Red};
+    const std::vector<sf::Color> colors{sf::Color::White, sf::Color::Black, sf::Color::Red, sf::Color(10, 20, 30, 40)};
+    // Edge tiles of an odd width and height.
+    const sf::Image image = _indexedImage(151, 99, colors, [](int x, int y) { return (x * 3 + y / 2) % 4; });
+    IndexedCanvas canvas;
+    REQUIRE(canvas.FromImage(image, palette));
+    REQUIRE(canvas.GetPalette().size() == 4);
+    REQUIRE(canvas.FindColor(sf::Color(10, 20, 30, 40)) == 3);
+    REQUIRE(canvas.GetIndex(1, 0) == 3);
+    REQUIRE(canvas.GetPixel(150, 98) == colors[(150 * 3 + 49) % 4]);
+    REQUIRE(_expandsTo(canvas, image));
+
+    // Tile by tile into a buffer of another stride.
+    std::vector<sf::Uint8> tile((size_t)IndexedCanvas::TILE_SIZE * 300, 0);
+    const int last = canvas.GetTileCount() - 1;
+    canvas.ExpandTile(last, tile.data(), 300);
+    const sf::Uint8* p = tile.data() + 34 * 300 + 22 * 4;
+    REQUIRE(sf::Color(p[0], p[1], p[2], p[3]) == image.getPixel(128 + 22, 64 + 34));
+
+    // An eighth of the bytes of the pixels for whole tiles, and the tile table.
+    const sf::Image square = _indexedImage(256, 128, colors, [](int x, int y) { return (x ^ y) & 3; });
+    REQUIRE(canvas.FromImage(square, palette));
+    REQUIRE(canvas.GetByteSize() == 8 * (IndexedCanvas::TILE_BYTES + sizeof(IndexedCanvas::Tile)));
+    REQUIRE(canvas.GetByteSize() * 7 < (size_t)256 * 128 * 4);
+    REQUIRE(_expandsTo(canvas, square));
+
+    // Any rectangle, across tiles and from an odd pixel.
+    std::vector<sf::Uint8> part((size_t)101 * 50 * 4, 0);
+    canvas.ExpandRect(sf::IntRect(61, 33, 101, 50), part.data(), (size_t)101 * 4);
+    const sf::Uint8* q = part.data() + ((size_t)40 * 101 + 7) * 4;
+    REQUIRE(sf::Color(q[0], q[1], q[2], q[3]) == square.getPixel(68, 73));
+
+    REQUIRE_FALSE(canvas.Create(10, 10, std::vector<sf::Color>(IndexedCanvas::MAX_COLORS + 1, sf::Color::Red)));
+}
+
+/*! \brief Test that fills of the indices cover the same region as a fill of the pixels, and that colors are changed through the palette.
+*/
+TEST_CASE("Fill and recolor the indices", "[IndexedCanvas]") {
+    const std::vector<sf::Color> palette{sf::Color::White, sf::Color::Black, sf::Color::Red, sf::Color::Blue};
+    // Noise of three colors with thin walls, so the regions have every shape of span.
+    const sf::Image image = _indexedImage(200, 150, palette, [](int x, int y) {
+        return (x % 37 == 5 || y % 29 == 3) ? 1 : (int)((unsigned int)(x * 7919 + y * 104729) % 97 < 70 ? 0 : 2);
+    });
+    const std::vector<std::pair<int, int>> seeds{{0, 0}, {1, 0}, {64, 64}, {63, 10}, {199, 149}, {5, 77}, {120, 3}};
+    for (const std::pair<int, int>& seed : seeds) {
+        IndexedCanvas canvas;
+        REQUIRE(canvas.FromImage(image, palette));
+        sf::Image expected = image;
+        const std::vector<MathUtility::Span> regionSpans = MathUtility::ScanlineFill(image.getPixelsPtr(), 200, 150, seed.first, seed.second);
+        MathUtility::FillSpans(MathUtility::MutablePixels(expected), 200, regionSpans, sf::Color::Blue);
+
+        const std::vector<MathUtility::Span> spans = canvas.Fill(seed.first, seed.second, 3);
+        size_t pixels = 0;
+        size_t expectedPixels = 0;
+        for (const MathUtility::Span& span : spans) {
+            pixels += span.x1 - span.x0 + 1;
+        }
+        for (const MathUtility::Span& span : regionSpans) {
+            expectedPixels += span.x1 - span.x0 + 1;
+        }
+        REQUIRE(pixels == expectedPixels);
+        REQUIRE(_expandsTo(canvas, expected));
+        // Filling again with the same index changes nothing.
+        REQUIRE(canvas.Fill(seed.first, seed.second, 3).empty());
+    }
+
+    IndexedCanvas canvas;
+    REQUIRE(canvas.Create(130, 70, palette));
+    canvas.FillRect(sf::IntRect(3, 5, 120, 60), 2);
+    canvas.FillRect(sf::IntRect(-10, 0, 1000, 1), 1);
+    REQUIRE(canvas.GetIndex(2, 5) == 0);
+    REQUIRE(canvas.GetIndex(3, 5) == 2);
+    REQUIRE(canvas.GetIndex(122, 64) == 2);
+    REQUIRE(canvas.GetIndex(123, 64) == 0);
+    REQUIRE(canvas.GetIndex(129, 0) == 1);
+
+    // A palette swap changes the color of every pixel of the index, not the indices.
+    canvas.SetPaletteColor(2, sf::Color::Green);
+    REQUIRE(canvas.GetPixel(50, 30) == sf::Color::Green);
+    REQUIRE(canvas.GetIndex(50, 30) == 2);
+    REQUIRE(canvas.FindColor(sf::Color::Red) == IndexedCanvas::NO_INDEX);
+    sf::Image expanded;
+    canvas.CopyToImage(expanded);
+    REQUIRE(expanded.getPixel(122, 64) == sf::Color::Green);
+    REQUIRE(expanded.getPixel(123, 64) == sf::Color::White);
+
+    // Swapped into a color the palette has already, both indices are one region of it.
+    canvas.SetPaletteColor(2, sf::Color::White);
+    REQUIRE(canvas.GetColorMask(sf::Color::White) == (1u | 1u << 2));
+    REQUIRE(canvas.Fill(0, 69, 3).size() == 69);
+    REQUIRE(canvas.GetIndex(50, 30) == 3);
+    REQUIRE(canvas.GetIndex(129, 0) == 1);
+    REQUIRE(canvas.Fill(50, 30, 3).empty());
+
+    // Within an area only.
+    REQUIRE(canvas.Fill(10, 10, 1, sf::IntRect(0, 0, 64, 64)).size() == 63);
+    REQUIRE(canvas.GetIndex(63, 63) == 1);
+    REQUIRE(canvas.GetIndex(64, 63) == 3);
+    REQUIRE(canvas.GetIndex(63, 64) == 3);
+    REQUIRE(canvas.Fill(100, 10, 1, sf::IntRect(0, 0, 64, 64)).empty());
+}
+
+/*! \brief Test that a tile of one index takes no indices, and that tiles are read from pixels, compacted and swapped.
+*/
+TEST_CASE("Keep tiles of one index without indices", "[IndexedCanvas]") {
+    const std::vector<sf::Color> palette{sf::Color::White, sf::Color::Black};
+    const size_t table = sizeof(IndexedCanvas::Tile) * 4 * 2;
+    IndexedCanvas canvas;
+    REQUIRE(canvas.Create(200, 100, palette));
+    REQUIRE(canvas.GetByteSize() == table);
+    canvas.FillRect(sf::IntRect(10, 10, 5, 5), 1);
+    REQUIRE(canvas.GetByteSize() == table + IndexedCanvas::TILE_BYTES);
+    REQUIRE_FALSE(canvas.Compact(0));
+    REQUIRE(canvas.HasIndex(0, 1));
+    REQUIRE_FALSE(canvas.HasIndex(1, 1));
+
+    // Painted over whole, the tile is of one index again. The edge tile only counts its part on the canvas.
+    canvas.FillRect(sf::IntRect(0, 0, 64, 64), 1);
+    canvas.FillRect(sf::IntRect(192, 64, 8, 36), 1);
+    REQUIRE(canvas.Compact(0));
+    REQUIRE(canvas.Compact(7));
+    REQUIRE(canvas.GetByteSize() == table);
+    REQUIRE(canvas.GetTile(7).index == 1);
+    REQUIRE(canvas.GetIndex(199, 99) == 1);
+
+    // A stroke across tiles covers the pixels within its radius.
+    canvas.FillCapsule(sf::Vector2f(20.5f, 80.5f), sf::Vector2f(150.5f, 80.5f), 10.0f, 1);
+    REQUIRE(canvas.GetIndex(20, 80) == 1);
+    REQUIRE(canvas.GetIndex(150, 84) == 1);
+    REQUIRE(canvas.GetIndex(80, 76) == 1);
+    REQUIRE(canvas.GetIndex(80, 74) == 0);
+    REQUIRE(canvas.GetIndex(155, 80) == 1);
+    REQUIRE(canvas.GetIndex(156, 80) == 0);
+    REQUIRE(canvas.GetIndex(154, 84) == 0);
+
+    // Swapped out and back, as undo and redo do.
+    IndexedCanvas::Tile before;
+    before.index = 0;
+    canvas.SwapTile(5, before);
+    REQUIRE(canvas.GetIndex(80, 80) == 0);
+    canvas.SwapTile(5, before);
+    REQUIRE(canvas.GetIndex(80, 80) == 1);
+
+    // New colors join the palette until it is full.
+    sf::Image image;
+    image.create(64, 64, sf::Color::White);
+    for (int i = 0; i < IndexedCanvas::MAX_COLORS - 2; i++) {
+        image.setPixel((unsigned int)i, 3, sf::Color((sf::Uint8)i, 1, 2));
+    }
+    REQUIRE(canvas.ReadTile(1, image.getPixelsPtr(), 64 * 4));
+    REQUIRE(canvas.GetPalette().size() == (size_t)IndexedCanvas::MAX_COLORS);
+    REQUIRE(canvas.GetPixel(64 + 13, 3) == sf::Color(13, 1, 2));
+    image.setPixel(20, 20, sf::Color(1, 2, 3, 4));
+    REQUIRE_FALSE(canvas.ReadTile(1, image.getPixelsPtr(), 64 * 4));
+
+    image.create(64, 64, sf::Color::Black);
+    REQUIRE(canvas.ReadTile(2, image.getPixelsPtr(), 64 * 4));
+    REQUIRE(canvas.GetTile(2).indices.empty());
+    REQUIRE(canvas.GetTile(2).index == 1);
+
+    image.setPixel(0, 0, sf::Color(1, 2, 3, 4));
+    IndexedCanvas full;
+    for (int i = 0; i < IndexedCanvas::MAX_COLORS; i++) {
+        image.setPixel((unsigned int)i, 1, sf::Color((sf::Uint8)i, 9, 9));
+    }
+    REQUIRE_FALSE(full.FromImage(image, palette));
+    REQUIRE(full.GetByteSize() == 0);
+}
+
+/*! \brief Benchmark a bucket fill and the expansion of a large canvas, against the same on its RGBA pixels.
+*/
+TEST_CASE("Benchmark indexed fills and expansion", "[IndexedCanvas][!benchmark]") {
+    const int size = 4096;
+    const std::vector<sf::Color> palette{sf::Color::White, sf::Color::Black, sf::Color::Red};
+    // A grid of walls, so the region is one shape of many spans.
+    const sf::Image image = _indexedImage(size, size, palette, [](int x, int y) { return (x % 256 == 0 && y % 512 > 8) ? 1 : 0; });
+    IndexedCanvas canvas;
+    REQUIRE(canvas.FromImage(image, palette));
+    sf::Image rgba = image;
+
+    auto start = std::chrono::steady_clock::now();
+    const std::vector<MathUtility::Span> spans = MathUtility::ScanlineFill(rgba.getPixelsPtr(), size, size, 1, 1);
+    MathUtility::FillSpans(MathUtility::MutablePixels(rgba), size, spans, sf::Color::Red);
+    const double rgbaMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    start = std::chrono::steady_clock::now();
+    const std::vector<MathUtility::Span> indexedSpans = canvas.Fill(1, 1, 2);
+    const double indexedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    REQUIRE(indexedSpans.size() > 0);
+
+    sf::Image expanded;
+    expanded.create(size, size);
+    sf::Uint8* pixels = MathUtility::MutablePixels(expanded);
+    const size_t stride = (size_t)size * 4;
+    start = std::chrono::steady_clock::now();
+    for (int tile = 0; tile < canvas.GetTileCount(); tile++) {
+        const size_t left = (size_t)(tile % canvas.GetTilesX()) * IndexedCanvas::TILE_SIZE;
+        const size_t top = (size_t)(tile / canvas.GetTilesX()) * IndexedCanvas::TILE_SIZE;
+        canvas.ExpandTile(tile, pixels + top * stride + left * 4, stride);
+    }
+    const double expandMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    REQUIRE(std::equal(rgba.getPixelsPtr(), rgba.getPixelsPtr() + stride * size, expanded.getPixelsPtr()));
+
+    const double rgbaBytes = (double)size * size * 4;
+    WARN("Fill of " << size << "x" << size << ": " << indexedMs << " ms on the indices, " << rgbaMs << " ms on the RGBA pixels; "
+        << canvas.GetByteSize() / 1024 / 1024 << " MB of indices against " << rgbaBytes / 1024 / 1024 << " MB; expanded in "
+        << expandMs << " ms (" << rgbaBytes / 1e3 / expandMs << " MB/s of RGBA)");
+    REQUIRE(canvas.GetByteSize() * 7 < (size_t)rgbaBytes);
+}
@@ -0,0 +1,90 @@
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "IndexedCanvas.hpp"
+#include "IndexedDelta.hpp"
+
+// True if the two canvases have the same index at every pixel.
+bool _sameIndices(const IndexedCanvas& a, const IndexedCanvas& b) {
+    for (int y = 0; y < a.GetHeight(); y++) {
+        for (int x = 0; x < a.GetWidth(); x++) {
+            if (a.GetIndex(x, y) != b.GetIndex(x, y)) {
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+/*! \brief Test that undo and redo of a stroke and a fill give back the indices before and after them.
+*/
+TEST_CASE("Undo and redo gestures on the indices", "[IndexedDelta]") {
+    const std::vector<sf::Color> palette{sf::Color::White, sf::Color::Black, sf::Color::Red};
+    sf::Image window;
+    IndexedCanvas canvas;
+    // Not a multiple of the tile size, so the edge tiles are partial.
+    REQUIRE(canvas.Create(300, 200, palette));
+    canvas.FillRect(sf::IntRect(100, 0, 3, 200), 1);
+    const IndexedCanvas before = canvas;
+
+    IndexedDelta stroke(canvas, window, "Stroke");
+    stroke.touch(10, 10, 250, 40);
+    canvas.FillCapsule(sf::Vector2f(20, 20), sf::Vector2f(240, 30), 12.0f, 2);
+    REQUIRE(stroke.execute());
+    // 4 tiles wide and one high, and the wall had already drawn on one of them.
+    REQUIRE(stroke.getTileCount() == 4);
+    REQUIRE(stroke.getByteSize() < 5 * IndexedCanvas::TILE_BYTES);
+    REQUIRE(stroke.getBounds() == sf::IntRect(0, 0, 256, 64));
+    const IndexedCanvas after = canvas;
+    REQUIRE(stroke.undo());
+    REQUIRE(_sameIndices(canvas, before));
+    REQUIRE(stroke.redo());
+    REQUIRE(_sameIndices(canvas, after));
+
+    // A fill of the whole canvas leaves every tile but the ones of the wall and the stroke of one index.
+    IndexedDelta fill(canvas, window, "Fill");
+    fill.touch(0, 0, 299, 199);
+    canvas.Fill(299, 199, 1);
+    REQUIRE(fill.execute());
+    REQUIRE(fill.getDescription().rfind("Fill (", 0) == 0);
+    REQUIRE(canvas.GetTile(14).indices.empty());
+    REQUIRE(fill.undo());
+    REQUIRE(_sameIndices(canvas, after));
+    REQUIRE(stroke.undo());
+    REQUIRE(_sameIndices(canvas, before));
+}
+
+/*! \brief Test that a gesture that changes nothing keeps nothing, and that spilled tiles come back.
+*/
+TEST_CASE("Indexed deltas keep only the changed tiles", "[IndexedDelta]") {
+    const std::vector<sf::Color> palette{sf::Color::White, sf::Color::Black};
+    sf::Image window;
+    IndexedCanvas canvas;
+    REQUIRE(canvas.Create(512, 512, palette));
+    SECTION("Nothing changed") {
+        IndexedDelta delta(canvas, window, "Stroke");
+        delta.touch(0, 0, 511, 511);
+        canvas.FillRect(sf::IntRect(10, 10, 5, 5), 0);
+        REQUIRE_FALSE(delta.execute());
+        REQUIRE(delta.getTileCount() == 0);
+    }
+    SECTION("Spilled and restored") {
+        IndexedDelta delta(canvas, window, "Stroke");
+        delta.touch(0, 0, 511, 511);
+        canvas.FillRect(sf::IntRect(0, 0, 128, 64), 1);
+        canvas.SetIndex(300, 300, 1);
+        REQUIRE(delta.execute());
+        REQUIRE(delta.getTileCount() == 3);
+        std::vector<sf::Uint8> bytes;
+        REQUIRE(delta.spill(bytes));
+        REQUIRE(delta.getByteSize() == 0);
+        REQUIRE_FALSE(delta.restore(std::vector<sf::Uint8>(bytes.begin(), bytes.end() - 1)));
+        REQUIRE(delta.restore(bytes));
+        REQUIRE(delta.undo());
+        REQUIRE(canvas.GetIndex(5, 5) == 0);
+        REQUIRE(canvas.GetIndex(300, 300) == 0);
+        REQUIRE(delta.redo());
+        REQUIRE(canvas.GetIndex(127, 63) == 1);
+        REQUIRE(canvas.GetIndex(300, 300) == 1);
+    }
+}
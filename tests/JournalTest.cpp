@@ -0,0 +1,151 @@
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "Journal.hpp"
+
+// A record of size bytes that all hold value.
+std::vector<sf::Uint8> _record(size_t size, sf::Uint8 value) {
+    return std::vector<sf::Uint8>(size, value);
+}
+
+/*! \brief Test that appended records are read back in order after the journal is closed.
+*/
+TEST_CASE("Append and read back journal records", "[Journal]") {
+    const std::string path = "JournalTest.journal";
+    std::remove(path.c_str());
+    Journal journal;
+    REQUIRE(journal.Open(path));
+    journal.Append(_record(3, 1));
+    journal.Append(_record(0, 0));
+    journal.Append(_record(300, 2));
+    REQUIRE(journal.GetRecordCount() == 3);
+    journal.Close();
+
+    std::vector<std::vector<sf::Uint8>> records;
+    size_t validSize;
+    REQUIRE(Journal::ReadRecords(path, records, validSize));
+    REQUIRE(records.size() == 3);
+    REQUIRE(records[0] == _record(3, 1));
+    REQUIRE(records[1].empty());
+    REQUIRE(records[2] == _record(300, 2));
+
+    // Reopening appends after the records that are there.
+    REQUIRE(journal.Open(path));
+    REQUIRE(journal.GetRecordCount() == 3);
+    journal.Append(_record(5, 3));
+    journal.Close();
+    REQUIRE(Journal::ReadRecords(path, records, validSize));
+    REQUIRE(records.size() == 4);
+    REQUIRE(records[3] == _record(5, 3));
+    std::remove(path.c_str());
+}
+
+/*! \brief Test that the background thread writes the records without a Flush().
+*/
+TEST_CASE("Journal records reach the file on the background thread", "[Journal]") {
+    const std::string path = "JournalTest.journal";
+    std::remove(path.c_str());
+    Journal journal;
+    REQUIRE(journal.Open(path, 5));
+    journal.Append(_record(10, 7));
+    std::vector<std::vector<sf::Uint8>> records;
+    size_t validSize = 0;
+    for (int i = 0; i < 200 && records.empty(); i++) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+        REQUIRE(Journal::ReadRecords(path, records, validSize));
+    }
+    REQUIRE(records.size() == 1);
+    journal.Close();
+    std::remove(path.c_str());
+}
+
+/*! \brief Test that a reset drops the written and the queued records and keeps the journal open.
+*/
+TEST_CASE("Reset a journal", "[Journal]") {
+    const std::string path = "JournalTest.journal";
+    std::remove(path.c_str());
+    Journal journal;
+    REQUIRE(journal.Open(path, 0));
+    journal.Append(_record(100, 1));
+    REQUIRE(journal.Flush());
+    journal.Append(_record(50, 2));
+    REQUIRE(journal.Reset());
+    REQUIRE(journal.GetRecordCount() == 0);
+    journal.Append(_record(20, 3));
+    journal.Close();
+    std::vector<std::vector<sf::Uint8>> records;
+    size_t validSize;
+    REQUIRE(Journal::ReadRecords(path, records, validSize));
+    REQUIRE(records.size() == 1);
+    REQUIRE(records[0] == _record(20, 3));
+    std::remove(path.c_str());
+}
+
+/*! \brief Test that a record torn by a crash is dropped and cut off when the journal is reopened.
+*/
+TEST_CASE("Torn journal records are dropped", "[Journal]") {
+    const std::string path = "JournalTest.journal";
+    std::remove(path.c_str());
+    Journal journal;
+    REQUIRE(journal.Open(path));
+    journal.Append(_record(20, 1));
+    journal.Append(_record(20, 2));
+    REQUIRE(journal.Flush());
+    const size_t size = journal.GetSize();
+    journal.Close();
+
+    // Cut the last record in half, like a crash in the middle of a write.
+    std::vector<sf::Uint8> bytes(size);
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    REQUIRE(std::fread(bytes.data(), 1, size, file) == size);
+    std::fclose(file);
+    file = std::fopen(path.c_str(), "wb");
+    std::fwrite(bytes.data(), 1, size - 10, file);
+    std::fclose(file);
+
+    std::vector<std::vector<sf::Uint8>> records;
+    size_t validSize;
+    REQUIRE(Journal::ReadRecords(path, records, validSize));
+    REQUIRE(records.size() == 1);
+    REQUIRE(records[0] == _record(20, 1));
+
+    // A corrupt byte fails the CRC check.
+    bytes[validSize - 6] ^= 0xFF;
+    file = std::fopen(path.c_str(), "wb");
+    std::fwrite(bytes.data(), 1, size, file);
+    std::fclose(file);
+    REQUIRE(Journal::ReadRecords(path, records, validSize));
+    REQUIRE(records.empty());
+
+    // Reopening cuts off the bad record, so new records are readable after the good ones.
+    REQUIRE(journal.Open(path));
+    journal.Append(_record(4, 9));
+    journal.Close();
+    REQUIRE(Journal::ReadRecords(path, records, validSize));
+    REQUIRE(records.size() == 1);
+    REQUIRE(records[0] == _record(4, 9));
+    std::remove(path.c_str());
+}
+
+/*! \brief Test that a file that is not a journal is not opened.
+*/
+TEST_CASE("Journal refuses other files", "[Journal]") {
+    const std::string path = "JournalTest.journal";
+    std::FILE* file = std::fopen(path.c_str(), "wb");
+    std::fputs("not a journal", file);
+    std::fclose(file);
+    Journal journal;
+    REQUIRE_FALSE(journal.Open(path));
+    std::remove(path.c_str());
+}
+
+/*! \brief Test the CRC-32 against the standard check value.
+*/
+TEST_CASE("Journal CRC-32", "[Journal]") {
+    const std::string check = "123456789";
+    REQUIRE(Journal::Crc32((const sf::Uint8*)check.data(), check.size()) == 0xCBF43926u);
+}
@@ -0,0 +1,182 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "Document.hpp"
+#include "MipPyramid.hpp"
+
+#include <SFML/Graphics.hpp>
+
+// An image of random pixels.
+sf::Image _noiseImage(unsigned width, unsigned height, unsigned seed) {
+    std::srand(seed);
+    sf::Image image;
+    image.create(width, height, sf::Color::White);
+    for (unsigned y = 0; y < height; y++) {
+        for (unsigned x = 0; x < width; x++) {
+            image.setPixel(x, y, sf::Color((sf::Uint8)(std::rand() % 256), (sf::Uint8)(std::rand() % 256), (sf::Uint8)(std::rand() % 256), 255));
+        }
+    }
+    return image;
+}
+
+// The next level of image: each pixel the rounded average of a 2x2 block, the last column
+// and row repeated when the size is odd.
+sf::Image _halve(const sf::Image& image) {
+    const unsigned width = image.getSize().x;
+    const unsigned height = image.getSize().y;
+    sf::Image half;
+    half.create((width + 1) / 2, (height + 1) / 2, sf::Color::White);
+    for (unsigned y = 0; y < half.getSize().y; y++) {
+        for (unsigned x = 0; x < half.getSize().x; x++) {
+            const sf::Color a = image.getPixel(x * 2, y * 2);
+            const sf::Color b = image.getPixel(std::min(x * 2 + 1, width - 1), y * 2);
+            const sf::Color c = image.getPixel(x * 2, std::min(y * 2 + 1, height - 1));
+            const sf::Color d = image.getPixel(std::min(x * 2 + 1, width - 1), std::min(y * 2 + 1, height - 1));
+            half.setPixel(x, y, sf::Color((sf::Uint8)((a.r + b.r + c.r + d.r + 2) / 4), (sf::Uint8)((a.g + b.g + c.g + d.g + 2) / 4),
+                                          (sf::Uint8)((a.b + b.b + c.b + d.b + 2) / 4), (sf::Uint8)((a.a + b.a + c.a + d.a + 2) / 4)));
+        }
+    }
+    return half;
+}
+
+// Queue every tile of image as level 0 of pyramid.
+void _updateAll(MipPyramid& pyramid, const sf::Image& image) {
+    const int width = (int)image.getSize().x;
+    const int height = (int)image.getSize().y;
+    const int tilesX = (width + MipPyramid::TILE_SIZE - 1) / MipPyramid::TILE_SIZE;
+    const int tilesY = (height + MipPyramid::TILE_SIZE - 1) / MipPyramid::TILE_SIZE;
+    for (int tile = 0; tile < tilesX * tilesY; tile++) {
+        const sf::IntRect rect = pyramid.GetTileRect(0, tile);
+        pyramid.Update(tile, image.getPixelsPtr() + ((size_t)rect.top * width + rect.left) * 4, (size_t)width * 4);
+    }
+}
+
+// True if level of pyramid has the pixels of expected.
+bool _levelEquals(MipPyramid& pyramid, int level, const sf::Image& expected) {
+    sf::Image read;
+    read.create(expected.getSize().x, expected.getSize().y, sf::Color::Black);
+    return pyramid.Read(level, 0, 0, read, sf::IntRect(0, 0, (int)expected.getSize().x, (int)expected.getSize().y))
+        && std::equal(read.getPixelsPtr(), read.getPixelsPtr() + expected.getSize().x * expected.getSize().y * 4, expected.getPixelsPtr());
+}
+
+/*! \brief Test that every level is the box filtered level below, for sizes that are not a power of two.
+*/
+TEST_CASE("Build the levels of a pyramid", "[MipPyramid]") {
+    MipPyramid pyramid;
+    pyramid.Reset(300, 200, sf::Color::White);
+    REQUIRE(pyramid.GetLevelCount() == 3);
+    REQUIRE(pyramid.GetLevelSize(1) == sf::Vector2i(150, 100));
+    REQUIRE(pyramid.GetLevelSize(3) == sf::Vector2i(38, 25));
+    // Nothing updated yet: every level is the background.
+    sf::Image white;
+    white.create(75, 50, sf::Color::White);
+    REQUIRE(_levelEquals(pyramid, 2, white));
+
+    sf::Image level = _noiseImage(300, 200, 46);
+    _updateAll(pyramid, level);
+    pyramid.Wait();
+    REQUIRE_FALSE(pyramid.IsBusy());
+    for (int i = 1; i <= 3; i++) {
+        level = _halve(level);
+        REQUIRE(_levelEquals(pyramid, i, level));
+    }
+}
+
+/*! \brief Test that a changed tile only rebuilds the tile above it on each level.
+*/
+TEST_CASE("Rebuild only the ancestors of a changed tile", "[MipPyramid]") {
+    MipPyramid pyramid;
+    pyramid.Reset(1000, 700, sf::Color::White);
+    REQUIRE(pyramid.GetLevelCount() == 4);
+    sf::Image image = _noiseImage(1000, 700, 7);
+    _updateAll(pyramid, image);
+    pyramid.Wait();
+    std::vector<int> rebuilt;
+    pyramid.TakeRebuilt(1, rebuilt);
+    REQUIRE(rebuilt.size() == 8 * 6);
+    pyramid.TakeRebuilt(2, rebuilt);
+    REQUIRE(rebuilt.size() == 4 * 3);
+    const size_t before = pyramid.GetRebuiltCount();
+
+    // Tile (5,3) of level 0 is in tile (2,1) of level 1 and tile (1,0) of level 2.
+    sf::Image red;
+    red.create(64, 64, sf::Color::Red);
+    pyramid.Update(3 * 16 + 5, red.getPixelsPtr(), 64 * 4);
+    pyramid.Wait();
+    REQUIRE(pyramid.GetRebuiltCount() == before + 4);
+    pyramid.TakeRebuilt(1, rebuilt);
+    REQUIRE(rebuilt == std::vector<int>{1 * 8 + 2});
+    pyramid.TakeRebuilt(2, rebuilt);
+    REQUIRE(rebuilt == std::vector<int>{1});
+    sf::Image pixel;
+    pixel.create(1, 1, sf::Color::Black);
+    REQUIRE(pyramid.Read(1, 5 * 32, 3 * 32, pixel, sf::IntRect(0, 0, 1, 1)));
+    REQUIRE(pixel.getPixel(0, 0) == sf::Color::Red);
+    REQUIRE(pyramid.Read(1, 5 * 32 - 1, 3 * 32, pixel, sf::IntRect(0, 0, 1, 1)));
+    REQUIRE(pixel.getPixel(0, 0) == _halve(image).getPixel(5 * 32 - 1, 3 * 32));
+}
+
+/*! \brief Test that the tiles of a document go into the pyramid, except the ones updated since.
+*/
+TEST_CASE("Build the pyramid of a document", "[MipPyramid]") {
+    const std::string path = "MipPyramidTest.mpd";
+    sf::Image image = _noiseImage(500, 300, 3);
+    {
+        DocumentWriter writer;
+        REQUIRE(writer.Open(path, 500, 300));
+        while (writer.GetNextTileRect().top < 300) {
+            const sf::IntRect rect = writer.GetNextTileRect();
+            REQUIRE(writer.AddTile(image.getPixelsPtr() + (rect.top * 500 + rect.left) * 4, 500 * 4));
+        }
+        REQUIRE(writer.Finish());
+    }
+    Document document;
+    REQUIRE(document.Open(path));
+    MipPyramid pyramid;
+    pyramid.Reset(500, 300, sf::Color::White, &document);
+    sf::Image blue;
+    blue.create(64, 64, sf::Color::Blue);
+    pyramid.Update(0, blue.getPixelsPtr(), 64 * 4);
+    pyramid.Wait();
+    for (unsigned y = 0; y < 64; y++) {
+        for (unsigned x = 0; x < 64; x++) {
+            image.setPixel(x, y, sf::Color::Blue);
+        }
+    }
+    REQUIRE(_levelEquals(pyramid, 1, _halve(image)));
+    REQUIRE(_levelEquals(pyramid, 2, _halve(_halve(image))));
+    pyramid.Reset(500, 300, sf::Color::White);
+    document.Close();
+    std::remove(path.c_str());
+}
+
+/*! \brief Benchmark bringing the pyramid of a large canvas up to date after a stroke, against building all of it.
+*/
+TEST_CASE("Benchmark rebuilding the pyramid after a stroke", "[MipPyramid] [!benchmark]") {
+    MipPyramid pyramid;
+    pyramid.Reset(16384, 16384, sf::Color::White);
+    const sf::Image tile = _noiseImage(64, 64, 1);
+    const int tilesX = 16384 / MipPyramid::TILE_SIZE;
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 16; i++) {
+        pyramid.Update(100 * tilesX + 100 + i, tile.getPixelsPtr(), 64 * 4);
+    }
+    pyramid.Wait();
+    const double strokeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    const size_t strokeTiles = pyramid.GetRebuiltCount();
+
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 64 * tilesX; i++) {
+        pyramid.Update(i, tile.getPixelsPtr(), 64 * 4);
+    }
+    pyramid.Wait();
+    const double bandMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    WARN(pyramid.GetLevelCount() << " levels over 16384 x 16384: a stroke over 16 tiles rebuilds " << strokeTiles
+         << " tiles in " << strokeMs << " ms; a band of " << 64 * tilesX << " tiles rebuilds "
+         << pyramid.GetRebuiltCount() - strokeTiles << " in " << bandMs << " ms");
+}
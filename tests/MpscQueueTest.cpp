@@ -0,0 +1,124 @@
+#include <chrono>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "MpscQueue.hpp"
+
+// A pushed item: the producer that pushed it and its count of items pushed before.
+struct _Tagged {
+    int producer = -1;
+    int index = -1;
+};
+
+// Push items from producers threads while the calling thread pops them in batches. Returns
+// true if every item arrived once and in the order its producer pushed it.
+bool _pushConcurrently(MpscQueue<_Tagged>& queue, int producers, int itemsEach) {
+    std::vector<std::thread> threads;
+    for (int p = 0; p < producers; p++) {
+        threads.emplace_back([&queue, p, itemsEach] {
+            for (int i = 0; i < itemsEach; i++) {
+                _Tagged item{p, i};
+                while (!queue.TryPush(item)) {
+                    std::this_thread::yield();
+                }
+            }
+        });
+    }
+    std::vector<int> next(producers, 0);
+    std::vector<_Tagged> batch;
+    bool ordered = true;
+    int received = 0;
+    while (received < producers * itemsEach) {
+        batch.clear();
+        if (queue.TryPopBatch(batch, 256) == 0) {
+            std::this_thread::yield();
+        }
+        for (const _Tagged& item : batch) {
+            ordered = ordered && item.index == next[item.producer];
+            next[item.producer]++;
+        }
+        received += (int)batch.size();
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    _Tagged extra;
+    return ordered && !queue.TryPop(extra);
+}
+
+/*! \brief Test that the queue hands items over in order and refuses them when full.
+*/
+TEST_CASE("Multi-producer queue order and capacity", "[MpscQueue]") {
+    MpscQueue<int> queue(3);
+    REQUIRE(queue.GetCapacity() == 4);
+    int value = 0;
+    REQUIRE_FALSE(queue.TryPop(value));
+    for (int lap = 0; lap < 3; lap++) {
+        for (int i = 0; i < 4; i++) {
+            int item = lap * 10 + i;
+            REQUIRE(queue.TryPush(item));
+        }
+        int extra = 99;
+        REQUIRE_FALSE(queue.TryPush(extra));
+        REQUIRE(queue.TryPop(value));
+        REQUIRE(value == lap * 10);
+        std::vector<int> batch;
+        REQUIRE(queue.TryPopBatch(batch, 2) == 2);
+        REQUIRE(batch == std::vector<int>{lap * 10 + 1, lap * 10 + 2});
+        REQUIRE(queue.TryPopBatch(batch, 8) == 1);
+        REQUIRE(batch.back() == lap * 10 + 3);
+        REQUIRE_FALSE(queue.TryPop(value));
+    }
+}
+
+/*! \brief Test that items from several producer threads all arrive, each producer's in order.
+*/
+TEST_CASE("Multi-producer queue with four producer threads", "[MpscQueue]") {
+    MpscQueue<_Tagged> queue(64);
+    REQUIRE(_pushConcurrently(queue, 4, 100000));
+}
+
+/*! \brief Benchmark pushes from 1 to 8 producer threads against a mutex guarded std::queue.
+*/
+TEST_CASE("Benchmark multi-producer queue contention", "[MpscQueue] [!benchmark]") {
+    const int itemsEach = 200000;
+    for (int producers : {1, 2, 4, 8}) {
+        MpscQueue<_Tagged> queue(4096);
+        auto start = std::chrono::steady_clock::now();
+        _pushConcurrently(queue, producers, itemsEach);
+        const double lockFreeMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+        std::queue<_Tagged> locked;
+        std::mutex mutex;
+        start = std::chrono::steady_clock::now();
+        std::vector<std::thread> threads;
+        for (int p = 0; p < producers; p++) {
+            threads.emplace_back([&locked, &mutex, p, itemsEach] {
+                for (int i = 0; i < itemsEach; i++) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    locked.push(_Tagged{p, i});
+                }
+            });
+        }
+        int received = 0;
+        while (received < producers * itemsEach) {
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                while (!locked.empty()) {
+                    locked.pop();
+                    received++;
+                }
+            }
+            std::this_thread::yield();
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        const double lockedMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        WARN(producers << " producers, " << itemsEach << " items each: lock-free " << lockFreeMs
+             << " ms, mutex and std::queue " << lockedMs << " ms");
+    }
+}
@@ -0,0 +1,43 @@
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "IndexedCanvas.hpp"
+#include "PaletteSwap.hpp"
+
+/*! \brief Test that a recolor changes the palette entries of the color, and undo sets them back, without touching the indices.
+*/
+TEST_CASE("Recolor through the palette", "[PaletteSwap]") {
+    const std::vector<sf::Color> palette{sf::Color::White, sf::Color::Red, sf::Color::Black, sf::Color::Red};
+    sf::Image window;
+    IndexedCanvas canvas;
+    REQUIRE(canvas.Create(1000, 700, palette));
+    canvas.FillRect(sf::IntRect(10, 10, 5, 5), 1);
+    canvas.FillRect(sf::IntRect(900, 600, 50, 50), 3);
+    canvas.FillRect(sf::IntRect(500, 300, 50, 50), 2);
+    const size_t bytes = canvas.GetByteSize();
+
+    PaletteSwap swap(canvas, window, sf::Color::Red, sf::Color::Green);
+    REQUIRE(swap.execute());
+    REQUIRE(swap.getColorCount() == 2);
+    REQUIRE(swap.getByteSize() <= 4 * sizeof(int));
+    REQUIRE(swap.getDescription() == "Recolor of 2 palette colors");
+    // Across the whole canvas, from the first tile to the ones of the square at the bottom right.
+    REQUIRE(swap.getBounds() == sf::IntRect(0, 0, 960, 700));
+    REQUIRE(canvas.GetPixel(12, 12) == sf::Color::Green);
+    REQUIRE(canvas.GetPixel(949, 649) == sf::Color::Green);
+    REQUIRE(canvas.GetPixel(520, 320) == sf::Color::Black);
+    REQUIRE(canvas.GetIndex(949, 649) == 3);
+    REQUIRE(canvas.GetByteSize() == bytes);
+
+    REQUIRE(swap.undo());
+    REQUIRE(canvas.GetPixel(12, 12) == sf::Color::Red);
+    REQUIRE(canvas.GetPixel(949, 649) == sf::Color::Red);
+    REQUIRE(swap.redo());
+    REQUIRE(canvas.GetPixel(949, 649) == sf::Color::Green);
+
+    // Nothing to recolor.
+    PaletteSwap none(canvas, window, sf::Color::Red, sf::Color::Blue);
+    REQUIRE_FALSE(none.execute());
+    PaletteSwap same(canvas, window, sf::Color::Black, sf::Color::Black);
+    REQUIRE_FALSE(same.execute());
+}
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "Draw.hpp"
+#include "MathUtility.hpp"
+#include "PixelBatch.hpp"
+
+#include <SFML/Graphics.hpp>
+
+// The pixels of a radius 5 paintbrush dab at (x,y), then the thick line joining it to a
+// dab at (x+20,y+20), like the paintbrush circle and line cases of the App tests.
+std::vector<std::pair<int, int>> _dabAndLine(int x, int y) {
+    std::vector<std::pair<int, int>> circle = MathUtility::BresenhamCircleAlgo(5);
+    std::vector<std::pair<int, int>> coords;
+    for (auto& offset : circle) {
+        coords.emplace_back(x + offset.first, y + offset.second);
+    }
+    for (auto& offset : circle) {
+        std::vector<std::pair<int, int>> line = MathUtility::ExtremelyFastLineAlgo(x + offset.first, y + offset.second, x + 20 + offset.first, y + 20 + offset.second);
+        coords.insert(coords.end(), line.begin(), line.end());
+    }
+    return coords;
+}
+
+/*! \brief Test that a batch paints its pixels and undo and redo restore them.
+*/
+TEST_CASE("Execute, undo and redo a pixel batch", "[PixelBatch]") {
+    sf::Image img;
+    img.create(100, 100, sf::Color::White);
+    img.setPixel(6, 5, sf::Color::Red);
+    PixelBatch batch(img, sf::Color::Black);
+    batch.add(5, 5);
+    batch.add(6, 5);
+    batch.add(5, 5);
+    batch.add(-1, 5);
+    batch.add(5, 100);
+    REQUIRE(batch.execute());
+    // The duplicate pixel and the pixels outside the image are dropped.
+    REQUIRE(batch.getPixelCount() == 2);
+    REQUIRE(batch.getBounds() == sf::IntRect(5, 5, 2, 1));
+    REQUIRE(img.getPixel(5, 5) == sf::Color::Black);
+    REQUIRE(img.getPixel(6, 5) == sf::Color::Black);
+    REQUIRE(batch.undo());
+    REQUIRE(img.getPixel(5, 5) == sf::Color::White);
+    REQUIRE(img.getPixel(6, 5) == sf::Color::Red);
+    REQUIRE(batch.redo());
+    REQUIRE(img.getPixel(6, 5) == sf::Color::Black);
+}
+
+/*! \brief Test that a batch that changes nothing does not execute.
+*/
+TEST_CASE("Pixel batch with nothing to paint", "[PixelBatch]") {
+    sf::Image img;
+    img.create(10, 10, sf::Color::White);
+    PixelBatch empty(img, sf::Color::Black);
+    REQUIRE_FALSE(empty.execute());
+    PixelBatch same(img, sf::Color::White);
+    same.add(3, 3);
+    REQUIRE_FALSE(same.execute());
+    REQUIRE(same.getPixelCount() == 0);
+}
+
+/*! \brief Test that a batch paints the same pixels as one Draw per pixel.
+*/
+TEST_CASE("Pixel batch matches per pixel draws", "[PixelBatch]") {
+    sf::Image expected;
+    expected.create(200, 200, sf::Color::White);
+    sf::Image img = expected;
+    std::vector<std::pair<int, int>> coords = _dabAndLine(50, 50);
+    for (auto& coord : coords) {
+        Draw(coord.first, coord.second, expected, sf::Color::Blue).execute();
+    }
+    PixelBatch batch(img, sf::Color::Blue);
+    batch.add(coords);
+    REQUIRE(batch.execute());
+    REQUIRE(batch.getCoords() == coords[0]);
+    REQUIRE(batch.getDescription() == "PixelBatch (" + std::to_string(batch.getPixelCount()) + " pixels, Blue)");
+    for (auto& coord : coords) {
+        REQUIRE(img.getPixel(coord.first, coord.second) == sf::Color::Blue);
+    }
+    REQUIRE(std::equal(img.getPixelsPtr(), img.getPixelsPtr() + 200 * 200 * 4, expected.getPixelsPtr()));
+}
+
+/*! \brief Test that a spilled batch restores its undo data.
+*/
+TEST_CASE("Spill and restore a pixel batch", "[PixelBatch]") {
+    sf::Image img;
+    img.create(200, 200, sf::Color::White);
+    img.setPixel(50, 50, sf::Color::Green);
+    sf::Image before = img;
+    PixelBatch batch(img, sf::Color::Black);
+    batch.add(_dabAndLine(50, 50));
+    REQUIRE(batch.execute());
+    const size_t pixelCount = batch.getPixelCount();
+    std::vector<sf::Uint8> bytes;
+    REQUIRE(batch.spill(bytes));
+    REQUIRE(batch.getByteSize() == 0);
+    REQUIRE(bytes.size() < pixelCount * 3);
+    REQUIRE_FALSE(batch.restore(std::vector<sf::Uint8>(bytes.begin(), bytes.end() - 1)));
+    REQUIRE(batch.restore(bytes));
+    REQUIRE(batch.getPixelCount() == pixelCount);
+    batch.undo();
+    REQUIRE(std::equal(img.getPixelsPtr(), img.getPixelsPtr() + 200 * 200 * 4, before.getPixelsPtr()));
+}
+
+/*! \brief Benchmark a paintbrush dab and line as one Draw command per pixel and as one PixelBatch.
+*/
+TEST_CASE("Benchmark pixel batch against per pixel draws", "[PixelBatch] [!benchmark]") {
+    sf::Image img;
+    img.create(1280, 720, sf::Color::White);
+    std::vector<std::pair<int, int>> coords = _dabAndLine(100, 200);
+
+    BENCHMARK("Draw per pixel: execute + undo") {
+        std::vector<std::unique_ptr<Command>> commands;
+        for (auto& coord : coords) {
+            std::unique_ptr<Command> draw(new Draw(coord.first, coord.second, img, sf::Color::Black));
+            if (draw->execute()) {
+                commands.push_back(std::move(draw));
+            }
+        }
+        for (auto it = commands.rbegin(); it != commands.rend(); ++it) {
+            (*it)->undo();
+        }
+        return commands.size();
+    };
+    BENCHMARK("PixelBatch: execute + undo") {
+        std::unique_ptr<PixelBatch> batch(new PixelBatch(img, sf::Color::Black));
+        batch->add(coords);
+        batch->execute();
+        batch->undo();
+        return batch->getPixelCount();
+    };
+}
@@ -0,0 +1,136 @@
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "MathUtility.hpp"
+#include "PixelKernels.hpp"
+
+#include <SFML/Graphics.hpp>
+
+// Random bytes, with runs of 0 and 255 so the fast paths of the kernels get exercised too.
+std::vector<sf::Uint8> _randomBytes(int count, unsigned seed) {
+    std::srand(seed);
+    std::vector<sf::Uint8> bytes(count);
+    for (int i = 0; i < count; i++) {
+        int kind = (i / 32) % 4;
+        bytes[i] = kind == 0 ? 0 : kind == 1 ? 255 : (sf::Uint8)(std::rand() % 256);
+    }
+    return bytes;
+}
+
+// Every level the CPU supports, slowest first.
+std::vector<PixelKernels::Level> _levels() {
+    std::vector<PixelKernels::Level> levels;
+    for (int level = PixelKernels::SCALAR; level <= PixelKernels::GetBestLevel(); level++) {
+        levels.push_back((PixelKernels::Level)level);
+    }
+    return levels;
+}
+
+/*! \brief Test that the scalar kernels blend like the formula in PixelKernels.hpp.
+*/
+TEST_CASE("Scalar kernels", "[PixelKernels]") {
+    PixelKernels::SetLevel(PixelKernels::SCALAR);
+    sf::Uint8 px[8] = {255, 255, 255, 255, 10, 20, 30, 255};
+    PixelKernels::FillSpan(px, 1, MathUtility::PackColor(sf::Color(1, 2, 3, 4)));
+    REQUIRE(sf::Color(px[0], px[1], px[2], px[3]) == sf::Color(1, 2, 3, 4));
+    REQUIRE(px[4] == 10);
+
+    sf::Uint8 white[4] = {255, 255, 255, 255};
+    sf::Uint8 half = 128;
+    PixelKernels::BlendMask(white, &half, 1, sf::Color::Black);
+    REQUIRE(white[0] == 127);
+    REQUIRE(white[3] == 255);
+
+    sf::Uint8 dst[4] = {0, 0, 0, 0};
+    sf::Uint8 top[8] = {0, 10, 255, 255, 1, 10, 255, 255};
+    sf::Uint8 bottom[8] = {0, 20, 0, 255, 0, 21, 0, 255};
+    PixelKernels::Downsample(dst, top, bottom, 1);
+    REQUIRE(sf::Color(dst[0], dst[1], dst[2], dst[3]) == sf::Color(0, 15, 128, 255));
+    PixelKernels::SetLevel(PixelKernels::GetBestLevel());
+}
+
+/*! \brief Test that every level gives the same pixels as the scalar kernels, including the odd tails.
+*/
+TEST_CASE("SIMD kernels match scalar", "[PixelKernels]") {
+    const int count = 1027;
+    std::vector<sf::Uint8> base = _randomBytes(count * 4, 1);
+    std::vector<sf::Uint8> src = _randomBytes(count * 4, 2);
+    std::vector<sf::Uint8> mask = _randomBytes(count, 3);
+    for (sf::Color color : {sf::Color::Red, sf::Color(10, 200, 30, 128), sf::Color(0, 0, 0, 0)}) {
+        std::vector<std::vector<sf::Uint8>> results;
+        for (PixelKernels::Level level : _levels()) {
+            PixelKernels::SetLevel(level);
+            REQUIRE(PixelKernels::GetLevel() == level);
+            std::vector<sf::Uint8> pixels = base;
+            PixelKernels::BlendMask(pixels.data(), mask.data(), count, color);
+            PixelKernels::FillSpan(pixels.data() + 12, 5, MathUtility::PackColor(color));
+            PixelKernels::Downsample(pixels.data() + 40, src.data(), base.data() + 4, (count - 11) / 2);
+            results.push_back(pixels);
+        }
+        for (const std::vector<sf::Uint8>& result : results) {
+            REQUIRE(result == results[0]);
+        }
+    }
+    PixelKernels::SetLevel(PixelKernels::GetBestLevel());
+}
+
+/*! \brief Benchmark each kernel at each level in gigabytes of pixels per second over a 1280x720 canvas.
+*/
+TEST_CASE("Benchmark pixel kernels", "[PixelKernels] [!benchmark]") {
+    const int width = 1280;
+    const int height = 720;
+    std::vector<sf::Uint8> canvas(width * height * 4, 255);
+    std::vector<sf::Uint8> layer(width * height * 4);
+    std::vector<sf::Uint8> coverage(width);
+    std::srand(5500);
+    for (sf::Uint8& b : layer) {
+        b = (sf::Uint8)(std::rand() % 256);
+    }
+    for (sf::Uint8& b : coverage) {
+        b = (sf::Uint8)(1 + std::rand() % 254);
+    }
+    const sf::Uint32 packed = MathUtility::PackColor(sf::Color::Blue);
+    const sf::Color translucent(0, 0, 255, 128);
+    for (PixelKernels::Level level : _levels()) {
+        PixelKernels::SetLevel(level);
+        const std::string name = PixelKernels::GetLevelName(level);
+        auto measure = [&](const std::string& kernel, auto&& run) {
+            auto start = std::chrono::steady_clock::now();
+            for (int i = 0; i < 10; i++) {
+                run();
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+            WARN(name << " " << kernel << ": " << 10.0 * canvas.size() / seconds / 1e9 << " GB/s");
+        };
+        auto fill = [&]() {
+            for (int y = 0; y < height; y++) {
+                PixelKernels::FillSpan(canvas.data() + (size_t)y * width * 4, width, packed);
+            }
+            return canvas[0];
+        };
+        auto masked = [&]() {
+            for (int y = 0; y < height; y++) {
+                PixelKernels::BlendMask(canvas.data() + (size_t)y * width * 4, coverage.data(), width, translucent);
+            }
+            return canvas[0];
+        };
+        auto downsample = [&]() {
+            for (int y = 0; y < height / 2; y++) {
+                PixelKernels::Downsample(layer.data() + (size_t)y * width * 2, canvas.data() + (size_t)y * 2 * width * 4,
+                                         canvas.data() + (size_t)(y * 2 + 1) * width * 4, width / 2);
+            }
+            return layer[0];
+        };
+        measure("FillSpan", fill);
+        measure("BlendMask", masked);
+        measure("Downsample", downsample);
+
+        BENCHMARK(name + " FillSpan 1280x720") { return fill(); };
+        BENCHMARK(name + " BlendMask 1280x720") { return masked(); };
+        BENCHMARK(name + " Downsample 1280x720") { return downsample(); };
+    }
+    PixelKernels::SetLevel(PixelKernels::GetBestLevel());
+}
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <cstdlib>
+#include <map>
+#include <set>
+#include <unordered_set>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "MathUtility.hpp"
+#include "PixelSet.hpp"
+
+/*! \brief Test packing and unpacking of negative and large coordinates.
+*/
+TEST_CASE("Pack pixel keys", "[PixelSet]") {
+    REQUIRE(PixelKey::X(PixelKey::Pack(-5, 7)) == -5);
+    REQUIRE(PixelKey::Y(PixelKey::Pack(-5, 7)) == 7);
+    REQUIRE(PixelKey::X(PixelKey::Pack(2147483647, -2147483647)) == 2147483647);
+    REQUIRE(PixelKey::Y(PixelKey::Pack(2147483647, -2147483647)) == -2147483647);
+    REQUIRE(PixelKey::Pack(1, 2) != PixelKey::Pack(2, 1));
+}
+
+/*! \brief Test insert, contains and erase against std::set with random coordinates.
+*/
+TEST_CASE("PixelSet matches std::set", "[PixelSet]") {
+    PixelSet pixels;
+    std::set<std::pair<int, int>> expected;
+    std::srand(5500);
+    for (int i = 0; i < 20000; i++) {
+        int x = std::rand() % 200 - 100;
+        int y = std::rand() % 200 - 100;
+        if (std::rand() % 3 == 0) {
+            REQUIRE(pixels.Erase(x, y) == (expected.erase(std::make_pair(x, y)) == 1));
+        } else {
+            REQUIRE(pixels.Insert(x, y) == expected.insert(std::make_pair(x, y)).second);
+        }
+    }
+    REQUIRE(pixels.Size() == expected.size());
+    for (int y = -100; y < 100; y++) {
+        for (int x = -100; x < 100; x++) {
+            REQUIRE(pixels.Contains(x, y) == (expected.count(std::make_pair(x, y)) == 1));
+        }
+    }
+    std::vector<std::pair<int, int>> all = pixels.ToVector();
+    std::sort(all.begin(), all.end());
+    REQUIRE(all == std::vector<std::pair<int, int>>(expected.begin(), expected.end()));
+    pixels.Clear();
+    REQUIRE(pixels.Empty());
+    REQUIRE_FALSE(pixels.Contains(0, 0));
+}
+
+/*! \brief Test the map values survive rehashing and erasing.
+*/
+TEST_CASE("PixelMap stores values", "[PixelSet]") {
+    PixelMap<int> counts;
+    for (int i = 0; i < 1000; i++) {
+        counts.Get(i % 37, i % 11)++;
+    }
+    REQUIRE(counts.Size() == 37 * 11);
+    REQUIRE(*counts.Find(0, 0) == 3);
+    REQUIRE(counts.Find(40, 0) == nullptr);
+    REQUIRE(counts.Insert(40, 0, 9));
+    REQUIRE_FALSE(counts.Insert(40, 0, 10));
+    REQUIRE(*counts.Find(40, 0) == 10);
+    int total = 0;
+    counts.ForEach([&total](int, int, int& value) { total += value; });
+    REQUIRE(total == 1010);
+    for (int x = 0; x < 37; x++) {
+        REQUIRE(counts.Erase(x, 0));
+    }
+    REQUIRE(counts.Size() == 37 * 10 + 1);
+    REQUIRE(*counts.Find(5, 5) == 3);
+}
+
+/*! \brief Test the map values move with their keys when erase shifts a probe run back.
+*/
+TEST_CASE("PixelMap matches std::map", "[PixelSet]") {
+    PixelMap<int> values;
+    std::map<std::pair<int, int>, int> expected;
+    std::srand(5501);
+    for (int i = 0; i < 20000; i++) {
+        int x = std::rand() % 100 - 50;
+        int y = std::rand() % 100 - 50;
+        if (std::rand() % 3 == 0) {
+            REQUIRE(values.Erase(x, y) == (expected.erase(std::make_pair(x, y)) == 1));
+        } else {
+            values.Get(x, y) = i;
+            expected[std::make_pair(x, y)] = i;
+        }
+    }
+    REQUIRE(values.Size() == expected.size());
+    for (const auto& entry : expected) {
+        REQUIRE(*values.Find(entry.first.first, entry.first.second) == entry.second);
+    }
+}
+
+/*! \brief Benchmark 1M insertions of a 1000x1000 block of pixels.
+*/
+TEST_CASE("Benchmark PixelSet against std::unordered_set", "[PixelSet] [!benchmark]") {
+    BENCHMARK("std::unordered_set<pair, SzudzikHash> 1M inserts") {
+        std::unordered_set<std::pair<int, int>, MathUtility::SzudzikHash> pixels;
+        for (int y = 0; y < 1000; y++) {
+            for (int x = 0; x < 1000; x++) {
+                pixels.insert(std::make_pair(x, y));
+            }
+        }
+        return pixels.size();
+    };
+    BENCHMARK("PixelSet 1M inserts") {
+        PixelSet pixels;
+        for (int y = 0; y < 1000; y++) {
+            for (int x = 0; x < 1000; x++) {
+                pixels.Insert(x, y);
+            }
+        }
+        return pixels.Size();
+    };
+    BENCHMARK("PixelSet 1M inserts (reserved)") {
+        PixelSet pixels;
+        pixels.Reserve(1000000);
+        for (int y = 0; y < 1000; y++) {
+            for (int x = 0; x < 1000; x++) {
+                pixels.Insert(x, y);
+            }
+        }
+        return pixels.Size();
+    };
+}
@@ -0,0 +1,84 @@
+#include <chrono>
+#include <cmath>
+#include <cstdlib>
+#include <string>
+
+#include "catch_amalgamated.hpp"
+#include "Rasterizer.hpp"
+
+#include <SFML/Graphics.hpp>
+
+/*! \brief Test a dot: full color in the middle, untouched outside, smooth at the edge.
+*/
+TEST_CASE("Rasterize a dot", "[Rasterizer]") {
+    sf::Image img = sf::Image();
+    img.create(40, 40, sf::Color::White);
+    Rasterizer::DrawCapsule(img, sf::Vector2f(20, 20), sf::Vector2f(20, 20), 10, sf::Color::Black);
+    REQUIRE(img.getPixel(20, 20) == sf::Color::Black);
+    REQUIRE(img.getPixel(23, 20) == sf::Color::Black);
+    REQUIRE(img.getPixel(27, 20) == sf::Color::White);
+    REQUIRE(img.getPixel(20, 13) == sf::Color::White);
+    // The pixel centered on the edge of the radius 5 disc is about half covered.
+    sf::Color edge = img.getPixel(25, 20);
+    REQUIRE(edge.r > 96);
+    REQUIRE(edge.r < 160);
+    // The covered area (sum of coverage) is close to pi * r^2.
+    double area = 0;
+    for (int y = 0; y < 40; y++) {
+        for (int x = 0; x < 40; x++) {
+            area += (255 - img.getPixel(x, y).r) / 255.0;
+        }
+    }
+    REQUIRE(std::fabs(area - 3.14159 * 25) < 2.0);
+}
+
+/*! \brief Test that a diagonal line is symmetric around its axis and keeps the canvas opaque.
+*/
+TEST_CASE("Rasterize a diagonal line", "[Rasterizer]") {
+    sf::Image img = sf::Image();
+    img.create(64, 64, sf::Color::White);
+    Rasterizer::DrawCapsule(img, sf::Vector2f(10, 10), sf::Vector2f(50, 50), 6, sf::Color::Red);
+    REQUIRE(img.getPixel(30, 30) == sf::Color::Red);
+    for (int i = 0; i < 64; i++) {
+        for (int j = 0; j < 64; j++) {
+            REQUIRE(img.getPixel(i, j) == img.getPixel(j, i));
+            REQUIRE(img.getPixel(i, j).a == 255);
+        }
+    }
+    REQUIRE(img.getPixel(40, 20) == sf::Color::White);
+    REQUIRE(img.getPixel(55, 55) == sf::Color::White);
+}
+
+/*! \brief Test that capsules hanging over the canvas border are clipped.
+*/
+TEST_CASE("Rasterize off the canvas", "[Rasterizer]") {
+    sf::Image img = sf::Image();
+    img.create(16, 16, sf::Color::White);
+    Rasterizer::DrawCapsule(img, sf::Vector2f(-20, 8), sf::Vector2f(40, 8), 30, sf::Color::Blue);
+    REQUIRE(img.getPixel(0, 0) == sf::Color::Blue);
+    REQUIRE(img.getPixel(15, 15) == sf::Color::Blue);
+    REQUIRE(Rasterizer::DrawCapsule(img, sf::Vector2f(-100, -100), sf::Vector2f(-90, -90), 10, sf::Color::Red) == 0);
+}
+
+/*! \brief Benchmark stroke throughput in megapixels per second for the brush sizes of the app.
+*/
+TEST_CASE("Benchmark capsule rasterization", "[Rasterizer] [!benchmark]") {
+    sf::Image img = sf::Image();
+    img.create(1280, 720, sf::Color::White);
+    for (int thickness : {6, 10, 30}) {
+        std::srand(5500);
+        size_t pixels = 0;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < 20000; i++) {
+            sf::Vector2f a((float)(std::rand() % 1280), (float)(std::rand() % 720));
+            sf::Vector2f b(a.x + std::rand() % 41 - 20, a.y + std::rand() % 41 - 20);
+            pixels += Rasterizer::DrawCapsule(img, a, b, (float)thickness, sf::Color::Blue);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        WARN("thickness " << thickness << ": " << pixels / seconds / 1e6 << " megapixels/s");
+
+        BENCHMARK("DrawCapsule 20px segment thickness=" + std::to_string(thickness)) {
+            return Rasterizer::DrawCapsule(img, sf::Vector2f(600, 300), sf::Vector2f(614, 314), (float)thickness, sf::Color::Red);
+        };
+    }
+}
@@ -0,0 +1,159 @@
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "Document.hpp"
+#include "RoundedLine.hpp"
+#include "StrokeCodec.hpp"
+
+#include <SFML/Graphics.hpp>
+
+// count line segments of strokes like the mouse draws them: each starts where the last ended,
+// moves a few pixels, and every strokeLength of them a new stroke starts with a new style.
+std::vector<std::unique_ptr<RoundedLine>> _mouseStrokes(size_t count, size_t strokeLength) {
+    std::vector<std::unique_ptr<RoundedLine>> lines;
+    lines.reserve(count);
+    int x = 640, y = 360;
+    unsigned seed = 12345;
+    for (size_t i = 0; i < count; i++) {
+        seed = seed * 1103515245 + 12345;
+        const int stroke = (int)(i / strokeLength);
+        if (i % strokeLength == 0) {
+            x = (int)(seed >> 8) % 1280;
+            y = (int)(seed >> 4) % 720;
+        }
+        const int nextX = x + (int)((seed >> 16) % 15) - 7;
+        const int nextY = y + (int)((seed >> 20) % 15) - 7;
+        lines.emplace_back(new RoundedLine(sf::Vector2f((float)x, (float)y), sf::Vector2f((float)nextX, (float)nextY), (float)(5 + stroke % 20),
+                                           stroke % 2 == 0 ? sf::Color::Black : sf::Color(10, 200, 30), (short)(stroke % 3)));
+        x = nextX;
+        y = nextY;
+    }
+    return lines;
+}
+
+// True if a and b are the same line segment.
+bool _sameLine(const RoundedLine& a, const RoundedLine& b) {
+    return a.getStartPoint() == b.getStartPoint() && a.getEndPoint() == b.getEndPoint() && a.getWidth() == b.getWidth()
+        && a.getColor() == b.getColor() && a.getOwner() == b.getOwner();
+}
+
+/*! \brief Test that line segments read back as written, across style changes, jumps and chunks.
+*/
+TEST_CASE("Stroke codec round trip", "[StrokeCodec]") {
+    std::vector<std::unique_ptr<RoundedLine>> lines = _mouseStrokes(1000, 37);
+    lines.emplace_back(new RoundedLine(sf::Vector2f(-12.5f, 3.25f), sf::Vector2f(100000, -0.00390625f), 0.5f, sf::Color(1, 2, 3, 4), -32768));
+    lines.emplace_back(new RoundedLine(sf::Vector2f(7, 7), sf::Vector2f(7, 7), 0.5f, sf::Color(1, 2, 3, 4), -32768));
+
+    // Write it in chunks, as a save to a file would.
+    StrokeWriter writer;
+    std::vector<sf::Uint8> bytes;
+    for (size_t i = 0; i < lines.size(); i++) {
+        writer.Write(*lines[i]);
+        if (writer.GetBytes().size() > 100) {
+            bytes.insert(bytes.end(), writer.GetBytes().begin(), writer.GetBytes().end());
+            writer.Clear();
+        }
+    }
+    bytes.insert(bytes.end(), writer.GetBytes().begin(), writer.GetBytes().end());
+    REQUIRE(bytes.size() < lines.size() * 8);
+
+    StrokeReader reader(bytes.data(), bytes.size());
+    for (const std::unique_ptr<RoundedLine>& expected : lines) {
+        std::unique_ptr<RoundedLine> line;
+        REQUIRE(reader.Read(line));
+        REQUIRE(_sameLine(*line, *expected));
+    }
+    REQUIRE(reader.AtEnd());
+    std::unique_ptr<RoundedLine> extra;
+    REQUIRE_FALSE(reader.Read(extra));
+}
+
+/*! \brief Test that strokes read back with their counts, and that cut or bad data is refused.
+*/
+TEST_CASE("Stroke codec strokes and bad data", "[StrokeCodec]") {
+    std::vector<std::unique_ptr<RoundedLine>> lines = _mouseStrokes(30, 10);
+    StrokeWriter writer;
+    for (size_t begin = 0; begin < lines.size(); begin += 10) {
+        writer.BeginStroke(10);
+        for (size_t i = begin; i < begin + 10; i++) {
+            writer.Write(*lines[i]);
+        }
+    }
+    REQUIRE(writer.GetCount() == 30);
+    const std::vector<sf::Uint8> bytes = writer.GetBytes();
+    StrokeReader reader(bytes.data(), bytes.size());
+    std::vector<std::unique_ptr<RoundedLine>> read;
+    for (int stroke = 1; stroke <= 3; stroke++) {
+        REQUIRE(reader.ReadStroke(read));
+        REQUIRE(read.size() == (size_t)stroke * 10);
+    }
+    REQUIRE(reader.AtEnd());
+    REQUIRE(_sameLine(*read[29], *lines[29]));
+
+    StrokeReader cut(bytes.data(), bytes.size() - 1);
+    read.clear();
+    REQUIRE(cut.ReadStroke(read));
+    REQUIRE(cut.ReadStroke(read));
+    REQUIRE_FALSE(cut.ReadStroke(read));
+    // The first line segment must carry its style.
+    const sf::Uint8 styleless[] = {1, 0, 0, 0, 0, 0};
+    StrokeReader bad(styleless, sizeof(styleless));
+    REQUIRE_FALSE(bad.ReadStroke(read));
+}
+
+/*! \brief Benchmark saving and loading a document with 1M line segments: the size of its
+*          strokes and how fast they are written and read, against their floats and text.
+*/
+TEST_CASE("Benchmark saving and loading 1M line segments", "[StrokeCodec] [!benchmark]") {
+    const std::string path = "StrokeCodecTest.mpd";
+    const size_t count = 1000000;
+    const std::vector<std::unique_ptr<RoundedLine>> lines = _mouseStrokes(count, 500);
+    size_t textSize = 0;
+    for (const std::unique_ptr<RoundedLine>& line : lines) {
+        textSize += line->description().size() + 1;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+    DocumentWriter document;
+    REQUIRE(document.Open(path, 64, 64));
+    sf::Image tile;
+    tile.create(64, 64, sf::Color::White);
+    REQUIRE(document.AddTile(tile.getPixelsPtr(), 64 * 4));
+    StrokeWriter writer;
+    for (size_t begin = 0; begin < count; begin += 500) {
+        writer.BeginStroke(500);
+        for (size_t i = begin; i < begin + 500; i++) {
+            writer.Write(*lines[i]);
+        }
+        if (writer.GetBytes().size() >= (1 << 20)) {
+            REQUIRE(document.AddStrokes(writer.GetBytes()));
+            writer.Clear();
+        }
+    }
+    REQUIRE(document.AddStrokes(writer.GetBytes()));
+    REQUIRE(document.Finish());
+    const double saveMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    start = std::chrono::steady_clock::now();
+    Document opened;
+    REQUIRE(opened.Open(path));
+    std::vector<std::unique_ptr<RoundedLine>> read;
+    std::vector<size_t> strokeEnds;
+    read.reserve(count);
+    REQUIRE(opened.ReadStrokes(read, strokeEnds));
+    const double loadMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+    REQUIRE(read.size() == count);
+    REQUIRE(strokeEnds.size() == count / 500);
+    REQUIRE(_sameLine(*read[count - 1], *lines[count - 1]));
+
+    const double size = (double)opened.GetStrokesSize();
+    WARN(count << " line segments: " << size / (1024 * 1024) << " MB, " << size / count << " bytes each (binary fields: "
+         << sizeof(float) * 5 + sizeof(sf::Color) + sizeof(short) << ", text: " << (double)textSize / count << "); save " << saveMs << " ms ("
+         << size / (1024 * 1024) / (saveMs / 1000) << " MB/s), load " << loadMs << " ms (" << size / (1024 * 1024) / (loadMs / 1000) << " MB/s)");
+    opened.Close();
+    std::remove(path.c_str());
+}
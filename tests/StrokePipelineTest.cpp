@@ -0,0 +1,205 @@
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "Rasterizer.hpp"
+#include "SpscQueue.hpp"
+#include "StrokePipeline.hpp"
+
+#include <SFML/Graphics.hpp>
+
+// Submit item, collecting whatever is finished while the pipeline is full.
+void _submit(StrokePipeline& pipeline, StrokeItem& item, std::vector<StrokeItem>& collected) {
+    StrokeItem done;
+    while (!pipeline.Submit(item)) {
+        while (pipeline.Collect(done)) {
+            collected.push_back(std::move(done));
+        }
+    }
+}
+
+// Collect until every submitted item is out, resuming the raster stage after each gesture.
+void _drain(StrokePipeline& pipeline, std::vector<StrokeItem>& collected) {
+    StrokeItem done;
+    while (!pipeline.IsIdle()) {
+        if (!pipeline.Collect(done)) {
+            std::this_thread::yield();
+            continue;
+        }
+        if ((done.kind == StrokeItem::END && done.raster) || done.kind == StrokeItem::FILL) {
+            pipeline.Resume();
+        }
+        collected.push_back(std::move(done));
+    }
+}
+
+// A stroke sample at (x,y).
+StrokeItem _sample(float x, float y, bool raster) {
+    StrokeItem item;
+    item.raster = raster;
+    item.point = sf::Vector2f(x, y);
+    item.width = 10;
+    item.color = sf::Color::Blue;
+    item.owner = 1234;
+    return item;
+}
+
+/*! \brief Test that the queue hands items over in order and refuses them when full.
+*/
+TEST_CASE("Single-producer queue order and capacity", "[StrokePipeline]") {
+    SpscQueue<int> queue(5);
+    REQUIRE(queue.GetCapacity() == 8);
+    int value = 0;
+    REQUIRE_FALSE(queue.TryPop(value));
+    for (int i = 0; i < 8; i++) {
+        REQUIRE(queue.TryPush(i));
+    }
+    int extra = 8;
+    REQUIRE_FALSE(queue.TryPush(extra));
+    REQUIRE(queue.GetSize() == 8);
+    for (int i = 0; i < 8; i++) {
+        REQUIRE(queue.TryPop(value));
+        REQUIRE(value == i);
+    }
+    REQUIRE_FALSE(queue.TryPop(value));
+}
+
+/*! \brief Test that every item crosses between two threads once and in order.
+*/
+TEST_CASE("Single-producer queue between two threads", "[StrokePipeline]") {
+    SpscQueue<int> queue(64);
+    const int count = 1000000;
+    std::thread producer([&queue] {
+        for (int i = 0; i < count; i++) {
+            int item = i;
+            while (!queue.TryPush(item)) {
+                std::this_thread::yield();
+            }
+        }
+    });
+    int expected = 0;
+    bool ordered = true;
+    int value;
+    while (expected < count) {
+        if (queue.TryPop(value)) {
+            ordered = ordered && value == expected;
+            expected++;
+        }
+    }
+    producer.join();
+    REQUIRE(ordered);
+    REQUIRE(queue.GetSize() == 0);
+}
+
+/*! \brief Test that the pipeline paints a straight raster stroke like painting its segments in place.
+*/
+TEST_CASE("Pipeline paints a raster stroke", "[StrokePipeline]") {
+    sf::Image img;
+    img.create(300, 200, sf::Color::White);
+    sf::Image expected = img;
+    std::vector<StrokeItem> collected;
+    {
+        StrokePipeline pipeline(img, nullptr);
+        const float xs[] = {10, 10, 50, 90, 90, 200};
+        for (float x : xs) {
+            StrokeItem item = _sample(x, x / 2, true);
+            _submit(pipeline, item, collected);
+        }
+        StrokeItem end;
+        end.kind = StrokeItem::END;
+        end.raster = true;
+        _submit(pipeline, end, collected);
+        _drain(pipeline, collected);
+    }
+    // The samples are in line, so each curve between their midpoints is one segment.
+    Rasterizer::DrawCapsule(expected, sf::Vector2f(10, 5), sf::Vector2f(10, 5), 10, sf::Color::Blue);
+    Rasterizer::DrawCapsule(expected, sf::Vector2f(10, 5), sf::Vector2f(30, 15), 10, sf::Color::Blue);
+    Rasterizer::DrawCapsule(expected, sf::Vector2f(30, 15), sf::Vector2f(70, 35), 10, sf::Color::Blue);
+    Rasterizer::DrawCapsule(expected, sf::Vector2f(70, 35), sf::Vector2f(145, 72.5f), 10, sf::Color::Blue);
+    Rasterizer::DrawCapsule(expected, sf::Vector2f(145, 72.5f), sf::Vector2f(200, 100), 10, sf::Color::Blue);
+    REQUIRE(std::equal(img.getPixelsPtr(), img.getPixelsPtr() + 300 * 200 * 4, expected.getPixelsPtr()));
+
+    // The repeated samples were dropped, the last segment was added at the end, and the
+    // end carries the tile delta of the stroke.
+    REQUIRE(collected.size() == 6);
+    REQUIRE(collected[1].line->getStartPoint() == sf::Vector2f(10, 5));
+    REQUIRE(collected[1].line->getEndPoint() == sf::Vector2f(30, 15));
+    REQUIRE(collected[4].line->getEndPoint() == sf::Vector2f(200, 100));
+    REQUIRE(collected[5].kind == StrokeItem::END);
+    REQUIRE(collected[5].lineCount == 5);
+    REQUIRE(collected[5].command != nullptr);
+    REQUIRE(collected[5].command->undo());
+    sf::Image white;
+    white.create(300, 200, sf::Color::White);
+    REQUIRE(std::equal(img.getPixelsPtr(), img.getPixelsPtr() + 300 * 200 * 4, white.getPixelsPtr()));
+}
+
+/*! \brief Test that line mode segments pass through without touching the image, and fills are painted.
+*/
+TEST_CASE("Pipeline passes line segments on and fills", "[StrokePipeline]") {
+    sf::Image img;
+    img.create(300, 200, sf::Color::White);
+    std::vector<StrokeItem> collected;
+    StrokePipeline pipeline(img, nullptr);
+    StrokeItem first = _sample(0, 100, false);
+    StrokeItem second = _sample(300, 100, false);
+    StrokeItem end;
+    end.kind = StrokeItem::END;
+    _submit(pipeline, first, collected);
+    _submit(pipeline, second, collected);
+    _submit(pipeline, end, collected);
+    _drain(pipeline, collected);
+    REQUIRE(collected.size() == 4);
+    REQUIRE(img.getPixel(150, 100) == sf::Color::White);
+    REQUIRE(collected[3].lineCount == 3);
+    REQUIRE(collected[3].command == nullptr);
+
+    // The line splits the image, so a fill above it stops there.
+    StrokeItem fill;
+    fill.kind = StrokeItem::FILL;
+    fill.point = sf::Vector2f(10, 10);
+    fill.color = sf::Color::Red;
+    fill.boundary.reset(new std::vector<const RoundedLine*>{collected[1].line.get(), collected[2].line.get()});
+    _submit(pipeline, fill, collected);
+    _drain(pipeline, collected);
+    REQUIRE(collected.size() == 5);
+    REQUIRE(collected[4].command != nullptr);
+    REQUIRE(img.getPixel(10, 10) == sf::Color::Red);
+    REQUIRE(img.getPixel(10, 190) == sf::Color::White);
+    REQUIRE(collected[4].bounds.top == 0);
+    REQUIRE(collected[4].bounds.height < 100);
+}
+
+/*! \brief Test that a stroke round a corner is smoothed into a chain of segments that cuts the corner.
+*/
+TEST_CASE("Pipeline smooths a stroke round a corner", "[StrokePipeline]") {
+    sf::Image img;
+    img.create(300, 200, sf::Color::White);
+    std::vector<StrokeItem> collected;
+    StrokePipeline pipeline(img, nullptr);
+    const sf::Vector2f samples[] = {sf::Vector2f(0, 0), sf::Vector2f(100, 0), sf::Vector2f(100, 100)};
+    for (sf::Vector2f sample : samples) {
+        StrokeItem item = _sample(sample.x, sample.y, false);
+        _submit(pipeline, item, collected);
+    }
+    StrokeItem end;
+    end.kind = StrokeItem::END;
+    _submit(pipeline, end, collected);
+    _drain(pipeline, collected);
+
+    // The corner took more segments than there are samples, and they join end to start.
+    REQUIRE(collected.size() > 5);
+    REQUIRE(collected.back().kind == StrokeItem::END);
+    REQUIRE(collected.back().lineCount == (int)collected.size() - 1);
+    REQUIRE(collected[0].line->getStartPoint() == sf::Vector2f(0, 0));
+    REQUIRE(collected[collected.size() - 2].line->getEndPoint() == sf::Vector2f(100, 100));
+    bool joined = true;
+    bool cut = true;
+    for (size_t i = 1; i + 1 < collected.size(); i++) {
+        joined = joined && collected[i].line->getStartPoint() == collected[i - 1].line->getEndPoint();
+        cut = cut && collected[i].line->getEndPoint() != sf::Vector2f(100, 0);
+    }
+    REQUIRE(joined);
+    REQUIRE(cut);
+}
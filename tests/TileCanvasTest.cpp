@@ -0,0 +1,179 @@
+#include <chrono>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+#include "catch_amalgamated.hpp"
+#include "TileCanvas.hpp"
+
+#include <SFML/Graphics.hpp>
+
+/*! \brief Test that a snapshot shares tiles until one side writes to them.
+*/
+TEST_CASE("Snapshots share tiles until written", "[TileCanvas]") {
+    TileCanvas canvas(200, 100, sf::Color::White);
+    REQUIRE(canvas.GetTileCount() == 4 * 2);
+    // A blank canvas is one buffer.
+    REQUIRE(canvas.GetBufferCount() == 1);
+    canvas.SetPixel(10, 10, sf::Color::Red);
+    REQUIRE(canvas.GetBufferCount() == 2);
+
+    TileCanvas snapshot = canvas;
+    for (int tile = 0; tile < canvas.GetTileCount(); tile++) {
+        REQUIRE(canvas.SharesTile(snapshot, tile));
+    }
+    canvas.SetPixel(150, 90, sf::Color::Blue);
+    REQUIRE(snapshot.GetPixel(150, 90) == sf::Color::White);
+    REQUIRE(canvas.GetPixel(150, 90) == sf::Color::Blue);
+    REQUIRE(snapshot.GetPixel(10, 10) == sf::Color::Red);
+    // Only the written tile was duplicated.
+    for (int tile = 0; tile < canvas.GetTileCount(); tile++) {
+        REQUIRE(canvas.SharesTile(snapshot, tile) == (tile != canvas.GetTileIndex(150, 90)));
+    }
+}
+
+/*! \brief Test that Sync only copies the dirty tiles of an image and leaves snapshots alone.
+*/
+TEST_CASE("Sync dirty tiles from an image", "[TileCanvas]") {
+    sf::Image img = sf::Image();
+    img.create(130, 70, sf::Color::White);
+    TileCanvas canvas(130, 70, sf::Color::White);
+    TileCanvas before = canvas;
+    img.setPixel(129, 69, sf::Color::Green);
+    img.setPixel(0, 0, sf::Color::Green);
+    canvas.MarkDirty(129, 69, 129, 69);
+    REQUIRE(canvas.Sync(img) == 1);
+    REQUIRE(canvas.GetPixel(129, 69) == sf::Color::Green);
+    // Not marked dirty, so not copied.
+    REQUIRE(canvas.GetPixel(0, 0) == sf::Color::White);
+    REQUIRE(before.GetPixel(129, 69) == sf::Color::White);
+    REQUIRE(canvas.Sync(img) == 0);
+
+    canvas.MarkDirty(0, 0, 129, 69);
+    REQUIRE(canvas.Sync(img) == 3 * 2);
+    sf::Image copy;
+    canvas.CopyToImage(copy);
+    REQUIRE(copy.getSize() == img.getSize());
+    REQUIRE(std::equal(img.getPixelsPtr(), img.getPixelsPtr() + 130 * 70 * 4, copy.getPixelsPtr()));
+}
+
+/*! \brief Test that shifting the tiles by whole tiles only leaves the exposed and edge tiles to copy.
+*/
+TEST_CASE("Shift tiles with a panned image", "[TileCanvas]") {
+    sf::Image img = sf::Image();
+    img.create(130, 140);
+    for (unsigned y = 0; y < 140; y++) {
+        for (unsigned x = 0; x < 130; x++) {
+            img.setPixel(x, y, sf::Color((sf::Uint8)x, (sf::Uint8)y, 7));
+        }
+    }
+    TileCanvas canvas(130, 140, sf::Color::White);
+    canvas.MarkDirty(0, 0, 129, 139);
+    REQUIRE(canvas.Sync(img) == 3 * 3);
+
+    // Pan one tile right and one down: the image pixels move up and left by 64.
+    sf::Image panned = sf::Image();
+    panned.create(130, 140, sf::Color::Black);
+    for (unsigned y = 0; y < 140 - 64; y++) {
+        for (unsigned x = 0; x < 130 - 64; x++) {
+            panned.setPixel(x, y, img.getPixel(x + 64, y + 64));
+        }
+    }
+    canvas.Shift(1, 1);
+    REQUIRE(canvas.GetPixel(10, 20) == img.getPixel(74, 84));
+    // Exposed: the last column and row. Taken from a partial edge tile: tiles (1,0), (0,1) and (1,1).
+    REQUIRE(canvas.Sync(panned) == 5 + 3);
+    sf::Image copy;
+    canvas.CopyToImage(copy);
+    REQUIRE(std::equal(panned.getPixelsPtr(), panned.getPixelsPtr() + 130 * 140 * 4, copy.getPixelsPtr()));
+}
+
+/*! \brief Test that packed tiles read as before, unpack only in the canvas that reads or writes them, and a uniform one is its color alone.
+*/
+TEST_CASE("Pack tiles and unpack them on demand", "[TileCanvas]") {
+    TileCanvas canvas(150, 100, sf::Color::White);
+    for (int x = 0; x < 150; x++) {
+        canvas.SetPixel(x, 99 - x / 2, sf::Color(x, 0, 255 - x));
+    }
+    // The buffers are held on to, so no new one takes the address of one packed.
+    std::vector<std::shared_ptr<const TileCanvas::Tile>> buffers;
+    std::unordered_map<const TileCanvas::Tile*, std::shared_ptr<const TileCanvas::PackedTile>> packed;
+    for (int tile = 0; tile < canvas.GetTileCount(); tile++) {
+        buffers.push_back(canvas.GetPixelBuffer(tile));
+        packed[buffers.back().get()] = TileCanvas::Pack(buffers.back()->data(), canvas.GetTileWidth(tile), canvas.GetTileHeight(tile));
+    }
+    // The top left tile has no line through it, so it is its color alone.
+    REQUIRE(packed[canvas.GetPixelBuffer(0).get()]->uniform);
+    REQUIRE(packed[canvas.GetPixelBuffer(0).get()]->encoded.empty());
+    REQUIRE_FALSE(packed[canvas.GetPixelBuffer(canvas.GetTileIndex(149, 25)).get()]->uniform);
+    sf::Image before;
+    canvas.CopyToImage(before);
+    std::unordered_set<const void*> counted;
+    const size_t raw = canvas.CountBytes(counted);
+    REQUIRE(raw >= (size_t)canvas.GetBufferCount() * TileCanvas::TILE_STRIDE * TileCanvas::TILE_SIZE);
+
+    TileCanvas snapshot = canvas;
+    REQUIRE(canvas.ReplacePacked(packed) == (size_t)canvas.GetTileCount());
+    REQUIRE(snapshot.ReplacePacked(packed) == (size_t)canvas.GetTileCount());
+    counted.clear();
+    REQUIRE(canvas.CountBytes(counted) * 8 < raw);
+    REQUIRE(canvas.GetPixelBuffer(0) == nullptr);
+
+    // Copying out unpacks straight into the image and leaves the tiles packed.
+    sf::Image after;
+    canvas.CopyToImage(after);
+    REQUIRE(std::equal(before.getPixelsPtr(), before.getPixelsPtr() + 150 * 100 * 4, after.getPixelsPtr()));
+    for (int tile = 0; tile < canvas.GetTileCount(); tile++) {
+        REQUIRE(canvas.IsPacked(tile));
+        REQUIRE(canvas.SharesTile(snapshot, tile));
+    }
+    // Reading or writing a tile unpacks it in that canvas only.
+    REQUIRE(canvas.GetPixel(149, 25) == sf::Color(149, 0, 106));
+    REQUIRE_FALSE(canvas.IsPacked(canvas.GetTileIndex(149, 25)));
+    canvas.SetPixel(10, 10, sf::Color::Red);
+    REQUIRE_FALSE(canvas.IsPacked(0));
+    REQUIRE(snapshot.IsPacked(0));
+    REQUIRE(snapshot.IsPacked(canvas.GetTileIndex(149, 25)));
+    REQUIRE(snapshot.GetPixel(10, 10) == sf::Color::White);
+    REQUIRE(canvas.GetPixel(10, 10) == sf::Color::Red);
+    REQUIRE(canvas.GetPixel(11, 10) == sf::Color::White);
+
+    // Tiles written since they were handed out keep their new pixels.
+    REQUIRE(canvas.ReplacePacked(packed) == 0);
+    // Sync overwrites a packed tile with new pixels.
+    sf::Image image;
+    image.create(150, 100, sf::Color::Green);
+    snapshot.MarkDirty(140, 90, 140, 90);
+    REQUIRE(snapshot.Sync(image) == 1);
+    REQUIRE(snapshot.GetPixel(149, 99) == sf::Color::Green);
+    REQUIRE(snapshot.GetPixel(100, 70) == sf::Color::White);
+}
+
+/*! \brief Benchmark taking a snapshot against copying the whole image.
+*/
+TEST_CASE("Benchmark canvas snapshots", "[TileCanvas] [!benchmark]") {
+    for (int size : {1024, 8192}) {
+        sf::Image img = sf::Image();
+        img.create(size, size, sf::Color::White);
+        TileCanvas canvas(size, size, sf::Color::White);
+        canvas.MarkDirty(0, 0, size - 1, size - 1);
+        canvas.Sync(img);
+        const std::string name = std::to_string(size) + "x" + std::to_string(size);
+
+        BENCHMARK("Copy sf::Image " + name) {
+            sf::Image copy = img;
+            return copy.getSize().x;
+        };
+        BENCHMARK("Snapshot TileCanvas " + name) {
+            TileCanvas snapshot = canvas;
+            return snapshot.GetTileCount();
+        };
+        BENCHMARK("Snapshot after a 100x100 stroke " + name) {
+            canvas.MarkDirty(500, 500, 599, 599);
+            canvas.Sync(img);
+            TileCanvas snapshot = canvas;
+            return snapshot.GetTileCount();
+        };
+    }
+}
@@ -0,0 +1,149 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <string>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "Draw.hpp"
+#include "Rasterizer.hpp"
+#include "TileDelta.hpp"
+
+#include <SFML/Graphics.hpp>
+
+// Paint a random scribble of segments into img as one recorded gesture.
+void _scribble(sf::Image& img, TileDelta& delta, int segments, float thickness, unsigned seed) {
+    std::srand(seed);
+    sf::Vector2f prev((float)(std::rand() % img.getSize().x), (float)(std::rand() % img.getSize().y));
+    for (int i = 0; i < segments; i++) {
+        sf::Vector2f next(prev.x + std::rand() % 41 - 20, prev.y + std::rand() % 41 - 20);
+        sf::IntRect bounds = Rasterizer::CapsuleBounds(prev, next, thickness);
+        delta.touch(bounds.left, bounds.top, bounds.left + bounds.width - 1, bounds.top + bounds.height - 1);
+        Rasterizer::DrawCapsule(img, prev, next, thickness, sf::Color((sf::Uint8)(i * 7), 0, 255, 200));
+        prev = next;
+    }
+}
+
+bool _sameImage(const sf::Image& a, const sf::Image& b) {
+    return a.getSize() == b.getSize() && std::equal(a.getPixelsPtr(), a.getPixelsPtr() + a.getSize().x * a.getSize().y * 4, b.getPixelsPtr());
+}
+
+/*! \brief Test that undo and redo of a stroke give back exactly the pixels before and after it.
+*/
+TEST_CASE("Undo and redo a stroke with tile deltas", "[TileDelta]") {
+    sf::Image img = sf::Image();
+    // Not a multiple of the tile size, so the edge tiles are partial.
+    img.create(300, 200, sf::Color::White);
+    Rasterizer::DrawCapsule(img, sf::Vector2f(0, 0), sf::Vector2f(300, 200), 40, sf::Color::Red);
+    sf::Image before = img;
+    TileDelta delta(img);
+    _scribble(img, delta, 200, 10, 42);
+    sf::Image after = img;
+    REQUIRE(delta.execute());
+    REQUIRE(delta.getTileCount() > 0);
+    REQUIRE(delta.undo());
+    REQUIRE(_sameImage(img, before));
+    REQUIRE(delta.redo());
+    REQUIRE(_sameImage(img, after));
+    REQUIRE(delta.undo());
+    REQUIRE(_sameImage(img, before));
+}
+
+/*! \brief Test that a delta only keeps the tiles that changed and compresses solid paint.
+*/
+TEST_CASE("Tile deltas keep only the changed tiles", "[TileDelta]") {
+    sf::Image img = sf::Image();
+    img.create(512, 512, sf::Color::White);
+    SECTION("Nothing changed") {
+        TileDelta delta(img);
+        delta.touch(0, 0, 511, 511);
+        REQUIRE_FALSE(delta.execute());
+        REQUIRE(delta.getTileCount() == 0);
+    }
+    SECTION("Solid rectangle") {
+        TileDelta delta(img);
+        delta.touch(0, 0, 511, 511);
+        for (int y = 10; y < 200; y++) {
+            for (int x = 10; x < 300; x++) {
+                img.setPixel(x, y, sf::Color::Blue);
+            }
+        }
+        REQUIRE(delta.execute());
+        // 5 x 4 tiles of 64 pixels, out of the 8 x 8 that were touched.
+        REQUIRE(delta.getTileCount() == 20);
+        // A few runs per row instead of 4 bytes per changed pixel.
+        REQUIRE(delta.getByteSize() < 290 * 190 / 10);
+        delta.undo();
+        REQUIRE(img.getPixel(100, 100) == sf::Color::White);
+        delta.redo();
+        REQUIRE(img.getPixel(100, 100) == sf::Color::Blue);
+        REQUIRE(img.getPixel(300, 100) == sf::Color::White);
+    }
+}
+
+/*! \brief Test that a tile delta still undoes after being spilled to bytes and restored.
+*/
+TEST_CASE("Spill and restore a tile delta", "[TileDelta]") {
+    sf::Image img = sf::Image();
+    img.create(300, 200, sf::Color::White);
+    sf::Image before = img;
+    TileDelta delta(img);
+    _scribble(img, delta, 100, 10, 7);
+    REQUIRE(delta.execute());
+    const size_t tiles = delta.getTileCount();
+    std::vector<sf::Uint8> bytes;
+    REQUIRE(delta.spill(bytes));
+    REQUIRE(delta.getByteSize() == 0);
+    REQUIRE_FALSE(delta.restore(std::vector<sf::Uint8>(bytes.begin(), bytes.end() - 1)));
+    REQUIRE(delta.restore(bytes));
+    REQUIRE(delta.getTileCount() == tiles);
+    delta.undo();
+    REQUIRE(_sameImage(img, before));
+}
+
+/*! \brief Test that undo stops at corrupt delta data instead of looping on it.
+*/
+TEST_CASE("Undo a corrupt tile delta", "[TileDelta]") {
+    sf::Image img = sf::Image();
+    img.create(64, 64, sf::Color::White);
+    TileDelta delta(img);
+    delta.touch(5, 5, 5, 5);
+    img.setPixel(5, 5, sf::Color::Red);
+    REQUIRE(delta.execute());
+    std::vector<sf::Uint8> bytes;
+    REQUIRE(delta.spill(bytes));
+    // One tile: its count, index and size, then the delta bytes.
+    REQUIRE(bytes.size() > 3);
+    REQUIRE(bytes[2] == bytes.size() - 3);
+    // Empty runs, then a varint that never ends.
+    for (sf::Uint8 fill : {0x00, 0x80}) {
+        std::fill(bytes.begin() + 3, bytes.end(), fill);
+        REQUIRE(delta.restore(bytes));
+        REQUIRE_FALSE(delta.undo());
+    }
+}
+
+/*! \brief Benchmark the memory per gesture against one Draw command per pixel, and undo speed.
+*/
+TEST_CASE("Benchmark tile delta undo", "[TileDelta] [!benchmark]") {
+    sf::Image img = sf::Image();
+    img.create(1280, 720, sf::Color::White);
+    for (float thickness : {6.0f, 30.0f}) {
+        sf::Image before = img;
+        TileDelta delta(img);
+        _scribble(img, delta, 500, thickness, 5500);
+        size_t changed = 0;
+        for (size_t i = 0; i < (size_t)1280 * 720 * 4; i += 4) {
+            changed += std::equal(img.getPixelsPtr() + i, img.getPixelsPtr() + i + 4, before.getPixelsPtr() + i) ? 0 : 1;
+        }
+        delta.execute();
+        WARN("thickness " << thickness << ": " << changed << " pixels changed in " << delta.getTileCount() << " tiles, "
+             << delta.getByteSize() << " bytes per gesture (" << (double)delta.getByteSize() / changed << " per pixel, a Draw per pixel takes "
+             << sizeof(Draw) << ")");
+
+        BENCHMARK("Undo + redo 500 segment stroke thickness=" + std::to_string((int)thickness)) {
+            delta.undo();
+            return delta.redo();
+        };
+    }
+}
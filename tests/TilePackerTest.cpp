@@ -0,0 +1,112 @@
+#include <algorithm>
+#include <chrono>
+#include <memory>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "TileCanvas.hpp"
+#include "TilePacker.hpp"
+
+#include <SFML/Graphics.hpp>
+
+// A canvas with a few strokes of paint across it, like a drawing on a white background.
+TileCanvas _paintedCanvas(int width, int height) {
+    TileCanvas canvas(width, height, sf::Color::White);
+    for (int stroke = 0; stroke < 8; stroke++) {
+        const sf::Color color((sf::Uint8)(stroke * 30), 80, (sf::Uint8)(255 - stroke * 30));
+        for (int x = 0; x < width; x++) {
+            const int y = (stroke * height / 8 + x / 3) % height;
+            for (int dy = 0; dy < 6 && y + dy < height; dy++) {
+                canvas.SetPixel(x, y + dy, color);
+            }
+        }
+    }
+    return canvas;
+}
+
+// Hand every tile of canvas to packer, wait for them and swap them in. Returns the tiles swapped.
+size_t _packAll(TilePacker& packer, TileCanvas& canvas) {
+    std::vector<TilePacker::Job> jobs;
+    std::unordered_set<const TileCanvas::Tile*> queued;
+    for (int tile = 0; tile < canvas.GetTileCount(); tile++) {
+        std::shared_ptr<const TileCanvas::Tile> pixels = canvas.GetPixelBuffer(tile);
+        if (pixels && queued.insert(pixels.get()).second) {
+            jobs.push_back(TilePacker::Job{pixels, canvas.GetTileWidth(tile), canvas.GetTileHeight(tile)});
+        }
+    }
+    packer.Pack(jobs);
+    packer.Wait();
+    std::vector<TilePacker::Result> results;
+    packer.Collect(results);
+    std::unordered_map<const TileCanvas::Tile*, std::shared_ptr<const TileCanvas::PackedTile>> packed;
+    for (const TilePacker::Result& result : results) {
+        packed[result.pixels.get()] = result.packed;
+    }
+    return canvas.ReplacePacked(packed);
+}
+
+/*! \brief Test that the worker packs every tile handed to it, even ones written since, and the canvas keeps its pixels.
+*/
+TEST_CASE("Pack tiles on the worker", "[TilePacker]") {
+    TileCanvas canvas = _paintedCanvas(300, 200);
+    sf::Image before;
+    canvas.CopyToImage(before);
+    TilePacker packer;
+    REQUIRE_FALSE(packer.IsBusy());
+    REQUIRE(_packAll(packer, canvas) == (size_t)canvas.GetTileCount());
+    REQUIRE(packer.GetPackedCount() == canvas.GetBufferCount());
+    REQUIRE(packer.GetPackedBytes() > 0);
+    sf::Image after;
+    canvas.CopyToImage(after);
+    REQUIRE(std::equal(before.getPixelsPtr(), before.getPixelsPtr() + 300 * 200 * 4, after.getPixelsPtr()));
+
+    // A tile written while the worker has it is not swapped; the worker packed its old buffer.
+    canvas.SetPixel(0, 0, sf::Color::Red);
+    std::vector<TilePacker::Job> jobs{TilePacker::Job{canvas.GetPixelBuffer(0), 64, 64}};
+    packer.Pack(jobs);
+    REQUIRE(jobs.empty());
+    canvas.SetPixel(1, 0, sf::Color::Red);
+    packer.Wait();
+    std::vector<TilePacker::Result> results;
+    REQUIRE(packer.Collect(results) == 1);
+    REQUIRE(results[0].pixels != canvas.GetPixelBuffer(0));
+    std::unordered_map<const TileCanvas::Tile*, std::shared_ptr<const TileCanvas::PackedTile>> packed{{results[0].pixels.get(), results[0].packed}};
+    REQUIRE(canvas.ReplacePacked(packed) == 0);
+    REQUIRE(canvas.GetPixel(1, 0) == sf::Color::Red);
+    REQUIRE(packer.Collect(results) == 0);
+}
+
+/*! \brief Benchmark the memory of a painted canvas packed, and how long a tile takes to unpack when it is read again.
+*/
+TEST_CASE("Benchmark packed tiles and unpack latency", "[TilePacker] [!benchmark]") {
+    const int width = 2048;
+    const int height = 2048;
+    TileCanvas canvas = _paintedCanvas(width, height);
+    std::unordered_set<const void*> counted;
+    const size_t raw = canvas.CountBytes(counted);
+    TilePacker packer;
+    const auto packStart = std::chrono::steady_clock::now();
+    _packAll(packer, canvas);
+    const double packMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - packStart).count();
+    counted.clear();
+    const size_t packed = canvas.CountBytes(counted);
+    REQUIRE(packed * 4 < raw);
+
+    // Read one pixel of every tile, unpacking each, and then copy out the whole canvas of packed tiles.
+    TileCanvas reread = canvas;
+    const auto readStart = std::chrono::steady_clock::now();
+    sf::Uint32 sum = 0;
+    for (int tile = 0; tile < reread.GetTileCount(); tile++) {
+        sum += reread.GetTile(tile)[0];
+    }
+    const double readUs = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - readStart).count() / reread.GetTileCount();
+    sf::Image image;
+    const auto copyStart = std::chrono::steady_clock::now();
+    canvas.CopyToImage(image);
+    const double copyMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - copyStart).count();
+    WARN(width << "x" << height << " painted canvas: " << raw / 1024 << " KB of tiles, " << packed / 1024 << " KB packed ("
+         << (double)raw / packed << "x) in " << packMs << " ms on the worker; unpacking a tile on a read takes " << readUs
+         << " us, copying out the packed canvas " << copyMs << " ms (" << sum << ")");
+}
@@ -0,0 +1,96 @@
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "Fill.hpp"
+#include "TileCanvas.hpp"
+#include "TileDelta.hpp"
+#include "Timeline.hpp"
+
+#include <SFML/Graphics.hpp>
+
+// True if both images have the same pixels.
+bool _sameFrame(const sf::Image& a, const sf::Image& b) {
+    return a.getSize() == b.getSize() && std::equal(a.getPixelsPtr(), a.getPixelsPtr() + a.getSize().x * a.getSize().y * 4, b.getPixelsPtr());
+}
+
+/*! \brief Test that raster commands redo into a copy of the image the way they redo in place.
+*/
+TEST_CASE("Redo raster commands into another image", "[Timeline]") {
+    sf::Image img;
+    img.create(300, 200, sf::Color::White);
+    const sf::Image before = img;
+    TileDelta delta(img);
+    delta.touch(20, 20, 120, 60);
+    for (int x = 20; x <= 120; x++) {
+        img.setPixel(x, 40, sf::Color::Red);
+    }
+    REQUIRE(delta.execute());
+    const sf::Image composite = img;
+    Fill fill(250, 150, img, sf::Color::Blue, composite);
+    REQUIRE(fill.execute());
+    const sf::Image after = img;
+
+    sf::Image copy = before;
+    REQUIRE(delta.redoInto(copy));
+    REQUIRE(fill.redoInto(copy));
+    REQUIRE(_sameFrame(copy, after));
+    // The image the commands were made on is left alone.
+    REQUIRE(_sameFrame(img, after));
+}
+
+/*! \brief Test that a frame renders as its keyframe with the commands redone over it.
+*/
+TEST_CASE("Render a timeline frame", "[Timeline]") {
+    sf::Image img;
+    img.create(300, 200, sf::Color::White);
+    Timeline::Frame frame;
+    frame.keyframe.Create(300, 200, sf::Color::White);
+    frame.keyframe.SetPixel(150, 100, sf::Color::Black);
+    img.setPixel(150, 100, sf::Color::Black);
+    const sf::Image composite = img;
+    Fill fill(10, 10, img, sf::Color::Green, composite);
+    REQUIRE(fill.execute());
+    frame.commands.push_back(&fill);
+
+    sf::Image rendered;
+    REQUIRE(Timeline::Render(frame, rendered));
+    REQUIRE(_sameFrame(rendered, img));
+    std::atomic<bool> cancel(true);
+    REQUIRE_FALSE(Timeline::Render(frame, rendered, &cancel));
+}
+
+/*! \brief Test that the worker renders the newest request and drops the ones it replaced.
+*/
+TEST_CASE("Timeline renders the newest request", "[Timeline]") {
+    sf::Image img;
+    img.create(300, 200, sf::Color::White);
+    std::vector<std::unique_ptr<Fill>> fills;
+    for (int i = 0; i < 100; i++) {
+        fills.emplace_back(new Fill(0, 0, img, i % 2 == 0 ? sf::Color::Red : sf::Color::Blue));
+        REQUIRE(fills.back()->execute());
+    }
+    Timeline timeline;
+    std::unique_ptr<sf::Image> image(new sf::Image);
+    sf::Uint32 gesture = 0;
+    std::vector<std::pair<size_t, size_t>> strokes;
+    REQUIRE_FALSE(timeline.Collect(image, gesture, strokes));
+    for (sf::Uint32 g = 1; g <= 100; g++) {
+        std::unique_ptr<Timeline::Frame> frame(new Timeline::Frame);
+        frame->gesture = g;
+        frame->keyframe.Create(300, 200, sf::Color::White);
+        for (sf::Uint32 i = 0; i < g; i++) {
+            frame->commands.push_back(fills[i].get());
+        }
+        frame->strokes.emplace_back(0, g);
+        timeline.Request(std::move(frame));
+    }
+    timeline.Wait();
+    REQUIRE_FALSE(timeline.IsBusy());
+    REQUIRE(timeline.Collect(image, gesture, strokes));
+    REQUIRE(gesture == 100);
+    REQUIRE(image->getPixel(150, 100) == sf::Color::Blue);
+    REQUIRE(strokes == std::vector<std::pair<size_t, size_t>>{{0, 100}});
+    REQUIRE_FALSE(timeline.Collect(image, gesture, strokes));
+}
@@ -0,0 +1,127 @@
+#include <algorithm>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "catch_amalgamated.hpp"
+#include "Document.hpp"
+#include "VirtualCanvas.hpp"
+
+#include <SFML/Graphics.hpp>
+
+// An image with a different color for every pixel, so a pixel read from the wrong place shows.
+sf::Image _patternImage(unsigned width, unsigned height) {
+    sf::Image image;
+    image.create(width, height, sf::Color::White);
+    for (unsigned y = 0; y < height; y++) {
+        for (unsigned x = 0; x < width; x++) {
+            image.setPixel(x, y, sf::Color((sf::Uint8)x, (sf::Uint8)y, (sf::Uint8)(x / 256 * 16 + y / 256), 255));
+        }
+    }
+    return image;
+}
+
+// The pixel at (x,y) of the canvas, read through a 1 x 1 image.
+sf::Color _canvasPixel(VirtualCanvas& canvas, int x, int y) {
+    sf::Image pixel;
+    pixel.create(1, 1, sf::Color::Black);
+    canvas.Read(x, y, pixel, sf::IntRect(0, 0, 1, 1));
+    return pixel.getPixel(0, 0);
+}
+
+/*! \brief Test that areas written back at unaligned places read back the same, and nothing else changes.
+*/
+TEST_CASE("Write back and read areas of a virtual canvas", "[VirtualCanvas]") {
+    VirtualCanvas canvas;
+    canvas.Create(1000, 700, sf::Color::White);
+    REQUIRE(canvas.GetTileCount() == 16 * 11);
+    REQUIRE(canvas.GetTileRect(15) == sf::IntRect(960, 0, 40, 64));
+    REQUIRE(canvas.GetPageCount() == 0);
+
+    // Write a 300 x 200 image at (130,70): tiles 2 to 6 across and 1 to 4 down.
+    const sf::Image image = _patternImage(300, 200);
+    REQUIRE(canvas.Write(130, 70, image, std::vector<sf::IntRect>{sf::IntRect(0, 0, 300, 200)}));
+    REQUIRE(canvas.GetPageCount() == 5 * 4);
+    REQUIRE(canvas.GetPageBytes() > 0);
+    sf::Image read;
+    read.create(300, 200, sf::Color::Black);
+    REQUIRE(canvas.Read(130, 70, read, sf::IntRect(0, 0, 300, 200)));
+    REQUIRE(std::equal(read.getPixelsPtr(), read.getPixelsPtr() + 300 * 200 * 4, image.getPixelsPtr()));
+    // The parts of the edge tiles outside the image kept the background.
+    REQUIRE(_canvasPixel(canvas, 129, 70) == sf::Color::White);
+    REQUIRE(_canvasPixel(canvas, 430, 269) == sf::Color::White);
+    REQUIRE(_canvasPixel(canvas, 130, 70) == image.getPixel(0, 0));
+
+    // A read overlapping the written area and running off the canvas.
+    sf::Image edge;
+    edge.create(200, 100, sf::Color::Black);
+    REQUIRE(canvas.Read(900, 650, edge, sf::IntRect(0, 0, 200, 100)));
+    REQUIRE(edge.getPixel(99, 49) == sf::Color::White);
+    REQUIRE(edge.getPixel(100, 50) == sf::Color::White);
+    REQUIRE(canvas.Read(-100, -50, edge, sf::IntRect(0, 0, 200, 100)));
+    REQUIRE(edge.getPixel(0, 0) == sf::Color::White);
+
+    // Writing back only a small area of another image writes only the tiles under it, but all of them.
+    sf::Image red;
+    red.create(300, 200, sf::Color::Red);
+    REQUIRE(canvas.Write(130, 70, red, std::vector<sf::IntRect>{sf::IntRect(10, 10, 5, 5)}));
+    REQUIRE(canvas.GetPageCount() == 5 * 4);
+    REQUIRE(_canvasPixel(canvas, 130, 70) == sf::Color::Red);
+    REQUIRE(_canvasPixel(canvas, 191, 127) == sf::Color::Red);
+    REQUIRE(_canvasPixel(canvas, 192, 128) == image.getPixel(62, 58));
+    REQUIRE(_canvasPixel(canvas, 129, 70) == sf::Color::White);
+
+    // Writing off the canvas only writes the tiles on it.
+    REQUIRE(canvas.Write(900, 600, red, std::vector<sf::IntRect>{sf::IntRect(0, 0, 300, 200)}));
+    REQUIRE(canvas.GetPageCount() == 5 * 4 + 2 * 2);
+    REQUIRE(_canvasPixel(canvas, 999, 699) == sf::Color::Red);
+}
+
+/*! \brief Test that tiles never written back come from the document, or are the background without one.
+*/
+TEST_CASE("Read a virtual canvas over a document", "[VirtualCanvas]") {
+    const std::string path = "VirtualCanvasTest.mpd";
+    const sf::Image image = _patternImage(500, 300);
+    {
+        DocumentWriter writer;
+        REQUIRE(writer.Open(path, 500, 300));
+        while (writer.GetNextTileRect().top < 300) {
+            const sf::IntRect rect = writer.GetNextTileRect();
+            REQUIRE(writer.AddTile(image.getPixelsPtr() + (rect.top * 500 + rect.left) * 4, 500 * 4));
+        }
+        REQUIRE(writer.Finish());
+    }
+    Document document;
+    REQUIRE(document.Open(path));
+    VirtualCanvas canvas;
+    canvas.Create(500, 300, sf::Color::White, &document);
+    sf::Image read;
+    read.create(500, 300, sf::Color::Black);
+    REQUIRE(canvas.Read(0, 0, read, sf::IntRect(0, 0, 500, 300)));
+    REQUIRE(std::equal(read.getPixelsPtr(), read.getPixelsPtr() + 500 * 300 * 4, image.getPixelsPtr()));
+
+    // A written tile is the page from then on; the others are still the document's, compressed.
+    sf::Image blue;
+    blue.create(64, 64, sf::Color::Blue);
+    REQUIRE(canvas.Write(64, 64, blue, std::vector<sf::IntRect>{sf::IntRect(0, 0, 64, 64)}));
+    REQUIRE(canvas.GetPageCount() == 1);
+    REQUIRE(_canvasPixel(canvas, 64, 64) == sf::Color::Blue);
+    REQUIRE(_canvasPixel(canvas, 63, 63) == image.getPixel(63, 63));
+    const sf::Uint8* encoded;
+    size_t encodedSize;
+    const sf::Uint8* documentTile;
+    size_t documentTileSize;
+    REQUIRE(canvas.GetEncodedTile(0, encoded, encodedSize));
+    REQUIRE(document.GetEncodedTile(0, documentTile, documentTileSize));
+    REQUIRE(encoded == documentTile);
+    REQUIRE(canvas.GetEncodedTile(9, encoded, encodedSize));
+    REQUIRE(encoded != documentTile);
+
+    // Without a document the tiles not written are the background, and have nothing encoded.
+    canvas.Create(500, 300, sf::Color::Green);
+    REQUIRE(canvas.GetPageCount() == 0);
+    REQUIRE_FALSE(canvas.GetEncodedTile(0, encoded, encodedSize));
+    REQUIRE(_canvasPixel(canvas, 499, 299) == sf::Color::Green);
+    document.Close();
+    std::remove(path.c_str());
+}